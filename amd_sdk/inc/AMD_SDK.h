@@ -41,7 +41,9 @@
 
 // AMD helper classes and functions
 #include "..\\src\\Timer.h"
+#include "..\\src\\FramePacing.h"
 #include "..\\src\\ShaderCache.h"
+#include "..\\src\\ShaderPermutations.h"
 #include "..\\src\\HelperFunctions.h"
 #include "..\\src\\Sprite.h"
 #include "..\\src\\Magnify.h"
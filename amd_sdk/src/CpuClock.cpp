@@ -0,0 +1,251 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: CpuClock.cpp
+//
+// Backend selection, TSC calibration and overhead measurement for the CPU clock.
+// This file doesn't depend on DXUT, so the clock can be used on its own.
+//--------------------------------------------------------------------------------------
+#include "CpuClock.h"
+
+#include <algorithm>
+#include <vector>
+
+#if AMD_CPU_CLOCK_HAVE_TSC && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+namespace AMD
+{
+    volatile int    CpuClock::s_Backend = CpuClock::BACKEND_AUTO;
+    double          CpuClock::s_fFrequency = 0.0;
+    double          CpuClock::s_fSecondsPerTick = 0.0;
+    long long       CpuClock::s_llOverheadTicks = 0;
+    double          CpuClock::s_fTscFrequency = 0.0;
+}
+
+namespace
+{
+    // Long enough to calibrate the TSC to a few parts per million against a 10 MHz QPC
+    const double kCalibrationSeconds = 0.02;
+
+    const int kOverheadSamples = 1001;
+
+#if defined(_WIN32)
+    const AMD::CpuClock::Backend kOsBackend = AMD::CpuClock::BACKEND_QPC;
+
+    long long OsNow()
+    {
+        LARGE_INTEGER t;
+        QueryPerformanceCounter( &t );
+        return t.QuadPart;
+    }
+
+    double OsFrequency()
+    {
+        LARGE_INTEGER freq;
+        QueryPerformanceFrequency( &freq );
+        return (double)freq.QuadPart;
+    }
+#else
+    const AMD::CpuClock::Backend kOsBackend = AMD::CpuClock::BACKEND_MONOTONIC;
+
+    long long OsNow()
+    {
+        timespec t;
+        clock_gettime( CLOCK_MONOTONIC, &t );
+        return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+    }
+
+    double OsFrequency()
+    {
+        return 1.0e9;
+    }
+#endif
+
+#if AMD_CPU_CLOCK_HAVE_TSC
+    // an invariant TSC runs at a constant rate in all P-, C- and T-states
+    bool HasInvariantTsc()
+    {
+        unsigned int uMaxLeaf, uEdx;
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid( info, 0x80000000 );
+        uMaxLeaf = (unsigned int)info[0];
+        if (uMaxLeaf < 0x80000007)
+        {
+            return false;
+        }
+        __cpuid( info, 0x80000007 );
+        uEdx = (unsigned int)info[3];
+#else
+        unsigned int uEax, uEbx, uEcx;
+        uMaxLeaf = __get_cpuid_max( 0x80000000, NULL );
+        if (uMaxLeaf < 0x80000007 || !__get_cpuid( 0x80000007, &uEax, &uEbx, &uEcx, &uEdx ))
+        {
+            return false;
+        }
+#endif
+        return 0 != (uEdx & (1u << 8));
+    }
+
+    // reads the TSC on both sides of an OS clock read, and returns the OS time of the read
+    // with the smallest bracket, so preemption between the reads doesn't skew the calibration
+    long long ReadBracketed( long long& o_llTsc )
+    {
+        long long llBestSpan = 0, llBestOs = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            long long llBefore = (long long)__rdtsc();
+            long long llOs = OsNow();
+            long long llAfter = (long long)__rdtsc();
+
+            if (0 == i || llAfter - llBefore < llBestSpan)
+            {
+                llBestSpan = llAfter - llBefore;
+                llBestOs = llOs;
+                o_llTsc = llBefore + (llAfter - llBefore) / 2;
+            }
+        }
+        return llBestOs;
+    }
+#endif
+}
+
+namespace AMD
+{
+    bool CpuClock::IsSupported( Backend backend )
+    {
+        switch (backend)
+        {
+        case BACKEND_AUTO:
+            return true;
+#if defined(_WIN32)
+        case BACKEND_QPC:
+            return true;
+#else
+        case BACKEND_MONOTONIC:
+            return true;
+#endif
+#if AMD_CPU_CLOCK_HAVE_TSC
+        case BACKEND_TSC:
+            return HasInvariantTsc();
+#endif
+        default:
+            return false;
+        }
+    }
+
+    const wchar_t* CpuClock::GetBackendName( Backend backend )
+    {
+        switch (backend)
+        {
+        case BACKEND_AUTO:      return L"Auto";
+        case BACKEND_QPC:       return L"QueryPerformanceCounter";
+        case BACKEND_MONOTONIC: return L"clock_gettime";
+        case BACKEND_TSC:       return L"TSC";
+        default:                return L"Unknown";
+        }
+    }
+
+    bool CpuClock::SetBackend( Backend backend )
+    {
+        if (BACKEND_AUTO == backend)
+        {
+            backend = IsSupported( BACKEND_TSC ) ? BACKEND_TSC : kOsBackend;
+        }
+
+        if (!IsSupported( backend ))
+        {
+            return false;
+        }
+
+        double fFrequency = OsFrequency();
+        if (BACKEND_TSC == backend)
+        {
+            if (0.0 == s_fTscFrequency)
+            {
+                s_fTscFrequency = CalibrateTsc();
+            }
+            fFrequency = s_fTscFrequency;
+        }
+
+        s_fFrequency = fFrequency;
+        s_fSecondsPerTick = 1.0 / fFrequency;
+
+        // switch last, so Now() doesn't use the new backend before its frequency is known
+        s_Backend = backend;
+        s_llOverheadTicks = MeasureOverhead();
+
+        return true;
+    }
+
+    long long CpuClock::NowUninitialized()
+    {
+        Initialize();
+        return Now();
+    }
+
+    double CpuClock::CalibrateTsc()
+    {
+#if AMD_CPU_CLOCK_HAVE_TSC
+        const double fOsFrequency = OsFrequency();
+
+        long long llTsc0 = 0, llTsc1 = 0;
+        long long llOs0 = ReadBracketed( llTsc0 );
+        long long llOs1 = llOs0;
+
+        while ((double)(llOs1 - llOs0) < kCalibrationSeconds * fOsFrequency)
+        {
+            llOs1 = ReadBracketed( llTsc1 );
+        }
+
+        return (double)(llTsc1 - llTsc0) * fOsFrequency / (double)(llOs1 - llOs0);
+#else
+        return 0.0;
+#endif
+    }
+
+    long long CpuClock::MeasureOverhead()
+    {
+        std::vector<long long> samples( kOverheadSamples );
+
+        // warm up the code path and, for the OS clocks, the vDSO / kernel page
+        for (int i = 0; i < 100; ++i)
+        {
+            Now();
+        }
+
+        for (int i = 0; i < kOverheadSamples; ++i)
+        {
+            long long llStart = Now();
+            long long llStop = Now();
+            samples[i] = llStop - llStart;
+        }
+
+        // the median, so interrupts in a few samples don't count
+        std::nth_element( samples.begin(), samples.begin() + kOverheadSamples / 2, samples.end() );
+        return (samples[kOverheadSamples / 2] > 0) ? samples[kOverheadSamples / 2] : 0;
+    }
+
+} // namespace AMD
@@ -0,0 +1,133 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: CpuClock.h
+//
+// The CPU clock used by the timers. There are three backends:
+//   - QPC:        QueryPerformanceCounter, Windows only
+//   - Monotonic:  clock_gettime( CLOCK_MONOTONIC ), everywhere else
+//   - TSC:        the x86 time stamp counter, read with rdtsc, if the CPU reports an
+//                 invariant TSC. Its frequency is calibrated against QPC or the monotonic
+//                 clock the first time it is used.
+//
+// The backend is picked on first use: the TSC if it is invariant, otherwise the OS clock.
+// SetBackend overrides that, but must be called before any timing is done, since ticks of
+// different backends can't be mixed.
+//
+// GetOverheadTicks is the median time between two back to back reads, i.e. what an empty
+// scope measures. CpuTimer subtracts it from every interval it measures.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_CPU_CLOCK_H
+#define AMD_SDK_CPU_CLOCK_H
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define AMD_CPU_CLOCK_HAVE_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define AMD_CPU_CLOCK_HAVE_TSC 0
+#endif
+
+namespace AMD
+{
+    class CpuClock
+    {
+    public:
+
+        enum Backend
+        {
+            BACKEND_AUTO,       // pick the best supported backend
+            BACKEND_QPC,
+            BACKEND_MONOTONIC,
+            BACKEND_TSC,
+            BACKEND_COUNT
+        };
+
+        // Current time in ticks of the selected backend
+        static long long Now()
+        {
+            switch (s_Backend)
+            {
+#if AMD_CPU_CLOCK_HAVE_TSC
+            case BACKEND_TSC:
+                return (long long)__rdtsc();
+#endif
+#if defined(_WIN32)
+            case BACKEND_QPC:
+                {
+                    LARGE_INTEGER t;
+                    QueryPerformanceCounter( &t );
+                    return t.QuadPart;
+                }
+#else
+            case BACKEND_MONOTONIC:
+                {
+                    timespec t;
+                    clock_gettime( CLOCK_MONOTONIC, &t );
+                    return (long long)t.tv_sec * 1000000000LL + t.tv_nsec;
+                }
+#endif
+            default:
+                return NowUninitialized();
+            }
+        }
+
+        static double GetFrequency() { Initialize(); return s_fFrequency; }
+        static double GetSecondsPerTick() { Initialize(); return s_fSecondsPerTick; }
+        static long long GetOverheadTicks() { Initialize(); return s_llOverheadTicks; }
+        static double TicksToSeconds( long long llTicks ) { return (double)llTicks * GetSecondsPerTick(); }
+
+        // Selects a backend and measures its overhead. Returns false, and keeps the current
+        // backend, if it isn't supported
+        static bool SetBackend( Backend backend );
+        static Backend GetBackend() { Initialize(); return (Backend)s_Backend; }
+        static bool IsSupported( Backend backend );
+        static const wchar_t* GetBackendName( Backend backend );
+
+    private:
+
+        static void Initialize() { if (BACKEND_AUTO == s_Backend) { SetBackend( BACKEND_AUTO ); } }
+        static long long NowUninitialized();
+
+        static double CalibrateTsc();
+        static long long MeasureOverhead();
+
+        static volatile int     s_Backend;      // BACKEND_AUTO until the first use
+        static double           s_fFrequency;
+        static double           s_fSecondsPerTick;
+        static long long        s_llOverheadTicks;
+        static double           s_fTscFrequency; // 0 until calibrated
+    };
+
+} // namespace AMD
+
+#endif
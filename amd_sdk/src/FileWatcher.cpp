@@ -0,0 +1,544 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: FileWatcher.cpp
+//
+// Implementation of the debounced directory watcher.
+//--------------------------------------------------------------------------------------
+#include "FileWatcher.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <ctype.h>
+
+using namespace AMD;
+
+namespace
+{
+    const unsigned int kuWaitForever = 0xFFFFFFFF;
+
+#ifdef _WIN32
+    const DWORD kdwNotifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+
+    DWORD WINAPI FileWatcher_ThreadProc_( void* pParameter )
+    {
+        ((FileWatcher*)pParameter)->WatchThreadProc();
+        return 0;
+    }
+#else
+    const uint32_t kuNotifyMask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+    void* FileWatcher_ThreadProc_( void* pParameter )
+    {
+        ((FileWatcher*)pParameter)->WatchThreadProc();
+        return NULL;
+    }
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------
+// Constructor
+//--------------------------------------------------------------------------------------
+FileWatcher::FileWatcher()
+    : m_pfnOnChanges( NULL )
+    , m_pUserData( NULL )
+    , m_uDebounceMs( 0 )
+    , m_uLastChangeMs( 0 )
+    , m_bRunning( false )
+#ifdef _WIN32
+    , m_hDirectory( INVALID_HANDLE_VALUE )
+    , m_hStopEvent( NULL )
+    , m_hThread( NULL )
+#else
+    , m_iNotifyFd( -1 )
+#endif
+{
+#ifndef _WIN32
+    m_StopPipe[0] = -1;
+    m_StopPipe[1] = -1;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------
+// Destructor
+//--------------------------------------------------------------------------------------
+FileWatcher::~FileWatcher()
+{
+    Stop();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Starts watching a directory tree
+//--------------------------------------------------------------------------------------
+bool FileWatcher::Start( const char* pszDirectory, PFN_ON_CHANGES pfnOnChanges, void* pUserData, unsigned int uDebounceMs )
+{
+    Stop();
+
+    m_Directory = pszDirectory;
+    m_pfnOnChanges = pfnOnChanges;
+    m_pUserData = pUserData;
+    m_uDebounceMs = uDebounceMs;
+    m_PendingChanges.clear();
+
+#ifdef _WIN32
+    m_hDirectory = CreateFileA( pszDirectory, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL );
+    if (m_hDirectory == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    m_hStopEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+    m_hThread = CreateThread( NULL, 0, FileWatcher_ThreadProc_, this, 0, NULL );
+    if ((NULL == m_hStopEvent) || (NULL == m_hThread))
+    {
+        Stop();
+        return false;
+    }
+#else
+    m_iNotifyFd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if ((m_iNotifyFd < 0) || (pipe( m_StopPipe ) != 0))
+    {
+        Stop();
+        return false;
+    }
+
+    AddWatches( "" );
+    if (m_WatchDirs.empty() || (pthread_create( &m_Thread, NULL, FileWatcher_ThreadProc_, this ) != 0))
+    {
+        Stop();
+        return false;
+    }
+#endif
+
+    m_bRunning = true;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Stops watching, and waits for the watcher thread to finish
+//--------------------------------------------------------------------------------------
+void FileWatcher::Stop()
+{
+#ifdef _WIN32
+    if (NULL != m_hThread)
+    {
+        SetEvent( m_hStopEvent );
+        WaitForSingleObject( m_hThread, INFINITE );
+        CloseHandle( m_hThread );
+        m_hThread = NULL;
+    }
+
+    if (NULL != m_hStopEvent)
+    {
+        CloseHandle( m_hStopEvent );
+        m_hStopEvent = NULL;
+    }
+
+    if (m_hDirectory != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle( m_hDirectory );
+        m_hDirectory = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_bRunning)
+    {
+        const char cStop = 0;
+        if (write( m_StopPipe[1], &cStop, 1 ) == 1)
+        {
+            pthread_join( m_Thread, NULL );
+        }
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (m_StopPipe[i] >= 0)
+        {
+            close( m_StopPipe[i] );
+            m_StopPipe[i] = -1;
+        }
+    }
+
+    if (m_iNotifyFd >= 0)
+    {
+        close( m_iNotifyFd );
+        m_iNotifyFd = -1;
+    }
+
+    m_WatchDirs.clear();
+#endif
+
+    m_bRunning = false;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Records a changed file, and restarts the debounce period
+//--------------------------------------------------------------------------------------
+void FileWatcher::AddChange( const std::string& i_RelativePath )
+{
+    m_PendingChanges.insert( i_RelativePath );
+    m_uLastChangeMs = GetTimeMs();
+}
+
+
+//--------------------------------------------------------------------------------------
+// How long to wait before the pending changes should be reported
+//--------------------------------------------------------------------------------------
+unsigned int FileWatcher::GetDebounceWait()
+{
+    if (m_PendingChanges.empty())
+    {
+        return kuWaitForever;
+    }
+
+    const unsigned int kuElapsed = GetTimeMs() - m_uLastChangeMs;
+    return (kuElapsed >= m_uDebounceMs) ? 0 : (m_uDebounceMs - kuElapsed);
+}
+
+
+//--------------------------------------------------------------------------------------
+// Reports the pending changes as one batch
+//--------------------------------------------------------------------------------------
+void FileWatcher::FlushChanges()
+{
+    if (m_PendingChanges.empty())
+    {
+        return;
+    }
+
+    std::vector<std::string> changes( m_PendingChanges.begin(), m_PendingChanges.end() );
+    m_PendingChanges.clear();
+
+    if (m_pfnOnChanges)
+    {
+        m_pfnOnChanges( changes, m_pUserData );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Millisecond clock used for debouncing
+//--------------------------------------------------------------------------------------
+unsigned int FileWatcher::GetTimeMs()
+{
+#ifdef _WIN32
+    return (unsigned int)GetTickCount();
+#else
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (unsigned int)((unsigned long long)now.tv_sec * 1000ULL + (unsigned long long)now.tv_nsec / 1000000ULL);
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------
+// The watcher thread: collects changes, and reports them once things have gone quiet
+//--------------------------------------------------------------------------------------
+#ifdef _WIN32
+void FileWatcher::WatchThreadProc()
+{
+    // ReadDirectoryChangesW needs a DWORD aligned buffer
+    DWORD buffer[16 * 1024];
+
+    OVERLAPPED overlapped;
+    memset( &overlapped, 0, sizeof( overlapped ) );
+    overlapped.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+
+    bool bReadPending = false;
+
+    for (;;)
+    {
+        if (!bReadPending)
+        {
+            ResetEvent( overlapped.hEvent );
+            if (!ReadDirectoryChangesW( m_hDirectory, buffer, sizeof( buffer ), TRUE, kdwNotifyFilter, NULL, &overlapped, NULL ))
+            {
+                break;
+            }
+            bReadPending = true;
+        }
+
+        HANDLE handles[2] = { m_hStopEvent, overlapped.hEvent };
+        const DWORD kdwWait = WaitForMultipleObjects( 2, handles, FALSE, GetDebounceWait() );
+
+        if (kdwWait == WAIT_OBJECT_0)
+        {
+            break;
+        }
+
+        if (kdwWait == WAIT_OBJECT_0 + 1)
+        {
+            bReadPending = false;
+
+            DWORD dwBytes = 0;
+            if (GetOverlappedResult( m_hDirectory, &overlapped, &dwBytes, FALSE ))
+            {
+                if (dwBytes == 0)
+                {
+                    // The buffer overflowed, so the changes were lost
+                    AddChange( "" );
+                }
+                else
+                {
+                    const BYTE* pEntry = (const BYTE*)buffer;
+                    for (;;)
+                    {
+                        const FILE_NOTIFY_INFORMATION* pInfo = (const FILE_NOTIFY_INFORMATION*)pEntry;
+                        const int kiNameLength = (int)(pInfo->FileNameLength / sizeof( WCHAR ));
+
+                        int iLength = WideCharToMultiByte( CP_ACP, 0, pInfo->FileName, kiNameLength, NULL, 0, NULL, NULL );
+                        std::string name( (size_t)iLength, '\0' );
+                        if (iLength > 0)
+                        {
+                            WideCharToMultiByte( CP_ACP, 0, pInfo->FileName, kiNameLength, &name[0], iLength, NULL, NULL );
+                        }
+                        AddChange( name );
+
+                        if (pInfo->NextEntryOffset == 0)
+                        {
+                            break;
+                        }
+                        pEntry += pInfo->NextEntryOffset;
+                    }
+                }
+            }
+        }
+
+        if (GetDebounceWait() == 0)
+        {
+            FlushChanges();
+        }
+    }
+
+    if (bReadPending)
+    {
+        DWORD dwBytes = 0;
+        CancelIo( m_hDirectory );
+        GetOverlappedResult( m_hDirectory, &overlapped, &dwBytes, TRUE );
+    }
+
+    CloseHandle( overlapped.hEvent );
+}
+#else
+void FileWatcher::WatchThreadProc()
+{
+    union
+    {
+        struct inotify_event    m_Event;
+        char                    m_Bytes[64 * 1024];
+    } buffer;
+
+    struct pollfd fds[2];
+    fds[0].fd = m_iNotifyFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = m_StopPipe[0];
+    fds[1].events = POLLIN;
+
+    for (;;)
+    {
+        const unsigned int kuWait = GetDebounceWait();
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+
+        const int kiResult = poll( fds, 2, (kuWait == kuWaitForever) ? -1 : (int)kuWait );
+        if ((kiResult < 0) && (errno != EINTR))
+        {
+            break;
+        }
+
+        if (fds[1].revents)
+        {
+            break;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            ssize_t iBytes;
+            while ((iBytes = read( m_iNotifyFd, buffer.m_Bytes, sizeof( buffer ) )) > 0)
+            {
+                for (ssize_t iOffset = 0; iOffset < iBytes; )
+                {
+                    const struct inotify_event* pEvent = (const struct inotify_event*)(buffer.m_Bytes + iOffset);
+                    iOffset += (ssize_t)(sizeof( struct inotify_event ) + pEvent->len);
+
+                    if (pEvent->mask & IN_Q_OVERFLOW)
+                    {
+                        AddChange( "" );
+                        continue;
+                    }
+
+                    std::map<int, std::string>::iterator it = m_WatchDirs.find( pEvent->wd );
+                    if (it == m_WatchDirs.end())
+                    {
+                        continue;
+                    }
+
+                    if (pEvent->mask & IN_IGNORED)
+                    {
+                        m_WatchDirs.erase( it );
+                        continue;
+                    }
+
+                    if (pEvent->len == 0)
+                    {
+                        continue;
+                    }
+
+                    const std::string kName = it->second.empty() ? std::string( pEvent->name ) : (it->second + "/" + pEvent->name);
+                    if (pEvent->mask & IN_ISDIR)
+                    {
+                        // Watch new directories too
+                        if (pEvent->mask & (IN_CREATE | IN_MOVED_TO))
+                        {
+                            AddWatches( kName );
+                        }
+                    }
+                    else
+                    {
+                        AddChange( kName );
+                    }
+                }
+            }
+        }
+
+        if (GetDebounceWait() == 0)
+        {
+            FlushChanges();
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// inotify isn't recursive, so each directory in the tree gets its own watch
+//--------------------------------------------------------------------------------------
+void FileWatcher::AddWatches( const std::string& i_RelativeDir )
+{
+    const std::string kFullDir = i_RelativeDir.empty() ? m_Directory : (m_Directory + "/" + i_RelativeDir);
+
+    const int kiWatch = inotify_add_watch( m_iNotifyFd, kFullDir.c_str(), kuNotifyMask );
+    if (kiWatch < 0)
+    {
+        return;
+    }
+    m_WatchDirs[kiWatch] = i_RelativeDir;
+
+    DIR* pDir = opendir( kFullDir.c_str() );
+    if (!pDir)
+    {
+        return;
+    }
+
+    struct dirent* pEntry;
+    while ((pEntry = readdir( pDir )) != NULL)
+    {
+        const std::string kName( pEntry->d_name );
+        if ((kName == ".") || (kName == ".."))
+        {
+            continue;
+        }
+
+        struct stat status;
+        const std::string kFullName = kFullDir + "/" + kName;
+        if ((stat( kFullName.c_str(), &status ) == 0) && S_ISDIR( status.st_mode ))
+        {
+            AddWatches( i_RelativeDir.empty() ? kName : (i_RelativeDir + "/" + kName) );
+        }
+    }
+
+    closedir( pDir );
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------
+// Returns a path in canonical form
+//--------------------------------------------------------------------------------------
+std::string FileWatcher::NormalizePath( const std::string& i_Path )
+{
+    // Keep any leading separators (absolute or UNC paths) as they are
+    size_t uStart = 0;
+    while ((uStart < i_Path.size()) && ((i_Path[uStart] == '/') || (i_Path[uStart] == '\\')))
+    {
+        uStart++;
+    }
+
+    std::vector<std::string> parts;
+    std::string part;
+    for (size_t i = uStart; i <= i_Path.size(); i++)
+    {
+        if ((i == i_Path.size()) || (i_Path[i] == '/') || (i_Path[i] == '\\'))
+        {
+            if (part == "..")
+            {
+                if (!parts.empty() && (parts.back() != ".."))
+                {
+                    parts.pop_back();
+                }
+                else if (uStart == 0)
+                {
+                    parts.push_back( part );
+                }
+            }
+            else if (!part.empty() && (part != "."))
+            {
+                parts.push_back( part );
+            }
+            part.clear();
+        }
+        else
+        {
+#ifdef _WIN32
+            part += (char)tolower( (unsigned char)i_Path[i] );
+#else
+            part += i_Path[i];
+#endif
+        }
+    }
+
+    std::string result( uStart, '/' );
+    for (size_t i = 0; i < parts.size(); i++)
+    {
+        if (i)
+        {
+            result += '/';
+        }
+        result += parts[i];
+    }
+    return result;
+}
@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: FileWatcher.h
+//
+// Watches a directory tree for changed files, using ReadDirectoryChangesW on Windows and
+// inotify on Linux. Changes are debounced: editors often write a file several times per
+// save (or save several files at once), so changes are collected until the directory has
+// been quiet for a short while, and then reported as one batch.
+//
+// The callback is made on the watcher's own thread, with paths relative to the watched
+// directory. An empty path in the batch means events were lost (the OS buffer overflowed),
+// so anything in the directory may have changed.
+//
+// This file has no D3D dependencies.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_FILE_WATCHER_H
+#define AMD_SDK_FILE_WATCHER_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+namespace AMD
+{
+    class FileWatcher
+    {
+    public:
+
+        typedef void (*PFN_ON_CHANGES)( const std::vector<std::string>& i_ChangedFiles, void* pUserData );
+
+        FileWatcher();
+        ~FileWatcher();
+
+        // Starts watching pszDirectory (and its subdirectories)
+        bool Start( const char* pszDirectory, PFN_ON_CHANGES pfnOnChanges, void* pUserData, unsigned int uDebounceMs = 250 );
+
+        // Stops watching; no callbacks are made after this returns
+        void Stop();
+
+        bool IsRunning() const { return m_bRunning; }
+        const std::string& GetDirectory() const { return m_Directory; }
+
+        // Returns a path in a canonical form, so that paths from the watcher and from the
+        // preprocessor can be compared: separators unified, "." and ".." resolved, and on
+        // Windows, lower case
+        static std::string NormalizePath( const std::string& i_Path );
+
+        // Do not call this function
+        void WatchThreadProc();
+
+    private:
+
+        void AddChange( const std::string& i_RelativePath );
+        unsigned int GetDebounceWait();
+        void FlushChanges();
+        static unsigned int GetTimeMs();
+
+#ifndef _WIN32
+        void AddWatches( const std::string& i_RelativeDir );
+#endif
+
+        std::string                 m_Directory;
+        std::set<std::string>       m_PendingChanges;
+        PFN_ON_CHANGES              m_pfnOnChanges;
+        void*                       m_pUserData;
+        unsigned int                m_uDebounceMs;
+        unsigned int                m_uLastChangeMs;
+        bool                        m_bRunning;
+
+#ifdef _WIN32
+        void*                       m_hDirectory;
+        void*                       m_hStopEvent;
+        void*                       m_hThread;
+#else
+        int                         m_iNotifyFd;
+        int                         m_StopPipe[2];
+        pthread_t                   m_Thread;
+        std::map<int, std::string>  m_WatchDirs;
+#endif
+    };
+
+} // namespace AMD
+
+#endif
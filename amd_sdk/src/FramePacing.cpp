@@ -0,0 +1,286 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: FramePacing.cpp
+//
+// Frame interval recording, rolling median / MAD stutter detection and the JSON report.
+//--------------------------------------------------------------------------------------
+#include "..\\..\\DXUT\\Core\\DXUT.h"
+#include "CpuClock.h"
+#include "FramePacing.h"
+
+#include <algorithm>
+
+namespace
+{
+    // scales the MAD to the standard deviation of a normal distribution
+    const float kMadToSigma = 1.4826f;
+
+    // frames needed in the window before stutter is detected
+    const unsigned int kMinWindow = 16;
+
+    const unsigned long long kInvalidFrame = ~0ull;
+
+    float Median( std::vector<float>& io_Values )
+    {
+        std::vector<float>::iterator mid = io_Values.begin() + io_Values.size() / 2;
+        std::nth_element( io_Values.begin(), mid, io_Values.end() );
+        return *mid;
+    }
+
+    void WriteFlags( FILE* pFile, unsigned int uFlags )
+    {
+        static const struct { unsigned int m_uFlag; const char* m_pszName; } kFlagNames[] =
+        {
+            { AMD::FramePacing::FLAG_RESIZE,        "resize" },
+            { AMD::FramePacing::FLAG_MODE_SWITCH,   "mode_switch" },
+            { AMD::FramePacing::FLAG_DEVICE_CHANGE, "device_change" },
+        };
+
+        fprintf( pFile, "[" );
+        bool bFirst = true;
+        for (size_t i = 0; i < ARRAYSIZE( kFlagNames ); i++)
+        {
+            if (uFlags & kFlagNames[i].m_uFlag)
+            {
+                fprintf( pFile, "%s\"%s\"", bFirst ? "" : ", ", kFlagNames[i].m_pszName );
+                bFirst = false;
+            }
+        }
+        fprintf( pFile, "]" );
+    }
+}
+
+namespace AMD
+{
+    //--------------------------------------------------------------------------------------
+    // Constructor
+    //--------------------------------------------------------------------------------------
+    FramePacing::FramePacing( unsigned int uHistory, unsigned int uWindow )
+        : m_fMadScale( 4.0f )
+        , m_fMinRatio( 1.25f )
+    {
+        m_History.resize( std::max( uHistory, 1u ) );
+        m_Window.resize( std::max( uWindow, kMinWindow ) );
+        m_Scratch.reserve( m_Window.size() );
+
+        Reset();
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // Destructor
+    //--------------------------------------------------------------------------------------
+    FramePacing::~FramePacing()
+    {
+    }
+
+
+    void FramePacing::SetStutterThreshold( float fMadScale, float fMinRatio )
+    {
+        m_fMadScale = fMadScale;
+        m_fMinRatio = fMinRatio;
+    }
+
+
+    void FramePacing::Reset()
+    {
+        for (size_t i = 0; i < m_History.size(); i++)
+        {
+            m_History[i].m_ullNumber = kInvalidFrame;
+        }
+
+        m_ullNumFrames = 0;
+        m_llLastTicks = 0;
+        m_uWindowCount = 0;
+        m_uWindowPos = 0;
+        m_fMedianMs = 0.0f;
+        m_fMadMs = 0.0f;
+        m_fLastIntervalMs = 0.0f;
+        m_uPendingFlags = 0;
+        m_uNumStutters = 0;
+        m_uNumFlaggedStutters = 0;
+        m_Summary[0] = 0;
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // Records the interval since the last call. The frame is judged against the baseline of
+    // the frames before it, and only then added to the window, so a spike doesn't raise its
+    // own threshold
+    //--------------------------------------------------------------------------------------
+    void FramePacing::OnFrame()
+    {
+        long long llNow = CpuClock::Now();
+        if (0 == m_llLastTicks)
+        {
+            m_llLastTicks = llNow;
+            return;
+        }
+
+        float fIntervalMs = (float)(CpuClock::TicksToSeconds( llNow - m_llLastTicks ) * 1000.0);
+        m_llLastTicks = llNow;
+
+        Frame& frame = m_History[m_ullNumFrames % m_History.size()];
+        frame.m_ullNumber = m_ullNumFrames;
+        frame.m_fIntervalMs = fIntervalMs;
+        frame.m_fMedianMs = m_fMedianMs;
+        frame.m_fMadMs = m_fMadMs;
+        frame.m_uFlags = m_uPendingFlags;
+        frame.m_bStutter = false;
+
+        if (m_uWindowCount >= kMinWindow)
+        {
+            float fThresholdMs = std::max( m_fMedianMs + m_fMadScale * kMadToSigma * m_fMadMs, m_fMedianMs * m_fMinRatio );
+            if (fIntervalMs > fThresholdMs)
+            {
+                frame.m_bStutter = true;
+                ++m_uNumStutters;
+                if (0 != frame.m_uFlags)
+                {
+                    ++m_uNumFlaggedStutters;
+                }
+            }
+        }
+
+        if (0 == frame.m_uFlags)
+        {
+            m_Window[m_uWindowPos] = fIntervalMs;
+            m_uWindowPos = (m_uWindowPos + 1) % (unsigned int)m_Window.size();
+            m_uWindowCount = std::min( m_uWindowCount + 1, (unsigned int)m_Window.size() );
+            UpdateBaseline();
+        }
+
+        m_fLastIntervalMs = fIntervalMs;
+        m_uPendingFlags = 0;
+        ++m_ullNumFrames;
+    }
+
+
+    void FramePacing::UpdateBaseline()
+    {
+        m_Scratch.assign( m_Window.begin(), m_Window.begin() + m_uWindowCount );
+        m_fMedianMs = Median( m_Scratch );
+
+        for (size_t i = 0; i < m_Scratch.size(); i++)
+        {
+            m_Scratch[i] = fabsf( m_Scratch[i] - m_fMedianMs );
+        }
+        m_fMadMs = Median( m_Scratch );
+    }
+
+
+    const wchar_t* FramePacing::GetSummary()
+    {
+        swprintf_s( m_Summary, L"Frame pacing: median %.2f ms, MAD %.2f ms, %u stutters (%u flagged)",
+            m_fMedianMs, m_fMadMs, m_uNumStutters, m_uNumFlaggedStutters );
+        return m_Summary;
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // Writes the recorded history as JSON: a summary, every stuttering or flagged frame,
+    // and all intervals in order
+    //--------------------------------------------------------------------------------------
+    bool FramePacing::WriteReport( const wchar_t* pwsPath ) const
+    {
+        FILE* pFile = NULL;
+        _wfopen_s( &pFile, pwsPath, L"wt" );
+        if (!pFile)
+        {
+            return false;
+        }
+
+        // the recorded frames, oldest first
+        std::vector<const Frame*> frames;
+        const unsigned long long ullFirst = (m_ullNumFrames > m_History.size()) ? m_ullNumFrames - m_History.size() : 0;
+        for (unsigned long long ullFrame = ullFirst; ullFrame < m_ullNumFrames; ullFrame++)
+        {
+            frames.push_back( &m_History[ullFrame % m_History.size()] );
+        }
+
+        std::vector<float> intervals;
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            intervals.push_back( frames[i]->m_fIntervalMs );
+        }
+        std::sort( intervals.begin(), intervals.end() );
+
+        struct Percentile
+        {
+            static float Get( const std::vector<float>& i_Sorted, double fPercentile )
+            {
+                if (i_Sorted.empty())
+                {
+                    return 0.0f;
+                }
+                size_t uRank = (size_t)ceil( fPercentile * 0.01 * (double)i_Sorted.size() );
+                return i_Sorted[std::min( std::max( uRank, (size_t)1 ), i_Sorted.size() ) - 1];
+            }
+        };
+
+        fprintf( pFile, "{\n" );
+        fprintf( pFile, "\"frames\": %llu,\n", m_ullNumFrames );
+        fprintf( pFile, "\"history_frames\": %u,\n", (unsigned int)frames.size() );
+        fprintf( pFile, "\"median_ms\": %.4f,\n", m_fMedianMs );
+        fprintf( pFile, "\"mad_ms\": %.4f,\n", m_fMadMs );
+        fprintf( pFile, "\"p50_ms\": %.4f,\n", Percentile::Get( intervals, 50.0 ) );
+        fprintf( pFile, "\"p95_ms\": %.4f,\n", Percentile::Get( intervals, 95.0 ) );
+        fprintf( pFile, "\"p99_ms\": %.4f,\n", Percentile::Get( intervals, 99.0 ) );
+        fprintf( pFile, "\"max_ms\": %.4f,\n", intervals.empty() ? 0.0f : intervals.back() );
+        fprintf( pFile, "\"stutter_threshold\": { \"mad_scale\": %.3f, \"min_ratio\": %.3f },\n", m_fMadScale, m_fMinRatio );
+        fprintf( pFile, "\"stutters\": %u,\n", m_uNumStutters );
+        fprintf( pFile, "\"flagged_stutters\": %u,\n", m_uNumFlaggedStutters );
+
+        fprintf( pFile, "\"events\": [" );
+        bool bFirst = true;
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            const Frame& frame = *frames[i];
+            if (!frame.m_bStutter && 0 == frame.m_uFlags)
+            {
+                continue;
+            }
+
+            fprintf( pFile, "%s\n{ \"frame\": %llu, \"interval_ms\": %.4f, \"median_ms\": %.4f, \"mad_ms\": %.4f, \"stutter\": %s, \"flags\": ",
+                bFirst ? "" : ",", frame.m_ullNumber, frame.m_fIntervalMs, frame.m_fMedianMs, frame.m_fMadMs, frame.m_bStutter ? "true" : "false" );
+            WriteFlags( pFile, frame.m_uFlags );
+            fprintf( pFile, " }" );
+            bFirst = false;
+        }
+        fprintf( pFile, "\n],\n" );
+
+        fprintf( pFile, "\"first_frame\": %llu,\n", ullFirst );
+        fprintf( pFile, "\"intervals_ms\": [" );
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            fprintf( pFile, "%s%.3f", (0 == i) ? "" : (0 == i % 16) ? ",\n" : ", ", frames[i]->m_fIntervalMs );
+        }
+        fprintf( pFile, "]\n}\n" );
+
+        bool bOk = (0 == ferror( pFile ));
+        fclose( pFile );
+        return bOk;
+    }
+
+} // namespace AMD
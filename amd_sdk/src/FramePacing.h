@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: FramePacing.h
+//
+// Records the interval between consecutive frames in a ring buffer, and detects stutter
+// against a rolling median and median absolute deviation (MAD) of the recent frames.
+//
+// A frame stutters when its interval exceeds both median + scale * MAD (the MAD scaled to
+// a standard deviation) and median * ratio, so perfectly paced frames with a MAD of 0
+// don't turn every bit of jitter into a stutter.
+//
+// Frames can be flagged, e.g. when the render targets were recreated for a resize or a
+// mode switch. Flagged frames are reported, but are kept out of the rolling window, so
+// an expected hitch doesn't skew the baseline. The history can be written as JSON.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_FRAME_PACING_H
+#define AMD_SDK_FRAME_PACING_H
+
+#include <vector>
+
+namespace AMD
+{
+    class FramePacing
+    {
+    public:
+
+        enum Flags
+        {
+            FLAG_RESIZE         = 1 << 0,   // the swap chain or render targets were resized
+            FLAG_MODE_SWITCH    = 1 << 1,   // a setting changed that recreated resources, e.g. the AA mode
+            FLAG_DEVICE_CHANGE  = 1 << 2,   // the device was recreated
+        };
+
+        // Keeps uHistory frames, and computes the median and MAD over the last uWindow unflagged frames
+        FramePacing( unsigned int uHistory = 1024, unsigned int uWindow = 120 );
+        ~FramePacing();
+
+        // Call once per frame, at the same point in the frame, e.g. at the start of the frame
+        // render callback. The intervals are then present to present
+        void OnFrame();
+
+        // Flags the frame in progress. Flags of consecutive calls accumulate
+        void MarkFrame( unsigned int uFlags ) { m_uPendingFlags |= uFlags; }
+
+        // A frame stutters when its interval exceeds median + fMadScale * 1.4826 * MAD and median * fMinRatio
+        void SetStutterThreshold( float fMadScale, float fMinRatio );
+
+        // Forgets all frames, e.g. after a pause
+        void Reset();
+
+        unsigned long long GetNumFrames() const { return m_ullNumFrames; }
+        unsigned int GetNumStutters() const { return m_uNumStutters; }
+        unsigned int GetNumFlaggedStutters() const { return m_uNumFlaggedStutters; }
+        float GetLastIntervalMs() const { return m_fLastIntervalMs; }
+        float GetMedianMs() const { return m_fMedianMs; }
+        float GetMadMs() const { return m_fMadMs; }
+
+        // One line summary for a HUD
+        const wchar_t* GetSummary();
+
+        bool WriteReport( const wchar_t* pwsPath ) const;
+
+    private:
+
+        struct Frame
+        {
+            unsigned long long  m_ullNumber;
+            float               m_fIntervalMs;
+            float               m_fMedianMs;    // of the window before this frame
+            float               m_fMadMs;
+            unsigned int        m_uFlags;
+            bool                m_bStutter;
+        };
+
+        void UpdateBaseline();
+
+        std::vector<Frame>          m_History;
+        unsigned long long          m_ullNumFrames;     // frames recorded, m_History holds the last ones
+        long long                   m_llLastTicks;      // CpuClock ticks of the last OnFrame, 0 before the first
+
+        std::vector<float>          m_Window;           // ring of the last unflagged intervals
+        unsigned int                m_uWindowCount;
+        unsigned int                m_uWindowPos;
+        std::vector<float>          m_Scratch;
+
+        float                       m_fMadScale;
+        float                       m_fMinRatio;
+        float                       m_fMedianMs;
+        float                       m_fMadMs;
+        float                       m_fLastIntervalMs;
+        unsigned int                m_uPendingFlags;
+        unsigned int                m_uNumStutters;
+        unsigned int                m_uNumFlaggedStutters;
+
+        wchar_t                     m_Summary[128];
+    };
+
+} // namespace AMD
+
+#endif
@@ -0,0 +1,296 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+//--------------------------------------------------------------------------------------
+// File: GpuTimestampRing.cpp
+//
+// The ring of in-flight GpuTimer intervals; this file doesn't depend on DXUT or D3D.
+//--------------------------------------------------------------------------------------
+#include "GpuTimestampRing.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+namespace AMD
+{
+    //--------------------------------------------------------------------------------------
+    // Constructor
+    //--------------------------------------------------------------------------------------
+    GpuTimestampRing::GpuTimestampRing( GpuTimestampBackend* pBackend, unsigned int uNumTimeStamps )
+        : m_pBackend( pBackend )
+        , m_uNumTimeStamps( uNumTimeStamps )
+        , m_pRecords( NULL )
+        , m_uIssue( uNumTimeStamps - 1 )
+        , m_uRetrieve( 0 )
+        , m_uFrameId( 0 )
+        , m_uCurFrameId( FrameIdMask )
+        , m_bCurFrameInvalid( true )
+        , m_fCurFrameTime( 0.0 )
+        , m_pfnOnFrame( NULL )
+        , m_pOnFrameData( NULL )
+        , m_pfnOnTimestamps( NULL )
+        , m_pOnTimestampsData( NULL )
+        , m_ullNextTag( 0 )
+        , m_uNumGrowths( 0 )
+        , m_uNumStalls( 0 )
+        , m_uLatencyFrames( 0 )
+        , m_uMaxLatencyFrames( 0 )
+    {
+        assert( pBackend != NULL );
+        assert( uNumTimeStamps > 0 );
+
+        m_pRecords = new Record[m_uNumTimeStamps];
+        CreateRecords( m_pRecords, 0, m_uNumTimeStamps );
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // Destructor
+    //--------------------------------------------------------------------------------------
+    GpuTimestampRing::~GpuTimestampRing()
+    {
+        for (unsigned int i = 0; i < m_uNumTimeStamps; i++)
+        {
+            m_pBackend->DestroyInterval( m_pRecords[i].m_pInterval );
+        }
+        delete[] m_pRecords;
+    }
+
+
+    void GpuTimestampRing::SetFrameCallback( PFN_ON_FRAME pfnOnFrame, void* pUserData )
+    {
+        m_pfnOnFrame = pfnOnFrame;
+        m_pOnFrameData = pUserData;
+    }
+
+
+    void GpuTimestampRing::SetTimestampCallback( PFN_ON_TIMESTAMPS pfnOnTimestamps, void* pUserData )
+    {
+        m_pfnOnTimestamps = pfnOnTimestamps;
+        m_pOnTimestampsData = pUserData;
+    }
+
+
+    void GpuTimestampRing::CreateRecords( Record* pRecords, unsigned int uFirst, unsigned int uCount )
+    {
+        for (unsigned int i = uFirst; i < uFirst + uCount; i++)
+        {
+            pRecords[i].m_pInterval = m_pBackend->CreateInterval();
+            assert( pRecords[i].m_pInterval != NULL );
+
+            pRecords[i].m_uFrameId = 0;
+            pRecords[i].m_uStartIssued = 0;
+            pRecords[i].m_uStopIssued = 0;
+            pRecords[i].m_ullTag = 0;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // Only called when every record is in flight. The records are moved to the start of a
+    // larger ring, oldest first, so they are still collected in the order they were issued
+    //--------------------------------------------------------------------------------------
+    bool GpuTimestampRing::Grow()
+    {
+        if (m_uNumTimeStamps >= MaxTimeStamps)
+        {
+            return false;
+        }
+
+        unsigned int uNumTimeStamps = (m_uNumTimeStamps * 2 < MaxTimeStamps) ? m_uNumTimeStamps * 2 : MaxTimeStamps;
+        Record* pRecords = new Record[uNumTimeStamps];
+
+        for (unsigned int i = 0; i < m_uNumTimeStamps; i++)
+        {
+            pRecords[i] = m_pRecords[(m_uRetrieve + i) % m_uNumTimeStamps];
+        }
+        CreateRecords( pRecords, m_uNumTimeStamps, uNumTimeStamps - m_uNumTimeStamps );
+
+        delete[] m_pRecords;
+        m_pRecords = pRecords;
+        m_uIssue = m_uNumTimeStamps - 1;
+        m_uRetrieve = 0;
+        m_uNumTimeStamps = uNumTimeStamps;
+        ++m_uNumGrowths;
+
+        return true;
+    }
+
+
+    void GpuTimestampRing::Start()
+    {
+        unsigned int uNext = (m_uIssue + 1 == m_uNumTimeStamps) ? 0 : m_uIssue + 1;
+
+        if (0 != m_pRecords[uNext].m_uStartIssued)
+        {
+            // the oldest record is still in flight: take whatever results are in, and if that
+            // doesn't free it, grow the ring rather than wait for the GPU
+            FinishCollection();
+
+            if (0 != m_pRecords[uNext].m_uStartIssued)
+            {
+                if (Grow())
+                {
+                    uNext = m_uIssue + 1;
+                }
+                else
+                {
+                    ++m_uNumStalls;
+                    Collect( uNext, true );
+                    Retire();
+                }
+            }
+        }
+
+        m_uIssue = uNext;
+        Record& record = m_pRecords[m_uIssue];
+        record.m_uFrameId = m_uFrameId;
+        record.m_uStartIssued = 1;
+        record.m_uStopIssued = 0;
+        record.m_ullTag = m_ullNextTag;
+        m_ullNextTag = 0;
+        m_pBackend->Begin( record.m_pInterval );
+    }
+
+
+    void GpuTimestampRing::Stop()
+    {
+        // check if the start has been issued but no stop yet
+        assert( (m_pRecords[m_uIssue].m_uStartIssued == 1) && (m_pRecords[m_uIssue].m_uStopIssued == 0) );
+
+        m_pRecords[m_uIssue].m_uStopIssued = 1;
+        m_pBackend->End( m_pRecords[m_uIssue].m_pInterval );
+    }
+
+
+    void GpuTimestampRing::EndFrame()
+    {
+        FinishCollection();
+        m_uFrameId = (m_uFrameId + 1) & FrameIdMask;
+    }
+
+
+    void GpuTimestampRing::FinishCollection()
+    {
+        while (Collect( m_uRetrieve, false ))
+        {
+            Retire();
+        }
+    }
+
+
+    void GpuTimestampRing::WaitIdle()
+    {
+        while (m_uRetrieve != m_uIssue)
+        {
+            Collect( m_uRetrieve, true );
+            Retire();
+        }
+
+        // retrieve the current record
+        Collect( m_uRetrieve, true );
+        Retire();
+
+        if (!m_bCurFrameInvalid && NULL != m_pfnOnFrame)
+        {
+            m_pfnOnFrame( m_pOnFrameData, m_fCurFrameTime );
+        }
+    }
+
+
+    void GpuTimestampRing::DiscardFrame()
+    {
+        m_bCurFrameInvalid = true;
+        m_fCurFrameTime = 0.0;
+    }
+
+
+    void GpuTimestampRing::Retire()
+    {
+        if (++m_uRetrieve == m_uNumTimeStamps)
+        {
+            m_uRetrieve = 0;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // Adds the result of a record to the time of its frame. Returns false if the record
+    // wasn't stopped or, without bWait, its result isn't in yet
+    //--------------------------------------------------------------------------------------
+    bool GpuTimestampRing::Collect( unsigned int uIndex, bool bWait )
+    {
+        Record& record = m_pRecords[uIndex];
+        if (!record.m_uStopIssued)
+        {
+            return false;
+        }
+
+        // start collecting data from a new frame? Then the last one is complete, and
+        // reported unless one of its results was disjoint
+        if (record.m_uFrameId != m_uCurFrameId)
+        {
+            if (!m_bCurFrameInvalid && NULL != m_pfnOnFrame)
+            {
+                m_pfnOnFrame( m_pOnFrameData, m_fCurFrameTime );
+            }
+
+            m_fCurFrameTime = 0.0;
+            m_uCurFrameId = record.m_uFrameId;
+            m_bCurFrameInvalid = false;
+        }
+
+        // if we want to retrieve the data NOW the CPU will stall
+        // otherwise return false if it is not yet available
+        GpuTimestampBackend::IntervalData data;
+        if (!m_pBackend->GetData( record.m_pInterval, bWait, data ))
+        {
+            return false;
+        }
+
+        m_uLatencyFrames = (m_uFrameId - record.m_uFrameId) & FrameIdMask;
+        m_uMaxLatencyFrames = (m_uLatencyFrames > m_uMaxLatencyFrames) ? m_uLatencyFrames : m_uMaxLatencyFrames;
+
+        if (data.m_bDisjoint || ((data.m_ullStart & 0xFFFFFFFF) == 0xFFFFFFFF) || ((data.m_ullStop & 0xFFFFFFFF) == 0xFFFFFFFF))
+        {
+            // mark the current frame time as invalid
+            m_bCurFrameInvalid = true;
+        }
+        else
+        {
+            unsigned long long ullTicks = data.m_ullStop - data.m_ullStart;
+            m_fCurFrameTime += (double)ullTicks / (double)data.m_ullFrequency;
+
+            if (NULL != m_pfnOnTimestamps && 0 != record.m_ullTag)
+            {
+                m_pfnOnTimestamps( m_pOnTimestampsData, record.m_ullTag, data.m_ullStart, data.m_ullStop, data.m_ullFrequency );
+            }
+        }
+
+        record.m_uStartIssued = 0;
+        record.m_uStopIssued = 0;
+        record.m_ullTag = 0;
+        return true;
+    }
+
+} // namespace AMD
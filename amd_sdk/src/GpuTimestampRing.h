@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+//--------------------------------------------------------------------------------------
+// File: GpuTimestampRing.h
+//
+// The ring of in-flight intervals behind GpuTimer, and its latency bookkeeping. Start and
+// Stop issue intervals on a GpuTimestampBackend without waiting for them; their results
+// are collected in issue order once the backend has them, and summed per frame. When the
+// ring is full of results that aren't in yet it doubles, up to MaxTimeStamps, and only
+// then stalls the CPU.
+//
+// It doesn't depend on DXUT or D3D, so with SimulatedGpuTimestamps it runs anywhere;
+// GpuTimestampRingTest (ssaa11/tools) drives it that way.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_GPU_TIMESTAMP_RING_H
+#define AMD_SDK_GPU_TIMESTAMP_RING_H
+
+#include "GpuTimestamps.h"
+
+namespace AMD
+{
+    class GpuTimestampRing
+    {
+    public:
+
+        // called with the GPU time of each frame, in seconds, once all its results are in.
+        // Frames with a disjoint result aren't reported
+        typedef void (*PFN_ON_FRAME)( void* pUserData, double fSeconds );
+
+        // called with the raw timestamps of each interval that was given a non-zero tag
+        typedef void (*PFN_ON_TIMESTAMPS)( void* pUserData, unsigned long long ullTag, unsigned long long ullStart, unsigned long long ullStop, unsigned long long ullFrequency );
+
+        static const unsigned int MaxTimeStamps = 1024;
+
+        // the backend must outlive the ring
+        GpuTimestampRing( GpuTimestampBackend* pBackend, unsigned int uNumTimeStamps = 8 );
+        ~GpuTimestampRing();
+
+        void SetFrameCallback( PFN_ON_FRAME pfnOnFrame, void* pUserData );
+        void SetTimestampCallback( PFN_ON_TIMESTAMPS pfnOnTimestamps, void* pUserData );
+        void SetNextTag( unsigned long long ullTag ) { m_ullNextTag = ullTag; }    // tag for the next Start
+
+        void Start();
+        void Stop();
+
+        // collects the results that are in, then starts the next frame
+        void EndFrame();
+        // collects the results that are in, without waiting
+        void FinishCollection();
+        // waits for every result in flight, and reports the frame being summed
+        void WaitIdle();
+        // drops the time summed so far for the current frame
+        void DiscardFrame();
+
+        unsigned int GetNumTimeStamps() const { return m_uNumTimeStamps; }
+        unsigned int GetNumGrowths() const { return m_uNumGrowths; }   // times the ring grew to avoid a stall
+        unsigned int GetNumStalls() const { return m_uNumStalls; }     // times Start stalled, with the ring at MaxTimeStamps
+
+        // frames from a Start until its result was collected, of the last result and the most seen
+        unsigned int GetLatencyFrames() const { return m_uLatencyFrames; }
+        unsigned int GetMaxLatencyFrames() const { return m_uMaxLatencyFrames; }
+
+    private:
+
+        static const unsigned int FrameIdMask = 0x3FFFFFFF;
+
+        struct Record
+        {
+            unsigned int                    m_uFrameId      : 30;
+            unsigned int                    m_uStartIssued  : 1;
+            unsigned int                    m_uStopIssued   : 1;
+            GpuTimestampBackend::Interval*  m_pInterval;
+            unsigned long long              m_ullTag;
+        };
+
+        void CreateRecords( Record* pRecords, unsigned int uFirst, unsigned int uCount );
+        bool Grow();
+        bool Collect( unsigned int uIndex, bool bWait );
+        void Retire();
+
+        GpuTimestampBackend*    m_pBackend;
+
+        unsigned int            m_uNumTimeStamps;
+        Record*                 m_pRecords;
+        unsigned int            m_uIssue;           // last record started
+        unsigned int            m_uRetrieve;        // next record to collect
+        unsigned int            m_uFrameId;
+
+        unsigned int            m_uCurFrameId;      // frame whose time is being summed, none at first
+        bool                    m_bCurFrameInvalid;
+        double                  m_fCurFrameTime;
+
+        PFN_ON_FRAME            m_pfnOnFrame;
+        void*                   m_pOnFrameData;
+        PFN_ON_TIMESTAMPS       m_pfnOnTimestamps;
+        void*                   m_pOnTimestampsData;
+        unsigned long long      m_ullNextTag;
+
+        unsigned int            m_uNumGrowths;
+        unsigned int            m_uNumStalls;
+        unsigned int            m_uLatencyFrames;
+        unsigned int            m_uMaxLatencyFrames;
+
+        // not copyable, it owns the intervals of its records
+        GpuTimestampRing( const GpuTimestampRing& );
+        GpuTimestampRing& operator=( const GpuTimestampRing& );
+    };
+
+} // namespace AMD
+
+#endif
@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: GpuTimestamps.cpp
+//
+// The simulated GPU timestamp backend. The D3D11 backend lives in Timer.cpp, next to
+// GpuTimer; this file doesn't depend on DXUT or D3D.
+//--------------------------------------------------------------------------------------
+#include "GpuTimestamps.h"
+
+namespace AMD
+{
+    //--------------------------------------------------------------------------------------
+    // Constructor
+    //--------------------------------------------------------------------------------------
+    SimulatedGpuTimestamps::SimulatedGpuTimestamps( unsigned long long ullFrequency, unsigned int uLatencyFrames )
+        : m_ullFrequency( ullFrequency )
+        , m_ullClock( 0 )
+        , m_fClockRemainder( 0.0 )
+        , m_uLatencyFrames( uLatencyFrames )
+        , m_uFrame( 0 )
+        , m_ullSequence( 0 )
+        , m_ullFlushedSequence( 0 )
+        , m_bFrameDisjoint( false )
+        , m_fDisjointRate( 0.0 )
+        , m_uRandom( 1 )
+        , m_uNumWaits( 0 )
+    {
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // Destructor
+    //--------------------------------------------------------------------------------------
+    SimulatedGpuTimestamps::~SimulatedGpuTimestamps()
+    {
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // Disjoint frames are drawn from a seeded LCG, so a run can be repeated exactly
+    //--------------------------------------------------------------------------------------
+    void SimulatedGpuTimestamps::SetDisjointRate( double fRate, unsigned int uSeed )
+    {
+        m_fDisjointRate = fRate;
+        m_uRandom = uSeed;
+    }
+
+
+    bool SimulatedGpuTimestamps::NextFrameDisjoint()
+    {
+        if (m_fDisjointRate <= 0.0)
+        {
+            return false;
+        }
+
+        m_uRandom = m_uRandom * 1664525u + 1013904223u;
+        return (double)(m_uRandom >> 8) < m_fDisjointRate * (double)(1u << 24);
+    }
+
+
+    void SimulatedGpuTimestamps::AddWork( double fSeconds )
+    {
+        double fTicks = fSeconds * (double)m_ullFrequency + m_fClockRemainder;
+        unsigned long long ullTicks = (fTicks > 0.0) ? (unsigned long long)fTicks : 0;
+
+        m_ullClock += ullTicks;
+        m_fClockRemainder = (fTicks > 0.0) ? fTicks - (double)ullTicks : 0.0;
+    }
+
+
+    void SimulatedGpuTimestamps::AdvanceFrame()
+    {
+        ++m_uFrame;
+        m_bFrameDisjoint = NextFrameDisjoint();
+    }
+
+
+    GpuTimestampBackend::Interval* SimulatedGpuTimestamps::CreateInterval()
+    {
+        SimulatedInterval* pInterval = new SimulatedInterval();
+        pInterval->m_ullStart = 0;
+        pInterval->m_ullStop = 0;
+        pInterval->m_ullSequence = 0;
+        pInterval->m_uEndFrame = 0;
+        pInterval->m_bDisjoint = false;
+        return pInterval;
+    }
+
+
+    void SimulatedGpuTimestamps::DestroyInterval( Interval* pInterval )
+    {
+        delete pInterval;
+    }
+
+
+    void SimulatedGpuTimestamps::Begin( Interval* pInterval )
+    {
+        SimulatedInterval* pSim = static_cast<SimulatedInterval*>( pInterval );
+        pSim->m_ullStart = m_ullClock;
+        pSim->m_ullSequence = 0;
+    }
+
+
+    void SimulatedGpuTimestamps::End( Interval* pInterval )
+    {
+        SimulatedInterval* pSim = static_cast<SimulatedInterval*>( pInterval );
+        pSim->m_ullStop = m_ullClock;
+        pSim->m_ullSequence = ++m_ullSequence;
+        pSim->m_uEndFrame = m_uFrame;
+        pSim->m_bDisjoint = m_bFrameDisjoint;
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // An interval completes m_uLatencyFrames frames after it ended, or when a wait made the
+    // GPU catch up with everything submitted so far
+    //--------------------------------------------------------------------------------------
+    bool SimulatedGpuTimestamps::IsComplete( const SimulatedInterval* pInterval ) const
+    {
+        return (0 != pInterval->m_ullSequence) &&
+            (pInterval->m_ullSequence <= m_ullFlushedSequence || m_uFrame - pInterval->m_uEndFrame >= m_uLatencyFrames);
+    }
+
+
+    bool SimulatedGpuTimestamps::GetData( Interval* pInterval, bool bWait, IntervalData& o_Data )
+    {
+        SimulatedInterval* pSim = static_cast<SimulatedInterval*>( pInterval );
+
+        if (!IsComplete( pSim ))
+        {
+            if (!bWait || 0 == pSim->m_ullSequence)
+            {
+                return false;
+            }
+
+            ++m_uNumWaits;
+            m_ullFlushedSequence = m_ullSequence;
+        }
+
+        o_Data.m_ullStart = pSim->m_ullStart;
+        o_Data.m_ullStop = pSim->m_ullStop;
+        o_Data.m_ullFrequency = m_ullFrequency;
+        o_Data.m_bDisjoint = pSim->m_bDisjoint;
+        return true;
+    }
+
+} // namespace AMD
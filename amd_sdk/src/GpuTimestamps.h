@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: GpuTimestamps.h
+//
+// The GPU query interface used by GpuTimer. An interval is what GpuTimer times between
+// Start and Stop: a start and a stop timestamp inside a disjoint query. GpuTimer creates
+// its D3D11 backend from an ID3D11Device; any other backend can be passed in instead.
+//
+// SimulatedGpuTimestamps is a backend without a GPU. Its clock only advances by AddWork,
+// results become available a configurable number of frames after they were issued, and
+// disjoint intervals can be injected. It doesn't depend on D3D, so GpuTimer's latency
+// ring, GpuTimestampRing, can be exercised anywhere, including on Linux.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_GPU_TIMESTAMPS_H
+#define AMD_SDK_GPU_TIMESTAMPS_H
+
+namespace AMD
+{
+    class GpuTimestampBackend
+    {
+    public:
+
+        class Interval
+        {
+        public:
+            virtual ~Interval() {}
+        };
+
+        struct IntervalData
+        {
+            unsigned long long  m_ullStart;
+            unsigned long long  m_ullStop;
+            unsigned long long  m_ullFrequency;
+            bool                m_bDisjoint;    // the timestamps can't be trusted
+        };
+
+        virtual ~GpuTimestampBackend() {}
+
+        // NULL on failure
+        virtual Interval* CreateInterval() = 0;
+        virtual void DestroyInterval( Interval* pInterval ) = 0;
+
+        virtual void Begin( Interval* pInterval ) = 0;
+        virtual void End( Interval* pInterval ) = 0;
+
+        // Returns false if the results aren't available yet. With bWait it doesn't return until
+        // they are, which stalls the CPU until the GPU has caught up
+        virtual bool GetData( Interval* pInterval, bool bWait, IntervalData& o_Data ) = 0;
+    };
+
+
+    class SimulatedGpuTimestamps : public GpuTimestampBackend
+    {
+    public:
+
+        SimulatedGpuTimestamps( unsigned long long ullFrequency = 100000000, unsigned int uLatencyFrames = 2 );
+        virtual ~SimulatedGpuTimestamps();
+
+        // Results of intervals ended in frame n become available once frame n + uLatencyFrames starts
+        void SetLatencyFrames( unsigned int uLatencyFrames ) { m_uLatencyFrames = uLatencyFrames; }
+        unsigned int GetLatencyFrames() const { return m_uLatencyFrames; }
+
+        // Fraction of frames, from 0 to 1, whose intervals report a disjoint result
+        void SetDisjointRate( double fRate, unsigned int uSeed = 1 );
+        // Makes the intervals of the current frame report a disjoint result
+        void InjectDisjoint() { m_bFrameDisjoint = true; }
+
+        // Advances the GPU clock, as if the GPU had executed fSeconds of work
+        void AddWork( double fSeconds );
+
+        // Ends the current frame, like a Present
+        void AdvanceFrame();
+        unsigned int GetFrame() const { return m_uFrame; }
+
+        // Number of GetData calls with bWait that had to wait for the simulated GPU
+        unsigned int GetNumWaits() const { return m_uNumWaits; }
+
+        virtual Interval* CreateInterval();
+        virtual void DestroyInterval( Interval* pInterval );
+        virtual void Begin( Interval* pInterval );
+        virtual void End( Interval* pInterval );
+        virtual bool GetData( Interval* pInterval, bool bWait, IntervalData& o_Data );
+
+    private:
+
+        class SimulatedInterval : public Interval
+        {
+        public:
+            unsigned long long  m_ullStart;
+            unsigned long long  m_ullStop;
+            unsigned long long  m_ullSequence;      // order in which intervals were ended, 0 while open
+            unsigned int        m_uEndFrame;
+            bool                m_bDisjoint;
+        };
+
+        bool IsComplete( const SimulatedInterval* pInterval ) const;
+        bool NextFrameDisjoint();
+
+        unsigned long long  m_ullFrequency;
+        unsigned long long  m_ullClock;             // GPU ticks
+        double              m_fClockRemainder;      // fraction of a tick not yet added to m_ullClock
+        unsigned int        m_uLatencyFrames;
+        unsigned int        m_uFrame;
+        unsigned long long  m_ullSequence;          // of the last interval ended
+        unsigned long long  m_ullFlushedSequence;   // everything up to this has completed, because of a wait
+        bool                m_bFrameDisjoint;
+        double              m_fDisjointRate;
+        unsigned int        m_uRandom;
+        unsigned int        m_uNumWaits;
+    };
+
+} // namespace AMD
+
+#endif
@@ -37,6 +37,9 @@
 #include "..\\..\\DXUT\\Core\\DXUT.h"
 #include "..\\..\\DXUT\\Optional\\SDKmisc.h"
 #include "ShaderCache.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderCompileServer.h"
+#include "FileWatcher.h"
 #include "Process.h"
 
 #include <Shlwapi.h>
@@ -99,7 +102,6 @@ ShaderCache::Shader::Shader()
     memset( m_wsHashFile, '\0', sizeof( wchar_t[m_uFILENAME_MAX_LENGTH] ) );
     memset( m_wsCommandLine, '\0', sizeof( wchar_t[m_uCOMMAND_LINE_MAX_LENGTH] ) );
     memset( m_wsISACommandLine, '\0', sizeof( wchar_t[m_uCOMMAND_LINE_MAX_LENGTH] ) );
-    memset( m_wsPreprocessCommandLine, '\0', sizeof( wchar_t[m_uCOMMAND_LINE_MAX_LENGTH] ) );
 
     memset( m_wsObjectFile_with_ISA, '\0', sizeof( wchar_t[m_uFILENAME_MAX_LENGTH] ) );
     memset( m_wsPreprocessFile_with_ISA, '\0', sizeof( wchar_t[m_uFILENAME_MAX_LENGTH] ) );
@@ -186,7 +188,6 @@ ShaderCache::ShaderCache( const SHADER_AUTO_RECOMPILE_TYPE i_keAutoRecompileTouc
     m_ShaderSourceList.clear();
     m_ShaderList.clear();
     m_PreprocessList.clear();
-    m_HashList.clear();
     m_CompileList.clear();
     m_CompileCheckList.clear();
     m_CreateList.clear();
@@ -205,6 +206,7 @@ ShaderCache::ShaderCache( const SHADER_AUTO_RECOMPILE_TYPE i_keAutoRecompileTouc
 
     InitializeCriticalSection( &m_CompileShaders_CriticalSection );
     InitializeCriticalSection( &m_GenISA_CriticalSection );
+    InitializeCriticalSection( &m_HotReload_CriticalSection );
 
     // the working dir we want for ShaderCache is not necessarily the current directory,
     // so get the current directory and then specify our working dir relative to it
@@ -352,8 +354,11 @@ ShaderCache::ShaderCache( const SHADER_AUTO_RECOMPILE_TYPE i_keAutoRecompileTouc
 
     m_bForceDebugShaders = false;
 
-    m_watchHandle = NULL;
-    m_waitPoolHandle = NULL;
+    m_pFileWatcher = NULL;
+    m_bHotReloadInProgress = false;
+
+    m_pCompileServer = NULL;
+    m_pCompileClient = NULL;
 
 #if AMD_SDK_INTERNAL_BUILD
     m_eTargetISA = DEFAULT_ISA_TARGET;
@@ -459,6 +464,13 @@ ShaderCache::ShaderCache( const SHADER_AUTO_RECOMPILE_TYPE i_keAutoRecompileTouc
 //--------------------------------------------------------------------------------------
 ShaderCache::~ShaderCache()
 {
+    // Stop watching first, so that no more changes get queued
+    if (NULL != m_pFileWatcher)
+    {
+        delete m_pFileWatcher;
+        m_pFileWatcher = NULL;
+    }
+
     WaitForSingleObject( s_hDoneEvent, INFINITE );
     CloseHandle( s_hDoneEvent );
 
@@ -486,7 +498,6 @@ ShaderCache::~ShaderCache()
     m_ShaderSourceList.clear();
     m_ShaderList.clear();
     m_PreprocessList.clear();
-    m_HashList.clear();
     m_CompileList.clear();
     m_CompileCheckList.clear();
     m_CreateList.clear();
@@ -502,18 +513,19 @@ ShaderCache::~ShaderCache()
         m_pProgressInfo = NULL;
     }
 
-    if (m_waitPoolHandle)
+    if (NULL != m_pCompileClient)
     {
-        UnregisterWaitEx( m_waitPoolHandle, INVALID_HANDLE_VALUE );
-        m_waitPoolHandle = NULL;
+        delete m_pCompileClient;
+        m_pCompileClient = NULL;
     }
 
-    if (m_watchHandle)
+    if (NULL != m_pCompileServer)
     {
-        FindCloseChangeNotification( m_watchHandle );
-        m_watchHandle = NULL;
+        delete m_pCompileServer;
+        m_pCompileServer = NULL;
     }
 
+    DeleteCriticalSection( &m_HotReload_CriticalSection );
     DeleteCriticalSection( &m_GenISA_CriticalSection );
     DeleteCriticalSection( &m_CompileShaders_CriticalSection );
 
@@ -897,23 +909,6 @@ bool ShaderCache::AddShader( ID3D11DeviceChild** ppShader,
     //  wcscat_s( pShader->m_wsISACommandLine, m_uCOMMAND_LINE_MAX_LENGTH, L"\"" );
 #endif
 
-    // Preprocess command line
-    wcscat_s( pShader->m_wsPreprocessCommandLine, m_uCOMMAND_LINE_MAX_LENGTH, L" /E " );
-    wcscat_s( pShader->m_wsPreprocessCommandLine, m_uCOMMAND_LINE_MAX_LENGTH, pwsEntryPoint );
-    wcscat_s( pShader->m_wsPreprocessCommandLine, m_uCOMMAND_LINE_MAX_LENGTH, L" " );
-    InsertInputFilenameIntoCommandLine( pShader->m_wsPreprocessCommandLine, pShader->m_wsSourceFile );
-    wcscat_s( pShader->m_wsPreprocessCommandLine, m_uCOMMAND_LINE_MAX_LENGTH, L" /P " );
-    InsertOutputFilenameIntoCommandLine( pShader->m_wsPreprocessCommandLine, pShader->m_wsPreprocessFile );
-    for (int iMacro = 0; iMacro < (int)pShader->m_uNumMacros; ++iMacro)
-    {
-        wchar_t wsValue[64];
-        wcscat_s( pShader->m_wsPreprocessCommandLine, m_uCOMMAND_LINE_MAX_LENGTH, L" /D " );
-        wcscat_s( pShader->m_wsPreprocessCommandLine, m_uCOMMAND_LINE_MAX_LENGTH, pShader->m_pMacros[iMacro].m_wsName );
-        wcscat_s( pShader->m_wsPreprocessCommandLine, m_uCOMMAND_LINE_MAX_LENGTH, L"=" );
-        _itow_s( pShader->m_pMacros[iMacro].m_iValue, wsValue, 10 );
-        wcscat_s( pShader->m_wsPreprocessCommandLine, m_uCOMMAND_LINE_MAX_LENGTH, wsValue );
-    }
-
     m_ShaderList.push_back( pShader );
 
     return true;
@@ -935,6 +930,21 @@ DWORD WINAPI GenerateShaders_ThreadProc_( void* pParameter )
 }
 
 
+//--------------------------------------------------------------------------------------
+// Thread proc for recompiling shaders that the file watcher found had changed
+//--------------------------------------------------------------------------------------
+DWORD WINAPI HotReloadShaders_ThreadProc_( void* pParameter )
+{
+    ShaderCache* pShaderCache = (ShaderCache*)pParameter;
+
+    pShaderCache->HotReloadShadersThreadProc();
+
+    SetEvent( s_hDoneEvent );
+
+    return 0;
+}
+
+
 //--------------------------------------------------------------------------------------
 // Initiates shader generation based upon the creation flags:
 // CREATE_TYPE_FORCE_COMPILE,      // Clean the cache, and compile all
@@ -958,6 +968,8 @@ HRESULT ShaderCache::GenerateShaders( CREATE_TYPE CreateType, const bool i_kbRec
         m_bShadersCreated = false;
         m_bPrintedProgress = false;
 
+        m_Telemetry.BeginBuild();
+
         if (i_kbRecreateShaders)
         {
             m_CreateList.clear();
@@ -975,6 +987,7 @@ HRESULT ShaderCache::GenerateShaders( CREATE_TYPE CreateType, const bool i_kbRec
             }
             else
             {
+                m_Telemetry.SetResult( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::RESULT_CACHE_HIT );
                 m_CreateList.push_back( pShader );
             }
         }
@@ -1022,9 +1035,115 @@ void ShaderCache::GenerateShadersThreadProc()
     m_shaderErrorRenderedCount = 0;
 
     PreprocessShaders();
+    CompileShadersOnServer();
     CompileShaders();
 }
 
+
+//--------------------------------------------------------------------------------------
+// Called by the hot reload thread proc. Only the shaders in the preprocess list (the ones
+// affected by the changed files) are touched.
+//--------------------------------------------------------------------------------------
+void ShaderCache::HotReloadShadersThreadProc()
+{
+    for (std::list<Shader*>::iterator it = m_PreprocessList.begin(); it != m_PreprocessList.end(); it++)
+    {
+        DeleteErrorFile( *it );
+        DeleteAssemblyFile( *it );
+        DeletePreprocessFile( *it );
+    }
+
+    // Remove Old Shader Errors from displaying over shader recompilation
+    m_bHasShaderErrorsToDisplay = false;
+    m_shaderErrorRenderedCount = 0;
+
+    PreprocessShaders();
+    CompileShadersOnServer();
+    CompileShaders();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Connects to (or hosts) a shader compile server
+//--------------------------------------------------------------------------------------
+bool ShaderCache::EnableCompileServer( const wchar_t* pwsPipeName, const bool i_kbHostIfNotRunning )
+{
+#if !AMD_SDK_PREBUILT_RELEASE_EXE
+    if (NULL == m_pCompileClient)
+    {
+        m_pCompileClient = new ShaderCompileClient();
+    }
+
+    if (m_pCompileClient->Connect( pwsPipeName ))
+    {
+        return true;
+    }
+
+    if (!i_kbHostIfNotRunning)
+    {
+        return false;
+    }
+
+    if (NULL == m_pCompileServer)
+    {
+        wchar_t wsArchiveDir[m_uPATHNAME_MAX_LENGTH];
+        swprintf_s( wsArchiveDir, L"%s\\Shaders\\Cache\\Server", m_wsWorkingDir );
+
+        m_pCompileServer = new ShaderCompileServer();
+        if (FAILED( m_pCompileServer->Start( pwsPipeName, wsArchiveDir ) ))
+        {
+            // Most likely another sample started hosting in the meantime, so just connect to that
+            delete m_pCompileServer;
+            m_pCompileServer = NULL;
+        }
+    }
+
+    return m_pCompileClient->Connect( pwsPipeName );
+#else
+    // the pre-built release executable only ever uses cached shaders
+    (void)pwsPipeName;
+    (void)i_kbHostIfNotRunning;
+    return false;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------
+// Exports the telemetry of the last build
+//--------------------------------------------------------------------------------------
+bool ShaderCache::ExportTelemetry( const wchar_t* pwsJSONFile, const wchar_t* pwsTraceFile )
+{
+    wchar_t wsPathName[m_uPATHNAME_MAX_LENGTH];
+    bool bSuccess = true;
+
+    if (NULL != pwsJSONFile)
+    {
+        if (PathIsRelativeW( pwsJSONFile ))
+        {
+            swprintf_s( wsPathName, L"%s\\Shaders\\Cache\\%s", m_wsWorkingDir, pwsJSONFile );
+            pwsJSONFile = wsPathName;
+        }
+        bSuccess = m_Telemetry.ExportJSON( pwsJSONFile ) && bSuccess;
+    }
+
+    if (NULL != pwsTraceFile)
+    {
+        if (PathIsRelativeW( pwsTraceFile ))
+        {
+            swprintf_s( wsPathName, L"%s\\Shaders\\Cache\\%s", m_wsWorkingDir, pwsTraceFile );
+            pwsTraceFile = wsPathName;
+        }
+        bSuccess = m_Telemetry.ExportChromeTrace( pwsTraceFile ) && bSuccess;
+    }
+
+    if (!bSuccess)
+    {
+        OutputDebugStringW( L"\n*** Shader Cache: failed to export telemetry ***\n" );
+    }
+
+    return bSuccess;
+}
+
 //--------------------------------------------------------------------------------------
 // Renders the progress of the shader generation process
 //--------------------------------------------------------------------------------------
@@ -1087,6 +1206,27 @@ void ShaderCache::RenderProgress( CDXUTTextHelper* g_pTxtHelper, int iFontHeight
 //--------------------------------------------------------------------------------------
 bool ShaderCache::ShadersReady()
 {
+    if (m_bHotReloadInProgress)
+    {
+        // Keep rendering with the current shaders while the changed ones compile, then swap
+        // all of the new ones in at once, here between frames
+        if (WaitForSingleObject( s_hDoneEvent, 0 ) == WAIT_OBJECT_0)
+        {
+            CreateShaders();
+
+            if (NULL != m_pProgressInfo)
+            {
+                delete [] m_pProgressInfo;
+                m_pProgressInfo = NULL;
+                m_uProgressCounter = 0;
+            }
+
+            m_bHotReloadInProgress = false;
+        }
+
+        return true;
+    }
+
     if (TryEnterCriticalSection( &m_CompileShaders_CriticalSection ))
     {
 
@@ -1110,6 +1250,10 @@ bool ShaderCache::ShadersReady()
                 }
 
                 LeaveCriticalSection( &m_CompileShaders_CriticalSection );
+
+                // Pick up any shaders the file watcher has queued since the last frame
+                StartHotReload();
+
                 return true;
             }
         }
@@ -1162,7 +1306,7 @@ void ShaderCache::SetRecompileTouchedShadersFlag( const bool i_bRecompileWhenTou
     if (m_bRecompileTouchedShaders)
     {
         // Create Directory Watcher
-        if ((m_waitPoolHandle == NULL) || (m_watchHandle == NULL))
+        if ((NULL == m_pFileWatcher) || !m_pFileWatcher->IsRunning())
         {
 #if defined(DEBUG) || defined(_DEBUG)
             const bool kb_Success = WatchDirectoryForChanges();
@@ -1243,48 +1387,29 @@ void ShaderCache::SetTargetISA( const ISA_TARGET i_eTargetISA )
 
 bool ShaderCache::WatchDirectoryForChanges( void )
 {
-    assert( !m_watchHandle );
-    assert( !m_waitPoolHandle );
-
-    if (m_waitPoolHandle)
+    if (NULL == m_pFileWatcher)
     {
-        UnregisterWaitEx( m_waitPoolHandle, INVALID_HANDLE_VALUE );
-        m_waitPoolHandle = NULL;
+        m_pFileWatcher = new FileWatcher();
     }
 
-    if (m_watchHandle)
+    if (m_pFileWatcher->IsRunning())
     {
-        FindCloseChangeNotification( m_watchHandle );
-        m_watchHandle = NULL;
-    }
-
-    assert( !m_watchHandle );
-    assert( !m_waitPoolHandle );
-
-    HANDLE watchHandle = FindFirstChangeNotification( m_wsShaderSourceDir, TRUE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE );
-    if (watchHandle == INVALID_HANDLE_VALUE)
-    {
-        wchar_t wsErrorString[m_uCOMMAND_LINE_MAX_LENGTH];
-        DWORD error = GetLastError();
-        swprintf_s( wsErrorString, L"\n\n*** Shader Cache: Error '%x' in FindFirstChangeNotification while attempting to watch directory '%s' ***\n\n", error, m_wsShaderSourceDir );
-        OutputDebugStringW( wsErrorString );
-        return false;
+        return true;
     }
 
-    m_watchHandle = watchHandle;
+    size_t i;
+    char szShaderSourceDir[m_uPATHNAME_MAX_LENGTH];
+    wcstombs_s( &i, szShaderSourceDir, m_uPATHNAME_MAX_LENGTH, m_wsShaderSourceDir, _TRUNCATE );
 
-    HANDLE poolHandle;
-    if (!RegisterWaitForSingleObject( &poolHandle, watchHandle, onDirectoryChangeEventTriggered, (void*) this, INFINITE, WT_EXECUTEINWAITTHREAD ))
+    if (!m_pFileWatcher->Start( szShaderSourceDir, OnWatchedFilesChanged, this ))
     {
         wchar_t wsErrorString[m_uCOMMAND_LINE_MAX_LENGTH];
         DWORD error = GetLastError();
-        swprintf_s( wsErrorString, L"\n\n*** Shader Cache: Error '%x' in RegisterWaitForSingleObject while attempting to watch directory '%s' ***\n\n", error, m_wsShaderSourceDir );
+        swprintf_s( wsErrorString, L"\n\n*** Shader Cache: Error '%x' while attempting to watch directory '%s' ***\n\n", error, m_wsShaderSourceDir );
         OutputDebugStringW( wsErrorString );
         return false;
     }
 
-    m_waitPoolHandle = poolHandle;
-
     wchar_t wsErrorString[m_uCOMMAND_LINE_MAX_LENGTH];
     swprintf_s( wsErrorString, L"\n\n*** Shader Cache: Succesfully enabled watching of directory '%s' ***\n\n", m_wsShaderSourceDir );
     OutputDebugStringW( wsErrorString );
@@ -1293,31 +1418,102 @@ bool ShaderCache::WatchDirectoryForChanges( void )
 }
 
 
-void __stdcall ShaderCache::onDirectoryChangeEventTriggered( void* args, BOOLEAN /*timeout*/ )
+//--------------------------------------------------------------------------------------
+// Called on the watcher thread with a debounced batch of changed files. Uses the include
+// graph from the last preprocess to find the shaders affected, and queues them for
+// StartHotReload. Shaders that haven't been preprocessed yet have no graph, so they are
+// always queued; if they haven't really changed, their hash will say so.
+//--------------------------------------------------------------------------------------
+void ShaderCache::OnWatchedFilesChanged( const std::vector<std::string>& i_ChangedFiles, void* pUserData )
 {
-    ShaderCache* pShaderCache = reinterpret_cast<ShaderCache *>(args);
+    ShaderCache* pShaderCache = reinterpret_cast<ShaderCache *>(pUserData);
+
+    if (!pShaderCache->RecompileTouchedShaders())
+    {
+        return;
+    }
 
-    if (pShaderCache->RecompileTouchedShaders())
+    const std::string& kWatchDir = pShaderCache->m_pFileWatcher->GetDirectory();
+    std::set<std::string> changedFiles;
+    bool bAllChanged = false;
+
+    for (size_t i = 0; i < i_ChangedFiles.size(); i++)
     {
-        // Don't recompile if shaders are currently compiling!
-        if (pShaderCache->ShadersReady())
+        if (i_ChangedFiles[i].empty())
         {
-            pShaderCache->GenerateShaders( AMD::ShaderCache::CREATE_TYPE_COMPILE_CHANGES, true );
+            // The watcher lost track of what changed
+            bAllChanged = true;
+            break;
+        }
+        changedFiles.insert( FileWatcher::NormalizePath( kWatchDir + "\\" + i_ChangedFiles[i] ) );
+    }
+
+    unsigned int uNumQueued = 0;
 
-            wchar_t wsErrorString[m_uCOMMAND_LINE_MAX_LENGTH];
-            swprintf_s( wsErrorString, L"\n\n*** ShaderCache::onDirectoryChangeEventTriggered! @ [%s] ***\n\n", pShaderCache->m_wsShaderSourceDir );
-            OutputDebugStringW( wsErrorString );
+    EnterCriticalSection( &pShaderCache->m_HotReload_CriticalSection );
+
+    for (std::list<Shader*>::iterator it = pShaderCache->m_ShaderList.begin(); it != pShaderCache->m_ShaderList.end(); it++)
+    {
+        Shader* pShader = *it;
+
+        bool bAffected = bAllChanged || pShader->m_Dependencies.empty();
+        for (size_t i = 0; !bAffected && (i < pShader->m_Dependencies.size()); i++)
+        {
+            bAffected = (changedFiles.find( pShader->m_Dependencies[i] ) != changedFiles.end());
         }
-        else
+
+        if (bAffected && pShaderCache->m_HotReloadSet.insert( pShader ).second)
         {
-            wchar_t wsErrorString[m_uCOMMAND_LINE_MAX_LENGTH];
-            swprintf_s( wsErrorString, L"\n\n*** ShaderCache::onDirectoryChangeEventTriggered! @ [%s] -- SKIPPED, because shaders are already compiling. ***\n\n", pShaderCache->m_wsShaderSourceDir );
-            OutputDebugStringW( wsErrorString );
+            uNumQueued++;
         }
     }
 
-    FindNextChangeNotification( pShaderCache->m_watchHandle );
-    FindNextChangeNotification( pShaderCache->m_watchHandle ); //twice
+    LeaveCriticalSection( &pShaderCache->m_HotReload_CriticalSection );
+
+    wchar_t wsErrorString[m_uCOMMAND_LINE_MAX_LENGTH];
+    swprintf_s( wsErrorString, L"\n\n*** ShaderCache::OnWatchedFilesChanged! %u file(s) changed, %u shader(s) queued for recompilation @ [%s] ***\n\n",
+        (unsigned int)i_ChangedFiles.size(), uNumQueued, pShaderCache->m_wsShaderSourceDir );
+    OutputDebugStringW( wsErrorString );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Called on the main thread (from ShadersReady) to start recompiling the shaders queued by
+// the watcher in the background. The current shaders stay in use until the new ones are
+// swapped in by ShadersReady.
+//--------------------------------------------------------------------------------------
+void ShaderCache::StartHotReload()
+{
+    if (m_bHotReloadInProgress || !m_bShadersCreated || (WaitForSingleObject( s_hDoneEvent, 0 ) != WAIT_OBJECT_0))
+    {
+        return;
+    }
+
+    EnterCriticalSection( &m_HotReload_CriticalSection );
+
+    if (m_HotReloadSet.size())
+    {
+        for (std::set<Shader*>::iterator it = m_HotReloadSet.begin(); it != m_HotReloadSet.end(); it++)
+        {
+            // Recompiled shaders are added back to the create list
+            m_CreateList.remove( *it );
+            m_PreprocessList.push_back( *it );
+        }
+        m_HotReloadSet.clear();
+
+        m_CreateType = CREATE_TYPE_COMPILE_CHANGES;
+        m_bHotReloadInProgress = true;
+
+        m_pProgressInfo = new ProgressInfo[m_PreprocessList.size() * 2];
+        m_uProgressCounter = 0;
+
+        m_Telemetry.BeginBuild();
+
+        ResetEvent( s_hDoneEvent );
+        QueueUserWorkItem( HotReloadShaders_ThreadProc_, this, WT_EXECUTELONGFUNCTION );
+    }
+
+    LeaveCriticalSection( &m_HotReload_CriticalSection );
 }
 
 //--------------------------------------------------------------------------------------
@@ -2152,7 +2348,6 @@ bool ShaderCache::CreateHashDigest( const std::list<Shader*>& i_ShaderList )
 void ShaderCache::PreprocessShaders()
 {
     Shader* pShader = NULL;
-    unsigned int uNumWorkThreads = 0;
 
     // Create Hash Digest File
     bool compileStatusInitialized = false;
@@ -2170,223 +2365,185 @@ void ShaderCache::PreprocessShaders()
         if (!compileStatusInitialized) { m_pProgressInfo[m_uProgressCounter++] = pShader; } // Add this if Hash Digest hasn't already done it!
     }
 
-    while (m_PreprocessList.size())
+    // The preprocessor runs in-process and is cheap compared to compilation, so there is no
+    // need to farm this work out to fxc processes; just preprocess and hash each shader in turn
+    while (m_PreprocessList.size() && (!m_bAbort))
     {
-        bool bRemove = false;
+        pShader = m_PreprocessList.front();
+        m_PreprocessList.pop_front();
 
-        for (std::list<Shader*>::iterator it = m_PreprocessList.begin(); it != m_PreprocessList.end(); it++)
+        pShader->m_wsCompileStatus = L"Finding Shader";
+        if (!CheckShaderFile( pShader ))
         {
-            if (bRemove)
-            {
-                m_PreprocessList.remove( pShader );
-                bRemove = false;
-            }
+            pShader->m_wsCompileStatus = L"ERROR: Shader Not Found!";
+            continue;
+        }
 
-            pShader = *it;
+        pShader->m_wsCompileStatus = L"Preprocessing";
+        pShader->m_bBeingProcessed = true;
 
-            if (uNumWorkThreads < m_uNumCPUCoresToUse)
-            {
-                // LAYLAFIXED: If we have 0 worker threads, then it implies we can't be processing a shader (so when (uNumWorkThreads == 0 ) && (m_bBeingProcessed == true), we have a bug!)
-                assert( (pShader->m_bBeingProcessed == false) || (uNumWorkThreads > 0) );
-                if ((pShader->m_bBeingProcessed == false) /*|| (uNumWorkThreads == 0)*/)
-                {
-                    bRemove = true;
-                    pShader->m_wsCompileStatus = L"Finding Shader"; // Starting to PreProcess the Shader
-                    if (CheckShaderFile( pShader ))
-                    {
-                        PreprocessShader( pShader );
-                        pShader->m_wsCompileStatus = L"Preprocessing"; // Starting to PreProcess the Shader
-                        //pShader->m_wsPreprocessFile_with_ISA
+        if (PreprocessShader( pShader ))
+        {
+            // Set Status to COMPARING HASH
+            pShader->m_wsCompileStatus = L"Comparing Hash";
 
-                        pShader->m_bBeingProcessed = true;
+            if (!CompareHash( pShader ))
+            {
+                DeleteObjectFile( pShader );
 
-                        m_HashList.push_back( pShader );
+                WriteHashFile( pShader );
 
-                        uNumWorkThreads++;
-                    }
-                    else
-                    {
-                        pShader->m_wsCompileStatus = L"ERROR: Shader Not Found!";
-                        pShader->m_bBeingProcessed = false;
-                        --uNumWorkThreads;
-                        continue;
-                    }
-                }
+                m_Telemetry.SetResult( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::RESULT_CACHE_MISS );
+                m_CompileList.push_back( pShader );
             }
             else
             {
-                // else break out of the for loop, and let this batch of work finish
-                break;
-            }
-
-            Sleep( 1 );
-        }
-
-        if (bRemove)
-        {
-            m_PreprocessList.remove( pShader );
-            bRemove = false;
-        }
-
-        if (m_bAbort)
-        {
-            break;
-        }
-
-        // Wait for current batch of preprocessing to finish
-        {
-            HANDLE handles[MAXIMUM_WAIT_OBJECTS];
-            DWORD nHandleCount = 0;
-            for (std::list<Shader*>::iterator it = m_HashList.begin(); it != m_HashList.end(); it++)
-            {
-                pShader = *it;
-                if (nHandleCount < MAXIMUM_WAIT_OBJECTS)
+                if (CheckObjectFile( pShader ))
                 {
-                    handles[nHandleCount++] = pShader->m_hCompileProcessHandle;
+                    m_Telemetry.SetResult( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::RESULT_CACHE_HIT );
+                    m_CreateList.push_back( pShader );
                 }
-                if (nHandleCount == MAXIMUM_WAIT_OBJECTS)
+                else
                 {
-                    WaitForMultipleObjects( nHandleCount, handles, TRUE, INFINITE );
-                    nHandleCount = 0;
+                    m_Telemetry.SetResult( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::RESULT_CACHE_MISS );
+                    m_CompileList.push_back( pShader );
                 }
             }
-            if (nHandleCount > 0)
-            {
-                WaitForMultipleObjects( nHandleCount, handles, TRUE, INFINITE );
-            }
-        }
 
-        // Close handles for current batch of preprocessing that is now finished
-        {
-            for (std::list<Shader*>::iterator it = m_HashList.begin(); it != m_HashList.end(); it++)
-            {
-                pShader = *it;
-                CloseHandle( pShader->m_hCompileProcessHandle );
-                CloseHandle( pShader->m_hCompileThreadHandle );
-                pShader->m_hCompileProcessHandle = NULL;
-                pShader->m_hCompileThreadHandle = NULL;
-            }
+            // Set Status to FINISHED
+            pShader->m_wsCompileStatus = L"Finished Preprocessing";
         }
-
-        // Hash Preprocessed Shaders
-        while (m_HashList.size() && (!m_bAbort))
+        else
         {
-            bRemove = false;
-
-            for (std::list<Shader*>::iterator it = m_HashList.begin(); it != m_HashList.end(); it++)
-            {
-                if (bRemove)
-                {
-                    pShader->m_iCompileWaitCount = -1;
-                    m_HashList.remove( pShader );
-                    bRemove = false;
-                }
-
-                pShader = *it;
+            // Let fxc have the final say, so the error is reported the usual way
+            DeleteObjectFile( pShader );
+            DeleteHashFile( pShader );
+            m_Telemetry.SetResult( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::RESULT_CACHE_MISS );
+            m_CompileList.push_back( pShader );
+        }
 
-                assert( pShader->m_bBeingProcessed == true );
-                pShader->m_wsCompileStatus = L"Waiting for Preprocessor";
-                pShader->m_iCompileWaitCount++;
+        pShader->m_bBeingProcessed = false;
+    }
+}
 
-                assert( pShader->m_hCompileProcessHandle == NULL );
+// a binary predicate implemented as a function:
+bool shader_duplicate_ptr( AMD::ShaderCache::Shader* pFirst, AMD::ShaderCache::Shader* pSecond )
+{
+    return (pFirst == pSecond);
+}
 
-                /*pShader->m_iCompileWaitCount = 0;
+//--------------------------------------------------------------------------------------
+// Returns the D3DCOMPILE flags equivalent to the fxc flags used in AddShader
+//--------------------------------------------------------------------------------------
+unsigned int ShaderCache::GetCompileFlags() const
+{
+#ifdef _DEBUG
+    return D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_PREFER_FLOW_CONTROL;
+#else
+    return m_bForceDebugShaders ? D3DCOMPILE_SKIP_OPTIMIZATION : D3DCOMPILE_OPTIMIZATION_LEVEL1;
+#endif
+}
 
-                bool bKeepLooping = true;
-                while( bKeepLooping )
-                {
-                unsigned long exitCode = 0;
-                int rValue = GetExitCodeProcess(pShader->m_hCompileProcessHandle, &exitCode );
-                bKeepLooping = ( (rValue != 0) && (exitCode == STILL_ACTIVE) );
-                pShader->m_iCompileWaitCount++;
-                }*/
 
-                if ((pShader->m_bBeingProcessed == true) && CreateHashFromPreprocessFile( pShader ))
-                {
-                    // Set Status to COMPARING HASH
-                    pShader->m_wsCompileStatus = L"Comparing Hash";
-                    //m_pProgressInfo[m_uProgressCounter++] = pShader;
-                    //m_pProgressInfo[m_uProgressCounter++].m_wsFilename = pShader->m_wsPreprocessFile_with_ISA;
-
-                    if (!CompareHash( pShader ))
-                    {
-                        DeleteObjectFile( pShader );
+//--------------------------------------------------------------------------------------
+// Hands the shaders in the compile list to the compile server, if one is enabled. Shaders
+// it builds go straight to the create list; anything else is left for fxc, so that errors
+// are reported in the usual way.
+//--------------------------------------------------------------------------------------
+void ShaderCache::CompileShadersOnServer()
+{
+    if ((NULL == m_pCompileClient) || !m_pCompileClient->IsConnected())
+    {
+        return;
+    }
 
-                        WriteHashFile( pShader );
+    const unsigned int kuCompileFlags = GetCompileFlags();
+    std::list<Shader*>::iterator it = m_CompileList.begin();
 
-                        m_CompileList.push_back( pShader );
-                    }
-                    else
-                    {
-                        if (CheckObjectFile( pShader ))
-                        {
-                            m_CreateList.push_back( pShader );
-                        }
-                        else
-                        {
-                            m_CompileList.push_back( pShader );
-                        }
-                    }
+    while ((it != m_CompileList.end()) && (!m_bAbort))
+    {
+        Shader* pShader = *it;
 
-                    // Set Status to FINISHED
-                    pShader->m_wsCompileStatus = L"Finished Preprocessing";
-                    //m_pProgressInfo[m_uProgressCounter++] = pShader;
-                    //m_pProgressInfo[m_uProgressCounter++].m_wsFilename = pShader->m_wsPreprocessFile_with_ISA;
+        if ((NULL == pShader->m_pHash) || (pShader->m_uHashLength < (long)ShaderCompileProtocol::HASH_LENGTH))
+        {
+            it++;
+            continue;
+        }
 
-                    pShader->m_bBeingProcessed = false;
+        pShader->m_wsCompileStatus = L"Compiling on Server";
+        m_Telemetry.BeginStage( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::STAGE_COMPILE );
 
-                    if (uNumWorkThreads > 0)
-                    {
-                        uNumWorkThreads--;
-                    }
-
-                    bRemove = true;
-                }
-                else
-                {
-                    Sleep( 1 );
-                }
-                /*else if( !bRemove )
-                {
-                // The Preprocess File Doesn't Exist; try again?
-                pShader->m_bBeingProcessed = false;
+        // The server compiles the canonical preprocessed source written by PreprocessShader
+        std::string source;
+        FILE* pFile = NULL;
+        wchar_t wsShaderPathName[m_uPATHNAME_MAX_LENGTH];
+        CreateFullPathFromOutputFilename( wsShaderPathName, pShader->m_wsPreprocessFile );
+        _wfopen_s( &pFile, wsShaderPathName, L"rb" );
+        if (pFile)
+        {
+            fseek( pFile, 0, SEEK_END );
+            source.resize( (size_t)ftell( pFile ) );
+            rewind( pFile );
+            if (!source.empty() && (fread( &source[0], 1, source.size(), pFile ) != source.size()))
+            {
+                source.clear();
+            }
+            fclose( pFile );
+        }
 
-                if ( uNumWorkThreads > 0 )
-                uNumWorkThreads--;
+        size_t i;
+        char szEntryPoint[m_uENTRY_POINT_MAX_LENGTH];
+        char szTarget[m_uTARGET_MAX_LENGTH];
+        wcstombs_s( &i, szEntryPoint, m_uENTRY_POINT_MAX_LENGTH, pShader->m_wsEntryPoint, _TRUNCATE );
+        wcstombs_s( &i, szTarget, m_uTARGET_MAX_LENGTH, pShader->m_wsTarget, _TRUNCATE );
 
-                m_PreprocessList.push_back( pShader );
+        std::vector<ShaderCompileProtocol::Macro> macros( pShader->m_uNumMacros );
+        for (unsigned int iMacro = 0; iMacro < pShader->m_uNumMacros; ++iMacro)
+        {
+            wcstombs_s( &i, macros[iMacro].m_szName, ShaderCompileProtocol::MACRO_NAME_LENGTH, pShader->m_pMacros[iMacro].m_wsName, _TRUNCATE );
+            macros[iMacro].m_iValue = pShader->m_pMacros[iMacro].m_iValue;
+        }
 
-                // SET STATUS TO RETRY!
-                pShader->m_wsCompileStatus = L"Preprocessing: RETRY";
+        unsigned char hash[ShaderCompileProtocol::HASH_LENGTH];
+        memcpy( hash, pShader->m_pHash, ShaderCompileProtocol::HASH_LENGTH );
 
-                bRemove = true;
-                //m_pProgressInfo[m_uProgressCounter++] = pShader;
-                //m_pProgressInfo[m_uProgressCounter++].m_wsFilename = pShader->m_wsPreprocessFile_with_ISA;
-                }*/
-            }
+        std::vector<BYTE> bytecode;
+        std::string errors;
+        HRESULT hr = m_pCompileClient->Compile( hash, szEntryPoint, szTarget, kuCompileFlags,
+            macros.empty() ? NULL : &macros[0], pShader->m_uNumMacros,
+            source.empty() ? NULL : source.c_str(), source.size(), bytecode, errors );
 
-            if (bRemove)
-            {
-                m_HashList.remove( pShader );
-            }
+        m_Telemetry.EndStage( pShader, ShaderCacheTelemetry::STAGE_COMPILE );
 
-            if (m_bAbort)
+        bool bWritten = false;
+        if (SUCCEEDED( hr ) && !bytecode.empty())
+        {
+            CreateFullPathFromOutputFilename( wsShaderPathName, pShader->m_wsObjectFile );
+            _wfopen_s( &pFile, wsShaderPathName, L"wb" );
+            if (pFile)
             {
-                break;
+                bWritten = (fwrite( &bytecode[0], bytecode.size(), 1, pFile ) == 1);
+                fclose( pFile );
             }
+        }
 
-            Sleep( 1 );
+        if (bWritten)
+        {
+            pShader->m_wsCompileStatus = L"Compiled on Server";
+            m_CreateList.push_back( pShader );
+            it = m_CompileList.erase( it );
+            continue;
+        }
 
+        if (!m_pCompileClient->IsConnected())
+        {
+            // Lost the server; fxc picks up everything that is left
+            OutputDebugStringW( L"\n*** Shader Cache: lost connection to the compile server, falling back to fxc ***\n" );
+            break;
         }
 
+        it++;
     }
-
-}
-
-// a binary predicate implemented as a function:
-bool shader_duplicate_ptr( AMD::ShaderCache::Shader* pFirst, AMD::ShaderCache::Shader* pSecond )
-{
-    return (pFirst == pSecond);
 }
 
 //--------------------------------------------------------------------------------------
@@ -2425,6 +2582,7 @@ void ShaderCache::CompileShaders()
                 {
                     bRemove = true;
                     pShader->m_wsCompileStatus = L"Compiling Shader";
+                    m_Telemetry.BeginStage( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::STAGE_COMPILE );
                     CompileShader( pShader );
 
                     pShader->m_bBeingProcessed = true;
@@ -2480,6 +2638,24 @@ void ShaderCache::CompileShaders()
             for (std::list<Shader*>::iterator it = m_CompileCheckList.begin(); it != m_CompileCheckList.end(); it++)
             {
                 pShader = *it;
+
+                // The whole batch is waited on together, so take the compile time from
+                // the fxc process itself, rather than from when the batch finished
+                FILETIME creationTime, exitTime, kernelTime, userTime;
+                if (GetProcessTimes( pShader->m_hCompileProcessHandle, &creationTime, &exitTime, &kernelTime, &userTime ))
+                {
+                    ULARGE_INTEGER uCreationTime, uExitTime;
+                    uCreationTime.LowPart = creationTime.dwLowDateTime;
+                    uCreationTime.HighPart = creationTime.dwHighDateTime;
+                    uExitTime.LowPart = exitTime.dwLowDateTime;
+                    uExitTime.HighPart = exitTime.dwHighDateTime;
+                    m_Telemetry.EndStage( pShader, ShaderCacheTelemetry::STAGE_COMPILE, (double)(uExitTime.QuadPart - uCreationTime.QuadPart) / 10000.0 );
+                }
+                else
+                {
+                    m_Telemetry.EndStage( pShader, ShaderCacheTelemetry::STAGE_COMPILE );
+                }
+
                 CloseHandle( pShader->m_hCompileProcessHandle );
                 CloseHandle( pShader->m_hCompileThreadHandle );
                 pShader->m_hCompileProcessHandle = NULL;
@@ -2552,6 +2728,7 @@ void ShaderCache::CompileShaders()
                         pShader->m_bShaderUpToDate = true;
                         pShader->m_bGPRsUpToDate = true;
                         m_ErrorList.insert( pShader );
+                        m_Telemetry.SetResult( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::RESULT_COMPILE_ERROR );
                         pShader->m_wsCompileStatus = L"Compiler Error!";
                         if (uNumWorkThreads > 0)
                         {
@@ -2612,12 +2789,21 @@ HRESULT ShaderCache::CreateShaders()
             if (NULL == *(pShader->m_ppShader) || (!pShader->m_bShaderUpToDate))
             {
                 assert( (!pShader->m_bShaderUpToDate) || (NULL != *(pShader->m_ppShader)) );
+                m_Telemetry.BeginStage( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::STAGE_CREATE );
                 hr = CreateShader( pShader );
+                m_Telemetry.EndStage( pShader, ShaderCacheTelemetry::STAGE_CREATE );
                 assert( S_OK == hr );
             }
         } // Else, this is a cloned shader, and we won't be using it for rendering, so don't initialize it.
     }
 
+    m_Telemetry.EndBuild();
+
+    if (m_bCreateHashDigest)
+    {
+        ExportTelemetry();
+    }
+
     return S_OK;
 }
 
@@ -2636,131 +2822,6 @@ void ShaderCache::InvalidateShaders( void )
     }
 }
 
-//--------------------------------------------------------------------------------------
-// The preprocess file generated by fxc can have the full path to the source file in it.
-// Strip that out before you create the hash.
-//--------------------------------------------------------------------------------------
-void ShaderCache::StripPathInfoFromPreprocessFile( Shader* pShader, FILE* pFile, char* pFileBufDst, int iFileSize )
-{
-    // clear out the destination buffer
-    memset( pFileBufDst, '\0', iFileSize );
-
-    // make a plain old char version of our source filename
-    size_t i;
-    char szSourceFileWithBackSlashes[m_uFILENAME_MAX_LENGTH];
-    memset( szSourceFileWithBackSlashes, '\0', sizeof( char[m_uFILENAME_MAX_LENGTH] ) );
-    wcstombs_s( &i, szSourceFileWithBackSlashes, m_uFILENAME_MAX_LENGTH, pShader->m_wsSourceFile, m_uFILENAME_MAX_LENGTH );
-
-    // fxc accepts both forward and back slashes, so convert any forward
-    // slashes to back slashes for consistency
-    char* pForwardSlash = strchr( szSourceFileWithBackSlashes, L'/' );
-    while (pForwardSlash)
-    {
-        *pForwardSlash = '\\';
-        pForwardSlash = strchr( szSourceFileWithBackSlashes, L'/' );
-    }
-
-    // now that we know we have back slashes (if we have slashes at all),
-    // find the last one to strip off any path info
-    char* pFileName = strrchr( szSourceFileWithBackSlashes, '\\' );
-
-    // support the case where the source filename doesn't contain any path info
-    // (this would happen if shaders were in the project working directory instead of
-    // a subfolder)
-    if (!pFileName)
-    {
-        pFileName = szSourceFileWithBackSlashes;
-    }
-    else
-    {
-        // if there was a slash, you are now pointing to it,
-        // so go one past it to get just the filename
-        pFileName++;
-    }
-
-
-    char szLine[m_uCOMMAND_LINE_MAX_LENGTH];
-    char* pLine = szLine;
-    char szFxcLineDirective[32];
-    strcpy_s( szFxcLineDirective, 32, "#line" );
-
-    while (fgets( pLine, m_uCOMMAND_LINE_MAX_LENGTH, pFile ))
-    {
-        // check if this is a line directive
-        char* pStartOfFxcLineDirective = strstr( pLine, szFxcLineDirective );
-        if (pStartOfFxcLineDirective)
-        {
-            // if it is, then check if the filename appears after #line
-            if (!strstr( pStartOfFxcLineDirective, pFileName ))
-            {
-                // if it is a line directive, but not one containing the filename,
-                // copy it over to the destination buffer
-                strcat_s( pFileBufDst, iFileSize, pLine );
-            }
-            // else, assume it is one of the problematic #line directives
-            // that contains full path info, and skip it
-        }
-        else
-        {
-            // else, not a line directive, so copy it over to the destination buffer
-            strcat_s( pFileBufDst, iFileSize, pLine );
-        }
-    }
-}
-
-
-//--------------------------------------------------------------------------------------
-// Creates a hash from a given shader
-//--------------------------------------------------------------------------------------
-BOOL ShaderCache::CreateHashFromPreprocessFile( Shader* pShader )
-{
-    FILE* pFile = NULL;
-    wchar_t wsShaderPathName[m_uPATHNAME_MAX_LENGTH];
-
-    CreateFullPathFromOutputFilename( wsShaderPathName, pShader->m_wsPreprocessFile );
-
-    const unsigned int kuMaxPath = AMD::ShaderCache::m_uPATHNAME_MAX_LENGTH;
-    const size_t kPathLength = wcslen( wsShaderPathName );
-    if (kPathLength >= kuMaxPath)
-    {
-        wchar_t wsErrorText[m_uCOMMAND_LINE_MAX_LENGTH];
-        swprintf_s( wsErrorText, L"Error: PATH LENGTH TOO LONG [%u/%u]\n\n%s", (unsigned)kPathLength, kuMaxPath, wsShaderPathName );
-        MessageBoxW( NULL, wsErrorText, L"ERROR: Path Length Too Long", MB_OK );
-        DebugBreak();
-    }
-
-    _wfopen_s( &pFile, wsShaderPathName, L"rt" );
-
-    if (pFile)
-    {
-        fseek( pFile, 0, SEEK_END );
-        int iFileSize = ftell( pFile );
-        rewind( pFile );
-        char* pFileBuf = new char[iFileSize];
-
-        // Strip path info from the preprocessed file, as otherwise this causes problems
-        // if you move a project on disk. Without this, it triggers a full rebuild of the
-        // shader cache, purely because the path has changed
-        StripPathInfoFromPreprocessFile( pShader, pFile, pFileBuf, iFileSize );
-
-        if (NULL != pShader->m_pHash)
-        {
-            free( pShader->m_pHash );
-            pShader->m_pHash = NULL;
-            pShader->m_uHashLength = 0;
-        }
-
-        CreateHash( pFileBuf, iFileSize, &pShader->m_pHash, &pShader->m_uHashLength );
-
-        delete [] pFileBuf;
-        fclose( pFile );
-
-        return TRUE;
-    }
-
-    return FALSE;
-}
-
 //--------------------------------------------------------------------------------------
 // Creates a hash for the shader filename
 //--------------------------------------------------------------------------------------
@@ -3041,35 +3102,76 @@ BOOL ShaderCache::CompileShader( Shader* pShader )
 
 
 //--------------------------------------------------------------------------------------
-// Preprocesses a shader
+// Preprocesses a shader in-process, and creates its hash from the canonical token stream.
+// The stream contains no path info, so moving a project on disk doesn't invalidate the
+// cache. A copy of the stream is written to the preprocess file for the hash digest.
 //--------------------------------------------------------------------------------------
 BOOL ShaderCache::PreprocessShader( Shader* pShader )
 {
-    STARTUPINFO si;
-    PROCESS_INFORMATION pi;
+    size_t i;
+    char szShaderSourceDir[m_uPATHNAME_MAX_LENGTH];
+    char szSourceFile[m_uPATHNAME_MAX_LENGTH];
+    memset( szShaderSourceDir, '\0', sizeof( char[m_uPATHNAME_MAX_LENGTH] ) );
+    memset( szSourceFile, '\0', sizeof( char[m_uPATHNAME_MAX_LENGTH] ) );
+    wcstombs_s( &i, szShaderSourceDir, m_uPATHNAME_MAX_LENGTH, m_wsShaderSourceDir, _TRUNCATE );
+    wcstombs_s( &i, szSourceFile, m_uPATHNAME_MAX_LENGTH, pShader->m_wsSourceFile, _TRUNCATE );
 
-    ZeroMemory( &si, sizeof( si ) );
-    si.cb = sizeof( si );
-    ZeroMemory( &pi, sizeof( pi ) );
+    m_Telemetry.BeginStage( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::STAGE_PREPROCESS );
 
-    // Start the child process.
-    BOOL bSuccess = CreateProcess( m_wsFxcExePath,   // Application name
-        pShader->m_wsPreprocessCommandLine, // Command line
-        NULL,             // Process handle not inheritable
-        NULL,             // Thread handle not inheritable
-        FALSE,            // Set handle inheritance to FALSE
-        CREATE_NO_WINDOW, // Don't make a console window
-        NULL,             // Use parent's environment block
-        NULL,             // Use parent's starting directory
-        &si,              // Pointer to STARTUPINFO structure
-        &pi );            // Pointer to PROCESS_INFORMATION structure
+    ShaderPreprocessor preprocessor;
+    preprocessor.AddIncludePath( szShaderSourceDir );
+    for (unsigned int iMacro = 0; iMacro < pShader->m_uNumMacros; ++iMacro)
+    {
+        preprocessor.Define( pShader->m_pMacros[iMacro].m_wsName, pShader->m_pMacros[iMacro].m_iValue );
+    }
 
-    assert( pShader->m_hCompileProcessHandle == NULL );
-    assert( pShader->m_hCompileThreadHandle == NULL );
-    pShader->m_hCompileProcessHandle = pi.hProcess;
-    pShader->m_hCompileThreadHandle = pi.hThread;
+    std::string sourcePath( szShaderSourceDir );
+    sourcePath += "\\";
+    sourcePath += szSourceFile;
 
-    return bSuccess;
+    std::string preprocessed;
+    const bool kbPreprocessed = preprocessor.PreprocessFile( sourcePath.c_str(), preprocessed );
+
+    m_Telemetry.EndStage( pShader, ShaderCacheTelemetry::STAGE_PREPROCESS );
+
+    // Record the include graph, so the file watcher knows which shaders a change affects
+    EnterCriticalSection( &m_HotReload_CriticalSection );
+    pShader->m_Dependencies.clear();
+    for (size_t iDependency = 0; iDependency < preprocessor.GetDependencies().size(); ++iDependency)
+    {
+        pShader->m_Dependencies.push_back( FileWatcher::NormalizePath( preprocessor.GetDependencies()[iDependency] ) );
+    }
+    LeaveCriticalSection( &m_HotReload_CriticalSection );
+
+    if (!kbPreprocessed)
+    {
+        OutputDebugStringA( "\n\n*** Shader Cache: Preprocessor error(s) ***\n" );
+        OutputDebugStringA( preprocessor.GetErrors().c_str() );
+        return FALSE;
+    }
+
+    FILE* pFile = NULL;
+    wchar_t wsShaderPathName[m_uPATHNAME_MAX_LENGTH];
+    CreateFullPathFromOutputFilename( wsShaderPathName, pShader->m_wsPreprocessFile );
+    _wfopen_s( &pFile, wsShaderPathName, L"wb" );
+    if (pFile)
+    {
+        fwrite( preprocessed.c_str(), preprocessed.size(), 1, pFile );
+        fclose( pFile );
+    }
+
+    if (NULL != pShader->m_pHash)
+    {
+        free( pShader->m_pHash );
+        pShader->m_pHash = NULL;
+        pShader->m_uHashLength = 0;
+    }
+
+    m_Telemetry.BeginStage( pShader, pShader->m_wsRawFileName, ShaderCacheTelemetry::STAGE_HASH );
+    CreateHash( preprocessed.c_str(), (int)preprocessed.size(), &pShader->m_pHash, &pShader->m_uHashLength );
+    m_Telemetry.EndStage( pShader, ShaderCacheTelemetry::STAGE_HASH );
+
+    return (NULL != pShader->m_pHash);
 }
 
 //--------------------------------------------------------------------------------------
@@ -38,6 +38,9 @@
 #include <set>
 #include <list>
 #include <vector>
+#include <string>
+
+#include "ShaderCacheTelemetry.h"
 
 // The following two defines (AMD_SDK_INTERNAL_BUILD and AMD_SDK_PREBUILT_RELEASE_EXE) are for internal AMD use.
 // If you don't work for AMD, you shouldn't need to touch them.
@@ -74,6 +77,9 @@
 
 namespace AMD
 {
+    class ShaderCompileServer;
+    class ShaderCompileClient;
+    class FileWatcher;
 
     class ShaderCache
     {
@@ -195,7 +201,6 @@ namespace AMD
             wchar_t                     m_wsHashFile[m_uFILENAME_MAX_LENGTH];
             wchar_t                     m_wsCommandLine[m_uCOMMAND_LINE_MAX_LENGTH];
             wchar_t                     m_wsISACommandLine[m_uCOMMAND_LINE_MAX_LENGTH];
-            wchar_t                     m_wsPreprocessCommandLine[m_uCOMMAND_LINE_MAX_LENGTH];
 
             wchar_t                     m_wsObjectFile_with_ISA[m_uFILENAME_MAX_LENGTH];
             wchar_t                     m_wsPreprocessFile_with_ISA[m_uFILENAME_MAX_LENGTH];
@@ -226,6 +231,10 @@ namespace AMD
             HANDLE                      m_hCompileProcessHandle;
             HANDLE                      m_hCompileThreadHandle;
 
+            // Normalized paths of the source file and everything it includes, from the last
+            // time it was preprocessed (empty if it hasn't been yet)
+            std::vector<std::string>    m_Dependencies;
+
             void SetupHashedFilename( void );
         };
 
@@ -294,24 +303,37 @@ namespace AMD
         // Called by the app to override optimizations when compiling shaders in release mode
         void ForceDebugShaders( bool bForce ) { m_bForceDebugShaders = bForce; }
 
-        // Do not call this function
+        // Called by the app (before GenerateShaders) to compile through a shared ShaderCompileServer.
+        // If no server is listening and i_kbHostIfNotRunning is set, this process hosts one, which
+        // other samples can then connect to. Shaders the server can't build fall back to fxc.
+        bool EnableCompileServer( const wchar_t* pwsPipeName = NULL, const bool i_kbHostIfNotRunning = true );
+
+        // Per-shader stage timings, cache hit/miss counts and critical path of the last build
+        const ShaderCacheTelemetry& GetTelemetry() const { return m_Telemetry; }
+
+        // Exports the telemetry of the last build as JSON and/or Chrome trace events; a NULL
+        // path skips that file. Relative paths are written to the Shaders\Cache directory.
+        bool ExportTelemetry( const wchar_t* pwsJSONFile = L"ShaderCacheTelemetry.json", const wchar_t* pwsTraceFile = L"ShaderCacheTrace.json" );
+
+        // Do not call these functions
         void GenerateShadersThreadProc();
+        void HotReloadShadersThreadProc();
 
     private:
 
         // Preprocessing, compilation, and creation methods
         void PreprocessShaders();
         void CompileShaders();
+        void CompileShadersOnServer();
         void InvalidateShaders();
 
         HRESULT CreateShaders();
         BOOL PreprocessShader( Shader* pShader );
         BOOL CompileShader( Shader* pShader );
+        unsigned int GetCompileFlags() const;
         HRESULT CreateShader( Shader* pShader );
 
         // Hash methods
-        void StripPathInfoFromPreprocessFile( Shader* pShader, FILE* pFile, char* pFileBufDst, int iFileSize );
-        BOOL CreateHashFromPreprocessFile( Shader* pShader );
         static void CreateHash( const char* data, int iFileSize, BYTE** hash, long* len );
         void WriteHashFile( Shader* pShader );
         BOOL CompareHash( Shader* pShader );
@@ -319,7 +341,8 @@ namespace AMD
 
         // Watch methods (for automatic shader recompilation when changed)
         bool WatchDirectoryForChanges( void );
-        static void __stdcall onDirectoryChangeEventTriggered( void* args, BOOLEAN /*timeout*/ );
+        static void OnWatchedFilesChanged( const std::vector<std::string>& i_ChangedFiles, void* pUserData );
+        void StartHotReload();
 
         // Check methodss
         BOOL CheckFXC();
@@ -379,7 +402,6 @@ namespace AMD
         std::list<Shader*>      m_ShaderSourceList;
         std::list<Shader*>      m_ShaderList;
         std::list<Shader*>      m_PreprocessList;
-        std::list<Shader*>      m_HashList;
         std::list<Shader*>      m_CompileList;
         std::list<Shader*>      m_CompileCheckList;
         std::list<Shader*>      m_CreateList;
@@ -425,8 +447,13 @@ namespace AMD
 #endif
         CRITICAL_SECTION        m_CompileShaders_CriticalSection;
         CRITICAL_SECTION        m_GenISA_CriticalSection;
-        HANDLE                  m_watchHandle;
-        HANDLE                  m_waitPoolHandle;
+        ShaderCompileServer*    m_pCompileServer;
+        ShaderCompileClient*    m_pCompileClient;
+        ShaderCacheTelemetry    m_Telemetry;
+        FileWatcher*            m_pFileWatcher;
+        std::set<Shader*>       m_HotReloadSet;
+        CRITICAL_SECTION        m_HotReload_CriticalSection;
+        bool                    m_bHotReloadInProgress;
         unsigned int            m_shaderErrorRenderedCount;
         bool                    m_bRecompileTouchedShaders;
         bool                    m_bShowShaderErrors;
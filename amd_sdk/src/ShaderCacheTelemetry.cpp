@@ -0,0 +1,476 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: ShaderCacheTelemetry.cpp
+//
+// Implementation of the ShaderCache build telemetry.
+//--------------------------------------------------------------------------------------
+#include "..\\..\\DXUT\\Core\\DXUT.h"
+#include "ShaderCacheTelemetry.h"
+
+using namespace AMD;
+
+namespace
+{
+    const char* const kResultNames[ShaderCacheTelemetry::RESULT_MAX] =
+    {
+        "unknown",
+        "hit",
+        "miss",
+        "error",
+    };
+
+    // Used for sorting shaders by the total time spent working on them, longest first
+    struct SortByWorkTime
+    {
+        template< typename T >
+        bool operator()( const T* pA, const T* pB ) const { return pA->GetWorkTime() > pB->GetWorkTime(); }
+    };
+}
+
+
+//--------------------------------------------------------------------------------------
+// Constructor
+//--------------------------------------------------------------------------------------
+ShaderCacheTelemetry::ShaderCacheTelemetry()
+    : m_fBuildEnd( -1.0 )
+{
+    InitializeCriticalSection( &m_CriticalSection );
+    QueryPerformanceFrequency( &m_Frequency );
+    QueryPerformanceCounter( &m_BuildStart );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Destructor
+//--------------------------------------------------------------------------------------
+ShaderCacheTelemetry::~ShaderCacheTelemetry()
+{
+    DeleteCriticalSection( &m_CriticalSection );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Starts a new build
+//--------------------------------------------------------------------------------------
+void ShaderCacheTelemetry::BeginBuild()
+{
+    EnterCriticalSection( &m_CriticalSection );
+    m_Records.clear();
+    m_fBuildEnd = -1.0;
+    QueryPerformanceCounter( &m_BuildStart );
+    LeaveCriticalSection( &m_CriticalSection );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Ends the current build
+//--------------------------------------------------------------------------------------
+void ShaderCacheTelemetry::EndBuild()
+{
+    EnterCriticalSection( &m_CriticalSection );
+    m_fBuildEnd = Now();
+    LeaveCriticalSection( &m_CriticalSection );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Milliseconds since the start of the build
+//--------------------------------------------------------------------------------------
+double ShaderCacheTelemetry::Now() const
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter( &now );
+    return (double)(now.QuadPart - m_BuildStart.QuadPart) * 1000.0 / (double)m_Frequency.QuadPart;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Records the start of a stage
+//--------------------------------------------------------------------------------------
+void ShaderCacheTelemetry::BeginStage( const void* pShader, const wchar_t* pwsName, STAGE eStage )
+{
+    assert( eStage < STAGE_MAX );
+
+    EnterCriticalSection( &m_CriticalSection );
+    ShaderRecord& record = GetRecord( pShader, pwsName );
+    record.m_fStart[eStage] = Now();
+    record.m_fEnd[eStage] = -1.0;
+    LeaveCriticalSection( &m_CriticalSection );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Records the end of a stage
+//--------------------------------------------------------------------------------------
+void ShaderCacheTelemetry::EndStage( const void* pShader, STAGE eStage, double fDurationMs )
+{
+    assert( eStage < STAGE_MAX );
+
+    EnterCriticalSection( &m_CriticalSection );
+    std::map<const void*, ShaderRecord>::iterator it = m_Records.find( pShader );
+    if ((it != m_Records.end()) && (it->second.m_fStart[eStage] >= 0.0))
+    {
+        ShaderRecord& record = it->second;
+        record.m_fEnd[eStage] = (fDurationMs >= 0.0) ? (record.m_fStart[eStage] + fDurationMs) : Now();
+    }
+    LeaveCriticalSection( &m_CriticalSection );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Records how the shader was obtained
+//--------------------------------------------------------------------------------------
+void ShaderCacheTelemetry::SetResult( const void* pShader, const wchar_t* pwsName, RESULT eResult )
+{
+    EnterCriticalSection( &m_CriticalSection );
+    GetRecord( pShader, pwsName ).m_eResult = eResult;
+    LeaveCriticalSection( &m_CriticalSection );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Accessors
+//--------------------------------------------------------------------------------------
+unsigned int ShaderCacheTelemetry::GetNumShaders() const
+{
+    return (unsigned int)m_Records.size();
+}
+
+unsigned int ShaderCacheTelemetry::GetResultCount( RESULT eResult ) const
+{
+    unsigned int uCount = 0;
+    for (std::map<const void*, ShaderRecord>::const_iterator it = m_Records.begin(); it != m_Records.end(); it++)
+    {
+        if (it->second.m_eResult == eResult)
+        {
+            uCount++;
+        }
+    }
+    return uCount;
+}
+
+double ShaderCacheTelemetry::GetBuildTime() const
+{
+    // If the build is still in progress (or never ended), use the last recorded activity
+    double fEnd = m_fBuildEnd;
+    for (std::map<const void*, ShaderRecord>::const_iterator it = m_Records.begin(); it != m_Records.end(); it++)
+    {
+        fEnd = std::max( fEnd, it->second.GetFinishTime() );
+    }
+    return fEnd;
+}
+
+const wchar_t* ShaderCacheTelemetry::GetStageName( STAGE eStage )
+{
+    switch (eStage)
+    {
+    case STAGE_PREPROCESS:  return L"preprocess";
+    case STAGE_HASH:        return L"hash";
+    case STAGE_COMPILE:     return L"compile";
+    case STAGE_CREATE:      return L"create";
+    default:                return L"unknown";
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Sum of the time spent in each recorded stage
+//--------------------------------------------------------------------------------------
+double ShaderCacheTelemetry::ShaderRecord::GetWorkTime() const
+{
+    double fTotal = 0.0;
+    for (int iStage = 0; iStage < STAGE_MAX; iStage++)
+    {
+        if (HasStage( iStage ))
+        {
+            fTotal += m_fEnd[iStage] - m_fStart[iStage];
+        }
+    }
+    return fTotal;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Time at which the shader's last stage ended
+//--------------------------------------------------------------------------------------
+double ShaderCacheTelemetry::ShaderRecord::GetFinishTime() const
+{
+    double fFinish = 0.0;
+    for (int iStage = 0; iStage < STAGE_MAX; iStage++)
+    {
+        if (HasStage( iStage ))
+        {
+            fFinish = std::max( fFinish, m_fEnd[iStage] );
+        }
+    }
+    return fFinish;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Finds (or adds) the record for a shader. Must be called inside the critical section.
+//--------------------------------------------------------------------------------------
+ShaderCacheTelemetry::ShaderRecord& ShaderCacheTelemetry::GetRecord( const void* pShader, const wchar_t* pwsName )
+{
+    std::map<const void*, ShaderRecord>::iterator it = m_Records.find( pShader );
+    if (it != m_Records.end())
+    {
+        return it->second;
+    }
+
+    ShaderRecord& record = m_Records[pShader];
+    record.m_Name = pwsName ? pwsName : L"";
+    record.m_uIndex = (unsigned int)m_Records.size() - 1;
+    record.m_eResult = RESULT_UNKNOWN;
+    for (int iStage = 0; iStage < STAGE_MAX; iStage++)
+    {
+        record.m_fStart[iStage] = -1.0;
+        record.m_fEnd[iStage] = -1.0;
+    }
+    return record;
+}
+
+
+//--------------------------------------------------------------------------------------
+// The shaders are independent of each other, so the critical path of the build is the
+// pipeline of whichever shader finished last
+//--------------------------------------------------------------------------------------
+const ShaderCacheTelemetry::ShaderRecord* ShaderCacheTelemetry::FindCriticalShader() const
+{
+    const ShaderRecord* pCritical = NULL;
+    for (std::map<const void*, ShaderRecord>::const_iterator it = m_Records.begin(); it != m_Records.end(); it++)
+    {
+        if (!pCritical || (it->second.GetFinishTime() > pCritical->GetFinishTime()))
+        {
+            pCritical = &it->second;
+        }
+    }
+    return pCritical;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Returns the records sorted by work time, longest first
+//--------------------------------------------------------------------------------------
+void ShaderCacheTelemetry::GetSortedRecords( std::vector<const ShaderRecord*>& o_Records ) const
+{
+    o_Records.clear();
+    for (std::map<const void*, ShaderRecord>::const_iterator it = m_Records.begin(); it != m_Records.end(); it++)
+    {
+        o_Records.push_back( &it->second );
+    }
+    std::sort( o_Records.begin(), o_Records.end(), SortByWorkTime() );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Writes a quoted, escaped, UTF-8 JSON string
+//--------------------------------------------------------------------------------------
+void ShaderCacheTelemetry::WriteJSONString( FILE* pFile, const std::wstring& i_String )
+{
+    std::string utf8;
+    if (!i_String.empty())
+    {
+        int iLength = WideCharToMultiByte( CP_UTF8, 0, i_String.c_str(), (int)i_String.size(), NULL, 0, NULL, NULL );
+        utf8.resize( iLength );
+        WideCharToMultiByte( CP_UTF8, 0, i_String.c_str(), (int)i_String.size(), &utf8[0], iLength, NULL, NULL );
+    }
+
+    fputc( '"', pFile );
+    for (size_t i = 0; i < utf8.size(); i++)
+    {
+        const unsigned char c = (unsigned char)utf8[i];
+        if ((c == '"') || (c == '\\'))
+        {
+            fputc( '\\', pFile );
+            fputc( c, pFile );
+        }
+        else if (c < 0x20)
+        {
+            fprintf( pFile, "\\u%04x", c );
+        }
+        else
+        {
+            fputc( c, pFile );
+        }
+    }
+    fputc( '"', pFile );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Exports the summary, critical path, and per-shader stage times as JSON
+//--------------------------------------------------------------------------------------
+bool ShaderCacheTelemetry::ExportJSON( const wchar_t* pwsPath ) const
+{
+    FILE* pFile = NULL;
+    _wfopen_s( &pFile, pwsPath, L"wt" );
+    if (!pFile)
+    {
+        return false;
+    }
+
+    EnterCriticalSection( (CRITICAL_SECTION*)&m_CriticalSection );
+
+    const unsigned int kuHits = GetResultCount( RESULT_CACHE_HIT );
+    const unsigned int kuMisses = GetResultCount( RESULT_CACHE_MISS );
+    const unsigned int kuErrors = GetResultCount( RESULT_COMPILE_ERROR );
+    const unsigned int kuLookups = kuHits + kuMisses + kuErrors;
+
+    fprintf( pFile, "{\n" );
+    fprintf( pFile, "  \"buildTimeMs\": %.3f,\n", GetBuildTime() );
+    fprintf( pFile, "  \"shaders\": %u,\n", GetNumShaders() );
+    fprintf( pFile, "  \"cacheHits\": %u,\n", kuHits );
+    fprintf( pFile, "  \"cacheMisses\": %u,\n", kuMisses );
+    fprintf( pFile, "  \"compileErrors\": %u,\n", kuErrors );
+    fprintf( pFile, "  \"hitRatio\": %.4f,\n", kuLookups ? (double)kuHits / (double)kuLookups : 0.0 );
+
+    // Total time spent in each stage, summed across all shaders
+    fprintf( pFile, "  \"stageTotalsMs\": {" );
+    for (int iStage = 0; iStage < STAGE_MAX; iStage++)
+    {
+        double fTotal = 0.0;
+        for (std::map<const void*, ShaderRecord>::const_iterator it = m_Records.begin(); it != m_Records.end(); it++)
+        {
+            if (it->second.HasStage( iStage ))
+            {
+                fTotal += it->second.m_fEnd[iStage] - it->second.m_fStart[iStage];
+            }
+        }
+        fprintf( pFile, "%s\"%S\": %.3f", iStage ? ", " : " ", GetStageName( (STAGE)iStage ), fTotal );
+    }
+    fprintf( pFile, " },\n" );
+
+    // Critical path: the stages of the last shader to finish, and the gaps between them
+    const ShaderRecord* pCritical = FindCriticalShader();
+    fprintf( pFile, "  \"criticalPath\": " );
+    if (pCritical)
+    {
+        double fPrevEnd = 0.0;
+        double fWait = 0.0;
+        fprintf( pFile, "{\n    \"shader\": " );
+        WriteJSONString( pFile, pCritical->m_Name );
+        fprintf( pFile, ",\n    \"finishMs\": %.3f,\n    \"workMs\": %.3f,\n    \"stages\": [", pCritical->GetFinishTime(), pCritical->GetWorkTime() );
+
+        bool bFirst = true;
+        for (int iStage = 0; iStage < STAGE_MAX; iStage++)
+        {
+            if (!pCritical->HasStage( iStage ))
+            {
+                continue;
+            }
+            const double kfWait = std::max( 0.0, pCritical->m_fStart[iStage] - fPrevEnd );
+            fWait += kfWait;
+            fPrevEnd = pCritical->m_fEnd[iStage];
+            fprintf( pFile, "%s\n      { \"stage\": \"%S\", \"waitMs\": %.3f, \"startMs\": %.3f, \"durationMs\": %.3f }",
+                bFirst ? "" : ",", GetStageName( (STAGE)iStage ), kfWait, pCritical->m_fStart[iStage], pCritical->m_fEnd[iStage] - pCritical->m_fStart[iStage] );
+            bFirst = false;
+        }
+        fprintf( pFile, "\n    ],\n    \"waitMs\": %.3f\n  },\n", fWait );
+    }
+    else
+    {
+        fprintf( pFile, "null,\n" );
+    }
+
+    // Per-shader breakdown, most expensive first
+    std::vector<const ShaderRecord*> records;
+    GetSortedRecords( records );
+
+    fprintf( pFile, "  \"shaderTimes\": [" );
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const ShaderRecord* pRecord = records[i];
+        fprintf( pFile, "%s\n    { \"name\": ", i ? "," : "" );
+        WriteJSONString( pFile, pRecord->m_Name );
+        fprintf( pFile, ", \"result\": \"%s\", \"workMs\": %.3f", kResultNames[pRecord->m_eResult], pRecord->GetWorkTime() );
+        for (int iStage = 0; iStage < STAGE_MAX; iStage++)
+        {
+            if (pRecord->HasStage( iStage ))
+            {
+                fprintf( pFile, ", \"%SMs\": %.3f", GetStageName( (STAGE)iStage ), pRecord->m_fEnd[iStage] - pRecord->m_fStart[iStage] );
+            }
+        }
+        fprintf( pFile, " }" );
+    }
+    fprintf( pFile, "\n  ]\n}\n" );
+
+    LeaveCriticalSection( (CRITICAL_SECTION*)&m_CriticalSection );
+
+    fclose( pFile );
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Exports the stages as Chrome trace events (chrome://tracing), one row per shader
+//--------------------------------------------------------------------------------------
+bool ShaderCacheTelemetry::ExportChromeTrace( const wchar_t* pwsPath ) const
+{
+    FILE* pFile = NULL;
+    _wfopen_s( &pFile, pwsPath, L"wt" );
+    if (!pFile)
+    {
+        return false;
+    }
+
+    EnterCriticalSection( (CRITICAL_SECTION*)&m_CriticalSection );
+
+    const ShaderRecord* pCritical = FindCriticalShader();
+    bool bFirst = true;
+
+    fprintf( pFile, "{\n\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [" );
+
+    for (std::map<const void*, ShaderRecord>::const_iterator it = m_Records.begin(); it != m_Records.end(); it++)
+    {
+        const ShaderRecord& record = it->second;
+
+        // Name the row after the shader
+        fprintf( pFile, "%s\n{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": { \"name\": ", bFirst ? "" : ",", record.m_uIndex );
+        WriteJSONString( pFile, record.m_Name );
+        fprintf( pFile, " } }" );
+        bFirst = false;
+
+        for (int iStage = 0; iStage < STAGE_MAX; iStage++)
+        {
+            if (!record.HasStage( iStage ))
+            {
+                continue;
+            }
+
+            // Trace timestamps are in microseconds
+            fprintf( pFile, ",\n{ \"name\": \"%S\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.1f, \"dur\": %.1f, \"args\": { \"result\": \"%s\" } }",
+                GetStageName( (STAGE)iStage ), (&record == pCritical) ? "ShaderCache,critical" : "ShaderCache",
+                record.m_uIndex, record.m_fStart[iStage] * 1000.0, (record.m_fEnd[iStage] - record.m_fStart[iStage]) * 1000.0,
+                kResultNames[record.m_eResult] );
+        }
+    }
+
+    fprintf( pFile, "\n]\n}\n" );
+
+    LeaveCriticalSection( (CRITICAL_SECTION*)&m_CriticalSection );
+
+    fclose( pFile );
+    return true;
+}
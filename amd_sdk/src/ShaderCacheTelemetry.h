@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: ShaderCacheTelemetry.h
+//
+// Records how long each shader spends in each stage of the ShaderCache pipeline
+// (preprocess, hash, compile, create), along with cache hit/miss counts, and works out
+// the critical path of the build: the shader that finished last, and how much of its
+// time was spent working versus waiting for a free compile slot or the main thread.
+//
+// The results can be exported as JSON (for scripts), and as Chrome trace events
+// (load in chrome://tracing) with one row per shader.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_SHADER_CACHE_TELEMETRY_H
+#define AMD_SDK_SHADER_CACHE_TELEMETRY_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace AMD
+{
+    class ShaderCacheTelemetry
+    {
+    public:
+
+        // Pipeline stages
+        typedef enum STAGE_t
+        {
+            STAGE_PREPROCESS,
+            STAGE_HASH,
+            STAGE_COMPILE,
+            STAGE_CREATE,
+            STAGE_MAX
+        } STAGE;
+
+        // How the shader's bytecode was obtained
+        typedef enum RESULT_t
+        {
+            RESULT_UNKNOWN,
+            RESULT_CACHE_HIT,       // Object file was up to date
+            RESULT_CACHE_MISS,      // Had to be compiled
+            RESULT_COMPILE_ERROR,
+            RESULT_MAX
+        } RESULT;
+
+        ShaderCacheTelemetry();
+        ~ShaderCacheTelemetry();
+
+        // Starts a new build, discarding the previous one
+        void BeginBuild();
+
+        // Marks the end of the build (all shaders created)
+        void EndBuild();
+
+        // Milliseconds since BeginBuild
+        double Now() const;
+
+        // Stage timing. If fDurationMs is not negative, the stage is taken to have lasted
+        // that long from its start (e.g. a compiler process's own run time), otherwise it
+        // ends now.
+        void BeginStage( const void* pShader, const wchar_t* pwsName, STAGE eStage );
+        void EndStage( const void* pShader, STAGE eStage, double fDurationMs = -1.0 );
+
+        void SetResult( const void* pShader, const wchar_t* pwsName, RESULT eResult );
+
+        unsigned int GetNumShaders() const;
+        unsigned int GetResultCount( RESULT eResult ) const;
+        double GetBuildTime() const;
+
+        // Export methods
+        bool ExportJSON( const wchar_t* pwsPath ) const;
+        bool ExportChromeTrace( const wchar_t* pwsPath ) const;
+
+        static const wchar_t* GetStageName( STAGE eStage );
+
+    private:
+
+        struct ShaderRecord
+        {
+            std::wstring    m_Name;
+            unsigned int    m_uIndex;       // order of first appearance, used as the trace row
+            RESULT          m_eResult;
+            double          m_fStart[STAGE_MAX];
+            double          m_fEnd[STAGE_MAX];
+
+            bool HasStage( int iStage ) const { return (m_fStart[iStage] >= 0.0) && (m_fEnd[iStage] >= m_fStart[iStage]); }
+            double GetWorkTime() const;
+            double GetFinishTime() const;
+        };
+
+        ShaderRecord& GetRecord( const void* pShader, const wchar_t* pwsName );
+        const ShaderRecord* FindCriticalShader() const;
+        void GetSortedRecords( std::vector<const ShaderRecord*>& o_Records ) const;
+
+        static void WriteJSONString( FILE* pFile, const std::wstring& i_String );
+
+        std::map<const void*, ShaderRecord>     m_Records;
+        CRITICAL_SECTION                        m_CriticalSection;
+        LARGE_INTEGER                           m_Frequency;
+        LARGE_INTEGER                           m_BuildStart;
+        double                                  m_fBuildEnd;
+    };
+
+} // namespace AMD
+
+#endif
@@ -0,0 +1,862 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: ShaderCompileServer.cpp
+//
+// Implementation of the shader compile server and client.
+//--------------------------------------------------------------------------------------
+#include "..\\..\\DXUT\\Core\\DXUT.h"
+#include "ShaderCompileServer.h"
+
+using namespace AMD;
+using namespace AMD::ShaderCompileProtocol;
+
+namespace
+{
+    // Magic number at the start of each archive file
+    const unsigned int kuArchiveMagic = 0x41435341; // 'ASCA'
+
+    // Pipe buffer sizes
+    const DWORD kdwPipeBufferSize = 64 * 1024;
+
+    // Passed to the client thread proc
+    struct ClientThreadArgs
+    {
+        ShaderCompileServer*    m_pServer;
+        HANDLE                  m_hPipe;
+    };
+
+    DWORD WINAPI ListenThreadProc_( void* pParameter )
+    {
+        ShaderCompileServer* pServer = (ShaderCompileServer*)pParameter;
+        pServer->ListenThreadProc();
+        return 0;
+    }
+
+    DWORD WINAPI ClientThreadProc_( void* pParameter )
+    {
+        ClientThreadArgs* pArgs = (ClientThreadArgs*)pParameter;
+        pArgs->m_pServer->ClientThreadProc( pArgs->m_hPipe );
+        delete pArgs;
+        return 0;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Reads or writes exactly dwSize bytes. If hStopEvent is not NULL, the pipe must have been
+    // opened for overlapped I/O, and the transfer is abandoned when the event is signaled.
+    //--------------------------------------------------------------------------------------
+    bool TransferAll( HANDLE hPipe, bool bWrite, void* pData, DWORD dwSize, HANDLE hStopEvent )
+    {
+        BYTE* pBytes = (BYTE*)pData;
+        OVERLAPPED overlapped;
+        ZeroMemory( &overlapped, sizeof( overlapped ) );
+        if (hStopEvent)
+        {
+            overlapped.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+        }
+
+        bool bResult = true;
+        while (dwSize > 0)
+        {
+            DWORD dwTransferred = 0;
+            BOOL bOK = bWrite ?
+                WriteFile( hPipe, pBytes, dwSize, &dwTransferred, hStopEvent ? &overlapped : NULL ) :
+                ReadFile( hPipe, pBytes, dwSize, &dwTransferred, hStopEvent ? &overlapped : NULL );
+
+            if (!bOK && hStopEvent && (GetLastError() == ERROR_IO_PENDING))
+            {
+                HANDLE handles[2] = { overlapped.hEvent, hStopEvent };
+                if (WaitForMultipleObjects( 2, handles, FALSE, INFINITE ) != WAIT_OBJECT_0)
+                {
+                    CancelIo( hPipe );
+                    GetOverlappedResult( hPipe, &overlapped, &dwTransferred, TRUE );
+                    bResult = false;
+                    break;
+                }
+                bOK = GetOverlappedResult( hPipe, &overlapped, &dwTransferred, FALSE );
+            }
+
+            if (!bOK || (dwTransferred == 0))
+            {
+                bResult = false;
+                break;
+            }
+
+            pBytes += dwTransferred;
+            dwSize -= dwTransferred;
+        }
+
+        if (overlapped.hEvent)
+        {
+            CloseHandle( overlapped.hEvent );
+        }
+
+        return bResult;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // 64-bit FNV-1a, used to turn a request key into an archive filename
+    //--------------------------------------------------------------------------------------
+    unsigned long long HashString( const std::string& i_String )
+    {
+        unsigned long long uHash = 14695981039346656037ULL;
+        for (size_t i = 0; i < i_String.size(); i++)
+        {
+            uHash ^= (unsigned char)i_String[i];
+            uHash *= 1099511628211ULL;
+        }
+        return uHash;
+    }
+
+    // Copies a fixed length string field, guaranteeing termination
+    template< size_t N >
+    void CopyField( char (&o_Dst)[N], const char* pszSrc )
+    {
+        strncpy_s( o_Dst, N, pszSrc ? pszSrc : "", _TRUNCATE );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Constructor
+//--------------------------------------------------------------------------------------
+ShaderCompileServer::ShaderCompileServer()
+    : m_pfnCompile( NULL )
+    , m_pUserData( NULL )
+    , m_hListenThread( NULL )
+    , m_hStopEvent( NULL )
+    , m_hFirstPipe( INVALID_HANDLE_VALUE )
+    , m_lNumRequests( 0 )
+    , m_lNumCacheHits( 0 )
+    , m_lNumCompiles( 0 )
+    , m_lNumDeduped( 0 )
+{
+    InitializeCriticalSection( &m_CriticalSection );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Destructor
+//--------------------------------------------------------------------------------------
+ShaderCompileServer::~ShaderCompileServer()
+{
+    Stop();
+
+    DeleteCriticalSection( &m_CriticalSection );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Starts the server
+//--------------------------------------------------------------------------------------
+HRESULT ShaderCompileServer::Start( const wchar_t* pwsPipeName, const wchar_t* pwsArchiveDir, PFN_COMPILE pfnCompile, void* pUserData )
+{
+    if (IsRunning())
+    {
+        return E_FAIL;
+    }
+
+    m_PipeName = pwsPipeName ? pwsPipeName : AMD_SHADER_COMPILE_SERVER_PIPE_NAME;
+    m_ArchiveDir = pwsArchiveDir ? pwsArchiveDir : L"";
+    m_pfnCompile = pfnCompile ? pfnCompile : D3DCompileCallback;
+    m_pUserData = pUserData;
+
+    if (!m_ArchiveDir.empty())
+    {
+        CreateDirectoryW( m_ArchiveDir.c_str(), NULL );
+    }
+
+    // Create the first instance here, so that failure (e.g. another server already owns
+    // the pipe name) is reported to the caller rather than lost on the listen thread
+    m_hFirstPipe = CreateNamedPipeW( m_PipeName.c_str(),
+        PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        PIPE_UNLIMITED_INSTANCES, kdwPipeBufferSize, kdwPipeBufferSize, 0, NULL );
+
+    if (m_hFirstPipe == INVALID_HANDLE_VALUE)
+    {
+        return HRESULT_FROM_WIN32( GetLastError() );
+    }
+
+    m_hStopEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+    m_hListenThread = CreateThread( NULL, 0, ListenThreadProc_, this, 0, NULL );
+
+    if (!m_hListenThread)
+    {
+        HRESULT hr = HRESULT_FROM_WIN32( GetLastError() );
+        CloseHandle( m_hFirstPipe );
+        m_hFirstPipe = INVALID_HANDLE_VALUE;
+        CloseHandle( m_hStopEvent );
+        m_hStopEvent = NULL;
+        return hr;
+    }
+
+    wchar_t wsMessage[MAX_PATH * 2];
+    swprintf_s( wsMessage, L"\n*** Shader Compile Server: listening on '%s' ***\n", m_PipeName.c_str() );
+    OutputDebugStringW( wsMessage );
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Stops the server, disconnecting all clients
+//--------------------------------------------------------------------------------------
+void ShaderCompileServer::Stop()
+{
+    if (!IsRunning())
+    {
+        return;
+    }
+
+    // Every blocking wait on the listen and client threads also waits on this event
+    SetEvent( m_hStopEvent );
+
+    WaitForSingleObject( m_hListenThread, INFINITE );
+    CloseHandle( m_hListenThread );
+    m_hListenThread = NULL;
+
+    EnterCriticalSection( &m_CriticalSection );
+    std::list<HANDLE> threads;
+    threads.swap( m_ClientThreads );
+    LeaveCriticalSection( &m_CriticalSection );
+
+    for (std::list<HANDLE>::iterator it = threads.begin(); it != threads.end(); it++)
+    {
+        WaitForSingleObject( *it, INFINITE );
+        CloseHandle( *it );
+    }
+
+    CloseHandle( m_hStopEvent );
+    m_hStopEvent = NULL;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Accepts connections, and hands each one to its own thread
+//--------------------------------------------------------------------------------------
+void ShaderCompileServer::ListenThreadProc()
+{
+    HANDLE hPipe = m_hFirstPipe;
+    m_hFirstPipe = INVALID_HANDLE_VALUE;
+
+    OVERLAPPED overlapped;
+    ZeroMemory( &overlapped, sizeof( overlapped ) );
+    overlapped.hEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+
+    for (;;)
+    {
+        if (hPipe == INVALID_HANDLE_VALUE)
+        {
+            hPipe = CreateNamedPipeW( m_PipeName.c_str(),
+                PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+                PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                PIPE_UNLIMITED_INSTANCES, kdwPipeBufferSize, kdwPipeBufferSize, 0, NULL );
+
+            if (hPipe == INVALID_HANDLE_VALUE)
+            {
+                OutputDebugStringW( L"\n*** Shader Compile Server: CreateNamedPipe failed, no longer accepting connections ***\n" );
+                break;
+            }
+        }
+
+        ResetEvent( overlapped.hEvent );
+        BOOL bConnected = ConnectNamedPipe( hPipe, &overlapped );
+        DWORD dwError = GetLastError();
+
+        if (!bConnected && (dwError == ERROR_IO_PENDING))
+        {
+            HANDLE handles[2] = { overlapped.hEvent, m_hStopEvent };
+            if (WaitForMultipleObjects( 2, handles, FALSE, INFINITE ) != WAIT_OBJECT_0)
+            {
+                DWORD dwUnused = 0;
+                CancelIo( hPipe );
+                GetOverlappedResult( hPipe, &overlapped, &dwUnused, TRUE );
+                CloseHandle( hPipe );
+                break;
+            }
+
+            DWORD dwUnused = 0;
+            bConnected = GetOverlappedResult( hPipe, &overlapped, &dwUnused, FALSE );
+        }
+        else if (!bConnected && (dwError == ERROR_PIPE_CONNECTED))
+        {
+            bConnected = TRUE;
+        }
+
+        if (!bConnected)
+        {
+            CloseHandle( hPipe );
+            hPipe = INVALID_HANDLE_VALUE;
+            continue;
+        }
+
+        ClientThreadArgs* pArgs = new ClientThreadArgs;
+        pArgs->m_pServer = this;
+        pArgs->m_hPipe = hPipe;
+        hPipe = INVALID_HANDLE_VALUE;
+
+        HANDLE hThread = CreateThread( NULL, 0, ClientThreadProc_, pArgs, 0, NULL );
+        if (!hThread)
+        {
+            CloseHandle( pArgs->m_hPipe );
+            delete pArgs;
+            continue;
+        }
+
+        EnterCriticalSection( &m_CriticalSection );
+
+        // Tidy up threads for clients that have already gone away
+        for (std::list<HANDLE>::iterator it = m_ClientThreads.begin(); it != m_ClientThreads.end();)
+        {
+            if (WaitForSingleObject( *it, 0 ) == WAIT_OBJECT_0)
+            {
+                CloseHandle( *it );
+                it = m_ClientThreads.erase( it );
+            }
+            else
+            {
+                it++;
+            }
+        }
+        m_ClientThreads.push_back( hThread );
+
+        LeaveCriticalSection( &m_CriticalSection );
+    }
+
+    CloseHandle( overlapped.hEvent );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Services requests from one client until it disconnects
+//--------------------------------------------------------------------------------------
+void ShaderCompileServer::ClientThreadProc( HANDLE hPipe )
+{
+    for (;;)
+    {
+        Request request;
+        Response response;
+
+        if (!TransferAll( hPipe, false, &request.m_Header, sizeof( request.m_Header ), m_hStopEvent ))
+        {
+            break;
+        }
+
+        const RequestHeader& header = request.m_Header;
+        if ((header.m_uMagic != REQUEST_MAGIC) || (header.m_uVersion != VERSION) ||
+            (header.m_uNumMacros > MAX_MACROS) || (header.m_uSourceLength > MAX_PAYLOAD))
+        {
+            // The stream can't be trusted after a malformed header, so drop the client
+            break;
+        }
+
+        request.m_Macros.resize( header.m_uNumMacros );
+        if (header.m_uNumMacros &&
+            !TransferAll( hPipe, false, &request.m_Macros[0], (DWORD)(header.m_uNumMacros * sizeof( Macro )), m_hStopEvent ))
+        {
+            break;
+        }
+
+        request.m_Source.resize( header.m_uSourceLength );
+        if (header.m_uSourceLength &&
+            !TransferAll( hPipe, false, &request.m_Source[0], header.m_uSourceLength, m_hStopEvent ))
+        {
+            break;
+        }
+
+        ProcessRequest( request, response );
+
+        ResponseHeader responseHeader;
+        responseHeader.m_uMagic = RESPONSE_MAGIC;
+        responseHeader.m_uStatus = (unsigned int)response.m_eStatus;
+        responseHeader.m_uBytecodeLength = (unsigned int)response.m_Bytecode.size();
+        responseHeader.m_uErrorLength = (unsigned int)response.m_Errors.size();
+
+        if (!TransferAll( hPipe, true, &responseHeader, sizeof( responseHeader ), m_hStopEvent ) ||
+            (responseHeader.m_uBytecodeLength &&
+             !TransferAll( hPipe, true, &response.m_Bytecode[0], responseHeader.m_uBytecodeLength, m_hStopEvent )) ||
+            (responseHeader.m_uErrorLength &&
+             !TransferAll( hPipe, true, &response.m_Errors[0], responseHeader.m_uErrorLength, m_hStopEvent )))
+        {
+            break;
+        }
+    }
+
+    DisconnectNamedPipe( hPipe );
+    CloseHandle( hPipe );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Handles a single request: memory cache, then in-flight compiles, then the archive, and
+// finally the compiler itself
+//--------------------------------------------------------------------------------------
+void ShaderCompileServer::ProcessRequest( const Request& i_Request, Response& o_Response )
+{
+    InterlockedIncrement( &m_lNumRequests );
+
+    o_Response.m_eStatus = STATUS_BAD_REQUEST;
+    o_Response.m_Bytecode.clear();
+    o_Response.m_Errors.clear();
+
+    if ((i_Request.m_Header.m_uNumMacros != i_Request.m_Macros.size()) ||
+        (i_Request.m_Header.m_uSourceLength != i_Request.m_Source.size()))
+    {
+        return;
+    }
+
+    const std::string key = CreateKey( i_Request );
+    InFlight* pInFlight = NULL;
+
+    EnterCriticalSection( &m_CriticalSection );
+
+    std::map<std::string, std::vector<BYTE> >::iterator cached = m_Cache.find( key );
+    if (cached != m_Cache.end())
+    {
+        o_Response.m_eStatus = STATUS_OK;
+        o_Response.m_Bytecode = cached->second;
+        LeaveCriticalSection( &m_CriticalSection );
+        InterlockedIncrement( &m_lNumCacheHits );
+        return;
+    }
+
+    std::map<std::string, InFlight*>::iterator inFlight = m_InFlight.find( key );
+    if (inFlight != m_InFlight.end())
+    {
+        // Someone else is already compiling this shader, so wait for their result
+        pInFlight = inFlight->second;
+        InterlockedIncrement( &pInFlight->m_lRefCount );
+        LeaveCriticalSection( &m_CriticalSection );
+
+        WaitForSingleObject( pInFlight->m_hDoneEvent, INFINITE );
+        o_Response = pInFlight->m_Response;
+        ReleaseInFlight( pInFlight );
+        InterlockedIncrement( &m_lNumDeduped );
+        return;
+    }
+
+    std::vector<BYTE> bytecode;
+    if (LoadFromArchive( key, bytecode ))
+    {
+        m_Cache[key] = bytecode;
+        o_Response.m_eStatus = STATUS_OK;
+        o_Response.m_Bytecode.swap( bytecode );
+        LeaveCriticalSection( &m_CriticalSection );
+        InterlockedIncrement( &m_lNumCacheHits );
+        return;
+    }
+
+    if (i_Request.m_Source.empty())
+    {
+        o_Response.m_eStatus = STATUS_NEED_SOURCE;
+        LeaveCriticalSection( &m_CriticalSection );
+        return;
+    }
+
+    pInFlight = new InFlight;
+    pInFlight->m_hDoneEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+    pInFlight->m_lRefCount = 1;
+    m_InFlight[key] = pInFlight;
+
+    LeaveCriticalSection( &m_CriticalSection );
+
+    // Compile outside the lock, so unrelated requests proceed in parallel
+    Response& response = pInFlight->m_Response;
+    HRESULT hr = m_pfnCompile( i_Request.m_Source.c_str(), i_Request.m_Source.size(), i_Request.m_Header,
+        i_Request.m_Macros.empty() ? NULL : &i_Request.m_Macros[0], response.m_Bytecode, response.m_Errors, m_pUserData );
+    response.m_eStatus = SUCCEEDED( hr ) ? STATUS_OK : STATUS_COMPILE_ERROR;
+    InterlockedIncrement( &m_lNumCompiles );
+
+    // Errors are not cached, so a retry (e.g. after an include on the server side changes) compiles again
+    EnterCriticalSection( &m_CriticalSection );
+    if (response.m_eStatus == STATUS_OK)
+    {
+        m_Cache[key] = response.m_Bytecode;
+    }
+    m_InFlight.erase( key );
+    LeaveCriticalSection( &m_CriticalSection );
+
+    if (response.m_eStatus == STATUS_OK)
+    {
+        SaveToArchive( key, response.m_Bytecode );
+    }
+
+    SetEvent( pInFlight->m_hDoneEvent );
+    o_Response = response;
+    ReleaseInFlight( pInFlight );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Creates the textual cache key for a request
+//--------------------------------------------------------------------------------------
+std::string ShaderCompileServer::CreateKey( const Request& i_Request )
+{
+    const RequestHeader& header = i_Request.m_Header;
+    char szBuffer[ENTRY_POINT_LENGTH + MACRO_NAME_LENGTH + 64];
+    std::string key;
+
+    for (unsigned int i = 0; i < HASH_LENGTH; i++)
+    {
+        sprintf_s( szBuffer, "%02x", header.m_SourceHash[i] );
+        key += szBuffer;
+    }
+
+    // Fields are copied so that an unterminated string in a bad request can't overrun
+    char szEntryPoint[ENTRY_POINT_LENGTH];
+    char szTarget[TARGET_LENGTH];
+    memcpy( szEntryPoint, header.m_szEntryPoint, ENTRY_POINT_LENGTH );
+    memcpy( szTarget, header.m_szTarget, TARGET_LENGTH );
+    szEntryPoint[ENTRY_POINT_LENGTH - 1] = '\0';
+    szTarget[TARGET_LENGTH - 1] = '\0';
+
+    sprintf_s( szBuffer, "|%s|%s|%08x|", szEntryPoint, szTarget, header.m_uCompileFlags );
+    key += szBuffer;
+
+    for (size_t i = 0; i < i_Request.m_Macros.size(); i++)
+    {
+        char szName[MACRO_NAME_LENGTH];
+        memcpy( szName, i_Request.m_Macros[i].m_szName, MACRO_NAME_LENGTH );
+        szName[MACRO_NAME_LENGTH - 1] = '\0';
+        sprintf_s( szBuffer, "%s=%d;", szName, i_Request.m_Macros[i].m_iValue );
+        key += szBuffer;
+    }
+
+    return key;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Loads bytecode from the archive. Each file stores the full key, so that a collision in
+// the filename hash can never return the wrong shader.
+//--------------------------------------------------------------------------------------
+bool ShaderCompileServer::LoadFromArchive( const std::string& i_Key, std::vector<BYTE>& o_Bytecode ) const
+{
+    if (m_ArchiveDir.empty())
+    {
+        return false;
+    }
+
+    wchar_t wsPath[MAX_PATH * 2];
+    swprintf_s( wsPath, L"%s\\%016llx.sco", m_ArchiveDir.c_str(), HashString( i_Key ) );
+
+    FILE* pFile = NULL;
+    _wfopen_s( &pFile, wsPath, L"rb" );
+    if (!pFile)
+    {
+        return false;
+    }
+
+    bool bResult = false;
+    unsigned int uMagic = 0;
+    unsigned int uKeyLength = 0;
+    unsigned int uBytecodeLength = 0;
+
+    if ((fread( &uMagic, sizeof( uMagic ), 1, pFile ) == 1) && (uMagic == kuArchiveMagic) &&
+        (fread( &uKeyLength, sizeof( uKeyLength ), 1, pFile ) == 1) && (uKeyLength == i_Key.size()))
+    {
+        std::string key( uKeyLength, '\0' );
+        if ((fread( &key[0], 1, uKeyLength, pFile ) == uKeyLength) && (key == i_Key) &&
+            (fread( &uBytecodeLength, sizeof( uBytecodeLength ), 1, pFile ) == 1) && (uBytecodeLength <= MAX_PAYLOAD))
+        {
+            o_Bytecode.resize( uBytecodeLength );
+            bResult = (uBytecodeLength == 0) || (fread( &o_Bytecode[0], 1, uBytecodeLength, pFile ) == uBytecodeLength);
+        }
+    }
+
+    fclose( pFile );
+    return bResult;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Writes bytecode to the archive (to a temporary file first, so readers never see a partial file)
+//--------------------------------------------------------------------------------------
+void ShaderCompileServer::SaveToArchive( const std::string& i_Key, const std::vector<BYTE>& i_Bytecode ) const
+{
+    if (m_ArchiveDir.empty())
+    {
+        return;
+    }
+
+    wchar_t wsPath[MAX_PATH * 2];
+    wchar_t wsTempPath[MAX_PATH * 2];
+    swprintf_s( wsPath, L"%s\\%016llx.sco", m_ArchiveDir.c_str(), HashString( i_Key ) );
+    swprintf_s( wsTempPath, L"%s.%u.tmp", wsPath, GetCurrentThreadId() );
+
+    FILE* pFile = NULL;
+    _wfopen_s( &pFile, wsTempPath, L"wb" );
+    if (!pFile)
+    {
+        return;
+    }
+
+    unsigned int uKeyLength = (unsigned int)i_Key.size();
+    unsigned int uBytecodeLength = (unsigned int)i_Bytecode.size();
+    bool bOK = (fwrite( &kuArchiveMagic, sizeof( kuArchiveMagic ), 1, pFile ) == 1) &&
+               (fwrite( &uKeyLength, sizeof( uKeyLength ), 1, pFile ) == 1) &&
+               (fwrite( i_Key.c_str(), 1, uKeyLength, pFile ) == uKeyLength) &&
+               (fwrite( &uBytecodeLength, sizeof( uBytecodeLength ), 1, pFile ) == 1) &&
+               ((uBytecodeLength == 0) || (fwrite( &i_Bytecode[0], 1, uBytecodeLength, pFile ) == uBytecodeLength));
+    fclose( pFile );
+
+    if (!bOK || !MoveFileExW( wsTempPath, wsPath, MOVEFILE_REPLACE_EXISTING ))
+    {
+        DeleteFileW( wsTempPath );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Drops a reference to an in-flight compile
+//--------------------------------------------------------------------------------------
+void ShaderCompileServer::ReleaseInFlight( InFlight* pInFlight )
+{
+    if (InterlockedDecrement( &pInFlight->m_lRefCount ) == 0)
+    {
+        CloseHandle( pInFlight->m_hDoneEvent );
+        delete pInFlight;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Default compile function
+//--------------------------------------------------------------------------------------
+HRESULT ShaderCompileServer::D3DCompileCallback( const char* pSource, size_t uSourceLength,
+                                                 const RequestHeader& i_Request, const Macro* pMacros,
+                                                 std::vector<BYTE>& o_Bytecode, std::string& o_Errors, void* /*pUserData*/ )
+{
+    std::vector<std::string> names( i_Request.m_uNumMacros );
+    std::vector<std::string> values( i_Request.m_uNumMacros );
+    std::vector<D3D_SHADER_MACRO> defines( i_Request.m_uNumMacros + 1 );
+
+    for (unsigned int i = 0; i < i_Request.m_uNumMacros; i++)
+    {
+        char szValue[16];
+        sprintf_s( szValue, "%d", pMacros[i].m_iValue );
+        names[i].assign( pMacros[i].m_szName, strnlen( pMacros[i].m_szName, MACRO_NAME_LENGTH ) );
+        values[i] = szValue;
+        defines[i].Name = names[i].c_str();
+        defines[i].Definition = values[i].c_str();
+    }
+    defines[i_Request.m_uNumMacros].Name = NULL;
+    defines[i_Request.m_uNumMacros].Definition = NULL;
+
+    char szEntryPoint[ENTRY_POINT_LENGTH];
+    char szTarget[TARGET_LENGTH];
+    CopyField( szEntryPoint, i_Request.m_szEntryPoint );
+    CopyField( szTarget, i_Request.m_szTarget );
+
+    ID3DBlob* pBlob = NULL;
+    ID3DBlob* pErrorBlob = NULL;
+    HRESULT hr = D3DCompile( pSource, uSourceLength, NULL, &defines[0], NULL, szEntryPoint, szTarget,
+        i_Request.m_uCompileFlags, 0, &pBlob, &pErrorBlob );
+
+    if (pErrorBlob)
+    {
+        o_Errors.assign( (const char*)pErrorBlob->GetBufferPointer(), pErrorBlob->GetBufferSize() );
+        pErrorBlob->Release();
+    }
+
+    if (pBlob)
+    {
+        const BYTE* pBytes = (const BYTE*)pBlob->GetBufferPointer();
+        o_Bytecode.assign( pBytes, pBytes + pBlob->GetBufferSize() );
+        pBlob->Release();
+    }
+
+    return hr;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Mock compile function, for exercising the server without d3dcompiler
+//--------------------------------------------------------------------------------------
+HRESULT ShaderCompileServer::MockCompile( const char* pSource, size_t uSourceLength,
+                                          const RequestHeader& /*i_Request*/, const Macro* /*pMacros*/,
+                                          std::vector<BYTE>& o_Bytecode, std::string& o_Errors, void* pUserData )
+{
+    if (pUserData)
+    {
+        Sleep( *(const DWORD*)pUserData );
+    }
+
+    const std::string source( pSource, uSourceLength );
+    if (source.find( "#error" ) != std::string::npos)
+    {
+        o_Errors = "mock(1): error: #error in source";
+        return E_FAIL;
+    }
+
+    o_Bytecode.assign( source.begin(), source.end() );
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Client constructor
+//--------------------------------------------------------------------------------------
+ShaderCompileClient::ShaderCompileClient()
+    : m_hPipe( INVALID_HANDLE_VALUE )
+{
+}
+
+
+//--------------------------------------------------------------------------------------
+// Client destructor
+//--------------------------------------------------------------------------------------
+ShaderCompileClient::~ShaderCompileClient()
+{
+    Disconnect();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Connects to a server
+//--------------------------------------------------------------------------------------
+bool ShaderCompileClient::Connect( const wchar_t* pwsPipeName, DWORD dwTimeoutMs )
+{
+    Disconnect();
+
+    const wchar_t* pwsName = pwsPipeName ? pwsPipeName : AMD_SHADER_COMPILE_SERVER_PIPE_NAME;
+    const DWORD dwStart = GetTickCount();
+
+    for (;;)
+    {
+        m_hPipe = CreateFileW( pwsName, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL );
+        if (m_hPipe != INVALID_HANDLE_VALUE)
+        {
+            return true;
+        }
+
+        // All instances busy: the server creates a new one as soon as it accepts a client
+        const DWORD dwElapsed = GetTickCount() - dwStart;
+        if ((GetLastError() != ERROR_PIPE_BUSY) || (dwElapsed >= dwTimeoutMs) ||
+            !WaitNamedPipeW( pwsName, dwTimeoutMs - dwElapsed ))
+        {
+            return false;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Disconnects from the server
+//--------------------------------------------------------------------------------------
+void ShaderCompileClient::Disconnect()
+{
+    if (m_hPipe != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle( m_hPipe );
+        m_hPipe = INVALID_HANDLE_VALUE;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Asks the server for a shader, sending the source only if the server needs it
+//--------------------------------------------------------------------------------------
+HRESULT ShaderCompileClient::Compile( const unsigned char (&i_SourceHash)[HASH_LENGTH],
+                                      const char* pszEntryPoint, const char* pszTarget, unsigned int uCompileFlags,
+                                      const Macro* pMacros, unsigned int uNumMacros,
+                                      const char* pSource, size_t uSourceLength,
+                                      std::vector<BYTE>& o_Bytecode, std::string& o_Errors )
+{
+    if (!IsConnected() || (uNumMacros > MAX_MACROS) || (uSourceLength > MAX_PAYLOAD))
+    {
+        return E_INVALIDARG;
+    }
+
+    RequestHeader header;
+    ZeroMemory( &header, sizeof( header ) );
+    header.m_uMagic = REQUEST_MAGIC;
+    header.m_uVersion = VERSION;
+    memcpy( header.m_SourceHash, i_SourceHash, HASH_LENGTH );
+    header.m_uCompileFlags = uCompileFlags;
+    CopyField( header.m_szEntryPoint, pszEntryPoint );
+    CopyField( header.m_szTarget, pszTarget );
+    header.m_uNumMacros = uNumMacros;
+    header.m_uSourceLength = 0;
+
+    ResponseHeader response;
+    HRESULT hr = SendRequest( header, pMacros, NULL, response, o_Bytecode, o_Errors );
+
+    if (SUCCEEDED( hr ) && (response.m_uStatus == STATUS_NEED_SOURCE) && pSource && uSourceLength)
+    {
+        header.m_uSourceLength = (unsigned int)uSourceLength;
+        hr = SendRequest( header, pMacros, pSource, response, o_Bytecode, o_Errors );
+    }
+
+    if (FAILED( hr ))
+    {
+        return hr;
+    }
+
+    switch (response.m_uStatus)
+    {
+    case STATUS_OK:             return S_OK;
+    case STATUS_NEED_SOURCE:    return HRESULT_FROM_WIN32( ERROR_NOT_FOUND );
+    case STATUS_COMPILE_ERROR:  return E_FAIL;
+    default:                    return E_INVALIDARG;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Sends one request, and reads the response
+//--------------------------------------------------------------------------------------
+HRESULT ShaderCompileClient::SendRequest( const RequestHeader& i_Header, const Macro* pMacros, const char* pSource,
+                                          ResponseHeader& o_Header, std::vector<BYTE>& o_Bytecode, std::string& o_Errors )
+{
+    o_Bytecode.clear();
+    o_Errors.clear();
+
+    bool bOK = TransferAll( m_hPipe, true, (void*)&i_Header, sizeof( i_Header ), NULL ) &&
+               ((i_Header.m_uNumMacros == 0) ||
+                TransferAll( m_hPipe, true, (void*)pMacros, (DWORD)(i_Header.m_uNumMacros * sizeof( Macro )), NULL )) &&
+               ((i_Header.m_uSourceLength == 0) ||
+                TransferAll( m_hPipe, true, (void*)pSource, i_Header.m_uSourceLength, NULL )) &&
+               TransferAll( m_hPipe, false, &o_Header, sizeof( o_Header ), NULL ) &&
+               (o_Header.m_uMagic == RESPONSE_MAGIC) &&
+               (o_Header.m_uBytecodeLength <= MAX_PAYLOAD) && (o_Header.m_uErrorLength <= MAX_PAYLOAD);
+
+    if (bOK)
+    {
+        o_Bytecode.resize( o_Header.m_uBytecodeLength );
+        o_Errors.resize( o_Header.m_uErrorLength );
+        bOK = ((o_Header.m_uBytecodeLength == 0) || TransferAll( m_hPipe, false, &o_Bytecode[0], o_Header.m_uBytecodeLength, NULL )) &&
+              ((o_Header.m_uErrorLength == 0) || TransferAll( m_hPipe, false, &o_Errors[0], o_Header.m_uErrorLength, NULL ));
+    }
+
+    if (!bOK)
+    {
+        // The stream is out of step after any failure, so the connection is no longer usable
+        HRESULT hr = HRESULT_FROM_WIN32( GetLastError() );
+        Disconnect();
+        return FAILED( hr ) ? hr : E_FAIL;
+    }
+
+    return S_OK;
+}
@@ -0,0 +1,242 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: ShaderCompileServer.h
+//
+// A long-lived shader compile server, and the matching client. The server listens on a
+// local named pipe and owns an on-disk archive of compiled bytecode, so that every sample
+// running on a workstation can share one warm compiler and one cache, rather than each
+// paying the fxc process startup cost.
+//
+// Requests are keyed on (source hash, entry point, target, flags, macros). The client
+// first sends the key alone; the source is only sent if the server asks for it. Identical
+// requests that arrive while a compile is in flight wait for that compile, rather than
+// compiling again.
+//
+// The compile step is a callback, so the server can be driven with MockCompile (or any
+// other function) to exercise the protocol, dedupe and archive without d3dcompiler, as
+// CompileServerTest (ssaa11/tools) does. ProcessRequest can also be called directly,
+// bypassing the pipe entirely.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_SHADER_COMPILE_SERVER_H
+#define AMD_SDK_SHADER_COMPILE_SERVER_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace AMD
+{
+    // Default pipe name used by the ShaderCache
+    #define AMD_SHADER_COMPILE_SERVER_PIPE_NAME L"\\\\.\\pipe\\AMD_SDK_ShaderCompileServer"
+
+    //--------------------------------------------------------------------------------------
+    // Wire protocol
+    //--------------------------------------------------------------------------------------
+    namespace ShaderCompileProtocol
+    {
+        static const unsigned int   REQUEST_MAGIC       = 0x52435341; // 'ASCR'
+        static const unsigned int   RESPONSE_MAGIC      = 0x50435341; // 'ASCP'
+        static const unsigned int   VERSION             = 1;
+        static const unsigned int   HASH_LENGTH         = 16;
+        static const unsigned int   ENTRY_POINT_LENGTH  = 128;
+        static const unsigned int   TARGET_LENGTH       = 16;
+        static const unsigned int   MACRO_NAME_LENGTH   = 64;
+        static const unsigned int   MAX_MACROS          = 64;
+        static const unsigned int   MAX_PAYLOAD         = 64 * 1024 * 1024;
+
+        typedef enum STATUS_t
+        {
+            STATUS_OK,              // Bytecode follows
+            STATUS_NEED_SOURCE,     // Server doesn't have this shader; resend with source
+            STATUS_COMPILE_ERROR,   // Error text follows
+            STATUS_BAD_REQUEST
+        } STATUS;
+
+        struct Macro
+        {
+            char            m_szName[MACRO_NAME_LENGTH];
+            int             m_iValue;
+        };
+
+        // Followed by m_uNumMacros Macro structures, then m_uSourceLength bytes of source
+        struct RequestHeader
+        {
+            unsigned int    m_uMagic;
+            unsigned int    m_uVersion;
+            unsigned char   m_SourceHash[HASH_LENGTH];
+            unsigned int    m_uCompileFlags;
+            char            m_szEntryPoint[ENTRY_POINT_LENGTH];
+            char            m_szTarget[TARGET_LENGTH];
+            unsigned int    m_uNumMacros;
+            unsigned int    m_uSourceLength;
+        };
+
+        // Followed by m_uBytecodeLength bytes of bytecode, then m_uErrorLength bytes of error text
+        struct ResponseHeader
+        {
+            unsigned int    m_uMagic;
+            unsigned int    m_uStatus;
+            unsigned int    m_uBytecodeLength;
+            unsigned int    m_uErrorLength;
+        };
+    }
+
+    //--------------------------------------------------------------------------------------
+    // The server
+    //--------------------------------------------------------------------------------------
+    class ShaderCompileServer
+    {
+    public:
+
+        // Compile callback: returns S_OK and fills o_Bytecode on success, or fails and fills o_Errors
+        typedef HRESULT (*PFN_COMPILE)( const char* pSource, size_t uSourceLength,
+                                        const ShaderCompileProtocol::RequestHeader& i_Request,
+                                        const ShaderCompileProtocol::Macro* pMacros,
+                                        std::vector<BYTE>& o_Bytecode, std::string& o_Errors, void* pUserData );
+
+        // A decoded request
+        struct Request
+        {
+            ShaderCompileProtocol::RequestHeader        m_Header;
+            std::vector<ShaderCompileProtocol::Macro>   m_Macros;
+            std::string                                 m_Source;
+        };
+
+        // A response, before it is encoded
+        struct Response
+        {
+            ShaderCompileProtocol::STATUS               m_eStatus;
+            std::vector<BYTE>                           m_Bytecode;
+            std::string                                 m_Errors;
+        };
+
+        ShaderCompileServer();
+        ~ShaderCompileServer();
+
+        // Starts listening on the given pipe. pwsArchiveDir may be NULL for a memory-only cache.
+        // With pfnCompile == NULL, shaders are compiled with D3DCompile.
+        HRESULT Start( const wchar_t* pwsPipeName, const wchar_t* pwsArchiveDir, PFN_COMPILE pfnCompile = NULL, void* pUserData = NULL );
+
+        // Stops listening, and disconnects all clients
+        void Stop();
+
+        bool IsRunning() const { return (m_hListenThread != NULL); }
+
+        // Handles a single request; this is what each pipe connection calls, and can be called
+        // directly to exercise the server without a pipe
+        void ProcessRequest( const Request& i_Request, Response& o_Response );
+
+        // Stats
+        unsigned int GetNumRequests() const { return (unsigned int)m_lNumRequests; }
+        unsigned int GetNumCacheHits() const { return (unsigned int)m_lNumCacheHits; }
+        unsigned int GetNumCompiles() const { return (unsigned int)m_lNumCompiles; }
+        unsigned int GetNumDeduped() const { return (unsigned int)m_lNumDeduped; }
+
+        // Default compile function, using D3DCompile
+        static HRESULT D3DCompileCallback( const char* pSource, size_t uSourceLength,
+                                           const ShaderCompileProtocol::RequestHeader& i_Request,
+                                           const ShaderCompileProtocol::Macro* pMacros,
+                                           std::vector<BYTE>& o_Bytecode, std::string& o_Errors, void* pUserData );
+
+        // Mock compile function for testing: copies the source into the bytecode after an
+        // optional delay (pUserData points to a DWORD in milliseconds, or is NULL). A source
+        // containing "#error" produces a compile error.
+        static HRESULT MockCompile( const char* pSource, size_t uSourceLength,
+                                    const ShaderCompileProtocol::RequestHeader& i_Request,
+                                    const ShaderCompileProtocol::Macro* pMacros,
+                                    std::vector<BYTE>& o_Bytecode, std::string& o_Errors, void* pUserData );
+
+        // Do not call these functions
+        void ListenThreadProc();
+        void ClientThreadProc( HANDLE hPipe );
+
+    private:
+
+        // A compile that is currently in progress, which identical requests wait on
+        struct InFlight
+        {
+            HANDLE      m_hDoneEvent;
+            LONG        m_lRefCount;
+            Response    m_Response;
+        };
+
+        static std::string CreateKey( const Request& i_Request );
+        bool LoadFromArchive( const std::string& i_Key, std::vector<BYTE>& o_Bytecode ) const;
+        void SaveToArchive( const std::string& i_Key, const std::vector<BYTE>& i_Bytecode ) const;
+        void ReleaseInFlight( InFlight* pInFlight );
+
+        std::map<std::string, std::vector<BYTE> >   m_Cache;
+        std::map<std::string, InFlight*>            m_InFlight;
+        std::list<HANDLE>                           m_ClientThreads;
+        CRITICAL_SECTION                            m_CriticalSection;
+        std::wstring                                m_PipeName;
+        std::wstring                                m_ArchiveDir;
+        PFN_COMPILE                                 m_pfnCompile;
+        void*                                       m_pUserData;
+        HANDLE                                      m_hListenThread;
+        HANDLE                                      m_hStopEvent;
+        HANDLE                                      m_hFirstPipe;
+        volatile LONG                               m_lNumRequests;
+        volatile LONG                               m_lNumCacheHits;
+        volatile LONG                               m_lNumCompiles;
+        volatile LONG                               m_lNumDeduped;
+    };
+
+    //--------------------------------------------------------------------------------------
+    // The client
+    //--------------------------------------------------------------------------------------
+    class ShaderCompileClient
+    {
+    public:
+
+        ShaderCompileClient();
+        ~ShaderCompileClient();
+
+        // Connects to a server, waiting up to dwTimeoutMs for a free pipe instance
+        bool Connect( const wchar_t* pwsPipeName, DWORD dwTimeoutMs = 1000 );
+        void Disconnect();
+        bool IsConnected() const { return (m_hPipe != INVALID_HANDLE_VALUE); }
+
+        // Asks the server for the bytecode for this shader. The source is only sent if the
+        // server doesn't already have the shader, so pSource may be NULL for a lookup only.
+        HRESULT Compile( const unsigned char (&i_SourceHash)[ShaderCompileProtocol::HASH_LENGTH],
+                         const char* pszEntryPoint, const char* pszTarget, unsigned int uCompileFlags,
+                         const ShaderCompileProtocol::Macro* pMacros, unsigned int uNumMacros,
+                         const char* pSource, size_t uSourceLength,
+                         std::vector<BYTE>& o_Bytecode, std::string& o_Errors );
+
+    private:
+
+        HRESULT SendRequest( const ShaderCompileProtocol::RequestHeader& i_Header,
+                             const ShaderCompileProtocol::Macro* pMacros, const char* pSource,
+                             ShaderCompileProtocol::ResponseHeader& o_Header,
+                             std::vector<BYTE>& o_Bytecode, std::string& o_Errors );
+
+        HANDLE m_hPipe;
+    };
+
+} // namespace AMD
+
+#endif
@@ -0,0 +1,369 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: ShaderPermutations.cpp
+//
+// Implementation of the declarative shader permutation table.
+//--------------------------------------------------------------------------------------
+#include "..\\..\\DXUT\\Core\\DXUT.h"
+#include "ShaderPermutations.h"
+
+#include <map>
+
+using namespace AMD;
+
+namespace
+{
+    DWORD WINAPI ShaderPermutations_ThreadProc_( void* pParameter )
+    {
+        ((ShaderPermutations*)pParameter)->CompileThreadProc();
+        return 0;
+    }
+
+    // 64-bit FNV-1a, used to find permutations with identical bytecode
+    unsigned long long HashBytecode( ID3DBlob* pBlob )
+    {
+        const unsigned char* pData = (const unsigned char*)pBlob->GetBufferPointer();
+        const size_t kuSize = pBlob->GetBufferSize();
+
+        unsigned long long uHash = 14695981039346656037ULL;
+        for (size_t i = 0; i < kuSize; i++)
+        {
+            uHash ^= pData[i];
+            uHash *= 1099511628211ULL;
+        }
+        return uHash;
+    }
+
+    bool IsSameBytecode( ID3DBlob* pA, ID3DBlob* pB )
+    {
+        return (pA->GetBufferSize() == pB->GetBufferSize()) &&
+               (memcmp( pA->GetBufferPointer(), pB->GetBufferPointer(), pA->GetBufferSize() ) == 0);
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Constructor
+//--------------------------------------------------------------------------------------
+ShaderPermutations::ShaderPermutations()
+    : m_uCompileFlags( 0 )
+    , m_lNextPermutation( 0 )
+{
+}
+
+
+//--------------------------------------------------------------------------------------
+// Destructor
+//--------------------------------------------------------------------------------------
+ShaderPermutations::~ShaderPermutations()
+{
+    Release();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Sets the shader to compile
+//--------------------------------------------------------------------------------------
+void ShaderPermutations::SetShader( const wchar_t* pwsFileName, const char* pszEntryPoint, const char* pszTarget, unsigned int uCompileFlags )
+{
+    m_FileName = pwsFileName;
+    m_EntryPoint = pszEntryPoint;
+    m_Target = pszTarget;
+    m_uCompileFlags = uCompileFlags;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Adds a bool axis
+//--------------------------------------------------------------------------------------
+unsigned int ShaderPermutations::AddBoolAxis( const char* pszMacro )
+{
+    Axis axis;
+    axis.m_Macro = pszMacro;
+    axis.m_Values.push_back( "" );
+    axis.m_Values.push_back( "1" );
+    axis.m_bBool = true;
+    m_Axes.push_back( axis );
+
+    return (unsigned int)m_Axes.size() - 1;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Adds an enum axis
+//--------------------------------------------------------------------------------------
+unsigned int ShaderPermutations::AddEnumAxis( const char* pszMacro, const char* const* ppszValues, unsigned int uNumValues )
+{
+    assert( uNumValues > 0 );
+
+    Axis axis;
+    axis.m_Macro = pszMacro;
+    for (unsigned int i = 0; i < uNumValues; i++)
+    {
+        axis.m_Values.push_back( ppszValues[i] );
+    }
+    axis.m_bBool = false;
+    m_Axes.push_back( axis );
+
+    return (unsigned int)m_Axes.size() - 1;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Size of the cartesian product of the axes
+//--------------------------------------------------------------------------------------
+unsigned int ShaderPermutations::GetNumPermutations() const
+{
+    unsigned int uCount = 1;
+    for (size_t i = 0; i < m_Axes.size(); i++)
+    {
+        uCount *= (unsigned int)m_Axes[i].m_Values.size();
+    }
+    return uCount;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Mixed radix index of a permutation; the first axis varies fastest
+//--------------------------------------------------------------------------------------
+unsigned int ShaderPermutations::GetIndex( const unsigned int* pAxisValues ) const
+{
+    unsigned int uIndex = 0;
+    unsigned int uStride = 1;
+    for (size_t i = 0; i < m_Axes.size(); i++)
+    {
+        assert( pAxisValues[i] < m_Axes[i].m_Values.size() );
+        uIndex += pAxisValues[i] * uStride;
+        uStride *= (unsigned int)m_Axes[i].m_Values.size();
+    }
+    return uIndex;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Compiles all permutations, dedupes the bytecode, and creates the shaders
+//--------------------------------------------------------------------------------------
+HRESULT ShaderPermutations::Compile( ID3D11Device* pDevice, unsigned int uNumThreads )
+{
+    Release();
+
+    const unsigned int kuNumPermutations = GetNumPermutations();
+    m_CompiledBytecode.assign( kuNumPermutations, (ID3DBlob*)NULL );
+    m_CompileResults.assign( kuNumPermutations, E_FAIL );
+    m_lNextPermutation = 0;
+
+    if (uNumThreads == 0)
+    {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo( &systemInfo );
+        uNumThreads = systemInfo.dwNumberOfProcessors;
+    }
+    uNumThreads = std::min( std::min( uNumThreads, kuNumPermutations ), (unsigned int)MAXIMUM_WAIT_OBJECTS );
+
+    // The calling thread does its share of the work too
+    std::vector<HANDLE> threads;
+    for (unsigned int i = 1; i < uNumThreads; i++)
+    {
+        HANDLE hThread = CreateThread( NULL, 0, ShaderPermutations_ThreadProc_, this, 0, NULL );
+        if (hThread)
+        {
+            threads.push_back( hThread );
+        }
+    }
+
+    CompileThreadProc();
+
+    if (!threads.empty())
+    {
+        WaitForMultipleObjects( (DWORD)threads.size(), &threads[0], TRUE, INFINITE );
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            CloseHandle( threads[i] );
+        }
+    }
+
+    // Dedupe identical bytecode, and build the table
+    HRESULT hr = S_OK;
+    std::multimap<unsigned long long, unsigned int> uniqueShaders;
+    m_Table.resize( kuNumPermutations );
+
+    for (unsigned int uPermutation = 0; uPermutation < kuNumPermutations; uPermutation++)
+    {
+        ID3DBlob* pBlob = m_CompiledBytecode[uPermutation];
+        m_CompiledBytecode[uPermutation] = NULL;
+
+        if (FAILED( m_CompileResults[uPermutation] ) || (NULL == pBlob))
+        {
+            SAFE_RELEASE( pBlob );
+            hr = FAILED( m_CompileResults[uPermutation] ) ? m_CompileResults[uPermutation] : E_FAIL;
+            m_Table[uPermutation] = (unsigned int)m_Shaders.size();
+            m_Shaders.push_back( NULL );
+            m_Bytecode.push_back( NULL );
+            continue;
+        }
+
+        const unsigned long long kuHash = HashBytecode( pBlob );
+        bool bFound = false;
+
+        typedef std::multimap<unsigned long long, unsigned int>::const_iterator Iterator;
+        std::pair<Iterator, Iterator> range = uniqueShaders.equal_range( kuHash );
+        for (Iterator it = range.first; it != range.second; it++)
+        {
+            if (IsSameBytecode( pBlob, m_Bytecode[it->second] ))
+            {
+                m_Table[uPermutation] = it->second;
+                bFound = true;
+                break;
+            }
+        }
+
+        if (bFound)
+        {
+            SAFE_RELEASE( pBlob );
+            continue;
+        }
+
+        ID3D11DeviceChild* pShader = NULL;
+        HRESULT hrCreate = CreateShader( pDevice, pBlob, &pShader );
+        if (FAILED( hrCreate ))
+        {
+            hr = hrCreate;
+        }
+
+        m_Table[uPermutation] = (unsigned int)m_Shaders.size();
+        uniqueShaders.insert( std::make_pair( kuHash, (unsigned int)m_Shaders.size() ) );
+        m_Shaders.push_back( pShader );
+        m_Bytecode.push_back( pBlob );
+    }
+
+    m_CompiledBytecode.clear();
+    m_CompileResults.clear();
+
+    return hr;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Releases the shaders and bytecode
+//--------------------------------------------------------------------------------------
+void ShaderPermutations::Release()
+{
+    for (size_t i = 0; i < m_Shaders.size(); i++)
+    {
+        SAFE_RELEASE( m_Shaders[i] );
+        SAFE_RELEASE( m_Bytecode[i] );
+    }
+
+    m_Shaders.clear();
+    m_Bytecode.clear();
+    m_Table.clear();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Each compile thread takes the next permutation until there are none left
+//--------------------------------------------------------------------------------------
+void ShaderPermutations::CompileThreadProc()
+{
+    const LONG klNumPermutations = (LONG)m_CompiledBytecode.size();
+
+    for (;;)
+    {
+        const LONG klPermutation = InterlockedIncrement( &m_lNextPermutation ) - 1;
+        if (klPermutation >= klNumPermutations)
+        {
+            break;
+        }
+
+        m_CompileResults[klPermutation] = CompilePermutation( (unsigned int)klPermutation, &m_CompiledBytecode[klPermutation] );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Compiles a single permutation
+//--------------------------------------------------------------------------------------
+HRESULT ShaderPermutations::CompilePermutation( unsigned int uIndex, ID3DBlob** ppBytecode ) const
+{
+    // Decode the index back into one value per axis, and define the macros to match
+    std::vector<D3D_SHADER_MACRO> macros;
+    for (size_t i = 0; i < m_Axes.size(); i++)
+    {
+        const Axis& axis = m_Axes[i];
+        const unsigned int kuValue = uIndex % (unsigned int)axis.m_Values.size();
+        uIndex /= (unsigned int)axis.m_Values.size();
+
+        if (axis.m_bBool && (kuValue == 0))
+        {
+            continue;
+        }
+
+        D3D_SHADER_MACRO macro = { axis.m_Macro.c_str(), axis.m_Values[kuValue].c_str() };
+        macros.push_back( macro );
+    }
+
+    D3D_SHADER_MACRO terminator = { NULL, NULL };
+    macros.push_back( terminator );
+
+    ID3DBlob* pErrors = NULL;
+    HRESULT hr = D3DCompileFromFile( m_FileName.c_str(), &macros[0], D3D_COMPILE_STANDARD_FILE_INCLUDE, m_EntryPoint.c_str(),
+                                     m_Target.c_str(), m_uCompileFlags, 0, ppBytecode, &pErrors );
+    if (FAILED( hr ) || (NULL == *ppBytecode))
+    {
+        if (NULL != pErrors)
+        {
+            OutputDebugStringA( (const char *)pErrors->GetBufferPointer() );
+        }
+        else
+        {
+            char errorString[256];
+            sprintf_s( errorString, "Unknown error compiling shader permutation: (%s, %s, %u)\n", m_EntryPoint.c_str(), m_Target.c_str(), uIndex );
+            OutputDebugStringA( errorString );
+        }
+    }
+    SAFE_RELEASE( pErrors );
+
+    return hr;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Creates the shader object, of the type given by the target
+//--------------------------------------------------------------------------------------
+HRESULT ShaderPermutations::CreateShader( ID3D11Device* pDevice, ID3DBlob* pBytecode, ID3D11DeviceChild** ppShader ) const
+{
+    const void* pData = pBytecode->GetBufferPointer();
+    const SIZE_T kSize = pBytecode->GetBufferSize();
+
+    switch (m_Target.empty() ? '\0' : m_Target[0])
+    {
+    case 'v': return pDevice->CreateVertexShader( pData, kSize, NULL, (ID3D11VertexShader**)ppShader );
+    case 'h': return pDevice->CreateHullShader( pData, kSize, NULL, (ID3D11HullShader**)ppShader );
+    case 'd': return pDevice->CreateDomainShader( pData, kSize, NULL, (ID3D11DomainShader**)ppShader );
+    case 'g': return pDevice->CreateGeometryShader( pData, kSize, NULL, (ID3D11GeometryShader**)ppShader );
+    case 'p': return pDevice->CreatePixelShader( pData, kSize, NULL, (ID3D11PixelShader**)ppShader );
+    case 'c': return pDevice->CreateComputeShader( pData, kSize, NULL, (ID3D11ComputeShader**)ppShader );
+    default:  return E_INVALIDARG;
+    }
+}
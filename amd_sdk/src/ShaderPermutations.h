@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: ShaderPermutations.h
+//
+// Describes a shader's permutations declaratively, as an entry point and target plus a
+// set of macro axes, rather than compiling each variant by hand. Each axis is either a
+// bool (macro undefined, or defined) or an enum (macro defined to one of a list of values).
+//
+// Compile expands the cartesian product of the axes and compiles every permutation in
+// parallel. Permutations that produce identical bytecode share one shader object. The
+// result is a flat table, indexed by the axis values in mixed radix (the first axis varies
+// fastest), so selecting a shader at draw time is a single array lookup.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_SHADER_PERMUTATIONS_H
+#define AMD_SDK_SHADER_PERMUTATIONS_H
+
+#include <string>
+#include <vector>
+
+namespace AMD
+{
+    class ShaderPermutations
+    {
+    public:
+
+        ShaderPermutations();
+        ~ShaderPermutations();
+
+        // The shader to compile. The shader type is taken from the target (vs_, ps_, cs_, ...)
+        void SetShader( const wchar_t* pwsFileName, const char* pszEntryPoint, const char* pszTarget, unsigned int uCompileFlags = 0 );
+
+        // Adds an axis, and returns its index. A bool axis has the values 0 (undefined) and 1
+        // (defined); an enum axis has one value per entry in ppszValues.
+        unsigned int AddBoolAxis( const char* pszMacro );
+        unsigned int AddEnumAxis( const char* pszMacro, const char* const* ppszValues, unsigned int uNumValues );
+
+        unsigned int GetNumAxes() const { return (unsigned int)m_Axes.size(); }
+        unsigned int GetNumPermutations() const;
+
+        // Table index of a permutation, from one value per axis
+        unsigned int GetIndex( const unsigned int* pAxisValues ) const;
+
+        // Compiles every permutation, on up to uNumThreads threads (0 uses one per core), and
+        // creates one shader object per unique bytecode
+        HRESULT Compile( ID3D11Device* pDevice, unsigned int uNumThreads = 0 );
+
+        // Releases the shaders and bytecode, but keeps the description
+        void Release();
+
+        // Lookups; NULL if the permutation failed to compile
+        ID3D11DeviceChild* GetShader( unsigned int uIndex ) const { return m_Shaders[m_Table[uIndex]]; }
+        ID3D11VertexShader* GetVertexShader( unsigned int uIndex ) const { return (ID3D11VertexShader*)GetShader( uIndex ); }
+        ID3D11HullShader* GetHullShader( unsigned int uIndex ) const { return (ID3D11HullShader*)GetShader( uIndex ); }
+        ID3D11DomainShader* GetDomainShader( unsigned int uIndex ) const { return (ID3D11DomainShader*)GetShader( uIndex ); }
+        ID3D11GeometryShader* GetGeometryShader( unsigned int uIndex ) const { return (ID3D11GeometryShader*)GetShader( uIndex ); }
+        ID3D11PixelShader* GetPixelShader( unsigned int uIndex ) const { return (ID3D11PixelShader*)GetShader( uIndex ); }
+        ID3D11ComputeShader* GetComputeShader( unsigned int uIndex ) const { return (ID3D11ComputeShader*)GetShader( uIndex ); }
+        ID3DBlob* GetBytecode( unsigned int uIndex ) const { return m_Bytecode[m_Table[uIndex]]; }
+
+        // Number of distinct shaders after deduplication
+        unsigned int GetNumUniqueShaders() const { return (unsigned int)m_Shaders.size(); }
+
+        // Do not call this function
+        void CompileThreadProc();
+
+    private:
+
+        struct Axis
+        {
+            std::string                 m_Macro;
+            std::vector<std::string>    m_Values;
+            bool                        m_bBool;
+        };
+
+        HRESULT CompilePermutation( unsigned int uIndex, ID3DBlob** ppBytecode ) const;
+        HRESULT CreateShader( ID3D11Device* pDevice, ID3DBlob* pBytecode, ID3D11DeviceChild** ppShader ) const;
+
+        std::wstring                        m_FileName;
+        std::string                         m_EntryPoint;
+        std::string                         m_Target;
+        unsigned int                        m_uCompileFlags;
+        std::vector<Axis>                   m_Axes;
+
+        // Permutation index -> unique shader index
+        std::vector<unsigned int>           m_Table;
+        std::vector<ID3D11DeviceChild*>     m_Shaders;
+        std::vector<ID3DBlob*>              m_Bytecode;
+
+        // Used while compiling
+        std::vector<ID3DBlob*>              m_CompiledBytecode;
+        std::vector<HRESULT>                m_CompileResults;
+        volatile LONG                       m_lNextPermutation;
+    };
+
+} // namespace AMD
+
+#endif
@@ -0,0 +1,1793 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: ShaderPreprocessor.cpp
+//
+// Implementation of the portable HLSL preprocessor used by the ShaderCache.
+//--------------------------------------------------------------------------------------
+#include "ShaderPreprocessor.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <iterator>
+
+using namespace AMD;
+
+namespace
+{
+    // Maximum #include nesting, to catch recursive includes without #pragma once
+    const int kiMaxIncludeDepth = 64;
+
+    // Multi-character punctuators, longest first so that greedy matching works
+    const char* const kMultiCharPunctuators[] =
+    {
+        "<<=", ">>=", "...",
+        "##", "->", "++", "--", "<<", ">>", "<=", ">=", "==", "!=", "&&", "||",
+        "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "::"
+    };
+
+    bool IsIdentStart( char c )
+    {
+        return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || (c == '_');
+    }
+
+    bool IsDigit( char c )
+    {
+        return (c >= '0') && (c <= '9');
+    }
+
+    bool IsIdentChar( char c )
+    {
+        return IsIdentStart( c ) || IsDigit( c );
+    }
+
+    std::string IntToString( long long iValue )
+    {
+        char szBuf[32];
+        char* p = szBuf + sizeof( szBuf );
+        *--p = '\0';
+        bool bNegative = (iValue < 0);
+        unsigned long long uValue = bNegative ? (0ULL - (unsigned long long)iValue) : (unsigned long long)iValue;
+        do
+        {
+            *--p = (char)('0' + (uValue % 10));
+            uValue /= 10;
+        } while (uValue);
+        if (bNegative)
+        {
+            *--p = '-';
+        }
+        return std::string( p );
+    }
+
+    //--------------------------------------------------------------------------------------
+    // A value in an #if expression. As in C, every signed type is intmax_t there and every
+    // unsigned type uintmax_t, so a value is 64 bits and a signedness. The bits are held
+    // unsigned so that wrapping unsigned arithmetic is well defined
+    //--------------------------------------------------------------------------------------
+    struct Value
+    {
+        unsigned long long  m_uBits;
+        bool                m_bUnsigned;
+    };
+
+    Value MakeValue( unsigned long long uBits, bool bUnsigned )
+    {
+        Value value = { uBits, bUnsigned };
+        return value;
+    }
+
+    Value MakeBool( bool bValue )
+    {
+        return MakeValue( bValue ? 1 : 0, false );
+    }
+
+    long long AsSigned( const Value& i_Value )
+    {
+        return (long long)i_Value.m_uBits;
+    }
+
+    // The usual arithmetic conversions: if either operand is unsigned, both are
+    bool IsUnsigned( const Value& i_Left, const Value& i_Right )
+    {
+        return i_Left.m_bUnsigned || i_Right.m_bUnsigned;
+    }
+
+    bool IsLess( const Value& i_Left, const Value& i_Right )
+    {
+        return IsUnsigned( i_Left, i_Right ) ? (i_Left.m_uBits < i_Right.m_uBits) : (AsSigned( i_Left ) < AsSigned( i_Right ));
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Recursive descent evaluator for #if expressions, operating on fully expanded tokens.
+    // Operands that aren't evaluated, like the right of 0 && x, are still parsed, but
+    // division by zero and signed overflow in them aren't errors
+    //--------------------------------------------------------------------------------------
+    class ExpressionEvaluator
+    {
+    public:
+
+        ExpressionEvaluator( const std::vector<std::string>& i_Tokens )
+            : m_Tokens( i_Tokens )
+            , m_uPos( 0 )
+            , m_iUnevaluated( 0 )
+            , m_bError( false )
+        {}
+
+        bool Evaluate( long long& o_iValue, std::string& o_Error )
+        {
+            o_iValue = AsSigned( Conditional() );
+            if (!m_bError && (m_uPos != m_Tokens.size()))
+            {
+                Fail( "unexpected token '" + m_Tokens[m_uPos] + "' in #if expression" );
+            }
+            o_Error = m_Error;
+            return !m_bError;
+        }
+
+    private:
+
+        bool Accept( const char* pszText )
+        {
+            if ((m_uPos < m_Tokens.size()) && (m_Tokens[m_uPos] == pszText))
+            {
+                m_uPos++;
+                return true;
+            }
+            return false;
+        }
+
+        void Fail( const std::string& i_Message )
+        {
+            if (!m_bError)
+            {
+                m_bError = true;
+                m_Error = i_Message;
+            }
+        }
+
+        // Errors in the result of an operation only count if the operation is evaluated
+        Value ArithmeticError( const char* pszMessage )
+        {
+            if (m_iUnevaluated == 0)
+            {
+                Fail( pszMessage );
+            }
+            return MakeValue( 0, false );
+        }
+
+        Value Conditional()
+        {
+            Value cond = LogicalOr();
+            if (Accept( "?" ))
+            {
+                bool bCond = (cond.m_uBits != 0);
+                m_iUnevaluated += bCond ? 0 : 1;
+                Value trueValue = Conditional();
+                m_iUnevaluated -= bCond ? 0 : 1;
+                if (!Accept( ":" ))
+                {
+                    Fail( "expected ':' in #if expression" );
+                    return MakeValue( 0, false );
+                }
+                m_iUnevaluated += bCond ? 1 : 0;
+                Value falseValue = Conditional();
+                m_iUnevaluated -= bCond ? 1 : 0;
+
+                Value result = bCond ? trueValue : falseValue;
+                result.m_bUnsigned = IsUnsigned( trueValue, falseValue );
+                return result;
+            }
+            return cond;
+        }
+
+        Value LogicalOr()
+        {
+            Value value = LogicalAnd();
+            while (Accept( "||" ))
+            {
+                bool bLeft = (value.m_uBits != 0);
+                m_iUnevaluated += bLeft ? 1 : 0;
+                Value right = LogicalAnd();
+                m_iUnevaluated -= bLeft ? 1 : 0;
+                value = MakeBool( bLeft || (right.m_uBits != 0) );
+            }
+            return value;
+        }
+
+        Value LogicalAnd()
+        {
+            Value value = BitOr();
+            while (Accept( "&&" ))
+            {
+                bool bLeft = (value.m_uBits != 0);
+                m_iUnevaluated += bLeft ? 0 : 1;
+                Value right = BitOr();
+                m_iUnevaluated -= bLeft ? 0 : 1;
+                value = MakeBool( bLeft && (right.m_uBits != 0) );
+            }
+            return value;
+        }
+
+        Value BitOr()
+        {
+            Value value = BitXor();
+            while (Accept( "|" ))
+            {
+                Value right = BitXor();
+                value = MakeValue( value.m_uBits | right.m_uBits, IsUnsigned( value, right ) );
+            }
+            return value;
+        }
+
+        Value BitXor()
+        {
+            Value value = BitAnd();
+            while (Accept( "^" ))
+            {
+                Value right = BitAnd();
+                value = MakeValue( value.m_uBits ^ right.m_uBits, IsUnsigned( value, right ) );
+            }
+            return value;
+        }
+
+        Value BitAnd()
+        {
+            Value value = Equality();
+            while (Accept( "&" ))
+            {
+                Value right = Equality();
+                value = MakeValue( value.m_uBits & right.m_uBits, IsUnsigned( value, right ) );
+            }
+            return value;
+        }
+
+        Value Equality()
+        {
+            Value value = Relational();
+            for (;;)
+            {
+                if (Accept( "==" ))      { value = MakeBool( value.m_uBits == Relational().m_uBits ); }
+                else if (Accept( "!=" )) { value = MakeBool( value.m_uBits != Relational().m_uBits ); }
+                else                     { return value; }
+            }
+        }
+
+        Value Relational()
+        {
+            Value value = Shift();
+            for (;;)
+            {
+                if (Accept( "<=" ))      { value = MakeBool( !IsLess( Shift(), value ) ); }
+                else if (Accept( ">=" )) { value = MakeBool( !IsLess( value, Shift() ) ); }
+                else if (Accept( "<" ))  { value = MakeBool( IsLess( value, Shift() ) ); }
+                else if (Accept( ">" ))  { value = MakeBool( IsLess( Shift(), value ) ); }
+                else                     { return value; }
+            }
+        }
+
+        // The result has the type of the left operand
+        Value Shift()
+        {
+            Value value = Additive();
+            for (;;)
+            {
+                if (Accept( "<<" ))
+                {
+                    unsigned int uShift = (unsigned int)(Additive().m_uBits & 63);
+                    value.m_uBits <<= uShift;
+                }
+                else if (Accept( ">>" ))
+                {
+                    unsigned int uShift = (unsigned int)(Additive().m_uBits & 63);
+                    value.m_uBits = value.m_bUnsigned ? (value.m_uBits >> uShift) : (unsigned long long)(AsSigned( value ) >> uShift);
+                }
+                else
+                {
+                    return value;
+                }
+            }
+        }
+
+        Value Additive()
+        {
+            Value value = Multiplicative();
+            for (;;)
+            {
+                bool bAdd = Accept( "+" );
+                if (!bAdd && !Accept( "-" ))
+                {
+                    return value;
+                }
+
+                Value right = Multiplicative();
+                bool bUnsigned = IsUnsigned( value, right );
+                unsigned long long uResult = bAdd ? (value.m_uBits + right.m_uBits) : (value.m_uBits - right.m_uBits);
+
+                // Signed overflow: the operands of an addition have the same sign and the
+                // result doesn't, or those of a subtraction differ and the result takes the
+                // sign of the right
+                unsigned long long uSigns = bAdd ? ((value.m_uBits ^ uResult) & (right.m_uBits ^ uResult))
+                                                 : ((value.m_uBits ^ right.m_uBits) & (value.m_uBits ^ uResult));
+                if (!bUnsigned && (uSigns >> 63))
+                {
+                    value = ArithmeticError( "integer overflow in #if expression" );
+                }
+                else
+                {
+                    value = MakeValue( uResult, bUnsigned );
+                }
+            }
+        }
+
+        Value Multiplicative()
+        {
+            Value value = Unary();
+            for (;;)
+            {
+                if (Accept( "*" ))
+                {
+                    Value right = Unary();
+                    bool bUnsigned = IsUnsigned( value, right );
+                    unsigned long long uResult = value.m_uBits * right.m_uBits;
+
+                    long long iLeft = AsSigned( value );
+                    long long iRight = AsSigned( right );
+                    bool bOverflow = !bUnsigned && (iLeft != 0) &&
+                                     (((iLeft == -1) && (iRight == LLONG_MIN)) ||
+                                      ((iRight == -1) && (iLeft == LLONG_MIN)) ||
+                                      ((long long)uResult / iLeft != iRight));
+                    value = bOverflow ? ArithmeticError( "integer overflow in #if expression" ) : MakeValue( uResult, bUnsigned );
+                }
+                else if (Accept( "/" ) || Accept( "%" ))
+                {
+                    bool bDivide = (m_Tokens[m_uPos - 1] == "/");
+                    Value right = Unary();
+                    bool bUnsigned = IsUnsigned( value, right );
+                    if (right.m_uBits == 0)
+                    {
+                        value = ArithmeticError( "division by zero in #if expression" );
+                    }
+                    else if (bUnsigned)
+                    {
+                        value = MakeValue( bDivide ? (value.m_uBits / right.m_uBits) : (value.m_uBits % right.m_uBits), true );
+                    }
+                    else if ((AsSigned( value ) == LLONG_MIN) && (AsSigned( right ) == -1))
+                    {
+                        // The quotient doesn't fit, and the remainder traps on x86 too
+                        value = ArithmeticError( "integer overflow in #if expression" );
+                    }
+                    else
+                    {
+                        long long iResult = bDivide ? (AsSigned( value ) / AsSigned( right )) : (AsSigned( value ) % AsSigned( right ));
+                        value = MakeValue( (unsigned long long)iResult, false );
+                    }
+                }
+                else
+                {
+                    return value;
+                }
+            }
+        }
+
+        Value Unary()
+        {
+            if (Accept( "+" )) { return Unary(); }
+            if (Accept( "-" ))
+            {
+                Value value = Unary();
+                if (!value.m_bUnsigned && (AsSigned( value ) == LLONG_MIN))
+                {
+                    return ArithmeticError( "integer overflow in #if expression" );
+                }
+                return MakeValue( 0ULL - value.m_uBits, value.m_bUnsigned );
+            }
+            if (Accept( "!" )) { return MakeBool( Unary().m_uBits == 0 ); }
+            if (Accept( "~" ))
+            {
+                Value value = Unary();
+                return MakeValue( ~value.m_uBits, value.m_bUnsigned );
+            }
+            return Primary();
+        }
+
+        Value Primary()
+        {
+            if (Accept( "(" ))
+            {
+                Value value = Conditional();
+                if (!Accept( ")" ))
+                {
+                    Fail( "expected ')' in #if expression" );
+                }
+                return value;
+            }
+
+            if (m_uPos >= m_Tokens.size())
+            {
+                Fail( "unexpected end of #if expression" );
+                return MakeValue( 0, false );
+            }
+
+            const std::string& token = m_Tokens[m_uPos++];
+            if (token[0] == '\'')
+            {
+                return MakeValue( (unsigned long long)ParseCharacter( token ), false );
+            }
+            if (IsDigit( token[0] ))
+            {
+                return ParseNumber( token );
+            }
+
+            Fail( "unexpected token '" + token + "' in #if expression" );
+            return MakeValue( 0, false );
+        }
+
+        // A constant is unsigned if it has a u suffix, or is too large for intmax_t
+        Value ParseNumber( const std::string& i_Token )
+        {
+            size_t uLength = i_Token.size();
+            bool bUnsigned = false;
+            while ((uLength > 0) && strchr( "uUlL", i_Token[uLength - 1] ))
+            {
+                bUnsigned = bUnsigned || (i_Token[uLength - 1] == 'u') || (i_Token[uLength - 1] == 'U');
+                uLength--;
+            }
+
+            unsigned long long uValue = 0;
+            unsigned int uBase = 10;
+            size_t i = 0;
+            if ((uLength > 1) && (i_Token[0] == '0') && ((i_Token[1] == 'x') || (i_Token[1] == 'X')))
+            {
+                uBase = 16;
+                i = 2;
+            }
+            else if ((uLength > 1) && (i_Token[0] == '0'))
+            {
+                uBase = 8;
+                i = 1;
+            }
+
+            for (; i < uLength; i++)
+            {
+                char c = i_Token[i];
+                unsigned int uDigit = 0;
+                if (IsDigit( c ))                   { uDigit = (unsigned int)(c - '0'); }
+                else if ((c >= 'a') && (c <= 'f'))  { uDigit = (unsigned int)(c - 'a' + 10); }
+                else if ((c >= 'A') && (c <= 'F'))  { uDigit = (unsigned int)(c - 'A' + 10); }
+                else                                { uDigit = 16; }
+
+                if (uDigit >= uBase)
+                {
+                    Fail( "invalid integer constant '" + i_Token + "' in #if expression" );
+                    return MakeValue( 0, false );
+                }
+                if (uValue > (ULLONG_MAX - uDigit) / uBase)
+                {
+                    Fail( "integer constant '" + i_Token + "' is too large in #if expression" );
+                    return MakeValue( 0, false );
+                }
+                uValue = uValue * uBase + uDigit;
+            }
+
+            return MakeValue( uValue, bUnsigned || (uValue > (unsigned long long)LLONG_MAX) );
+        }
+
+        long long ParseCharacter( const std::string& i_Token )
+        {
+            if ((i_Token.size() >= 3) && (i_Token[1] != '\\'))
+            {
+                return (unsigned char)i_Token[1];
+            }
+            if (i_Token.size() >= 4)
+            {
+                switch (i_Token[2])
+                {
+                case 'n':   return '\n';
+                case 't':   return '\t';
+                case 'r':   return '\r';
+                case '0':   return '\0';
+                default:    return (unsigned char)i_Token[2];
+                }
+            }
+            Fail( "invalid character constant in #if expression" );
+            return 0;
+        }
+
+        const std::vector<std::string>& m_Tokens;
+        size_t                          m_uPos;
+        int                             m_iUnevaluated;     // depth of operands that aren't evaluated
+        bool                            m_bError;
+        std::string                     m_Error;
+    };
+}
+
+
+//--------------------------------------------------------------------------------------
+// Constructor
+//--------------------------------------------------------------------------------------
+ShaderPreprocessor::ShaderPreprocessor()
+    : m_pOutput( NULL )
+    , m_iCurrentLine( 0 )
+    , m_bAtLineStart( true )
+{
+}
+
+
+//--------------------------------------------------------------------------------------
+// Destructor
+//--------------------------------------------------------------------------------------
+ShaderPreprocessor::~ShaderPreprocessor()
+{
+}
+
+
+//--------------------------------------------------------------------------------------
+// Adds an include search path
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::AddIncludePath( const char* pszPath )
+{
+    if (pszPath && *pszPath)
+    {
+        m_IncludePaths.push_back( pszPath );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Defines a macro, the same way a /D option on the fxc command line would
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::Define( const char* pszName, const char* pszValue )
+{
+    std::string line( "#define " );
+    line += pszName;
+    line += " ";
+    line += pszValue ? pszValue : "";
+
+    TokenList tokens;
+    Tokenize( line, tokens );
+    HandleDefine( "<command line>", 0, tokens );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Defines a macro from a wide name and integer value (ShaderCache::Macro)
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::Define( const wchar_t* pwsName, int iValue )
+{
+    // Macro names are plain identifiers, so a straight narrowing copy is sufficient
+    std::string name;
+    for (const wchar_t* p = pwsName; p && *p; p++)
+    {
+        name += (char)*p;
+    }
+
+    Define( name.c_str(), IntToString( iValue ).c_str() );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Removes a macro
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::Undefine( const char* pszName )
+{
+    m_Macros.erase( pszName );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Clears all state apart from the include paths
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::Reset()
+{
+    m_Macros.clear();
+    m_Dependencies.clear();
+    m_PragmaOnceFiles.clear();
+    m_Errors.clear();
+    m_PendingText.clear();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Preprocesses a file from disk
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::PreprocessFile( const char* pszFileName, std::string& o_Output )
+{
+    std::string contents;
+    if (!ReadFile( pszFileName, contents ))
+    {
+        m_Errors.clear();
+        m_Dependencies.clear();
+        Error( pszFileName, 0, "cannot open source file" );
+        return false;
+    }
+
+    return PreprocessSource( contents.data(), contents.size(), pszFileName, o_Output );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Preprocesses source held in memory
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::PreprocessSource( const char* pSource, size_t uLength, const char* pszFileName, std::string& o_Output )
+{
+    o_Output.clear();
+    m_Errors.clear();
+    m_Dependencies.clear();
+    m_PragmaOnceFiles.clear();
+    m_PendingText.clear();
+    m_pOutput = &o_Output;
+    m_bAtLineStart = true;
+
+    // Macros defined by the source itself must not leak into the next run
+    std::map<std::string, MacroDef> savedMacros = m_Macros;
+
+    std::string fileName( pszFileName ? pszFileName : "<memory>" );
+    m_Dependencies.push_back( fileName );
+
+    std::string text;
+    SpliceAndStripComments( pSource, uLength, text );
+    bool bResult = ProcessFile( fileName, text, 0 );
+
+    if (!m_bAtLineStart)
+    {
+        o_Output += '\n';
+    }
+
+    m_Macros.swap( savedMacros );
+    m_pOutput = NULL;
+
+    return bResult && m_Errors.empty();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Removes backslash-newline splices and comments. Newlines are preserved (deferred to the
+// end of the logical line) so that line numbers in error messages stay correct.
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::SpliceAndStripComments( const char* pSource, size_t uLength, std::string& o_Text )
+{
+    o_Text.clear();
+    o_Text.reserve( uLength );
+
+    int iDeferredNewlines = 0;
+    size_t i = 0;
+
+    while (i < uLength)
+    {
+        char c = pSource[i];
+
+        // Line splice
+        if ((c == '\\') && (i + 1 < uLength) && ((pSource[i + 1] == '\n') || ((pSource[i + 1] == '\r') && (i + 2 < uLength) && (pSource[i + 2] == '\n'))))
+        {
+            i += (pSource[i + 1] == '\r') ? 3 : 2;
+            iDeferredNewlines++;
+            continue;
+        }
+
+        if (c == '\r')
+        {
+            i++;
+            continue;
+        }
+
+        if (c == '\n')
+        {
+            o_Text += '\n';
+            o_Text.append( (size_t)iDeferredNewlines, '\n' );
+            iDeferredNewlines = 0;
+            i++;
+            continue;
+        }
+
+        // Line comment
+        if ((c == '/') && (i + 1 < uLength) && (pSource[i + 1] == '/'))
+        {
+            while ((i < uLength) && (pSource[i] != '\n'))
+            {
+                if ((pSource[i] == '\\') && (i + 1 < uLength) && (pSource[i + 1] == '\n'))
+                {
+                    iDeferredNewlines++;
+                    i++;
+                }
+                i++;
+            }
+            o_Text += ' ';
+            continue;
+        }
+
+        // Block comment
+        if ((c == '/') && (i + 1 < uLength) && (pSource[i + 1] == '*'))
+        {
+            i += 2;
+            while ((i < uLength) && !((pSource[i] == '*') && (i + 1 < uLength) && (pSource[i + 1] == '/')))
+            {
+                if (pSource[i] == '\n')
+                {
+                    iDeferredNewlines++;
+                }
+                i++;
+            }
+            i = std::min( i + 2, uLength );
+            o_Text += ' ';
+            continue;
+        }
+
+        // String and character literals are copied verbatim, so comment markers inside them are ignored
+        if ((c == '"') || (c == '\''))
+        {
+            o_Text += c;
+            i++;
+            while ((i < uLength) && (pSource[i] != c) && (pSource[i] != '\n'))
+            {
+                if ((pSource[i] == '\\') && (i + 1 < uLength) && (pSource[i + 1] != '\n'))
+                {
+                    o_Text += pSource[i++];
+                }
+                o_Text += pSource[i++];
+            }
+            if ((i < uLength) && (pSource[i] == c))
+            {
+                o_Text += pSource[i++];
+            }
+            continue;
+        }
+
+        o_Text += c;
+        i++;
+    }
+
+    o_Text.append( (size_t)iDeferredNewlines, '\n' );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Splits a single logical line into preprocessing tokens
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::Tokenize( const std::string& i_Line, TokenList& o_Tokens )
+{
+    o_Tokens.clear();
+
+    const size_t uLength = i_Line.size();
+    size_t i = 0;
+    bool bSpace = false;
+
+    while (i < uLength)
+    {
+        char c = i_Line[i];
+
+        if ((c == ' ') || (c == '\t') || (c == '\f') || (c == '\v'))
+        {
+            bSpace = true;
+            i++;
+            continue;
+        }
+
+        Token token;
+        token.m_bSpaceBefore = bSpace;
+        bSpace = false;
+        size_t uStart = i;
+
+        if (IsIdentStart( c ))
+        {
+            while ((i < uLength) && IsIdentChar( i_Line[i] ))
+            {
+                i++;
+            }
+            token.m_eType = TOKEN_IDENTIFIER;
+        }
+        else if (IsDigit( c ) || ((c == '.') && (i + 1 < uLength) && IsDigit( i_Line[i + 1] )))
+        {
+            // pp-number: digits, letters, underscores, dots, and signed exponents
+            i++;
+            while (i < uLength)
+            {
+                char n = i_Line[i];
+                if (((n == '+') || (n == '-')) && strchr( "eEpP", i_Line[i - 1] ))
+                {
+                    i++;
+                }
+                else if (IsIdentChar( n ) || (n == '.'))
+                {
+                    i++;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            token.m_eType = TOKEN_NUMBER;
+        }
+        else if ((c == '"') || (c == '\''))
+        {
+            i++;
+            while ((i < uLength) && (i_Line[i] != c))
+            {
+                i += (i_Line[i] == '\\') ? 2 : 1;
+            }
+            i = std::min( i + 1, uLength );
+            token.m_eType = TOKEN_STRING;
+        }
+        else
+        {
+            size_t uMatch = 1;
+            for (size_t p = 0; p < sizeof( kMultiCharPunctuators ) / sizeof( kMultiCharPunctuators[0] ); p++)
+            {
+                size_t uPunctLength = strlen( kMultiCharPunctuators[p] );
+                if (i_Line.compare( i, uPunctLength, kMultiCharPunctuators[p] ) == 0)
+                {
+                    uMatch = uPunctLength;
+                    break;
+                }
+            }
+            i += uMatch;
+            token.m_eType = TOKEN_PUNCTUATOR;
+        }
+
+        token.m_Text = i_Line.substr( uStart, i - uStart );
+        o_Tokens.push_back( token );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Processes one (already spliced and comment-stripped) file
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::ProcessFile( const std::string& i_FileName, const std::string& i_Text, int iDepth )
+{
+    std::vector<CondState> conds;
+    TokenList tokens;
+    int iLine = 0;
+    size_t uLineStart = 0;
+
+    while (uLineStart < i_Text.size())
+    {
+        size_t uLineEnd = i_Text.find( '\n', uLineStart );
+        if (uLineEnd == std::string::npos)
+        {
+            uLineEnd = i_Text.size();
+        }
+
+        iLine++;
+        m_CurrentFile = i_FileName;
+        m_iCurrentLine = iLine;
+
+        Tokenize( i_Text.substr( uLineStart, uLineEnd - uLineStart ), tokens );
+        uLineStart = uLineEnd + 1;
+
+        if (tokens.empty())
+        {
+            continue;
+        }
+
+        if ((tokens[0].m_eType == TOKEN_PUNCTUATOR) && (tokens[0].m_Text == "#"))
+        {
+            // Directives end any pending run of text, which must be expanded first
+            FlushPendingText();
+            if (!ProcessDirective( i_FileName, iLine, tokens, conds, iDepth ))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        if (conds.empty() || conds.back().m_bActive)
+        {
+            m_PendingText.insert( m_PendingText.end(), tokens.begin(), tokens.end() );
+        }
+    }
+
+    FlushPendingText();
+
+    if (!conds.empty())
+    {
+        Error( i_FileName, iLine, "unterminated #if" );
+        return false;
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Handles a single directive line (tokens[0] is the '#')
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::ProcessDirective( const std::string& i_FileName, int iLine, const TokenList& i_Tokens,
+                                           std::vector<CondState>& io_Conds, int iDepth )
+{
+    // Null directive
+    if (i_Tokens.size() < 2)
+    {
+        return true;
+    }
+
+    const std::string& directive = i_Tokens[1].m_Text;
+    const bool kbActive = io_Conds.empty() || io_Conds.back().m_bActive;
+
+    if ((directive == "if") || (directive == "ifdef") || (directive == "ifndef"))
+    {
+        CondState cond;
+        cond.m_bParentActive = kbActive;
+        cond.m_bActive = false;
+        cond.m_bTaken = false;
+        cond.m_bSeenElse = false;
+
+        if (kbActive)
+        {
+            bool bResult = false;
+            if (directive == "if")
+            {
+                if (!EvaluateCondition( i_FileName, iLine, i_Tokens, bResult ))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                if ((i_Tokens.size() < 3) || (i_Tokens[2].m_eType != TOKEN_IDENTIFIER))
+                {
+                    Error( i_FileName, iLine, "#" + directive + " expects a macro name" );
+                    return false;
+                }
+                bResult = (m_Macros.find( i_Tokens[2].m_Text ) != m_Macros.end());
+                if (directive == "ifndef")
+                {
+                    bResult = !bResult;
+                }
+            }
+            cond.m_bActive = bResult;
+            cond.m_bTaken = bResult;
+        }
+
+        io_Conds.push_back( cond );
+        return true;
+    }
+
+    if (directive == "elif")
+    {
+        if (io_Conds.empty() || io_Conds.back().m_bSeenElse)
+        {
+            Error( i_FileName, iLine, "#elif without #if" );
+            return false;
+        }
+
+        CondState& cond = io_Conds.back();
+        if (!cond.m_bParentActive || cond.m_bTaken)
+        {
+            cond.m_bActive = false;
+            return true;
+        }
+
+        bool bResult = false;
+        if (!EvaluateCondition( i_FileName, iLine, i_Tokens, bResult ))
+        {
+            return false;
+        }
+        cond.m_bActive = bResult;
+        cond.m_bTaken = bResult;
+        return true;
+    }
+
+    if (directive == "else")
+    {
+        if (io_Conds.empty() || io_Conds.back().m_bSeenElse)
+        {
+            Error( i_FileName, iLine, "#else without #if" );
+            return false;
+        }
+
+        CondState& cond = io_Conds.back();
+        cond.m_bActive = cond.m_bParentActive && !cond.m_bTaken;
+        cond.m_bTaken = true;
+        cond.m_bSeenElse = true;
+        return true;
+    }
+
+    if (directive == "endif")
+    {
+        if (io_Conds.empty())
+        {
+            Error( i_FileName, iLine, "#endif without #if" );
+            return false;
+        }
+        io_Conds.pop_back();
+        return true;
+    }
+
+    // Everything below only applies inside active blocks
+    if (!kbActive)
+    {
+        return true;
+    }
+
+    if (directive == "define")
+    {
+        return HandleDefine( i_FileName, iLine, i_Tokens );
+    }
+
+    if (directive == "undef")
+    {
+        if ((i_Tokens.size() < 3) || (i_Tokens[2].m_eType != TOKEN_IDENTIFIER))
+        {
+            Error( i_FileName, iLine, "#undef expects a macro name" );
+            return false;
+        }
+        m_Macros.erase( i_Tokens[2].m_Text );
+        return true;
+    }
+
+    if (directive == "include")
+    {
+        return HandleInclude( i_FileName, iLine, i_Tokens, iDepth );
+    }
+
+    if (directive == "pragma")
+    {
+        if ((i_Tokens.size() >= 3) && (i_Tokens[2].m_Text == "once"))
+        {
+            m_PragmaOnceFiles.insert( i_FileName );
+        }
+        else
+        {
+            // Other pragmas (pack_matrix, warning, ...) affect compilation, so they are kept
+            EmitLine( i_Tokens );
+        }
+        return true;
+    }
+
+    if (directive == "error")
+    {
+        std::string message( "#error" );
+        for (size_t i = 2; i < i_Tokens.size(); i++)
+        {
+            message += " " + i_Tokens[i].m_Text;
+        }
+        Error( i_FileName, iLine, message );
+        return false;
+    }
+
+    if (directive == "line")
+    {
+        // #line only carries file/line info, which is deliberately left out of the canonical stream
+        return true;
+    }
+
+    Error( i_FileName, iLine, "unknown preprocessor directive '#" + directive + "'" );
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Handles #include "file" and #include <file>
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::HandleInclude( const std::string& i_FileName, int iLine, const TokenList& i_Tokens, int iDepth )
+{
+    TokenList operand( i_Tokens.begin() + 2, i_Tokens.end() );
+
+    // A computed include is macro expanded once before being interpreted
+    if (!operand.empty() && (operand[0].m_eType != TOKEN_STRING) && (operand[0].m_Text != "<"))
+    {
+        TokenList expanded;
+        if (!Expand( operand, expanded ))
+        {
+            return false;
+        }
+        operand.swap( expanded );
+    }
+
+    std::string includeName;
+    bool bQuoted = false;
+
+    if (!operand.empty() && (operand[0].m_eType == TOKEN_STRING) && (operand[0].m_Text[0] == '"') && (operand[0].m_Text.size() >= 2))
+    {
+        includeName = operand[0].m_Text.substr( 1, operand[0].m_Text.size() - 2 );
+        bQuoted = true;
+    }
+    else if (!operand.empty() && (operand[0].m_Text == "<"))
+    {
+        size_t i = 1;
+        for (; (i < operand.size()) && (operand[i].m_Text != ">"); i++)
+        {
+            if ((i > 1) && operand[i].m_bSpaceBefore)
+            {
+                includeName += ' ';
+            }
+            includeName += operand[i].m_Text;
+        }
+        if (i == operand.size())
+        {
+            includeName.clear();
+        }
+    }
+
+    if (includeName.empty())
+    {
+        Error( i_FileName, iLine, "#include expects \"FILENAME\" or <FILENAME>" );
+        return false;
+    }
+
+    if (iDepth >= kiMaxIncludeDepth)
+    {
+        Error( i_FileName, iLine, "#include nested too deeply" );
+        return false;
+    }
+
+    // Quoted includes look next to the including file first, then in the include paths
+    std::vector<std::string> candidates;
+    if (bQuoted)
+    {
+        candidates.push_back( JoinPath( DirectoryOf( i_FileName ), includeName ) );
+    }
+    for (size_t i = 0; i < m_IncludePaths.size(); i++)
+    {
+        candidates.push_back( JoinPath( m_IncludePaths[i], includeName ) );
+    }
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        std::string contents;
+        if (!ReadFile( candidates[i], contents ))
+        {
+            continue;
+        }
+
+        if (m_PragmaOnceFiles.find( candidates[i] ) != m_PragmaOnceFiles.end())
+        {
+            return true;
+        }
+
+        if (std::find( m_Dependencies.begin(), m_Dependencies.end(), candidates[i] ) == m_Dependencies.end())
+        {
+            m_Dependencies.push_back( candidates[i] );
+        }
+
+        std::string text;
+        SpliceAndStripComments( contents.data(), contents.size(), text );
+        return ProcessFile( candidates[i], text, iDepth + 1 );
+    }
+
+    Error( i_FileName, iLine, "cannot open include file '" + includeName + "'" );
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Handles #define (tokens[0] is '#', tokens[1] is 'define')
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::HandleDefine( const std::string& i_FileName, int iLine, const TokenList& i_Tokens )
+{
+    if ((i_Tokens.size() < 3) || (i_Tokens[2].m_eType != TOKEN_IDENTIFIER))
+    {
+        Error( i_FileName, iLine, "#define expects a macro name" );
+        return false;
+    }
+
+    MacroDef macro;
+    size_t uBody = 3;
+
+    // A '(' immediately after the name (no whitespace) makes this a function-like macro
+    if ((i_Tokens.size() > 3) && (i_Tokens[3].m_Text == "(") && !i_Tokens[3].m_bSpaceBefore)
+    {
+        macro.m_bFunctionLike = true;
+        size_t i = 4;
+        bool bExpectParam = true;
+
+        for (; i < i_Tokens.size(); i++)
+        {
+            const Token& token = i_Tokens[i];
+            if (token.m_Text == ")")
+            {
+                break;
+            }
+            if (bExpectParam && (token.m_eType == TOKEN_IDENTIFIER))
+            {
+                macro.m_Params.push_back( token.m_Text );
+                bExpectParam = false;
+            }
+            else if (bExpectParam && (token.m_Text == "..."))
+            {
+                macro.m_Params.push_back( "__VA_ARGS__" );
+                macro.m_bVariadic = true;
+                bExpectParam = false;
+            }
+            else if (!bExpectParam && !macro.m_bVariadic && (token.m_Text == ","))
+            {
+                bExpectParam = true;
+            }
+            else
+            {
+                Error( i_FileName, iLine, "invalid macro parameter list" );
+                return false;
+            }
+        }
+
+        if ((i == i_Tokens.size()) || (bExpectParam && !macro.m_Params.empty()))
+        {
+            Error( i_FileName, iLine, "invalid macro parameter list" );
+            return false;
+        }
+        uBody = i + 1;
+    }
+
+    macro.m_Body.assign( i_Tokens.begin() + uBody, i_Tokens.end() );
+    if (!macro.m_Body.empty())
+    {
+        macro.m_Body[0].m_bSpaceBefore = false;
+
+        if ((macro.m_Body.front().m_Text == "##") || (macro.m_Body.back().m_Text == "##"))
+        {
+            Error( i_FileName, iLine, "'##' cannot appear at either end of a macro expansion" );
+            return false;
+        }
+    }
+
+    m_Macros[i_Tokens[2].m_Text] = macro;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Evaluates the expression of an #if or #elif
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::EvaluateCondition( const std::string& i_FileName, int iLine, const TokenList& i_Tokens, bool& o_bResult )
+{
+    // Resolve defined X / defined( X ) before macro expansion
+    TokenList resolved;
+    for (size_t i = 2; i < i_Tokens.size(); i++)
+    {
+        const Token& token = i_Tokens[i];
+        if ((token.m_eType == TOKEN_IDENTIFIER) && (token.m_Text == "defined"))
+        {
+            bool bParen = (i + 1 < i_Tokens.size()) && (i_Tokens[i + 1].m_Text == "(");
+            size_t uName = i + (bParen ? 2 : 1);
+            if ((uName >= i_Tokens.size()) || (i_Tokens[uName].m_eType != TOKEN_IDENTIFIER) ||
+                (bParen && ((uName + 1 >= i_Tokens.size()) || (i_Tokens[uName + 1].m_Text != ")"))))
+            {
+                Error( i_FileName, iLine, "'defined' expects a macro name" );
+                return false;
+            }
+
+            Token value;
+            value.m_eType = TOKEN_NUMBER;
+            value.m_bSpaceBefore = token.m_bSpaceBefore;
+            value.m_Text = (m_Macros.find( i_Tokens[uName].m_Text ) != m_Macros.end()) ? "1" : "0";
+            resolved.push_back( value );
+
+            i = uName + (bParen ? 1 : 0);
+            continue;
+        }
+        resolved.push_back( token );
+    }
+
+    TokenList expanded;
+    if (!Expand( resolved, expanded ))
+    {
+        return false;
+    }
+
+    // Identifiers left after expansion evaluate to zero (true/false are accepted for HLSL's sake)
+    std::vector<std::string> texts;
+    for (size_t i = 0; i < expanded.size(); i++)
+    {
+        const Token& token = expanded[i];
+        if (token.m_eType == TOKEN_IDENTIFIER)
+        {
+            texts.push_back( (token.m_Text == "true") ? "1" : "0" );
+        }
+        else
+        {
+            texts.push_back( token.m_Text );
+        }
+    }
+
+    if (texts.empty())
+    {
+        Error( i_FileName, iLine, "#if with no expression" );
+        return false;
+    }
+
+    long long iValue = 0;
+    std::string error;
+    ExpressionEvaluator evaluator( texts );
+    if (!evaluator.Evaluate( iValue, error ))
+    {
+        Error( i_FileName, iLine, error );
+        return false;
+    }
+
+    o_bResult = (iValue != 0);
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Fully macro expands a token list
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::Expand( const TokenList& i_Tokens, TokenList& o_Tokens )
+{
+    // Work list held in reverse, so the next token to process is at the back
+    TokenList work( i_Tokens.rbegin(), i_Tokens.rend() );
+
+    while (!work.empty())
+    {
+        Token token = work.back();
+        work.pop_back();
+
+        std::map<std::string, MacroDef>::const_iterator it = m_Macros.end();
+        if ((token.m_eType == TOKEN_IDENTIFIER) && (token.m_HideSet.find( token.m_Text ) == token.m_HideSet.end()))
+        {
+            it = m_Macros.find( token.m_Text );
+        }
+
+        if (it == m_Macros.end())
+        {
+            o_Tokens.push_back( token );
+            continue;
+        }
+
+        const MacroDef& macro = it->second;
+        std::vector<TokenList> args;
+        std::set<std::string> hideSet;
+
+        if (!macro.m_bFunctionLike)
+        {
+            hideSet = token.m_HideSet;
+        }
+        else
+        {
+            // A function-like macro name not followed by '(' is left alone
+            if (work.empty() || (work.back().m_eType != TOKEN_PUNCTUATOR) || (work.back().m_Text != "("))
+            {
+                o_Tokens.push_back( token );
+                continue;
+            }
+            work.pop_back();
+
+            TokenList current;
+            int iDepth = 0;
+            bool bClosed = false;
+            Token closeParen;
+
+            while (!work.empty())
+            {
+                Token arg = work.back();
+                work.pop_back();
+
+                if (arg.m_eType == TOKEN_PUNCTUATOR)
+                {
+                    if (arg.m_Text == "(")
+                    {
+                        iDepth++;
+                    }
+                    else if (arg.m_Text == ")")
+                    {
+                        if (iDepth == 0)
+                        {
+                            closeParen = arg;
+                            bClosed = true;
+                            break;
+                        }
+                        iDepth--;
+                    }
+                    else if ((arg.m_Text == ",") && (iDepth == 0) &&
+                             !(macro.m_bVariadic && (args.size() + 1 == macro.m_Params.size())))
+                    {
+                        args.push_back( current );
+                        current.clear();
+                        continue;
+                    }
+                }
+                current.push_back( arg );
+            }
+
+            if (!bClosed)
+            {
+                Error( m_CurrentFile, m_iCurrentLine, "unterminated argument list invoking macro '" + token.m_Text + "'" );
+                return false;
+            }
+
+            args.push_back( current );
+            if (macro.m_Params.empty() && (args.size() == 1) && args[0].empty())
+            {
+                args.clear();
+            }
+            if (macro.m_bVariadic && (args.size() + 1 == macro.m_Params.size()))
+            {
+                args.push_back( TokenList() );
+            }
+            if (args.size() != macro.m_Params.size())
+            {
+                Error( m_CurrentFile, m_iCurrentLine, "wrong number of arguments for macro '" + token.m_Text + "'" );
+                return false;
+            }
+
+            std::set_intersection( token.m_HideSet.begin(), token.m_HideSet.end(),
+                                   closeParen.m_HideSet.begin(), closeParen.m_HideSet.end(),
+                                   std::inserter( hideSet, hideSet.begin() ) );
+        }
+
+        hideSet.insert( token.m_Text );
+
+        TokenList result;
+        if (!Substitute( macro, args, hideSet, result ))
+        {
+            return false;
+        }
+        if (!result.empty())
+        {
+            result[0].m_bSpaceBefore = token.m_bSpaceBefore;
+        }
+
+        work.insert( work.end(), result.rbegin(), result.rend() );
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Substitutes arguments into a macro body, handling # and ##
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::Substitute( const MacroDef& i_Macro, const std::vector<TokenList>& i_Args,
+                                     const std::set<std::string>& i_HideSet, TokenList& o_Tokens )
+{
+    const TokenList& body = i_Macro.m_Body;
+
+    for (size_t i = 0; i < body.size(); i++)
+    {
+        const Token& token = body[i];
+        const bool kbHasNext = (i + 1 < body.size());
+
+        // # param
+        if (i_Macro.m_bFunctionLike && (token.m_eType == TOKEN_PUNCTUATOR) && (token.m_Text == "#") && kbHasNext)
+        {
+            int iParam = FindParam( i_Macro, body[i + 1].m_Text );
+            if (iParam >= 0)
+            {
+                Token str = Stringize( i_Args[iParam] );
+                str.m_bSpaceBefore = token.m_bSpaceBefore;
+                o_Tokens.push_back( str );
+                i++;
+                continue;
+            }
+        }
+
+        // ## rhs
+        if ((token.m_eType == TOKEN_PUNCTUATOR) && (token.m_Text == "##") && kbHasNext)
+        {
+            const Token& rhs = body[++i];
+            int iParam = FindParam( i_Macro, rhs.m_Text );
+            TokenList right;
+            if (iParam >= 0)
+            {
+                right = i_Args[iParam];
+            }
+            else
+            {
+                right.push_back( rhs );
+            }
+
+            if (right.empty())
+            {
+                continue;
+            }
+            if (o_Tokens.empty())
+            {
+                o_Tokens = right;
+                continue;
+            }
+
+            Token pasted;
+            if (!Paste( o_Tokens.back(), right[0], pasted ))
+            {
+                Error( m_CurrentFile, m_iCurrentLine, "pasting \"" + o_Tokens.back().m_Text + "\" and \"" + right[0].m_Text + "\" does not give a valid token" );
+                return false;
+            }
+            o_Tokens.back() = pasted;
+            o_Tokens.insert( o_Tokens.end(), right.begin() + 1, right.end() );
+            continue;
+        }
+
+        int iParam = FindParam( i_Macro, token.m_Text );
+        if (iParam < 0)
+        {
+            o_Tokens.push_back( token );
+            continue;
+        }
+
+        const TokenList& arg = i_Args[iParam];
+        size_t uFirst = o_Tokens.size();
+
+        // param ## ...: the argument is inserted unexpanded
+        if (kbHasNext && (body[i + 1].m_Text == "##"))
+        {
+            if (arg.empty())
+            {
+                // Skip the ##; an argument on its right is then inserted as-is
+                i++;
+                if (i + 1 < body.size())
+                {
+                    int iRight = FindParam( i_Macro, body[i + 1].m_Text );
+                    if (iRight >= 0)
+                    {
+                        o_Tokens.insert( o_Tokens.end(), i_Args[iRight].begin(), i_Args[iRight].end() );
+                        i++;
+                    }
+                }
+            }
+            else
+            {
+                o_Tokens.insert( o_Tokens.end(), arg.begin(), arg.end() );
+            }
+        }
+        else
+        {
+            TokenList expanded;
+            if (!Expand( arg, expanded ))
+            {
+                return false;
+            }
+            o_Tokens.insert( o_Tokens.end(), expanded.begin(), expanded.end() );
+        }
+
+        if (o_Tokens.size() > uFirst)
+        {
+            o_Tokens[uFirst].m_bSpaceBefore = token.m_bSpaceBefore;
+        }
+    }
+
+    for (size_t i = 0; i < o_Tokens.size(); i++)
+    {
+        o_Tokens[i].m_HideSet.insert( i_HideSet.begin(), i_HideSet.end() );
+    }
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Returns the index of a macro parameter, or -1
+//--------------------------------------------------------------------------------------
+int ShaderPreprocessor::FindParam( const MacroDef& i_Macro, const std::string& i_Name ) const
+{
+    if (!i_Macro.m_bFunctionLike)
+    {
+        return -1;
+    }
+
+    for (size_t i = 0; i < i_Macro.m_Params.size(); i++)
+    {
+        if (i_Macro.m_Params[i] == i_Name)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Implements the # operator
+//--------------------------------------------------------------------------------------
+ShaderPreprocessor::Token ShaderPreprocessor::Stringize( const TokenList& i_Tokens )
+{
+    Token result;
+    result.m_eType = TOKEN_STRING;
+    result.m_Text = "\"";
+
+    for (size_t i = 0; i < i_Tokens.size(); i++)
+    {
+        const Token& token = i_Tokens[i];
+        if ((i > 0) && token.m_bSpaceBefore)
+        {
+            result.m_Text += ' ';
+        }
+
+        if (token.m_eType == TOKEN_STRING)
+        {
+            for (size_t c = 0; c < token.m_Text.size(); c++)
+            {
+                if ((token.m_Text[c] == '"') || (token.m_Text[c] == '\\'))
+                {
+                    result.m_Text += '\\';
+                }
+                result.m_Text += token.m_Text[c];
+            }
+        }
+        else
+        {
+            result.m_Text += token.m_Text;
+        }
+    }
+
+    result.m_Text += '"';
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Implements the ## operator
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::Paste( const Token& i_Left, const Token& i_Right, Token& o_Token )
+{
+    TokenList tokens;
+    Tokenize( i_Left.m_Text + i_Right.m_Text, tokens );
+    if (tokens.size() != 1)
+    {
+        return false;
+    }
+
+    o_Token = tokens[0];
+    o_Token.m_bSpaceBefore = i_Left.m_bSpaceBefore;
+    o_Token.m_HideSet = i_Left.m_HideSet;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Expands and emits the text accumulated since the last directive
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::FlushPendingText()
+{
+    if (m_PendingText.empty())
+    {
+        return;
+    }
+
+    TokenList expanded;
+    if (Expand( m_PendingText, expanded ))
+    {
+        EmitTokens( expanded );
+    }
+    m_PendingText.clear();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Writes tokens to the canonical output. Tokens are separated by a single space, with a
+// line break after statements and braces to keep the output readable.
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::EmitTokens( const TokenList& i_Tokens )
+{
+    std::string& output = *m_pOutput;
+
+    for (size_t i = 0; i < i_Tokens.size(); i++)
+    {
+        const std::string& text = i_Tokens[i].m_Text;
+        if (!m_bAtLineStart)
+        {
+            output += ' ';
+        }
+        output += text;
+
+        m_bAtLineStart = (text == ";") || (text == "{") || (text == "}");
+        if (m_bAtLineStart)
+        {
+            output += '\n';
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Writes a directive that is passed through (#pragma) on a line of its own
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::EmitLine( const TokenList& i_Tokens )
+{
+    std::string& output = *m_pOutput;
+
+    if (!m_bAtLineStart)
+    {
+        output += '\n';
+    }
+
+    for (size_t i = 0; i < i_Tokens.size(); i++)
+    {
+        if (i > 1)
+        {
+            output += ' ';
+        }
+        output += i_Tokens[i].m_Text;
+    }
+
+    output += '\n';
+    m_bAtLineStart = true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Reads a whole file into memory
+//--------------------------------------------------------------------------------------
+bool ShaderPreprocessor::ReadFile( const std::string& i_FileName, std::string& o_Contents )
+{
+    FILE* pFile = NULL;
+#ifdef _MSC_VER
+    fopen_s( &pFile, i_FileName.c_str(), "rb" );
+#else
+    pFile = fopen( i_FileName.c_str(), "rb" );
+#endif
+    if (!pFile)
+    {
+        return false;
+    }
+
+    o_Contents.clear();
+    char buffer[4096];
+    size_t uRead = 0;
+    while ((uRead = fread( buffer, 1, sizeof( buffer ), pFile )) > 0)
+    {
+        o_Contents.append( buffer, uRead );
+    }
+
+    fclose( pFile );
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Returns the directory part of a path (empty if there is none)
+//--------------------------------------------------------------------------------------
+std::string ShaderPreprocessor::DirectoryOf( const std::string& i_FileName )
+{
+    size_t uSlash = i_FileName.find_last_of( "/\\" );
+    return (uSlash == std::string::npos) ? std::string() : i_FileName.substr( 0, uSlash );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Joins a directory and a relative file name
+//--------------------------------------------------------------------------------------
+std::string ShaderPreprocessor::JoinPath( const std::string& i_Dir, const std::string& i_File )
+{
+    if (i_Dir.empty())
+    {
+        return i_File;
+    }
+
+    char cLast = i_Dir[i_Dir.size() - 1];
+    if ((cLast == '/') || (cLast == '\\'))
+    {
+        return i_Dir + i_File;
+    }
+
+#ifdef _WIN32
+    return i_Dir + "\\" + i_File;
+#else
+    return i_Dir + "/" + i_File;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------
+// Records an error
+//--------------------------------------------------------------------------------------
+void ShaderPreprocessor::Error( const std::string& i_FileName, int iLine, const std::string& i_Message )
+{
+    m_Errors += i_FileName;
+    m_Errors += "(" + IntToString( iLine ) + "): error: ";
+    m_Errors += i_Message;
+    m_Errors += "\n";
+}
@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: ShaderPreprocessor.h
+//
+// A small, portable HLSL preprocessor. Supports #include (with #pragma once), object-like
+// and function-like macros (including # and ##), #undef, #if/#ifdef/#ifndef/#elif/#else/#endif
+// with defined() and full integer expression evaluation, and #error. #if expressions follow
+// C's rules for signed and unsigned values, and overflow or division by zero is an error
+// rather than a crash.
+//
+// The output is a canonical token stream: comments and whitespace are collapsed, and no
+// #line directives or path info are emitted, so the stream only changes when the code the
+// compiler will see changes. The ShaderCache hashes this stream in memory to decide whether
+// a shader needs recompiling, rather than running fxc /P and stripping the result.
+//
+// This file has no Windows or D3D dependencies.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_SHADER_PREPROCESSOR_H
+#define AMD_SDK_SHADER_PREPROCESSOR_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace AMD
+{
+    class ShaderPreprocessor
+    {
+    public:
+
+        ShaderPreprocessor();
+        ~ShaderPreprocessor();
+
+        // Adds a directory that is searched for #include files, after the directory of the including file
+        void AddIncludePath( const char* pszPath );
+
+        // Defines an object-like macro, equivalent to fxc's /D name=value
+        void Define( const char* pszName, const char* pszValue = "1" );
+
+        // Convenience overload matching the ShaderCache::Macro layout
+        void Define( const wchar_t* pwsName, int iValue );
+
+        // Removes a macro definition
+        void Undefine( const char* pszName );
+
+        // Clears macros, errors and dependencies (include paths are kept)
+        void Reset();
+
+        // Preprocesses a file from disk, writing the canonical token stream to o_Output
+        bool PreprocessFile( const char* pszFileName, std::string& o_Output );
+
+        // Preprocesses source from memory; pszFileName is used for relative includes and error messages
+        bool PreprocessSource( const char* pSource, size_t uLength, const char* pszFileName, std::string& o_Output );
+
+        // Errors from the last call, formatted as "file(line): error: message"
+        const std::string& GetErrors() const { return m_Errors; }
+
+        // Every file opened by the last call (the root file first), useful for dependency tracking
+        const std::vector<std::string>& GetDependencies() const { return m_Dependencies; }
+
+    private:
+
+        enum TOKEN_TYPE
+        {
+            TOKEN_IDENTIFIER,
+            TOKEN_NUMBER,
+            TOKEN_STRING,
+            TOKEN_PUNCTUATOR
+        };
+
+        struct Token
+        {
+            Token() : m_eType( TOKEN_PUNCTUATOR ), m_bSpaceBefore( false ) {}
+
+            std::string             m_Text;
+            TOKEN_TYPE              m_eType;
+            bool                    m_bSpaceBefore;
+            std::set<std::string>   m_HideSet;      // macros that must not be expanded again for this token
+        };
+
+        typedef std::vector<Token> TokenList;
+
+        struct MacroDef
+        {
+            MacroDef() : m_bFunctionLike( false ), m_bVariadic( false ) {}
+
+            bool                        m_bFunctionLike;
+            bool                        m_bVariadic;
+            std::vector<std::string>    m_Params;
+            TokenList                   m_Body;
+        };
+
+        struct CondState
+        {
+            bool m_bParentActive;   // was the enclosing block active
+            bool m_bActive;         // is the current branch active
+            bool m_bTaken;          // has any branch of this #if been taken
+            bool m_bSeenElse;
+        };
+
+        // Tokenization
+        static void SpliceAndStripComments( const char* pSource, size_t uLength, std::string& o_Text );
+        static void Tokenize( const std::string& i_Line, TokenList& o_Tokens );
+
+        // Processing
+        bool ProcessFile( const std::string& i_FileName, const std::string& i_Text, int iDepth );
+        bool ProcessDirective( const std::string& i_FileName, int iLine, const TokenList& i_Tokens,
+                               std::vector<CondState>& io_Conds, int iDepth );
+        bool HandleInclude( const std::string& i_FileName, int iLine, const TokenList& i_Tokens, int iDepth );
+        bool HandleDefine( const std::string& i_FileName, int iLine, const TokenList& i_Tokens );
+        bool EvaluateCondition( const std::string& i_FileName, int iLine, const TokenList& i_Tokens, bool& o_bResult );
+
+        // Macro expansion (hide set algorithm, after Prosser)
+        bool Expand( const TokenList& i_Tokens, TokenList& o_Tokens );
+        bool Substitute( const MacroDef& i_Macro, const std::vector<TokenList>& i_Args,
+                         const std::set<std::string>& i_HideSet, TokenList& o_Tokens );
+        int  FindParam( const MacroDef& i_Macro, const std::string& i_Name ) const;
+        static Token Stringize( const TokenList& i_Tokens );
+        static bool  Paste( const Token& i_Left, const Token& i_Right, Token& o_Token );
+
+        // Output
+        void EmitTokens( const TokenList& i_Tokens );
+        void EmitLine( const TokenList& i_Tokens );
+
+        // File helpers
+        static bool ReadFile( const std::string& i_FileName, std::string& o_Contents );
+        static std::string DirectoryOf( const std::string& i_FileName );
+        static std::string JoinPath( const std::string& i_Dir, const std::string& i_File );
+
+        void FlushPendingText();
+        void Error( const std::string& i_FileName, int iLine, const std::string& i_Message );
+
+        std::map<std::string, MacroDef>     m_Macros;
+        std::vector<std::string>            m_IncludePaths;
+        std::vector<std::string>            m_Dependencies;
+        std::set<std::string>               m_PragmaOnceFiles;
+        std::string                         m_Errors;
+        std::string*                        m_pOutput;
+        TokenList                           m_PendingText;  // text lines waiting for macro expansion
+        std::string                         m_CurrentFile;
+        int                                 m_iCurrentLine;
+        bool                                m_bAtLineStart;
+    };
+
+} // namespace AMD
+
+#endif
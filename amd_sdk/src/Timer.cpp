@@ -25,13 +25,125 @@
 
 //using namespace AMD;
 
-#if USE_RDTSC
-__declspec(naked) LONGLONG __cdecl rdtsc_time(void)
+//-----------------------------------------------------------------------------
+TimerStats::TimerStats() :
+m_EmaWeight( 0.1 )
+{
+    Reset();
+}
+
+void TimerStats::Reset()
+{
+    // keep the buckets allocated, so a timer that is reset every so often doesn't allocate again
+    std::fill( m_Buckets.begin(), m_Buckets.end(), 0 );
+    m_Count = 0;
+    m_Min = 0.0;
+    m_Max = 0.0;
+    m_Sum = 0.0;
+    m_Ema = 0.0;
+}
+
+void TimerStats::SetEmaWeight( double weight )
+{
+    m_EmaWeight = weight;
+}
+
+// values below 2^SubBucketBits ns get a bucket each, above that every power of two
+// is split into 2^SubBucketBits linear sub-buckets
+UINT TimerStats::BucketIndex( UINT64 ns )
+{
+    const UINT64 maxValue = (1ull << MaxValueBits) - 1;
+    if (ns > maxValue)
+    {
+        ns = maxValue;
+    }
+
+    if (ns < (1ull << SubBucketBits))
+    {
+        return (UINT)ns;
+    }
+
+    UINT msb = 0;
+    for (UINT step = 32; step > 0; step >>= 1)
+    {
+        if (ns >> (msb + step))
+        {
+            msb += step;
+        }
+    }
+
+    UINT shift = msb - SubBucketBits;
+    return (shift << SubBucketBits) + (UINT)(ns >> shift);
+}
+
+double TimerStats::BucketValue( UINT index )
+{
+    if (index < (2u << SubBucketBits))
+    {
+        return (double)index;
+    }
+
+    UINT shift = (index >> SubBucketBits) - 1;
+    UINT64 lower = (UINT64)(index - (shift << SubBucketBits)) << shift;
+    return (double)lower + (double)(1ull << shift) * 0.5;
+}
+
+void TimerStats::Add( double t )
+{
+    if (m_Buckets.empty())
+    {
+        m_Buckets.resize( NumBuckets, 0 );
+    }
+
+    double ns = t * 1.0e9;
+    ++m_Buckets[BucketIndex( (ns > 0.0) ? (UINT64)(ns + 0.5) : 0 )];
+
+    if (0 == m_Count)
+    {
+        m_Min = t;
+        m_Max = t;
+        m_Ema = t;
+    }
+    else
+    {
+        m_Min = std::min( m_Min, t );
+        m_Max = std::max( m_Max, t );
+        m_Ema += (t - m_Ema) * m_EmaWeight;
+    }
+
+    m_Sum += t;
+    ++m_Count;
+}
+
+double TimerStats::GetPercentile( double percentile ) const
 {
-    __asm rdtsc
-    __asm ret
+    if (0 == m_Count)
+    {
+        return 0.0;
+    }
+
+    // rank of the sample at the percentile, counting from 1
+    double rank = ceil( percentile * 0.01 * m_Count );
+    UINT64 target = (rank < 1.0) ? 1 : (UINT64)rank;
+    if (target > m_Count)
+    {
+        target = m_Count;
+    }
+
+    UINT64 count = 0;
+    for (UINT i = 0; i < NumBuckets; ++i)
+    {
+        count += m_Buckets[i];
+        if (count >= target)
+        {
+            // the exact extremes are known, so don't report a bucket midpoint outside of them
+            double t = BucketValue( i ) * 1.0e-9;
+            return std::min( std::max( t, m_Min ), m_Max );
+        }
+    }
+
+    return m_Max;
 }
-#endif
 
 //-----------------------------------------------------------------------------
 Timer::Timer() :
@@ -45,6 +157,26 @@ Timer::~Timer()
 {
 }
 
+const TimerStats& Timer::GetStats()
+{
+    FinishCollection();
+
+    return m_Stats;
+}
+
+void Timer::ResetStats()
+{
+    m_Stats.Reset();
+}
+
+void Timer::AddFrame( double t )
+{
+    m_LastTime = t;
+    m_SumTime += t;
+    ++m_NumFrames;
+    m_Stats.Add( t );
+}
+
 double Timer::GetTime()
 {
     FinishCollection();
@@ -64,22 +196,10 @@ double Timer::GetTimeNumFrames()
 //-----------------------------------------------------------------------------
 
 CpuTimer::CpuTimer() :
-Timer()
+Timer(),
+m_startTime( 0 ),
+m_bTimed( false )
 {
-    LARGE_INTEGER freq;
-    QueryPerformanceFrequency( &freq );
-    m_freq = static_cast<double>(freq.QuadPart);
-
-#if USE_RDTSC
-    const double calibrationTime = 0.1;
-
-    LONGLONG start, stop;
-    start = rdtsc_time();
-    Delay(calibrationTime);
-    stop = rdtsc_time();
-
-    m_freqRdtsc = static_cast<double>(stop - start) / calibrationTime;
-#endif
 }
 
 CpuTimer::~CpuTimer()
@@ -88,304 +208,257 @@ CpuTimer::~CpuTimer()
 
 void CpuTimer::Reset( bool bResetSum )
 {
-    m_LastTime = 0.0;
     if (bResetSum)
     {
         m_SumTime = 0.0;
         m_NumFrames = 0;
+        m_Stats.Reset();
     }
     else
     {
         ++m_NumFrames;
+
+        // frames in which the timer didn't run don't count towards the statistics
+        if (m_bTimed)
+        {
+            m_Stats.Add( m_LastTime );
+        }
     }
+
+    m_LastTime = 0.0;
+    m_bTimed = false;
 }
 
 void CpuTimer::Start()
 {
-#if USE_RDTSC
-    m_startTime.QuadPart = rdtsc_time();
-#else
-    QueryPerformanceCounter( &m_startTime );
-#endif
+    m_bTimed = true;
+    m_startTime = AMD::CpuClock::Now();
 }
 
 void CpuTimer::Stop()
 {
-    LARGE_INTEGER t;
-    double freq;
+    LONGLONG t = AMD::CpuClock::Now();
 
-#if USE_RDTSC
-    t.QuadPart = rdtsc_time();
-    freq = m_freqRdtsc;
-#else
-    QueryPerformanceCounter( &t );
-    freq = m_freq;
-#endif
+    double time = AMD::CpuClock::TicksToSeconds( ElapsedTicks( m_startTime, t ) );
+    m_LastTime += time;
+    m_SumTime += time;
+}
 
-    m_LastTime += static_cast<double>(t.QuadPart - m_startTime.QuadPart) / freq;
-    m_SumTime += static_cast<double>(t.QuadPart - m_startTime.QuadPart) / freq;
+// the time between two clock reads, without the cost of the reads themselves
+LONGLONG CpuTimer::ElapsedTicks( LONGLONG start, LONGLONG stop )
+{
+    LONGLONG ticks = stop - start - AMD::CpuClock::GetOverheadTicks();
+    return (ticks > 0) ? ticks : 0;
 }
 
-void CpuTimer::Delay( double sec )
+void CpuTimer::AddTime( double t )
 {
-    LARGE_INTEGER start, stop;
-    double t;
+    m_bTimed = true;
+    m_LastTime += t;
+    m_SumTime += t;
+}
 
-    QueryPerformanceCounter( &start );
+void CpuTimer::Delay( double sec )
+{
+    LONGLONG start = AMD::CpuClock::Now();
 
-    do
+    while (AMD::CpuClock::TicksToSeconds( AMD::CpuClock::Now() - start ) < sec)
     {
-        QueryPerformanceCounter( &stop );
-
-        t = static_cast<double>(stop.QuadPart - start.QuadPart) / m_freq;
-    } while (t < sec);
+    }
 }
 
 //-----------------------------------------------------------------------------
 
-GpuTimer::GpuTimer( ID3D11Device* pDev, UINT64 freq, UINT numTimeStamps ) :
-Timer(),
-m_pDevCtx( NULL ),
-m_numTimeStamps( numTimeStamps ),
-m_curIssueTs( m_numTimeStamps - 1 ),
-m_nextRetrTs( 0 ),
-m_FrameID( 0 ),
-
-m_CurTime( 0.0 )
+namespace
 {
-    HRESULT hr;
+    // the GpuTimer interval on D3D11: a disjoint query around two timestamp queries
+    class D3D11GpuTimestamps : public AMD::GpuTimestampBackend
+    {
+    public:
+        D3D11GpuTimestamps( ID3D11Device* pDev ) :
+        m_pDev( pDev ),
+        m_pDevCtx( NULL )
+        {
+            m_pDev->AddRef();
+            m_pDev->GetImmediateContext( &m_pDevCtx );
+            _ASSERT( m_pDevCtx != NULL );
+        }
 
-    _ASSERT( pDev != NULL );
-    _ASSERT( numTimeStamps>0 );
+        virtual ~D3D11GpuTimestamps()
+        {
+            SAFE_RELEASE( m_pDevCtx );
+            SAFE_RELEASE( m_pDev );
+        }
 
-    pDev->GetImmediateContext( &m_pDevCtx );
-    _ASSERT( m_pDevCtx != NULL );
+        virtual Interval* CreateInterval()
+        {
+            D3D11_QUERY_DESC qd;
+            qd.MiscFlags = 0;
 
-    D3D11_QUERY_DESC qd;
-    qd.MiscFlags = 0;
+            D3D11Interval* pInterval = new D3D11Interval();
 
-    m_ts = new TsRecord[m_numTimeStamps];
-    for (UINT i = 0; i < m_numTimeStamps; i++)
-    {
-        qd.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+            qd.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+            HRESULT hr = m_pDev->CreateQuery( &qd, &pInterval->pDisjointTS );
 
-        hr = pDev->CreateQuery( &qd, &m_ts[i].pDisjointTS );
-        _ASSERT( (hr == S_OK) && (m_ts[i].pDisjointTS != NULL) );
+            qd.Query = D3D11_QUERY_TIMESTAMP;
+            if (SUCCEEDED( hr )) { hr = m_pDev->CreateQuery( &qd, &pInterval->pStart ); }
+            if (SUCCEEDED( hr )) { hr = m_pDev->CreateQuery( &qd, &pInterval->pStop ); }
+
+            if (FAILED( hr ))
+            {
+                delete pInterval;
+                return NULL;
+            }
+            return pInterval;
+        }
 
-        qd.Query = D3D11_QUERY_TIMESTAMP;
+        virtual void DestroyInterval( Interval* pInterval )
+        {
+            delete pInterval;
+        }
 
-        hr = pDev->CreateQuery( &qd, &m_ts[i].pStart );
-        _ASSERT( (hr == S_OK) && (m_ts[i].pStart != NULL) );
+        virtual void Begin( Interval* pInterval )
+        {
+            D3D11Interval* pD3D = static_cast<D3D11Interval*>( pInterval );
+            m_pDevCtx->Begin( pD3D->pDisjointTS );
+            m_pDevCtx->End( pD3D->pStart );
+        }
 
-        hr = pDev->CreateQuery( &qd, &m_ts[i].pStop );
-        _ASSERT( (hr == S_OK) && (m_ts[i].pStop != NULL) );
+        virtual void End( Interval* pInterval )
+        {
+            D3D11Interval* pD3D = static_cast<D3D11Interval*>( pInterval );
+            m_pDevCtx->End( pD3D->pStop );
+            m_pDevCtx->End( pD3D->pDisjointTS );
+        }
 
-        m_ts[i].state.stateWord = 0;
-    }
-    m_CurTimeFrame.id = 0;
-    m_CurTimeFrame.invalid = 1;
+        virtual bool GetData( Interval* pInterval, bool bWait, IntervalData& data )
+        {
+            D3D11Interval* pD3D = static_cast<D3D11Interval*>( pInterval );
+
+            D3D11_QUERY_DATA_TIMESTAMP_DISJOINT tsd;
+            if (!GetQueryData( pD3D->pDisjointTS, &tsd, sizeof( tsd ), bWait ) ||
+                !GetQueryData( pD3D->pStart, &data.m_ullStart, sizeof( UINT64 ), bWait ) ||
+                !GetQueryData( pD3D->pStop, &data.m_ullStop, sizeof( UINT64 ), bWait ))
+            {
+                return false;
+            }
+
+            data.m_ullFrequency = tsd.Frequency;
+            data.m_bDisjoint = (FALSE != tsd.Disjoint);
+            return true;
+        }
+
+    private:
+        class D3D11Interval : public Interval
+        {
+        public:
+            D3D11Interval() : pStart( NULL ), pStop( NULL ), pDisjointTS( NULL ) {}
+            virtual ~D3D11Interval()
+            {
+                SAFE_RELEASE( pDisjointTS );
+                SAFE_RELEASE( pStart );
+                SAFE_RELEASE( pStop );
+            }
+
+            ID3D11Query* pStart;
+            ID3D11Query* pStop;
+            ID3D11Query* pDisjointTS;
+        };
+
+        // if we want to retrieve the timing data NOW the CPU will stall
+        bool GetQueryData( ID3D11Query* pQuery, void* pData, UINT size, bool bWait )
+        {
+            HRESULT hr;
+            do
+            {
+                hr = m_pDevCtx->GetData( pQuery, pData, size, 0 );
+            } while (bWait && hr == S_FALSE);
+
+            _ASSERT( SUCCEEDED( hr ) );
+            return (S_OK == hr);
+        }
+
+        ID3D11Device*           m_pDev;
+        ID3D11DeviceContext*    m_pDevCtx;
+    };
+}
+
+GpuTimer::GpuTimer( ID3D11Device* pDev, UINT64 freq, UINT numTimeStamps ) :
+Timer(),
+m_pBackend( NULL ),
+m_bOwnsBackend( true ),
+m_pRing( NULL )
+{
+    _ASSERT( pDev != NULL );
+
+    m_pBackend = new D3D11GpuTimestamps( pDev );
+    m_pRing = new AMD::GpuTimestampRing( m_pBackend, numTimeStamps );
+    m_pRing->SetFrameCallback( &GpuTimer::OnFrame, this );
 
     freq = 0;//prevent warning
 }
 
+GpuTimer::GpuTimer( AMD::GpuTimestampBackend* pBackend, UINT numTimeStamps ) :
+Timer(),
+m_pBackend( pBackend ),
+m_bOwnsBackend( false ),
+m_pRing( NULL )
+{
+    _ASSERT( pBackend != NULL );
+
+    m_pRing = new AMD::GpuTimestampRing( m_pBackend, numTimeStamps );
+    m_pRing->SetFrameCallback( &GpuTimer::OnFrame, this );
+}
+
 GpuTimer::~GpuTimer()
 {
-    for (UINT i = 0; i < m_numTimeStamps; i++)
+    // the ring returns its intervals to the backend, so goes first
+    SAFE_DELETE( m_pRing );
+
+    if (m_bOwnsBackend)
     {
-        SAFE_RELEASE( m_ts[i].pDisjointTS );
-        SAFE_RELEASE( m_ts[i].pStart );
-        SAFE_RELEASE( m_ts[i].pStop );
+        SAFE_DELETE( m_pBackend );
     }
-    SAFE_DELETE_ARRAY( m_ts );
+}
 
-    SAFE_RELEASE( m_pDevCtx );
+void GpuTimer::OnFrame( void* pUserData, double seconds )
+{
+    static_cast<GpuTimer*>( pUserData )->AddFrame( seconds );
 }
 
 void GpuTimer::Reset( bool bResetSum )
 {
-    FinishCollection();
-    m_FrameID = (m_FrameID + 1) & 0x3FFFFFFF;
+    m_pRing->EndFrame();
 
     if (bResetSum)
     {
-        WaitIdle();
-        m_CurTimeFrame.invalid = 1;
-        m_CurTime = 0.0;
+        m_pRing->WaitIdle();
+        m_pRing->DiscardFrame();
         m_LastTime = 0.0;
         m_SumTime = 0.0;
         m_NumFrames = 0;
+        m_Stats.Reset();
     }
 }
 
 void GpuTimer::Start()
 {
-    if (++m_curIssueTs == m_numTimeStamps)
-    {
-        m_curIssueTs = 0;
-    }
-
-    if (0 != m_ts[m_curIssueTs].state.data.startIssued)
-    {
-        _ASSERT( false && "CPU stall required! This should never happen. Please increase GpuTimer::NumTimeStamps in Timer.h" );
-        CollectData( m_curIssueTs, TRUE );
-    }
-
-    m_ts[m_curIssueTs].state.data.frameID = m_FrameID;
-    m_ts[m_curIssueTs].state.data.startIssued = 1;
-    m_ts[m_curIssueTs].state.data.stopIssued = 0;
-    m_pDevCtx->Begin( m_ts[m_curIssueTs].pDisjointTS );
-    m_pDevCtx->End( m_ts[m_curIssueTs].pStart );
+    m_pRing->Start();
 }
 
 void GpuTimer::Stop()
 {
-    // check if timestamp start has been issued but no stop yet
-    _ASSERT( (m_ts[m_curIssueTs].state.data.startIssued == 1) && (m_ts[m_curIssueTs].state.data.stopIssued == 0) );
-
-    m_ts[m_curIssueTs].state.data.stopIssued = 1;
-    m_pDevCtx->End( m_ts[m_curIssueTs].pStop );
-    m_pDevCtx->End( m_ts[m_curIssueTs].pDisjointTS );
+    m_pRing->Stop();
 }
 
 void GpuTimer::WaitIdle()
 {
-    while (m_nextRetrTs != m_curIssueTs)
-    {
-        CollectData( m_nextRetrTs, true );
-
-        if (++m_nextRetrTs == m_numTimeStamps)
-        {
-            m_nextRetrTs = 0;
-        }
-    }
-
-    // retrieve the current Ts
-    CollectData( m_nextRetrTs, true );
-    if (++m_nextRetrTs == m_numTimeStamps)
-    {
-        m_nextRetrTs = 0;
-    }
-
-    if (0 == m_CurTimeFrame.invalid)
-    {
-        m_LastTime = m_CurTime;
-        m_SumTime += m_CurTime;
-        ++m_NumFrames;
-    }
+    m_pRing->WaitIdle();
 }
 
 void GpuTimer::FinishCollection()
 {
-    // retrieve all available timestamps
-    while (CollectData( m_nextRetrTs ))
-    {
-        if (++m_nextRetrTs == m_numTimeStamps)
-        {
-            m_nextRetrTs = 0;
-        }
-    }
-}
-
-bool GpuTimer::CollectData( UINT idx, BOOL stall )
-{
-    if (!m_ts[idx].state.data.stopIssued)
-    {
-        return false;
-    }
-
-    // start collecting data from a new frame?
-    if (m_ts[idx].state.data.frameID != m_CurTimeFrame.id)
-    {
-        // if frametimes collected are valid: write them into m_time
-        // so m_time always contains the most recent valid timing data
-        if (0 == m_CurTimeFrame.invalid)
-        {
-            m_LastTime = m_CurTime;
-            m_SumTime += m_CurTime;
-            ++m_NumFrames;
-        }
-
-        // start collecting time data of the next frame
-        m_CurTime = 0.0;
-        m_CurTimeFrame.id = m_ts[idx].state.data.frameID;
-        m_CurTimeFrame.invalid = 0;
-    }
-
-    // if we want to retrieve the next timing data NOW the CPU will stall
-    // increase NumTimeStamps in Timer.h to prevent this from happening
-    if (stall)
-    {
-        HRESULT hr;
-        UINT64 start, stop;
-
-        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT tsd;
-        do
-        {
-            hr = m_pDevCtx->GetData( m_ts[idx].pDisjointTS, &tsd, sizeof( D3D11_QUERY_DATA_TIMESTAMP_DISJOINT ), 0 );
-        } while (hr == S_FALSE);
-
-        _ASSERT( hr == S_OK );
-
-        do
-        {
-            hr = m_pDevCtx->GetData( m_ts[idx].pStart, &start, sizeof( UINT64 ), 0 );
-        } while (hr == S_FALSE);
-
-        _ASSERT( hr == S_OK );
-
-        do
-        {
-            hr = m_pDevCtx->GetData( m_ts[idx].pStop, &stop, sizeof( UINT64 ), 0 );
-        } while (hr == S_FALSE);
-
-        _ASSERT( hr == S_OK );
-
-        if (tsd.Disjoint || ((start & 0xFFFFFFFF) == 0xFFFFFFFF) || ((stop & 0xFFFFFFFF) == 0xFFFFFFFF))
-        {
-            // mark current frametime as invalid
-            m_CurTimeFrame.invalid = 1;
-        }
-        else
-        {
-            m_CurTime += static_cast<double>(stop - start) / static_cast<double>(tsd.Frequency);
-        }
-
-        m_ts[idx].state.stateWord = 0;
-        return true;
-    }
-
-    // finally try collecting the available data, return false if it was not yet available
-    UINT64 start, stop;
-
-    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT tsd;
-    if (S_FALSE == m_pDevCtx->GetData( m_ts[idx].pDisjointTS, &tsd, sizeof( D3D11_QUERY_DATA_TIMESTAMP_DISJOINT ), 0 ))
-    {
-        return false;
-    }
-    if (S_FALSE == m_pDevCtx->GetData( m_ts[idx].pStart, &start, sizeof( UINT64 ), 0 ))
-    {
-        return false;
-    }
-
-    if (S_FALSE == m_pDevCtx->GetData( m_ts[idx].pStop, &stop, sizeof( UINT64 ), 0 ))
-    {
-        return false;
-    }
-
-    // all data was available, so evaluate times
-    if (tsd.Disjoint || ((start & 0xFFFFFFFF) == 0xFFFFFFFF) || ((stop & 0xFFFFFFFF) == 0xFFFFFFFF))
-    {
-        // mark current frametime as invalid
-        m_CurTimeFrame.invalid = 1;
-    }
-    else
-    {
-        UINT64 dt = (stop - start);
-        m_CurTime += static_cast<double>(dt) / static_cast<double>(tsd.Frequency);
-    }
-
-    m_ts[idx].state.stateWord = 0;
-    return true;
+    m_pRing->FinishCollection();
 }
 
 //-----------------------------------------------------------------------------
@@ -445,56 +518,132 @@ void GpuCpuTimer::WaitIdle()
 // convenience timer functions
 //-----------------------------------------------------------------------------
 
-TimingEvent::TimingEvent() :
-m_name( NULL ),
-m_nameLen( 0 ),
-m_used( false ),
-m_parent( NULL ),
-m_firstChild( NULL ),
-m_next( NULL )
+TimerChildTable::TimerChildTable() :
+m_slots( NULL ),
+m_mask( 0 ),
+m_count( 0 )
 {
-    m_gpu = (NULL != TimerEx::Instance().GetDevice()) ? new GpuTimer( TimerEx::Instance().GetDevice(), 0, 16 ) : NULL;
 }
 
-TimingEvent::~TimingEvent()
+TimerChildTable::~TimerChildTable()
 {
-    SAFE_DELETE( m_gpu );
-    SAFE_DELETE_ARRAY( m_name );
+    SAFE_DELETE_ARRAY( m_slots );
 }
 
-void TimingEvent::SetName( LPCWSTR name )
+TimingEvent* TimerChildTable::Find( UINT nameId ) const
 {
-    size_t len_req = wcslen( name ) + 1;
-    if (len_req > m_nameLen)
+    if (NULL == m_slots)
     {
-        SAFE_DELETE_ARRAY( m_name );
-        int len_alloc = 32 + (len_req & 0xFFFFFFE0);  // round up to next multiple of 32 so when reused we don't have to realloc too often
-        m_name = new WCHAR[len_alloc];
-        m_nameLen = len_alloc;
+        return NULL;
+    }
+
+    // linear probing; the table is never more than half full, so this terminates quickly
+    for (UINT i = (nameId * 2654435761u) & m_mask; ; i = (i + 1) & m_mask)
+    {
+        TimingEvent* te = m_slots[i];
+        if (NULL == te || te->m_nameId == nameId)
+        {
+            return te;
+        }
     }
-    wcscpy_s( m_name, m_nameLen, name );
 }
 
-LPCWSTR TimingEvent::GetName()
+void TimerChildTable::Insert( TimingEvent* te )
 {
-    return m_name;
+    if ((m_count + 1) * 2 > m_mask + 1 || NULL == m_slots)
+    {
+        // grow, and reinsert the existing children
+        UINT oldSize = (NULL == m_slots) ? 0 : m_mask + 1;
+        UINT newSize = (0 == oldSize) ? 8 : oldSize * 2;
+        TimingEvent** oldSlots = m_slots;
+
+        m_slots = new TimingEvent*[newSize];
+        memset( m_slots, 0, newSize * sizeof( TimingEvent* ) );
+        m_mask = newSize - 1;
+        m_count = 0;
+
+        for (UINT i = 0; i < oldSize; ++i)
+        {
+            if (NULL != oldSlots[i])
+            {
+                Insert( oldSlots[i] );
+            }
+        }
+        SAFE_DELETE_ARRAY( oldSlots );
+    }
+
+    UINT i = (te->m_nameId * 2654435761u) & m_mask;
+    while (NULL != m_slots[i] && m_slots[i] != te)
+    {
+        i = (i + 1) & m_mask;
+    }
+
+    if (NULL == m_slots[i])
+    {
+        m_slots[i] = te;
+        ++m_count;
+    }
 }
 
-void TimingEvent::Start()
+void TimerChildTable::Clear()
 {
-    m_used = true;
-    if (NULL != m_gpu) { m_gpu->Start(); }
-    m_cpu.Start();
+    // keep the allocation, so rebuilding the table doesn't allocate
+    if (NULL != m_slots)
+    {
+        memset( m_slots, 0, (m_mask + 1) * sizeof( TimingEvent* ) );
+    }
+    m_count = 0;
 }
 
-void TimingEvent::Stop()
+void TimerChildTable::Swap( TimerChildTable& other )
 {
-    m_cpu.Stop();
-    if (NULL != m_gpu) { m_gpu->Stop(); }
-    m_used = true;
+    std::swap( m_slots, other.m_slots );
+    std::swap( m_mask, other.m_mask );
+    std::swap( m_count, other.m_count );
 }
 
-double TimingEvent::GetTime( TimerType type, bool stall )
+//-----------------------------------------------------------------------------
+
+TimingEvent::TimingEvent( ID3D11Device* pDev ) :
+m_nameId( TimerEx::InvalidNameId ),
+m_used( false ),
+m_parent( NULL ),
+m_firstChild( NULL ),
+m_next( NULL )
+{
+    m_gpu = (NULL != pDev) ? new GpuTimer( pDev, 0, 16 ) : NULL;
+
+    if (NULL != m_gpu)
+    {
+        m_gpu->SetTimestampCallback( &AMD::TimerCapture::OnGpuTimestamps, &TimerEx::Instance().GetCapture() );
+    }
+}
+
+TimingEvent::~TimingEvent()
+{
+    SAFE_DELETE( m_gpu );
+}
+
+LPCWSTR TimingEvent::GetName()
+{
+    return TimerEx::Instance().GetNameString( m_nameId );
+}
+
+void TimingEvent::Start()
+{
+    m_used = true;
+    if (NULL != m_gpu) { m_gpu->Start(); }
+    m_cpu.Start();
+}
+
+void TimingEvent::Stop()
+{
+    m_cpu.Stop();
+    if (NULL != m_gpu) { m_gpu->Stop(); }
+    m_used = true;
+}
+
+double TimingEvent::GetTime( TimerType type, bool stall )
 {
     switch (type)
     {
@@ -536,44 +685,22 @@ double TimingEvent::GetAvgTime( TimerType type, bool stall )
     }
 }
 
-TimingEvent* TimingEvent::GetTimer( LPCWSTR timerId )
+const TimerStats* TimingEvent::GetStats( TimerType type )
 {
-    size_t len = wcslen( timerId );
-    size_t seperator = wcscspn( timerId, L"/|\\" );
-
-    if (seperator < len)
-    {
-        LPWSTR idCopy = new WCHAR[len + 1];
-        wcscpy_s( idCopy, len + 1, timerId );
-        idCopy[seperator] = 0;
-
-        TimingEvent* te = m_firstChild;
-        while (te)
-        {
-            if (!wcscmp( idCopy, te->m_name ))
-            {
-                te = te->GetTimerRec( &idCopy[seperator + 1] );
-                delete [] idCopy;
-                return te;
-            }
-            te = te->m_next;
-        }
-
-        delete [] idCopy;
-    }
-    else
+    switch (type)
     {
-        TimingEvent* te = m_firstChild;
-        while (te)
-        {
-            if (!wcscmp( timerId, te->m_name ))
-            {
-                return te;
-            }
-            te = te->m_next;
-        }
+    case ttCpu:
+        return &m_cpu.GetStats();
+    case ttGpu:
+        return (NULL != m_gpu) ? &m_gpu->GetStats() : NULL;
+    default:
+        return NULL;
     }
-    return NULL;
+}
+
+TimingEvent* TimingEvent::GetTimer( LPCWSTR timerId )
+{
+    return FindTimer( m_children, timerId );
 }
 
 TimingEvent* TimingEvent::GetParent()
@@ -591,32 +718,26 @@ TimingEvent* TimingEvent::GetNextTimer()
     return m_next;
 }
 
-// when this function is called we know we're working on a copy of the name, so we can "destruct" it
-TimingEvent* TimingEvent::GetTimerRec( LPWSTR timerId )
+// walks a path of names, one table lookup per path element, without copying the path
+TimingEvent* TimingEvent::FindTimer( const TimerChildTable& children, LPCWSTR timerId )
 {
-    size_t len = wcslen( timerId );
-    size_t seperator = wcscspn( timerId, L"/|\\" );
-    if (seperator < len)
-    {
-        timerId[seperator] = 0;
-    }
+    const TimerChildTable* table = &children;
 
-    TimingEvent* te = m_firstChild;
-    while (te)
+    for (;;)
     {
-        if (!wcscmp( timerId, te->m_name ))
-        {
-            if (seperator < len)
-            {
-                te = te->GetTimerRec( &timerId[seperator + 1] );
-            }
+        size_t seperator = wcscspn( timerId, L"/|\\" );
+
+        UINT nameId = TimerEx::Instance().FindName( timerId, seperator );
+        TimingEvent* te = (TimerEx::InvalidNameId != nameId) ? table->Find( nameId ) : NULL;
 
+        if (NULL == te || 0 == timerId[seperator])
+        {
             return te;
         }
-        te = te->m_next;
-    }
 
-    return NULL;
+        table = &te->m_children;
+        timerId += seperator + 1;
+    }
 }
 
 TimingEvent* TimingEvent::FindLastChildUsed()
@@ -635,18 +756,120 @@ TimingEvent* TimingEvent::FindLastChildUsed()
 }
 //-----------------------------------------------------------------------------
 
+// Timing events of one worker thread. The thread appends begin/end events to a ring buffer, and
+// TimerEx::Reset consumes them on the main thread. There is one writer and one reader, so publishing
+// the write and read positions with interlocked exchanges is enough; no locks are taken.
+struct TimerLane
+{
+    static const UINT NumEvents = 8192;     // power of two
+
+    struct Event
+    {
+        UINT        nameId;                 // InvalidNameId for an end event
+        LONGLONG    ticks;
+    };
+
+    TimerLane( DWORD threadId ) :
+    m_threadId( threadId ),
+    m_write( 0 ),
+    m_read( 0 ),
+    m_dropped( 0 ),
+    m_openDepth( 0 ),
+    m_skipDepth( 0 )
+    {
+        m_name[0] = 0;
+        m_startTicks.reserve( 32 );
+    }
+
+    // writer side, only called by the owning thread
+    void Push( UINT nameId )
+    {
+        // a begin needs room for itself and the ends of all open timers, so ends are never dropped;
+        // if a begin is dropped, everything until its end is dropped too, to keep the nesting intact
+        if (InvalidNameId != nameId)
+        {
+            if (0 != m_skipDepth || (ULONG)m_write - (ULONG)m_read + m_openDepth + 2 > NumEvents)
+            {
+                ++m_skipDepth;
+                InterlockedIncrement( &m_dropped );
+                return;
+            }
+            ++m_openDepth;
+        }
+        else
+        {
+            if (0 != m_skipDepth)
+            {
+                --m_skipDepth;
+                return;
+            }
+            _ASSERT( "Start(...) not called before Stop()" && (m_openDepth > 0) );
+            if (0 == m_openDepth)
+            {
+                return;
+            }
+            --m_openDepth;
+        }
+
+        LONGLONG t = AMD::CpuClock::Now();
+
+        Event& e = m_events[(ULONG)m_write & (NumEvents - 1)];
+        e.nameId = nameId;
+        e.ticks = t;
+        InterlockedExchange( &m_write, m_write + 1 );
+    }
+
+    static const UINT InvalidNameId = TimerEx::InvalidNameId;
+
+    DWORD               m_threadId;
+    WCHAR               m_name[64];
+
+    Event               m_events[NumEvents];
+    volatile LONG       m_write;
+    volatile LONG       m_read;
+    volatile LONG       m_dropped;
+    UINT                m_openDepth;    // writer only
+    UINT                m_skipDepth;    // writer only
+
+    // reader side, only used by TimerEx on the main thread
+    TimerTree               m_tree;
+    std::vector<LONGLONG>   m_startTicks;
+};
+
+//-----------------------------------------------------------------------------
+
 TimerEx::TimerEx() :
 m_pDev( NULL ),
-m_Current( NULL ),
-m_Unused( NULL )
+m_pTree( &m_MainTree ),
+m_bCpuOnly( false ),
+m_MainThreadId( 0 )
 {
+    m_TlsIndex = TlsAlloc();
+
+    InitializeCriticalSection( &m_LanesLock );
+    InitializeSRWLock( &m_NamesLock );
 };
 
 TimerEx::~TimerEx()
 {
-    _ASSERT( "Stop() not called for every Start(...)" && (m_Current == NULL) );
+    _ASSERT( "Stop() not called for every Start(...)" && (m_MainTree.m_Current == NULL) );
 
     Destroy();
+
+    for (size_t i = 0; i < m_Lanes.size(); ++i)
+    {
+        DeleteTree( m_Lanes[i]->m_tree );
+        delete m_Lanes[i];
+    }
+    m_Lanes.clear();
+
+    for (size_t i = 0; i < m_Names.size(); ++i)
+    {
+        SAFE_DELETE_ARRAY( m_Names[i] );
+    }
+
+    DeleteCriticalSection( &m_LanesLock );
+    TlsFree( m_TlsIndex );
 }
 
 void TimerEx::DeleteTimerTree( TimingEvent* te )
@@ -662,37 +885,60 @@ void TimerEx::DeleteTimerTree( TimingEvent* te )
     }
 }
 
-void TimerEx::Init( ID3D11Device* pDev )
-{
-    m_pDev = pDev;
-}
-
-void TimerEx::Destroy()
+void TimerEx::DeleteTree( TimerTree& tree )
 {
     // delete all unused
-    TimingEvent* te = m_Unused;
+    TimingEvent* te = tree.m_Unused;
     while (NULL != te)
     {
         TimingEvent* tmp = te;
         te = te->m_next;
         delete tmp;
     }
-    m_Unused = NULL;
+    tree.m_Unused = NULL;
 
     // delete all used
-    DeleteTimerTree( m_Root );
-    m_Root = NULL;
+    DeleteTimerTree( tree.m_Root );
+    tree.m_Root = NULL;
+    tree.m_Current = NULL;
+    tree.m_RootChildren.Clear();
+}
+
+void TimerEx::Init( ID3D11Device* pDev )
+{
+    m_pDev = pDev;
+    m_MainThreadId = GetCurrentThreadId();
+}
+
+void TimerEx::Destroy()
+{
+    // the lanes have no GPU timers, so they can outlive the device
+    DeleteTree( m_MainTree );
 
     m_pDev = NULL;
 }
 
-void TimerEx::Reset( TimingEvent* te, bool bResetSum )
+void TimerEx::RebuildChildTable( TimerTree& tree, TimingEvent* parent )
+{
+    TimerChildTable& table = (NULL == parent) ? tree.m_RootChildren : parent->m_children;
+    table.Clear();
+
+    for (TimingEvent* te = (NULL == parent) ? tree.m_Root : parent->m_firstChild; NULL != te; te = te->m_next)
+    {
+        table.Insert( te );
+    }
+}
+
+void TimerEx::Reset( TimerTree& tree, TimingEvent* te, bool bResetSum )
 {
     TimingEvent* prev = NULL;
+    TimingEvent* parent = (NULL != te) ? te->m_parent : NULL;
+    bool removed = false;
+
     while (NULL != te)
     {
         // recursion
-        Reset( te->m_firstChild, bResetSum );
+        Reset( tree, te->m_firstChild, bResetSum );
 
         // reset the timer event
         te->m_cpu.Reset( bResetSum );
@@ -719,7 +965,7 @@ void TimerEx::Reset( TimingEvent* te, bool bResetSum )
                 {
                     if (NULL == tmp->m_parent)
                     {
-                        m_Root = tmp->m_next;
+                        tree.m_Root = tmp->m_next;
                     }
                     else
                     {
@@ -732,51 +978,251 @@ void TimerEx::Reset( TimingEvent* te, bool bResetSum )
                 }
 
                 tmp->m_parent = NULL;
-                tmp->m_next = m_Unused;
-                m_Unused = tmp;
+                tmp->m_next = tree.m_Unused;
+                tree.m_Unused = tmp;
+                removed = true;
             }
         }
     }
+
+    // open addressing doesn't support removal directly, so rebuild the lookup table of this level
+    if (removed)
+    {
+        RebuildChildTable( tree, parent );
+    }
 }
 
 void TimerEx::Reset( bool bResetSum )
 {
     _ASSERT( "init not called or called with NULL" && (m_pDev != NULL) );
-    _ASSERT( "Stop() not called for every Start(...)" && (m_Current == NULL) );
+    _ASSERT( "Stop() not called for every Start(...)" && (m_pTree->m_Current == NULL) );
+    _ASSERT( "Reset() called from a worker thread" && (GetCurrentThreadId() == m_MainThreadId) );
+
+    if (NULL != m_pTree->m_Root)
+    {
+        Reset( *m_pTree, m_pTree->m_Root, bResetSum );
+    }
+
+    // merge what the worker threads recorded since the last reset
+    EnterCriticalSection( &m_LanesLock );
+    for (size_t i = 0; i < m_Lanes.size(); ++i)
+    {
+        MergeLane( m_Lanes[i], (UINT)i, bResetSum );
+    }
+    LeaveCriticalSection( &m_LanesLock );
+
+    // the frame being captured ends here, including the lane events just merged
+    if (m_Capture.IsEnabled())
+    {
+        m_Capture.EndFrame( AMD::CpuClock::Now() );
+    }
+}
+
+void TimerEx::MergeLane( TimerLane* lane, UINT laneIndex, bool bResetSum )
+{
+    TimerTree& tree = lane->m_tree;
+
+    // timers still running on the worker thread count as used, so they are not removed
+    for (TimingEvent* te = tree.m_Current; NULL != te; te = te->m_parent)
+    {
+        te->m_used = true;
+    }
+
+    if (NULL != tree.m_Root)
+    {
+        Reset( tree, tree.m_Root, bResetSum );
+    }
+
+    // replay the events, as if Start and Stop had been called on this thread
+    ULONG end = (ULONG)lane->m_write;
+    MemoryBarrier();
+
+    for (ULONG i = (ULONG)lane->m_read; i != end; ++i)
+    {
+        const TimerLane::Event& e = lane->m_events[i & (TimerLane::NumEvents - 1)];
+
+        if (InvalidNameId != e.nameId)
+        {
+            TimingEvent* te = Begin( tree, e.nameId, NULL );
+            te->m_used = true;
+            lane->m_startTicks.push_back( e.ticks );
+        }
+        else if (NULL != tree.m_Current && !lane->m_startTicks.empty())
+        {
+            TimingEvent* te = tree.m_Current;
+            te->m_cpu.AddTime( AMD::CpuClock::TicksToSeconds( CpuTimer::ElapsedTicks( lane->m_startTicks.back(), e.ticks ) ) );
+            m_Capture.AddLaneEvent( laneIndex + 1, te->m_nameId, (UINT)lane->m_startTicks.size() - 1, lane->m_startTicks.back(), e.ticks );
+            te->m_used = true;
+            lane->m_startTicks.pop_back();
+            tree.m_Current = te->m_parent;
+        }
+    }
+
+    InterlockedExchange( &lane->m_read, (LONG)end );
+}
+
+TimerLane* TimerEx::GetThreadLane()
+{
+    TimerLane* lane = (TimerLane*)TlsGetValue( m_TlsIndex );
+    if (NULL == lane)
+    {
+        // first timer on this thread: register a lane for it
+        lane = new TimerLane( GetCurrentThreadId() );
+        swprintf_s( lane->m_name, L"Thread %u", (unsigned int)lane->m_threadId );
+
+        EnterCriticalSection( &m_LanesLock );
+        m_Lanes.push_back( lane );
+        LeaveCriticalSection( &m_LanesLock );
+
+        TlsSetValue( m_TlsIndex, lane );
+    }
+    return lane;
+}
+
+void TimerEx::SetThreadName( LPCWSTR name )
+{
+    if (GetCurrentThreadId() != m_MainThreadId)
+    {
+        TimerLane* lane = GetThreadLane();
+
+        EnterCriticalSection( &m_LanesLock );
+        wcsncpy_s( lane->m_name, name, _TRUNCATE );
+        LeaveCriticalSection( &m_LanesLock );
+    }
+}
+
+UINT TimerEx::GetNumLanes()
+{
+    EnterCriticalSection( &m_LanesLock );
+    UINT numLanes = (UINT)m_Lanes.size();
+    LeaveCriticalSection( &m_LanesLock );
+
+    return numLanes;
+}
+
+// lanes are never removed, but m_Lanes may grow while a new thread registers
+TimerLane* TimerEx::GetLane( UINT lane )
+{
+    EnterCriticalSection( &m_LanesLock );
+    TimerLane* pLane = (lane < m_Lanes.size()) ? m_Lanes[lane] : NULL;
+    LeaveCriticalSection( &m_LanesLock );
+
+    return pLane;
+}
+
+LPCWSTR TimerEx::GetLaneName( UINT lane )
+{
+    TimerLane* pLane = GetLane( lane );
+    return (NULL != pLane) ? pLane->m_name : NULL;
+}
+
+DWORD TimerEx::GetLaneThreadId( UINT lane )
+{
+    TimerLane* pLane = GetLane( lane );
+    return (NULL != pLane) ? pLane->m_threadId : 0;
+}
+
+// the lane trees are only changed by Reset, so like the main tree they should be read on the main thread
+TimingEvent* TimerEx::GetLaneTimer( UINT lane, LPCWSTR timerId )
+{
+    TimerLane* pLane = GetLane( lane );
+    if (NULL == pLane)
+    {
+        return NULL;
+    }
+
+    TimerTree& tree = pLane->m_tree;
+    return (NULL == timerId) ? tree.m_Root : TimingEvent::FindTimer( tree.m_RootChildren, timerId );
+}
+
+double TimerEx::GetTotalCpuTime( LPCWSTR timerId )
+{
+    TimingEvent* te = GetTimer( timerId );
+    double t = (NULL != te) ? te->GetTime( ttCpu ) : 0.0;
+
+    UINT numLanes = GetNumLanes();
+    for (UINT i = 0; i < numLanes; ++i)
+    {
+        te = GetLaneTimer( i, timerId );
+        t += (NULL != te) ? te->GetTime( ttCpu ) : 0.0;
+    }
+
+    return t;
+}
+
+UINT TimerEx::GetNumDroppedEvents()
+{
+    UINT dropped = 0;
 
-    if (NULL != m_Root)
+    EnterCriticalSection( &m_LanesLock );
+    for (size_t i = 0; i < m_Lanes.size(); ++i)
     {
-        Reset( m_Root, bResetSum );
+        dropped += (UINT)m_Lanes[i]->m_dropped;
     }
+    LeaveCriticalSection( &m_LanesLock );
+
+    return dropped;
 }
 
 void TimerEx::Start( LPCWSTR timerId )
+{
+    Start( InternName( timerId ) );
+}
+
+void TimerEx::Start( UINT nameId )
 {
     _ASSERT( "init not called or called with NULL" && (m_pDev != NULL) );
+    _ASSERT( "name not interned" && (nameId != InvalidNameId) );
+
+    if (GetCurrentThreadId() != m_MainThreadId)
+    {
+        GetThreadLane()->Push( nameId );
+        return;
+    }
+
+    TimingEvent* te = Begin( *m_pTree, nameId, m_bCpuOnly ? NULL : m_pDev );
+
+    if (m_Capture.IsEnabled() && m_pTree == &m_MainTree)
+    {
+        UINT64 tag = m_Capture.BeginEvent( nameId, AMD::CpuClock::Now() );
+        if (NULL != te->m_gpu) { te->m_gpu->SetNextTag( tag ); }
+    }
+
+    te->Start();
+}
+
+TimingEvent* TimerEx::Begin( TimerTree& tree, UINT nameId, ID3D11Device* pDev )
+{
+    TimingEvent* current = tree.m_Current;
+    TimerChildTable& children = (NULL == current) ? tree.m_RootChildren : current->m_children;
 
-    TimingEvent* te = (NULL == m_Current) ? GetTimer( timerId ) : m_Current->GetTimer( timerId );
+    TimingEvent* te = children.Find( nameId );
     if (NULL == te)
     {
         // create new timer event
-        if (NULL == m_Unused)
+        if (NULL == tree.m_Unused)
         {
-            te = new TimingEvent();
+            te = new TimingEvent( pDev );
         }
         else
         {
-            te = m_Unused;
-            m_Unused = te->m_next;
-            te->m_next = NULL;
+            te = tree.m_Unused;
+            tree.m_Unused = te->m_next;
         }
 
-        te->SetName( timerId );
-        te->m_parent = m_Current;
+        // a reused event starts without the links of its previous place in the tree
+        te->m_nameId = nameId;
+        te->m_parent = current;
+        te->m_next = NULL;
+        te->m_firstChild = NULL;
+        te->m_children.Clear();
+        children.Insert( te );
 
         // now look where to insert it
         TimingEvent* lu = NULL;
-        if (NULL == m_Current)
+        if (NULL == current)
         {
-            TimingEvent* tmp = m_Root;
+            TimingEvent* tmp = tree.m_Root;
             while (tmp)
             {
                 if (tmp->m_used)
@@ -788,7 +1234,7 @@ void TimerEx::Start( LPCWSTR timerId )
         }
         else
         {
-            lu = m_Current->FindLastChildUsed();
+            lu = current->FindLastChildUsed();
         }
 
         if (NULL != lu)
@@ -798,31 +1244,43 @@ void TimerEx::Start( LPCWSTR timerId )
         }
         else
         {
-            if (NULL == m_Current)
+            if (NULL == current)
             {
-                te->m_next = m_Root;
-                m_Root = te;
+                te->m_next = tree.m_Root;
+                tree.m_Root = te;
             }
             else
             {
-                te->m_next = m_Current->m_firstChild;
-                m_Current->m_firstChild = te;
+                te->m_next = current->m_firstChild;
+                current->m_firstChild = te;
             }
 
         }
     }
 
-    m_Current = te;
-    m_Current->Start();
+    tree.m_Current = te;
+    return te;
 }
 
 void TimerEx::Stop()
 {
     _ASSERT( "init not called or called with NULL" && (m_pDev != NULL) );
-    _ASSERT( "Start(...) not called before Stop()" && (m_Current != NULL) );
 
-    m_Current->Stop();
-    m_Current = m_Current->m_parent;
+    if (GetCurrentThreadId() != m_MainThreadId)
+    {
+        GetThreadLane()->Push( InvalidNameId );
+        return;
+    }
+
+    _ASSERT( "Start(...) not called before Stop()" && (m_pTree->m_Current != NULL) );
+
+    m_pTree->m_Current->Stop();
+    m_pTree->m_Current = m_pTree->m_Current->m_parent;
+
+    if (m_Capture.IsEnabled() && m_pTree == &m_MainTree)
+    {
+        m_Capture.EndEvent( AMD::CpuClock::Now() );
+    }
 }
 
 double TimerEx::GetTime( TimerType type, LPCWSTR timerId, bool stall )
@@ -831,9 +1289,9 @@ double TimerEx::GetTime( TimerType type, LPCWSTR timerId, bool stall )
 
     TimingEvent* te = NULL;
 
-    if (NULL != m_Current)
+    if (NULL != m_pTree->m_Current)
     {
-        te = m_Current->GetTimer( timerId );
+        te = m_pTree->m_Current->GetTimer( timerId );
     }
 
     if (NULL == te)
@@ -850,9 +1308,9 @@ double TimerEx::GetAvgTime( TimerType type, LPCWSTR timerId, bool stall )
 
     TimingEvent* te = NULL;
 
-    if (NULL != m_Current)
+    if (NULL != m_pTree->m_Current)
     {
-        te = m_Current->GetTimer( timerId );
+        te = m_pTree->m_Current->GetTimer( timerId );
     }
 
     if (NULL == te)
@@ -863,47 +1321,445 @@ double TimerEx::GetAvgTime( TimerType type, LPCWSTR timerId, bool stall )
     return (NULL != te) ? te->GetAvgTime( type, stall ) : 0.0;
 }
 
+const TimerStats* TimerEx::GetStats( TimerType type, LPCWSTR timerId )
+{
+    TimingEvent* te = NULL;
+
+    if (NULL != m_pTree->m_Current)
+    {
+        te = m_pTree->m_Current->GetTimer( timerId );
+    }
+
+    if (NULL == te)
+    {
+        te = GetTimer( timerId );
+    }
+
+    return (NULL != te) ? te->GetStats( type ) : NULL;
+}
+
+void TimerEx::ResetStats( TimingEvent* te )
+{
+    for (; NULL != te; te = te->m_next)
+    {
+        ResetStats( te->m_firstChild );
+
+        te->m_cpu.ResetStats();
+        if (NULL != te->m_gpu) { te->m_gpu->ResetStats(); }
+    }
+}
+
+void TimerEx::ResetStats()
+{
+    _ASSERT( "ResetStats() called from a worker thread" && (GetCurrentThreadId() == m_MainThreadId) );
+
+    ResetStats( m_pTree->m_Root );
+
+    // lane trees are only touched by Reset on this thread, so they can be reset here too
+    EnterCriticalSection( &m_LanesLock );
+    for (size_t i = 0; i < m_Lanes.size(); ++i)
+    {
+        ResetStats( m_Lanes[i]->m_tree.m_Root );
+    }
+    LeaveCriticalSection( &m_LanesLock );
+}
+
+void TimerEx::WriteStats( FILE* file, TimingEvent* te, const std::wstring& lane, const std::wstring& parentPath )
+{
+    static const TimerType types[] = { ttCpu, ttGpu };
+
+    for (; NULL != te; te = te->m_next)
+    {
+        std::wstring path = parentPath.empty() ? te->GetName() : parentPath + L"|" + te->GetName();
+
+        // quoted, so names may contain commas
+        std::wstring fields = L"\"" + lane + L"\",\"" + path + L"\"";
+        int len = WideCharToMultiByte( CP_UTF8, 0, fields.c_str(), -1, NULL, 0, NULL, NULL );
+        std::vector<char> utf8( (len > 0) ? len : 1, 0 );
+        if (len > 0)
+        {
+            WideCharToMultiByte( CP_UTF8, 0, fields.c_str(), -1, &utf8[0], len, NULL, NULL );
+        }
+
+        for (UINT i = 0; i < ARRAYSIZE( types ); ++i)
+        {
+            const TimerStats* stats = te->GetStats( types[i] );
+            if (NULL == stats || 0 == stats->GetCount())
+            {
+                continue;
+            }
+
+            fprintf( file, "%s,%s,%u,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%u\n",
+                &utf8[0], (ttCpu == types[i]) ? "cpu" : "gpu", stats->GetCount(),
+                stats->GetMin() * 1000.0, stats->GetMean() * 1000.0, stats->GetEma() * 1000.0,
+                stats->GetPercentile( 50.0 ) * 1000.0, stats->GetPercentile( 95.0 ) * 1000.0,
+                stats->GetPercentile( 99.0 ) * 1000.0, stats->GetPercentile( 99.9 ) * 1000.0,
+                stats->GetMax() * 1000.0, (ttGpu == types[i]) ? te->m_gpu->GetMaxLatencyFrames() : 0 );
+        }
+
+        WriteStats( file, te->m_firstChild, lane, path );
+    }
+}
+
+bool TimerEx::WriteStats( LPCWSTR fileName )
+{
+    _ASSERT( "WriteStats() called from a worker thread" && (GetCurrentThreadId() == m_MainThreadId) );
+
+    FILE* file = NULL;
+    _wfopen_s( &file, fileName, L"wt" );
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    fprintf( file, "lane,timer,type,frames,min_ms,mean_ms,ema_ms,p50_ms,p95_ms,p99_ms,p99.9_ms,max_ms,latency_frames\n" );
+
+    WriteStats( file, m_pTree->m_Root, L"Main", L"" );
+
+    EnterCriticalSection( &m_LanesLock );
+    for (size_t i = 0; i < m_Lanes.size(); ++i)
+    {
+        WriteStats( file, m_Lanes[i]->m_tree.m_Root, m_Lanes[i]->m_name, L"" );
+    }
+    LeaveCriticalSection( &m_LanesLock );
+
+    bool ok = (0 == ferror( file ));
+    fclose( file );
+
+    return ok;
+}
+
+bool TimerEx::WriteOverhead( LPCWSTR fileName )
+{
+    _ASSERT( "WriteOverhead() called from a worker thread" && (GetCurrentThreadId() == m_MainThreadId) );
+
+    // measured before opening the file, so the file system isn't part of it
+    double getTimeNs = 0.0;
+    double scopeNs = MeasureScopeOverhead( 100000, &getTimeNs );
+    double disabledZoneNs = 0.0;
+    double zoneNs = MeasureZoneOverhead( 100000, &disabledZoneNs );
+
+    WCHAR text[192];
+    swprintf_s( text, L"Timer overhead: %.1f ns per TIMER_Begin/TIMER_End, %.1f ns per GetTime, %.1f ns per TIMER_Zone, %.1f ns per disabled TIMER_Zone\n",
+                scopeNs, getTimeNs, zoneNs, disabledZoneNs );
+    OutputDebugStringW( text );
+
+    FILE* file = NULL;
+    _wfopen_s( &file, fileName, L"wt" );
+    if (NULL == file)
+    {
+        return false;
+    }
+
+    fprintf( file, "measurement,ns\n" );
+    fprintf( file, "scope,%.2f\n", scopeNs );
+    fprintf( file, "get_time,%.2f\n", getTimeNs );
+    fprintf( file, "zone,%.2f\n", zoneNs );
+    fprintf( file, "zone_disabled,%.2f\n", disabledZoneNs );
+
+    bool ok = (0 == ferror( file ));
+    fclose( file );
+
+    return ok;
+}
 
 TimingEvent* TimerEx::GetTimer( LPCWSTR timerId )
 {
     if (NULL == timerId)
     {
-        return m_Root;
+        return m_pTree->m_Root;
     }
 
     _ASSERT( "init not called" && (m_pDev != NULL) );
 
-    size_t len = wcslen( timerId );
-    size_t seperator = wcscspn( timerId, L"/|\\" );
-    if (seperator < len)
+    return TimingEvent::FindTimer( m_pTree->m_RootChildren, timerId );
+}
+
+//-----------------------------------------------------------------------------
+
+UINT TimerEx::HashName( LPCWSTR name, size_t len )
+{
+    // FNV-1a
+    UINT hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash = (hash ^ name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// m_NamesLock must be held, shared or exclusive
+UINT TimerEx::FindNameLocked( LPCWSTR name, size_t len, UINT hash ) const
+{
+    if (m_NameSlots.empty())
     {
-        LPWSTR idCopy = new WCHAR[len + 1];
-        wcscpy_s( idCopy, len + 1, timerId );
-        idCopy[seperator] = 0;
-        TimingEvent* te = m_Root;
-        while (te)
+        return InvalidNameId;
+    }
+
+    UINT mask = (UINT)m_NameSlots.size() - 1;
+
+    for (UINT i = hash & mask; 0 != m_NameSlots[i]; i = (i + 1) & mask)
+    {
+        UINT nameId = m_NameSlots[i] - 1;
+        if (m_NameHashes[nameId] == hash && 0 == wcsncmp( m_Names[nameId], name, len ) && 0 == m_Names[nameId][len])
         {
-            if (!wcscmp( idCopy, te->m_name ))
-            {
-                te = te->GetTimerRec( &idCopy[seperator + 1] );
-                delete [] idCopy;
-                return te;
-            }
-            te = te->m_next;
+            return nameId;
         }
-        delete [] idCopy;
     }
-    else
+
+    return InvalidNameId;
+}
+
+UINT TimerEx::FindName( LPCWSTR name, size_t len ) const
+{
+    UINT hash = HashName( name, len );
+
+    AcquireSRWLockShared( &m_NamesLock );
+    UINT nameId = FindNameLocked( name, len, hash );
+    ReleaseSRWLockShared( &m_NamesLock );
+
+    return nameId;
+}
+
+UINT TimerEx::InternName( LPCWSTR name )
+{
+    size_t len = wcslen( name );
+
+    return InternName( name, len, HashName( name, len ) );
+}
+
+UINT TimerEx::InternName( LPCWSTR name, size_t len, UINT hash )
+{
+    AcquireSRWLockShared( &m_NamesLock );
+    UINT nameId = FindNameLocked( name, len, hash );
+    ReleaseSRWLockShared( &m_NamesLock );
+
+    if (InvalidNameId != nameId)
+    {
+        return nameId;
+    }
+
+    AcquireSRWLockExclusive( &m_NamesLock );
+
+    // another thread may have added it since the lookup above
+    nameId = FindNameLocked( name, len, hash );
+    if (InvalidNameId == nameId)
     {
-        TimingEvent* te = m_Root;
-        while (te)
+        // first time this name is seen: keep a copy, so the caller's string may be temporary
+        nameId = (UINT)m_Names.size();
+
+        LPWSTR copy = new WCHAR[len + 1];
+        wcscpy_s( copy, len + 1, name );
+        m_Names.push_back( copy );
+        m_NameHashes.push_back( hash );
+
+        // keep the table at most half full; rehash everything when it grows
+        if (m_Names.size() * 2 > m_NameSlots.size())
         {
-            if (!wcscmp( timerId, te->m_name ))
+            m_NameSlots.assign( std::max<size_t>( 64, m_NameSlots.size() * 2 ), 0 );
+            UINT mask = (UINT)m_NameSlots.size() - 1;
+
+            for (UINT id = 0; id < (UINT)m_Names.size(); ++id)
             {
-                return te;
+                UINT i = m_NameHashes[id] & mask;
+                while (0 != m_NameSlots[i])
+                {
+                    i = (i + 1) & mask;
+                }
+                m_NameSlots[i] = id + 1;
             }
-            te = te->m_next;
         }
+        else
+        {
+            UINT mask = (UINT)m_NameSlots.size() - 1;
+            UINT i = hash & mask;
+            while (0 != m_NameSlots[i])
+            {
+                i = (i + 1) & mask;
+            }
+            m_NameSlots[i] = nameId + 1;
+        }
+    }
+
+    ReleaseSRWLockExclusive( &m_NamesLock );
+
+    return nameId;
+}
+
+UINT TimerEx::RegisterZone( TimerZoneSite& site )
+{
+    size_t len = wcslen( site.m_name );
+
+    // the hash was computed at compile time, unless the compiler has no constexpr
+    _ASSERT( "zone name hash mismatch" && (0 == site.m_hash || HashName( site.m_name, len ) == site.m_hash) );
+    UINT hash = (0 != site.m_hash) ? site.m_hash : HashName( site.m_name, len );
+
+    UINT nameId = InternName( site.m_name, len, hash );
+
+    // several threads may register the same site at once; they all get the same ID, but only
+    // the first adds the site to the list
+    AcquireSRWLockExclusive( &m_NamesLock );
+    if (InvalidNameId == site.m_nameId)
+    {
+        m_ZoneSites.push_back( &site );
+        site.m_nameId = nameId;
+    }
+    ReleaseSRWLockExclusive( &m_NamesLock );
+
+    return nameId;
+}
+
+UINT TimerEx::GetNumZoneSites( ) const
+{
+    AcquireSRWLockShared( &m_NamesLock );
+    UINT numSites = (UINT)m_ZoneSites.size();
+    ReleaseSRWLockShared( &m_NamesLock );
+
+    return numSites;
+}
+
+const TimerZoneSite* TimerEx::GetZoneSite( UINT index ) const
+{
+    AcquireSRWLockShared( &m_NamesLock );
+    const TimerZoneSite* site = (index < m_ZoneSites.size()) ? m_ZoneSites[index] : NULL;
+    ReleaseSRWLockShared( &m_NamesLock );
+
+    return site;
+}
+
+LPCWSTR TimerEx::GetNameString( UINT nameId ) const
+{
+    // the strings themselves never move, only the array of pointers to them
+    AcquireSRWLockShared( &m_NamesLock );
+    LPCWSTR name = (nameId < m_Names.size()) ? m_Names[nameId] : NULL;
+    ReleaseSRWLockShared( &m_NamesLock );
+
+    return name;
+}
+
+double TimerEx::MeasureScopeOverhead( UINT numIterations, double* pGetTimeNs )
+{
+    _ASSERT( "init not called or called with NULL" && (m_pDev != NULL) );
+    _ASSERT( "MeasureScopeOverhead called inside a timer" && (m_MainTree.m_Current == NULL) );
+    _ASSERT( "MeasureScopeOverhead called from a worker thread" && (GetCurrentThreadId() == m_MainThreadId) );
+
+    if (0 == numIterations || NULL != m_MainTree.m_Current || GetCurrentThreadId() != m_MainThreadId)
+    {
+        return 0.0;
+    }
+
+    // record into a scratch tree, so the real timers are left alone
+    TimerTree scratch;
+    m_pTree = &scratch;
+    m_bCpuOnly = true;
+
+    // the first pass creates the timers, so only steady state is measured
+    Start( L"MeasureScopeOverhead" );
+    Start( L"Nested" );
+    Stop();
+    Stop();
+
+    CpuTimer scopeTimer;
+    scopeTimer.Start();
+    for (UINT i = 0; i < numIterations; ++i)
+    {
+        Start( L"MeasureScopeOverhead" );
+        Start( L"Nested" );
+        Stop();
+        Stop();
+    }
+    scopeTimer.Stop();
+
+    if (NULL != pGetTimeNs)
+    {
+        volatile double sink = 0.0;
+
+        CpuTimer getTimeTimer;
+        getTimeTimer.Start();
+        for (UINT i = 0; i < numIterations; ++i)
+        {
+            sink = GetTime( ttCpu, L"MeasureScopeOverhead|Nested" );
+        }
+        getTimeTimer.Stop();
+        (void)sink;
+
+        *pGetTimeNs = getTimeTimer.GetTime() * 1.0e9 / numIterations;
     }
-    return NULL;
+
+    DeleteTree( scratch );
+    m_pTree = &m_MainTree;
+    m_bCpuOnly = false;
+
+    return scopeTimer.GetTime() * 1.0e9 / (2.0 * numIterations);
+}
+
+double TimerEx::MeasureZoneOverhead( UINT numIterations, double* pDisabledNs )
+{
+    _ASSERT( "init not called or called with NULL" && (m_pDev != NULL) );
+    _ASSERT( "MeasureZoneOverhead called inside a timer" && (m_MainTree.m_Current == NULL) );
+    _ASSERT( "MeasureZoneOverhead called from a worker thread" && (GetCurrentThreadId() == m_MainThreadId) );
+
+    if (0 == numIterations || NULL != m_MainTree.m_Current || GetCurrentThreadId() != m_MainThreadId)
+    {
+        return 0.0;
+    }
+
+    // the sites of TIMER_Zone, used directly so AMD_TIMER_CATEGORIES doesn't compile the zones out
+    static TimerZoneSite outerSite = { L"MeasureZoneOverhead", __FILE__, __LINE__, tcDetail, AMD_TIMER_HASH( L"MeasureZoneOverhead" ), InvalidNameId };
+    static TimerZoneSite nestedSite = { L"Nested", __FILE__, __LINE__, tcDetail, AMD_TIMER_HASH( L"Nested" ), InvalidNameId };
+
+    // record into a scratch tree, so the real timers are left alone
+    TimerTree scratch;
+    m_pTree = &scratch;
+    m_bCpuOnly = true;
+
+    // the first pass registers the sites and creates the timers, so only steady state is measured
+    {
+        TimerZone<1> outer( outerSite );
+        TimerZone<1> nested( nestedSite );
+    }
+
+    CpuTimer zoneTimer;
+    zoneTimer.Start();
+    for (UINT i = 0; i < numIterations; ++i)
+    {
+        TimerZone<1> outer( outerSite );
+        TimerZone<1> nested( nestedSite );
+    }
+    zoneTimer.Stop();
+
+    if (NULL != pDisabledNs)
+    {
+        // the same loop with compiled out zones, against a loop without them; both do a volatile
+        // store per iteration, so the compiler can't remove the loops
+        volatile UINT sink = 0;
+
+        CpuTimer baseTimer;
+        baseTimer.Start();
+        for (UINT i = 0; i < numIterations; ++i)
+        {
+            sink = i;
+        }
+        baseTimer.Stop();
+
+        CpuTimer disabledTimer;
+        disabledTimer.Start();
+        for (UINT i = 0; i < numIterations; ++i)
+        {
+            TimerZone<0> outer( outerSite );
+            TimerZone<0> nested( nestedSite );
+            sink = i;
+        }
+        disabledTimer.Stop();
+        (void)sink;
+
+        double disabled = disabledTimer.GetTime() - baseTimer.GetTime();
+        *pDisabledNs = (disabled > 0.0) ? disabled * 1.0e9 / (2.0 * numIterations) : 0.0;
+    }
+
+    DeleteTree( scratch );
+    m_pTree = &m_MainTree;
+    m_bCpuOnly = false;
+
+    return zoneTimer.GetTime() * 1.0e9 / (2.0 * numIterations);
 }
@@ -72,8 +72,23 @@
 * TIMER_End( )
 *   This ends a timer which was previously started with TIMER_Begin.
 *
+* TIMER_Zone( category, name )
+*   Add this inside a code block to add profiling to it, from this line to the end of the block.
+*   The name must be a string literal, anything else doesn't compile, because the site keeps the
+*   pointer from the first run for good. Use TIMER_ProfileCodeBlock for names built at runtime.
+*   Each zone has static site data (name, file, line, category)
+*   that is constant initialized, with the name hashed at compile time where the compiler supports
+*   constexpr (VS2015 and later). The site is registered with TimerEx the first time the zone runs,
+*   which interns its name once; after that a zone costs one Start/Stop pair without any string work.
+*   The category is one of TimerCategory. Zones of a category that is not in AMD_TIMER_CATEGORIES,
+*   or all zones if ENABLE_AMD_TIMER is 0, compile to nothing. Both may be defined by the project,
+*   e.g. AMD_TIMER_CATEGORIES=(tcFrame|tcRender) to keep only the coarse zones in a release build.
+*   Only one zone per line is possible.
+*
 * TIMER_ProfileCodeBlock( col, name )
-*   Convenience macro. Add this inside a code block to add profiling to it. See examples for details.
+*   Add this inside a code block to add profiling to it, from this line to the end of the block.
+*   Unlike TIMER_Zone it looks up the name every time it runs, so the name may be built at runtime.
+*   col is ignored. Only one per code block is possible.
 *
 * TIMER_GetTime( Cpu_Gpu, name )
 *   Retrieve the timing value of a timer in microseconds.
@@ -86,6 +101,22 @@
 *   This macro stalls the CPU until the result of a GPU timer is available.
 *   Since it forces the CPU to idle, this macro should not be used in time critical parts of your app.
 *
+* TIMER_GetStats( Cpu_Gpu, name )
+*   Retrieve the TimerStats of a timer: min, max, mean, EMA and percentiles (p50, p95, p99, p99.9 ...)
+*   of its per frame times since the last TIMER_FullReset or TIMER_ResetStats, in seconds.
+*   Returns NULL if there is no timer with that name.
+*
+* TIMER_ResetStats( )
+*   Clears the statistics of all timers, e.g. after a setting changed that affects the timings.
+*
+* TIMER_WriteStats( fileName )
+*   Writes the statistics of all timers to a CSV file, for benchmark runs.
+*
+* TIMER_WriteOverhead( fileName )
+*   Measures what the timers themselves cost, with MeasureScopeOverhead and MeasureZoneOverhead,
+*   and writes it to a CSV file next to the statistics, so they can be read with it in mind.
+*   Call outside of any timer.
+*
 *
 * Classes
 * -------
@@ -93,9 +124,19 @@
 * TimerExHelper
 *   Create an Instance of this class to automatically add profiling to a code block.
 *   This class starts a timer in the constructor and ends the timer in its destructor.
+*   It looks up its name every time, so use it for names built at runtime, and TIMER_Zone otherwise.
+*
+* TimerZone< Enabled >
+*   The scoped timer behind TIMER_Zone. TimerZone< 0 > is empty, so a disabled zone has no cost.
 *
 * TimerEx
 *   Singleton that manages the timer tree generated by TIMER_Begin and TIMER_End.
+*   TIMER_Begin and TIMER_End may be used on any thread. The thread that called TIMER_Init records
+*   into the main tree, including GPU times. Other threads record CPU times only, into a lock-free
+*   buffer per thread, which TIMER_Reset merges into one lane (tree) per thread. Lane times are
+*   therefore those of the previous frame. TIMER_SetThreadName( name ) names the calling thread's lane.
+*   TIMER_EnableCapture( numFrames ) keeps a timeline of the last frames (see TimerCapture.h), which
+*   TIMER_DumpCapture( ) or a frame time spike writes out as Chrome trace JSON and Perfetto protobuf.
 *   Functions:
 *     - Instance        : retrieve the instance of TimerEx
 *     - GetDevice       : get the device passed to TimerEx at Init
@@ -105,8 +146,14 @@
 *     - Start           : start a timer
 *     - Stop            : stop a timer
 *     - GetTime         : retrieve the timing result of a timer
+*     - GetStats        : retrieve the frame time statistics of a timer
 *     - GetTimer        : retrieve a TimerEvent*. This ptr should not be kept past a reset.
 *                         it can be used to manually iterate through the timer tree
+*     - InternName      : map a timer name to an integer ID. Names are interned the first time
+*                         they are used, so Start/Stop/GetTime don't allocate in steady state
+*     - MeasureScopeOverhead : measure the cost of a TIMER_Begin/TIMER_End pair in nanoseconds
+*     - MeasureZoneOverhead  : measure the cost of an enabled and a disabled TIMER_Zone in nanoseconds
+*     - RegisterZone         : called by a TIMER_Zone the first time it runs
 *
 * TimerEvent
 *   Manages one CpuTimer and one GpuTimer (if ID3D11Device is specified) plus the name of
@@ -114,6 +161,8 @@
 *   Functions:
 *     - GetTime       : retrieve the timing result for either gpu or cpu.
 *                       Specify if the cpu should wait to the latest gpu time to be available
+*     - GetStats      : retrieve the frame time statistics for either gpu or cpu
+*     - GetGpuTimer   : retrieve the GpuTimer, e.g. for its frames of latency
 *     - GetTimer      : retrieve a nested TimerEvent* by name or relative path
 *     - GetParent     : retrieve the parental TimerEvent*
 *     - GetFirstChild : retrieve the first child-TimerEvent*
@@ -123,16 +172,23 @@
 * Timer
 *   Lightweight interface to instrument your code without the overhead introduced by the TimerEx class.
 *   The times measured by Timer will add up when starting/stopping the timer multiple times without
-*   resetting the timer.
+*   resetting the timer. GetStats returns the statistics of the per frame times (the times between
+*   resets, or the GPU time of each frame).
 *   Create an instance of either of the derived classes for each event you want to profile:
 *     - CpuTimer    : measures the time taken on the CPU to execute from Start to Stop
+*                     It reads AMD::CpuClock (invariant TSC, QPC or clock_gettime, see CpuClock.h) and
+*                     subtracts the measured cost of reading the clock, so even very short scopes are accurate.
 *     - GpuTimer    : measures the time taken on the GPU to execute from Start to Stop
 *                     When using GpuTimer please note that the timing results may only be available
 *                     several frames later, so numTimeStamps should specify enough space for at least
 *                     numTimesTimerStartedPerFrame*maxNumFramesLag timing values. Please also keep in mind
 *                     that Crossfire configurations are likely to increase the number of frames until a result
 *                     is ready.
-*                     If numTimeStamps is chosen too small this will result in the CPU stalling.
+*                     If numTimeStamps is chosen too small the ring of timestamps grows, up to MaxTimeStamps,
+*                     beyond that the CPU stalls. GetLatencyFrames reports how many frames results take.
+*                     Instead of a device, GpuTimer can take an AMD::GpuTimestampBackend, e.g. the
+*                     SimulatedGpuTimestamps in GpuTimestamps.h, to run without a GPU. The ring itself is
+*                     AMD::GpuTimestampRing, which doesn't depend on D3D.
 *     - GpuCpuTimer : Measure the time the GPU takes to execute the commands beeing issued between Start and Stop
 *                     by measuring the time on the CPU.
 *                     This will stall the CPU twice, once at Start and once at Stop.
@@ -411,11 +467,27 @@
 //namespace AMD
 //{
 
-#define USE_RDTSC 0
 #define WATCH_BAD_TS_VAL 0
 #define CHECK_DISJOINT   0
 
+#ifndef ENABLE_AMD_TIMER
 #define ENABLE_AMD_TIMER 1
+#endif
+
+// bit mask of the TimerCategory values whose TIMER_Zone zones are compiled in
+#ifndef AMD_TIMER_CATEGORIES
+#define AMD_TIMER_CATEGORIES 0xFFFFFFFF
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER < 1900)
+#define AMD_TIMER_HAVE_CONSTEXPR 0
+#else
+#define AMD_TIMER_HAVE_CONSTEXPR 1
+#endif
+
+#include "CpuClock.h"
+#include "GpuTimestampRing.h"
+#include "TimerCapture.h"
 
 enum TimerType
 {
@@ -424,6 +496,55 @@ enum TimerType
     ttGpuCpu    = 3,
 };
 
+// categories of TIMER_Zone zones, to compile them out selectively with AMD_TIMER_CATEGORIES
+enum TimerCategory
+{
+    tcDefault   = 1 << 0,
+    tcFrame     = 1 << 1,   // the top level passes of a frame
+    tcRender    = 1 << 2,
+    tcCompute   = 1 << 3,
+    tcLoading   = 1 << 4,   // resource creation and streaming
+    tcDetail    = 1 << 5,   // fine grained zones, e.g. per draw or per object
+};
+
+//-----------------------------------------------------------------------------
+
+// streaming statistics of per frame times: min, max, mean, an exponential moving average
+// and a log bucketed histogram (HDR histogram style) for percentiles.
+// a bucket spans at most 1/32 of its value, so percentiles are within about 1.6%
+class TimerStats
+{
+public:
+    TimerStats();
+
+    void    Reset           ( );
+    void    Add             ( double t );               // one frame's time in seconds
+    void    SetEmaWeight    ( double weight );          // weight of a new sample in the EMA, 0.1 by default
+
+    UINT    GetCount        ( ) const { return m_Count; }
+    double  GetMin          ( ) const { return m_Min; }
+    double  GetMax          ( ) const { return m_Max; }
+    double  GetMean         ( ) const { return (0 != m_Count) ? m_Sum / m_Count : 0.0; }
+    double  GetEma          ( ) const { return m_Ema; }
+    double  GetPercentile   ( double percentile ) const; // e.g. 99.9, in seconds
+
+private:
+    static const UINT SubBucketBits = 5;
+    static const UINT MaxValueBits = 40;                // 2^40 ns, about 18 minutes
+    static const UINT NumBuckets = (MaxValueBits - SubBucketBits + 1) << SubBucketBits;
+
+    static UINT     BucketIndex     ( UINT64 ns );
+    static double   BucketValue     ( UINT index );     // midpoint of the bucket in ns
+
+    std::vector<UINT>   m_Buckets;  // allocated by the first Add
+    UINT                m_Count;
+    double              m_Min;
+    double              m_Max;
+    double              m_Sum;
+    double              m_Ema;
+    double              m_EmaWeight;
+};
+
 //-----------------------------------------------------------------------------
 
 class Timer
@@ -440,10 +561,17 @@ public:
     double GetSumTime();
     double GetTimeNumFrames();
 
+    // statistics of the frame times since the last full reset
+    const TimerStats& GetStats();
+    void ResetStats();
+
 protected:
     double          m_LastTime;
     double          m_SumTime;
     unsigned int    m_NumFrames;
+    TimerStats      m_Stats;
+
+    void AddFrame( double t );
 
     virtual void FinishCollection() {}
 };
@@ -462,39 +590,32 @@ public:
 
     void Delay(double sec);
 
-private:
-    LARGE_INTEGER m_startTime;
-    double m_freq;
+    // adds a time measured elsewhere, e.g. on another thread
+    void AddTime( double t );
 
-#if USE_RDTSC
-    double m_freqRdtsc;
-#endif
+    // ticks of AMD::CpuClock between two reads, minus the cost of reading the clock
+    static LONGLONG ElapsedTicks( LONGLONG start, LONGLONG stop );
+
+private:
+    LONGLONG m_startTime;   // AMD::CpuClock ticks
+    bool m_bTimed;          // started or added to since the last reset
 };
 
 //-----------------------------------------------------------------------------
 
 class GpuTimer : public Timer
 {
-private:
-    struct TsRecord
-    {
-        union TsRecordState
-        {
-            struct TsRecordData
-            {
-                unsigned frameID        :30;
-                unsigned startIssued    : 1;
-                unsigned stopIssued     : 1;
-            } data;
-            UINT stateWord;
-        } state;
-        ID3D11Query* pStart;
-        ID3D11Query* pStop;
-        ID3D11Query* pDisjointTS;
-    };
-
 public:
+    // called with the raw timestamps of each Start/Stop pair that was given a non-zero tag
+    typedef AMD::GpuTimestampRing::PFN_ON_TIMESTAMPS PFN_ON_TIMESTAMPS;
+
+    // the ring of timestamp records grows when Start finds it full of results that aren't in yet,
+    // up to MaxTimeStamps records. Only then does the CPU stall
+    static const UINT MaxTimeStamps = AMD::GpuTimestampRing::MaxTimeStamps;
+
     GpuTimer(ID3D11Device* pDev, UINT64 freq = 27000000, UINT numTimeStamps = 8);
+    // times with another query backend, e.g. AMD::SimulatedGpuTimestamps, which must outlive the timer
+    GpuTimer(AMD::GpuTimestampBackend* pBackend, UINT numTimeStamps = 8);
     virtual ~GpuTimer();
 
     virtual void Reset( bool bResetSum );
@@ -503,27 +624,28 @@ public:
 
     void WaitIdle();
 
-private:
+    void SetTimestampCallback( PFN_ON_TIMESTAMPS pfnOnTimestamps, void* pUserData ) { m_pRing->SetTimestampCallback( pfnOnTimestamps, pUserData ); }
+    void SetNextTag( UINT64 tag ) { m_pRing->SetNextTag( tag ); }  // tag for the next Start
 
-    ID3D11DeviceContext*    m_pDevCtx;
+    UINT GetNumTimeStamps() const { return m_pRing->GetNumTimeStamps(); }
+    UINT GetNumGrowths() const { return m_pRing->GetNumGrowths(); }     // times the ring grew to avoid a stall
+    UINT GetNumStalls() const { return m_pRing->GetNumStalls(); }       // times Start stalled, with the ring at MaxTimeStamps
 
-    UINT                    m_numTimeStamps;
-    TsRecord*               m_ts;
+    // frames from a Start until its result was collected, of the last result and the most seen
+    UINT GetLatencyFrames() const { return m_pRing->GetLatencyFrames(); }
+    UINT GetMaxLatencyFrames() const { return m_pRing->GetMaxLatencyFrames(); }
 
-    UINT                    m_curIssueTs;
-    UINT                    m_nextRetrTs;
-    UINT                    m_FrameID;
+private:
 
-    struct CurTimeFrameBits
-    {
-        UINT        id      :30;
-        UINT        invalid : 1;
-    } m_CurTimeFrame;
-    double                  m_CurTime;
+    AMD::GpuTimestampBackend* m_pBackend;
+    bool                    m_bOwnsBackend;
 
+    // the records in flight and their latency, see GpuTimestampRing.h
+    AMD::GpuTimestampRing*  m_pRing;
+
+    static void OnFrame( void* pUserData, double seconds );
 
     virtual void FinishCollection();
-    bool CollectData(UINT idx, BOOL stall = FALSE);
 };
 
 //-----------------------------------------------------------------------------
@@ -549,11 +671,56 @@ private:
 // TimerEx:         extended timer singleton to provide instrumentalization similar to PIX
 // TimerExHelper:   convenience class to provide easy profiling of function calls
 // some MAKROS:     to ease instrumenting your code
+class TimingEvent;
+
+// static data of one TIMER_Zone, constant initialized and registered with TimerEx when the zone first runs
+struct TimerZoneSite
+{
+    LPCWSTR         m_name;
+    const char*     m_file;
+    UINT            m_line;
+    UINT            m_category;
+    UINT            m_hash;     // hash of m_name, or 0 if the compiler couldn't compute it
+    volatile UINT   m_nameId;   // TimerEx::InvalidNameId until registered
+};
+
+#if AMD_TIMER_HAVE_CONSTEXPR
+// FNV-1a of a zero terminated name at compile time, the same hash TimerEx interns names with
+constexpr UINT TimerHashName( LPCWSTR name, UINT hash = 2166136261u )
+{
+    return (0 == *name) ? hash : TimerHashName( name + 1, (hash ^ (UINT)*name) * 16777619u );
+}
+#endif
+
+// open addressed table of a timer's children, keyed by interned name ID
+// it only allocates when it grows, so lookups of existing timers are allocation free
+class TimerChildTable
+{
+public:
+    TimerChildTable();
+    ~TimerChildTable();
+
+    TimingEvent*    Find            ( UINT nameId ) const;
+    void            Insert          ( TimingEvent* te );
+    void            Clear           ( );
+    void            Swap            ( TimerChildTable& other );
+
+private:
+    TimerChildTable( const TimerChildTable& );
+    TimerChildTable& operator=( const TimerChildTable& );
+
+    TimingEvent**   m_slots;
+    UINT            m_mask;
+    UINT            m_count;
+};
+
 class TimingEvent
 {
 public:
     double          GetTime         ( TimerType type, bool stall = false );
     double          GetAvgTime      ( TimerType type, bool stall = false );
+    const TimerStats* GetStats      ( TimerType type );     // NULL for ttGpu without a device
+    GpuTimer*       GetGpuTimer     ( ) { return m_gpu; }   // for its ring size and latency; NULL without a device
 
     TimingEvent*    GetTimer        ( LPCWSTR timerId );    // get a child-timer by name
     TimingEvent*    GetParent       ( );                    // walk through timer tree
@@ -566,20 +733,21 @@ private:
     // functions only to be used by TimerEx
     friend class TimerEx;
 
-    TimingEvent( );
+    friend class TimerChildTable;
+
+    TimingEvent( ID3D11Device* pDev );
     virtual ~TimingEvent();
 
-    TimingEvent*    GetTimerRec         ( LPWSTR timerId );
+    static TimingEvent* FindTimer       ( const TimerChildTable& children, LPCWSTR timerId );
     void            Reset               ( );
     void            Start               ( );
     void            Stop                ( );
 
     TimingEvent*    FindLastChildUsed   ( );
-    void            SetName             ( LPCWSTR timerId );
 
 private:
-    LPWSTR          m_name;
-    unsigned int    m_nameLen;
+    UINT            m_nameId;
+    TimerChildTable m_children;
 
     CpuTimer        m_cpu;
     GpuTimer*       m_gpu;
@@ -590,6 +758,23 @@ private:
     TimingEvent*    m_next;
 };
 
+// one tree of timing events: the main thread's tree, or one lane of worker thread timings
+struct TimerTree
+{
+    TimerTree() : m_Root( NULL ), m_Current( NULL ), m_Unused( NULL ) {}
+
+    TimingEvent*    m_Root;     // timer tree
+    TimingEvent*    m_Current;  // current position in timer tree
+    TimingEvent*    m_Unused;   // unused timers (for faster reuse)
+    TimerChildTable m_RootChildren;
+
+private:
+    TimerTree( const TimerTree& );
+    TimerTree& operator=( const TimerTree& );
+};
+
+struct TimerLane;
+
 class TimerEx
 {
 public:
@@ -608,23 +793,91 @@ public:
     void            Destroy         ( );                        // to be called when the ID3D11Device* gets destroyed
     void            Reset           ( bool bResetSum );         // to be called one a frame, preferably on frame switch (flip)
     void            Start           ( LPCWSTR timerId );        // looks for the child in the tree structure, if not found adds another child
+    void            Start           ( UINT nameId );            // as above, with a name already interned by InternName
     void            Stop            ( );
     double          GetTime         ( TimerType type, LPCWSTR timerId, bool stall = false );
     double          GetAvgTime      ( TimerType type, LPCWSTR timerId, bool stall = false );
+    const TimerStats* GetStats      ( TimerType type, LPCWSTR timerId ); // NULL if there is no such timer
     TimingEvent*    GetTimer        ( LPCWSTR timerId = NULL ); // returns the first child of root if NULL, else searches childnodes for timer with that name
 
+    // clears the statistics of all timers, e.g. when a setting changes what is measured
+    void            ResetStats      ( );
+    // writes the statistics of all timers as CSV, one line per timer and type, times in milliseconds,
+    // plus the most frames of latency seen by GPU timers
+    bool            WriteStats      ( LPCWSTR fileName );
+    // writes the results of MeasureScopeOverhead and MeasureZoneOverhead as CSV, one line per measurement, in nanoseconds
+    bool            WriteOverhead   ( LPCWSTR fileName );
+
+    static const UINT InvalidNameId = 0xFFFFFFFF;
+
+    UINT            InternName      ( LPCWSTR name );           // returns the ID of name, adding it the first time it is seen
+    UINT            FindName        ( LPCWSTR name, size_t len ) const; // returns the ID of the first len characters of name, or InvalidNameId
+    LPCWSTR         GetNameString   ( UINT nameId ) const;
+
+    // runs numIterations nested Start/Stop pairs on a scratch tree (CPU only) and returns the cost of one
+    // pair in nanoseconds; optionally also the cost of a GetTime lookup by path. Call outside of any timer
+    double          MeasureScopeOverhead( UINT numIterations = 100000, double* pGetTimeNs = NULL );
+    // as above for nested TimerZone< 1 > zones; optionally also the cost of a TimerZone< 0 >, which should be 0
+    double          MeasureZoneOverhead ( UINT numIterations = 100000, double* pDisabledNs = NULL );
+
+    // interns the name of a TIMER_Zone site and stores its ID in the site, returns the ID
+    UINT            RegisterZone    ( TimerZoneSite& site );
+    UINT            GetNumZoneSites ( ) const;
+    const TimerZoneSite* GetZoneSite( UINT index ) const;
+
+    // Start/Stop may be called from any thread. The thread that called Init records into the main tree,
+    // with GPU timers; every other thread records CPU times into its own lock-free buffer, which Reset
+    // merges into that thread's lane. So lane times are those of the previous frame.
+    void            SetThreadName   ( LPCWSTR name );           // names the calling thread's lane
+    UINT            GetNumLanes     ( );
+    LPCWSTR         GetLaneName     ( UINT lane );
+    DWORD           GetLaneThreadId ( UINT lane );
+    TimingEvent*    GetLaneTimer    ( UINT lane, LPCWSTR timerId = NULL );
+    double          GetTotalCpuTime ( LPCWSTR timerId );        // CPU time of a timer summed over the main tree and all lanes
+    UINT            GetNumDroppedEvents( );                     // timers not recorded because a thread's buffer was full
+
+    // frame capture ring, for Chrome trace / Perfetto dumps of the last frames
+    AMD::TimerCapture& GetCapture   ( ) { return m_Capture; }
+
 private:
     TimerEx             ( );
     virtual ~TimerEx    ( );
 
-    void Reset          ( TimingEvent* te, bool bResetSum );
+    TimingEvent* Begin  ( TimerTree& tree, UINT nameId, ID3D11Device* pDev );
+    void Reset          ( TimerTree& tree, TimingEvent* te, bool bResetSum );
+    void RebuildChildTable( TimerTree& tree, TimingEvent* parent );
     void DeleteTimerTree( TimingEvent* te );
+    void DeleteTree     ( TimerTree& tree );
+
+    TimerLane* GetThreadLane( );
+    TimerLane* GetLane  ( UINT lane );
+    void MergeLane      ( TimerLane* lane, UINT laneIndex, bool bResetSum );
+    void ResetStats     ( TimingEvent* te );
+    void WriteStats     ( FILE* file, TimingEvent* te, const std::wstring& lane, const std::wstring& parentPath );
+
+    static UINT HashName( LPCWSTR name, size_t len );
+    UINT FindNameLocked ( LPCWSTR name, size_t len, UINT hash ) const;
+    UINT InternName     ( LPCWSTR name, size_t len, UINT hash );
 
 protected:
     ID3D11Device*   m_pDev;
-    TimingEvent*    m_Root;     // timer tree
-    TimingEvent*    m_Current;  // current position in timer tree
-    TimingEvent*    m_Unused;   // unused timers (for faster reuse)
+    TimerTree       m_MainTree;
+    TimerTree*      m_pTree;    // m_MainTree, or a scratch tree while measuring overhead
+    bool            m_bCpuOnly; // set while measuring overhead, so no GPU timers are created
+    AMD::TimerCapture m_Capture;
+
+    // worker thread lanes
+    DWORD                   m_MainThreadId;
+    DWORD                   m_TlsIndex;
+    std::vector<TimerLane*> m_Lanes;
+    CRITICAL_SECTION        m_LanesLock;
+
+    // interned timer names, shared by all threads
+    std::vector<LPWSTR> m_Names;        // name ID -> name
+    std::vector<UINT>   m_NameHashes;   // name ID -> hash
+    std::vector<UINT>   m_NameSlots;    // open addressed hash table of name ID + 1, 0 is empty
+    std::vector<const TimerZoneSite*> m_ZoneSites; // registered TIMER_Zone sites
+    mutable SRWLOCK     m_NamesLock;        // also guards m_ZoneSites
 };
 
 #if ENABLE_AMD_TIMER
@@ -649,6 +902,27 @@ protected:
 #define TIMER_GetAvgTime( Cpu_Gpu, name )               \
     TimerEx::Instance( ).GetAvgTime( tt##Cpu_Gpu, name )
 
+#define TIMER_GetStats( Cpu_Gpu, name )             \
+    TimerEx::Instance( ).GetStats( tt##Cpu_Gpu, name )
+
+#define TIMER_ResetStats( )                         \
+    TimerEx::Instance( ).ResetStats( );
+
+#define TIMER_WriteStats( fileName )                \
+    TimerEx::Instance( ).WriteStats( fileName )
+
+#define TIMER_WriteOverhead( fileName )             \
+    TimerEx::Instance( ).WriteOverhead( fileName )
+
+#define TIMER_SetThreadName( name )                 \
+    TimerEx::Instance( ).SetThreadName( name );
+
+#define TIMER_EnableCapture( numFrames )            \
+    TimerEx::Instance( ).GetCapture( ).Enable( numFrames );
+
+#define TIMER_DumpCapture( )                        \
+    TimerEx::Instance( ).GetCapture( ).RequestDump( );
+
 // makros, analogue to PIX
 #define TIMER_Begin( col, name )                    \
     TimerEx::Instance( ).Start( name );
@@ -666,6 +940,13 @@ protected:
 #define TIMER_GetTime( Cpu_Gpu, name )          0
 #define TIMER_WaitForGpuAndGetTime( name )      0
 #define TIMER_GetAvgTime( Cpu_Gpu, name )       0
+#define TIMER_GetStats( Cpu_Gpu, name )         ((const TimerStats*)NULL)
+#define TIMER_ResetStats( )
+#define TIMER_WriteStats( fileName )            false
+#define TIMER_WriteOverhead( fileName )         false
+#define TIMER_SetThreadName( name )
+#define TIMER_EnableCapture( numFrames )
+#define TIMER_DumpCapture( )
 #define TIMER_Begin( col, name )
 #define TIMER_End( )
 #endif
@@ -678,12 +959,67 @@ public:
         (void)&col;
         TIMER_Begin( col, name );
     }
-    virtual ~TimerExHelper( )
+    ~TimerExHelper( )
     {
         TIMER_End( );
     }
 };
 
+// the scoped timer of TIMER_Zone, starts the site's timer by ID and stops it at the end of the scope
+template <int Enabled>
+class TimerZone
+{
+public:
+    explicit TimerZone( TimerZoneSite& site )
+    {
+        UINT nameId = site.m_nameId;
+        if (TimerEx::InvalidNameId == nameId)
+        {
+            nameId = TimerEx::Instance( ).RegisterZone( site );
+        }
+        TimerEx::Instance( ).Start( nameId );
+    }
+    ~TimerZone( )
+    {
+        TimerEx::Instance( ).Stop( );
+    }
+
+private:
+    TimerZone( const TimerZone& );
+    TimerZone& operator=( const TimerZone& );
+};
+
+// a compiled out zone
+template <>
+class TimerZone<0>
+{
+public:
+    explicit TimerZone( TimerZoneSite& ) {}
+};
+
+// specialize this to switch a category on or off regardless of AMD_TIMER_CATEGORIES
+template <UINT Category>
+struct TimerCategoryEnabled
+{
+    enum { value = (ENABLE_AMD_TIMER && 0 != (Category & (AMD_TIMER_CATEGORIES))) ? 1 : 0 };
+};
+
+#define AMD_TIMER_CONCAT_( a, b )   a##b
+#define AMD_TIMER_CONCAT( a, b )    AMD_TIMER_CONCAT_( a, b )
+
+#if AMD_TIMER_HAVE_CONSTEXPR
+#define AMD_TIMER_HASH( name )      TimerHashName( name )
+#else
+#define AMD_TIMER_HASH( name )      0
+#endif
+
+// L"" name only compiles for a string literal, which the static site may keep the pointer to
+#define TIMER_Zone( category, name )                                                                \
+    static TimerZoneSite AMD_TIMER_CONCAT( __timer_zone_site_, __LINE__ ) =                         \
+        { L"" name, __FILE__, __LINE__, category, AMD_TIMER_HASH( L"" name ), TimerEx::InvalidNameId }; \
+    TimerZone< TimerCategoryEnabled< category >::value >                                            \
+        AMD_TIMER_CONCAT( __timer_zone_, __LINE__ )( AMD_TIMER_CONCAT( __timer_zone_site_, __LINE__ ) );
+
 #if ENABLE_AMD_TIMER
 #define TIMER_ProfileCodeBlock( col, name )         \
     TimerExHelper __codeblock_timer( col, name );
@@ -0,0 +1,731 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: TimerCapture.cpp
+//
+// Implementation of the TimerEx frame capture ring and its trace exporters.
+//--------------------------------------------------------------------------------------
+#include "..\\..\\DXUT\\Core\\DXUT.h"
+#include "Timer.h"
+#include "TimerCapture.h"
+
+using namespace AMD;
+
+namespace
+{
+    // GPU results usually arrive within this many frames
+    const unsigned int kGpuLatencyFrames = 4;
+
+    // Event index bits in a GpuTimer tag; the rest is the frame number + 1
+    const unsigned int kTagIndexBits = 24;
+
+    const unsigned short kGpuLane = 0xFFFF;
+
+    const unsigned long long kInvalidFrame = ~0ULL;
+
+    struct SortByFrameNumber
+    {
+        template< typename T >
+        bool operator()( const T* pA, const T* pB ) const { return pA->m_ullNumber < pB->m_ullNumber; }
+    };
+
+    //--------------------------------------------------------------------------------------
+    // Minimal protobuf encoding, enough for Perfetto's TracePacket, TrackDescriptor and TrackEvent
+    //--------------------------------------------------------------------------------------
+    enum
+    {
+        kWireVarint = 0,
+        kWireBytes = 2,
+    };
+
+    void WriteVarint( std::string& io_Buffer, unsigned long long ullValue )
+    {
+        while (ullValue >= 0x80)
+        {
+            io_Buffer.push_back( (char)((ullValue & 0x7F) | 0x80) );
+            ullValue >>= 7;
+        }
+        io_Buffer.push_back( (char)ullValue );
+    }
+
+    void WriteVarintField( std::string& io_Buffer, unsigned int uField, unsigned long long ullValue )
+    {
+        WriteVarint( io_Buffer, (uField << 3) | kWireVarint );
+        WriteVarint( io_Buffer, ullValue );
+    }
+
+    void WriteBytesField( std::string& io_Buffer, unsigned int uField, const std::string& i_Bytes )
+    {
+        WriteVarint( io_Buffer, (uField << 3) | kWireBytes );
+        WriteVarint( io_Buffer, i_Bytes.size() );
+        io_Buffer.append( i_Bytes );
+    }
+
+    // Field numbers from perfetto/protos/perfetto/trace
+    enum
+    {
+        kTrace_Packet = 1,
+
+        kTracePacket_Timestamp = 8,
+        kTracePacket_TrustedPacketSequenceId = 10,
+        kTracePacket_TrackEvent = 11,
+        kTracePacket_SequenceFlags = 13,
+        kTracePacket_TrackDescriptor = 60,
+
+        kTrackDescriptor_Uuid = 1,
+        kTrackDescriptor_Name = 2,
+
+        kTrackEvent_Type = 9,
+        kTrackEvent_TrackUuid = 11,
+        kTrackEvent_Name = 23,
+
+        kTrackEventType_SliceBegin = 1,
+        kTrackEventType_SliceEnd = 2,
+
+        kSequenceFlags_IncrementalStateCleared = 1,
+
+        kTrackUuidBase = 1000,
+    };
+
+    // One end of a slice, for sorting into timestamp order
+    struct PerfettoSliceEdge
+    {
+        unsigned long long  m_ullTimestamp;
+        unsigned int        m_uTrack;
+        unsigned int        m_uDepth;
+        unsigned int        m_uName;        // index into the name table
+        bool                m_bBegin;
+
+        // at equal times, ends come before begins, inner ends before outer ends, and outer begins before inner begins
+        bool operator<( const PerfettoSliceEdge& i_Other ) const
+        {
+            if (m_ullTimestamp != i_Other.m_ullTimestamp) { return m_ullTimestamp < i_Other.m_ullTimestamp; }
+            if (m_bBegin != i_Other.m_bBegin) { return !m_bBegin; }
+            return m_bBegin ? (m_uDepth < i_Other.m_uDepth) : (m_uDepth > i_Other.m_uDepth);
+        }
+    };
+
+    std::string ToUTF8( const wchar_t* pwsString )
+    {
+        std::string utf8;
+        int iLength = (NULL != pwsString) ? WideCharToMultiByte( CP_UTF8, 0, pwsString, -1, NULL, 0, NULL, NULL ) : 0;
+        if (iLength > 1)
+        {
+            utf8.resize( iLength );
+            WideCharToMultiByte( CP_UTF8, 0, pwsString, -1, &utf8[0], iLength, NULL, NULL );
+            utf8.resize( iLength - 1 );
+        }
+        return utf8;
+    }
+
+    void WriteJSONString( FILE* pFile, const std::string& i_String )
+    {
+        fputc( '"', pFile );
+        for (size_t i = 0; i < i_String.size(); i++)
+        {
+            const unsigned char c = (unsigned char)i_String[i];
+            if ((c == '"') || (c == '\\'))
+            {
+                fputc( '\\', pFile );
+                fputc( c, pFile );
+            }
+            else if (c < 0x20)
+            {
+                fprintf( pFile, "\\u%04x", c );
+            }
+            else
+            {
+                fputc( c, pFile );
+            }
+        }
+        fputc( '"', pFile );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Constructor
+//--------------------------------------------------------------------------------------
+TimerCapture::TimerCapture()
+    : m_bEnabled( false )
+    , m_ullFrameNumber( 0 )
+    , m_fSpikeFactor( 0.0 )
+    , m_fSpikeMinMs( 0.0 )
+    , m_uSpikeFramesAfter( 10 )
+    , m_fAverageFrameMs( 0.0 )
+    , m_uDumpCountdown( 0 )
+    , m_OutputPrefix( L"TimerCapture" )
+    , m_uNumDumps( 0 )
+{
+    m_fTickFrequency = CpuClock::GetFrequency();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Destructor
+//--------------------------------------------------------------------------------------
+TimerCapture::~TimerCapture()
+{
+}
+
+
+//--------------------------------------------------------------------------------------
+// Starts capturing. The frames are allocated here, and their event lists keep their
+// capacity when reused, so capturing doesn't allocate once the ring has filled up
+//--------------------------------------------------------------------------------------
+void TimerCapture::Enable( unsigned int uNumFrames )
+{
+    _ASSERT( uNumFrames > 0 );
+
+    Frame empty;
+    empty.m_ullNumber = kInvalidFrame;
+    empty.m_llBegin = 0;
+    empty.m_llEnd = 0;
+
+    m_Frames.assign( std::max( uNumFrames, 1u ), empty );
+    m_OpenEvents.clear();
+    m_fAverageFrameMs = 0.0;
+    m_uDumpCountdown = 0;
+
+    Frame& frame = CurrentFrame();
+    frame.m_ullNumber = m_ullFrameNumber;
+    frame.m_llBegin = CpuClock::Now();
+
+    m_bEnabled = true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Stops capturing and frees the ring
+//--------------------------------------------------------------------------------------
+void TimerCapture::Disable()
+{
+    m_bEnabled = false;
+    m_Frames.clear();
+    m_OpenEvents.clear();
+    m_uDumpCountdown = 0;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Sets up the automatic dump on a frame time spike
+//--------------------------------------------------------------------------------------
+void TimerCapture::SetSpikeTrigger( double fFactor, double fMinFrameMs, unsigned int uFramesAfter )
+{
+    m_fSpikeFactor = fFactor;
+    m_fSpikeMinMs = fMinFrameMs;
+    m_uSpikeFramesAfter = uFramesAfter;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Dumps the ring a few frames from now, once the GPU has caught up
+//--------------------------------------------------------------------------------------
+void TimerCapture::RequestDump()
+{
+    if (m_bEnabled && 0 == m_uDumpCountdown)
+    {
+        m_uDumpCountdown = kGpuLatencyFrames;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// A main thread scope begins
+//--------------------------------------------------------------------------------------
+unsigned long long TimerCapture::BeginEvent( unsigned int uNameId, long long llTicks )
+{
+    if (!m_bEnabled)
+    {
+        return 0;
+    }
+
+    Frame& frame = CurrentFrame();
+    const unsigned int kuIndex = (unsigned int)frame.m_Events.size();
+
+    Event e;
+    e.m_uNameId = uNameId;
+    e.m_uLane = 0;
+    e.m_uDepth = (unsigned short)m_OpenEvents.size();
+    e.m_llCpuBegin = llTicks;
+    e.m_llCpuEnd = llTicks;
+    e.m_ullGpuBegin = 0;
+    e.m_ullGpuEnd = 0;
+    e.m_ullGpuFrequency = 0;
+    frame.m_Events.push_back( e );
+    m_OpenEvents.push_back( kuIndex );
+
+    return (kuIndex < (1u << kTagIndexBits)) ? (((m_ullFrameNumber + 1) << kTagIndexBits) | kuIndex) : 0;
+}
+
+
+//--------------------------------------------------------------------------------------
+// The innermost open main thread scope ends
+//--------------------------------------------------------------------------------------
+void TimerCapture::EndEvent( long long llTicks )
+{
+    // scopes opened before capturing was enabled have no event
+    if (!m_bEnabled || m_OpenEvents.empty())
+    {
+        return;
+    }
+
+    CurrentFrame().m_Events[m_OpenEvents.back()].m_llCpuEnd = llTicks;
+    m_OpenEvents.pop_back();
+}
+
+
+//--------------------------------------------------------------------------------------
+// A worker thread scope, merged by TimerEx::Reset
+//--------------------------------------------------------------------------------------
+void TimerCapture::AddLaneEvent( unsigned int uLane, unsigned int uNameId, unsigned int uDepth, long long llBegin, long long llEnd )
+{
+    if (!m_bEnabled)
+    {
+        return;
+    }
+
+    Event e;
+    e.m_uNameId = uNameId;
+    e.m_uLane = (unsigned short)uLane;
+    e.m_uDepth = (unsigned short)uDepth;
+    e.m_llCpuBegin = llBegin;
+    e.m_llCpuEnd = llEnd;
+    e.m_ullGpuBegin = 0;
+    e.m_ullGpuEnd = 0;
+    e.m_ullGpuFrequency = 0;
+    CurrentFrame().m_Events.push_back( e );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Called by TimerEx::Reset: finishes the current frame, checks for a spike, writes a
+// pending dump, and starts the next frame
+//--------------------------------------------------------------------------------------
+void TimerCapture::EndFrame( long long llTicks )
+{
+    if (!m_bEnabled)
+    {
+        return;
+    }
+
+    Frame& frame = CurrentFrame();
+    frame.m_llEnd = llTicks;
+
+    const double kfFrameMs = (double)(frame.m_llEnd - frame.m_llBegin) * 1000.0 / m_fTickFrequency;
+
+    if (m_fSpikeFactor > 0.0 && m_fAverageFrameMs > 0.0 && 0 == m_uDumpCountdown &&
+        kfFrameMs > m_fSpikeFactor * m_fAverageFrameMs && kfFrameMs >= m_fSpikeMinMs)
+    {
+        wchar_t wsMessage[256];
+        swprintf_s( wsMessage, L"TimerCapture: frame %llu took %.2fms (average %.2fms), dumping\n", frame.m_ullNumber, kfFrameMs, m_fAverageFrameMs );
+        OutputDebugStringW( wsMessage );
+
+        m_uDumpCountdown = std::max( m_uSpikeFramesAfter, kGpuLatencyFrames );
+    }
+
+    m_fAverageFrameMs = (m_fAverageFrameMs > 0.0) ? (m_fAverageFrameMs * 0.95 + kfFrameMs * 0.05) : kfFrameMs;
+
+    if (0 != m_uDumpCountdown && 0 == --m_uDumpCountdown)
+    {
+        WriteDump();
+    }
+
+    ++m_ullFrameNumber;
+
+    Frame& next = CurrentFrame();
+    next.m_ullNumber = m_ullFrameNumber;
+    next.m_llBegin = llTicks;
+    next.m_llEnd = 0;
+    next.m_Events.clear();
+    m_OpenEvents.clear();
+}
+
+
+//--------------------------------------------------------------------------------------
+// GpuTimer callback, when the timestamps of a tagged scope have come back
+//--------------------------------------------------------------------------------------
+void TimerCapture::OnGpuTimestamps( void* pUserData, unsigned long long ullTag, unsigned long long ullBegin, unsigned long long ullEnd, unsigned long long ullFrequency )
+{
+    TimerCapture* pCapture = (TimerCapture*)pUserData;
+    if (!pCapture->m_bEnabled || 0 == ullTag)
+    {
+        return;
+    }
+
+    const unsigned long long kullNumber = (ullTag >> kTagIndexBits) - 1;
+    const unsigned int kuIndex = (unsigned int)(ullTag & ((1u << kTagIndexBits) - 1));
+
+    // the frame may have been overwritten since, if the GPU is far behind
+    Frame& frame = pCapture->m_Frames[kullNumber % pCapture->m_Frames.size()];
+    if (frame.m_ullNumber != kullNumber || kuIndex >= frame.m_Events.size())
+    {
+        return;
+    }
+
+    Event& e = frame.m_Events[kuIndex];
+    e.m_ullGpuBegin = ullBegin;
+    e.m_ullGpuEnd = ullEnd;
+    e.m_ullGpuFrequency = ullFrequency;
+}
+
+
+//--------------------------------------------------------------------------------------
+// The completed frames in the ring, oldest first
+//--------------------------------------------------------------------------------------
+void TimerCapture::GetDumpFrames( std::vector<const Frame*>& o_Frames ) const
+{
+    o_Frames.clear();
+    for (size_t i = 0; i < m_Frames.size(); ++i)
+    {
+        if (kInvalidFrame != m_Frames[i].m_ullNumber && 0 != m_Frames[i].m_llEnd)
+        {
+            o_Frames.push_back( &m_Frames[i] );
+        }
+    }
+    std::sort( o_Frames.begin(), o_Frames.end(), SortByFrameNumber() );
+}
+
+
+//--------------------------------------------------------------------------------------
+// One track per lane that has events, plus one for the GPU if any GPU results are in
+//--------------------------------------------------------------------------------------
+void TimerCapture::GetTracks( const std::vector<const Frame*>& i_Frames, std::vector<Track>& o_Tracks, unsigned int& o_uGpuTrack ) const
+{
+    std::vector<bool> lanesUsed;
+    bool bGpuUsed = false;
+
+    for (size_t i = 0; i < i_Frames.size(); ++i)
+    {
+        const std::vector<Event>& events = i_Frames[i]->m_Events;
+        for (size_t j = 0; j < events.size(); ++j)
+        {
+            if (events[j].m_uLane >= lanesUsed.size())
+            {
+                lanesUsed.resize( events[j].m_uLane + 1, false );
+            }
+            lanesUsed[events[j].m_uLane] = true;
+            bGpuUsed = bGpuUsed || (0 != events[j].m_ullGpuFrequency);
+        }
+    }
+
+    o_Tracks.clear();
+    for (unsigned int uLane = 0; uLane < (unsigned int)lanesUsed.size(); ++uLane)
+    {
+        if (lanesUsed[uLane])
+        {
+            Track track;
+            track.m_uLane = uLane;
+
+            LPCWSTR pwsName = (0 == uLane) ? L"Main thread" : TimerEx::Instance().GetLaneName( uLane - 1 );
+            track.m_Name = (NULL != pwsName) ? pwsName : L"Thread";
+            o_Tracks.push_back( track );
+        }
+    }
+
+    o_uGpuTrack = (unsigned int)o_Tracks.size();
+    if (bGpuUsed)
+    {
+        Track track;
+        track.m_uLane = kGpuLane;
+        track.m_Name = L"GPU";
+        o_Tracks.push_back( track );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// The GPU clock can't be read from the CPU in D3D11, so the GPU timeline is placed by
+// lining up the first GPU scope with the CPU begin of the same scope
+//--------------------------------------------------------------------------------------
+bool TimerCapture::GetGpuAnchor( const std::vector<const Frame*>& i_Frames, unsigned long long& o_ullGpuTicks, double& o_fCpuNs ) const
+{
+    for (size_t i = 0; i < i_Frames.size(); ++i)
+    {
+        const std::vector<Event>& events = i_Frames[i]->m_Events;
+        for (size_t j = 0; j < events.size(); ++j)
+        {
+            if (0 != events[j].m_ullGpuFrequency)
+            {
+                o_ullGpuTicks = events[j].m_ullGpuBegin;
+                o_fCpuNs = TicksToNs( events[j].m_llCpuBegin );
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Exports the ring as Chrome trace events, one row per lane plus one for the GPU and
+// one for the frames
+//--------------------------------------------------------------------------------------
+bool TimerCapture::ExportChromeTrace( const wchar_t* pwsPath ) const
+{
+    std::vector<const Frame*> frames;
+    GetDumpFrames( frames );
+    if (frames.empty())
+    {
+        return false;
+    }
+
+    FILE* pFile = NULL;
+    _wfopen_s( &pFile, pwsPath, L"wt" );
+    if (!pFile)
+    {
+        return false;
+    }
+
+    std::vector<Track> tracks;
+    unsigned int uGpuTrack = 0;
+    GetTracks( frames, tracks, uGpuTrack );
+
+    unsigned long long ullAnchorTicks = 0;
+    double fAnchorNs = 0.0;
+    GetGpuAnchor( frames, ullAnchorTicks, fAnchorNs );
+
+    // times in microseconds from the start of the first frame
+    const double kfOriginNs = TicksToNs( frames[0]->m_llBegin );
+
+    fprintf( pFile, "{\n\"displayTimeUnit\": \"ms\",\n\"traceEvents\": [" );
+    fprintf( pFile, "\n{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": { \"name\": \"Frames\" } }" );
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        fprintf( pFile, ",\n{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": { \"name\": ", (unsigned int)i + 1 );
+        WriteJSONString( pFile, ToUTF8( tracks[i].m_Name.c_str() ) );
+        fprintf( pFile, " } }" );
+    }
+
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        const Frame& frame = *frames[i];
+
+        fprintf( pFile, ",\n{ \"name\": \"Frame %llu\", \"ph\": \"X\", \"pid\": 1, \"tid\": 0, \"ts\": %.3f, \"dur\": %.3f }",
+            frame.m_ullNumber, (TicksToNs( frame.m_llBegin ) - kfOriginNs) * 1.0e-3, TicksToNs( frame.m_llEnd - frame.m_llBegin ) * 1.0e-3 );
+
+        for (size_t j = 0; j < frame.m_Events.size(); ++j)
+        {
+            const Event& e = frame.m_Events[j];
+            const std::string name = ToUTF8( TimerEx::Instance().GetNameString( e.m_uNameId ) );
+
+            unsigned int uTrack = 0;
+            while (uTrack < uGpuTrack && tracks[uTrack].m_uLane != e.m_uLane)
+            {
+                ++uTrack;
+            }
+
+            fprintf( pFile, ",\n{ \"name\": " );
+            WriteJSONString( pFile, name );
+            fprintf( pFile, ", \"cat\": \"cpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f }",
+                uTrack + 1, (TicksToNs( e.m_llCpuBegin ) - kfOriginNs) * 1.0e-3, TicksToNs( e.m_llCpuEnd - e.m_llCpuBegin ) * 1.0e-3 );
+
+            if (0 != e.m_ullGpuFrequency)
+            {
+                const double kfGpuBeginNs = GpuToNs( e, e.m_ullGpuBegin, ullAnchorTicks, fAnchorNs );
+                const double kfGpuEndNs = GpuToNs( e, e.m_ullGpuEnd, ullAnchorTicks, fAnchorNs );
+
+                fprintf( pFile, ",\n{ \"name\": " );
+                WriteJSONString( pFile, name );
+                fprintf( pFile, ", \"cat\": \"gpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f }",
+                    uGpuTrack + 1, (kfGpuBeginNs - kfOriginNs) * 1.0e-3, (kfGpuEndNs - kfGpuBeginNs) * 1.0e-3 );
+            }
+        }
+    }
+
+    fprintf( pFile, "\n]\n}\n" );
+    fclose( pFile );
+
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Exports the ring as a Perfetto trace: one track descriptor per lane, the GPU and the
+// frames, then slice begin/end track events in timestamp order
+//--------------------------------------------------------------------------------------
+bool TimerCapture::ExportPerfetto( const wchar_t* pwsPath ) const
+{
+    std::vector<const Frame*> frames;
+    GetDumpFrames( frames );
+    if (frames.empty())
+    {
+        return false;
+    }
+
+    std::vector<Track> tracks;
+    unsigned int uGpuTrack = 0;
+    GetTracks( frames, tracks, uGpuTrack );
+
+    // the frames get the last track
+    const unsigned int kuFrameTrack = (unsigned int)tracks.size();
+    Track frameTrack;
+    frameTrack.m_uLane = kGpuLane;
+    frameTrack.m_Name = L"Frames";
+    tracks.push_back( frameTrack );
+
+    unsigned long long ullAnchorTicks = 0;
+    double fAnchorNs = 0.0;
+    GetGpuAnchor( frames, ullAnchorTicks, fAnchorNs );
+
+    // names are stored once; frame names go after the timer names
+    std::vector<std::string> names;
+    std::vector<unsigned int> nameIndices;      // timer name ID -> index into names, + 1
+    std::vector<PerfettoSliceEdge> edges;
+
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        const Frame& frame = *frames[i];
+
+        char szFrameName[64];
+        sprintf_s( szFrameName, "Frame %llu", frame.m_ullNumber );
+        names.push_back( szFrameName );
+
+        PerfettoSliceEdge edge;
+        edge.m_uTrack = kuFrameTrack;
+        edge.m_uDepth = 0;
+        edge.m_uName = (unsigned int)names.size() - 1;
+        edge.m_bBegin = true;
+        edge.m_ullTimestamp = (unsigned long long)TicksToNs( frame.m_llBegin );
+        edges.push_back( edge );
+        edge.m_bBegin = false;
+        edge.m_ullTimestamp = (unsigned long long)TicksToNs( frame.m_llEnd );
+        edges.push_back( edge );
+
+        for (size_t j = 0; j < frame.m_Events.size(); ++j)
+        {
+            const Event& e = frame.m_Events[j];
+
+            if (e.m_uNameId >= nameIndices.size())
+            {
+                nameIndices.resize( e.m_uNameId + 1, 0 );
+            }
+            if (0 == nameIndices[e.m_uNameId])
+            {
+                names.push_back( ToUTF8( TimerEx::Instance().GetNameString( e.m_uNameId ) ) );
+                nameIndices[e.m_uNameId] = (unsigned int)names.size();
+            }
+
+            unsigned int uTrack = 0;
+            while (uTrack < uGpuTrack && tracks[uTrack].m_uLane != e.m_uLane)
+            {
+                ++uTrack;
+            }
+
+            edge.m_uTrack = uTrack;
+            edge.m_uDepth = e.m_uDepth;
+            edge.m_uName = nameIndices[e.m_uNameId] - 1;
+            edge.m_bBegin = true;
+            edge.m_ullTimestamp = (unsigned long long)TicksToNs( e.m_llCpuBegin );
+            edges.push_back( edge );
+            edge.m_bBegin = false;
+            edge.m_ullTimestamp = (unsigned long long)TicksToNs( e.m_llCpuEnd );
+            edges.push_back( edge );
+
+            if (0 != e.m_ullGpuFrequency)
+            {
+                edge.m_uTrack = uGpuTrack;
+                edge.m_bBegin = true;
+                edge.m_ullTimestamp = (unsigned long long)std::max( 0.0, GpuToNs( e, e.m_ullGpuBegin, ullAnchorTicks, fAnchorNs ) );
+                edges.push_back( edge );
+                edge.m_bBegin = false;
+                edge.m_ullTimestamp = (unsigned long long)std::max( 0.0, GpuToNs( e, e.m_ullGpuEnd, ullAnchorTicks, fAnchorNs ) );
+                edges.push_back( edge );
+            }
+        }
+    }
+
+    std::stable_sort( edges.begin(), edges.end() );
+
+    // build the trace in memory, then write it in one go
+    std::string trace;
+    std::string packet;
+    std::string message;
+
+    for (size_t i = 0; i < tracks.size(); ++i)
+    {
+        message.clear();
+        WriteVarintField( message, kTrackDescriptor_Uuid, kTrackUuidBase + i );
+        WriteBytesField( message, kTrackDescriptor_Name, ToUTF8( tracks[i].m_Name.c_str() ) );
+
+        packet.clear();
+        WriteVarintField( packet, kTracePacket_TrustedPacketSequenceId, 1 );
+        if (0 == i)
+        {
+            WriteVarintField( packet, kTracePacket_SequenceFlags, kSequenceFlags_IncrementalStateCleared );
+        }
+        WriteBytesField( packet, kTracePacket_TrackDescriptor, message );
+        WriteBytesField( trace, kTrace_Packet, packet );
+    }
+
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        const PerfettoSliceEdge& edge = edges[i];
+
+        message.clear();
+        WriteVarintField( message, kTrackEvent_Type, edge.m_bBegin ? kTrackEventType_SliceBegin : kTrackEventType_SliceEnd );
+        WriteVarintField( message, kTrackEvent_TrackUuid, kTrackUuidBase + edge.m_uTrack );
+        if (edge.m_bBegin)
+        {
+            WriteBytesField( message, kTrackEvent_Name, names[edge.m_uName] );
+        }
+
+        packet.clear();
+        WriteVarintField( packet, kTracePacket_Timestamp, edge.m_ullTimestamp );
+        WriteVarintField( packet, kTracePacket_TrustedPacketSequenceId, 1 );
+        WriteBytesField( packet, kTracePacket_TrackEvent, message );
+        WriteBytesField( trace, kTrace_Packet, packet );
+    }
+
+    FILE* pFile = NULL;
+    _wfopen_s( &pFile, pwsPath, L"wb" );
+    if (!pFile)
+    {
+        return false;
+    }
+
+    const bool kbWritten = (fwrite( trace.data(), 1, trace.size(), pFile ) == trace.size());
+    fclose( pFile );
+
+    return kbWritten;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Writes both trace formats, numbered so earlier dumps aren't overwritten
+//--------------------------------------------------------------------------------------
+void TimerCapture::WriteDump()
+{
+    wchar_t wsJSON[MAX_PATH];
+    wchar_t wsPerfetto[MAX_PATH];
+    swprintf_s( wsJSON, L"%ls_%u.json", m_OutputPrefix.c_str(), m_uNumDumps );
+    swprintf_s( wsPerfetto, L"%ls_%u.perfetto-trace", m_OutputPrefix.c_str(), m_uNumDumps );
+
+    const bool kbJSON = ExportChromeTrace( wsJSON );
+    const bool kbPerfetto = ExportPerfetto( wsPerfetto );
+    ++m_uNumDumps;
+
+    wchar_t wsMessage[MAX_PATH * 2 + 64];
+    swprintf_s( wsMessage, L"TimerCapture: %ls %ls, %ls %ls\n", wsJSON, kbJSON ? L"written" : L"failed", wsPerfetto, kbPerfetto ? L"written" : L"failed" );
+    OutputDebugStringW( wsMessage );
+}
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: TimerCapture.h
+//
+// Keeps the last N frames of TimerEx timings as a timeline: every scope with its CPU
+// begin and end, on the main thread and on each worker lane, plus its GPU begin and end
+// once the timestamp queries have come back.
+//
+// The ring can be written out on demand, or automatically when a frame takes much longer
+// than the recent average, as Chrome trace JSON (chrome://tracing) and as a Perfetto
+// protobuf trace (ui.perfetto.dev), so hitches can be inspected offline. Writing is
+// delayed by a few frames, so the GPU results of the frame of interest are in.
+//
+// D3D11 can't correlate GPU and CPU clocks, so the GPU track is aligned with the CPU at
+// the first captured GPU scope.
+//--------------------------------------------------------------------------------------
+#ifndef AMD_SDK_TIMER_CAPTURE_H
+#define AMD_SDK_TIMER_CAPTURE_H
+
+#include <string>
+#include <vector>
+
+namespace AMD
+{
+    class TimerCapture
+    {
+    public:
+
+        TimerCapture();
+        ~TimerCapture();
+
+        // Starts capturing into a ring of uNumFrames frames
+        void Enable( unsigned int uNumFrames = 120 );
+        void Disable();
+        bool IsEnabled() const { return m_bEnabled; }
+
+        // Dumps automatically when a frame takes more than fFactor times the average frame time,
+        // and at least fMinFrameMs, after recording uFramesAfter more frames. A factor of 0 disables it
+        void SetSpikeTrigger( double fFactor, double fMinFrameMs = 0.0, unsigned int uFramesAfter = 10 );
+
+        // Dumps are written to <prefix>_<n>.json and <prefix>_<n>.perfetto-trace
+        void SetOutputPrefix( const wchar_t* pwsPrefix ) { m_OutputPrefix = pwsPrefix; }
+
+        // Dumps the ring once the GPU results of the current frame are available
+        void RequestDump();
+        unsigned int GetNumDumps() const { return m_uNumDumps; }
+
+        bool ExportChromeTrace( const wchar_t* pwsPath ) const;
+        bool ExportPerfetto( const wchar_t* pwsPath ) const;
+
+        // Called by TimerEx, with CpuClock ticks. Lane 0 is the main thread, lane n is TimerEx worker lane n - 1.
+        // BeginEvent returns a tag for the scope's GpuTimer, or 0 when not capturing
+        unsigned long long BeginEvent( unsigned int uNameId, long long llTicks );
+        void EndEvent( long long llTicks );
+        void AddLaneEvent( unsigned int uLane, unsigned int uNameId, unsigned int uDepth, long long llBegin, long long llEnd );
+        void EndFrame( long long llTicks );
+        static void OnGpuTimestamps( void* pUserData, unsigned long long ullTag, unsigned long long ullBegin, unsigned long long ullEnd, unsigned long long ullFrequency );
+
+    private:
+
+        struct Event
+        {
+            unsigned int        m_uNameId;
+            unsigned short      m_uLane;
+            unsigned short      m_uDepth;
+            long long           m_llCpuBegin;
+            long long           m_llCpuEnd;
+            unsigned long long  m_ullGpuBegin;
+            unsigned long long  m_ullGpuEnd;
+            unsigned long long  m_ullGpuFrequency;      // 0 until the GPU results are in
+        };
+
+        struct Frame
+        {
+            unsigned long long  m_ullNumber;
+            long long           m_llBegin;
+            long long           m_llEnd;
+            std::vector<Event>  m_Events;
+        };
+
+        struct Track
+        {
+            unsigned int        m_uLane;                // 0xFFFF for the GPU
+            std::wstring        m_Name;
+        };
+
+        Frame& CurrentFrame() { return m_Frames[m_ullFrameNumber % m_Frames.size()]; }
+        void GetDumpFrames( std::vector<const Frame*>& o_Frames ) const;
+        void GetTracks( const std::vector<const Frame*>& i_Frames, std::vector<Track>& o_Tracks, unsigned int& o_uGpuTrack ) const;
+        bool GetGpuAnchor( const std::vector<const Frame*>& i_Frames, unsigned long long& o_ullGpuTicks, double& o_fCpuNs ) const;
+        double TicksToNs( long long llTicks ) const { return (double)llTicks * 1.0e9 / m_fTickFrequency; }
+        double GpuToNs( const Event& i_Event, unsigned long long ullGpuTicks, unsigned long long ullAnchorTicks, double fAnchorNs ) const
+        {
+            return fAnchorNs + (double)(long long)(ullGpuTicks - ullAnchorTicks) * 1.0e9 / (double)i_Event.m_ullGpuFrequency;
+        }
+        void WriteDump();
+
+        bool                        m_bEnabled;
+        std::vector<Frame>          m_Frames;
+        unsigned long long          m_ullFrameNumber;   // number of the frame being recorded
+        std::vector<unsigned int>   m_OpenEvents;       // main thread scopes that haven't ended yet
+        double                      m_fTickFrequency;
+
+        double                      m_fSpikeFactor;
+        double                      m_fSpikeMinMs;
+        unsigned int                m_uSpikeFramesAfter;
+        double                      m_fAverageFrameMs;
+        unsigned int                m_uDumpCountdown;   // frames until the pending dump is written, 0 if none
+
+        std::wstring                m_OutputPrefix;
+        unsigned int                m_uNumDumps;
+    };
+
+} // namespace AMD
+
+#endif
@@ -17,6 +17,43 @@
  
 #include "crc.h"
 
+#if defined(CRC32)
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define CRC_HAVE_PCLMUL
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(_M_ARM64) || defined(__aarch64__)
+#define CRC_HAVE_ARMV8
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+#endif
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif
+
 
 /*
  * Derive parameters from the standard-specific parameters in crc.h.
@@ -203,7 +240,8 @@ crcInit(void)
  * 
  * Description: Compute the CRC of a given message.
  *
- * Notes:    crcInit() must be called first.
+ * Notes:    crcInit() must be called first, except for CRC32, which
+ *        is forwarded to crcCompute() and needs no setup.
  *
  * Returns:    The CRC of the message.
  *
@@ -211,6 +249,12 @@ crcInit(void)
 crc
 crcFast(unsigned char const message[], int nBytes)
 {
+#if defined(CRC32)
+
+    return (crcCompute(message, (nBytes > 0) ? (unsigned long long) nBytes : 0));
+
+#else
+
     crc             remainder = INITIAL_REMAINDER;
     unsigned char  data;
   int            byte;
@@ -230,4 +274,686 @@ crcFast(unsigned char const message[], int nBytes)
      */
     return (REFLECT_REMAINDER(remainder) ^ FINAL_XOR_VALUE);
 
+#endif
+
 }   /* crcFast() */
+
+
+
+#if defined(CRC32)
+
+/*
+ * The fast CRC-32 implementations below work on the reflected form of
+ * the polynomial, which gives the same results as the code above without
+ * reflecting every byte.  They take and return the running remainder
+ * before the final XOR.
+ */
+#define POLYNOMIAL_REFLECTED  0xEDB88320
+
+typedef unsigned int (*crcUpdateFunc)(unsigned int remainder, unsigned char const * message, size_t nBytes);
+
+static unsigned int  crcTable16[16][256];
+
+
+/*********************************************************************
+ *
+ * Function:    crcUpdateTable()
+ * 
+ * Description: Update a remainder with a message, a byte at a time.
+ *
+ * Notes:    
+ *
+ * Returns:    The new remainder.
+ *
+ *********************************************************************/
+static unsigned int
+crcUpdateTable(unsigned int remainder, unsigned char const * message, size_t nBytes)
+{
+    while (nBytes--)
+    {
+        remainder = crcTable16[0][(remainder ^ *message++) & 0xFF] ^ (remainder >> 8);
+    }
+
+    return (remainder);
+
+}   /* crcUpdateTable() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcUpdateSlice16()
+ * 
+ * Description: Update a remainder with a message, sixteen bytes at a
+ *        time.
+ *
+ * Notes:    Each of the sixteen tables advances one byte's
+ *        contribution past the bytes that follow it, so the
+ *        lookups are independent of each other.  Bytes are
+ *        assembled explicitly, so this works on either byte order.
+ *
+ * Returns:    The new remainder.
+ *
+ *********************************************************************/
+static unsigned int
+crcUpdateSlice16(unsigned int remainder, unsigned char const * message, size_t nBytes)
+{
+    while (nBytes >= 16)
+    {
+        unsigned int  a = remainder ^ ((unsigned int) message[0]
+                                    | ((unsigned int) message[1] << 8)
+                                    | ((unsigned int) message[2] << 16)
+                                    | ((unsigned int) message[3] << 24));
+
+        remainder = crcTable16[15][a & 0xFF]
+                  ^ crcTable16[14][(a >> 8) & 0xFF]
+                  ^ crcTable16[13][(a >> 16) & 0xFF]
+                  ^ crcTable16[12][a >> 24]
+                  ^ crcTable16[11][message[4]]
+                  ^ crcTable16[10][message[5]]
+                  ^ crcTable16[9][message[6]]
+                  ^ crcTable16[8][message[7]]
+                  ^ crcTable16[7][message[8]]
+                  ^ crcTable16[6][message[9]]
+                  ^ crcTable16[5][message[10]]
+                  ^ crcTable16[4][message[11]]
+                  ^ crcTable16[3][message[12]]
+                  ^ crcTable16[2][message[13]]
+                  ^ crcTable16[1][message[14]]
+                  ^ crcTable16[0][message[15]];
+
+        message += 16;
+        nBytes -= 16;
+    }
+
+    return (crcUpdateTable(remainder, message, nBytes));
+
+}   /* crcUpdateSlice16() */
+
+
+#if defined(CRC_HAVE_PCLMUL)
+
+#if defined(__GNUC__)
+#define CRC_TARGET_PCLMUL  __attribute__((target("pclmul,sse4.1")))
+#else
+#define CRC_TARGET_PCLMUL
+#endif
+
+/*********************************************************************
+ *
+ * Function:    crcUpdatePclmul()
+ * 
+ * Description: Update a remainder with a message, by folding 64 bytes
+ *        at a time with carry-less multiplies.
+ *
+ * Notes:    This follows Intel's "Fast CRC Computation for Generic
+ *        Polynomials Using PCLMULQDQ Instruction", with the
+ *        bit-reflected constants for the CRC-32 polynomial.  The
+ *        SSE4.2 crc32 instruction can't be used, as it computes
+ *        CRC-32C, a different polynomial.  Messages shorter than
+ *        64 bytes, and the last nBytes % 16, use slice-by-16.
+ *
+ * Returns:    The new remainder.
+ *
+ *********************************************************************/
+static CRC_TARGET_PCLMUL unsigned int
+crcUpdatePclmul(unsigned int remainder, unsigned char const * message, size_t nBytes)
+{
+    static unsigned long long const  k1k2[2] = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+    static unsigned long long const  k3k4[2] = { 0x01751997d0ULL, 0x00ccaa009eULL };
+    static unsigned long long const  k5k0[2] = { 0x0163cd6124ULL, 0x0000000000ULL };
+    static unsigned long long const  poly[2] = { 0x01db710641ULL, 0x01f7011641ULL };
+
+    __m128i  x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+
+    if (nBytes < 64)
+    {
+        return (crcUpdateSlice16(remainder, message, nBytes));
+    }
+
+    /*
+     * Load the first 64 bytes, with the remainder folded into the first.
+     */
+    x1 = _mm_loadu_si128((__m128i const *) (message + 0x00));
+    x2 = _mm_loadu_si128((__m128i const *) (message + 0x10));
+    x3 = _mm_loadu_si128((__m128i const *) (message + 0x20));
+    x4 = _mm_loadu_si128((__m128i const *) (message + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int) remainder));
+    x0 = _mm_loadu_si128((__m128i const *) k1k2);
+
+    message += 64;
+    nBytes -= 64;
+
+    /*
+     * Fold four lanes in parallel, 64 bytes at a time.
+     */
+    while (nBytes >= 64)
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((__m128i const *) (message + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((__m128i const *) (message + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((__m128i const *) (message + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((__m128i const *) (message + 0x30)));
+
+        message += 64;
+        nBytes -= 64;
+    }
+
+    /*
+     * Fold the four lanes into one.
+     */
+    x0 = _mm_loadu_si128((__m128i const *) k3k4);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    /*
+     * Fold any remaining whole 16 byte blocks.
+     */
+    while (nBytes >= 16)
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((__m128i const *) message)), x5);
+
+        message += 16;
+        nBytes -= 16;
+    }
+
+    /*
+     * Fold 128 bits down to 64.
+     */
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((__m128i const *) k5k0);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    /*
+     * Barrett reduce to 32 bits.
+     */
+    x0 = _mm_loadu_si128((__m128i const *) poly);
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    remainder = (unsigned int) _mm_extract_epi32(x1, 1);
+
+    return (crcUpdateSlice16(remainder, message, nBytes));
+
+}   /* crcUpdatePclmul() */
+
+#endif /* CRC_HAVE_PCLMUL */
+
+
+#if defined(CRC_HAVE_ARMV8)
+
+#if defined(__GNUC__)
+#define CRC_TARGET_ARMV8  __attribute__((target("+crc")))
+#else
+#define CRC_TARGET_ARMV8
+#endif
+
+/*********************************************************************
+ *
+ * Function:    crcUpdateArmv8()
+ * 
+ * Description: Update a remainder with a message, using the ARMv8
+ *        CRC32 instructions, eight bytes at a time.
+ *
+ * Notes:    
+ *
+ * Returns:    The new remainder.
+ *
+ *********************************************************************/
+static CRC_TARGET_ARMV8 unsigned int
+crcUpdateArmv8(unsigned int remainder, unsigned char const * message, size_t nBytes)
+{
+    /*
+     * Align to eight bytes, then do the bulk of the message.
+     */
+    while (nBytes && ((size_t) message & 7))
+    {
+        remainder = __crc32b(remainder, *message++);
+        --nBytes;
+    }
+
+    while (nBytes >= 8)
+    {
+        unsigned long long  data;
+
+        memcpy(&data, message, sizeof(data));
+        remainder = __crc32d(remainder, data);
+        message += 8;
+        nBytes -= 8;
+    }
+
+    while (nBytes--)
+    {
+        remainder = __crc32b(remainder, *message++);
+    }
+
+    return (remainder);
+
+}   /* crcUpdateArmv8() */
+
+#endif /* CRC_HAVE_ARMV8 */
+
+
+/*********************************************************************
+ *
+ * Function:    crcIsSupported()
+ * 
+ * Description: Check whether this CPU can run an implementation.
+ *
+ * Notes:    
+ *
+ * Returns:    TRUE if the implementation can be used.
+ *
+ *********************************************************************/
+int
+crcIsSupported(crcImplementation impl)
+{
+    switch (impl)
+    {
+    case CRC_IMPL_TABLE:
+    case CRC_IMPL_SLICE16:
+        return (TRUE);
+
+#if defined(CRC_HAVE_PCLMUL)
+    case CRC_IMPL_PCLMUL:
+        {
+            /*
+             * CPUID leaf 1: ECX bit 1 is PCLMULQDQ, bit 19 is SSE4.1.
+             */
+            unsigned int  ecx;
+#if defined(_MSC_VER)
+            int  info[4];
+            __cpuid(info, 1);
+            ecx = (unsigned int) info[2];
+#else
+            unsigned int  eax, ebx, edx;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+            {
+                return (FALSE);
+            }
+#endif
+            return (((ecx & (1u << 1)) && (ecx & (1u << 19))) ? TRUE : FALSE);
+        }
+#endif
+
+#if defined(CRC_HAVE_ARMV8)
+    case CRC_IMPL_ARMV8:
+#if defined(_WIN32)
+        return (IsProcessorFeaturePresent(PF_ARM_V8_CRC32_INSTRUCTIONS_AVAILABLE) ? TRUE : FALSE);
+#elif defined(__linux__)
+        return ((getauxval(AT_HWCAP) & HWCAP_CRC32) ? TRUE : FALSE);
+#elif defined(__ARM_FEATURE_CRC32)
+        return (TRUE);
+#else
+        return (FALSE);
+#endif
+#endif
+
+    default:
+        return (FALSE);
+    }
+
+}   /* crcIsSupported() */
+
+
+/*
+ * The implementation table, and the one in use.  Both are set up before
+ * main() runs, so no locking is needed afterwards.
+ */
+static crcUpdateFunc      crcUpdateFuncs[CRC_IMPL_COUNT];
+static crcImplementation  crcSelected = CRC_IMPL_SLICE16;
+
+static struct crcSetup
+{
+    crcSetup()
+    {
+        unsigned int  remainder;
+        int           dividend;
+        int           slice;
+        unsigned char bit;
+
+
+        /*
+         * The byte-at-a-time table, in reflected form.
+         */
+        for (dividend = 0; dividend < 256; ++dividend)
+        {
+            remainder = (unsigned int) dividend;
+
+            for (bit = 8; bit > 0; --bit)
+            {
+                remainder = (remainder & 1) ? ((remainder >> 1) ^ POLYNOMIAL_REFLECTED) : (remainder >> 1);
+            }
+
+            crcTable16[0][dividend] = remainder;
+        }
+
+        /*
+         * Each further table advances the previous one by a zero byte.
+         */
+        for (slice = 1; slice < 16; ++slice)
+        {
+            for (dividend = 0; dividend < 256; ++dividend)
+            {
+                remainder = crcTable16[slice - 1][dividend];
+                crcTable16[slice][dividend] = crcTable16[0][remainder & 0xFF] ^ (remainder >> 8);
+            }
+        }
+
+        crcUpdateFuncs[CRC_IMPL_TABLE] = crcUpdateTable;
+        crcUpdateFuncs[CRC_IMPL_SLICE16] = crcUpdateSlice16;
+#if defined(CRC_HAVE_PCLMUL)
+        crcUpdateFuncs[CRC_IMPL_PCLMUL] = crcUpdatePclmul;
+#endif
+#if defined(CRC_HAVE_ARMV8)
+        crcUpdateFuncs[CRC_IMPL_ARMV8] = crcUpdateArmv8;
+#endif
+
+        /*
+         * Pick the fastest implementation this CPU supports.
+         */
+        if (crcUpdateFuncs[CRC_IMPL_ARMV8] && crcIsSupported(CRC_IMPL_ARMV8))
+        {
+            crcSelected = CRC_IMPL_ARMV8;
+        }
+        else if (crcUpdateFuncs[CRC_IMPL_PCLMUL] && crcIsSupported(CRC_IMPL_PCLMUL))
+        {
+            crcSelected = CRC_IMPL_PCLMUL;
+        }
+    }
+
+} crcSetupInstance;
+
+
+/*********************************************************************
+ *
+ * Function:    crcUpdateWith()
+ * 
+ * Description: Update a remainder with a message of any length, using
+ *        the given implementation.
+ *
+ * Notes:    Lengths are split into pieces that fit a size_t, so
+ *        that 32-bit builds can hash more than 4GB.
+ *
+ * Returns:    The new remainder.
+ *
+ *********************************************************************/
+static unsigned int
+crcUpdateWith(crcImplementation impl, unsigned int remainder, unsigned char const * message, unsigned long long nBytes)
+{
+    crcUpdateFunc  update = crcUpdateFuncs[impl];
+
+    while (nBytes > 0)
+    {
+        size_t  piece = (nBytes > 0x40000000ULL) ? (size_t) 0x40000000 : (size_t) nBytes;
+
+        remainder = update(remainder, message, piece);
+        message += piece;
+        nBytes -= piece;
+    }
+
+    return (remainder);
+
+}   /* crcUpdateWith() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcBegin()
+ * 
+ * Description: Start a streaming CRC.
+ *
+ * Notes:    
+ *
+ * Returns:    None defined.
+ *
+ *********************************************************************/
+void
+crcBegin(crcContext * context)
+{
+    context->remainder = INITIAL_REMAINDER;
+    context->nBytes = 0;
+
+}   /* crcBegin() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcUpdate()
+ * 
+ * Description: Add the next piece of a message to a streaming CRC.
+ *
+ * Notes:    The pieces may be any size; the result is the same as
+ *        for the whole message at once.
+ *
+ * Returns:    None defined.
+ *
+ *********************************************************************/
+void
+crcUpdate(crcContext * context, void const * message, unsigned long long nBytes)
+{
+    context->remainder = crcUpdateWith(crcSelected, context->remainder, (unsigned char const *) message, nBytes);
+    context->nBytes += nBytes;
+
+}   /* crcUpdate() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcEnd()
+ * 
+ * Description: Finish a streaming CRC.
+ *
+ * Notes:    The context is left unchanged, so this may be called
+ *        part way through, and more data added afterwards.
+ *
+ * Returns:    The CRC of the message so far.
+ *
+ *********************************************************************/
+crc
+crcEnd(crcContext const * context)
+{
+    return ((crc) (context->remainder ^ FINAL_XOR_VALUE));
+
+}   /* crcEnd() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcCompute()
+ * 
+ * Description: Compute the CRC of a message in one call.
+ *
+ * Notes:    
+ *
+ * Returns:    The CRC of the message.
+ *
+ *********************************************************************/
+crc
+crcCompute(void const * message, unsigned long long nBytes)
+{
+    return (crcComputeWith(crcSelected, message, nBytes));
+
+}   /* crcCompute() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcComputeWith()
+ * 
+ * Description: Compute the CRC of a message with a particular
+ *        implementation.
+ *
+ * Notes:    Falls back to the table if the implementation isn't
+ *        supported by this CPU.
+ *
+ * Returns:    The CRC of the message.
+ *
+ *********************************************************************/
+crc
+crcComputeWith(crcImplementation impl, void const * message, unsigned long long nBytes)
+{
+    if (impl < 0 || impl >= CRC_IMPL_COUNT || !crcUpdateFuncs[impl] || !crcIsSupported(impl))
+    {
+        impl = CRC_IMPL_TABLE;
+    }
+
+    return ((crc) (crcUpdateWith(impl, INITIAL_REMAINDER, (unsigned char const *) message, nBytes) ^ FINAL_XOR_VALUE));
+
+}   /* crcComputeWith() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcGetImplementation()
+ * 
+ * Description: Get the implementation used by crcUpdate() and
+ *        crcCompute().
+ *
+ * Notes:    
+ *
+ * Returns:    The implementation.
+ *
+ *********************************************************************/
+crcImplementation
+crcGetImplementation(void)
+{
+    return (crcSelected);
+
+}   /* crcGetImplementation() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcGetImplementationName()
+ * 
+ * Description: Get an implementation's name, for logging.
+ *
+ * Notes:    
+ *
+ * Returns:    The name.
+ *
+ *********************************************************************/
+char const *
+crcGetImplementationName(crcImplementation impl)
+{
+    static char const * const  names[CRC_IMPL_COUNT] = { "table", "slice-by-16", "pclmul", "armv8" };
+
+    return ((impl >= 0 && impl < CRC_IMPL_COUNT) ? names[impl] : "unknown");
+
+}   /* crcGetImplementationName() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcBenchmark()
+ * 
+ * Description: Measure an implementation's throughput.
+ *
+ * Notes:    Hashes an nBytes buffer of pseudo-random data
+ *        nIterations times.  Use a buffer larger than the last
+ *        level cache to measure memory speed, or a small one to
+ *        measure the implementation alone.
+ *
+ * Returns:    Throughput in MB/s, or 0 if the implementation isn't
+ *        supported or the buffer couldn't be allocated.
+ *
+ *********************************************************************/
+double
+crcBenchmark(crcImplementation impl, unsigned long long nBytes, int nIterations)
+{
+    unsigned char *     buffer;
+    unsigned long long  i;
+    unsigned int        seed = 0x12345678;
+    volatile crc        result = 0;
+    double              seconds;
+    int                 iteration;
+
+
+    if (impl < 0 || impl >= CRC_IMPL_COUNT || !crcUpdateFuncs[impl] || !crcIsSupported(impl) ||
+        nBytes == 0 || nBytes > (size_t) -1 || nIterations <= 0)
+    {
+        return (0.0);
+    }
+
+    buffer = (unsigned char *) malloc((size_t) nBytes);
+    if (!buffer)
+    {
+        return (0.0);
+    }
+
+    for (i = 0; i < nBytes; ++i)
+    {
+        seed = seed * 1664525 + 1013904223;
+        buffer[i] = (unsigned char) (seed >> 24);
+    }
+
+    /*
+     * One untimed pass, to fault the pages in and warm the caches.
+     */
+    result = crcComputeWith(impl, buffer, nBytes);
+
+#if defined(_WIN32)
+    LARGE_INTEGER  frequency, start, end;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&start);
+#else
+    struct timespec  start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+#endif
+
+    for (iteration = 0; iteration < nIterations; ++iteration)
+    {
+        result = crcComputeWith(impl, buffer, nBytes);
+    }
+
+#if defined(_WIN32)
+    QueryPerformanceCounter(&end);
+    seconds = (double) (end.QuadPart - start.QuadPart) / (double) frequency.QuadPart;
+#else
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) * 1e-9;
+#endif
+
+    (void) result;
+    free(buffer);
+
+    return ((seconds > 0.0) ? ((double) nBytes * nIterations) / (seconds * 1024.0 * 1024.0) : 0.0);
+
+}   /* crcBenchmark() */
+
+#endif /* CRC32 */
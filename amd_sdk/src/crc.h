@@ -76,4 +76,46 @@ crc   crcSlow(unsigned char const message[], int nBytes);
 crc   crcFast(unsigned char const message[], int nBytes);
 
 
+#if defined(CRC32)
+
+/*
+ * Streaming CRC-32, for messages that arrive in pieces or are larger
+ * than an int.  The work is done by the fastest implementation this
+ * CPU supports, chosen at startup.
+ */
+typedef struct
+{
+    unsigned int        remainder;
+    unsigned long long  nBytes;
+
+} crcContext;
+
+void  crcBegin(crcContext * context);
+void  crcUpdate(crcContext * context, void const * message, unsigned long long nBytes);
+crc   crcEnd(crcContext const * context);
+crc   crcCompute(void const * message, unsigned long long nBytes);
+
+/*
+ * The available implementations, for testing and benchmarking.
+ * CrcBench (ssaa11/tools) checks and measures each of them.
+ */
+typedef enum
+{
+    CRC_IMPL_TABLE = 0,     /* One byte at a time */
+    CRC_IMPL_SLICE16,       /* Sixteen bytes at a time, 16KB of tables */
+    CRC_IMPL_PCLMUL,        /* x86 carry-less multiply folding (SSE4.1 + PCLMULQDQ) */
+    CRC_IMPL_ARMV8,         /* ARMv8 CRC32 instructions */
+    CRC_IMPL_COUNT
+
+} crcImplementation;
+
+int          crcIsSupported(crcImplementation impl);
+crcImplementation crcGetImplementation(void);
+char const * crcGetImplementationName(crcImplementation impl);
+crc          crcComputeWith(crcImplementation impl, void const * message, unsigned long long nBytes);
+double       crcBenchmark(crcImplementation impl, unsigned long long nBytes, int nIterations);
+
+#endif
+
+
 #endif /* _crc_h */
\ No newline at end of file
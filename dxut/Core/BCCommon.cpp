@@ -0,0 +1,187 @@
+//--------------------------------------------------------------------------------------
+// File: BCCommon.cpp
+//
+// BC7 tables and block threads, shared by BCDecode.cpp and BCEncode.cpp
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "BCCommon.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+using namespace DirectX;
+
+//--------------------------------------------------------------------------------------
+// Tables
+//--------------------------------------------------------------------------------------
+
+// Two subset partitions: bit i is set if texel i is in subset 1. BC6H uses the first 32
+const uint16_t BC::g_Partitions2[64] =
+{
+    0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+    0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+    0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+    0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+    0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+    0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+    0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+    0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+};
+
+// Anchor texels of the second subset; subset 0 anchors at texel 0
+const uint8_t BC::g_Anchor2[64] =
+{
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15,  2,  8,  2,  2,  8,  8, 15,
+     2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15,  6,  8,  2,  8, 15, 15,
+     2,  8,  2,  2,  2, 15, 15,  6,
+     6,  2,  6,  8, 15, 15,  2,  2,
+    15, 15, 15, 15, 15,  2,  2, 15,
+};
+
+const uint8_t BC::g_Weights2[4] = { 0, 21, 43, 64 };
+const uint8_t BC::g_Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+const uint8_t BC::g_Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+//--------------------------------------------------------------------------------------
+// Threads
+//--------------------------------------------------------------------------------------
+namespace
+{
+    struct JobQueue
+    {
+        BC::JobFunc     run;
+        void*           context;
+        long            numJobs;
+        volatile long   nextJob;
+    };
+
+    inline long AtomicIncrement( volatile long* value )
+    {
+#if defined(_WIN32)
+        return InterlockedIncrement( value );
+#else
+        return __sync_add_and_fetch( value, 1 );
+#endif
+    }
+
+    void RunQueue( _Inout_ JobQueue* queue )
+    {
+        for( ;; )
+        {
+            const long job = AtomicIncrement( &queue->nextJob ) - 1;
+            if ( job >= queue->numJobs )
+                break;
+
+            queue->run( queue->context, static_cast<size_t>( job ) );
+        }
+    }
+
+#if defined(_WIN32)
+    unsigned int __stdcall JobThread( _In_ void* param )
+    {
+        RunQueue( static_cast<JobQueue*>( param ) );
+        return 0;
+    }
+#else
+    void* JobThread( void* param )
+    {
+        RunQueue( static_cast<JobQueue*>( param ) );
+        return nullptr;
+    }
+#endif
+};
+
+unsigned int BC::GetProcessorCount()
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    return info.dwNumberOfProcessors;
+#else
+    const long count = sysconf( _SC_NPROCESSORS_ONLN );
+    return ( count > 0 ) ? static_cast<unsigned int>( count ) : 1;
+#endif
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void BC::RunJobs( JobFunc run, void* context, size_t numJobs, unsigned int numThreads )
+{
+    if ( !numJobs )
+        return;
+
+    JobQueue queue;
+    queue.run = run;
+    queue.context = context;
+    queue.numJobs = static_cast<long>( numJobs );
+    queue.nextJob = 0;
+
+    if ( !numThreads )
+    {
+        numThreads = GetProcessorCount();
+    }
+    numThreads = std::min( std::max( numThreads, 1u ), MAX_THREADS );
+    const unsigned int numWorkers = static_cast<unsigned int>( std::min<size_t>( numThreads, numJobs ) ) - 1;
+
+#if defined(_WIN32)
+    HANDLE threads[MAX_THREADS];
+    unsigned int numStarted = 0;
+    for( unsigned int i = 0; i < numWorkers; ++i )
+    {
+        const uintptr_t thread = _beginthreadex( nullptr, 0, JobThread, &queue, 0, nullptr );
+        if ( !thread )
+            break;
+        threads[numStarted++] = reinterpret_cast<HANDLE>( thread );
+    }
+
+    RunQueue( &queue );
+
+    if ( numStarted )
+    {
+        WaitForMultipleObjects( numStarted, threads, TRUE, INFINITE );
+        for( unsigned int i = 0; i < numStarted; ++i )
+        {
+            CloseHandle( threads[i] );
+        }
+    }
+#else
+    pthread_t threads[MAX_THREADS];
+    unsigned int numStarted = 0;
+    for( unsigned int i = 0; i < numWorkers; ++i )
+    {
+        if ( pthread_create( &threads[numStarted], nullptr, JobThread, &queue ) )
+            break;
+        ++numStarted;
+    }
+
+    RunQueue( &queue );
+
+    for( unsigned int i = 0; i < numStarted; ++i )
+    {
+        pthread_join( threads[i], nullptr );
+    }
+#endif
+}
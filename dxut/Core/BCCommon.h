@@ -0,0 +1,57 @@
+//--------------------------------------------------------------------------------------
+// File: BCCommon.h
+//
+// What the BC decoder and encoder share: the BC7 partition, anchor and weight tables,
+// and the threads that work through a texture's blocks
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <d3d11.h>
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#endif
+#include <stdint.h>
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+namespace DirectX
+{
+    namespace BC
+    {
+        // From the Direct3D 11 functional specification. Two subset partitions have bit i set
+        // if texel i is in subset 1, and the second subset's anchor texel in g_Anchor2
+        extern const uint16_t g_Partitions2[64];
+        extern const uint8_t g_Anchor2[64];
+        extern const uint8_t g_Weights2[4];
+        extern const uint8_t g_Weights3[8];
+        extern const uint8_t g_Weights4[16];
+
+        // Rows of blocks go out to the threads in strips of this many
+        const size_t STRIP_BLOCK_ROWS = 16;
+
+        const unsigned int MAX_THREADS = 64;
+
+        unsigned int GetProcessorCount();
+
+        typedef void (*JobFunc)( _Inout_ void* context, _In_ size_t job );
+
+        // Calls run( context, job ) for every job from 0 to numJobs - 1, on up to numThreads
+        // threads (0 for one per processor) including this one. Threads that can't be started
+        // leave their share to the others
+        void RunJobs( _In_ JobFunc run, _Inout_ void* context, _In_ size_t numJobs, _In_ unsigned int numThreads );
+    }
+}
@@ -0,0 +1,1721 @@
+//--------------------------------------------------------------------------------------
+// File: BCDecode.cpp
+//
+// BC1-BC7 block decoding, scalar and SSE2, and multithreaded decoding of whole textures
+//
+// This file doesn't include DXUT and doesn't touch a Direct3D device, so it can be built
+// into a headless test or benchmark.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "BCDecode.h"
+#include "BCCommon.h"
+
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#define BC_DECODE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)-1)
+#endif
+
+using namespace DirectX;
+using namespace DirectX::BC;
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+//--------------------------------------------------------------------------------------
+// BC6H and BC7 tables, from the Direct3D 11 functional specification; those the encoder
+// uses too are in BCCommon.cpp
+//--------------------------------------------------------------------------------------
+
+// Three subset partitions: the subset of each texel
+const uint8_t g_Partitions3[64][16] =
+{
+    { 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2 },
+    { 0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1 },
+    { 0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1 },
+    { 0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2 },
+    { 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2 },
+    { 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2 },
+    { 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2 },
+    { 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2 },
+    { 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2 },
+    { 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2 },
+    { 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2 },
+    { 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2 },
+    { 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0 },
+    { 0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2 },
+    { 0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0 },
+    { 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2 },
+    { 0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1 },
+    { 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2 },
+    { 0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1 },
+    { 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2 },
+    { 0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0 },
+    { 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0 },
+    { 0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2 },
+    { 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0 },
+    { 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1 },
+    { 0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2 },
+    { 0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2 },
+    { 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1 },
+    { 0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1 },
+    { 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2 },
+    { 0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1 },
+    { 0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2 },
+    { 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0 },
+    { 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0 },
+    { 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0 },
+    { 0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0 },
+    { 0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1 },
+    { 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1 },
+    { 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1 },
+    { 0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2 },
+    { 0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1 },
+    { 0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1 },
+    { 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1 },
+    { 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1 },
+    { 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2 },
+    { 0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1 },
+    { 0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2 },
+    { 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2 },
+    { 0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2 },
+    { 0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2 },
+    { 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2 },
+    { 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2 },
+    { 0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2 },
+    { 0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2 },
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2 },
+    { 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1 },
+    { 0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2 },
+    { 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+    { 0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0 },
+};
+
+// Anchor texels of the second and third of three subsets; subset 0 anchors at texel 0
+const uint8_t g_Anchor3[2][64] =
+{
+    {
+         3,  3, 15, 15,  8,  3, 15, 15,
+         8,  8,  6,  6,  6,  5,  3,  3,
+         3,  3,  8, 15,  3,  3,  6, 10,
+         5,  8,  8,  6,  8,  5, 15, 15,
+         8, 15,  3,  5,  6, 10,  8, 15,
+        15,  3, 15,  5, 15, 15, 15, 15,
+         3, 15,  5,  5,  5,  8,  5, 10,
+         5, 10,  8, 13, 15, 12,  3,  3,
+    },
+    {
+        15,  8,  8,  3, 15, 15,  3,  8,
+        15, 15, 15, 15, 15, 15, 15,  8,
+        15,  8, 15,  3, 15,  8, 15,  8,
+         3, 15,  6, 10, 15, 15, 10,  8,
+        15,  3, 15, 10, 10,  8,  9, 10,
+         6, 15,  8, 15,  3,  6,  6,  8,
+        15,  3, 15, 15, 15, 15, 15, 15,
+        15, 15, 15, 15,  3, 15, 15,  8,
+    },
+};
+
+inline const uint8_t* GetWeights( unsigned int indexBits )
+{
+    return ( indexBits == 2 ) ? g_Weights2 : ( indexBits == 3 ) ? g_Weights3 : g_Weights4;
+}
+
+struct BC7ModeInfo
+{
+    uint8_t     numSubsets;
+    uint8_t     partitionBits;
+    uint8_t     rotationBits;
+    uint8_t     indexSelectionBits;
+    uint8_t     colorBits;
+    uint8_t     alphaBits;
+    uint8_t     endpointPBits;      // one per endpoint
+    uint8_t     sharedPBits;        // one per subset
+    uint8_t     indexBits;
+    uint8_t     indexBits2;         // separate alpha indices
+};
+
+const BC7ModeInfo g_BC7Modes[8] =
+{
+    { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+    { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+    { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+    { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+    { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+    { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+    { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+    { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+// BC6H endpoint fields: w and x are the endpoints of subset 0, y and z those of subset 1
+enum BC6HField
+{
+    RW, GW, BW,
+    RX, GX, BX,
+    RY, GY, BY,
+    RZ, GZ, BZ,
+};
+
+// count bits of the block, from bit shift of the field up
+struct BC6HBits
+{
+    uint8_t     field;
+    uint8_t     shift;
+    uint8_t     count;
+};
+
+struct BC6HModeInfo
+{
+    uint8_t     mode;               // the 2 or 5 mode bits
+    bool        bTransformed;       // x, y and z are deltas from w
+    uint8_t     numSubsets;
+    uint8_t     endpointBits;
+    uint8_t     deltaBits[3];
+    BC6HBits    bits[25];           // in the order they are stored, up to a zero count
+};
+
+const BC6HModeInfo g_BC6HModes[14] =
+{
+    { 0x00, true, 2, 10, { 5, 5, 5 },
+      { { GY, 4, 1 }, { BY, 4, 1 }, { BZ, 4, 1 }, { RW, 0, 10 }, { GW, 0, 10 }, { BW, 0, 10 },
+        { RX, 0, 5 }, { GZ, 4, 1 }, { GY, 0, 4 }, { GX, 0, 5 }, { BZ, 0, 1 }, { GZ, 0, 4 },
+        { BX, 0, 5 }, { BZ, 1, 1 }, { BY, 0, 4 }, { RY, 0, 5 }, { BZ, 2, 1 }, { RZ, 0, 5 },
+        { BZ, 3, 1 } } },
+    { 0x01, true, 2, 7, { 6, 6, 6 },
+      { { GY, 5, 1 }, { GZ, 4, 1 }, { GZ, 5, 1 }, { RW, 0, 7 }, { BZ, 0, 1 }, { BZ, 1, 1 },
+        { BY, 4, 1 }, { GW, 0, 7 }, { BY, 5, 1 }, { BZ, 2, 1 }, { GY, 4, 1 }, { BW, 0, 7 },
+        { BZ, 3, 1 }, { BZ, 5, 1 }, { BZ, 4, 1 }, { RX, 0, 6 }, { GY, 0, 4 }, { GX, 0, 6 },
+        { GZ, 0, 4 }, { BX, 0, 6 }, { BY, 0, 4 }, { RY, 0, 6 }, { RZ, 0, 6 } } },
+    { 0x02, true, 2, 11, { 5, 4, 4 },
+      { { RW, 0, 10 }, { GW, 0, 10 }, { BW, 0, 10 }, { RX, 0, 5 }, { RW, 10, 1 }, { GY, 0, 4 },
+        { GX, 0, 4 }, { GW, 10, 1 }, { BZ, 0, 1 }, { GZ, 0, 4 }, { BX, 0, 4 }, { BW, 10, 1 },
+        { BZ, 1, 1 }, { BY, 0, 4 }, { RY, 0, 5 }, { BZ, 2, 1 }, { RZ, 0, 5 }, { BZ, 3, 1 } } },
+    { 0x06, true, 2, 11, { 4, 5, 4 },
+      { { RW, 0, 10 }, { GW, 0, 10 }, { BW, 0, 10 }, { RX, 0, 4 }, { RW, 10, 1 }, { GZ, 4, 1 },
+        { GY, 0, 4 }, { GX, 0, 5 }, { GW, 10, 1 }, { GZ, 0, 4 }, { BX, 0, 4 }, { BW, 10, 1 },
+        { BZ, 1, 1 }, { BY, 0, 4 }, { RY, 0, 4 }, { BZ, 0, 1 }, { BZ, 2, 1 }, { RZ, 0, 4 },
+        { GY, 4, 1 }, { BZ, 3, 1 } } },
+    { 0x0a, true, 2, 11, { 4, 4, 5 },
+      { { RW, 0, 10 }, { GW, 0, 10 }, { BW, 0, 10 }, { RX, 0, 4 }, { RW, 10, 1 }, { BY, 4, 1 },
+        { GY, 0, 4 }, { GX, 0, 4 }, { GW, 10, 1 }, { BZ, 0, 1 }, { GZ, 0, 4 }, { BX, 0, 5 },
+        { BW, 10, 1 }, { BY, 0, 4 }, { RY, 0, 4 }, { BZ, 1, 1 }, { BZ, 2, 1 }, { RZ, 0, 4 },
+        { BZ, 4, 1 }, { BZ, 3, 1 } } },
+    { 0x0e, true, 2, 9, { 5, 5, 5 },
+      { { RW, 0, 9 }, { BY, 4, 1 }, { GW, 0, 9 }, { GY, 4, 1 }, { BW, 0, 9 }, { BZ, 4, 1 },
+        { RX, 0, 5 }, { GZ, 4, 1 }, { GY, 0, 4 }, { GX, 0, 5 }, { BZ, 0, 1 }, { GZ, 0, 4 },
+        { BX, 0, 5 }, { BZ, 1, 1 }, { BY, 0, 4 }, { RY, 0, 5 }, { BZ, 2, 1 }, { RZ, 0, 5 },
+        { BZ, 3, 1 } } },
+    { 0x12, true, 2, 8, { 6, 5, 5 },
+      { { RW, 0, 8 }, { GZ, 4, 1 }, { BY, 4, 1 }, { GW, 0, 8 }, { BZ, 2, 1 }, { GY, 4, 1 },
+        { BW, 0, 8 }, { BZ, 3, 1 }, { BZ, 4, 1 }, { RX, 0, 6 }, { GY, 0, 4 }, { GX, 0, 5 },
+        { BZ, 0, 1 }, { GZ, 0, 4 }, { BX, 0, 5 }, { BZ, 1, 1 }, { BY, 0, 4 }, { RY, 0, 6 },
+        { RZ, 0, 6 } } },
+    { 0x16, true, 2, 8, { 5, 6, 5 },
+      { { RW, 0, 8 }, { BZ, 0, 1 }, { BY, 4, 1 }, { GW, 0, 8 }, { GY, 5, 1 }, { GY, 4, 1 },
+        { BW, 0, 8 }, { GZ, 5, 1 }, { BZ, 4, 1 }, { RX, 0, 5 }, { GZ, 4, 1 }, { GY, 0, 4 },
+        { GX, 0, 6 }, { GZ, 0, 4 }, { BX, 0, 5 }, { BZ, 1, 1 }, { BY, 0, 4 }, { RY, 0, 5 },
+        { BZ, 2, 1 }, { RZ, 0, 5 }, { BZ, 3, 1 } } },
+    { 0x1a, true, 2, 8, { 5, 5, 6 },
+      { { RW, 0, 8 }, { BZ, 1, 1 }, { BY, 4, 1 }, { GW, 0, 8 }, { BY, 5, 1 }, { GY, 4, 1 },
+        { BW, 0, 8 }, { BZ, 5, 1 }, { BZ, 4, 1 }, { RX, 0, 5 }, { GZ, 4, 1 }, { GY, 0, 4 },
+        { GX, 0, 5 }, { BZ, 0, 1 }, { GZ, 0, 4 }, { BX, 0, 6 }, { BY, 0, 4 }, { RY, 0, 5 },
+        { BZ, 2, 1 }, { RZ, 0, 5 }, { BZ, 3, 1 } } },
+    { 0x1e, false, 2, 6, { 6, 6, 6 },
+      { { RW, 0, 6 }, { GZ, 4, 1 }, { BZ, 0, 1 }, { BZ, 1, 1 }, { BY, 4, 1 }, { GW, 0, 6 },
+        { GY, 5, 1 }, { BY, 5, 1 }, { BZ, 2, 1 }, { GY, 4, 1 }, { BW, 0, 6 }, { GZ, 5, 1 },
+        { BZ, 3, 1 }, { BZ, 5, 1 }, { BZ, 4, 1 }, { RX, 0, 6 }, { GY, 0, 4 }, { GX, 0, 6 },
+        { GZ, 0, 4 }, { BX, 0, 6 }, { BY, 0, 4 }, { RY, 0, 6 }, { RZ, 0, 6 } } },
+    { 0x03, false, 1, 10, { 10, 10, 10 },
+      { { RW, 0, 10 }, { GW, 0, 10 }, { BW, 0, 10 }, { RX, 0, 10 }, { GX, 0, 10 }, { BX, 0, 10 } } },
+    { 0x07, true, 1, 11, { 9, 9, 9 },
+      { { RW, 0, 10 }, { GW, 0, 10 }, { BW, 0, 10 }, { RX, 0, 9 }, { RW, 10, 1 }, { GX, 0, 9 },
+        { GW, 10, 1 }, { BX, 0, 9 }, { BW, 10, 1 } } },
+    { 0x0b, true, 1, 12, { 8, 8, 8 },
+      { { RW, 0, 10 }, { GW, 0, 10 }, { BW, 0, 10 }, { RX, 0, 8 }, { RW, 11, 1 }, { RW, 10, 1 },
+        { GX, 0, 8 }, { GW, 11, 1 }, { GW, 10, 1 }, { BX, 0, 8 }, { BW, 11, 1 }, { BW, 10, 1 } } },
+    { 0x0f, true, 1, 16, { 4, 4, 4 },
+      { { RW, 0, 10 }, { GW, 0, 10 }, { BW, 0, 10 }, { RX, 0, 4 }, { RW, 15, 1 }, { RW, 14, 1 },
+        { RW, 13, 1 }, { RW, 12, 1 }, { RW, 11, 1 }, { RW, 10, 1 }, { GX, 0, 4 }, { GW, 15, 1 },
+        { GW, 14, 1 }, { GW, 13, 1 }, { GW, 12, 1 }, { GW, 11, 1 }, { GW, 10, 1 }, { BX, 0, 4 },
+        { BW, 15, 1 }, { BW, 14, 1 }, { BW, 13, 1 }, { BW, 12, 1 }, { BW, 11, 1 }, { BW, 10, 1 } } },
+};
+
+const uint16_t HALF_ONE = 0x3c00;
+const uint16_t HALF_MINUS_ONE = 0xbc00;
+
+//--------------------------------------------------------------------------------------
+// Helpers
+//--------------------------------------------------------------------------------------
+inline uint32_t Load16( _In_reads_bytes_(2) const uint8_t* p )
+{
+    return uint32_t( p[0] ) | ( uint32_t( p[1] ) << 8 );
+}
+
+inline uint32_t Load32( _In_reads_bytes_(4) const uint8_t* p )
+{
+    return uint32_t( p[0] ) | ( uint32_t( p[1] ) << 8 ) | ( uint32_t( p[2] ) << 16 ) | ( uint32_t( p[3] ) << 24 );
+}
+
+inline uint64_t Load64( _In_reads_bytes_(8) const uint8_t* p )
+{
+    return uint64_t( Load32( p ) ) | ( uint64_t( Load32( p + 4 ) ) << 32 );
+}
+
+inline uint32_t PackRGBA( uint32_t r, uint32_t g, uint32_t b, uint32_t a )
+{
+    return r | ( g << 8 ) | ( b << 16 ) | ( a << 24 );
+}
+
+inline uint64_t PackHalf4( uint32_t r, uint32_t g, uint32_t b, uint32_t a )
+{
+    return uint64_t( r | ( g << 16 ) ) | ( uint64_t( b | ( a << 16 ) ) << 32 );
+}
+
+// Writes a block's 4x4 texels of 4 or 8 bytes each
+template<typename T>
+inline void StoreBlock( _In_reads_(16) const T* texels, _Out_ uint8_t* dst, size_t dstPitch )
+{
+    for( size_t row = 0; row < 4; ++row )
+    {
+        memcpy( dst + row * dstPitch, texels + row * 4, 4 * sizeof(T) );
+    }
+}
+
+// A 128 bit block, read from bit 0 up
+class BitReader
+{
+public:
+    explicit BitReader( _In_reads_bytes_(16) const uint8_t* block ) :
+        m_lo( Load64( block ) ),
+        m_hi( Load64( block + 8 ) ),
+        m_pos( 0 )
+    {
+    }
+
+    uint32_t Read( unsigned int count )
+    {
+        assert( count > 0 && count <= 32 && m_pos + count <= 128 );
+
+        uint64_t bits;
+        if ( m_pos >= 64 )
+            bits = m_hi >> ( m_pos - 64 );
+        else if ( m_pos + count <= 64 )
+            bits = m_lo >> m_pos;
+        else
+            bits = ( m_lo >> m_pos ) | ( m_hi << ( 64 - m_pos ) );
+
+        m_pos += count;
+        return uint32_t( bits & ( ( uint64_t( 1 ) << count ) - 1 ) );
+    }
+
+    unsigned int GetPosition() const { return m_pos; }
+
+private:
+    uint64_t        m_lo;
+    uint64_t        m_hi;
+    unsigned int    m_pos;
+};
+
+// Bit replication of 5 and 6 bit endpoints; alpha is 255
+inline uint32_t Expand565( uint32_t c )
+{
+    const uint32_t r = ( c >> 11 ) & 31;
+    const uint32_t g = ( c >> 5 ) & 63;
+    const uint32_t b = c & 31;
+    return PackRGBA( ( r << 3 ) | ( r >> 2 ), ( g << 2 ) | ( g >> 4 ), ( b << 3 ) | ( b >> 2 ), 255 );
+}
+
+inline uint32_t Channel( uint32_t rgba, unsigned int channel )
+{
+    return ( rgba >> ( channel * 8 ) ) & 0xff;
+}
+
+// n / d rounded to the nearest half, ties to even, for 0 < |n| <= d
+uint16_t RatioToHalf( int n, int d )
+{
+    if ( !n )
+        return 0;
+
+    const uint32_t sign = ( n < 0 ) ? 0x8000 : 0;
+    const uint32_t num = uint32_t( ( n < 0 ) ? -n : n );
+    const uint32_t den = uint32_t( d );
+    assert( num <= den );
+
+    // |n| / d = 2^-k * [1, 2)
+    int k = 0;
+    while( ( num << k ) < den )
+    {
+        ++k;
+    }
+
+    // 10 bits of mantissa below the leading one; |n| / d >= 1 / d keeps k well above the
+    // smallest normal exponent of -14
+    uint64_t scaled = uint64_t( num ) << ( 10 + k );
+    uint32_t q = uint32_t( scaled / den );
+    const uint32_t r = uint32_t( scaled % den );
+    if ( 2 * r > den || ( 2 * r == den && ( q & 1 ) ) )
+    {
+        ++q;
+    }
+
+    uint32_t exponent = uint32_t( 15 - k );
+    if ( q == 2048 )
+    {
+        q = 1024;
+        ++exponent;
+    }
+
+    return uint16_t( sign | ( exponent << 10 ) | ( q - 1024 ) );
+}
+
+//--------------------------------------------------------------------------------------
+// BC1-BC5 palettes and indices
+//--------------------------------------------------------------------------------------
+
+// The 4 colors of a BC1 block. Three color blocks (color0 <= color1) have transparent
+// black as their last color; BC2 and BC3 always use four colors
+void GetBC1PaletteReference( _In_reads_bytes_(8) const uint8_t* block, bool bFourColors, _Out_writes_(4) uint32_t palette[4] )
+{
+    const uint32_t c0 = Load16( block );
+    const uint32_t c1 = Load16( block + 2 );
+    palette[0] = Expand565( c0 );
+    palette[1] = Expand565( c1 );
+
+    uint32_t rgb2[3];
+    uint32_t rgb3[3];
+    for( unsigned int ch = 0; ch < 3; ++ch )
+    {
+        const uint32_t e0 = Channel( palette[0], ch );
+        const uint32_t e1 = Channel( palette[1], ch );
+        if ( bFourColors || c0 > c1 )
+        {
+            rgb2[ch] = ( 2 * e0 + e1 + 1 ) / 3;
+            rgb3[ch] = ( e0 + 2 * e1 + 1 ) / 3;
+        }
+        else
+        {
+            rgb2[ch] = ( e0 + e1 + 1 ) / 2;
+            rgb3[ch] = 0;
+        }
+    }
+
+    palette[2] = PackRGBA( rgb2[0], rgb2[1], rgb2[2], 255 );
+    palette[3] = ( bFourColors || c0 > c1 ) ? PackRGBA( rgb3[0], rgb3[1], rgb3[2], 255 ) : 0;
+}
+
+// The 8 values of a BC3 alpha or BC4 / BC5 UNORM block
+void GetUnormPaletteReference( _In_reads_bytes_(8) const uint8_t* block, _Out_writes_(8) uint32_t palette[8] )
+{
+    const uint32_t a0 = block[0];
+    const uint32_t a1 = block[1];
+    palette[0] = a0;
+    palette[1] = a1;
+
+    if ( a0 > a1 )
+    {
+        for( uint32_t i = 1; i < 7; ++i )
+        {
+            palette[i + 1] = ( ( 7 - i ) * a0 + i * a1 + 3 ) / 7;
+        }
+    }
+    else
+    {
+        for( uint32_t i = 1; i < 5; ++i )
+        {
+            palette[i + 1] = ( ( 5 - i ) * a0 + i * a1 + 2 ) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+// The halfs of n / ( 7 * 127 ) and n / ( 5 * 127 ), which SNORM palettes interpolate to.
+// Filled in before main, so decoding threads only read them
+struct SnormHalfTables
+{
+    uint16_t    sevenths[2 * 7 * 127 + 1];
+    uint16_t    fifths[2 * 5 * 127 + 1];
+
+    SnormHalfTables()
+    {
+        for( int n = -7 * 127; n <= 7 * 127; ++n )
+        {
+            sevenths[n + 7 * 127] = RatioToHalf( n, 7 * 127 );
+        }
+        for( int n = -5 * 127; n <= 5 * 127; ++n )
+        {
+            fifths[n + 5 * 127] = RatioToHalf( n, 5 * 127 );
+        }
+    }
+};
+
+const SnormHalfTables g_SnormHalfs;
+
+// The 8 values of a BC4 / BC5 SNORM block, as halfs
+void GetSnormPalette( _In_reads_bytes_(8) const uint8_t* block, _Out_writes_(8) uint16_t palette[8] )
+{
+    // -128 is clamped to -127
+    const int r0 = std::max( int( int8_t( block[0] ) ), -127 );
+    const int r1 = std::max( int( int8_t( block[1] ) ), -127 );
+
+    if ( r0 > r1 )
+    {
+        for( int i = 0; i < 8; ++i )
+        {
+            // Palette order: r0, r1, then from r0 towards r1
+            const int w1 = ( i == 0 ) ? 0 : ( i == 1 ) ? 7 : i - 1;
+            palette[i] = g_SnormHalfs.sevenths[( 7 - w1 ) * r0 + w1 * r1 + 7 * 127];
+        }
+    }
+    else
+    {
+        for( int i = 0; i < 6; ++i )
+        {
+            const int w1 = ( i == 0 ) ? 0 : ( i == 1 ) ? 5 : i - 1;
+            palette[i] = g_SnormHalfs.fifths[( 5 - w1 ) * r0 + w1 * r1 + 5 * 127];
+        }
+        palette[6] = HALF_MINUS_ONE;
+        palette[7] = HALF_ONE;
+    }
+}
+
+// 3 bit index of texel i of a BC3 alpha or BC4 / BC5 block
+inline uint32_t GetIndex3( uint64_t block, unsigned int i )
+{
+    return uint32_t( ( block >> ( 16 + 3 * i ) ) & 7 );
+}
+
+//--------------------------------------------------------------------------------------
+// BC1-BC5, scalar
+//--------------------------------------------------------------------------------------
+void DecodeColorBlockReference( _In_reads_bytes_(8) const uint8_t* block, bool bFourColors, _Out_writes_(16) uint32_t texels[16] )
+{
+    uint32_t palette[4];
+    GetBC1PaletteReference( block, bFourColors, palette );
+
+    const uint32_t indices = Load32( block + 4 );
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        texels[i] = palette[( indices >> ( 2 * i ) ) & 3];
+    }
+}
+
+void DecodeBC1Reference( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint32_t texels[16];
+    DecodeColorBlockReference( block, false, texels );
+    StoreBlock( texels, dst, dstPitch );
+}
+
+void DecodeBC2Reference( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint32_t texels[16];
+    DecodeColorBlockReference( block + 8, true, texels );
+
+    const uint64_t alpha = Load64( block );
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        const uint32_t a = uint32_t( ( alpha >> ( 4 * i ) ) & 15 ) * 17;
+        texels[i] = ( texels[i] & 0x00ffffff ) | ( a << 24 );
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+
+void DecodeBC3Reference( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint32_t texels[16];
+    DecodeColorBlockReference( block + 8, true, texels );
+
+    uint32_t palette[8];
+    GetUnormPaletteReference( block, palette );
+    const uint64_t alpha = Load64( block );
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        texels[i] = ( texels[i] & 0x00ffffff ) | ( palette[GetIndex3( alpha, i )] << 24 );
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+
+void DecodeBC4UReference( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint32_t palette[8];
+    GetUnormPaletteReference( block, palette );
+
+    const uint64_t red = Load64( block );
+    uint32_t texels[16];
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        texels[i] = PackRGBA( palette[GetIndex3( red, i )], 0, 0, 255 );
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+
+void DecodeBC5UReference( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint32_t paletteR[8];
+    uint32_t paletteG[8];
+    GetUnormPaletteReference( block, paletteR );
+    GetUnormPaletteReference( block + 8, paletteG );
+
+    const uint64_t red = Load64( block );
+    const uint64_t green = Load64( block + 8 );
+    uint32_t texels[16];
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        texels[i] = PackRGBA( paletteR[GetIndex3( red, i )], paletteG[GetIndex3( green, i )], 0, 255 );
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+
+// SNORM blocks share their code with the SSE2 path: after the palette, which has to be
+// exact anyway, there is nothing but table lookups
+void DecodeBC4S( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint16_t palette[8];
+    GetSnormPalette( block, palette );
+
+    const uint64_t red = Load64( block );
+    uint64_t texels[16];
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        texels[i] = PackHalf4( palette[GetIndex3( red, i )], 0, 0, HALF_ONE );
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+
+void DecodeBC5S( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint16_t paletteR[8];
+    uint16_t paletteG[8];
+    GetSnormPalette( block, paletteR );
+    GetSnormPalette( block + 8, paletteG );
+
+    const uint64_t red = Load64( block );
+    const uint64_t green = Load64( block + 8 );
+    uint64_t texels[16];
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        texels[i] = PackHalf4( paletteR[GetIndex3( red, i )], paletteG[GetIndex3( green, i )], 0, HALF_ONE );
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+
+//--------------------------------------------------------------------------------------
+// BC6H
+//--------------------------------------------------------------------------------------
+struct BC6HBlock
+{
+    int             endpoints[2][2][3];     // [subset][endpoint][rgb], unquantized
+    uint8_t         subsets[16];
+    uint8_t         indices[16];
+    const uint8_t*  weights;
+    unsigned int    numWeights;
+    unsigned int    numSubsets;
+};
+
+inline int SignExtend( uint32_t value, unsigned int bits )
+{
+    const uint32_t mask = ( 1u << bits ) - 1;
+    int result = int( value & mask );
+    if ( result & ( 1 << ( bits - 1 ) ) )
+    {
+        result -= int( 1u << bits );
+    }
+    return result;
+}
+
+int Unquantize( int comp, unsigned int bits, bool bSigned )
+{
+    if ( !bSigned )
+    {
+        if ( bits >= 15 )
+            return comp;
+        if ( !comp )
+            return 0;
+        if ( comp == int( ( 1u << bits ) - 1 ) )
+            return 0xffff;
+        return ( ( comp << 16 ) + 0x8000 ) >> bits;
+    }
+
+    if ( bits >= 16 )
+        return comp;
+
+    const bool bNegative = ( comp < 0 );
+    if ( bNegative )
+    {
+        comp = -comp;
+    }
+
+    int unq;
+    if ( !comp )
+        unq = 0;
+    else if ( comp >= int( ( 1u << ( bits - 1 ) ) - 1 ) )
+        unq = 0x7fff;
+    else
+        unq = ( ( comp << 15 ) + 0x4000 ) >> ( bits - 1 );
+
+    return bNegative ? -unq : unq;
+}
+
+// Scales the interpolated value to the largest finite half (0x7bff) and returns its bits
+inline uint32_t FinishUnquantize( int comp, bool bSigned )
+{
+    if ( !bSigned )
+        return uint32_t( ( comp * 31 ) >> 6 );
+
+    if ( comp < 0 )
+    {
+        const uint32_t magnitude = uint32_t( ( -comp * 31 ) >> 5 );
+        return magnitude ? ( 0x8000 | magnitude ) : 0;
+    }
+
+    return uint32_t( ( comp * 31 ) >> 5 );
+}
+
+// Returns false for the reserved modes
+bool UnpackBC6H( _In_reads_bytes_(16) const uint8_t* block, bool bSigned, _Out_ BC6HBlock& out )
+{
+    BitReader bits( block );
+    uint32_t mode = bits.Read( 2 );
+    if ( mode >= 2 )
+    {
+        mode |= bits.Read( 3 ) << 2;
+    }
+
+    const BC6HModeInfo* info = nullptr;
+    for( size_t i = 0; i < _countof( g_BC6HModes ); ++i )
+    {
+        if ( g_BC6HModes[i].mode == mode )
+        {
+            info = &g_BC6HModes[i];
+            break;
+        }
+    }
+
+    if ( !info )
+        return false;
+
+    uint32_t fields[12] = {};
+    for( const BC6HBits* field = info->bits; field->count; ++field )
+    {
+        fields[field->field] |= bits.Read( field->count ) << field->shift;
+    }
+
+    const unsigned int epBits = info->endpointBits;
+    for( unsigned int ch = 0; ch < 3; ++ch )
+    {
+        const unsigned int deltaBits = info->bTransformed ? info->deltaBits[ch] : epBits;
+
+        int w = int( fields[RW + ch] );
+        int x = int( fields[RX + ch] );
+        int y = int( fields[RY + ch] );
+        int z = int( fields[RZ + ch] );
+
+        if ( bSigned )
+        {
+            w = SignExtend( fields[RW + ch], epBits );
+        }
+
+        if ( bSigned || info->bTransformed )
+        {
+            x = SignExtend( fields[RX + ch], deltaBits );
+            y = SignExtend( fields[RY + ch], deltaBits );
+            z = SignExtend( fields[RZ + ch], deltaBits );
+        }
+
+        if ( info->bTransformed )
+        {
+            const uint32_t mask = ( 1u << epBits ) - 1;
+            x = int( uint32_t( w + x ) & mask );
+            y = int( uint32_t( w + y ) & mask );
+            z = int( uint32_t( w + z ) & mask );
+            if ( bSigned )
+            {
+                x = SignExtend( uint32_t( x ), epBits );
+                y = SignExtend( uint32_t( y ), epBits );
+                z = SignExtend( uint32_t( z ), epBits );
+            }
+        }
+
+        out.endpoints[0][0][ch] = Unquantize( w, epBits, bSigned );
+        out.endpoints[0][1][ch] = Unquantize( x, epBits, bSigned );
+        out.endpoints[1][0][ch] = Unquantize( y, epBits, bSigned );
+        out.endpoints[1][1][ch] = Unquantize( z, epBits, bSigned );
+    }
+
+    out.numSubsets = info->numSubsets;
+    if ( info->numSubsets == 2 )
+    {
+        // The partition follows the endpoints, at bit 77
+        const uint32_t shape = bits.Read( 5 );
+        const uint32_t anchor = g_Anchor2[shape];
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            out.subsets[i] = uint8_t( ( g_Partitions2[shape] >> i ) & 1 );
+            out.indices[i] = uint8_t( bits.Read( ( i == 0 || i == anchor ) ? 2 : 3 ) );
+        }
+        out.weights = g_Weights3;
+        out.numWeights = 8;
+    }
+    else
+    {
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            out.subsets[i] = 0;
+            out.indices[i] = uint8_t( bits.Read( ( i == 0 ) ? 3 : 4 ) );
+        }
+        out.weights = g_Weights4;
+        out.numWeights = 16;
+    }
+
+    assert( bits.GetPosition() == 128 );
+    return true;
+}
+
+void DecodeBC6HReference( const uint8_t* block, uint8_t* dst, size_t dstPitch, bool bSigned )
+{
+    uint64_t texels[16];
+
+    BC6HBlock bc6h;
+    if ( !UnpackBC6H( block, bSigned, bc6h ) )
+    {
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            texels[i] = PackHalf4( 0, 0, 0, HALF_ONE );
+        }
+    }
+    else
+    {
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            const int (&ep)[2][3] = bc6h.endpoints[bc6h.subsets[i]];
+            const int w = bc6h.weights[bc6h.indices[i]];
+
+            uint32_t rgb[3];
+            for( unsigned int ch = 0; ch < 3; ++ch )
+            {
+                const int comp = ( ep[0][ch] * ( 64 - w ) + ep[1][ch] * w + 32 ) >> 6;
+                rgb[ch] = FinishUnquantize( comp, bSigned );
+            }
+
+            texels[i] = PackHalf4( rgb[0], rgb[1], rgb[2], HALF_ONE );
+        }
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+
+void DecodeBC6HUReference( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    DecodeBC6HReference( block, dst, dstPitch, false );
+}
+
+void DecodeBC6HSReference( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    DecodeBC6HReference( block, dst, dstPitch, true );
+}
+
+//--------------------------------------------------------------------------------------
+// BC7
+//--------------------------------------------------------------------------------------
+struct BC7Block
+{
+    uint8_t         endpoints[3][2][4];     // [subset][endpoint][rgba], expanded to 8 bits
+    uint8_t         subsets[16];
+    uint8_t         colorIndices[16];
+    uint8_t         alphaIndices[16];
+    const uint8_t*  colorWeights;
+    const uint8_t*  alphaWeights;
+    unsigned int    numColorWeights;
+    unsigned int    numAlphaWeights;
+    unsigned int    numSubsets;
+    unsigned int    rotation;               // 0 or the channel swapped with alpha, plus 1
+    bool            bSeparateAlpha;         // modes 4 and 5 index alpha on its own
+};
+
+inline uint8_t ExpandBits( uint32_t value, unsigned int bits )
+{
+    value <<= ( 8 - bits );
+    return uint8_t( value | ( value >> bits ) );
+}
+
+// Returns false for the reserved mode
+bool UnpackBC7( _In_reads_bytes_(16) const uint8_t* block, _Out_ BC7Block& out )
+{
+    if ( !block[0] )
+        return false;
+
+    unsigned int mode = 0;
+    while( !( block[0] & ( 1 << mode ) ) )
+    {
+        ++mode;
+    }
+
+    const BC7ModeInfo& info = g_BC7Modes[mode];
+    BitReader bits( block );
+    bits.Read( mode + 1 );
+
+    const uint32_t partition = info.partitionBits ? bits.Read( info.partitionBits ) : 0;
+    out.rotation = info.rotationBits ? bits.Read( info.rotationBits ) : 0;
+    const uint32_t indexSelection = info.indexSelectionBits ? bits.Read( info.indexSelectionBits ) : 0;
+    out.numSubsets = info.numSubsets;
+
+    // Red of every endpoint, then green, blue and alpha
+    uint32_t endpoints[3][2][4];
+    for( unsigned int ch = 0; ch < 4; ++ch )
+    {
+        const unsigned int channelBits = ( ch < 3 ) ? info.colorBits : info.alphaBits;
+        for( unsigned int s = 0; s < info.numSubsets; ++s )
+        {
+            for( unsigned int e = 0; e < 2; ++e )
+            {
+                endpoints[s][e][ch] = channelBits ? bits.Read( channelBits ) : 0;
+            }
+        }
+    }
+
+    uint32_t pBits[3][2] = {};
+    for( unsigned int s = 0; s < info.numSubsets; ++s )
+    {
+        if ( info.endpointPBits )
+        {
+            pBits[s][0] = bits.Read( 1 );
+            pBits[s][1] = bits.Read( 1 );
+        }
+    }
+    for( unsigned int s = 0; s < info.numSubsets; ++s )
+    {
+        if ( info.sharedPBits )
+        {
+            pBits[s][0] = pBits[s][1] = bits.Read( 1 );
+        }
+    }
+
+    const unsigned int pBitCount = info.endpointPBits + info.sharedPBits;
+    for( unsigned int s = 0; s < info.numSubsets; ++s )
+    {
+        for( unsigned int e = 0; e < 2; ++e )
+        {
+            for( unsigned int ch = 0; ch < 4; ++ch )
+            {
+                const unsigned int channelBits = ( ch < 3 ) ? info.colorBits : info.alphaBits;
+                if ( !channelBits )
+                {
+                    out.endpoints[s][e][ch] = 255;
+                }
+                else
+                {
+                    const uint32_t value = ( endpoints[s][e][ch] << pBitCount ) | ( pBitCount ? pBits[s][e] : 0 );
+                    out.endpoints[s][e][ch] = ExpandBits( value, channelBits + pBitCount );
+                }
+            }
+        }
+    }
+
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        if ( info.numSubsets == 2 )
+            out.subsets[i] = uint8_t( ( g_Partitions2[partition] >> i ) & 1 );
+        else if ( info.numSubsets == 3 )
+            out.subsets[i] = g_Partitions3[partition][i];
+        else
+            out.subsets[i] = 0;
+    }
+
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        bool bAnchor = ( i == 0 );
+        if ( info.numSubsets == 2 )
+            bAnchor |= ( i == g_Anchor2[partition] );
+        else if ( info.numSubsets == 3 )
+            bAnchor |= ( i == g_Anchor3[0][partition] || i == g_Anchor3[1][partition] );
+
+        out.colorIndices[i] = uint8_t( bits.Read( info.indexBits - ( bAnchor ? 1 : 0 ) ) );
+    }
+
+    out.bSeparateAlpha = ( info.indexBits2 != 0 );
+    if ( out.bSeparateAlpha )
+    {
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            out.alphaIndices[i] = uint8_t( bits.Read( info.indexBits2 - ( ( i == 0 ) ? 1 : 0 ) ) );
+        }
+    }
+    else
+    {
+        memcpy( out.alphaIndices, out.colorIndices, sizeof( out.alphaIndices ) );
+    }
+
+    unsigned int colorIndexBits = info.indexBits;
+    unsigned int alphaIndexBits = out.bSeparateAlpha ? info.indexBits2 : info.indexBits;
+    if ( indexSelection )
+    {
+        // Mode 4 can give color the 3 bit indices and alpha the 2 bit ones
+        std::swap( colorIndexBits, alphaIndexBits );
+        uint8_t swapped[16];
+        memcpy( swapped, out.colorIndices, sizeof( swapped ) );
+        memcpy( out.colorIndices, out.alphaIndices, sizeof( swapped ) );
+        memcpy( out.alphaIndices, swapped, sizeof( swapped ) );
+    }
+
+    out.colorWeights = GetWeights( colorIndexBits );
+    out.alphaWeights = GetWeights( alphaIndexBits );
+    out.numColorWeights = 1u << colorIndexBits;
+    out.numAlphaWeights = 1u << alphaIndexBits;
+
+    assert( bits.GetPosition() == 128 );
+    return true;
+}
+
+inline uint32_t Interpolate( uint32_t e0, uint32_t e1, uint32_t weight )
+{
+    return ( e0 * ( 64 - weight ) + e1 * weight + 32 ) >> 6;
+}
+
+// Swaps alpha with red, green or blue
+inline uint32_t Rotate( uint32_t rgba, unsigned int rotation )
+{
+    if ( !rotation )
+        return rgba;
+
+    const unsigned int shift = ( rotation - 1 ) * 8;
+    const uint32_t a = rgba >> 24;
+    const uint32_t c = ( rgba >> shift ) & 0xff;
+    rgba &= ~( ( 0xffu << shift ) | 0xff000000u );
+    return rgba | ( a << shift ) | ( c << 24 );
+}
+
+void DecodeBC7Reference( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint32_t texels[16];
+
+    BC7Block bc7;
+    if ( !UnpackBC7( block, bc7 ) )
+    {
+        memset( texels, 0, sizeof( texels ) );
+    }
+    else
+    {
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            const uint8_t (&ep)[2][4] = bc7.endpoints[bc7.subsets[i]];
+            const uint32_t wc = bc7.colorWeights[bc7.colorIndices[i]];
+            const uint32_t wa = bc7.alphaWeights[bc7.alphaIndices[i]];
+
+            const uint32_t rgba = PackRGBA( Interpolate( ep[0][0], ep[1][0], wc ),
+                                            Interpolate( ep[0][1], ep[1][1], wc ),
+                                            Interpolate( ep[0][2], ep[1][2], wc ),
+                                            Interpolate( ep[0][3], ep[1][3], wa ) );
+            texels[i] = Rotate( rgba, bc7.rotation );
+        }
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+
+#if defined(BC_DECODE_SSE2)
+//--------------------------------------------------------------------------------------
+// SSE2: palettes are computed a vector at a time, and BC1-BC3 pick the colors of a row of
+// texels with masks
+//--------------------------------------------------------------------------------------
+
+// x / 3, x / 5 and x / 7 as ( x * k ) >> 16, exact for the largest sums the palettes add up
+const uint16_t DIV3 = 21846;    // x <= 766
+const uint16_t DIV5 = 13108;    // x <= 1277
+const uint16_t DIV7 = 9363;     // x <= 1788
+
+void GetBC1PaletteSSE2( _In_reads_bytes_(8) const uint8_t* block, bool bFourColors, _Out_writes_(4) __m128i palette[4] )
+{
+    const uint32_t c0 = Load16( block );
+    const uint32_t c1 = Load16( block + 2 );
+    const __m128i zero = _mm_setzero_si128();
+
+    // 16 bit lanes: color 0 and color 1, and swapped
+    const __m128i e = _mm_unpacklo_epi8( _mm_setr_epi32( int( Expand565( c0 ) ), int( Expand565( c1 ) ), 0, 0 ), zero );
+    const __m128i swapped = _mm_shuffle_epi32( e, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+
+    __m128i colors23;
+    if ( bFourColors || c0 > c1 )
+    {
+        // ( 2 * e0 + e1 + 1 ) / 3 and ( e0 + 2 * e1 + 1 ) / 3; alpha works out as 255
+        const __m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_slli_epi16( e, 1 ), swapped ), _mm_set1_epi16( 1 ) );
+        colors23 = _mm_mulhi_epu16( sum, _mm_set1_epi16( short( DIV3 ) ) );
+    }
+    else
+    {
+        // ( e0 + e1 + 1 ) / 2, and transparent black
+        colors23 = _mm_avg_epu16( e, swapped );
+        colors23 = _mm_unpacklo_epi64( colors23, zero );
+    }
+
+    const __m128i colors = _mm_packus_epi16( e, colors23 );
+    palette[0] = _mm_shuffle_epi32( colors, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+    palette[1] = _mm_shuffle_epi32( colors, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+    palette[2] = _mm_shuffle_epi32( colors, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+    palette[3] = _mm_shuffle_epi32( colors, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+}
+
+// Picks the colors of the four rows of a block. Each lane of a row gets its index shifted to
+// bits 6 and 7, and the two bits select between the four colors
+void DecodeColorRowsSSE2( _In_reads_bytes_(8) const uint8_t* block, bool bFourColors, _Out_writes_(4) __m128i rows[4] )
+{
+    __m128i palette[4];
+    GetBC1PaletteSSE2( block, bFourColors, palette );
+
+    const uint32_t indices = Load32( block + 4 );
+    const __m128i shifts = _mm_setr_epi32( 64, 16, 4, 1 );
+    const __m128i bit0 = _mm_set1_epi32( 0x40 );
+    const __m128i bit1 = _mm_set1_epi32( 0x80 );
+
+    for( unsigned int row = 0; row < 4; ++row )
+    {
+        const __m128i v = _mm_mullo_epi16( _mm_set1_epi32( int( ( indices >> ( 8 * row ) ) & 0xff ) ), shifts );
+        const __m128i lo = _mm_cmpeq_epi32( _mm_and_si128( v, bit0 ), bit0 );
+        const __m128i hi = _mm_cmpeq_epi32( _mm_and_si128( v, bit1 ), bit1 );
+
+        const __m128i c01 = _mm_or_si128( _mm_and_si128( lo, palette[1] ), _mm_andnot_si128( lo, palette[0] ) );
+        const __m128i c23 = _mm_or_si128( _mm_and_si128( lo, palette[3] ), _mm_andnot_si128( lo, palette[2] ) );
+        rows[row] = _mm_or_si128( _mm_and_si128( hi, c23 ), _mm_andnot_si128( hi, c01 ) );
+    }
+}
+
+inline void StoreRows( _In_reads_(4) const __m128i rows[4], _Out_ uint8_t* dst, size_t dstPitch )
+{
+    for( size_t row = 0; row < 4; ++row )
+    {
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( dst + row * dstPitch ), rows[row] );
+    }
+}
+
+void GetUnormPaletteSSE2( _In_reads_bytes_(8) const uint8_t* block, _Out_writes_(8) uint32_t palette[8] )
+{
+    const __m128i a0 = _mm_set1_epi16( short( block[0] ) );
+    const __m128i a1 = _mm_set1_epi16( short( block[1] ) );
+
+    __m128i values;
+    if ( block[0] > block[1] )
+    {
+        const __m128i w0 = _mm_setr_epi16( 7, 0, 6, 5, 4, 3, 2, 1 );
+        const __m128i w1 = _mm_setr_epi16( 0, 7, 1, 2, 3, 4, 5, 6 );
+        const __m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( a0, w0 ), _mm_mullo_epi16( a1, w1 ) ), _mm_set1_epi16( 3 ) );
+        values = _mm_mulhi_epu16( sum, _mm_set1_epi16( short( DIV7 ) ) );
+    }
+    else
+    {
+        // The last two are 0 and 255
+        const __m128i w0 = _mm_setr_epi16( 5, 0, 4, 3, 2, 1, 0, 0 );
+        const __m128i w1 = _mm_setr_epi16( 0, 5, 1, 2, 3, 4, 0, 0 );
+        const __m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( a0, w0 ), _mm_mullo_epi16( a1, w1 ) ), _mm_set1_epi16( 2 ) );
+        values = _mm_mulhi_epu16( sum, _mm_set1_epi16( short( DIV5 ) ) );
+        values = _mm_or_si128( values, _mm_setr_epi16( 0, 0, 0, 0, 0, 0, 0, 255 ) );
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( palette ), _mm_unpacklo_epi16( values, zero ) );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( palette + 4 ), _mm_unpackhi_epi16( values, zero ) );
+}
+
+void DecodeBC1SSE2( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    __m128i rows[4];
+    DecodeColorRowsSSE2( block, false, rows );
+    StoreRows( rows, dst, dstPitch );
+}
+
+void DecodeBC2SSE2( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    __m128i rows[4];
+    DecodeColorRowsSSE2( block + 8, true, rows );
+
+    // 4 bits of alpha per texel, times 17 for 8 bits: a nibble in both halves of the byte
+    const __m128i nibbles = _mm_set1_epi32( 0x0f000000 );
+    const __m128i rgb = _mm_set1_epi32( 0x00ffffff );
+    for( unsigned int row = 0; row < 4; ++row )
+    {
+        const uint32_t a = Load16( block + 2 * row );
+        const __m128i alpha = _mm_and_si128( _mm_slli_epi32( _mm_setr_epi32( int( a ), int( a >> 4 ), int( a >> 8 ), int( a >> 12 ) ), 24 ), nibbles );
+        rows[row] = _mm_or_si128( _mm_and_si128( rows[row], rgb ), _mm_or_si128( alpha, _mm_slli_epi32( alpha, 4 ) ) );
+    }
+
+    StoreRows( rows, dst, dstPitch );
+}
+
+void DecodeBC3SSE2( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    __m128i rows[4];
+    DecodeColorRowsSSE2( block + 8, true, rows );
+
+    uint32_t palette[8];
+    GetUnormPaletteSSE2( block, palette );
+
+    const uint64_t alpha = Load64( block );
+    const __m128i rgb = _mm_set1_epi32( 0x00ffffff );
+    for( unsigned int row = 0; row < 4; ++row )
+    {
+        const unsigned int i = row * 4;
+        const __m128i a = _mm_setr_epi32( int( palette[GetIndex3( alpha, i )] ), int( palette[GetIndex3( alpha, i + 1 )] ),
+                                          int( palette[GetIndex3( alpha, i + 2 )] ), int( palette[GetIndex3( alpha, i + 3 )] ) );
+        rows[row] = _mm_or_si128( _mm_and_si128( rows[row], rgb ), _mm_slli_epi32( a, 24 ) );
+    }
+
+    StoreRows( rows, dst, dstPitch );
+}
+
+void DecodeBC4USSE2( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint32_t palette[8];
+    GetUnormPaletteSSE2( block, palette );
+
+    const uint64_t red = Load64( block );
+    const __m128i opaque = _mm_slli_epi32( _mm_set1_epi32( 0xff ), 24 );
+    __m128i rows[4];
+    for( unsigned int row = 0; row < 4; ++row )
+    {
+        const unsigned int i = row * 4;
+        rows[row] = _mm_or_si128( _mm_setr_epi32( int( palette[GetIndex3( red, i )] ), int( palette[GetIndex3( red, i + 1 )] ),
+                                                  int( palette[GetIndex3( red, i + 2 )] ), int( palette[GetIndex3( red, i + 3 )] ) ), opaque );
+    }
+
+    StoreRows( rows, dst, dstPitch );
+}
+
+void DecodeBC5USSE2( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint32_t paletteR[8];
+    uint32_t paletteG[8];
+    GetUnormPaletteSSE2( block, paletteR );
+    GetUnormPaletteSSE2( block + 8, paletteG );
+
+    const uint64_t red = Load64( block );
+    const uint64_t green = Load64( block + 8 );
+    const __m128i opaque = _mm_slli_epi32( _mm_set1_epi32( 0xff ), 24 );
+    __m128i rows[4];
+    for( unsigned int row = 0; row < 4; ++row )
+    {
+        const unsigned int i = row * 4;
+        const __m128i r = _mm_setr_epi32( int( paletteR[GetIndex3( red, i )] ), int( paletteR[GetIndex3( red, i + 1 )] ),
+                                          int( paletteR[GetIndex3( red, i + 2 )] ), int( paletteR[GetIndex3( red, i + 3 )] ) );
+        const __m128i g = _mm_setr_epi32( int( paletteG[GetIndex3( green, i )] ), int( paletteG[GetIndex3( green, i + 1 )] ),
+                                          int( paletteG[GetIndex3( green, i + 2 )] ), int( paletteG[GetIndex3( green, i + 3 )] ) );
+        rows[row] = _mm_or_si128( _mm_or_si128( r, _mm_slli_epi32( g, 8 ) ), opaque );
+    }
+
+    StoreRows( rows, dst, dstPitch );
+}
+
+// The colors of a BC6H subset, 8 at a time. The endpoints and weights are interleaved so
+// _mm_madd_epi16 adds both products in 32 bits; unsigned endpoints are biased by -32768 to
+// fit in 16 bits, which adds 32768 * 64 back afterwards
+void GetBC6HPaletteSSE2( _In_ const BC6HBlock& bc6h, unsigned int subset, bool bSigned, _Out_writes_(16) uint64_t palette[16] )
+{
+    const int bias = bSigned ? 0 : 32768;
+    const __m128i round = _mm_set1_epi32( 32 + bias * 64 );
+
+    __m128i pairs[3];
+    for( unsigned int ch = 0; ch < 3; ++ch )
+    {
+        const uint32_t e0 = uint32_t( bc6h.endpoints[subset][0][ch] - bias ) & 0xffff;
+        const uint32_t e1 = uint32_t( bc6h.endpoints[subset][1][ch] - bias ) & 0xffff;
+        pairs[ch] = _mm_set1_epi32( int( e0 | ( e1 << 16 ) ) );
+    }
+
+    for( unsigned int k = 0; k < bc6h.numWeights; k += 8 )
+    {
+        __m128i weights[2];
+        for( unsigned int j = 0; j < 2; ++j )
+        {
+            const uint8_t* w = bc6h.weights + k + j * 4;
+            weights[j] = _mm_setr_epi32( int( ( 64 - w[0] ) | ( w[0] << 16 ) ), int( ( 64 - w[1] ) | ( w[1] << 16 ) ),
+                                         int( ( 64 - w[2] ) | ( w[2] << 16 ) ), int( ( 64 - w[3] ) | ( w[3] << 16 ) ) );
+        }
+
+        __m128i channels[3];
+        for( unsigned int ch = 0; ch < 3; ++ch )
+        {
+            __m128i halfs[2];
+            for( unsigned int j = 0; j < 2; ++j )
+            {
+                const __m128i comp = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( pairs[ch], weights[j] ), round ), 6 );
+                if ( !bSigned )
+                {
+                    // comp * 31 >> 6
+                    halfs[j] = _mm_srli_epi32( _mm_sub_epi32( _mm_slli_epi32( comp, 5 ), comp ), 6 );
+                }
+                else
+                {
+                    // Sign and magnitude, without negative zeros
+                    const __m128i sign = _mm_srai_epi32( comp, 31 );
+                    const __m128i magnitude = _mm_sub_epi32( _mm_xor_si128( comp, sign ), sign );
+                    const __m128i scaled = _mm_srli_epi32( _mm_sub_epi32( _mm_slli_epi32( magnitude, 5 ), magnitude ), 5 );
+                    const __m128i nonZero = _mm_andnot_si128( _mm_cmpeq_epi32( scaled, _mm_setzero_si128() ), sign );
+                    halfs[j] = _mm_or_si128( scaled, _mm_and_si128( nonZero, _mm_set1_epi32( 0x8000 ) ) );
+                }
+            }
+
+            // Pack to 16 bits, through the signed range
+            const __m128i flip = _mm_set1_epi32( 0x8000 );
+            channels[ch] = _mm_xor_si128( _mm_packs_epi32( _mm_sub_epi32( halfs[0], flip ), _mm_sub_epi32( halfs[1], flip ) ),
+                                          _mm_set1_epi16( -32768 ) );
+        }
+
+        const __m128i alpha = _mm_set1_epi16( short( HALF_ONE ) );
+        const __m128i rgLo = _mm_unpacklo_epi16( channels[0], channels[1] );
+        const __m128i rgHi = _mm_unpackhi_epi16( channels[0], channels[1] );
+        const __m128i baLo = _mm_unpacklo_epi16( channels[2], alpha );
+        const __m128i baHi = _mm_unpackhi_epi16( channels[2], alpha );
+
+        __m128i* out = reinterpret_cast<__m128i*>( palette + k );
+        _mm_storeu_si128( out, _mm_unpacklo_epi32( rgLo, baLo ) );
+        _mm_storeu_si128( out + 1, _mm_unpackhi_epi32( rgLo, baLo ) );
+        _mm_storeu_si128( out + 2, _mm_unpacklo_epi32( rgHi, baHi ) );
+        _mm_storeu_si128( out + 3, _mm_unpackhi_epi32( rgHi, baHi ) );
+    }
+}
+
+void DecodeBC6HSSE2( const uint8_t* block, uint8_t* dst, size_t dstPitch, bool bSigned )
+{
+    uint64_t texels[16];
+
+    BC6HBlock bc6h;
+    if ( !UnpackBC6H( block, bSigned, bc6h ) )
+    {
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            texels[i] = PackHalf4( 0, 0, 0, HALF_ONE );
+        }
+    }
+    else
+    {
+        uint64_t palette[2][16];
+        for( unsigned int s = 0; s < bc6h.numSubsets; ++s )
+        {
+            GetBC6HPaletteSSE2( bc6h, s, bSigned, palette[s] );
+        }
+
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            texels[i] = palette[bc6h.subsets[i]][bc6h.indices[i]];
+        }
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+
+void DecodeBC6HUSSE2( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    DecodeBC6HSSE2( block, dst, dstPitch, false );
+}
+
+void DecodeBC6HSSSE2( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    DecodeBC6HSSE2( block, dst, dstPitch, true );
+}
+
+// The RGBA8 colors of a BC7 subset, two at a time in 16 bit lanes
+void GetBC7PaletteSSE2( _In_reads_(4) const uint8_t e0[4], _In_reads_(4) const uint8_t e1[4],
+                        _In_reads_(numWeights) const uint8_t* weights, unsigned int numWeights,
+                        _Out_writes_(numWeights) uint32_t* palette )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v0 = _mm_unpacklo_epi8( _mm_set1_epi32( int( Load32( e0 ) ) ), zero );
+    const __m128i v1 = _mm_unpacklo_epi8( _mm_set1_epi32( int( Load32( e1 ) ) ), zero );
+    const __m128i sixtyFour = _mm_set1_epi16( 64 );
+    const __m128i round = _mm_set1_epi16( 32 );
+
+    for( unsigned int k = 0; k < numWeights; k += 2 )
+    {
+        const __m128i w = _mm_unpacklo_epi64( _mm_set1_epi16( short( weights[k] ) ), _mm_set1_epi16( short( weights[k + 1] ) ) );
+        const __m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( v0, _mm_sub_epi16( sixtyFour, w ) ), _mm_mullo_epi16( v1, w ) ), round );
+        _mm_storel_epi64( reinterpret_cast<__m128i*>( palette + k ), _mm_packus_epi16( _mm_srli_epi16( sum, 6 ), zero ) );
+    }
+}
+
+void DecodeBC7SSE2( const uint8_t* block, uint8_t* dst, size_t dstPitch )
+{
+    uint32_t texels[16];
+
+    BC7Block bc7;
+    if ( !UnpackBC7( block, bc7 ) )
+    {
+        memset( texels, 0, sizeof( texels ) );
+    }
+    else if ( !bc7.bSeparateAlpha )
+    {
+        uint32_t palette[3][16];
+        for( unsigned int s = 0; s < bc7.numSubsets; ++s )
+        {
+            GetBC7PaletteSSE2( bc7.endpoints[s][0], bc7.endpoints[s][1], bc7.colorWeights, bc7.numColorWeights, palette[s] );
+        }
+
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            texels[i] = palette[bc7.subsets[i]][bc7.colorIndices[i]];
+        }
+    }
+    else
+    {
+        // One subset, with alpha interpolated by its own weights
+        uint32_t colors[8];
+        uint32_t alphas[8];
+        GetBC7PaletteSSE2( bc7.endpoints[0][0], bc7.endpoints[0][1], bc7.colorWeights, bc7.numColorWeights, colors );
+        GetBC7PaletteSSE2( bc7.endpoints[0][0], bc7.endpoints[0][1], bc7.alphaWeights, bc7.numAlphaWeights, alphas );
+
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            const uint32_t rgba = ( colors[bc7.colorIndices[i]] & 0x00ffffff ) | ( alphas[bc7.alphaIndices[i]] & 0xff000000 );
+            texels[i] = Rotate( rgba, bc7.rotation );
+        }
+    }
+
+    StoreBlock( texels, dst, dstPitch );
+}
+#endif // BC_DECODE_SSE2
+
+//--------------------------------------------------------------------------------------
+// Formats
+//--------------------------------------------------------------------------------------
+typedef void (*DecodeBlockFunc)( _In_ const uint8_t* block, _Out_ uint8_t* dst, _In_ size_t dstPitch );
+
+struct BCFormatInfo
+{
+    DecodeBlockFunc reference;
+    DecodeBlockFunc fast;
+    size_t          blockBytes;
+    size_t          texelBytes;
+    DXGI_FORMAT     decodedFormat;
+};
+
+#if defined(BC_DECODE_SSE2)
+#define BC_FAST(x) x##SSE2
+#else
+#define BC_FAST(x) x##Reference
+#endif
+
+bool GetFormatInfo( DXGI_FORMAT format, _Out_ BCFormatInfo& info )
+{
+    const DXGI_FORMAT rgba8 = DXGI_FORMAT_R8G8B8A8_UNORM;
+    const DXGI_FORMAT rgba8SRGB = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+    const DXGI_FORMAT rgba16f = DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+    switch( format )
+    {
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+        {
+            const BCFormatInfo bc1 = { DecodeBC1Reference, BC_FAST(DecodeBC1), 8, 4, ( format == DXGI_FORMAT_BC1_UNORM_SRGB ) ? rgba8SRGB : rgba8 };
+            info = bc1;
+        }
+        return true;
+
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+        {
+            const BCFormatInfo bc2 = { DecodeBC2Reference, BC_FAST(DecodeBC2), 16, 4, ( format == DXGI_FORMAT_BC2_UNORM_SRGB ) ? rgba8SRGB : rgba8 };
+            info = bc2;
+        }
+        return true;
+
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+        {
+            const BCFormatInfo bc3 = { DecodeBC3Reference, BC_FAST(DecodeBC3), 16, 4, ( format == DXGI_FORMAT_BC3_UNORM_SRGB ) ? rgba8SRGB : rgba8 };
+            info = bc3;
+        }
+        return true;
+
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+        {
+            const BCFormatInfo bc4 = { DecodeBC4UReference, BC_FAST(DecodeBC4U), 8, 4, rgba8 };
+            info = bc4;
+        }
+        return true;
+
+    case DXGI_FORMAT_BC4_SNORM:
+        {
+            const BCFormatInfo bc4 = { DecodeBC4S, DecodeBC4S, 8, 8, rgba16f };
+            info = bc4;
+        }
+        return true;
+
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+        {
+            const BCFormatInfo bc5 = { DecodeBC5UReference, BC_FAST(DecodeBC5U), 16, 4, rgba8 };
+            info = bc5;
+        }
+        return true;
+
+    case DXGI_FORMAT_BC5_SNORM:
+        {
+            const BCFormatInfo bc5 = { DecodeBC5S, DecodeBC5S, 16, 8, rgba16f };
+            info = bc5;
+        }
+        return true;
+
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+        {
+            const BCFormatInfo bc6h = { DecodeBC6HUReference, BC_FAST(DecodeBC6HU), 16, 8, rgba16f };
+            info = bc6h;
+        }
+        return true;
+
+    case DXGI_FORMAT_BC6H_SF16:
+        {
+            const BCFormatInfo bc6h = { DecodeBC6HSReference, BC_FAST(DecodeBC6HS), 16, 8, rgba16f };
+            info = bc6h;
+        }
+        return true;
+
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        {
+            const BCFormatInfo bc7 = { DecodeBC7Reference, BC_FAST(DecodeBC7), 16, 4, ( format == DXGI_FORMAT_BC7_UNORM_SRGB ) ? rgba8SRGB : rgba8 };
+            info = bc7;
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+#undef BC_FAST
+
+//--------------------------------------------------------------------------------------
+// Threads
+//--------------------------------------------------------------------------------------
+struct DecodeJob
+{
+    const uint8_t*  src;
+    size_t          srcRowPitch;
+    uint8_t*        dst;
+    size_t          dstRowPitch;
+    size_t          width;
+    size_t          height;
+};
+
+struct DecodeWork
+{
+    const DecodeJob*    jobs;
+    DXGI_FORMAT         format;
+    unsigned int        flags;
+};
+
+void RunDecodeJob( _Inout_ void* context, size_t job )
+{
+    const DecodeWork* work = static_cast<const DecodeWork*>( context );
+    const DecodeJob& j = work->jobs[job];
+    (void)DecodeBC( work->format, j.width, j.height, j.src, j.srcRowPitch, j.dst, j.dstRowPitch, work->flags );
+}
+
+};
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+DXGI_FORMAT DirectX::GetBCDecodedFormat( DXGI_FORMAT format )
+{
+    BCFormatInfo info;
+    return GetFormatInfo( format, info ) ? info.decodedFormat : DXGI_FORMAT_UNKNOWN;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::DecodeBC( DXGI_FORMAT format,
+                           size_t width,
+                           size_t height,
+                           const uint8_t* src,
+                           size_t srcRowPitch,
+                           uint8_t* dst,
+                           size_t dstRowPitch,
+                           unsigned int flags )
+{
+    if ( !src || !dst )
+        return E_INVALIDARG;
+
+    BCFormatInfo info;
+    if ( !GetFormatInfo( format, info ) )
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+
+    const size_t blocksWide = ( width + 3 ) / 4;
+    const size_t blocksHigh = ( height + 3 ) / 4;
+    if ( srcRowPitch < blocksWide * info.blockBytes || dstRowPitch < width * info.texelBytes )
+        return E_INVALIDARG;
+
+    const DecodeBlockFunc decode = ( flags & BC_DECODE_REFERENCE ) ? info.reference : info.fast;
+
+    // Blocks that stick out over the right or bottom edge are decoded aside and cropped
+    uint8_t edge[4 * 4 * 8];
+    const size_t edgePitch = 4 * info.texelBytes;
+
+    for( size_t by = 0; by < blocksHigh; ++by )
+    {
+        const uint8_t* block = src + by * srcRowPitch;
+        uint8_t* dstRow = dst + by * 4 * dstRowPitch;
+        const size_t rows = std::min<size_t>( height - by * 4, 4 );
+
+        for( size_t bx = 0; bx < blocksWide; ++bx, block += info.blockBytes )
+        {
+            uint8_t* texels = dstRow + bx * edgePitch;
+            const size_t columns = std::min<size_t>( width - bx * 4, 4 );
+
+            if ( rows == 4 && columns == 4 )
+            {
+                decode( block, texels, dstRowPitch );
+            }
+            else
+            {
+                decode( block, edge, edgePitch );
+                for( size_t row = 0; row < rows; ++row )
+                {
+                    memcpy( texels + row * dstRowPitch, edge + row * edgePitch, columns * info.texelBytes );
+                }
+            }
+        }
+    }
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::DecodeDDSTexture( const DDSTextureDesc& desc,
+                                   unsigned int numThreads,
+                                   unsigned int flags,
+                                   DecodedTexture& texture )
+{
+    texture.format = DXGI_FORMAT_UNKNOWN;
+    texture.mipCount = 0;
+    texture.arraySize = 0;
+    texture.mips.reset();
+    texture.pixels.reset();
+    texture.pixelBytes = 0;
+
+    BCFormatInfo info;
+    if ( !GetFormatInfo( desc.format, info ) )
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+
+    const size_t numMips = desc.mipCount * desc.arraySize;
+    std::unique_ptr<DDSMipLayout[]> mips( new (std::nothrow) DDSMipLayout[ numMips ] );
+    std::unique_ptr<DDSMipLayout[]> srcMips( new (std::nothrow) DDSMipLayout[ numMips ] );
+    if ( !mips || !srcMips )
+        return E_OUTOFMEMORY;
+
+    // Lay the decoded mips out the way the DDS file does, with the same dimensions
+    size_t totalBytes = 0;
+    size_t numJobs = 0;
+    for( size_t item = 0; item < desc.arraySize; ++item )
+    {
+        for( size_t mip = 0; mip < desc.mipCount; ++mip )
+        {
+            const size_t index = item * desc.mipCount + mip;
+            DDSMipLayout& src = srcMips[index];
+            HRESULT hr = GetMipLayout( desc, item, mip, src );
+            if ( FAILED( hr ) )
+                return hr;
+
+            DDSMipLayout& dst = mips[index];
+            dst = src;
+            if ( src.width > SIZE_MAX / info.texelBytes )
+                return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+            dst.rowBytes = src.width * info.texelBytes;
+            dst.numRows = src.height;
+            if ( dst.numRows && dst.rowBytes > SIZE_MAX / dst.numRows )
+                return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+            dst.slicePitch = dst.rowBytes * dst.numRows;
+            if ( dst.depth && dst.slicePitch > SIZE_MAX / dst.depth )
+                return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+            dst.numBytes = dst.slicePitch * dst.depth;
+            if ( totalBytes > SIZE_MAX - dst.numBytes )
+                return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+            dst.offset = totalBytes;
+            totalBytes += dst.numBytes;
+
+            numJobs += dst.depth * ( ( src.numRows + STRIP_BLOCK_ROWS - 1 ) / STRIP_BLOCK_ROWS );
+        }
+    }
+
+    std::unique_ptr<uint8_t[]> pixels( new (std::nothrow) uint8_t[ totalBytes ] );
+    if ( !pixels )
+        return E_OUTOFMEMORY;
+
+    std::vector<DecodeJob> jobs;
+    jobs.reserve( numJobs );
+    for( size_t index = 0; index < numMips; ++index )
+    {
+        const DDSMipLayout& src = srcMips[index];
+        const DDSMipLayout& dst = mips[index];
+        for( size_t slice = 0; slice < dst.depth; ++slice )
+        {
+            for( size_t blockRow = 0; blockRow < src.numRows; blockRow += STRIP_BLOCK_ROWS )
+            {
+                DecodeJob job;
+                job.src = desc.bitData + src.offset + slice * src.slicePitch + blockRow * src.rowBytes;
+                job.srcRowPitch = src.rowBytes;
+                job.dst = pixels.get() + dst.offset + slice * dst.slicePitch + blockRow * 4 * dst.rowBytes;
+                job.dstRowPitch = dst.rowBytes;
+                job.width = dst.width;
+                job.height = std::min( dst.height - blockRow * 4, STRIP_BLOCK_ROWS * 4 );
+                jobs.push_back( job );
+            }
+        }
+    }
+
+    if ( !jobs.empty() )
+    {
+        DecodeWork work;
+        work.jobs = &jobs[0];
+        work.format = desc.format;
+        work.flags = flags;
+        RunJobs( RunDecodeJob, &work, jobs.size(), numThreads );
+    }
+
+    texture.format = info.decodedFormat;
+    texture.mipCount = desc.mipCount;
+    texture.arraySize = desc.arraySize;
+    texture.mips = std::move( mips );
+    texture.pixels = std::move( pixels );
+    texture.pixelBytes = totalBytes;
+
+    return S_OK;
+}
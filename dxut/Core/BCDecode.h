@@ -0,0 +1,91 @@
+//--------------------------------------------------------------------------------------
+// File: BCDecode.h
+//
+// Software decoder for block compressed textures (BC1-BC7), so the texels of a DDS file
+// can be read without a GPU, e.g. to test, compare or sample textures headless.
+//
+// BC1-BC3, BC7 and the UNORM variants of BC4 and BC5 decode to R8G8B8A8_UNORM, or to
+// R8G8B8A8_UNORM_SRGB (still sRGB encoded) for sRGB formats. BC6H and the SNORM variants of
+// BC4 and BC5 decode to R16G16B16A16_FLOAT. Channels a format doesn't store are 0, alpha 1.
+// Typeless formats decode like their UNORM (or UF16) variants.
+//
+// The results are reproducible. BCDecodeBench (ssaa11/tools) checks them against Pillow's
+// decoder, on a golden set of blocks it decoded (BCDecodeGolden.h):
+//   - BC7 is bit-exact to Pillow. Both follow the integer decoding of the Direct3D 11
+//     functional specification, except that reserved modes decode to zeros here, as the
+//     specification says, and to opaque black in Pillow
+//   - BC1-BC5 expand the endpoints to 8 bits by bit replication, as Pillow does, but round
+//     the interpolated values to nearest where Pillow truncates them, so they can be 1
+//     higher; the BC1 three-color midpoint rounds up
+//   - BC6H follows the integer decoding of the specification, including zeros with alpha 1
+//     for reserved modes. Pillow only decodes it to 8 bits, so it isn't checked against it
+//   - the SNORM values of BC4 and BC5 are rounded to the nearest half, and aren't checked
+//     against Pillow either, for the same reason
+//
+// The SSE2 code gives the same bits as the scalar reference code, which follows the
+// specification texel by texel; BC_DECODE_REFERENCE selects it, to check one against the
+// other.
+//
+// Nothing here needs a Direct3D device, so it builds headless like DDSFile.cpp.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "DDSFile.h"
+
+#if defined(_MSC_VER) && (_MSC_VER<1610) && !defined(_Out_writes_bytes_)
+#define _Out_writes_bytes_(exp)
+#endif
+
+namespace DirectX
+{
+    enum BC_DECODE_FLAGS
+    {
+        BC_DECODE_DEFAULT   = 0,
+        BC_DECODE_REFERENCE = 0x1,  // scalar code only
+    };
+
+    // The format a BC format decodes to, or DXGI_FORMAT_UNKNOWN if format isn't BC1-BC7
+    DXGI_FORMAT GetBCDecodedFormat( _In_ DXGI_FORMAT format );
+
+    // Decodes a 2D surface. width and height are in texels; blocks on the right and bottom
+    // edges are cropped. srcRowPitch is the size of a row of blocks
+    HRESULT DecodeBC( _In_ DXGI_FORMAT format,
+                      _In_ size_t width,
+                      _In_ size_t height,
+                      _In_reads_bytes_(srcRowPitch*((height+3)/4)) const uint8_t* src,
+                      _In_ size_t srcRowPitch,
+                      _Out_writes_bytes_(dstRowPitch*height) uint8_t* dst,
+                      _In_ size_t dstRowPitch,
+                      _In_ unsigned int flags );
+
+    // Every mip of every array item (or cube face) of a texture, decoded. The mips are laid
+    // out like in a DDS file, item by item and finest mip first: mips[item * mipCount + mip]
+    // is where each one is in pixels, with numRows counting texels
+    struct DecodedTexture
+    {
+        DXGI_FORMAT                     format;
+        size_t                          mipCount;
+        size_t                          arraySize;
+        std::unique_ptr<DDSMipLayout[]> mips;
+        std::unique_ptr<uint8_t[]>      pixels;
+        size_t                          pixelBytes;
+    };
+
+    // Decodes the whole texture, with the rows of blocks of all mips shared out between
+    // numThreads threads (0 for one per processor), the calling thread included
+    HRESULT DecodeDDSTexture( _In_ const DDSTextureDesc& desc,
+                              _In_ unsigned int numThreads,
+                              _In_ unsigned int flags,
+                              _Out_ DecodedTexture& texture );
+}
@@ -0,0 +1,1654 @@
+//--------------------------------------------------------------------------------------
+// File: BCEncode.cpp
+//
+// BC1, BC3, BC4, BC5 and BC7 block encoding, and multithreaded encoding of whole textures
+//
+// This file doesn't include DXUT and doesn't touch a Direct3D device, so it can be built
+// into a headless test or tool.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "BCEncode.h"
+#include "BCCommon.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#define BC_ENCODE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER<1610) && !defined(_Inout_updates_)
+#define _Inout_updates_(exp)
+#endif
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)-1)
+#endif
+
+using namespace DirectX;
+using namespace DirectX::BC;
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+//--------------------------------------------------------------------------------------
+// Blocks
+//--------------------------------------------------------------------------------------
+
+// The 16 texels of a block, RGBA
+struct Block
+{
+    uint8_t texels[16][4];
+};
+
+// Blocks that stick out over the right or bottom edge repeat the last column and row
+void LoadBlock( _In_ const uint8_t* src, size_t srcRowPitch, size_t columns, size_t rows, _Out_ Block& block )
+{
+    for( size_t y = 0; y < 4; ++y )
+    {
+        const uint8_t* row = src + std::min( y, rows - 1 ) * srcRowPitch;
+        for( size_t x = 0; x < 4; ++x )
+        {
+            memcpy( block.texels[y * 4 + x], row + std::min( x, columns - 1 ) * 4, 4 );
+        }
+    }
+}
+
+const uint32_t ALL_TEXELS = 0xffff;
+
+// Masks of channels, bit i for channel i
+const unsigned int RED_CHANNEL = 0x1;
+const unsigned int COLOR_CHANNELS = 0x7;
+const unsigned int ALL_CHANNELS = 0xf;
+
+// A 128 bit block, written from bit 0 up
+class BitWriter
+{
+public:
+    explicit BitWriter( _Out_writes_bytes_(16) uint8_t* block ) :
+        m_block( block ),
+        m_pos( 0 )
+    {
+        memset( block, 0, 16 );
+    }
+
+    void Write( uint32_t value, unsigned int count )
+    {
+        assert( m_pos + count <= 128 );
+        for( unsigned int i = 0; i < count; ++i, ++m_pos )
+        {
+            if ( ( value >> i ) & 1 )
+            {
+                m_block[m_pos >> 3] |= static_cast<uint8_t>( 1u << ( m_pos & 7 ) );
+            }
+        }
+    }
+
+    unsigned int GetPosition() const { return m_pos; }
+
+private:
+    uint8_t*        m_block;
+    unsigned int    m_pos;
+};
+
+inline void Store16( uint32_t value, _Out_writes_bytes_(2) uint8_t* p )
+{
+    p[0] = static_cast<uint8_t>( value );
+    p[1] = static_cast<uint8_t>( value >> 8 );
+}
+
+inline int Clamp( int value, int lo, int hi )
+{
+    return std::min( std::max( value, lo ), hi );
+}
+
+inline int Round( float value )
+{
+    return static_cast<int>( floorf( value + 0.5f ) );
+}
+
+//--------------------------------------------------------------------------------------
+// Nearest palette colors
+//
+// The texels and palettes are 16 bit integers with up to four channels; channels a format
+// doesn't encode are 0 in both. The errors are exact sums of squares, so the SSE2 and the
+// scalar code pick the same indices, the first of equally near colors
+//--------------------------------------------------------------------------------------
+const unsigned int MAX_PALETTE = 16;
+
+typedef int16_t Palette[MAX_PALETTE][4];
+
+// The texels of a block, red and green of four texels interleaved, then blue and alpha,
+// the way _mm_madd_epi16 wants them
+struct IndexBlock
+{
+#if defined(BC_ENCODE_SSE2)
+    __m128i     rg[4];
+    __m128i     ba[4];
+#else
+    int16_t     rg[4][8];
+    int16_t     ba[4][8];
+#endif
+};
+
+// Channels is a mask of the channels of texels to keep; the rest are 0
+void MakeIndexBlock( _In_reads_(16) const uint8_t texels[16][4], unsigned int channels, _Out_ IndexBlock& out )
+{
+    int16_t rg[4][8];
+    int16_t ba[4][8];
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        int16_t c[4];
+        for( unsigned int ch = 0; ch < 4; ++ch )
+        {
+            c[ch] = ( channels & ( 1u << ch ) ) ? texels[i][ch] : 0;
+        }
+        rg[i / 4][( i % 4 ) * 2] = c[0];
+        rg[i / 4][( i % 4 ) * 2 + 1] = c[1];
+        ba[i / 4][( i % 4 ) * 2] = c[2];
+        ba[i / 4][( i % 4 ) * 2 + 1] = c[3];
+    }
+
+#if defined(BC_ENCODE_SSE2)
+    for( unsigned int g = 0; g < 4; ++g )
+    {
+        out.rg[g] = _mm_loadu_si128( reinterpret_cast<const __m128i*>( rg[g] ) );
+        out.ba[g] = _mm_loadu_si128( reinterpret_cast<const __m128i*>( ba[g] ) );
+    }
+#else
+    memcpy( out.rg, rg, sizeof(rg) );
+    memcpy( out.ba, ba, sizeof(ba) );
+#endif
+}
+
+inline void GetTexel( _In_ const IndexBlock& block, unsigned int i, _Out_writes_(4) int c[4] )
+{
+#if defined(BC_ENCODE_SSE2)
+    int16_t rg[8];
+    int16_t ba[8];
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( rg ), block.rg[i / 4] );
+    _mm_storeu_si128( reinterpret_cast<__m128i*>( ba ), block.ba[i / 4] );
+#else
+    const int16_t* rg = block.rg[i / 4];
+    const int16_t* ba = block.ba[i / 4];
+#endif
+    c[0] = rg[( i % 4 ) * 2];
+    c[1] = rg[( i % 4 ) * 2 + 1];
+    c[2] = ba[( i % 4 ) * 2];
+    c[3] = ba[( i % 4 ) * 2 + 1];
+}
+
+// Sets the indices of the texels in mask to their nearest colors, and returns the sum
+// of their squared errors
+uint32_t FindIndicesReference( _In_ const IndexBlock& block, _In_ const Palette& palette, unsigned int numColors,
+                               uint32_t mask, _Inout_updates_(16) uint8_t indices[16] )
+{
+    uint32_t total = 0;
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        if ( !( mask & ( 1u << i ) ) )
+            continue;
+
+        int c[4];
+        GetTexel( block, i, c );
+
+        uint32_t best = UINT32_MAX;
+        for( unsigned int p = 0; p < numColors; ++p )
+        {
+            uint32_t error = 0;
+            for( unsigned int ch = 0; ch < 4; ++ch )
+            {
+                const int d = c[ch] - palette[p][ch];
+                error += static_cast<uint32_t>( d * d );
+            }
+            if ( error < best )
+            {
+                best = error;
+                indices[i] = static_cast<uint8_t>( p );
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+#if defined(BC_ENCODE_SSE2)
+uint32_t FindIndicesSSE2( _In_ const IndexBlock& block, _In_ const Palette& palette, unsigned int numColors,
+                          uint32_t mask, _Inout_updates_(16) uint8_t indices[16] )
+{
+    __m128i paletteRG[MAX_PALETTE];
+    __m128i paletteBA[MAX_PALETTE];
+    for( unsigned int p = 0; p < numColors; ++p )
+    {
+        paletteRG[p] = _mm_set1_epi32( static_cast<uint16_t>( palette[p][0] ) | ( static_cast<uint32_t>( static_cast<uint16_t>( palette[p][1] ) ) << 16 ) );
+        paletteBA[p] = _mm_set1_epi32( static_cast<uint16_t>( palette[p][2] ) | ( static_cast<uint32_t>( static_cast<uint16_t>( palette[p][3] ) ) << 16 ) );
+    }
+
+    uint32_t total = 0;
+    for( unsigned int g = 0; g < 4; ++g )
+    {
+        if ( !( ( mask >> ( g * 4 ) ) & 0xf ) )
+            continue;
+
+        __m128i best = _mm_set1_epi32( 0x7fffffff );
+        __m128i bestIndex = _mm_setzero_si128();
+        for( unsigned int p = 0; p < numColors; ++p )
+        {
+            const __m128i drg = _mm_sub_epi16( block.rg[g], paletteRG[p] );
+            const __m128i dba = _mm_sub_epi16( block.ba[g], paletteBA[p] );
+            const __m128i error = _mm_add_epi32( _mm_madd_epi16( drg, drg ), _mm_madd_epi16( dba, dba ) );
+            const __m128i less = _mm_cmplt_epi32( error, best );
+            best = _mm_or_si128( _mm_and_si128( less, error ), _mm_andnot_si128( less, best ) );
+            bestIndex = _mm_or_si128( _mm_and_si128( less, _mm_set1_epi32( static_cast<int>( p ) ) ), _mm_andnot_si128( less, bestIndex ) );
+        }
+
+        uint32_t errors[4];
+        uint32_t groupIndices[4];
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( errors ), best );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( groupIndices ), bestIndex );
+        for( unsigned int j = 0; j < 4; ++j )
+        {
+            const unsigned int i = g * 4 + j;
+            if ( mask & ( 1u << i ) )
+            {
+                indices[i] = static_cast<uint8_t>( groupIndices[j] );
+                total += errors[j];
+            }
+        }
+    }
+    return total;
+}
+#endif
+
+typedef uint32_t (*FindIndicesFunc)( _In_ const IndexBlock& block, _In_ const Palette& palette, unsigned int numColors,
+                                     uint32_t mask, _Inout_updates_(16) uint8_t indices[16] );
+
+struct EncodeParams
+{
+    unsigned int        quality;
+    FindIndicesFunc     findIndices;
+};
+
+//--------------------------------------------------------------------------------------
+// Endpoint fitting, in floats of 0 to 255
+//--------------------------------------------------------------------------------------
+struct Texels
+{
+    float   c[16][4];
+};
+
+void ToFloat( _In_reads_(16) const uint8_t texels[16][4], unsigned int channels, _Out_ Texels& out )
+{
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        for( unsigned int ch = 0; ch < 4; ++ch )
+        {
+            out.c[i][ch] = ( channels & ( 1u << ch ) ) ? static_cast<float>( texels[i][ch] ) : 0.0f;
+        }
+    }
+}
+
+unsigned int CountTexels( uint32_t mask )
+{
+    unsigned int count = 0;
+    for( ; mask; mask &= mask - 1 )
+    {
+        ++count;
+    }
+    return count;
+}
+
+void GetMean( _In_ const Texels& texels, uint32_t mask, _Out_writes_(4) float mean[4] )
+{
+    float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        if ( mask & ( 1u << i ) )
+        {
+            for( unsigned int ch = 0; ch < 4; ++ch )
+            {
+                sum[ch] += texels.c[i][ch];
+            }
+        }
+    }
+
+    const float scale = 1.0f / static_cast<float>( std::max( CountTexels( mask ), 1u ) );
+    for( unsigned int ch = 0; ch < 4; ++ch )
+    {
+        mean[ch] = sum[ch] * scale;
+    }
+}
+
+// The principal axis of the texels in mask, by power iteration on their covariance until
+// it settles. Returns the variance along it, times the number of texels; the axis is 0 if
+// they're all the same
+float GetPrincipalAxis( _In_ const Texels& texels, uint32_t mask, _In_reads_(4) const float mean[4], _Out_writes_(4) float axis[4] )
+{
+    float cov[4][4] = {};
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        if ( !( mask & ( 1u << i ) ) )
+            continue;
+
+        float d[4];
+        for( unsigned int ch = 0; ch < 4; ++ch )
+        {
+            d[ch] = texels.c[i][ch] - mean[ch];
+        }
+        for( unsigned int a = 0; a < 4; ++a )
+        {
+            for( unsigned int b = a; b < 4; ++b )
+            {
+                cov[a][b] += d[a] * d[b];
+            }
+        }
+    }
+    for( unsigned int a = 0; a < 4; ++a )
+    {
+        for( unsigned int b = 0; b < a; ++b )
+        {
+            cov[a][b] = cov[b][a];
+        }
+    }
+
+    // Start from the row of the largest variance, which is never orthogonal to the axis
+    unsigned int largest = 0;
+    for( unsigned int ch = 1; ch < 4; ++ch )
+    {
+        if ( cov[ch][ch] > cov[largest][largest] )
+        {
+            largest = ch;
+        }
+    }
+
+    float v[4];
+    memcpy( v, cov[largest], sizeof(v) );
+    float length = 0.0f;
+    for( unsigned int iteration = 0; iteration < 8; ++iteration )
+    {
+        float next[4];
+        length = 0.0f;
+        for( unsigned int a = 0; a < 4; ++a )
+        {
+            next[a] = cov[a][0] * v[0] + cov[a][1] * v[1] + cov[a][2] * v[2] + cov[a][3] * v[3];
+            length = std::max( length, fabsf( next[a] ) );
+        }
+        if ( length < 1e-6f )
+        {
+            axis[0] = axis[1] = axis[2] = axis[3] = 0.0f;
+            return 0.0f;
+        }
+        float change = 0.0f;
+        for( unsigned int a = 0; a < 4; ++a )
+        {
+            const float scaled = next[a] / length;
+            change = std::max( change, fabsf( scaled - v[a] ) );
+            v[a] = scaled;
+        }
+        if ( change < 1e-3f )
+            break;
+    }
+
+    const float norm = sqrtf( v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3] );
+    for( unsigned int ch = 0; ch < 4; ++ch )
+    {
+        axis[ch] = v[ch] / norm;
+    }
+
+    // Rayleigh quotient
+    float variance = 0.0f;
+    for( unsigned int a = 0; a < 4; ++a )
+    {
+        for( unsigned int b = 0; b < 4; ++b )
+        {
+            variance += axis[a] * cov[a][b] * axis[b];
+        }
+    }
+    return variance;
+}
+
+inline void ClampEndpoint( _Inout_updates_(4) float e[4] )
+{
+    for( unsigned int ch = 0; ch < 4; ++ch )
+    {
+        e[ch] = std::min( std::max( e[ch], 0.0f ), 255.0f );
+    }
+}
+
+// The extremes of the texels in mask along their principal axis
+void FitPrincipalAxis( _In_ const Texels& texels, uint32_t mask, _Out_writes_(4) float e0[4], _Out_writes_(4) float e1[4] )
+{
+    float mean[4];
+    float axis[4];
+    GetMean( texels, mask, mean );
+    (void)GetPrincipalAxis( texels, mask, mean, axis );
+
+    float lo = 0.0f;
+    float hi = 0.0f;
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        if ( mask & ( 1u << i ) )
+        {
+            float t = 0.0f;
+            for( unsigned int ch = 0; ch < 4; ++ch )
+            {
+                t += ( texels.c[i][ch] - mean[ch] ) * axis[ch];
+            }
+            lo = std::min( lo, t );
+            hi = std::max( hi, t );
+        }
+    }
+
+    for( unsigned int ch = 0; ch < 4; ++ch )
+    {
+        e0[ch] = mean[ch] + lo * axis[ch];
+        e1[ch] = mean[ch] + hi * axis[ch];
+    }
+    ClampEndpoint( e0 );
+    ClampEndpoint( e1 );
+}
+
+// The corners of the bounding box of the texels in mask, on the diagonal that follows the
+// channel with the largest range. inset moves them towards each other by that fraction of
+// the range, which suits palettes that don't reach much beyond their endpoints
+void FitBoundingBox( _In_ const Texels& texels, uint32_t mask, float inset, _Out_writes_(4) float e0[4], _Out_writes_(4) float e1[4] )
+{
+    float mean[4];
+    GetMean( texels, mask, mean );
+
+    float lo[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+    float hi[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        if ( mask & ( 1u << i ) )
+        {
+            for( unsigned int ch = 0; ch < 4; ++ch )
+            {
+                lo[ch] = std::min( lo[ch], texels.c[i][ch] );
+                hi[ch] = std::max( hi[ch], texels.c[i][ch] );
+            }
+        }
+    }
+
+    unsigned int major = 0;
+    for( unsigned int ch = 1; ch < 4; ++ch )
+    {
+        if ( hi[ch] - lo[ch] > hi[major] - lo[major] )
+        {
+            major = ch;
+        }
+    }
+
+    for( unsigned int ch = 0; ch < 4; ++ch )
+    {
+        float covariance = 0.0f;
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            if ( mask & ( 1u << i ) )
+            {
+                covariance += ( texels.c[i][ch] - mean[ch] ) * ( texels.c[i][major] - mean[major] );
+            }
+        }
+
+        const float d = ( hi[ch] - lo[ch] ) * inset;
+        e0[ch] = lo[ch] + d;
+        e1[ch] = hi[ch] - d;
+        if ( covariance < 0.0f )
+        {
+            std::swap( e0[ch], e1[ch] );
+        }
+    }
+}
+
+// The endpoints that best fit the texels in mask by least squares, given how far each
+// texel is from e0 towards e1. Returns false if all the weights are the same
+bool FitLeastSquares( _In_ const Texels& texels, uint32_t mask, _In_reads_(16) const float weights[16],
+                      _Out_writes_(4) float e0[4], _Out_writes_(4) float e1[4] )
+{
+    float a = 0.0f;
+    float b = 0.0f;
+    float c = 0.0f;
+    float x0[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float x1[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        if ( !( mask & ( 1u << i ) ) )
+            continue;
+
+        const float w1 = weights[i];
+        const float w0 = 1.0f - w1;
+        a += w0 * w0;
+        b += w0 * w1;
+        c += w1 * w1;
+        for( unsigned int ch = 0; ch < 4; ++ch )
+        {
+            x0[ch] += w0 * texels.c[i][ch];
+            x1[ch] += w1 * texels.c[i][ch];
+        }
+    }
+
+    const float det = a * c - b * b;
+    if ( fabsf( det ) < 1e-4f )
+        return false;
+
+    const float inv = 1.0f / det;
+    for( unsigned int ch = 0; ch < 4; ++ch )
+    {
+        e0[ch] = ( c * x0[ch] - b * x1[ch] ) * inv;
+        e1[ch] = ( a * x1[ch] - b * x0[ch] ) * inv;
+    }
+    ClampEndpoint( e0 );
+    ClampEndpoint( e1 );
+    return true;
+}
+
+unsigned int GetRefinements( unsigned int quality )
+{
+    return ( quality == BC_ENCODE_HIGH ) ? 8 : ( quality == BC_ENCODE_NORMAL ) ? 1 : 0;
+}
+
+//--------------------------------------------------------------------------------------
+// BC1 color blocks, also the color of BC3
+//--------------------------------------------------------------------------------------
+
+inline uint32_t Expand5( uint32_t v ) { return ( v << 3 ) | ( v >> 2 ); }
+inline uint32_t Expand6( uint32_t v ) { return ( v << 2 ) | ( v >> 4 ); }
+
+uint32_t QuantizeRGB565( _In_reads_(4) const float e[4] )
+{
+    const uint32_t r = static_cast<uint32_t>( Clamp( Round( e[0] * ( 31.0f / 255.0f ) ), 0, 31 ) );
+    const uint32_t g = static_cast<uint32_t>( Clamp( Round( e[1] * ( 63.0f / 255.0f ) ), 0, 63 ) );
+    const uint32_t b = static_cast<uint32_t>( Clamp( Round( e[2] * ( 31.0f / 255.0f ) ), 0, 31 ) );
+    return ( r << 11 ) | ( g << 5 ) | b;
+}
+
+// The palette BCDecode.cpp decodes: four colors, or three and transparent black
+void GetBC1Palette( uint32_t c0, uint32_t c1, bool bFourColors, _Out_ Palette& palette )
+{
+    int e[2][3];
+    const uint32_t c[2] = { c0, c1 };
+    for( unsigned int j = 0; j < 2; ++j )
+    {
+        e[j][0] = static_cast<int>( Expand5( ( c[j] >> 11 ) & 31 ) );
+        e[j][1] = static_cast<int>( Expand6( ( c[j] >> 5 ) & 63 ) );
+        e[j][2] = static_cast<int>( Expand5( c[j] & 31 ) );
+    }
+
+    for( unsigned int ch = 0; ch < 3; ++ch )
+    {
+        palette[0][ch] = static_cast<int16_t>( e[0][ch] );
+        palette[1][ch] = static_cast<int16_t>( e[1][ch] );
+        if ( bFourColors )
+        {
+            palette[2][ch] = static_cast<int16_t>( ( 2 * e[0][ch] + e[1][ch] + 1 ) / 3 );
+            palette[3][ch] = static_cast<int16_t>( ( e[0][ch] + 2 * e[1][ch] + 1 ) / 3 );
+        }
+        else
+        {
+            palette[2][ch] = static_cast<int16_t>( ( e[0][ch] + e[1][ch] + 1 ) / 2 );
+            palette[3][ch] = 0;
+        }
+    }
+    for( unsigned int p = 0; p < 4; ++p )
+    {
+        palette[p][3] = 0;
+    }
+}
+
+struct BC1Candidate
+{
+    uint32_t    c0;
+    uint32_t    c1;
+    uint8_t     indices[16];
+    uint32_t    error;
+};
+
+// Encodes the texels in mask with endpoints e0 and e1, in four color mode (the colors in
+// the order of the indices 0, 2, 3, 1 lie evenly on the line) or three color mode
+void EvaluateBC1( _In_ const IndexBlock& block, uint32_t mask, _In_reads_(4) const float e0[4], _In_reads_(4) const float e1[4],
+                  bool bFourColors, _In_ const EncodeParams& params, _Inout_ BC1Candidate& candidate )
+{
+    candidate.c0 = QuantizeRGB565( e0 );
+    candidate.c1 = QuantizeRGB565( e1 );
+
+    Palette palette;
+    GetBC1Palette( candidate.c0, candidate.c1, bFourColors, palette );
+    candidate.error = params.findIndices( block, palette, bFourColors ? 4 : 3, mask, candidate.indices );
+}
+
+inline float GetBC1Weight( uint8_t index, bool bFourColors )
+{
+    static const float fourColors[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    static const float threeColors[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+    return bFourColors ? fourColors[index] : threeColors[index];
+}
+
+// Fits the endpoints to the texels in mask, and refines them as far as the quality asks
+void FitBC1( _In_ const Texels& texels, _In_ const IndexBlock& block, uint32_t mask, bool bFourColors,
+             _In_ const EncodeParams& params, _Out_ BC1Candidate& best )
+{
+    float e0[4];
+    float e1[4];
+    if ( params.quality == BC_ENCODE_FAST )
+    {
+        FitBoundingBox( texels, mask, bFourColors ? 1.0f / 16.0f : 0.0f, e0, e1 );
+    }
+    else
+    {
+        FitPrincipalAxis( texels, mask, e0, e1 );
+    }
+    EvaluateBC1( block, mask, e0, e1, bFourColors, params, best );
+
+    const unsigned int refinements = GetRefinements( params.quality );
+    for( unsigned int r = 0; r < refinements && best.error; ++r )
+    {
+        float weights[16];
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            weights[i] = GetBC1Weight( best.indices[i], bFourColors );
+        }
+        if ( !FitLeastSquares( texels, mask, weights, e0, e1 ) )
+            break;
+
+        BC1Candidate candidate = best;
+        EvaluateBC1( block, mask, e0, e1, bFourColors, params, candidate );
+        if ( candidate.error >= best.error )
+            break;
+        best = candidate;
+    }
+}
+
+// Writes an 8 byte color block. Four color blocks need color0 > color1, and three color
+// blocks color0 <= color1, so the endpoints are swapped as needed. transparent has the
+// texels that get index 3 in three color mode
+void WriteBC1( _In_ const BC1Candidate& candidate, bool bFourColors, uint32_t transparent, _Out_writes_bytes_(8) uint8_t* dst )
+{
+    uint32_t c0 = candidate.c0;
+    uint32_t c1 = candidate.c1;
+    uint8_t remap[4] = { 0, 1, 2, 3 };
+    if ( bFourColors ? ( c0 < c1 ) : ( c0 > c1 ) )
+    {
+        std::swap( c0, c1 );
+        remap[0] = 1;
+        remap[1] = 0;
+        if ( bFourColors )
+        {
+            remap[2] = 3;
+            remap[3] = 2;
+        }
+    }
+
+    uint32_t indices = 0;
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        const uint32_t index = ( transparent & ( 1u << i ) ) ? 3u : remap[candidate.indices[i] & 3];
+        indices |= index << ( 2 * i );
+    }
+
+    Store16( c0, dst );
+    Store16( c1, dst + 2 );
+    Store16( indices & 0xffff, dst + 4 );
+    Store16( indices >> 16, dst + 6 );
+}
+
+// bCutout makes texels with alpha below 128 transparent, in three color mode
+void EncodeColorBlock( _In_ const Block& block, bool bCutout, _In_ const EncodeParams& params, _Out_writes_bytes_(8) uint8_t* dst )
+{
+    uint32_t transparent = 0;
+    if ( bCutout )
+    {
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            if ( block.texels[i][3] < 128 )
+            {
+                transparent |= 1u << i;
+            }
+        }
+    }
+
+    const uint32_t opaque = ALL_TEXELS & ~transparent;
+    if ( !opaque )
+    {
+        const BC1Candidate black = { 0, 0, {}, 0 };
+        WriteBC1( black, false, transparent, dst );
+        return;
+    }
+
+    Texels texels;
+    IndexBlock indexBlock;
+    ToFloat( block.texels, COLOR_CHANNELS, texels );
+    MakeIndexBlock( block.texels, COLOR_CHANNELS, indexBlock );
+
+    BC1Candidate best;
+    bool bFourColors = !transparent;
+    FitBC1( texels, indexBlock, opaque, bFourColors, params, best );
+
+    // Three colors may fit better, e.g. a smooth ramp that has the midpoint spot on. Only
+    // BC1 blocks (bCutout) can use it
+    if ( bCutout && !transparent && params.quality == BC_ENCODE_HIGH && best.error )
+    {
+        BC1Candidate threeColors;
+        FitBC1( texels, indexBlock, opaque, false, params, threeColors );
+        if ( threeColors.error < best.error )
+        {
+            best = threeColors;
+            bFourColors = false;
+        }
+    }
+
+    WriteBC1( best, bFourColors, transparent, dst );
+}
+
+//--------------------------------------------------------------------------------------
+// BC3 alpha and BC4 / BC5 UNORM blocks
+//--------------------------------------------------------------------------------------
+
+// The palette BCDecode.cpp decodes: eight values if a0 > a1, else six, 0 and 255
+void GetUnormPalette( int a0, int a1, _Out_ Palette& palette )
+{
+    memset( palette, 0, sizeof(int16_t) * 8 * 4 );
+    palette[0][0] = static_cast<int16_t>( a0 );
+    palette[1][0] = static_cast<int16_t>( a1 );
+    if ( a0 > a1 )
+    {
+        for( int i = 1; i < 7; ++i )
+        {
+            palette[i + 1][0] = static_cast<int16_t>( ( ( 7 - i ) * a0 + i * a1 + 3 ) / 7 );
+        }
+    }
+    else
+    {
+        for( int i = 1; i < 5; ++i )
+        {
+            palette[i + 1][0] = static_cast<int16_t>( ( ( 5 - i ) * a0 + i * a1 + 2 ) / 5 );
+        }
+        palette[6][0] = 0;
+        palette[7][0] = 255;
+    }
+}
+
+struct UnormCandidate
+{
+    int         a0;
+    int         a1;
+    uint8_t     indices[16];
+    uint32_t    error;
+};
+
+void EvaluateUnorm( _In_ const IndexBlock& block, int a0, int a1, _In_ const EncodeParams& params, _Inout_ UnormCandidate& best )
+{
+    UnormCandidate candidate;
+    candidate.a0 = Clamp( a0, 0, 255 );
+    candidate.a1 = Clamp( a1, 0, 255 );
+
+    Palette palette;
+    GetUnormPalette( candidate.a0, candidate.a1, palette );
+    candidate.error = params.findIndices( block, palette, 8, ALL_TEXELS, candidate.indices );
+    if ( candidate.error < best.error )
+    {
+        best = candidate;
+    }
+}
+
+// Encodes channel ch of the block into 8 bytes
+void EncodeUnormBlock( _In_ const Block& block, unsigned int ch, _In_ const EncodeParams& params, _Out_writes_bytes_(8) uint8_t* dst )
+{
+    uint8_t values[16][4] = {};
+    int lo = 255;
+    int hi = 0;
+    int innerLo = 255;
+    int innerHi = 0;
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        const int v = block.texels[i][ch];
+        values[i][0] = static_cast<uint8_t>( v );
+        lo = std::min( lo, v );
+        hi = std::max( hi, v );
+        if ( v != 0 && v != 255 )
+        {
+            innerLo = std::min( innerLo, v );
+            innerHi = std::max( innerHi, v );
+        }
+    }
+
+    IndexBlock indexBlock;
+    MakeIndexBlock( values, RED_CHANNEL, indexBlock );
+
+    UnormCandidate best;
+    best.error = UINT32_MAX;
+
+    // Eight values between the extremes; a0 > a1 selects them
+    EvaluateUnorm( indexBlock, hi, lo, params, best );
+
+    if ( params.quality != BC_ENCODE_FAST && best.error )
+    {
+        // Six values, with 0 and 255 on the side
+        if ( innerLo <= innerHi )
+        {
+            EvaluateUnorm( indexBlock, innerLo, innerHi, params, best );
+        }
+
+        Texels texels;
+        ToFloat( values, RED_CHANNEL, texels );
+
+        const unsigned int refinements = GetRefinements( params.quality );
+        for( unsigned int r = 0; r < refinements && best.error && best.a0 > best.a1; ++r )
+        {
+            float weights[16];
+            for( unsigned int i = 0; i < 16; ++i )
+            {
+                const uint8_t index = best.indices[i];
+                weights[i] = ( index < 2 ) ? static_cast<float>( index ) : static_cast<float>( index - 1 ) / 7.0f;
+            }
+
+            float e0[4];
+            float e1[4];
+            if ( !FitLeastSquares( texels, ALL_TEXELS, weights, e0, e1 ) )
+                break;
+
+            const uint32_t previous = best.error;
+            EvaluateUnorm( indexBlock, Round( e0[0] ), Round( e1[0] ), params, best );
+            if ( best.error >= previous )
+                break;
+        }
+
+        // Nudge the endpoints around the best ones
+        if ( params.quality == BC_ENCODE_HIGH && best.error )
+        {
+            const int a0 = best.a0;
+            const int a1 = best.a1;
+            for( int d0 = -2; d0 <= 2; ++d0 )
+            {
+                for( int d1 = -2; d1 <= 2; ++d1 )
+                {
+                    if ( d0 || d1 )
+                    {
+                        EvaluateUnorm( indexBlock, a0 + d0, a1 + d1, params, best );
+                    }
+                }
+            }
+        }
+    }
+
+    dst[0] = static_cast<uint8_t>( best.a0 );
+    dst[1] = static_cast<uint8_t>( best.a1 );
+    uint64_t indices = 0;
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        indices |= static_cast<uint64_t>( best.indices[i] ) << ( 3 * i );
+    }
+    for( unsigned int j = 0; j < 6; ++j )
+    {
+        dst[2 + j] = static_cast<uint8_t>( indices >> ( 8 * j ) );
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// BC7
+//--------------------------------------------------------------------------------------
+
+inline uint32_t Interpolate( uint32_t e0, uint32_t e1, uint32_t weight )
+{
+    return ( e0 * ( 64 - weight ) + e1 * weight + 32 ) >> 6;
+}
+
+// Mode 6: one subset of RGBA endpoints with 7 bits and a p-bit each, 4 bit indices
+struct Mode6Candidate
+{
+    uint32_t    e[2][4];        // 8 bit values, the p-bit in bit 0
+    uint8_t     indices[16];
+    uint32_t    error;
+};
+
+// The 8 bit value nearest to v that has p in bit 0
+inline uint32_t QuantizeWithPBit( float v, uint32_t p )
+{
+    return ( static_cast<uint32_t>( Clamp( Round( ( v - static_cast<float>( p ) ) * 0.5f ), 0, 127 ) ) << 1 ) | p;
+}
+
+void EvaluateMode6( _In_ const IndexBlock& block, _In_reads_(4) const float e0[4], _In_reads_(4) const float e1[4],
+                    uint32_t p0, uint32_t p1, _In_ const EncodeParams& params, _Inout_ Mode6Candidate& best )
+{
+    Mode6Candidate candidate;
+    for( unsigned int ch = 0; ch < 4; ++ch )
+    {
+        candidate.e[0][ch] = QuantizeWithPBit( e0[ch], p0 );
+        candidate.e[1][ch] = QuantizeWithPBit( e1[ch], p1 );
+    }
+
+    Palette palette;
+    for( unsigned int p = 0; p < 16; ++p )
+    {
+        for( unsigned int ch = 0; ch < 4; ++ch )
+        {
+            palette[p][ch] = static_cast<int16_t>( Interpolate( candidate.e[0][ch], candidate.e[1][ch], g_Weights4[p] ) );
+        }
+    }
+
+    candidate.error = params.findIndices( block, palette, 16, ALL_TEXELS, candidate.indices );
+    if ( candidate.error < best.error )
+    {
+        best = candidate;
+    }
+}
+
+// The p-bits that quantize an endpoint best, by themselves
+uint32_t GetBestPBit( _In_reads_(4) const float e[4] )
+{
+    float error[2] = { 0.0f, 0.0f };
+    for( uint32_t p = 0; p < 2; ++p )
+    {
+        for( unsigned int ch = 0; ch < 4; ++ch )
+        {
+            const float d = static_cast<float>( QuantizeWithPBit( e[ch], p ) ) - e[ch];
+            error[p] += d * d;
+        }
+    }
+    return ( error[1] < error[0] ) ? 1u : 0u;
+}
+
+void EvaluateMode6PBits( _In_ const IndexBlock& block, _In_reads_(4) const float e0[4], _In_reads_(4) const float e1[4],
+                         _In_ const EncodeParams& params, _Inout_ Mode6Candidate& best )
+{
+    if ( params.quality == BC_ENCODE_FAST )
+    {
+        EvaluateMode6( block, e0, e1, GetBestPBit( e0 ), GetBestPBit( e1 ), params, best );
+    }
+    else
+    {
+        for( uint32_t p = 0; p < 4; ++p )
+        {
+            EvaluateMode6( block, e0, e1, p & 1, p >> 1, params, best );
+        }
+    }
+}
+
+void FitMode6( _In_ const Texels& texels, _In_ const IndexBlock& block, _In_ const EncodeParams& params, _Out_ Mode6Candidate& best )
+{
+    float e0[4];
+    float e1[4];
+    if ( params.quality == BC_ENCODE_FAST )
+    {
+        FitBoundingBox( texels, ALL_TEXELS, 0.0f, e0, e1 );
+    }
+    else
+    {
+        FitPrincipalAxis( texels, ALL_TEXELS, e0, e1 );
+    }
+
+    best.error = UINT32_MAX;
+    EvaluateMode6PBits( block, e0, e1, params, best );
+
+    const unsigned int refinements = GetRefinements( params.quality );
+    for( unsigned int r = 0; r < refinements && best.error; ++r )
+    {
+        float weights[16];
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            weights[i] = static_cast<float>( g_Weights4[best.indices[i]] ) / 64.0f;
+        }
+        if ( !FitLeastSquares( texels, ALL_TEXELS, weights, e0, e1 ) )
+            break;
+
+        const uint32_t previous = best.error;
+        EvaluateMode6PBits( block, e0, e1, params, best );
+        if ( best.error >= previous )
+            break;
+    }
+}
+
+void WriteMode6( _In_ const Mode6Candidate& candidate, _Out_writes_bytes_(16) uint8_t* dst )
+{
+    // The anchor texel's index has an implied 0 on top
+    uint32_t e[2][4];
+    uint8_t indices[16];
+    memcpy( e, candidate.e, sizeof(e) );
+    memcpy( indices, candidate.indices, sizeof(indices) );
+    if ( indices[0] & 8 )
+    {
+        for( unsigned int ch = 0; ch < 4; ++ch )
+        {
+            std::swap( e[0][ch], e[1][ch] );
+        }
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            indices[i] = static_cast<uint8_t>( 15 - indices[i] );
+        }
+    }
+
+    BitWriter bits( dst );
+    bits.Write( 1u << 6, 7 );
+    for( unsigned int ch = 0; ch < 4; ++ch )
+    {
+        bits.Write( e[0][ch] >> 1, 7 );
+        bits.Write( e[1][ch] >> 1, 7 );
+    }
+    bits.Write( e[0][0] & 1, 1 );
+    bits.Write( e[1][0] & 1, 1 );
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        bits.Write( indices[i], i ? 4 : 3 );
+    }
+    assert( bits.GetPosition() == 128 );
+}
+
+// Mode 1: two subsets of RGB endpoints with 6 bits each and a p-bit shared by the subset,
+// 3 bit indices; alpha is 255
+struct Mode1Subset
+{
+    uint32_t    e[2][3];        // 7 bit values, the p-bit in bit 0
+    uint32_t    error;
+};
+
+struct Mode1Candidate
+{
+    unsigned int    partition;
+    Mode1Subset     subsets[2];
+    uint8_t         indices[16];
+    uint32_t        error;
+};
+
+inline uint32_t Expand7( uint32_t v ) { return ( v << 1 ) | ( v >> 6 ); }
+
+void EvaluateMode1Subset( _In_ const IndexBlock& block, uint32_t mask, _In_reads_(4) const float e0[4], _In_reads_(4) const float e1[4],
+                          uint32_t p, _In_ const EncodeParams& params, _Inout_ Mode1Subset& best, _Inout_updates_(16) uint8_t indices[16] )
+{
+    Mode1Subset candidate;
+    for( unsigned int ch = 0; ch < 3; ++ch )
+    {
+        // The 8 bit value is about 4 * q + 2 * p
+        candidate.e[0][ch] = ( static_cast<uint32_t>( Clamp( Round( ( e0[ch] - 2.0f * static_cast<float>( p ) ) * 0.25f ), 0, 63 ) ) << 1 ) | p;
+        candidate.e[1][ch] = ( static_cast<uint32_t>( Clamp( Round( ( e1[ch] - 2.0f * static_cast<float>( p ) ) * 0.25f ), 0, 63 ) ) << 1 ) | p;
+    }
+
+    Palette palette;
+    for( unsigned int i = 0; i < 8; ++i )
+    {
+        for( unsigned int ch = 0; ch < 3; ++ch )
+        {
+            palette[i][ch] = static_cast<int16_t>( Interpolate( Expand7( candidate.e[0][ch] ), Expand7( candidate.e[1][ch] ), g_Weights3[i] ) );
+        }
+        palette[i][3] = 255;
+    }
+
+    uint8_t subsetIndices[16];
+    candidate.error = params.findIndices( block, palette, 8, mask, subsetIndices );
+    if ( candidate.error < best.error )
+    {
+        best = candidate;
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            if ( mask & ( 1u << i ) )
+            {
+                indices[i] = subsetIndices[i];
+            }
+        }
+    }
+}
+
+void FitMode1( _In_ const Texels& texels, _In_ const IndexBlock& block, unsigned int partition, _In_ const EncodeParams& params,
+               _Out_ Mode1Candidate& out )
+{
+    out.partition = partition;
+    out.error = 0;
+    memset( out.indices, 0, sizeof(out.indices) );
+
+    const uint32_t masks[2] = { ALL_TEXELS & ~static_cast<uint32_t>( g_Partitions2[partition] ), g_Partitions2[partition] };
+    for( unsigned int s = 0; s < 2; ++s )
+    {
+        Mode1Subset& best = out.subsets[s];
+        best.error = UINT32_MAX;
+
+        float e0[4];
+        float e1[4];
+        FitPrincipalAxis( texels, masks[s], e0, e1 );
+        for( uint32_t p = 0; p < 2; ++p )
+        {
+            EvaluateMode1Subset( block, masks[s], e0, e1, p, params, best, out.indices );
+        }
+
+        for( unsigned int r = 0; r < 2 && best.error; ++r )
+        {
+            float weights[16];
+            for( unsigned int i = 0; i < 16; ++i )
+            {
+                weights[i] = static_cast<float>( g_Weights3[out.indices[i] & 7] ) / 64.0f;
+            }
+            if ( !FitLeastSquares( texels, masks[s], weights, e0, e1 ) )
+                break;
+
+            const uint32_t previous = best.error;
+            for( uint32_t p = 0; p < 2; ++p )
+            {
+                EvaluateMode1Subset( block, masks[s], e0, e1, p, params, best, out.indices );
+            }
+            if ( best.error >= previous )
+                break;
+        }
+
+        out.error += best.error;
+    }
+}
+
+void WriteMode1( _In_ const Mode1Candidate& candidate, _Out_writes_bytes_(16) uint8_t* dst )
+{
+    const unsigned int partition = candidate.partition;
+    const unsigned int anchors[2] = { 0, g_Anchor2[partition] };
+
+    Mode1Subset subsets[2];
+    uint8_t indices[16];
+    memcpy( subsets, candidate.subsets, sizeof(subsets) );
+    memcpy( indices, candidate.indices, sizeof(indices) );
+    for( unsigned int s = 0; s < 2; ++s )
+    {
+        if ( indices[anchors[s]] & 4 )
+        {
+            for( unsigned int ch = 0; ch < 3; ++ch )
+            {
+                std::swap( subsets[s].e[0][ch], subsets[s].e[1][ch] );
+            }
+            for( unsigned int i = 0; i < 16; ++i )
+            {
+                if ( ( ( g_Partitions2[partition] >> i ) & 1 ) == s )
+                {
+                    indices[i] = static_cast<uint8_t>( 7 - indices[i] );
+                }
+            }
+        }
+    }
+
+    BitWriter bits( dst );
+    bits.Write( 1u << 1, 2 );
+    bits.Write( partition, 6 );
+    for( unsigned int ch = 0; ch < 3; ++ch )
+    {
+        for( unsigned int s = 0; s < 2; ++s )
+        {
+            bits.Write( subsets[s].e[0][ch] >> 1, 6 );
+            bits.Write( subsets[s].e[1][ch] >> 1, 6 );
+        }
+    }
+    bits.Write( subsets[0].e[0][0] & 1, 1 );
+    bits.Write( subsets[1].e[0][0] & 1, 1 );
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        bits.Write( indices[i], ( i == anchors[0] || i == anchors[1] ) ? 2 : 3 );
+    }
+    assert( bits.GetPosition() == 128 );
+}
+
+// How many partitions mode 1 encodes in full, out of those whose subsets lie closest to
+// a line
+const unsigned int MODE1_PARTITIONS = 4;
+
+struct PartitionEstimate
+{
+    float           error;
+    unsigned int    partition;
+
+    bool operator<( const PartitionEstimate& other ) const { return error < other.error; }
+};
+
+// Sums of the RGB of some texels, and of their squares and products
+struct Moments
+{
+    float   count;
+    float   sum[3];
+    float   products[3][3];
+
+    Moments() :
+        count( 0.0f )
+    {
+        memset( sum, 0, sizeof(sum) );
+        memset( products, 0, sizeof(products) );
+    }
+
+    void Add( _In_reads_(3) const float c[3] )
+    {
+        count += 1.0f;
+        for( unsigned int a = 0; a < 3; ++a )
+        {
+            sum[a] += c[a];
+            for( unsigned int b = 0; b < 3; ++b )
+            {
+                products[a][b] += c[a] * c[b];
+            }
+        }
+    }
+
+    Moments Less( _In_ const Moments& other ) const
+    {
+        Moments result;
+        result.count = count - other.count;
+        for( unsigned int a = 0; a < 3; ++a )
+        {
+            result.sum[a] = sum[a] - other.sum[a];
+            for( unsigned int b = 0; b < 3; ++b )
+            {
+                result.products[a][b] = products[a][b] - other.products[a][b];
+            }
+        }
+        return result;
+    }
+
+    // The sum of the squared distances of the texels from their principal axis: the
+    // trace of their scatter matrix less its largest eigenvalue
+    float GetLineError() const
+    {
+        if ( count < 2.0f )
+            return 0.0f;
+
+        float scatter[3][3];
+        unsigned int largest = 0;
+        for( unsigned int a = 0; a < 3; ++a )
+        {
+            for( unsigned int b = 0; b < 3; ++b )
+            {
+                scatter[a][b] = products[a][b] - sum[a] * sum[b] / count;
+            }
+            if ( scatter[a][a] > scatter[largest][largest] )
+            {
+                largest = a;
+            }
+        }
+
+        const float trace = scatter[0][0] + scatter[1][1] + scatter[2][2];
+        float v[3] = { scatter[largest][0], scatter[largest][1], scatter[largest][2] };
+        for( unsigned int iteration = 0; iteration < 4; ++iteration )
+        {
+            float next[3];
+            float length = 0.0f;
+            for( unsigned int a = 0; a < 3; ++a )
+            {
+                next[a] = scatter[a][0] * v[0] + scatter[a][1] * v[1] + scatter[a][2] * v[2];
+                length += next[a] * next[a];
+            }
+            if ( length < 1e-6f )
+                return 0.0f;
+
+            const float scale = 1.0f / sqrtf( length );
+            for( unsigned int a = 0; a < 3; ++a )
+            {
+                v[a] = next[a] * scale;
+            }
+        }
+
+        float eigenvalue = 0.0f;
+        for( unsigned int a = 0; a < 3; ++a )
+        {
+            eigenvalue += v[a] * ( scatter[a][0] * v[0] + scatter[a][1] * v[1] + scatter[a][2] * v[2] );
+        }
+        return std::max( trace - eigenvalue, 0.0f );
+    }
+};
+
+void EncodeBC7Block( _In_ const Block& block, _In_ const EncodeParams& params, _Out_writes_bytes_(16) uint8_t* dst )
+{
+    Texels texels;
+    IndexBlock indexBlock;
+    ToFloat( block.texels, ALL_CHANNELS, texels );
+    MakeIndexBlock( block.texels, ALL_CHANNELS, indexBlock );
+
+    Mode6Candidate mode6;
+    FitMode6( texels, indexBlock, params, mode6 );
+
+    bool bOpaque = true;
+    for( unsigned int i = 0; i < 16; ++i )
+    {
+        bOpaque &= ( block.texels[i][3] == 255 );
+    }
+
+    if ( params.quality == BC_ENCODE_HIGH && bOpaque && mode6.error )
+    {
+        // Rank the partitions by the spread of their subsets off their principal axes. The
+        // sums of each subset come from those of the whole block less the other subset's
+        Moments all;
+        for( unsigned int i = 0; i < 16; ++i )
+        {
+            all.Add( texels.c[i] );
+        }
+
+        PartitionEstimate estimates[64];
+        for( unsigned int partition = 0; partition < 64; ++partition )
+        {
+            Moments subset1;
+            for( unsigned int i = 0; i < 16; ++i )
+            {
+                if ( ( g_Partitions2[partition] >> i ) & 1 )
+                {
+                    subset1.Add( texels.c[i] );
+                }
+            }
+
+            estimates[partition].partition = partition;
+            estimates[partition].error = all.Less( subset1 ).GetLineError() + subset1.GetLineError();
+        }
+        std::partial_sort( estimates, estimates + MODE1_PARTITIONS, estimates + 64 );
+
+        Mode1Candidate best;
+        FitMode1( texels, indexBlock, estimates[0].partition, params, best );
+        for( unsigned int j = 1; j < MODE1_PARTITIONS; ++j )
+        {
+            Mode1Candidate candidate;
+            FitMode1( texels, indexBlock, estimates[j].partition, params, candidate );
+            if ( candidate.error < best.error )
+            {
+                best = candidate;
+            }
+        }
+
+        if ( best.error < mode6.error )
+        {
+            WriteMode1( best, dst );
+            return;
+        }
+    }
+
+    WriteMode6( mode6, dst );
+}
+
+//--------------------------------------------------------------------------------------
+// Formats
+//--------------------------------------------------------------------------------------
+void EncodeBC1Block( _In_ const Block& block, _In_ const EncodeParams& params, _Out_ uint8_t* dst )
+{
+    EncodeColorBlock( block, true, params, dst );
+}
+
+void EncodeBC3Block( _In_ const Block& block, _In_ const EncodeParams& params, _Out_ uint8_t* dst )
+{
+    EncodeUnormBlock( block, 3, params, dst );
+    EncodeColorBlock( block, false, params, dst + 8 );
+}
+
+void EncodeBC4Block( _In_ const Block& block, _In_ const EncodeParams& params, _Out_ uint8_t* dst )
+{
+    EncodeUnormBlock( block, 0, params, dst );
+}
+
+void EncodeBC5Block( _In_ const Block& block, _In_ const EncodeParams& params, _Out_ uint8_t* dst )
+{
+    EncodeUnormBlock( block, 0, params, dst );
+    EncodeUnormBlock( block, 1, params, dst + 8 );
+}
+
+typedef void (*EncodeBlockFunc)( _In_ const Block& block, _In_ const EncodeParams& params, _Out_ uint8_t* dst );
+
+bool GetEncoder( DXGI_FORMAT format, _Out_ EncodeBlockFunc& encode, _Out_ size_t& blockBytes )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+        encode = EncodeBC1Block;
+        blockBytes = 8;
+        return true;
+
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+        encode = EncodeBC3Block;
+        blockBytes = 16;
+        return true;
+
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+        encode = EncodeBC4Block;
+        blockBytes = 8;
+        return true;
+
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+        encode = EncodeBC5Block;
+        blockBytes = 16;
+        return true;
+
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        encode = EncodeBC7Block;
+        blockBytes = 16;
+        return true;
+
+    default:
+        encode = nullptr;
+        blockBytes = 0;
+        return false;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Threads
+//--------------------------------------------------------------------------------------
+struct EncodeJob
+{
+    const uint8_t*  src;
+    size_t          srcRowPitch;
+    uint8_t*        dst;
+    size_t          dstRowPitch;
+    size_t          width;
+    size_t          height;
+};
+
+struct EncodeWork
+{
+    const EncodeJob*    jobs;
+    DXGI_FORMAT         format;
+    unsigned int        flags;
+};
+
+void RunEncodeJob( _Inout_ void* context, size_t job )
+{
+    const EncodeWork* work = static_cast<const EncodeWork*>( context );
+    const EncodeJob& j = work->jobs[job];
+    (void)EncodeBC( work->format, j.width, j.height, j.src, j.srcRowPitch, j.dst, j.dstRowPitch, work->flags );
+}
+
+};
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool DirectX::IsBCEncodable( DXGI_FORMAT format )
+{
+    EncodeBlockFunc encode;
+    size_t blockBytes;
+    return GetEncoder( format, encode, blockBytes );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::EncodeBC( DXGI_FORMAT format,
+                           size_t width,
+                           size_t height,
+                           const uint8_t* src,
+                           size_t srcRowPitch,
+                           uint8_t* dst,
+                           size_t dstRowPitch,
+                           unsigned int flags )
+{
+    if ( !src || !dst )
+        return E_INVALIDARG;
+
+    EncodeBlockFunc encode;
+    size_t blockBytes;
+    if ( !GetEncoder( format, encode, blockBytes ) )
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+
+    const size_t blocksWide = ( width + 3 ) / 4;
+    const size_t blocksHigh = ( height + 3 ) / 4;
+    if ( srcRowPitch < width * 4 || dstRowPitch < blocksWide * blockBytes )
+        return E_INVALIDARG;
+
+    EncodeParams params;
+    params.quality = flags & BC_ENCODE_QUALITY_MASK;
+    if ( params.quality > BC_ENCODE_HIGH )
+    {
+        params.quality = BC_ENCODE_HIGH;
+    }
+#if defined(BC_ENCODE_SSE2)
+    params.findIndices = ( flags & BC_ENCODE_REFERENCE ) ? FindIndicesReference : FindIndicesSSE2;
+#else
+    params.findIndices = FindIndicesReference;
+#endif
+
+    for( size_t by = 0; by < blocksHigh; ++by )
+    {
+        const uint8_t* srcRow = src + by * 4 * srcRowPitch;
+        uint8_t* block = dst + by * dstRowPitch;
+        const size_t rows = std::min<size_t>( height - by * 4, 4 );
+
+        for( size_t bx = 0; bx < blocksWide; ++bx, block += blockBytes )
+        {
+            Block texels;
+            LoadBlock( srcRow + bx * 16, srcRowPitch, std::min<size_t>( width - bx * 4, 4 ), rows, texels );
+            encode( texels, params, block );
+        }
+    }
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::EncodeBCTexture( DXGI_FORMAT format,
+                                  DXGI_FORMAT srcFormat,
+                                  size_t width,
+                                  size_t height,
+                                  size_t mipCount,
+                                  size_t arraySize,
+                                  const D3D11_SUBRESOURCE_DATA* src,
+                                  unsigned int numThreads,
+                                  unsigned int flags,
+                                  EncodedTexture& texture )
+{
+    texture.format = DXGI_FORMAT_UNKNOWN;
+    texture.width = 0;
+    texture.height = 0;
+    texture.mipCount = 0;
+    texture.arraySize = 0;
+    texture.mips.reset();
+    texture.bits.reset();
+    texture.bitSize = 0;
+
+    if ( !src || !width || !height || !mipCount || !arraySize )
+        return E_INVALIDARG;
+
+    if ( !IsBCEncodable( format ) )
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+
+    switch( srcFormat )
+    {
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        break;
+
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        format = MakeSRGB( format );
+        break;
+
+    default:
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+    }
+
+    const size_t numMips = mipCount * arraySize;
+    if ( numMips / arraySize != mipCount )
+        return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+
+    std::unique_ptr<DDSMipLayout[]> mips( new (std::nothrow) DDSMipLayout[ numMips ] );
+    if ( !mips )
+        return E_OUTOFMEMORY;
+
+    // Lay the mips out the way a DDS file does
+    size_t totalBytes = 0;
+    size_t numJobs = 0;
+    for( size_t item = 0; item < arraySize; ++item )
+    {
+        for( size_t mip = 0; mip < mipCount; ++mip )
+        {
+            DDSMipLayout& layout = mips[item * mipCount + mip];
+            memset( &layout, 0, sizeof(layout) );
+            layout.width = std::max<size_t>( width >> std::min<size_t>( mip, 63 ), 1 );
+            layout.height = std::max<size_t>( height >> std::min<size_t>( mip, 63 ), 1 );
+            layout.depth = 1;
+
+            HRESULT hr = GetSurfaceInfo( layout.width, layout.height, format, &layout.numBytes, &layout.rowBytes, &layout.numRows );
+            if ( FAILED( hr ) )
+                return hr;
+
+            if ( !src[item * mipCount + mip].pSysMem || src[item * mipCount + mip].SysMemPitch < layout.width * 4 )
+                return E_INVALIDARG;
+
+            layout.slicePitch = layout.numBytes;
+            if ( totalBytes > SIZE_MAX - layout.numBytes )
+                return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+            layout.offset = totalBytes;
+            totalBytes += layout.numBytes;
+
+            numJobs += ( layout.numRows + STRIP_BLOCK_ROWS - 1 ) / STRIP_BLOCK_ROWS;
+        }
+    }
+
+    std::unique_ptr<uint8_t[]> bits( new (std::nothrow) uint8_t[ totalBytes ] );
+    if ( !bits )
+        return E_OUTOFMEMORY;
+
+    std::vector<EncodeJob> jobs;
+    jobs.reserve( numJobs );
+    for( size_t index = 0; index < numMips; ++index )
+    {
+        const DDSMipLayout& layout = mips[index];
+        const uint8_t* pixels = static_cast<const uint8_t*>( src[index].pSysMem );
+        for( size_t blockRow = 0; blockRow < layout.numRows; blockRow += STRIP_BLOCK_ROWS )
+        {
+            EncodeJob job;
+            job.src = pixels + blockRow * 4 * src[index].SysMemPitch;
+            job.srcRowPitch = src[index].SysMemPitch;
+            job.dst = bits.get() + layout.offset + blockRow * layout.rowBytes;
+            job.dstRowPitch = layout.rowBytes;
+            job.width = layout.width;
+            job.height = std::min( layout.height - blockRow * 4, STRIP_BLOCK_ROWS * 4 );
+            jobs.push_back( job );
+        }
+    }
+
+    if ( !jobs.empty() )
+    {
+        EncodeWork work;
+        work.jobs = &jobs[0];
+        work.format = format;
+        work.flags = flags;
+        RunJobs( RunEncodeJob, &work, jobs.size(), numThreads );
+    }
+
+    texture.format = format;
+    texture.width = width;
+    texture.height = height;
+    texture.mipCount = mipCount;
+    texture.arraySize = arraySize;
+    texture.mips = std::move( mips );
+    texture.bits = std::move( bits );
+    texture.bitSize = totalBytes;
+
+    return S_OK;
+}
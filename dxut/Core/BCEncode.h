@@ -0,0 +1,102 @@
+//--------------------------------------------------------------------------------------
+// File: BCEncode.h
+//
+// Software encoder for BC1, BC3, BC4, BC5 and BC7, so textures that are generated or
+// converted at run time (e.g. WIC images) can be block compressed without a GPU, and
+// cached on disk as DDS files.
+//
+// The source is R8G8B8A8_UNORM (or _SRGB) texels. BC4 encodes red, BC5 red and green;
+// BC1 keeps alpha as a 1 bit cutout at 128, BC3 and BC7 keep all of it. sRGB texels are
+// encoded as they are and give the _SRGB variant of the format.
+//
+// Quality tiers:
+//   - BC_ENCODE_FAST fits the endpoints to the bounding box of each block
+//   - BC_ENCODE_NORMAL fits them to the principal axis of the colors, and refines them
+//     by least squares on the indices that come out of it
+//   - BC_ENCODE_HIGH refines until nothing improves, tries the three color mode of BC1
+//     and small endpoint searches for BC3 alpha and BC4/5, and has BC7 try two subsets
+//     (mode 1) on the most promising partitions of opaque blocks, besides mode 6
+//
+// Endpoints are judged against palettes that decode like BCDecode.cpp. The SSE2 code,
+// which finds the nearest palette entry of four texels at a time, picks the same indices
+// as the scalar code that BC_ENCODE_REFERENCE selects.
+//
+// Nothing here needs a Direct3D device, so it builds headless like DDSFile.cpp.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "DDSFile.h"
+
+#if defined(_MSC_VER) && (_MSC_VER<1610) && !defined(_Out_writes_bytes_)
+#define _Out_writes_bytes_(exp)
+#endif
+
+namespace DirectX
+{
+    enum BC_ENCODE_FLAGS
+    {
+        BC_ENCODE_FAST          = 0x0,
+        BC_ENCODE_NORMAL        = 0x1,
+        BC_ENCODE_HIGH          = 0x2,
+        BC_ENCODE_QUALITY_MASK  = 0x3,
+
+        BC_ENCODE_REFERENCE     = 0x10, // scalar code only
+    };
+
+    // Whether format is one EncodeBC can write: BC1, BC3, BC7 and the UNORM BC4 and BC5,
+    // typeless or not
+    bool IsBCEncodable( _In_ DXGI_FORMAT format );
+
+    // Encodes a 2D surface of RGBA8 texels. width and height are in texels; blocks on the
+    // right and bottom edges repeat the last column and row. dstRowPitch is the size of a
+    // row of blocks
+    HRESULT EncodeBC( _In_ DXGI_FORMAT format,
+                      _In_ size_t width,
+                      _In_ size_t height,
+                      _In_reads_bytes_(srcRowPitch*height) const uint8_t* src,
+                      _In_ size_t srcRowPitch,
+                      _Out_writes_bytes_(dstRowPitch*((height+3)/4)) uint8_t* dst,
+                      _In_ size_t dstRowPitch,
+                      _In_ unsigned int flags );
+
+    // A compressed texture, with its mips laid out like in a DDS file, item by item and
+    // finest mip first: mips[item * mipCount + mip] is where each one is in bits
+    struct EncodedTexture
+    {
+        DXGI_FORMAT                     format;
+        size_t                          width;
+        size_t                          height;
+        size_t                          mipCount;
+        size_t                          arraySize;
+        std::unique_ptr<DDSMipLayout[]> mips;
+        std::unique_ptr<uint8_t[]>      bits;
+        size_t                          bitSize;
+    };
+
+    // Encodes every mip of every array item of a 2D texture. src holds the RGBA8 texels of
+    // each one, src[item * mipCount + mip], with the dimensions of a full mip chain from
+    // width x height down; sRGB source formats give sRGB encoded formats. The rows of
+    // blocks are shared out between numThreads threads (0 for one per processor), the
+    // calling thread included
+    HRESULT EncodeBCTexture( _In_ DXGI_FORMAT format,
+                             _In_ DXGI_FORMAT srcFormat,
+                             _In_ size_t width,
+                             _In_ size_t height,
+                             _In_ size_t mipCount,
+                             _In_ size_t arraySize,
+                             _In_reads_(mipCount*arraySize) const D3D11_SUBRESOURCE_DATA* src,
+                             _In_ unsigned int numThreads,
+                             _In_ unsigned int flags,
+                             _Out_ EncodedTexture& texture );
+}
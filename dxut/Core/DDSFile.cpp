@@ -0,0 +1,1389 @@
+//--------------------------------------------------------------------------------------
+// File: DDSFile.cpp
+//
+// DDS header parsing, subresource layout and read-only file views for DDSTextureLoader
+//
+// This file doesn't include DXUT and doesn't touch a Direct3D device, so it can be built
+// into a headless test or benchmark.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "DDSFile.h"
+#include "DDSZFile.h"
+
+#include <assert.h>
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <algorithm>
+#include <string>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#endif
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)-1)
+#endif
+
+using namespace DirectX;
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+#if defined(_WIN32)
+struct handle_closer { void operator()(HANDLE h) { if (h) CloseHandle(h); } };
+
+typedef public std::unique_ptr<void, handle_closer> ScopedHandle;
+
+inline HANDLE safe_handle( HANDLE h ) { return (h == INVALID_HANDLE_VALUE) ? 0 : h; }
+#endif
+
+// Reads are split so a single request never exceeds what a DWORD / ssize_t can hold
+const size_t READ_CHUNK_SIZE = 0x40000000;
+
+// Whether both files exist and the first was last written before the second
+#if defined(_WIN32)
+bool IsOlder( const wchar_t* fileName, const wchar_t* otherName )
+{
+    WIN32_FILE_ATTRIBUTE_DATA fileInfo, otherInfo;
+    return GetFileAttributesExW( fileName, GetFileExInfoStandard, &fileInfo )
+        && GetFileAttributesExW( otherName, GetFileExInfoStandard, &otherInfo )
+        && CompareFileTime( &fileInfo.ftLastWriteTime, &otherInfo.ftLastWriteTime ) < 0;
+}
+#else
+bool GetWriteTime( const wchar_t* fileName, time_t& writeTime )
+{
+    size_t pathLength = wcstombs( nullptr, fileName, 0 );
+    if ( pathLength == static_cast<size_t>( -1 ) )
+    {
+        return false;
+    }
+
+    std::vector<char> path( pathLength + 1 );
+    wcstombs( &path[0], fileName, path.size() );
+
+    struct stat fileStat;
+    if ( stat( &path[0], &fileStat ) != 0 )
+    {
+        return false;
+    }
+
+    writeTime = fileStat.st_mtime;
+    return true;
+}
+
+bool IsOlder( const wchar_t* fileName, const wchar_t* otherName )
+{
+    time_t fileTime, otherTime;
+    return GetWriteTime( fileName, fileTime ) && GetWriteTime( otherName, otherTime ) && fileTime < otherTime;
+}
+#endif
+
+};
+
+//--------------------------------------------------------------------------------------
+// MappedFile
+//--------------------------------------------------------------------------------------
+MappedFile::MappedFile() :
+    m_data( nullptr ),
+    m_size( 0 ),
+    m_mapped( false )
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+void MappedFile::Close()
+{
+    if ( m_mapped && m_data )
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile( m_data );
+#else
+        munmap( const_cast<uint8_t*>( m_data ), m_size );
+#endif
+    }
+
+    m_heapData.reset();
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+}
+
+_Use_decl_annotations_
+HRESULT MappedFile::Open( const wchar_t* fileName )
+{
+    Close();
+
+    if ( !fileName )
+    {
+        return E_INVALIDARG;
+    }
+
+    // A .ddsz file next to a .dds file is read in its place, unless the .dds file was
+    // written after it, e.g. when the media changed and DDSZConvert wasn't run again
+    const size_t length = wcslen( fileName );
+    if ( length >= 4 && fileName[length - 4] == L'.'
+         && towlower( fileName[length - 3] ) == L'd'
+         && towlower( fileName[length - 2] ) == L'd'
+         && towlower( fileName[length - 1] ) == L's' )
+    {
+        std::wstring ddszName( fileName );
+        ddszName += L'z';
+        if ( !IsOlder( ddszName.c_str(), fileName )
+             && SUCCEEDED( OpenFile( ddszName.c_str() ) ) && IsDDSZ( m_data, m_size ) && SUCCEEDED( Decompress() ) )
+        {
+            return S_OK;
+        }
+
+        Close();
+    }
+
+    HRESULT hr = OpenFile( fileName );
+    if ( FAILED(hr) )
+    {
+        return hr;
+    }
+
+    // Or the file itself may be a DDSZ file
+    if ( IsDDSZ( m_data, m_size ) )
+    {
+        hr = Decompress();
+        if ( FAILED(hr) )
+        {
+            Close();
+            return hr;
+        }
+    }
+
+    return S_OK;
+}
+
+// Replaces the view of a DDSZ file with the DDS file decompressed into the heap, on a
+// thread per processor
+HRESULT MappedFile::Decompress()
+{
+    std::unique_ptr<uint8_t[]> ddsData;
+    size_t ddsSize = 0;
+    HRESULT hr = DecompressDDSZ( m_data, m_size, 0, ddsData, ddsSize );
+    if ( FAILED(hr) )
+    {
+        return hr;
+    }
+
+    Close();
+
+    m_heapData = std::move( ddsData );
+    m_data = m_heapData.get();
+    m_size = ddsSize;
+    return S_OK;
+}
+
+#if defined(_WIN32)
+
+_Use_decl_annotations_
+HRESULT MappedFile::OpenFile( const wchar_t* fileName )
+{
+    Close();
+
+    if ( !fileName )
+    {
+        return E_INVALIDARG;
+    }
+
+    // open the file, telling the cache manager it will be read front to back
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    CREATEFILE2_EXTENDED_PARAMETERS params = { sizeof(CREATEFILE2_EXTENDED_PARAMETERS), 0 };
+    params.dwFileAttributes = FILE_ATTRIBUTE_NORMAL;
+    params.dwFileFlags = FILE_FLAG_SEQUENTIAL_SCAN;
+    ScopedHandle hFile( safe_handle( CreateFile2( fileName,
+                                                  GENERIC_READ,
+                                                  FILE_SHARE_READ,
+                                                  OPEN_EXISTING,
+                                                  &params ) ) );
+#else
+    ScopedHandle hFile( safe_handle( CreateFileW( fileName,
+                                                  GENERIC_READ,
+                                                  FILE_SHARE_READ,
+                                                  nullptr,
+                                                  OPEN_EXISTING,
+                                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                                  nullptr ) ) );
+#endif
+
+    if ( !hFile )
+    {
+        return HRESULT_FROM_WIN32( GetLastError() );
+    }
+
+    // Get the file size
+    LARGE_INTEGER FileSize = { 0 };
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_VISTA)
+    FILE_STANDARD_INFO fileInfo;
+    if ( !GetFileInformationByHandleEx( hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo) ) )
+    {
+        return HRESULT_FROM_WIN32( GetLastError() );
+    }
+    FileSize = fileInfo.EndOfFile;
+#else
+    if ( !GetFileSizeEx( hFile.get(), &FileSize ) )
+    {
+        return HRESULT_FROM_WIN32( GetLastError() );
+    }
+#endif
+
+    // A 64-bit process can view files larger than 4 GB; only reject what can't be addressed
+    if ( FileSize.QuadPart < 0 || static_cast<uint64_t>( FileSize.QuadPart ) > SIZE_MAX )
+    {
+        return HRESULT_FROM_WIN32( ERROR_FILE_TOO_LARGE );
+    }
+
+    size_t fileSize = static_cast<size_t>( FileSize.QuadPart );
+    if ( !fileSize )
+    {
+        return S_OK;
+    }
+
+    // The view keeps the section and the file open, so both handles can be closed once it's mapped
+    ScopedHandle hMapping( CreateFileMappingW( hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr ) );
+    if ( hMapping )
+    {
+        void* view = MapViewOfFile( hMapping.get(), FILE_MAP_READ, 0, 0, 0 );
+        if ( view )
+        {
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) && WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+            // Start reading the whole file in large sequential I/Os, instead of one page fault at a time
+            WIN32_MEMORY_RANGE_ENTRY range = { view, fileSize };
+            PrefetchVirtualMemory( GetCurrentProcess(), 1, &range, 0 );
+#endif
+            m_data = static_cast<const uint8_t*>( view );
+            m_size = fileSize;
+            m_mapped = true;
+            return S_OK;
+        }
+    }
+
+    // Fall back to reading the file into the heap
+    std::unique_ptr<uint8_t[]> heapData( new (std::nothrow) uint8_t[ fileSize ] );
+    if ( !heapData )
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    for( size_t offset = 0; offset < fileSize; )
+    {
+        DWORD bytesToRead = static_cast<DWORD>( std::min( fileSize - offset, READ_CHUNK_SIZE ) );
+        DWORD bytesRead = 0;
+        if ( !ReadFile( hFile.get(), heapData.get() + offset, bytesToRead, &bytesRead, nullptr ) )
+        {
+            return HRESULT_FROM_WIN32( GetLastError() );
+        }
+
+        if ( bytesRead < bytesToRead )
+        {
+            return E_FAIL;
+        }
+
+        offset += bytesRead;
+    }
+
+    m_heapData = std::move( heapData );
+    m_data = m_heapData.get();
+    m_size = fileSize;
+    return S_OK;
+}
+
+#else
+
+_Use_decl_annotations_
+HRESULT MappedFile::OpenFile( const wchar_t* fileName )
+{
+    Close();
+
+    if ( !fileName )
+    {
+        return E_INVALIDARG;
+    }
+
+    // POSIX paths are multibyte strings in the current locale
+    size_t pathLength = wcstombs( nullptr, fileName, 0 );
+    if ( pathLength == static_cast<size_t>( -1 ) )
+    {
+        return E_INVALIDARG;
+    }
+
+    std::vector<char> path( pathLength + 1 );
+    wcstombs( &path[0], fileName, path.size() );
+
+    int fd = open( &path[0], O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        return E_FAIL;
+    }
+
+    struct stat fileStat;
+    if ( fstat( fd, &fileStat ) != 0 || fileStat.st_size < 0 ||
+         static_cast<uint64_t>( fileStat.st_size ) > SIZE_MAX )
+    {
+        close( fd );
+        return E_FAIL;
+    }
+
+    size_t fileSize = static_cast<size_t>( fileStat.st_size );
+    if ( !fileSize )
+    {
+        close( fd );
+        return S_OK;
+    }
+
+    // The mapping stays valid after the descriptor is closed. Note a file truncated by
+    // another process while it's mapped raises SIGBUS on access
+    posix_fadvise( fd, 0, 0, POSIX_FADV_SEQUENTIAL );
+    void* view = mmap( nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( view != MAP_FAILED )
+    {
+        close( fd );
+
+        madvise( view, fileSize, MADV_SEQUENTIAL );
+        madvise( view, fileSize, MADV_WILLNEED );
+
+        m_data = static_cast<const uint8_t*>( view );
+        m_size = fileSize;
+        m_mapped = true;
+        return S_OK;
+    }
+
+    // Fall back to reading the file into the heap
+    std::unique_ptr<uint8_t[]> heapData( new (std::nothrow) uint8_t[ fileSize ] );
+    if ( !heapData )
+    {
+        close( fd );
+        return E_OUTOFMEMORY;
+    }
+
+    for( size_t offset = 0; offset < fileSize; )
+    {
+        ssize_t bytesRead = read( fd, heapData.get() + offset, std::min( fileSize - offset, READ_CHUNK_SIZE ) );
+        if ( bytesRead <= 0 )
+        {
+            close( fd );
+            return E_FAIL;
+        }
+
+        offset += static_cast<size_t>( bytesRead );
+    }
+
+    close( fd );
+
+    m_heapData = std::move( heapData );
+    m_data = m_heapData.get();
+    m_size = fileSize;
+    return S_OK;
+}
+
+#endif
+
+
+//--------------------------------------------------------------------------------------
+// Return the BPP for a particular format
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+size_t DirectX::BitsPerPixel( DXGI_FORMAT fmt )
+{
+    switch( fmt )
+    {
+    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+        return 128;
+
+    case DXGI_FORMAT_R32G32B32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+    case DXGI_FORMAT_R32G32B32_UINT:
+    case DXGI_FORMAT_R32G32B32_SINT:
+        return 96;
+
+    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+    case DXGI_FORMAT_R32G32_TYPELESS:
+    case DXGI_FORMAT_R32G32_FLOAT:
+    case DXGI_FORMAT_R32G32_UINT:
+    case DXGI_FORMAT_R32G32_SINT:
+    case DXGI_FORMAT_R32G8X24_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+    case DXGI_FORMAT_Y416:
+    case DXGI_FORMAT_Y210:
+    case DXGI_FORMAT_Y216:
+        return 64;
+
+    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+    case DXGI_FORMAT_R10G10B10A2_UINT:
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+    case DXGI_FORMAT_R8G8B8A8_SINT:
+    case DXGI_FORMAT_R16G16_TYPELESS:
+    case DXGI_FORMAT_R16G16_FLOAT:
+    case DXGI_FORMAT_R16G16_UNORM:
+    case DXGI_FORMAT_R16G16_UINT:
+    case DXGI_FORMAT_R16G16_SNORM:
+    case DXGI_FORMAT_R16G16_SINT:
+    case DXGI_FORMAT_R32_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT:
+    case DXGI_FORMAT_R32_FLOAT:
+    case DXGI_FORMAT_R32_UINT:
+    case DXGI_FORMAT_R32_SINT:
+    case DXGI_FORMAT_R24G8_TYPELESS:
+    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+    case DXGI_FORMAT_R8G8_B8G8_UNORM:
+    case DXGI_FORMAT_G8R8_G8B8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DXGI_FORMAT_AYUV:
+    case DXGI_FORMAT_Y410:
+    case DXGI_FORMAT_YUY2:
+        return 32;
+
+    case DXGI_FORMAT_P010:
+    case DXGI_FORMAT_P016:
+        return 24;
+
+    case DXGI_FORMAT_R8G8_TYPELESS:
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R8G8_UINT:
+    case DXGI_FORMAT_R8G8_SNORM:
+    case DXGI_FORMAT_R8G8_SINT:
+    case DXGI_FORMAT_R16_TYPELESS:
+    case DXGI_FORMAT_R16_FLOAT:
+    case DXGI_FORMAT_D16_UNORM:
+    case DXGI_FORMAT_R16_UNORM:
+    case DXGI_FORMAT_R16_UINT:
+    case DXGI_FORMAT_R16_SNORM:
+    case DXGI_FORMAT_R16_SINT:
+    case DXGI_FORMAT_B5G6R5_UNORM:
+    case DXGI_FORMAT_B5G5R5A1_UNORM:
+    case DXGI_FORMAT_A8P8:
+    case DXGI_FORMAT_B4G4R4A4_UNORM:
+        return 16;
+
+    case DXGI_FORMAT_NV12:
+    case DXGI_FORMAT_420_OPAQUE:
+    case DXGI_FORMAT_NV11:
+        return 12;
+
+    case DXGI_FORMAT_R8_TYPELESS:
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_R8_UINT:
+    case DXGI_FORMAT_R8_SNORM:
+    case DXGI_FORMAT_R8_SINT:
+    case DXGI_FORMAT_A8_UNORM:
+    case DXGI_FORMAT_AI44:
+    case DXGI_FORMAT_IA44:
+    case DXGI_FORMAT_P8:
+        return 8;
+
+    case DXGI_FORMAT_R1_UNORM:
+        return 1;
+
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        return 4;
+
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return 8;
+
+    default:
+        return 0;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+DXGI_FORMAT DirectX::MakeSRGB( DXGI_FORMAT format )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC1_UNORM:
+        return DXGI_FORMAT_BC1_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC2_UNORM:
+        return DXGI_FORMAT_BC2_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC3_UNORM:
+        return DXGI_FORMAT_BC3_UNORM_SRGB;
+
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+        return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+        return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC7_UNORM:
+        return DXGI_FORMAT_BC7_UNORM_SRGB;
+
+    default:
+        return format;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Get surface information for a particular format
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GetSurfaceInfo( size_t width,
+                                 size_t height,
+                                 DXGI_FORMAT fmt,
+                                 size_t* outNumBytes,
+                                 size_t* outRowBytes,
+                                 size_t* outNumRows )
+{
+    // Computed in 64 bits, so a large surface fails instead of wrapping in a 32-bit build
+    uint64_t numBytes = 0;
+    uint64_t rowBytes = 0;
+    uint64_t numRows = 0;
+
+    bool bc = false;
+    bool packed = false;
+    bool planar = false;
+    uint64_t bpe = 0;
+    switch (fmt)
+    {
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        bc=true;
+        bpe = 8;
+        break;
+
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        bc = true;
+        bpe = 16;
+        break;
+
+    case DXGI_FORMAT_R8G8_B8G8_UNORM:
+    case DXGI_FORMAT_G8R8_G8B8_UNORM:
+    case DXGI_FORMAT_YUY2:
+        packed = true;
+        bpe = 4;
+        break;
+
+    case DXGI_FORMAT_Y210:
+    case DXGI_FORMAT_Y216:
+        packed = true;
+        bpe = 8;
+        break;
+
+    case DXGI_FORMAT_NV12:
+    case DXGI_FORMAT_420_OPAQUE:
+        planar = true;
+        bpe = 2;
+        break;
+
+    case DXGI_FORMAT_P010:
+    case DXGI_FORMAT_P016:
+        planar = true;
+        bpe = 4;
+        break;
+    }
+
+    if (bc)
+    {
+        uint64_t numBlocksWide = 0;
+        if (width > 0)
+        {
+            numBlocksWide = std::max<uint64_t>( 1, (uint64_t(width) + 3u) / 4u );
+        }
+        uint64_t numBlocksHigh = 0;
+        if (height > 0)
+        {
+            numBlocksHigh = std::max<uint64_t>( 1, (uint64_t(height) + 3u) / 4u );
+        }
+        rowBytes = numBlocksWide * bpe;
+        numRows = numBlocksHigh;
+        numBytes = rowBytes * numBlocksHigh;
+    }
+    else if (packed)
+    {
+        rowBytes = ( ( uint64_t(width) + 1u ) >> 1 ) * bpe;
+        numRows = uint64_t(height);
+        numBytes = rowBytes * height;
+    }
+    else if ( fmt == DXGI_FORMAT_NV11 )
+    {
+        rowBytes = ( ( uint64_t(width) + 3u ) >> 2 ) * 4u;
+        numRows = uint64_t(height) * 2u; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+        numBytes = rowBytes * numRows;
+    }
+    else if (planar)
+    {
+        rowBytes = ( ( uint64_t(width) + 1u ) >> 1 ) * bpe;
+        numBytes = ( rowBytes * height ) + ( ( rowBytes * height + 1u ) >> 1 );
+        numRows = height + ( ( uint64_t(height) + 1u ) >> 1 );
+    }
+    else
+    {
+        size_t bpp = BitsPerPixel( fmt );
+        if (!bpp)
+        {
+            return E_INVALIDARG;
+        }
+
+        rowBytes = ( uint64_t(width) * bpp + 7u ) / 8u; // round up to nearest byte
+        numRows = uint64_t(height);
+        numBytes = rowBytes * height;
+    }
+
+    if (numBytes > SIZE_MAX || rowBytes > SIZE_MAX || numRows > SIZE_MAX)
+    {
+        return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+    }
+
+    if (outNumBytes)
+    {
+        *outNumBytes = static_cast<size_t>( numBytes );
+    }
+    if (outRowBytes)
+    {
+        *outRowBytes = static_cast<size_t>( rowBytes );
+    }
+    if (outNumRows)
+    {
+        *outNumRows = static_cast<size_t>( numRows );
+    }
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+#define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
+
+static DXGI_FORMAT GetDXGIFormat( const DDS_PIXELFORMAT& ddpf )
+{
+    if (ddpf.flags & DDS_RGB)
+    {
+        // Note that sRGB formats are written using the "DX10" extended header
+
+        switch (ddpf.RGBBitCount)
+        {
+        case 32:
+            if (ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0xff000000))
+            {
+                return DXGI_FORMAT_R8G8B8A8_UNORM;
+            }
+
+            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0xff000000))
+            {
+                return DXGI_FORMAT_B8G8R8A8_UNORM;
+            }
+
+            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0x00000000))
+            {
+                return DXGI_FORMAT_B8G8R8X8_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
+
+            // Note that many common DDS reader/writers (including D3DX) swap the
+            // the RED/BLUE masks for 10:10:10:2 formats. We assume
+            // below that the 'backwards' header mask is being used since it is most
+            // likely written by D3DX. The more robust solution is to use the 'DX10'
+            // header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
+
+            // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
+            if (ISBITMASK(0x3ff00000,0x000ffc00,0x000003ff,0xc0000000))
+            {
+                return DXGI_FORMAT_R10G10B10A2_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+
+            if (ISBITMASK(0x0000ffff,0xffff0000,0x00000000,0x00000000))
+            {
+                return DXGI_FORMAT_R16G16_UNORM;
+            }
+
+            if (ISBITMASK(0xffffffff,0x00000000,0x00000000,0x00000000))
+            {
+                // Only 32-bit color channel format in D3D9 was R32F
+                return DXGI_FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
+            }
+            break;
+
+        case 24:
+            // No 24bpp DXGI formats aka D3DFMT_R8G8B8
+            break;
+
+        case 16:
+            if (ISBITMASK(0x7c00,0x03e0,0x001f,0x8000))
+            {
+                return DXGI_FORMAT_B5G5R5A1_UNORM;
+            }
+            if (ISBITMASK(0xf800,0x07e0,0x001f,0x0000))
+            {
+                return DXGI_FORMAT_B5G6R5_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+
+            if (ISBITMASK(0x0f00,0x00f0,0x000f,0xf000))
+            {
+                return DXGI_FORMAT_B4G4R4A4_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+
+            // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
+            break;
+        }
+    }
+    else if (ddpf.flags & DDS_LUMINANCE)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x00000000))
+            {
+                return DXGI_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+
+            // No DXGI format maps to ISBITMASK(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
+        }
+
+        if (16 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x0000ffff,0x00000000,0x00000000,0x00000000))
+            {
+                return DXGI_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x0000ff00))
+            {
+                return DXGI_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+        }
+    }
+    else if (ddpf.flags & DDS_ALPHA)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            return DXGI_FORMAT_A8_UNORM;
+        }
+    }
+    else if (ddpf.flags & DDS_BUMPDUDV)
+    {
+        if (16 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x00ff, 0xff00, 0x0000, 0x0000))
+            {
+                return DXGI_FORMAT_R8G8_SNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+        }
+
+        if (32 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+            {
+                return DXGI_FORMAT_R8G8B8A8_SNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+            if (ISBITMASK(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
+            {
+                return DXGI_FORMAT_R16G16_SNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+
+            // No DXGI format maps to ISBITMASK(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000) aka D3DFMT_A2W10V10U10
+        }
+    }
+
+
+    else if (ddpf.flags & DDS_FOURCC)
+    {
+        if (MAKEFOURCC( 'D', 'X', 'T', '1' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC1_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '3' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '5' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC3_UNORM;
+        }
+
+        // While pre-multiplied alpha isn't directly supported by the DXGI formats,
+        // they are basically the same as these BC formats so they can be mapped
+        if (MAKEFOURCC( 'D', 'X', 'T', '2' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '4' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC3_UNORM;
+        }
+
+        if (MAKEFOURCC( 'A', 'T', 'I', '1' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '4', 'U' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '4', 'S' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_SNORM;
+        }
+
+        if (MAKEFOURCC( 'A', 'T', 'I', '2' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '5', 'U' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '5', 'S' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_SNORM;
+        }
+
+        // BC6H and BC7 are written using the "DX10" extended header
+
+        if (MAKEFOURCC( 'R', 'G', 'B', 'G' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_R8G8_B8G8_UNORM;
+        }
+        if (MAKEFOURCC( 'G', 'R', 'G', 'B' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_G8R8_G8B8_UNORM;
+        }
+
+        if (MAKEFOURCC('Y','U','Y','2') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_YUY2;
+        }
+
+        // Check for D3DFORMAT enums being set here
+        switch( ddpf.fourCC )
+        {
+        case 36: // D3DFMT_A16B16G16R16
+            return DXGI_FORMAT_R16G16B16A16_UNORM;
+
+        case 110: // D3DFMT_Q16W16V16U16
+            return DXGI_FORMAT_R16G16B16A16_SNORM;
+
+        case 111: // D3DFMT_R16F
+            return DXGI_FORMAT_R16_FLOAT;
+
+        case 112: // D3DFMT_G16R16F
+            return DXGI_FORMAT_R16G16_FLOAT;
+
+        case 113: // D3DFMT_A16B16G16R16F
+            return DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+        case 114: // D3DFMT_R32F
+            return DXGI_FORMAT_R32_FLOAT;
+
+        case 115: // D3DFMT_G32R32F
+            return DXGI_FORMAT_R32G32_FLOAT;
+
+        case 116: // D3DFMT_A32B32G32R32F
+            return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        }
+    }
+
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::FillInitData( size_t width,
+                               size_t height,
+                               size_t depth,
+                               size_t mipCount,
+                               size_t arraySize,
+                               DXGI_FORMAT format,
+                               size_t maxsize,
+                               size_t bitSize,
+                               const uint8_t* bitData,
+                               size_t& twidth,
+                               size_t& theight,
+                               size_t& tdepth,
+                               size_t& skipMip,
+                               D3D11_SUBRESOURCE_DATA* initData )
+{
+    if ( !bitData || !initData )
+    {
+        return E_POINTER;
+    }
+
+    skipMip = 0;
+    twidth = 0;
+    theight = 0;
+    tdepth = 0;
+
+    size_t NumBytes = 0;
+    size_t RowBytes = 0;
+    size_t offset = 0;
+
+    size_t index = 0;
+    for( size_t j = 0; j < arraySize; j++ )
+    {
+        size_t w = width;
+        size_t h = height;
+        size_t d = depth;
+        for( size_t i = 0; i < mipCount; i++ )
+        {
+            HRESULT hr = GetSurfaceInfo( w,
+                                         h,
+                                         format,
+                                         &NumBytes,
+                                         &RowBytes,
+                                         nullptr
+                                       );
+            if ( FAILED(hr) )
+            {
+                return hr;
+            }
+
+            // D3D11_SUBRESOURCE_DATA pitches are 32-bit
+            if ( RowBytes > UINT32_MAX || NumBytes > UINT32_MAX )
+            {
+                return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+            }
+
+            if ( (mipCount <= 1) || !maxsize || (w <= maxsize && h <= maxsize && d <= maxsize) )
+            {
+                if ( !twidth )
+                {
+                    twidth = w;
+                    theight = h;
+                    tdepth = d;
+                }
+
+                assert(index < mipCount * arraySize);
+                _Analysis_assume_(index < mipCount * arraySize);
+                initData[index].pSysMem = ( const void* )( bitData + offset );
+                initData[index].SysMemPitch = static_cast<UINT>( RowBytes );
+                initData[index].SysMemSlicePitch = static_cast<UINT>( NumBytes );
+                ++index;
+            }
+            else if ( !j )
+            {
+                // Count number of skipped mipmaps (first item only)
+                ++skipMip;
+            }
+
+            // Compare sizes rather than pointers, so a corrupt header can't wrap the end pointer
+            uint64_t mipBytes = uint64_t(NumBytes) * d;
+            if (mipBytes > bitSize - offset)
+            {
+                return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+            }
+
+            offset += static_cast<size_t>( mipBytes );
+
+            w = w >> 1;
+            h = h >> 1;
+            d = d >> 1;
+            if (w == 0)
+            {
+                w = 1;
+            }
+            if (h == 0)
+            {
+                h = 1;
+            }
+            if (d == 0)
+            {
+                d = 1;
+            }
+        }
+    }
+
+    return (index > 0) ? S_OK : E_FAIL;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GetMipLayout( const DDSTextureDesc& desc,
+                               size_t item,
+                               size_t mip,
+                               DDSMipLayout& layout )
+{
+    memset( &layout, 0, sizeof(layout) );
+
+    if ( item >= desc.arraySize || mip >= desc.mipCount )
+    {
+        return E_INVALIDARG;
+    }
+
+    // Bytes of one whole item, and of the mips of an item before the one asked for
+    uint64_t itemBytes = 0;
+    uint64_t mipOffset = 0;
+
+    size_t w = desc.width;
+    size_t h = desc.height;
+    size_t d = desc.depth;
+    for( size_t i = 0; i < desc.mipCount; i++ )
+    {
+        size_t NumBytes = 0;
+        size_t RowBytes = 0;
+        size_t NumRows = 0;
+        HRESULT hr = GetSurfaceInfo( w, h, desc.format, &NumBytes, &RowBytes, &NumRows );
+        if ( FAILED(hr) )
+        {
+            return hr;
+        }
+
+        if ( i == mip )
+        {
+            mipOffset = itemBytes;
+            layout.numBytes = NumBytes * d;
+            layout.rowBytes = RowBytes;
+            layout.numRows = NumRows;
+            layout.slicePitch = NumBytes;
+            layout.width = w;
+            layout.height = h;
+            layout.depth = d;
+        }
+
+        itemBytes += uint64_t(NumBytes) * d;
+
+        w = std::max<size_t>( w >> 1, 1 );
+        h = std::max<size_t>( h >> 1, 1 );
+        d = std::max<size_t>( d >> 1, 1 );
+    }
+
+    // With itemBytes bounded by the file, the offset below can't overflow 64 bits
+    if ( itemBytes > desc.bitSize )
+    {
+        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+    }
+
+    uint64_t offset = itemBytes * item + mipOffset;
+    if ( offset > desc.bitSize || layout.numBytes > desc.bitSize - offset )
+    {
+        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+    }
+
+    layout.offset = static_cast<size_t>( offset );
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::ParseDDSHeader( const uint8_t* ddsData,
+                                 size_t ddsDataSize,
+                                 DDSTextureDesc& desc )
+{
+    memset( &desc, 0, sizeof(desc) );
+
+    // Need at least enough data to fill the header and magic number to be a valid DDS
+    if (ddsDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
+    {
+        return E_FAIL;
+    }
+
+    if (!ddsData)
+    {
+        return E_POINTER;
+    }
+
+    // DDS files always start with the same magic number ("DDS ")
+    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData );
+    if (dwMagicNumber != DDS_MAGIC)
+    {
+        return E_FAIL;
+    }
+
+    auto header = reinterpret_cast<const DDS_HEADER*>( ddsData + sizeof( uint32_t ) );
+
+    // Verify header to validate DDS file
+    if (header->size != sizeof(DDS_HEADER) ||
+        header->ddspf.size != sizeof(DDS_PIXELFORMAT))
+    {
+        return E_FAIL;
+    }
+
+    // Check for DX10 extension
+    bool bDXT10Header = false;
+    if ((header->ddspf.flags & DDS_FOURCC) &&
+        (MAKEFOURCC( 'D', 'X', '1', '0' ) == header->ddspf.fourCC) )
+    {
+        // Must be long enough for both headers and magic value
+        if (ddsDataSize < (sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10)))
+        {
+            return E_FAIL;
+        }
+
+        bDXT10Header = true;
+    }
+
+    size_t offset = sizeof( uint32_t )
+                    + sizeof( DDS_HEADER )
+                    + (bDXT10Header ? sizeof( DDS_HEADER_DXT10 ) : 0);
+
+    UINT width = header->width;
+    UINT height = header->height;
+    UINT depth = header->depth;
+
+    uint32_t resDim = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+    UINT arraySize = 1;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    bool isCubeMap = false;
+
+    size_t mipCount = header->mipMapCount;
+    if (0 == mipCount)
+    {
+        mipCount = 1;
+    }
+
+    if (bDXT10Header)
+    {
+        auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>( (const char*)header + sizeof(DDS_HEADER) );
+
+        arraySize = d3d10ext->arraySize;
+        if (arraySize == 0)
+        {
+           return HRESULT_FROM_WIN32( ERROR_INVALID_DATA );
+        }
+
+        switch( d3d10ext->dxgiFormat )
+        {
+        case DXGI_FORMAT_AI44:
+        case DXGI_FORMAT_IA44:
+        case DXGI_FORMAT_P8:
+        case DXGI_FORMAT_A8P8:
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+
+        default:
+            if ( BitsPerPixel( d3d10ext->dxgiFormat ) == 0 )
+            {
+                return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+            }
+        }
+           
+        format = d3d10ext->dxgiFormat;
+
+        switch ( d3d10ext->resourceDimension )
+        {
+        case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
+            // D3DX writes 1D textures with a fixed Height of 1
+            if ((header->flags & DDS_HEIGHT) && height != 1)
+            {
+                return HRESULT_FROM_WIN32( ERROR_INVALID_DATA );
+            }
+            height = depth = 1;
+            break;
+
+        case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
+            if (d3d10ext->miscFlag & D3D11_RESOURCE_MISC_TEXTURECUBE)
+            {
+                arraySize *= 6;
+                isCubeMap = true;
+            }
+            depth = 1;
+            break;
+
+        case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
+            if (!(header->flags & DDS_HEADER_FLAGS_VOLUME))
+            {
+                return HRESULT_FROM_WIN32( ERROR_INVALID_DATA );
+            }
+
+            if (arraySize > 1)
+            {
+                return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+            }
+            break;
+
+        default:
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+        }
+
+        resDim = d3d10ext->resourceDimension;
+    }
+    else
+    {
+        format = GetDXGIFormat( header->ddspf );
+
+        if (format == DXGI_FORMAT_UNKNOWN)
+        {
+           return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+        }
+
+        if (header->flags & DDS_HEADER_FLAGS_VOLUME)
+        {
+            resDim = D3D11_RESOURCE_DIMENSION_TEXTURE3D;
+        }
+        else 
+        {
+            if (header->caps2 & DDS_CUBEMAP)
+            {
+                // We require all six faces to be defined
+                if ((header->caps2 & DDS_CUBEMAP_ALLFACES ) != DDS_CUBEMAP_ALLFACES)
+                {
+                    return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+                }
+
+                arraySize = 6;
+                isCubeMap = true;
+            }
+
+            depth = 1;
+            resDim = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+
+            // Note there's no way for a legacy Direct3D 9 DDS to express a '1D' texture
+        }
+
+        assert( BitsPerPixel( format ) != 0 );
+    }
+
+    // Bound sizes (for security purposes we don't trust DDS file metadata larger than the D3D 11.x hardware requirements)
+    if (mipCount > D3D11_REQ_MIP_LEVELS)
+    {
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+    }
+
+    switch ( resDim )
+    {
+    case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
+        if ((arraySize > D3D11_REQ_TEXTURE1D_ARRAY_AXIS_DIMENSION) ||
+            (width > D3D11_REQ_TEXTURE1D_U_DIMENSION) )
+        {
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+        }
+        break;
+
+    case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
+        if ( isCubeMap )
+        {
+            // This is the right bound because we set arraySize to (NumCubes*6) above
+            if ((arraySize > D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
+                (width > D3D11_REQ_TEXTURECUBE_DIMENSION) ||
+                (height > D3D11_REQ_TEXTURECUBE_DIMENSION))
+            {
+                return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+            }
+        }
+        else if ((arraySize > D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
+                    (width > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION) ||
+                    (height > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION))
+        {
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+        }
+        break;
+
+    case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
+        if ((arraySize > 1) ||
+            (width > D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
+            (height > D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
+            (depth > D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION) )
+        {
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+        }
+        break;
+
+    default:
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+    }
+
+    desc.header = header;
+    desc.bitData = ddsData + offset;
+    desc.bitSize = ddsDataSize - offset;
+    desc.resDim = resDim;
+    desc.width = width;
+    desc.height = height;
+    desc.depth = depth;
+    desc.mipCount = mipCount;
+    desc.arraySize = arraySize;
+    desc.format = format;
+    desc.isCubeMap = isCubeMap;
+
+    return S_OK;
+}
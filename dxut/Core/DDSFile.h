@@ -0,0 +1,241 @@
+//--------------------------------------------------------------------------------------
+// File: DDSFile.h
+//
+// DDS file structures, header parsing and subresource layout, and a read-only view of
+// a file for DDSTextureLoader
+//
+// Nothing here needs a Direct3D device, so a DDS file can be mapped, validated and laid
+// out into subresources headless, e.g. to test or benchmark the loader without a GPU.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <d3d11.h>
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#endif
+#include <stdint.h>
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#include <memory>
+
+#if defined(_MSC_VER) && (_MSC_VER<1610) && !defined(_In_reads_)
+#define _In_reads_(exp)
+#define _Out_writes_(exp)
+#define _In_reads_bytes_(exp)
+#endif
+
+#ifndef _Use_decl_annotations_
+#define _Use_decl_annotations_
+#endif
+
+//--------------------------------------------------------------------------------------
+// Macros
+//--------------------------------------------------------------------------------------
+#ifndef MAKEFOURCC
+    #define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
+                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
+                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
+#endif /* defined(MAKEFOURCC) */
+
+//--------------------------------------------------------------------------------------
+// DDS file structure definitions
+//
+// See DDS.h in the 'Texconv' sample and the 'DirectXTex' library
+//--------------------------------------------------------------------------------------
+#pragma pack(push,1)
+
+const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+struct DDS_PIXELFORMAT
+{
+    uint32_t    size;
+    uint32_t    flags;
+    uint32_t    fourCC;
+    uint32_t    RGBBitCount;
+    uint32_t    RBitMask;
+    uint32_t    GBitMask;
+    uint32_t    BBitMask;
+    uint32_t    ABitMask;
+};
+
+#define DDS_FOURCC      0x00000004  // DDPF_FOURCC
+#define DDS_RGB         0x00000040  // DDPF_RGB
+#define DDS_LUMINANCE   0x00020000  // DDPF_LUMINANCE
+#define DDS_ALPHA       0x00000002  // DDPF_ALPHA
+#define DDS_BUMPDUDV    0x00080000  // DDPF_BUMPDUDV
+
+#define DDS_HEADER_FLAGS_VOLUME         0x00800000  // DDSD_DEPTH
+
+#define DDS_HEIGHT 0x00000002 // DDSD_HEIGHT
+#define DDS_WIDTH  0x00000004 // DDSD_WIDTH
+
+#define DDS_CUBEMAP_POSITIVEX 0x00000600 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
+#define DDS_CUBEMAP_NEGATIVEX 0x00000a00 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
+#define DDS_CUBEMAP_POSITIVEY 0x00001200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
+#define DDS_CUBEMAP_NEGATIVEY 0x00002200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEY
+#define DDS_CUBEMAP_POSITIVEZ 0x00004200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEZ
+#define DDS_CUBEMAP_NEGATIVEZ 0x00008200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEZ
+
+#define DDS_CUBEMAP_ALLFACES ( DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX |\
+                               DDS_CUBEMAP_POSITIVEY | DDS_CUBEMAP_NEGATIVEY |\
+                               DDS_CUBEMAP_POSITIVEZ | DDS_CUBEMAP_NEGATIVEZ )
+
+#define DDS_CUBEMAP 0x00000200 // DDSCAPS2_CUBEMAP
+
+enum DDS_MISC_FLAGS2
+{
+    DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7L,
+};
+
+struct DDS_HEADER
+{
+    uint32_t        size;
+    uint32_t        flags;
+    uint32_t        height;
+    uint32_t        width;
+    uint32_t        pitchOrLinearSize;
+    uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
+    uint32_t        mipMapCount;
+    uint32_t        reserved1[11];
+    DDS_PIXELFORMAT ddspf;
+    uint32_t        caps;
+    uint32_t        caps2;
+    uint32_t        caps3;
+    uint32_t        caps4;
+    uint32_t        reserved2;
+};
+
+struct DDS_HEADER_DXT10
+{
+    DXGI_FORMAT     dxgiFormat;
+    uint32_t        resourceDimension;
+    uint32_t        miscFlag; // see D3D11_RESOURCE_MISC_FLAG
+    uint32_t        arraySize;
+    uint32_t        miscFlags2;
+};
+
+#pragma pack(pop)
+namespace DirectX
+{
+    // A DDS file after its headers have been validated. The dimensions have been checked
+    // against the Direct3D 11 limits, and bitData points just past the headers, into the
+    // memory that was parsed
+    struct DDSTextureDesc
+    {
+        const DDS_HEADER*   header;
+        const uint8_t*      bitData;
+        size_t              bitSize;
+        uint32_t            resDim;     // D3D11_RESOURCE_DIMENSION
+        size_t              width;
+        size_t              height;
+        size_t              depth;
+        size_t              mipCount;
+        size_t              arraySize;  // includes the 6 faces of a cube map
+        DXGI_FORMAT         format;
+        bool                isCubeMap;
+    };
+
+    // Validates the magic value, the headers and the format of a DDS file in memory
+    HRESULT ParseDDSHeader( _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+                            _In_ size_t ddsDataSize,
+                            _Out_ DDSTextureDesc& desc );
+
+    size_t BitsPerPixel( _In_ DXGI_FORMAT fmt );
+
+    // The sRGB variant of a format, or the format itself if it has none
+    DXGI_FORMAT MakeSRGB( _In_ DXGI_FORMAT format );
+
+    // Fails if the surface is too large for size_t
+    HRESULT GetSurfaceInfo( _In_ size_t width,
+                            _In_ size_t height,
+                            _In_ DXGI_FORMAT fmt,
+                            _Out_opt_ size_t* outNumBytes,
+                            _Out_opt_ size_t* outRowBytes,
+                            _Out_opt_ size_t* outNumRows );
+
+    // Points each subresource at its bits in bitData, skipping the top mips that exceed
+    // maxsize (0 for no limit). twidth, theight and tdepth return the top mip that was kept
+    HRESULT FillInitData( _In_ size_t width,
+                          _In_ size_t height,
+                          _In_ size_t depth,
+                          _In_ size_t mipCount,
+                          _In_ size_t arraySize,
+                          _In_ DXGI_FORMAT format,
+                          _In_ size_t maxsize,
+                          _In_ size_t bitSize,
+                          _In_reads_bytes_(bitSize) const uint8_t* bitData,
+                          _Out_ size_t& twidth,
+                          _Out_ size_t& theight,
+                          _Out_ size_t& tdepth,
+                          _Out_ size_t& skipMip,
+                          _Out_writes_(mipCount*arraySize) D3D11_SUBRESOURCE_DATA* initData );
+
+    // Where one mip of one array item (or cube face) is in a DDS file, relative to bitData.
+    // Each item stores its mips finest first, and the items follow one another
+    struct DDSMipLayout
+    {
+        size_t              offset;
+        size_t              numBytes;   // all depth slices
+        size_t              rowBytes;
+        size_t              numRows;    // of blocks for block compressed formats
+        size_t              slicePitch;
+        size_t              width;
+        size_t              height;
+        size_t              depth;
+    };
+
+    // Fails if item or mip is out of range, or the mip doesn't fit in bitSize
+    HRESULT GetMipLayout( _In_ const DDSTextureDesc& desc,
+                          _In_ size_t item,
+                          _In_ size_t mip,
+                          _Out_ DDSMipLayout& layout );
+
+    // A read-only view of a whole file. The file is memory mapped, with a hint that it will
+    // be read sequentially, so subresources can be uploaded straight from the page cache
+    // without a copy; if it can't be mapped it's read into the heap instead. The data stays
+    // valid until Close or destruction.
+    //
+    // DDSZ files (DDSZFile.h) are decompressed into the heap on open, and a name.ddsz file
+    // next to name.dds is opened in its place as long as it's at least as new, so the
+    // loaders always see a DDS file
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        HRESULT Open( _In_z_ const wchar_t* fileName );
+        void Close();
+
+        const uint8_t* data() const { return m_data; }
+        size_t size() const { return m_size; }
+        bool IsMapped() const { return m_mapped; }
+
+    private:
+        MappedFile( const MappedFile& );
+        MappedFile& operator=( const MappedFile& );
+
+        HRESULT OpenFile( _In_z_ const wchar_t* fileName );
+        HRESULT Decompress();
+
+        const uint8_t*              m_data;
+        size_t                      m_size;
+        bool                        m_mapped;
+        std::unique_ptr<uint8_t[]>  m_heapData;
+    };
+}
@@ -0,0 +1,359 @@
+//--------------------------------------------------------------------------------------
+// File: DDSZFile.cpp
+//
+// DDSZ compression and parallel decompression
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "DDSZFile.h"
+#include "BCCommon.h"
+#include "LZ4Block.h"
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)-1)
+#endif
+
+using namespace DirectX;
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+struct CompressContext
+{
+    const uint8_t*          ddsData;
+    DDSZ_BLOCK*             blocks;
+    uint8_t*                scratch;
+    const size_t*           scratchOffsets;
+};
+
+// Each block compresses into its own part of the scratch buffer, and is kept as it is
+// unless that makes it smaller
+void CompressBlock( void* context, size_t job )
+{
+    CompressContext* ctx = static_cast<CompressContext*>( context );
+    DDSZ_BLOCK& block = ctx->blocks[job];
+
+    const uint8_t* src = ctx->ddsData + static_cast<size_t>( block.offset );
+    uint8_t* dst = ctx->scratch + ctx->scratchOffsets[job];
+
+    size_t dataSize = LZ4CompressBlock( src, block.size, dst, LZ4CompressBound( block.size ) );
+    if ( dataSize && dataSize < block.size )
+    {
+        block.codec = DDSZ_CODEC_LZ4;
+        block.dataSize = static_cast<uint32_t>( dataSize );
+    }
+    else
+    {
+        memcpy( dst, src, block.size );
+        block.codec = DDSZ_CODEC_NONE;
+        block.dataSize = block.size;
+    }
+}
+
+struct DecompressContext
+{
+    const uint8_t*          ddszData;
+    const DDSZ_BLOCK*       blocks;
+    uint8_t*                ddsData;
+    bool*                   succeeded;
+};
+
+void DecompressBlock( void* context, size_t job )
+{
+    DecompressContext* ctx = static_cast<DecompressContext*>( context );
+    const DDSZ_BLOCK& block = ctx->blocks[job];
+
+    const uint8_t* src = ctx->ddszData + static_cast<size_t>( block.dataOffset );
+    uint8_t* dst = ctx->ddsData + static_cast<size_t>( block.offset );
+
+    if ( block.codec == DDSZ_CODEC_LZ4 )
+    {
+        ctx->succeeded[job] = LZ4DecompressBlock( src, block.dataSize, dst, block.size );
+    }
+    else
+    {
+        memcpy( dst, src, block.size );
+        ctx->succeeded[job] = true;
+    }
+}
+
+};
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool DirectX::IsDDSZ( const uint8_t* data, size_t dataSize )
+{
+    if ( !data || dataSize < sizeof(uint32_t) )
+        return false;
+
+    uint32_t magic;
+    memcpy( &magic, data, sizeof(magic) );
+    return magic == DDSZ_MAGIC;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::CompressDDS( const uint8_t* ddsData,
+                              size_t ddsSize,
+                              unsigned int numThreads,
+                              std::unique_ptr<uint8_t[]>& ddszData,
+                              size_t& ddszSize )
+{
+    ddszData.reset();
+    ddszSize = 0;
+
+    DDSTextureDesc desc;
+    HRESULT hr = ParseDDSHeader( ddsData, ddsSize, desc );
+    if ( FAILED(hr) )
+    {
+        return hr;
+    }
+
+    const size_t headerSize = static_cast<size_t>( desc.bitData - ddsData );
+
+    // Cut the data at the start and end of every mip, so a block never spans two
+    std::vector<size_t> cuts;
+    cuts.push_back( 0 );
+    cuts.push_back( desc.bitSize );
+    for( size_t item = 0; item < desc.arraySize; ++item )
+    {
+        for( size_t mip = 0; mip < desc.mipCount; ++mip )
+        {
+            DDSMipLayout layout;
+            hr = GetMipLayout( desc, item, mip, layout );
+            if ( FAILED(hr) )
+            {
+                return hr;
+            }
+
+            cuts.push_back( layout.offset );
+            cuts.push_back( layout.offset + layout.numBytes );
+        }
+    }
+    std::sort( cuts.begin(), cuts.end() );
+    cuts.erase( std::unique( cuts.begin(), cuts.end() ), cuts.end() );
+
+    // Then cut large mips into blocks of at most DDSZ_MAX_BLOCK_SIZE
+    std::vector<DDSZ_BLOCK> blocks;
+    std::vector<size_t> scratchOffsets;
+    size_t scratchSize = 0;
+    for( size_t i = 0; i + 1 < cuts.size(); ++i )
+    {
+        for( size_t offset = cuts[i]; offset < cuts[i + 1]; offset += DDSZ_MAX_BLOCK_SIZE )
+        {
+            DDSZ_BLOCK block;
+            memset( &block, 0, sizeof(block) );
+            block.offset = headerSize + offset;
+            block.size = static_cast<uint32_t>( std::min<size_t>( cuts[i + 1] - offset, DDSZ_MAX_BLOCK_SIZE ) );
+            blocks.push_back( block );
+
+            scratchOffsets.push_back( scratchSize );
+            scratchSize += LZ4CompressBound( block.size );
+        }
+    }
+
+    std::unique_ptr<uint8_t[]> scratch;
+    if ( !blocks.empty() )
+    {
+        scratch.reset( new (std::nothrow) uint8_t[ scratchSize ] );
+        if ( !scratch )
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        CompressContext context;
+        context.ddsData = ddsData;
+        context.blocks = &blocks[0];
+        context.scratch = scratch.get();
+        context.scratchOffsets = &scratchOffsets[0];
+        BC::RunJobs( CompressBlock, &context, blocks.size(), numThreads );
+    }
+
+    // Lay out the file now the size of every block is known
+    const size_t tableSize = blocks.size() * sizeof(DDSZ_BLOCK);
+    size_t outSize = sizeof(DDSZ_HEADER) + tableSize + headerSize;
+    for( size_t i = 0; i < blocks.size(); ++i )
+    {
+        blocks[i].dataOffset = outSize;
+        outSize += blocks[i].dataSize;
+    }
+
+    std::unique_ptr<uint8_t[]> out( new (std::nothrow) uint8_t[ outSize ] );
+    if ( !out )
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    DDSZ_HEADER header;
+    header.magic = DDSZ_MAGIC;
+    header.version = DDSZ_VERSION;
+    header.ddsSize = ddsSize;
+    header.headerSize = static_cast<uint32_t>( headerSize );
+    header.numBlocks = static_cast<uint32_t>( blocks.size() );
+
+    uint8_t* dst = out.get();
+    memcpy( dst, &header, sizeof(header) );
+    dst += sizeof(header);
+    if ( tableSize )
+    {
+        memcpy( dst, &blocks[0], tableSize );
+        dst += tableSize;
+    }
+    memcpy( dst, ddsData, headerSize );
+    dst += headerSize;
+    for( size_t i = 0; i < blocks.size(); ++i )
+    {
+        memcpy( dst, scratch.get() + scratchOffsets[i], blocks[i].dataSize );
+        dst += blocks[i].dataSize;
+    }
+
+    ddszData = std::move( out );
+    ddszSize = outSize;
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::DecompressDDSZ( const uint8_t* ddszData,
+                                 size_t ddszSize,
+                                 unsigned int numThreads,
+                                 std::unique_ptr<uint8_t[]>& ddsData,
+                                 size_t& ddsSize )
+{
+    ddsData.reset();
+    ddsSize = 0;
+
+    if ( !ddszData )
+    {
+        return E_POINTER;
+    }
+
+    if ( ddszSize < sizeof(DDSZ_HEADER) || !IsDDSZ( ddszData, ddszSize ) )
+    {
+        return E_FAIL;
+    }
+
+    DDSZ_HEADER header;
+    memcpy( &header, ddszData, sizeof(header) );
+    if ( header.version != DDSZ_VERSION )
+    {
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+    }
+
+    if ( header.ddsSize > SIZE_MAX || header.headerSize > header.ddsSize )
+    {
+        return E_FAIL;
+    }
+
+    // The block table and the DDS headers must fit in the file
+    size_t remaining = ddszSize - sizeof(DDSZ_HEADER);
+    if ( header.numBlocks > remaining / sizeof(DDSZ_BLOCK) )
+    {
+        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+    }
+
+    std::vector<DDSZ_BLOCK> blocks( header.numBlocks );
+    const size_t tableSize = blocks.size() * sizeof(DDSZ_BLOCK);
+    if ( tableSize )
+    {
+        memcpy( &blocks[0], ddszData + sizeof(DDSZ_HEADER), tableSize );
+    }
+    remaining -= tableSize;
+
+    if ( header.headerSize > remaining )
+    {
+        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+    }
+
+    // The blocks must follow one another from the end of the headers to the end of the
+    // DDS file, and each must read from inside the DDSZ file
+    uint64_t expectedOffset = header.headerSize;
+    for( size_t i = 0; i < blocks.size(); ++i )
+    {
+        const DDSZ_BLOCK& block = blocks[i];
+
+        if ( block.offset != expectedOffset || !block.size || block.size > header.ddsSize - expectedOffset )
+        {
+            return E_FAIL;
+        }
+        expectedOffset += block.size;
+
+        if ( block.dataOffset > ddszSize || block.dataSize > ddszSize - block.dataOffset )
+        {
+            return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+        }
+
+        if ( block.codec == DDSZ_CODEC_NONE )
+        {
+            if ( block.dataSize != block.size )
+            {
+                return E_FAIL;
+            }
+        }
+        else if ( block.codec != DDSZ_CODEC_LZ4 )
+        {
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+        }
+    }
+
+    if ( expectedOffset != header.ddsSize )
+    {
+        return E_FAIL;
+    }
+
+    const size_t outSize = static_cast<size_t>( header.ddsSize );
+    std::unique_ptr<uint8_t[]> out( new (std::nothrow) uint8_t[ outSize ? outSize : 1 ] );
+    if ( !out )
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    memcpy( out.get(), ddszData + sizeof(DDSZ_HEADER) + tableSize, header.headerSize );
+
+    if ( !blocks.empty() )
+    {
+        std::unique_ptr<bool[]> succeeded( new (std::nothrow) bool[ blocks.size() ] );
+        if ( !succeeded )
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        DecompressContext context;
+        context.ddszData = ddszData;
+        context.blocks = &blocks[0];
+        context.ddsData = out.get();
+        context.succeeded = succeeded.get();
+        BC::RunJobs( DecompressBlock, &context, blocks.size(), numThreads );
+
+        for( size_t i = 0; i < blocks.size(); ++i )
+        {
+            if ( !succeeded[i] )
+            {
+                return E_FAIL;
+            }
+        }
+    }
+
+    ddsData = std::move( out );
+    ddsSize = outSize;
+    return S_OK;
+}
@@ -0,0 +1,97 @@
+//--------------------------------------------------------------------------------------
+// File: DDSZFile.h
+//
+// DDSZ: a DDS file with its texture data compressed, to cut the bytes read from disk at
+// startup. The data is cut into blocks that never cross a mip, so each block can be
+// decompressed on its own, and the blocks are shared out between threads. Blocks are
+// compressed with LZ4 (LZ4Block.h), or stored as they are when that doesn't make them
+// smaller, which is common for block compressed formats with a lot of noise.
+//
+// The DDS magic and headers are stored uncompressed, so a .ddsz file decompresses to the
+// exact bytes of the .dds file it was made from. MappedFile::Open reads a .ddsz file in
+// place of the .dds file next to it, unless the .dds file is newer, so loaders don't need
+// to know about it. DDSZConvert (ssaa11/tools) converts a media tree.
+//
+// File layout, little endian:
+//   DDSZ_HEADER
+//   DDSZ_BLOCK[numBlocks], in the order of their offsets, covering the texture data
+//   the DDS magic and headers, headerSize bytes
+//   the data of the blocks
+//
+// Nothing here needs a Direct3D device, so it builds headless like DDSFile.cpp.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "DDSFile.h"
+
+//--------------------------------------------------------------------------------------
+// DDSZ file structure definitions
+//--------------------------------------------------------------------------------------
+#pragma pack(push,1)
+
+const uint32_t DDSZ_MAGIC = 0x5A534444; // "DDSZ"
+const uint32_t DDSZ_VERSION = 1;
+
+// Blocks of texture data are at most this large, so even a texture without mips is
+// decompressed by several threads
+const uint32_t DDSZ_MAX_BLOCK_SIZE = 256 * 1024;
+
+enum DDSZ_CODEC
+{
+    DDSZ_CODEC_NONE = 0,
+    DDSZ_CODEC_LZ4  = 1,
+};
+
+struct DDSZ_HEADER
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint64_t    ddsSize;        // of the whole DDS file
+    uint32_t    headerSize;     // of its magic and headers
+    uint32_t    numBlocks;
+};
+
+struct DDSZ_BLOCK
+{
+    uint64_t    offset;         // in the DDS file
+    uint64_t    dataOffset;     // in the DDSZ file
+    uint32_t    size;
+    uint32_t    dataSize;
+    uint32_t    codec;          // DDSZ_CODEC
+    uint32_t    reserved;
+};
+
+#pragma pack(pop)
+
+namespace DirectX
+{
+    // Whether the data starts like a DDSZ file
+    bool IsDDSZ( _In_reads_bytes_(dataSize) const uint8_t* data, _In_ size_t dataSize );
+
+    // Compresses a DDS file in memory. The blocks are shared out between numThreads threads
+    // (0 for one per processor), the calling thread included
+    HRESULT CompressDDS( _In_reads_bytes_(ddsSize) const uint8_t* ddsData,
+                         _In_ size_t ddsSize,
+                         _In_ unsigned int numThreads,
+                         _Out_ std::unique_ptr<uint8_t[]>& ddszData,
+                         _Out_ size_t& ddszSize );
+
+    // Decompresses a DDSZ file back into the DDS file it was made from, validating every
+    // size and offset first, so a damaged file fails rather than reading out of bounds
+    HRESULT DecompressDDSZ( _In_reads_bytes_(ddszSize) const uint8_t* ddszData,
+                            _In_ size_t ddszSize,
+                            _In_ unsigned int numThreads,
+                            _Out_ std::unique_ptr<uint8_t[]>& ddsData,
+                            _Out_ size_t& ddsSize );
+}
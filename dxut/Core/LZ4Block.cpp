@@ -0,0 +1,253 @@
+//--------------------------------------------------------------------------------------
+// File: LZ4Block.cpp
+//
+// LZ4 block compression and decompression
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+#include "LZ4Block.h"
+
+#include <string.h>
+#include <memory>
+#include <new>
+
+using namespace DirectX;
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+// From the LZ4 block format description
+const size_t MIN_MATCH = 4;
+const size_t LAST_LITERALS = 5;     // the last 5 bytes are always literals
+const size_t MF_LIMIT = 12;         // and the last match starts at least 12 bytes from the end
+const size_t MAX_OFFSET = 65535;
+const size_t RUN_MASK = 15;
+
+const unsigned int HASH_LOG = 16;
+const uint32_t NO_POSITION = 0xffffffff;
+
+inline uint32_t Read32( const uint8_t* p )
+{
+    uint32_t value;
+    memcpy( &value, p, sizeof(value) );
+    return value;
+}
+
+inline uint32_t Hash( uint32_t sequence )
+{
+    return ( sequence * 2654435761u ) >> ( 32 - HASH_LOG );
+}
+
+// Lengths of 15 or more go on in bytes of 255 and a last byte below it
+inline bool WriteLength( size_t length, uint8_t*& op, const uint8_t* end )
+{
+    for( ; length >= 255; length -= 255 )
+    {
+        if ( op >= end )
+            return false;
+        *op++ = 255;
+    }
+
+    if ( op >= end )
+        return false;
+    *op++ = static_cast<uint8_t>( length );
+    return true;
+}
+
+inline bool ReadLength( size_t& length, const uint8_t*& ip, const uint8_t* end )
+{
+    uint8_t byte;
+    do
+    {
+        if ( ip >= end )
+            return false;
+        byte = *ip++;
+        length += byte;
+    } while( byte == 255 );
+
+    return true;
+}
+
+// A sequence is a token, literals and, unless it's the last one, a match
+bool WriteSequence( const uint8_t* literals, size_t numLiterals, size_t offset, size_t matchLength,
+                    uint8_t*& op, const uint8_t* end )
+{
+    if ( op >= end )
+        return false;
+
+    uint8_t* token = op++;
+    *token = static_cast<uint8_t>( ( numLiterals < RUN_MASK ? numLiterals : RUN_MASK ) << 4 );
+    if ( numLiterals >= RUN_MASK && !WriteLength( numLiterals - RUN_MASK, op, end ) )
+        return false;
+
+    if ( static_cast<size_t>( end - op ) < numLiterals )
+        return false;
+    memcpy( op, literals, numLiterals );
+    op += numLiterals;
+
+    if ( !matchLength )
+        return true;
+
+    if ( end - op < 2 )
+        return false;
+    *op++ = static_cast<uint8_t>( offset );
+    *op++ = static_cast<uint8_t>( offset >> 8 );
+
+    const size_t length = matchLength - MIN_MATCH;
+    *token |= static_cast<uint8_t>( length < RUN_MASK ? length : RUN_MASK );
+    return length < RUN_MASK || WriteLength( length - RUN_MASK, op, end );
+}
+
+};
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+size_t DirectX::LZ4CompressBound( size_t srcSize )
+{
+    return srcSize + srcSize / 255 + 16;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+size_t DirectX::LZ4CompressBlock( const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstCapacity )
+{
+    if ( !src || !dst || srcSize >= 0x7fffffff )
+        return 0;
+
+    uint8_t* op = dst;
+    const uint8_t* end = dst + dstCapacity;
+    size_t anchor = 0;
+
+    if ( srcSize > MF_LIMIT )
+    {
+        std::unique_ptr<uint32_t[]> table( new (std::nothrow) uint32_t[ size_t(1) << HASH_LOG ] );
+        if ( !table )
+            return 0;
+        memset( table.get(), 0xff, sizeof(uint32_t) << HASH_LOG );
+
+        const size_t matchLimit = srcSize - LAST_LITERALS;
+        const size_t lastMatchStart = srcSize - MF_LIMIT;
+
+        // Runs without a match are skipped faster and faster, as incompressible data is
+        size_t misses = 0;
+        size_t ip = 0;
+        while( ip <= lastMatchStart )
+        {
+            const uint32_t sequence = Read32( src + ip );
+            uint32_t& entry = table[ Hash( sequence ) ];
+            const size_t ref = entry;
+            entry = static_cast<uint32_t>( ip );
+
+            if ( ref == NO_POSITION || ip - ref > MAX_OFFSET || Read32( src + ref ) != sequence )
+            {
+                ip += 1 + ( misses++ >> 6 );
+                continue;
+            }
+            misses = 0;
+
+            // Extend the match both ways
+            size_t matchStart = ip;
+            size_t matchRef = ref;
+            while( matchStart > anchor && matchRef > 0 && src[matchStart - 1] == src[matchRef - 1] )
+            {
+                --matchStart;
+                --matchRef;
+            }
+
+            size_t matchEnd = ip + MIN_MATCH;
+            while( matchEnd < matchLimit && src[matchEnd] == src[ref + matchEnd - ip] )
+            {
+                ++matchEnd;
+            }
+
+            if ( !WriteSequence( src + anchor, matchStart - anchor, matchStart - matchRef, matchEnd - matchStart, op, end ) )
+                return 0;
+
+            anchor = ip = matchEnd;
+
+            // Remember a position inside the match, so the next one can start there
+            if ( ip - 2 <= lastMatchStart )
+            {
+                table[ Hash( Read32( src + ip - 2 ) ) ] = static_cast<uint32_t>( ip - 2 );
+            }
+        }
+    }
+
+    if ( !WriteSequence( src + anchor, srcSize - anchor, 0, 0, op, end ) )
+        return 0;
+
+    return static_cast<size_t>( op - dst );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool DirectX::LZ4DecompressBlock( const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize )
+{
+    if ( !src || !dst )
+        return false;
+
+    const uint8_t* ip = src;
+    const uint8_t* const srcEnd = src + srcSize;
+    uint8_t* op = dst;
+    uint8_t* const dstEnd = dst + dstSize;
+
+    for(;;)
+    {
+        if ( ip >= srcEnd )
+            return false;
+        const uint8_t token = *ip++;
+
+        size_t numLiterals = token >> 4;
+        if ( numLiterals == RUN_MASK && !ReadLength( numLiterals, ip, srcEnd ) )
+            return false;
+
+        if ( static_cast<size_t>( srcEnd - ip ) < numLiterals || static_cast<size_t>( dstEnd - op ) < numLiterals )
+            return false;
+        memcpy( op, ip, numLiterals );
+        ip += numLiterals;
+        op += numLiterals;
+
+        // The last sequence has no match
+        if ( ip == srcEnd )
+            break;
+
+        if ( srcEnd - ip < 2 )
+            return false;
+        const size_t offset = ip[0] | ( static_cast<size_t>( ip[1] ) << 8 );
+        ip += 2;
+        if ( !offset || offset > static_cast<size_t>( op - dst ) )
+            return false;
+
+        size_t matchLength = token & RUN_MASK;
+        if ( matchLength == RUN_MASK && !ReadLength( matchLength, ip, srcEnd ) )
+            return false;
+        matchLength += MIN_MATCH;
+
+        if ( static_cast<size_t>( dstEnd - op ) < matchLength )
+            return false;
+
+        // Matches closer than their length repeat the bytes they have just written, so
+        // they're copied in steps that never overlap, each twice as long as the last
+        const uint8_t* match = op - offset;
+        while( matchLength )
+        {
+            const size_t step = ( matchLength < static_cast<size_t>( op - match ) ) ? matchLength : static_cast<size_t>( op - match );
+            memcpy( op, match, step );
+            op += step;
+            matchLength -= step;
+        }
+    }
+
+    return op == dstEnd;
+}
@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------------------
+// File: LZ4Block.h
+//
+// The LZ4 block format: a compressor and a bounds-checked decompressor for one block, with
+// no frame, checksums or dictionary. Blocks written here can be read by the reference LZ4
+// library's LZ4_decompress_safe, and the other way round.
+//
+// The compressor is a single pass over a hash table of the last position of every 4 byte
+// sequence, like LZ4's fast mode, and is meant for offline conversion. The decompressor
+// never reads or writes out of its buffers, whatever the input, so it's safe on files
+// from disk.
+//
+// Nothing here needs a Direct3D device, so it can be built into a headless tool or test.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#endif
+#include <stdint.h>
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#include <stddef.h>
+
+#if defined(_MSC_VER)
+#include <sal.h>
+#endif
+
+// No-ops where sal.h doesn't have them (VS2010) or doesn't exist, so LZ4Block.cpp builds on
+// its own with any compiler
+#ifndef _In_
+#define _In_
+#endif
+
+#ifndef _In_reads_bytes_
+#define _In_reads_bytes_(exp)
+#endif
+
+#ifndef _Out_writes_bytes_
+#define _Out_writes_bytes_(exp)
+#endif
+
+#ifndef _Use_decl_annotations_
+#define _Use_decl_annotations_
+#endif
+
+namespace DirectX
+{
+    // The most a block of srcSize bytes can take compressed
+    size_t LZ4CompressBound( _In_ size_t srcSize );
+
+    // Returns the compressed size, or 0 if it doesn't fit in dstCapacity or there isn't
+    // enough memory. Blocks must be smaller than 2 GB
+    size_t LZ4CompressBlock( _In_reads_bytes_(srcSize) const uint8_t* src,
+                             _In_ size_t srcSize,
+                             _Out_writes_bytes_(dstCapacity) uint8_t* dst,
+                             _In_ size_t dstCapacity );
+
+    // Fails unless the block decompresses to exactly dstSize bytes
+    bool LZ4DecompressBlock( _In_reads_bytes_(srcSize) const uint8_t* src,
+                             _In_ size_t srcSize,
+                             _Out_writes_bytes_(dstSize) uint8_t* dst,
+                             _In_ size_t dstSize );
+}
@@ -0,0 +1,695 @@
+//--------------------------------------------------------------------------------------
+// File: MipGen.cpp
+//
+// Gamma correct box and Kaiser filtering of 8 bit RGBA mip chains, multithreaded, with
+// optional alpha coverage preservation
+//
+// This file doesn't include DXUT and doesn't touch a Direct3D device, so it can be built
+// into a headless test or tool.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "MipGen.h"
+#include "BCCommon.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#define MIPGEN_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && (_MSC_VER<1610) && !defined(_Inout_updates_)
+#define _Inout_updates_(exp)
+#define _Inout_updates_bytes_(exp)
+#endif
+
+#ifndef SIZE_MAX
+#define SIZE_MAX ((size_t)-1)
+#endif
+
+using namespace DirectX;
+using namespace DirectX::BC;
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+//--------------------------------------------------------------------------------------
+// Color conversion
+//--------------------------------------------------------------------------------------
+
+// Linear values are rounded to this many steps to look up their sRGB encoding, which
+// is fine enough to tell apart the darkest sRGB codes
+const size_t LINEAR_STEPS = 65536;
+
+float SRGBToLinear( _In_ float value )
+{
+    return ( value <= 0.04045f ) ? value / 12.92f : powf( ( value + 0.055f ) / 1.055f, 2.4f );
+}
+
+struct ColorTables
+{
+    float       unormToFloat[256];
+    float       srgbToLinear[256];
+    uint8_t     linearToSRGB[LINEAR_STEPS];
+
+    ColorTables()
+    {
+        for( size_t i = 0; i < 256; ++i )
+        {
+            unormToFloat[i] = static_cast<float>( i ) / 255.f;
+            srgbToLinear[i] = SRGBToLinear( unormToFloat[i] );
+        }
+
+        // Codes change halfway between two codes in sRGB, i.e. where the encoding rounds
+        float bounds[255];
+        for( size_t code = 0; code < 255; ++code )
+        {
+            bounds[code] = SRGBToLinear( ( static_cast<float>( code ) + 0.5f ) / 255.f );
+        }
+
+        size_t code = 0;
+        for( size_t i = 0; i < LINEAR_STEPS; ++i )
+        {
+            const float linear = static_cast<float>( i ) / static_cast<float>( LINEAR_STEPS - 1 );
+            while( code < 255 && linear >= bounds[code] )
+            {
+                ++code;
+            }
+            linearToSRGB[i] = static_cast<uint8_t>( code );
+        }
+    }
+};
+
+// Filled in before main, so threads never race to build them
+const ColorTables g_Tables;
+
+
+//--------------------------------------------------------------------------------------
+// Kernels
+//--------------------------------------------------------------------------------------
+
+const double KAISER_ALPHA = 4.0;
+const double KAISER_RADIUS = 3.0;   // in texels of the smaller mip
+const double PI = 3.14159265358979323846;
+
+struct Tap
+{
+    size_t  index;
+    float   weight;
+};
+
+// The taps of the texels of a smaller mip along one axis: texel x is the weighted sum of
+// taps[first[x]] up to taps[first[x + 1]]
+struct Kernel
+{
+    std::vector<size_t> first;
+    std::vector<Tap>    taps;
+};
+
+
+//--------------------------------------------------------------------------------------
+double BesselI0( _In_ double x )
+{
+    const double quarterSq = x * x * 0.25;
+    double sum = 1.0;
+    double term = 1.0;
+    for( int k = 1; k < 64 && term > sum * 1e-12; ++k )
+    {
+        term *= quarterSq / static_cast<double>( k * k );
+        sum += term;
+    }
+    return sum;
+}
+
+
+//--------------------------------------------------------------------------------------
+double KaiserSinc( _In_ double t )
+{
+    const double window = t / KAISER_RADIUS;
+    if ( fabs( window ) >= 1.0 )
+        return 0.0;
+
+    const double sinc = ( t == 0.0 ) ? 1.0 : sin( PI * t ) / ( PI * t );
+    return sinc * BesselI0( KAISER_ALPHA * sqrt( 1.0 - window * window ) ) / BesselI0( KAISER_ALPHA );
+}
+
+
+//--------------------------------------------------------------------------------------
+void BuildKernel( _In_ size_t srcSize, _In_ size_t dstSize, _In_ unsigned int filter, _Out_ Kernel& kernel )
+{
+    kernel.first.resize( dstSize + 1 );
+    kernel.taps.clear();
+
+    const double scale = static_cast<double>( srcSize ) / static_cast<double>( dstSize );
+    const ptrdiff_t lastIndex = static_cast<ptrdiff_t>( srcSize ) - 1;
+
+    for( size_t x = 0; x < dstSize; ++x )
+    {
+        const size_t first = kernel.taps.size();
+        kernel.first[x] = first;
+
+        double sum = 0.0;
+        if ( filter == MIPGEN_KAISER && srcSize > dstSize )
+        {
+            // Texels past the edges repeat the edge texel
+            const double center = ( static_cast<double>( x ) + 0.5 ) * scale;
+            const double support = KAISER_RADIUS * scale;
+            const ptrdiff_t lo = static_cast<ptrdiff_t>( floor( center - support ) );
+            const ptrdiff_t hi = static_cast<ptrdiff_t>( ceil( center + support ) );
+            for( ptrdiff_t i = lo; i < hi; ++i )
+            {
+                const double weight = KaiserSinc( ( static_cast<double>( i ) + 0.5 - center ) / scale );
+                if ( weight == 0.0 )
+                    continue;
+
+                Tap tap;
+                tap.index = static_cast<size_t>( std::min( std::max<ptrdiff_t>( i, 0 ), lastIndex ) );
+                tap.weight = static_cast<float>( weight );
+                kernel.taps.push_back( tap );
+                sum += weight;
+            }
+        }
+        else
+        {
+            // Each texel counts for as much of it as the smaller texel covers
+            const double lo = static_cast<double>( x ) * scale;
+            const double hi = static_cast<double>( x + 1 ) * scale;
+            for( size_t i = static_cast<size_t>( lo ); static_cast<double>( i ) < hi && i < srcSize; ++i )
+            {
+                const double weight = std::min( hi, static_cast<double>( i + 1 ) ) - std::max( lo, static_cast<double>( i ) );
+                if ( weight <= 0.0 )
+                    continue;
+
+                Tap tap;
+                tap.index = i;
+                tap.weight = static_cast<float>( weight );
+                kernel.taps.push_back( tap );
+                sum += weight;
+            }
+        }
+
+        assert( sum > 0.0 );
+        for( size_t i = first; i < kernel.taps.size(); ++i )
+        {
+            kernel.taps[i].weight = static_cast<float>( kernel.taps[i].weight / sum );
+        }
+    }
+
+    kernel.first[dstSize] = kernel.taps.size();
+}
+
+
+//--------------------------------------------------------------------------------------
+// Four channel arithmetic. Both do the same float operations in the same order, so they
+// round the same
+//--------------------------------------------------------------------------------------
+
+struct ScalarOps
+{
+    struct Vec
+    {
+        float c[4];
+    };
+
+    static Vec Zero()
+    {
+        Vec v = { { 0.f, 0.f, 0.f, 0.f } };
+        return v;
+    }
+
+    static Vec Load( _In_reads_(4) const float* p )
+    {
+        Vec v = { { p[0], p[1], p[2], p[3] } };
+        return v;
+    }
+
+    static void Store( _Out_writes_(4) float* p, _In_ const Vec& v )
+    {
+        memcpy( p, v.c, sizeof(v.c) );
+    }
+
+    static Vec MulAdd( _In_ const Vec& acc, _In_ const Vec& v, _In_ float weight )
+    {
+        Vec r;
+        for( size_t c = 0; c < 4; ++c )
+        {
+            r.c[c] = acc.c[c] + v.c[c] * weight;
+        }
+        return r;
+    }
+
+    // Clamps to [0, 1] and rounds to steps[c]
+    static void Quantize( _In_ const Vec& v, _In_reads_(4) const float* steps, _Out_writes_(4) int* q )
+    {
+        for( size_t c = 0; c < 4; ++c )
+        {
+            const float x = std::min( std::max( v.c[c], 0.f ), 1.f );
+            q[c] = static_cast<int>( x * steps[c] + 0.5f );
+        }
+    }
+};
+
+#if defined(MIPGEN_SSE2)
+
+struct SSE2Ops
+{
+    typedef __m128 Vec;
+
+    static Vec Zero()
+    {
+        return _mm_setzero_ps();
+    }
+
+    static Vec Load( _In_reads_(4) const float* p )
+    {
+        return _mm_loadu_ps( p );
+    }
+
+    static void Store( _Out_writes_(4) float* p, _In_ const Vec& v )
+    {
+        _mm_storeu_ps( p, v );
+    }
+
+    static Vec MulAdd( _In_ const Vec& acc, _In_ const Vec& v, _In_ float weight )
+    {
+        return _mm_add_ps( acc, _mm_mul_ps( v, _mm_set1_ps( weight ) ) );
+    }
+
+    static void Quantize( _In_ const Vec& v, _In_reads_(4) const float* steps, _Out_writes_(4) int* q )
+    {
+        const __m128 x = _mm_min_ps( _mm_max_ps( v, _mm_setzero_ps() ), _mm_set1_ps( 1.f ) );
+        const __m128i r = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( x, _mm_loadu_ps( steps ) ), _mm_set1_ps( 0.5f ) ) );
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( q ), r );
+    }
+};
+
+#endif
+
+
+//--------------------------------------------------------------------------------------
+// Filtering one mip from the one above
+//--------------------------------------------------------------------------------------
+
+struct MipWork
+{
+    const uint8_t*  src;
+    size_t          srcWidth;
+    size_t          srcRowPitch;
+    uint8_t*        dst;
+    size_t          dstWidth;
+    size_t          dstHeight;
+    const Kernel*   horizontal;
+    const Kernel*   vertical;
+    const float*    toLinear[4];
+    float           steps[4];
+    bool            srgb;
+    bool            reference;
+    volatile long   failed;
+};
+
+// Rows of texels go out to the threads in strips of this many
+const size_t STRIP_ROWS = STRIP_BLOCK_ROWS * 4;
+
+
+//--------------------------------------------------------------------------------------
+template<class Ops>
+void FilterStrip( _In_ const MipWork& work,
+                  _In_ size_t y0,
+                  _In_ size_t y1,
+                  _In_ size_t firstRow,
+                  _In_ size_t numRows,
+                  _Inout_updates_(work.srcWidth*4) float* linear,
+                  _Inout_updates_(numRows*work.dstWidth*4) float* filtered )
+{
+    const Kernel& horizontal = *work.horizontal;
+    const Kernel& vertical = *work.vertical;
+
+    // Decode and filter across each source row the strip reads
+    for( size_t row = 0; row < numRows; ++row )
+    {
+        const uint8_t* src = work.src + ( firstRow + row ) * work.srcRowPitch;
+        for( size_t i = 0; i < work.srcWidth * 4; i += 4 )
+        {
+            for( size_t c = 0; c < 4; ++c )
+            {
+                linear[i + c] = work.toLinear[c][src[i + c]];
+            }
+        }
+
+        float* out = filtered + row * work.dstWidth * 4;
+        for( size_t x = 0; x < work.dstWidth; ++x )
+        {
+            typename Ops::Vec acc = Ops::Zero();
+            for( size_t t = horizontal.first[x]; t < horizontal.first[x + 1]; ++t )
+            {
+                const Tap& tap = horizontal.taps[t];
+                acc = Ops::MulAdd( acc, Ops::Load( linear + tap.index * 4 ), tap.weight );
+            }
+            Ops::Store( out + x * 4, acc );
+        }
+    }
+
+    // Then down, and back to 8 bits
+    for( size_t y = y0; y < y1; ++y )
+    {
+        uint8_t* dst = work.dst + y * work.dstWidth * 4;
+        for( size_t x = 0; x < work.dstWidth; ++x, dst += 4 )
+        {
+            typename Ops::Vec acc = Ops::Zero();
+            for( size_t t = vertical.first[y]; t < vertical.first[y + 1]; ++t )
+            {
+                const Tap& tap = vertical.taps[t];
+                acc = Ops::MulAdd( acc, Ops::Load( filtered + ( ( tap.index - firstRow ) * work.dstWidth + x ) * 4 ), tap.weight );
+            }
+
+            int q[4];
+            Ops::Quantize( acc, work.steps, q );
+            if ( work.srgb )
+            {
+                dst[0] = g_Tables.linearToSRGB[q[0]];
+                dst[1] = g_Tables.linearToSRGB[q[1]];
+                dst[2] = g_Tables.linearToSRGB[q[2]];
+            }
+            else
+            {
+                dst[0] = static_cast<uint8_t>( q[0] );
+                dst[1] = static_cast<uint8_t>( q[1] );
+                dst[2] = static_cast<uint8_t>( q[2] );
+            }
+            dst[3] = static_cast<uint8_t>( q[3] );
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+void RunMipJob( _Inout_ void* context, _In_ size_t job )
+{
+    MipWork& work = *static_cast<MipWork*>( context );
+    const Kernel& vertical = *work.vertical;
+
+    const size_t y0 = job * STRIP_ROWS;
+    const size_t y1 = std::min( y0 + STRIP_ROWS, work.dstHeight );
+
+    // The source rows the strip reads
+    size_t firstRow = SIZE_MAX;
+    size_t lastRow = 0;
+    for( size_t t = vertical.first[y0]; t < vertical.first[y1]; ++t )
+    {
+        firstRow = std::min( firstRow, vertical.taps[t].index );
+        lastRow = std::max( lastRow, vertical.taps[t].index );
+    }
+    const size_t numRows = lastRow - firstRow + 1;
+
+    std::unique_ptr<float[]> linear( new (std::nothrow) float[ work.srcWidth * 4 ] );
+    std::unique_ptr<float[]> filtered( new (std::nothrow) float[ numRows * work.dstWidth * 4 ] );
+    if ( !linear || !filtered )
+    {
+        work.failed = 1;
+        return;
+    }
+
+#if defined(MIPGEN_SSE2)
+    if ( !work.reference )
+    {
+        FilterStrip<SSE2Ops>( work, y0, y1, firstRow, numRows, linear.get(), filtered.get() );
+        return;
+    }
+#endif
+    FilterStrip<ScalarOps>( work, y0, y1, firstRow, numRows, linear.get(), filtered.get() );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Alpha coverage
+//--------------------------------------------------------------------------------------
+
+const uint8_t ALPHA_REF = 128;
+
+size_t CountCovered( _In_reads_bytes_(numTexels*4) const uint8_t* texels, _In_ size_t numTexels )
+{
+    size_t covered = 0;
+    for( size_t i = 0; i < numTexels; ++i )
+    {
+        if ( texels[i * 4 + 3] >= ALPHA_REF )
+        {
+            ++covered;
+        }
+    }
+    return covered;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Scales alpha so that as close to coverage of the texels as possible pass the alpha test
+//--------------------------------------------------------------------------------------
+void ScaleAlphaToCoverage( _Inout_updates_bytes_(numTexels*4) uint8_t* texels, _In_ size_t numTexels, _In_ double coverage )
+{
+    size_t histogram[256] = {};
+    for( size_t i = 0; i < numTexels; ++i )
+    {
+        ++histogram[texels[i * 4 + 3]];
+    }
+
+    // The lowest alpha that should pass, from the texels at or above each alpha
+    const double target = coverage * static_cast<double>( numTexels );
+    size_t threshold = 255;
+    double bestError = fabs( static_cast<double>( histogram[255] ) - target );
+    size_t passing = histogram[255];
+    for( size_t alpha = 254; alpha >= 1; --alpha )
+    {
+        passing += histogram[alpha];
+        const double error = fabs( static_cast<double>( passing ) - target );
+        if ( error < bestError )
+        {
+            bestError = error;
+            threshold = alpha;
+        }
+    }
+
+    if ( threshold == ALPHA_REF )
+        return;
+
+    // Puts threshold just over the reference and threshold - 1 just under it
+    const float scale = ( static_cast<float>( ALPHA_REF ) - 0.5f ) / ( static_cast<float>( threshold ) - 0.5f );
+    for( size_t i = 0; i < numTexels; ++i )
+    {
+        uint8_t& alpha = texels[i * 4 + 3];
+        alpha = static_cast<uint8_t>( std::min( static_cast<float>( alpha ) * scale + 0.5f, 255.f ) );
+    }
+}
+
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool DirectX::IsMipGenFormat( DXGI_FORMAT format )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+size_t DirectX::CountMips( size_t width, size_t height )
+{
+    size_t mipCount = 1;
+    while( width > 1 || height > 1 )
+    {
+        width = std::max<size_t>( width / 2, 1 );
+        height = std::max<size_t>( height / 2, 1 );
+        ++mipCount;
+    }
+    return mipCount;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GenerateMipChain( DXGI_FORMAT format,
+                                   size_t width,
+                                   size_t height,
+                                   const uint8_t* src,
+                                   size_t srcRowPitch,
+                                   size_t mipCount,
+                                   unsigned int numThreads,
+                                   unsigned int flags,
+                                   MipChain& chain )
+{
+    chain.format = DXGI_FORMAT_UNKNOWN;
+    chain.width = 0;
+    chain.height = 0;
+    chain.mipCount = 0;
+    chain.mips.reset();
+    chain.bits.reset();
+    chain.bitSize = 0;
+
+    if ( !src || !width || !height || srcRowPitch < width * 4 )
+        return E_INVALIDARG;
+
+    if ( !IsMipGenFormat( format ) )
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+
+    const size_t fullCount = CountMips( width, height );
+    if ( !mipCount )
+    {
+        mipCount = fullCount;
+    }
+    else if ( mipCount > fullCount )
+    {
+        return E_INVALIDARG;
+    }
+
+    size_t totalBytes = 0;
+    for( size_t mip = 0, w = width, h = height; mip < mipCount; ++mip )
+    {
+        const size_t rowBytes = w * 4;
+        if ( rowBytes / 4 != w || ( rowBytes * h ) / h != rowBytes || totalBytes > SIZE_MAX - rowBytes * h )
+            return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+        totalBytes += rowBytes * h;
+
+        w = std::max<size_t>( w / 2, 1 );
+        h = std::max<size_t>( h / 2, 1 );
+    }
+
+    std::unique_ptr<D3D11_SUBRESOURCE_DATA[]> mips( new (std::nothrow) D3D11_SUBRESOURCE_DATA[ mipCount ] );
+    std::unique_ptr<uint8_t[]> bits( new (std::nothrow) uint8_t[ totalBytes ] );
+    if ( !mips || !bits )
+        return E_OUTOFMEMORY;
+
+    uint8_t* pMip = bits.get();
+    for( size_t mip = 0, w = width, h = height; mip < mipCount; ++mip )
+    {
+        mips[mip].pSysMem = pMip;
+        mips[mip].SysMemPitch = static_cast<UINT>( w * 4 );
+        mips[mip].SysMemSlicePitch = static_cast<UINT>( w * h * 4 );
+        pMip += w * h * 4;
+
+        w = std::max<size_t>( w / 2, 1 );
+        h = std::max<size_t>( h / 2, 1 );
+    }
+
+    for( size_t y = 0; y < height; ++y )
+    {
+        memcpy( bits.get() + y * width * 4, src + y * srcRowPitch, width * 4 );
+    }
+
+    bool srgb = ( flags & MIPGEN_SRGB ) != 0;
+    bool hasAlpha = true;
+    switch( format )
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+        srgb = true;
+        break;
+
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        srgb = true;
+        hasAlpha = false;
+        break;
+
+    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+        hasAlpha = false;
+        break;
+
+    default:
+        break;
+    }
+
+    const bool keepCoverage = hasAlpha && ( flags & MIPGEN_ALPHA_COVERAGE );
+    const double coverage = keepCoverage
+                          ? static_cast<double>( CountCovered( bits.get(), width * height ) ) / static_cast<double>( width * height )
+                          : 0.0;
+
+    MipWork work;
+    memset( &work, 0, sizeof(work) );
+    for( size_t c = 0; c < 3; ++c )
+    {
+        work.toLinear[c] = srgb ? g_Tables.srgbToLinear : g_Tables.unormToFloat;
+        work.steps[c] = srgb ? static_cast<float>( LINEAR_STEPS - 1 ) : 255.f;
+    }
+    work.toLinear[3] = g_Tables.unormToFloat;
+    work.steps[3] = 255.f;
+    work.srgb = srgb;
+#if defined(MIPGEN_SSE2)
+    work.reference = ( flags & MIPGEN_REFERENCE ) != 0;
+#else
+    work.reference = true;
+#endif
+
+    const unsigned int filter = flags & MIPGEN_FILTER_MASK;
+    Kernel horizontal, vertical;
+    for( size_t mip = 1; mip < mipCount; ++mip )
+    {
+        const size_t srcWidth = std::max<size_t>( width >> ( mip - 1 ), 1 );
+        const size_t srcHeight = std::max<size_t>( height >> ( mip - 1 ), 1 );
+        const size_t dstWidth = std::max<size_t>( srcWidth / 2, 1 );
+        const size_t dstHeight = std::max<size_t>( srcHeight / 2, 1 );
+
+        BuildKernel( srcWidth, dstWidth, filter, horizontal );
+        BuildKernel( srcHeight, dstHeight, filter, vertical );
+
+        work.src = static_cast<const uint8_t*>( mips[mip - 1].pSysMem );
+        work.srcWidth = srcWidth;
+        work.srcRowPitch = mips[mip - 1].SysMemPitch;
+        work.dst = const_cast<uint8_t*>( static_cast<const uint8_t*>( mips[mip].pSysMem ) );
+        work.dstWidth = dstWidth;
+        work.dstHeight = dstHeight;
+        work.horizontal = &horizontal;
+        work.vertical = &vertical;
+
+        RunJobs( RunMipJob, &work, ( dstHeight + STRIP_ROWS - 1 ) / STRIP_ROWS, numThreads );
+        if ( work.failed )
+            return E_OUTOFMEMORY;
+
+        if ( keepCoverage )
+        {
+            ScaleAlphaToCoverage( work.dst, dstWidth * dstHeight, coverage );
+        }
+    }
+
+    chain.format = format;
+    chain.width = width;
+    chain.height = height;
+    chain.mipCount = mipCount;
+    chain.mips = std::move( mips );
+    chain.bits = std::move( bits );
+    chain.bitSize = totalBytes;
+
+    return S_OK;
+}
@@ -0,0 +1,104 @@
+//--------------------------------------------------------------------------------------
+// File: MipGen.h
+//
+// Mip chain generation on the CPU for 8 bit RGBA textures, so a loader can create its
+// textures with every mip in one call (immutable ones too) without a device context to
+// run GenerateMips on, and a tool can build the mips offline.
+//
+// The texels are filtered in linear space: _SRGB formats, or any format with
+// MIPGEN_SRGB, have their color channels decoded from sRGB before filtering and encoded
+// again after. Alpha is always linear.
+//
+// Filters, chosen with the MIPGEN_FILTER_MASK bits:
+//   - MIPGEN_BOX averages the texels each one covers, exactly 2x2 for even sizes
+//   - MIPGEN_KAISER is a Kaiser windowed sinc reaching three texels of the smaller mip
+//     either side, which keeps more detail and aliases less than a box
+// Both are separable and clamp to the edges of the texture.
+//
+// MIPGEN_ALPHA_COVERAGE scales the alpha of every smaller mip so that as many of its
+// texels pass an alpha test at 128 as in the top mip, so alpha tested foliage and fences
+// don't thin out in the distance.
+//
+// Each mip is filtered from the one above, with its rows shared out between threads. The
+// SSE2 code filters the four channels of a texel at once and gives the same bits as the
+// scalar code that MIPGEN_REFERENCE selects.
+//
+// Nothing here needs a Direct3D device, so it builds headless like DDSFile.cpp.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <d3d11.h>
+
+#if defined(_MSC_VER)
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#endif
+#include <stdint.h>
+#if defined(_MSC_VER)
+#pragma warning(pop)
+#endif
+
+#include <memory>
+
+#if defined(_MSC_VER) && (_MSC_VER<1610) && !defined(_In_reads_bytes_)
+#define _In_reads_bytes_(exp)
+#endif
+
+namespace DirectX
+{
+    enum MIPGEN_FLAGS
+    {
+        MIPGEN_BOX              = 0x0,
+        MIPGEN_KAISER           = 0x1,
+        MIPGEN_FILTER_MASK      = 0xF,
+
+        MIPGEN_SRGB             = 0x10,     // UNORM texels are sRGB encoded too
+        MIPGEN_ALPHA_COVERAGE   = 0x20,
+
+        MIPGEN_REFERENCE        = 0x100,    // scalar code only
+    };
+
+    // Whether GenerateMipChain can filter format: R8G8B8A8, B8G8R8A8 and B8G8R8X8, as
+    // UNORM, UNORM_SRGB or typeless
+    bool IsMipGenFormat( _In_ DXGI_FORMAT format );
+
+    // Number of mips in a full chain down to 1x1
+    size_t CountMips( _In_ size_t width, _In_ size_t height );
+
+    // A mip chain of tightly packed texels, finest mip first, each one half the size of
+    // the one above (rounded down, but at least 1)
+    struct MipChain
+    {
+        DXGI_FORMAT                                 format;
+        size_t                                      width;
+        size_t                                      height;
+        size_t                                      mipCount;
+        std::unique_ptr<D3D11_SUBRESOURCE_DATA[]>   mips;
+        std::unique_ptr<uint8_t[]>                  bits;
+        size_t                                      bitSize;
+    };
+
+    // Copies a width x height image of format and filters mipCount - 1 smaller mips from it
+    // (0 for a full chain). The rows of each mip are shared out between numThreads threads
+    // (0 for one per processor), the calling thread included
+    HRESULT GenerateMipChain( _In_ DXGI_FORMAT format,
+                              _In_ size_t width,
+                              _In_ size_t height,
+                              _In_reads_bytes_(srcRowPitch*height) const uint8_t* src,
+                              _In_ size_t srcRowPitch,
+                              _In_ size_t mipCount,
+                              _In_ unsigned int numThreads,
+                              _In_ unsigned int flags,
+                              _Out_ MipChain& chain );
+}
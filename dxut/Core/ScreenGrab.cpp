@@ -22,7 +22,8 @@
 
 // Does not capture 1D textures or 3D textures (volume maps)
 
-// Does not capture mipmap chains, only the top-most texture level is saved
+// Does not capture mipmap chains, only the top-most texture level is saved (the overload of
+// SaveDDSTextureToFile that takes texels from memory writes every mip and array item)
 
 // For 2D array textures and cubemaps, it captures only the first image in the array
 
@@ -91,6 +92,7 @@ struct DDS_PIXELFORMAT
 #define DDS_WIDTH  0x00000004 // DDSD_WIDTH
 
 #define DDS_SURFACE_FLAGS_TEXTURE 0x00001000 // DDSCAPS_TEXTURE
+#define DDS_SURFACE_FLAGS_MIPMAP  0x00400008 // DDSCAPS_COMPLEX | DDSCAPS_MIPMAP
 
 typedef struct
 {
@@ -714,47 +716,39 @@ static IWICImagingFactory* _GetWIC()
 
 
 //--------------------------------------------------------------------------------------
-HRESULT DirectX::SaveDDSTextureToFile( _In_ ID3D11DeviceContext* pContext,
-                                       _In_ ID3D11Resource* pSource,
-                                       _In_z_ LPCWSTR fileName )
+// The magic number, header and, for formats without a legacy pixel format and for
+// arrays, the 'DX10' header extension of a 2D texture's .DDS file
+//--------------------------------------------------------------------------------------
+static const size_t MAX_HEADER_SIZE = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+
+static HRESULT SetupDDSHeader( _In_ DXGI_FORMAT format,
+                               _In_ size_t width,
+                               _In_ size_t height,
+                               _In_ size_t mipLevels,
+                               _In_ size_t arraySize,
+                               _Out_writes_bytes_(MAX_HEADER_SIZE) uint8_t* fileHeader,
+                               _Out_ size_t& headerSize )
 {
-    if ( !fileName )
-        return E_INVALIDARG;
-
-    D3D11_TEXTURE2D_DESC desc = { 0 };
-    ComPtr<ID3D11Texture2D> pStaging;
-    HRESULT hr = CaptureTexture( pContext, pSource, desc, pStaging );
-    if ( FAILED(hr) )
-        return hr;
-
-    // Create file
-#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
-    ScopedHandle hFile( safe_handle( CreateFile2( fileName, GENERIC_WRITE, 0, CREATE_ALWAYS, 0 ) ) );
-#else
-    ScopedHandle hFile( safe_handle( CreateFileW( fileName, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, 0, 0 ) ) );
-#endif
-    if ( !hFile )
-        return HRESULT_FROM_WIN32( GetLastError() );
-
-    // Setup header
-    const size_t MAX_HEADER_SIZE = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
-    uint8_t fileHeader[ MAX_HEADER_SIZE ];
-
     *reinterpret_cast<uint32_t*>(&fileHeader[0]) = DDS_MAGIC;
 
     auto header = reinterpret_cast<DDS_HEADER*>( &fileHeader[0] + sizeof(uint32_t) );
-    size_t headerSize = sizeof(uint32_t) + sizeof(DDS_HEADER);
+    headerSize = sizeof(uint32_t) + sizeof(DDS_HEADER);
     memset( header, 0, sizeof(DDS_HEADER) );
     header->size = sizeof( DDS_HEADER );
     header->flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP;
-    header->height = desc.Height;
-    header->width = desc.Width;
-    header->mipMapCount = 1;
+    header->height = static_cast<uint32_t>( height );
+    header->width = static_cast<uint32_t>( width );
+    header->mipMapCount = static_cast<uint32_t>( mipLevels );
     header->caps = DDS_SURFACE_FLAGS_TEXTURE;
+    if ( mipLevels > 1 )
+    {
+        header->caps |= DDS_SURFACE_FLAGS_MIPMAP;
+    }
 
-    // Try to use a legacy .DDS pixel format for better tools support, otherwise fallback to 'DX10' header extension
+    // Try to use a legacy .DDS pixel format for better tools support, otherwise fallback to 'DX10' header extension,
+    // which arrays always need
     DDS_HEADER_DXT10* extHeader = nullptr;
-    switch( desc.Format )
+    switch( ( arraySize > 1 ) ? DXGI_FORMAT_UNKNOWN : format )
     {
     case DXGI_FORMAT_R8G8B8A8_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A8B8G8R8, sizeof(DDS_PIXELFORMAT) );    break;
     case DXGI_FORMAT_R16G16_UNORM:          memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_G16R16, sizeof(DDS_PIXELFORMAT) );      break;
@@ -803,16 +797,16 @@ HRESULT DirectX::SaveDDSTextureToFile( _In_ ID3D11DeviceContext* pContext,
         headerSize += sizeof(DDS_HEADER_DXT10);
         extHeader = reinterpret_cast<DDS_HEADER_DXT10*>( reinterpret_cast<uint8_t*>(&fileHeader[0]) + sizeof(uint32_t) + sizeof(DDS_HEADER) );
         memset( extHeader, 0, sizeof(DDS_HEADER_DXT10) );
-        extHeader->dxgiFormat = desc.Format;
+        extHeader->dxgiFormat = format;
         extHeader->resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
-        extHeader->arraySize = 1;
+        extHeader->arraySize = static_cast<uint32_t>( arraySize );
         break;
     }
 
     size_t rowPitch, slicePitch, rowCount;
-    GetSurfaceInfo( desc.Width, desc.Height, desc.Format, &slicePitch, &rowPitch, &rowCount );
+    GetSurfaceInfo( width, height, format, &slicePitch, &rowPitch, &rowCount );
 
-    if ( IsCompressed( desc.Format ) )
+    if ( IsCompressed( format ) )
     {
         header->flags |= DDS_HEADER_FLAGS_LINEARSIZE;
         header->pitchOrLinearSize = static_cast<uint32_t>( slicePitch );
@@ -823,6 +817,43 @@ HRESULT DirectX::SaveDDSTextureToFile( _In_ ID3D11DeviceContext* pContext,
         header->pitchOrLinearSize = static_cast<uint32_t>( rowPitch );
     }
 
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+HRESULT DirectX::SaveDDSTextureToFile( _In_ ID3D11DeviceContext* pContext,
+                                       _In_ ID3D11Resource* pSource,
+                                       _In_z_ LPCWSTR fileName )
+{
+    if ( !fileName )
+        return E_INVALIDARG;
+
+    D3D11_TEXTURE2D_DESC desc = { 0 };
+    ComPtr<ID3D11Texture2D> pStaging;
+    HRESULT hr = CaptureTexture( pContext, pSource, desc, pStaging );
+    if ( FAILED(hr) )
+        return hr;
+
+    // Create file
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    ScopedHandle hFile( safe_handle( CreateFile2( fileName, GENERIC_WRITE, 0, CREATE_ALWAYS, 0 ) ) );
+#else
+    ScopedHandle hFile( safe_handle( CreateFileW( fileName, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, 0, 0 ) ) );
+#endif
+    if ( !hFile )
+        return HRESULT_FROM_WIN32( GetLastError() );
+
+    // Setup header
+    uint8_t fileHeader[ MAX_HEADER_SIZE ];
+    size_t headerSize;
+    hr = SetupDDSHeader( desc.Format, desc.Width, desc.Height, 1, 1, fileHeader, headerSize );
+    if ( FAILED(hr) )
+        return hr;
+
+    size_t rowPitch, slicePitch, rowCount;
+    GetSurfaceInfo( desc.Width, desc.Height, desc.Format, &slicePitch, &rowPitch, &rowCount );
+
     // Setup pixels
     std::unique_ptr<uint8_t[]> pixels( new (std::nothrow) uint8_t[ slicePitch ] );
     if (!pixels)
@@ -869,6 +900,80 @@ HRESULT DirectX::SaveDDSTextureToFile( _In_ ID3D11DeviceContext* pContext,
     return S_OK;
 }
 
+//--------------------------------------------------------------------------------------
+HRESULT DirectX::SaveDDSTextureToFile( _In_ DXGI_FORMAT format,
+                                       _In_ size_t width,
+                                       _In_ size_t height,
+                                       _In_ size_t mipLevels,
+                                       _In_ size_t arraySize,
+                                       _In_reads_(mipLevels*arraySize) const D3D11_SUBRESOURCE_DATA* initData,
+                                       _In_z_ LPCWSTR fileName )
+{
+    if ( !initData || !fileName || !width || !height || !mipLevels || !arraySize )
+        return E_INVALIDARG;
+
+    if ( width > UINT32_MAX || height > UINT32_MAX || mipLevels > UINT32_MAX || arraySize > UINT32_MAX )
+        return E_INVALIDARG;
+
+    // Setup header before creating the file, so unsupported formats don't leave an empty one behind
+    uint8_t fileHeader[ MAX_HEADER_SIZE ];
+    size_t headerSize;
+    HRESULT hr = SetupDDSHeader( format, width, height, mipLevels, arraySize, fileHeader, headerSize );
+    if ( FAILED(hr) )
+        return hr;
+
+    // Create file
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    ScopedHandle hFile( safe_handle( CreateFile2( fileName, GENERIC_WRITE, 0, CREATE_ALWAYS, 0 ) ) );
+#else
+    ScopedHandle hFile( safe_handle( CreateFileW( fileName, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, 0, 0 ) ) );
+#endif
+    if ( !hFile )
+        return HRESULT_FROM_WIN32( GetLastError() );
+
+    DWORD bytesWritten;
+    if ( !WriteFile( hFile.get(), fileHeader, static_cast<DWORD>( headerSize ), &bytesWritten, 0 ) )
+        return HRESULT_FROM_WIN32( GetLastError() );
+
+    if ( bytesWritten != headerSize )
+        return E_FAIL;
+
+    // Write pixels, item by item and finest mip first, a row at a time since the source
+    // may be pitched differently than the file
+    for( size_t item = 0; item < arraySize; ++item )
+    {
+        size_t w = width;
+        size_t h = height;
+        for( size_t level = 0; level < mipLevels; ++level )
+        {
+            const D3D11_SUBRESOURCE_DATA& data = initData[ item * mipLevels + level ];
+
+            size_t rowPitch, slicePitch, rowCount;
+            GetSurfaceInfo( w, h, format, &slicePitch, &rowPitch, &rowCount );
+            if ( !data.pSysMem || data.SysMemPitch < rowPitch || rowPitch > UINT32_MAX )
+                return E_INVALIDARG;
+
+            auto sptr = reinterpret_cast<const uint8_t*>( data.pSysMem );
+            for( size_t row = 0; row < rowCount; ++row )
+            {
+                if ( !WriteFile( hFile.get(), sptr, static_cast<DWORD>( rowPitch ), &bytesWritten, 0 ) )
+                    return HRESULT_FROM_WIN32( GetLastError() );
+
+                if ( bytesWritten != rowPitch )
+                    return E_FAIL;
+
+                sptr += data.SysMemPitch;
+            }
+
+            w = std::max<size_t>( w / 2, 1 );
+            h = std::max<size_t>( h / 2, 1 );
+        }
+    }
+
+    return S_OK;
+}
+
+
 //--------------------------------------------------------------------------------------
 HRESULT DirectX::SaveWICTextureToFile( _In_ ID3D11DeviceContext* pContext,
                                        _In_ ID3D11Resource* pSource,
@@ -34,12 +34,27 @@
 
 #include <functional>
 
+#if defined(_MSC_VER) && (_MSC_VER<1610) && !defined(_In_reads_)
+#define _In_reads_(exp)
+#define _Out_writes_bytes_(exp)
+#endif
+
 namespace DirectX
 {
     HRESULT SaveDDSTextureToFile( _In_ ID3D11DeviceContext* pContext,
                                   _In_ ID3D11Resource* pSource,
                                   _In_z_ LPCWSTR fileName );
 
+    // Writes a 2D texture held in memory, every mip of every array item, e.g. one that was
+    // block compressed on the CPU. initData is laid out like for CreateTexture2D
+    HRESULT SaveDDSTextureToFile( _In_ DXGI_FORMAT format,
+                                  _In_ size_t width,
+                                  _In_ size_t height,
+                                  _In_ size_t mipLevels,
+                                  _In_ size_t arraySize,
+                                  _In_reads_(mipLevels*arraySize) const D3D11_SUBRESOURCE_DATA* initData,
+                                  _In_z_ LPCWSTR fileName );
+
     HRESULT SaveWICTextureToFile( _In_ ID3D11DeviceContext* pContext,
                                   _In_ ID3D11Resource* pSource,
                                   _In_ REFGUID guidContainerFormat, 
@@ -44,6 +44,7 @@
 #include <memory>
 
 #include "WICTextureLoader.h"
+#include "MipGen.h"
 
 #if defined(_DEBUG) || defined(PROFILE)
 #pragma comment(lib,"dxguid.lib")
@@ -309,6 +310,43 @@ static DXGI_FORMAT MakeSRGB( _In_ DXGI_FORMAT format )
 }
 
 
+//---------------------------------------------------------------------------------
+// Whether the frame's metadata says its colors are sRGB
+//---------------------------------------------------------------------------------
+static bool _IsSRGB( _In_ IWICBitmapFrameDecode* frame )
+{
+    bool sRGB = false;
+
+    ComPtr<IWICMetadataQueryReader> metareader;
+    if ( SUCCEEDED( frame->GetMetadataQueryReader( metareader.GetAddressOf() ) ) )
+    {
+        GUID containerFormat;
+        if ( SUCCEEDED( metareader->GetContainerFormat( &containerFormat ) ) )
+        {
+            PROPVARIANT value;
+            PropVariantInit( &value );
+
+            if ( memcmp( &containerFormat, &GUID_ContainerFormatPng, sizeof(GUID) ) == 0 )
+            {
+                // Check for sRGB chunk
+                if ( SUCCEEDED( metareader->GetMetadataByName( L"/sRGB/RenderingIntent", &value ) ) && value.vt == VT_UI1 )
+                {
+                    sRGB = true;
+                }
+            }
+            else if ( SUCCEEDED( metareader->GetMetadataByName( L"System.Image.ColorSpace", &value ) ) && value.vt == VT_UI2 && value.uiVal == 1 )
+            {
+                sRGB = true;
+            }
+
+            PropVariantClear( &value );
+        }
+    }
+
+    return sRGB;
+}
+
+
 //---------------------------------------------------------------------------------
 static HRESULT CreateTextureFromWIC( _In_ ID3D11Device* d3dDevice,
                                      _In_opt_ ID3D11DeviceContext* d3dContext,
@@ -319,6 +357,8 @@ static HRESULT CreateTextureFromWIC( _In_ ID3D11Device* d3dDevice,
                                      _In_ unsigned int cpuAccessFlags,
                                      _In_ unsigned int miscFlags,
                                      _In_ bool forceSRGB,
+                                     _In_ bool cpuMips,
+                                     _In_ unsigned int mipFlags,
                                      _Out_opt_ ID3D11Resource** texture,
                                      _Out_opt_ ID3D11ShaderResourceView** textureView )
 {
@@ -454,44 +494,10 @@ static HRESULT CreateTextureFromWIC( _In_ ID3D11Device* d3dDevice,
         return E_FAIL;
 
     // Handle sRGB formats
-    if ( forceSRGB )
+    if ( forceSRGB || _IsSRGB( frame ) )
     {
         format = MakeSRGB( format );
     }
-    else
-    {
-        ComPtr<IWICMetadataQueryReader> metareader;
-        if ( SUCCEEDED( frame->GetMetadataQueryReader( metareader.GetAddressOf() ) ) )
-        {
-            GUID containerFormat;
-            if ( SUCCEEDED( metareader->GetContainerFormat( &containerFormat ) ) )
-            {
-                // Check for sRGB colorspace metadata
-                bool sRGB = false;
-
-                PROPVARIANT value;
-                PropVariantInit( &value );
-
-                if ( memcmp( &containerFormat, &GUID_ContainerFormatPng, sizeof(GUID) ) == 0 )
-                {
-                    // Check for sRGB chunk
-                    if ( SUCCEEDED( metareader->GetMetadataByName( L"/sRGB/RenderingIntent", &value ) ) && value.vt == VT_UI1 )
-                    {
-                        sRGB = true;
-                    }
-                }
-                else if ( SUCCEEDED( metareader->GetMetadataByName( L"System.Image.ColorSpace", &value ) ) && value.vt == VT_UI2 && value.uiVal == 1 )
-                {
-                    sRGB = true;
-                }
-
-                PropVariantClear( &value );
-
-                if ( sRGB )
-                    format = MakeSRGB( format );
-            }
-        }
-    }
 
     // Verify our target format is supported by the current device
     // (handles WDDM 1.0 or WDDM 1.1 device driver cases as well as DirectX 11.0 Runtime without 16bpp format support)
@@ -602,9 +608,22 @@ static HRESULT CreateTextureFromWIC( _In_ ID3D11Device* d3dDevice,
             return hr;
     }
 
+    // Filter the mips on the CPU if the format allows, so they go in with the top mip and
+    // the texture can be immutable
+    MipChain mipChain;
+    bool cpugen = false;
+    if ( cpuMips && textureView != 0 && IsMipGenFormat( format ) )
+    {
+        hr = GenerateMipChain( format, twidth, theight, temp.get(), rowPitch, 0, 0, mipFlags, mipChain );
+        if ( FAILED(hr) )
+            return hr;
+
+        cpugen = true;
+    }
+
     // See if format is supported for auto-gen mipmaps (varies by feature level)
     bool autogen = false;
-    if ( d3dContext != 0 && textureView != 0 ) // Must have context and shader-view to auto generate mipmaps
+    if ( !cpugen && d3dContext != 0 && textureView != 0 && usage == D3D11_USAGE_DEFAULT ) // Must have context, shader-view and a writable texture to auto generate mipmaps
     {
         UINT fmtSupport = 0;
         hr = d3dDevice->CheckFormatSupport( format, &fmtSupport );
@@ -618,7 +637,7 @@ static HRESULT CreateTextureFromWIC( _In_ ID3D11Device* d3dDevice,
     D3D11_TEXTURE2D_DESC desc;
     desc.Width = twidth;
     desc.Height = theight;
-    desc.MipLevels = (autogen) ? 0 : 1;
+    desc.MipLevels = (autogen) ? 0 : (cpugen) ? static_cast<UINT>( mipChain.mipCount ) : 1;
     desc.ArraySize = 1;
     desc.Format = format;
     desc.SampleDesc.Count = 1;
@@ -643,7 +662,7 @@ static HRESULT CreateTextureFromWIC( _In_ ID3D11Device* d3dDevice,
     initData.SysMemSlicePitch = static_cast<UINT>( imageSize );
 
     ID3D11Texture2D* tex = nullptr;
-    hr = d3dDevice->CreateTexture2D( &desc, (autogen) ? nullptr : &initData, &tex );
+    hr = d3dDevice->CreateTexture2D( &desc, (autogen) ? nullptr : (cpugen) ? mipChain.mips.get() : &initData, &tex );
     if ( SUCCEEDED(hr) && tex != 0 )
     {
         if (textureView != 0)
@@ -653,7 +672,7 @@ static HRESULT CreateTextureFromWIC( _In_ ID3D11Device* d3dDevice,
             SRVDesc.Format = desc.Format;
 
             SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-            SRVDesc.Texture2D.MipLevels = (autogen) ? -1 : 1;
+            SRVDesc.Texture2D.MipLevels = (autogen || cpugen) ? -1 : 1;
 
             hr = d3dDevice->CreateShaderResourceView( tex, &SRVDesc, textureView );
             if ( FAILED(hr) )
@@ -790,7 +809,7 @@ HRESULT DirectX::CreateWICTextureFromMemoryEx( ID3D11Device* d3dDevice,
         return hr;
 
     hr = CreateTextureFromWIC( d3dDevice, d3dContext, frame.Get(), maxsize,
-                               usage, bindFlags, cpuAccessFlags, miscFlags, forceSRGB,
+                               usage, bindFlags, cpuAccessFlags, miscFlags, forceSRGB, false, 0,
                                texture, textureView );
     if ( FAILED(hr)) 
         return hr;
@@ -851,18 +870,19 @@ HRESULT DirectX::CreateWICTextureFromFileEx( ID3D11Device* d3dDevice,
                                        texture, textureView );
 }
 
-_Use_decl_annotations_
-HRESULT DirectX::CreateWICTextureFromFileEx( ID3D11Device* d3dDevice,
-                                             ID3D11DeviceContext* d3dContext,
-                                             const wchar_t* fileName,
-                                             size_t maxsize,
-                                             D3D11_USAGE usage,
-                                             unsigned int bindFlags,
-                                             unsigned int cpuAccessFlags,
-                                             unsigned int miscFlags,
-                                             bool forceSRGB,
-                                             ID3D11Resource** texture,
-                                             ID3D11ShaderResourceView** textureView )
+static HRESULT CreateTextureFromFile( _In_ ID3D11Device* d3dDevice,
+                                      _In_opt_ ID3D11DeviceContext* d3dContext,
+                                      _In_z_ const wchar_t* fileName,
+                                      _In_ size_t maxsize,
+                                      _In_ D3D11_USAGE usage,
+                                      _In_ unsigned int bindFlags,
+                                      _In_ unsigned int cpuAccessFlags,
+                                      _In_ unsigned int miscFlags,
+                                      _In_ bool forceSRGB,
+                                      _In_ bool cpuMips,
+                                      _In_ unsigned int mipFlags,
+                                      _Out_opt_ ID3D11Resource** texture,
+                                      _Out_opt_ ID3D11ShaderResourceView** textureView )
 {
     if ( texture )
     {
@@ -892,7 +912,7 @@ HRESULT DirectX::CreateWICTextureFromFileEx( ID3D11Device* d3dDevice,
         return hr;
 
     hr = CreateTextureFromWIC( d3dDevice, d3dContext, frame.Get(), maxsize,
-                               usage, bindFlags, cpuAccessFlags, miscFlags, forceSRGB,
+                               usage, bindFlags, cpuAccessFlags, miscFlags, forceSRGB, cpuMips, mipFlags,
                                texture, textureView );
 
 #if defined(_DEBUG) || defined(PROFILE)
@@ -944,3 +964,162 @@ HRESULT DirectX::CreateWICTextureFromFileEx( ID3D11Device* d3dDevice,
 
     return hr;
 }
+
+_Use_decl_annotations_
+HRESULT DirectX::CreateWICTextureFromFileEx( ID3D11Device* d3dDevice,
+                                             ID3D11DeviceContext* d3dContext,
+                                             const wchar_t* fileName,
+                                             size_t maxsize,
+                                             D3D11_USAGE usage,
+                                             unsigned int bindFlags,
+                                             unsigned int cpuAccessFlags,
+                                             unsigned int miscFlags,
+                                             bool forceSRGB,
+                                             ID3D11Resource** texture,
+                                             ID3D11ShaderResourceView** textureView )
+{
+    return CreateTextureFromFile( d3dDevice, d3dContext, fileName, maxsize,
+                                  usage, bindFlags, cpuAccessFlags, miscFlags, forceSRGB, false, 0,
+                                  texture, textureView );
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::CreateWICTextureWithMipsFromFile( ID3D11Device* d3dDevice,
+                                                   ID3D11DeviceContext* d3dContext,
+                                                   const wchar_t* fileName,
+                                                   size_t maxsize,
+                                                   D3D11_USAGE usage,
+                                                   unsigned int bindFlags,
+                                                   unsigned int cpuAccessFlags,
+                                                   unsigned int miscFlags,
+                                                   bool forceSRGB,
+                                                   unsigned int mipFlags,
+                                                   ID3D11Resource** texture,
+                                                   ID3D11ShaderResourceView** textureView )
+{
+    return CreateTextureFromFile( d3dDevice, d3dContext, fileName, maxsize,
+                                  usage, bindFlags, cpuAccessFlags, miscFlags, forceSRGB, true, mipFlags,
+                                  texture, textureView );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::LoadWICTextureFromFile( const wchar_t* fileName,
+                                         size_t maxsize,
+                                         bool forceSRGB,
+                                         std::unique_ptr<uint8_t[]>& pixels,
+                                         size_t& width,
+                                         size_t& height,
+                                         DXGI_FORMAT& format )
+{
+    pixels.reset();
+    width = height = 0;
+    format = DXGI_FORMAT_UNKNOWN;
+
+    if ( !fileName )
+        return E_INVALIDARG;
+
+    IWICImagingFactory* pWIC = _GetWIC();
+    if ( !pWIC )
+        return E_NOINTERFACE;
+
+    ComPtr<IWICBitmapDecoder> decoder;
+    HRESULT hr = pWIC->CreateDecoderFromFilename( fileName, 0, GENERIC_READ, WICDecodeMetadataCacheOnDemand, decoder.GetAddressOf() );
+    if ( FAILED(hr) )
+        return hr;
+
+    ComPtr<IWICBitmapFrameDecode> frame;
+    hr = decoder->GetFrame( 0, frame.GetAddressOf() );
+    if ( FAILED(hr) )
+        return hr;
+
+    UINT fwidth, fheight;
+    hr = frame->GetSize( &fwidth, &fheight );
+    if ( FAILED(hr) )
+        return hr;
+
+    assert( fwidth > 0 && fheight > 0 );
+
+    if ( !maxsize )
+    {
+        maxsize = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+    }
+
+    // Same scaling as CreateTextureFromWIC
+    UINT twidth = fwidth;
+    UINT theight = fheight;
+    if ( fwidth > maxsize || fheight > maxsize )
+    {
+        float ar = static_cast<float>(fheight) / static_cast<float>(fwidth);
+        if ( fwidth > fheight )
+        {
+            twidth = static_cast<UINT>( maxsize );
+            theight = std::max<UINT>( static_cast<UINT>( static_cast<float>(maxsize) * ar ), 1 );
+        }
+        else
+        {
+            theight = static_cast<UINT>( maxsize );
+            twidth = std::max<UINT>( static_cast<UINT>( static_cast<float>(maxsize) / ar ), 1 );
+        }
+    }
+
+    ComPtr<IWICBitmapSource> source( frame );
+    if ( twidth != fwidth || theight != fheight )
+    {
+        ComPtr<IWICBitmapScaler> scaler;
+        hr = pWIC->CreateBitmapScaler( scaler.GetAddressOf() );
+        if ( FAILED(hr) )
+            return hr;
+
+        hr = scaler->Initialize( frame.Get(), twidth, theight, WICBitmapInterpolationModeFant );
+        if ( FAILED(hr) )
+            return hr;
+
+        source = scaler;
+    }
+
+    WICPixelFormatGUID pixelFormat;
+    hr = source->GetPixelFormat( &pixelFormat );
+    if ( FAILED(hr) )
+        return hr;
+
+    if ( memcmp( &GUID_WICPixelFormat32bppRGBA, &pixelFormat, sizeof(GUID) ) != 0 )
+    {
+        ComPtr<IWICFormatConverter> FC;
+        hr = pWIC->CreateFormatConverter( FC.GetAddressOf() );
+        if ( FAILED(hr) )
+            return hr;
+
+        BOOL canConvert = FALSE;
+        hr = FC->CanConvert( pixelFormat, GUID_WICPixelFormat32bppRGBA, &canConvert );
+        if ( FAILED(hr) || !canConvert )
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+
+        hr = FC->Initialize( source.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeErrorDiffusion, 0, 0, WICBitmapPaletteTypeCustom );
+        if ( FAILED(hr) )
+            return hr;
+
+        source = FC;
+    }
+
+    size_t rowPitch = size_t( twidth ) * 4;
+    size_t imageSize = rowPitch * theight;
+    if ( imageSize > UINT32_MAX )
+        return HRESULT_FROM_WIN32( ERROR_ARITHMETIC_OVERFLOW );
+
+    std::unique_ptr<uint8_t[]> temp( new (std::nothrow) uint8_t[ imageSize ] );
+    if (!temp)
+        return E_OUTOFMEMORY;
+
+    hr = source->CopyPixels( 0, static_cast<UINT>( rowPitch ), static_cast<UINT>( imageSize ), temp.get() );
+    if ( FAILED(hr) )
+        return hr;
+
+    pixels = std::move( temp );
+    width = twidth;
+    height = theight;
+    format = ( forceSRGB || _IsSRGB( frame.Get() ) ) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    return S_OK;
+}
@@ -36,6 +36,8 @@
 #include <stdint.h>
 #pragma warning(pop)
 
+#include <memory>
+
 #if defined(_MSC_VER) && (_MSC_VER<1610) && !defined(_In_reads_)
 #define _In_reads_(exp)
 #define _Out_writes_(exp)
@@ -135,4 +137,34 @@ namespace DirectX
                                         _Out_opt_ ID3D11Resource** texture,
                                         _Out_opt_ ID3D11ShaderResourceView** textureView
                                     );
+
+    // Like CreateWICTextureFromFileEx, but 8 bit RGBA images get their full mip chain filtered
+    // on the CPU (see MipGen.h for mipFlags) and created with the texture, so it can be
+    // D3D11_USAGE_IMMUTABLE and d3dContext isn't used. Other formats fall back to
+    // GenerateMips on d3dContext, which needs D3D11_USAGE_DEFAULT; without it they get no mips
+    HRESULT CreateWICTextureWithMipsFromFile( _In_ ID3D11Device* d3dDevice,
+                                              _In_opt_ ID3D11DeviceContext* d3dContext,
+                                              _In_z_ const wchar_t* szFileName,
+                                              _In_ size_t maxsize,
+                                              _In_ D3D11_USAGE usage,
+                                              _In_ unsigned int bindFlags,
+                                              _In_ unsigned int cpuAccessFlags,
+                                              _In_ unsigned int miscFlags,
+                                              _In_ bool forceSRGB,
+                                              _In_ unsigned int mipFlags,
+                                              _Out_opt_ ID3D11Resource** texture,
+                                              _Out_opt_ ID3D11ShaderResourceView** textureView
+                                            );
+
+    // Decodes the first frame of an image to R8G8B8A8 texels on the CPU, scaled down to fit
+    // maxsize (0 for the largest 2D texture Direct3D 11 allows), e.g. to block compress it.
+    // format comes back _SRGB if forceSRGB is set or the image's metadata says so
+    HRESULT LoadWICTextureFromFile( _In_z_ const wchar_t* fileName,
+                                    _In_ size_t maxsize,
+                                    _In_ bool forceSRGB,
+                                    _Out_ std::unique_ptr<uint8_t[]>& pixels,
+                                    _Out_ size_t& width,
+                                    _Out_ size_t& height,
+                                    _Out_ DXGI_FORMAT& format
+                                  );
 }
\ No newline at end of file
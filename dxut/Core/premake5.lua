@@ -27,6 +27,14 @@ project "DXUT"
 
    files { "*.h", "*.cpp" }
 
+   -- DDSFile.cpp doesn't include DXUT.h, so it can also be built headless
+   filter "files:DDSFile.cpp"
+      flags { "NoPCH" }
+
+   -- Nor do the BC decoder and encoder, the mip generator, or the DDSZ container
+   filter "files:BCDecode.cpp or BCEncode.cpp or BCCommon.cpp or MipGen.cpp or DDSZFile.cpp or LZ4Block.cpp"
+      flags { "NoPCH" }
+
    filter "configurations:Debug"
       defines { "WIN32", "_DEBUG", "DEBUG", "PROFILE", "_WINDOWS", "_LIB", "_WIN32_WINNT=0x0601" }
       flags { "Symbols", "FatalWarnings", "Unicode" }
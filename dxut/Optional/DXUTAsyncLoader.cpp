@@ -0,0 +1,512 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTAsyncLoader.cpp
+//
+// Thread pool texture loader with a bounded upload queue and placeholder textures
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#include "dxut.h"
+#include "DXUTAsyncLoader.h"
+#include "SDKmisc.h"
+
+#include "DDSTextureLoader.h"
+#include "WICTextureLoader.h"
+
+#include <process.h>
+
+using namespace DirectX;
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+const UINT MAX_WORKERS = 8;
+
+// Stride used to touch every page of a mapped file, so a worker takes the page faults
+// instead of the thread creating the texture
+const size_t PAGE_STRIDE = 4096;
+
+// RGBA8 texel of each placeholder
+const UINT PLACEHOLDER_TEXELS[DXUT_PLACEHOLDER_COUNT] =
+{
+    0xff808080, // grey
+    0xffff8080, // (0.5, 0.5, 1) encodes a flat normal
+    0xff000000, // black
+};
+
+double GetSeconds()
+{
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter( &counter );
+    QueryPerformanceFrequency( &frequency );
+    return static_cast<double>( counter.QuadPart ) / static_cast<double>( frequency.QuadPart );
+}
+
+}
+
+//--------------------------------------------------------------------------------------
+// Global/Static Members
+//--------------------------------------------------------------------------------------
+static CDXUTAsyncTextureLoader* s_dxut_global_async_texture_loader = nullptr;
+CDXUTAsyncTextureLoader& WINAPI DXUTGetGlobalAsyncTextureLoader()
+{
+    // Using an accessor function gives control of the construction order
+    if ( !s_dxut_global_async_texture_loader )
+    {
+        s_dxut_global_async_texture_loader = new CDXUTAsyncTextureLoader;
+    }
+    return *s_dxut_global_async_texture_loader;
+}
+
+HRESULT WINAPI DXUTDestroyGlobalAsyncTextureLoader()
+{
+    SAFE_DELETE( s_dxut_global_async_texture_loader );
+    return S_OK;
+}
+
+_Use_decl_annotations_
+void WINAPI DXUTCancelAsyncTextureLoads( const void* pOwner )
+{
+    if ( s_dxut_global_async_texture_loader )
+    {
+        s_dxut_global_async_texture_loader->Cancel( pOwner );
+    }
+}
+
+
+//======================================================================================
+// CDXUTAsyncTextureLoader
+//======================================================================================
+
+_Use_decl_annotations_
+CDXUTAsyncTextureLoader::CDXUTAsyncTextureLoader( UINT numWorkers, UINT maxQueuedUploads ) :
+    m_bShutdown( false ),
+    m_NumWorkers( numWorkers ),
+    m_MaxQueuedUploads( std::max( maxQueuedUploads, 1u ) )
+{
+    InitializeCriticalSection( &m_Lock );
+    InitializeConditionVariable( &m_WorkAvailable );
+    InitializeConditionVariable( &m_UploadSpace );
+
+    for( UINT i = 0; i < DXUT_PLACEHOLDER_COUNT; ++i )
+    {
+        m_pPlaceholders[i] = nullptr;
+    }
+
+    if ( !m_NumWorkers )
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo( &info );
+        m_NumWorkers = ( info.dwNumberOfProcessors > 1 ) ? info.dwNumberOfProcessors - 1 : 1;
+    }
+    m_NumWorkers = std::min( m_NumWorkers, MAX_WORKERS );
+}
+
+CDXUTAsyncTextureLoader::~CDXUTAsyncTextureLoader()
+{
+    Shutdown();
+    DeleteCriticalSection( &m_Lock );
+}
+
+
+//--------------------------------------------------------------------------------------
+// The workers are started on the first request, so a loader that is never used costs nothing
+//--------------------------------------------------------------------------------------
+void CDXUTAsyncTextureLoader::StartWorkers()
+{
+    m_bShutdown = false;
+
+    for( UINT i = 0; i < m_NumWorkers; ++i )
+    {
+        HANDLE hThread = reinterpret_cast<HANDLE>( _beginthreadex( nullptr, 0, WorkerThread, this, 0, nullptr ) );
+        if ( hThread )
+        {
+            m_Workers.push_back( hThread );
+        }
+    }
+}
+
+
+void CDXUTAsyncTextureLoader::Shutdown()
+{
+    EnterCriticalSection( &m_Lock );
+    m_bShutdown = true;
+    LeaveCriticalSection( &m_Lock );
+    WakeAllConditionVariable( &m_WorkAvailable );
+    WakeAllConditionVariable( &m_UploadSpace );
+
+    for( auto it = m_Workers.begin(); it != m_Workers.end(); ++it )
+    {
+        WaitForSingleObject( *it, INFINITE );
+        CloseHandle( *it );
+    }
+    m_Workers.clear();
+
+    // No worker is left, so every job can go, however far it got
+    m_LoadQueue.clear();
+    m_UploadQueue.clear();
+    for( auto it = m_Jobs.begin(); it != m_Jobs.end(); ++it )
+    {
+        delete *it;
+    }
+    m_Jobs.clear();
+
+    for( UINT i = 0; i < DXUT_PLACEHOLDER_COUNT; ++i )
+    {
+        SAFE_RELEASE( m_pPlaceholders[i] );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT CDXUTAsyncTextureLoader::CreatePlaceholders( ID3D11Device* pDevice )
+{
+    for( UINT i = 0; i < DXUT_PLACEHOLDER_COUNT; ++i )
+    {
+        if ( m_pPlaceholders[i] )
+        {
+            continue;
+        }
+
+        D3D11_TEXTURE2D_DESC desc;
+        desc.Width = desc.Height = 1;
+        desc.MipLevels = desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.SampleDesc.Quality = 0;
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        desc.CPUAccessFlags = 0;
+        desc.MiscFlags = 0;
+
+        D3D11_SUBRESOURCE_DATA initData;
+        initData.pSysMem = &PLACEHOLDER_TEXELS[i];
+        initData.SysMemPitch = sizeof(UINT);
+        initData.SysMemSlicePitch = sizeof(UINT);
+
+        ID3D11Texture2D* pTexture = nullptr;
+        HRESULT hr = pDevice->CreateTexture2D( &desc, &initData, &pTexture );
+        if ( FAILED(hr) )
+            return hr;
+
+        hr = pDevice->CreateShaderResourceView( pTexture, nullptr, &m_pPlaceholders[i] );
+        SAFE_RELEASE( pTexture );
+        if ( FAILED(hr) )
+            return hr;
+
+        DXUT_SetDebugName( m_pPlaceholders[i], "DXUTAsyncLoader placeholder" );
+    }
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT CDXUTAsyncTextureLoader::Request( ID3D11Device* pDevice, LPCWSTR pSrcFile, bool bSRGB,
+                                          ID3D11ShaderResourceView** ppSRV, ID3D11ShaderResourceView* pOnError,
+                                          DXUT_TEXTURE_PLACEHOLDER placeholder, const void* pOwner, size_t maxsize )
+{
+    if ( !pDevice || !pSrcFile || !ppSRV || placeholder >= DXUT_PLACEHOLDER_COUNT )
+        return E_INVALIDARG;
+
+    // Already loaded
+    if ( DXUTGetGlobalResourceCache().FindTexture( pSrcFile, bSRGB, ppSRV, maxsize ) )
+        return S_OK;
+
+    HRESULT hr = CreatePlaceholders( pDevice );
+    if ( FAILED(hr) )
+        return hr;
+
+    TextureRequest request;
+    request.ppSRV = ppSRV;
+    request.pOnError = pOnError;
+    request.pOwner = pOwner;
+
+    *ppSRV = m_pPlaceholders[placeholder];
+    (*ppSRV)->AddRef();
+
+    // Already being loaded
+    for( auto it = m_Jobs.begin(); it != m_Jobs.end(); ++it )
+    {
+        if ( !wcscmp( (*it)->wszSource, pSrcFile ) && (*it)->bSRGB == bSRGB && (*it)->maxsize == maxsize )
+        {
+            (*it)->requests.push_back( request );
+            return S_OK;
+        }
+    }
+
+    LoadJob* pJob = new (std::nothrow) LoadJob;
+    if ( !pJob )
+    {
+        SAFE_RELEASE( *ppSRV );
+        return E_OUTOFMEMORY;
+    }
+
+    wcscpy_s( pJob->wszSource, MAX_PATH, pSrcFile );
+    pJob->bSRGB = bSRGB;
+    pJob->maxsize = maxsize;
+
+    WCHAR ext[_MAX_EXT];
+    _wsplitpath_s( pSrcFile, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT );
+    pJob->bDDS = ( _wcsicmp( ext, L".dds" ) == 0 );
+
+    pJob->requests.push_back( request );
+    pJob->hr = E_PENDING;
+    m_Jobs.push_back( pJob );
+
+    if ( m_Workers.empty() )
+    {
+        StartWorkers();
+    }
+
+    if ( m_Workers.empty() )
+    {
+        // No thread could be started, so load it right here
+        LoadFile( pJob );
+        m_UploadQueue.push_back( pJob );
+        return S_OK;
+    }
+
+    EnterCriticalSection( &m_Lock );
+    m_LoadQueue.push_back( pJob );
+    LeaveCriticalSection( &m_Lock );
+    WakeConditionVariable( &m_WorkAvailable );
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+unsigned int __stdcall CDXUTAsyncTextureLoader::WorkerThread( void* pParam )
+{
+    static_cast<CDXUTAsyncTextureLoader*>( pParam )->WorkerLoop();
+    return 0;
+}
+
+
+void CDXUTAsyncTextureLoader::WorkerLoop()
+{
+    for(;;)
+    {
+        EnterCriticalSection( &m_Lock );
+        while( m_LoadQueue.empty() && !m_bShutdown )
+        {
+            SleepConditionVariableCS( &m_WorkAvailable, &m_Lock, INFINITE );
+        }
+
+        if ( m_bShutdown )
+        {
+            LeaveCriticalSection( &m_Lock );
+            return;
+        }
+
+        LoadJob* pJob = m_LoadQueue.front();
+        m_LoadQueue.pop_front();
+        LeaveCriticalSection( &m_Lock );
+
+        LoadFile( pJob );
+
+        // Wait for room in the upload queue, so the files in flight are bounded
+        EnterCriticalSection( &m_Lock );
+        while( m_UploadQueue.size() >= m_MaxQueuedUploads && !m_bShutdown )
+        {
+            SleepConditionVariableCS( &m_UploadSpace, &m_Lock, INFINITE );
+        }
+
+        if ( m_bShutdown )
+        {
+            LeaveCriticalSection( &m_Lock );
+            return;
+        }
+
+        m_UploadQueue.push_back( pJob );
+        LeaveCriticalSection( &m_Lock );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Runs on a worker. Only reads the job's source and writes its file and result
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTAsyncTextureLoader::LoadFile( LoadJob* pJob )
+{
+    pJob->hr = pJob->file.Open( pJob->wszSource );
+    if ( FAILED(pJob->hr) )
+        return;
+
+    if ( pJob->bDDS )
+    {
+        DDSTextureDesc desc;
+        pJob->hr = ParseDDSHeader( pJob->file.data(), pJob->file.size(), desc );
+        if ( FAILED(pJob->hr) )
+            return;
+    }
+
+    if ( pJob->file.IsMapped() )
+    {
+        const volatile uint8_t* pData = pJob->file.data();
+        uint8_t touch = 0;
+        for( size_t offset = 0; offset < pJob->file.size(); offset += PAGE_STRIDE )
+        {
+            touch ^= pData[offset];
+        }
+        UNREFERENCED_PARAMETER( touch );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+UINT CDXUTAsyncTextureLoader::ProcessUploads( ID3D11Device* pDevice, ID3D11DeviceContext* pContext, float fBudgetMs )
+{
+    if ( !pDevice )
+        return 0;
+
+    const double fEnd = GetSeconds() + fBudgetMs * 0.001;
+    UINT numCreated = 0;
+
+    for(;;)
+    {
+        EnterCriticalSection( &m_Lock );
+        LoadJob* pJob = nullptr;
+        if ( !m_UploadQueue.empty() )
+        {
+            pJob = m_UploadQueue.front();
+            m_UploadQueue.pop_front();
+        }
+        LeaveCriticalSection( &m_Lock );
+
+        if ( !pJob )
+            break;
+
+        WakeConditionVariable( &m_UploadSpace );
+
+        HRESULT hr = pJob->hr;
+        ID3D11ShaderResourceView* pSRV = nullptr;
+        if ( SUCCEEDED(hr) && !pJob->requests.empty() )
+        {
+            if ( pJob->bDDS )
+            {
+                // The subresources are read straight from the mapped file
+                hr = CreateDDSTextureFromMemoryEx( pDevice, pJob->file.data(), pJob->file.size(), pJob->maxsize,
+                                                   D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0, pJob->bSRGB,
+                                                   nullptr, &pSRV );
+            }
+            else
+            {
+                hr = CreateWICTextureFromMemoryEx( pDevice, pContext, pJob->file.data(), pJob->file.size(), pJob->maxsize,
+                                                   D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0, pJob->bSRGB,
+                                                   nullptr, &pSRV );
+            }
+
+            if ( SUCCEEDED(hr) )
+            {
+                DXUTGetGlobalResourceCache().AddTexture( pJob->wszSource, pJob->bSRGB, pSRV, pJob->maxsize );
+                ++numCreated;
+            }
+        }
+
+        for( auto it = pJob->requests.begin(); it != pJob->requests.end(); ++it )
+        {
+            SAFE_RELEASE( *it->ppSRV );
+            if ( pSRV )
+            {
+                *it->ppSRV = pSRV;
+                pSRV->AddRef();
+            }
+            else
+            {
+                *it->ppSRV = it->pOnError;
+            }
+        }
+        SAFE_RELEASE( pSRV );
+
+        m_Jobs.erase( std::find( m_Jobs.begin(), m_Jobs.end(), pJob ) );
+        delete pJob;
+
+        if ( GetSeconds() >= fEnd )
+            break;
+    }
+
+    return numCreated;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTAsyncTextureLoader::Cancel( const void* pOwner )
+{
+    EnterCriticalSection( &m_Lock );
+
+    for( auto it = m_Jobs.begin(); it != m_Jobs.end(); )
+    {
+        LoadJob* pJob = *it;
+        auto& requests = pJob->requests;
+        for( auto req = requests.begin(); req != requests.end(); )
+        {
+            if ( req->pOwner == pOwner )
+                req = requests.erase( req );
+            else
+                ++req;
+        }
+
+        // A job no worker has picked up yet can go right away; the others are dropped
+        // when they reach ProcessUploads
+        auto queued = std::find( m_LoadQueue.begin(), m_LoadQueue.end(), pJob );
+        if ( requests.empty() && queued != m_LoadQueue.end() )
+        {
+            m_LoadQueue.erase( queued );
+            delete pJob;
+            it = m_Jobs.erase( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    LeaveCriticalSection( &m_Lock );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+UINT CDXUTAsyncTextureLoader::GetNumPending( const void* pOwner ) const
+{
+    UINT numPending = 0;
+    for( auto it = m_Jobs.cbegin(); it != m_Jobs.cend(); ++it )
+    {
+        for( auto req = (*it)->requests.cbegin(); req != (*it)->requests.cend(); ++req )
+        {
+            if ( !pOwner || req->pOwner == pOwner )
+                ++numPending;
+        }
+    }
+    return numPending;
+}
+
+
+_Use_decl_annotations_
+bool CDXUTAsyncTextureLoader::IsPlaceholder( const ID3D11ShaderResourceView* pSRV ) const
+{
+    if ( !pSRV )
+        return false;
+
+    for( UINT i = 0; i < DXUT_PLACEHOLDER_COUNT; ++i )
+    {
+        if ( m_pPlaceholders[i] == pSRV )
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,122 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTAsyncLoader.h
+//
+// Loads textures on a pool of worker threads. The workers open and map the files, parse
+// and validate DDS headers and fault the texels in, then queue the result for upload.
+// The upload queue is bounded, so the workers stall rather than hold every file in
+// memory when the device falls behind. Resources are only created in ProcessUploads,
+// on the thread that renders, within a time budget.
+//
+// Until a texture has been created, its requests hold a 1x1 placeholder SRV, so the
+// caller can bind them right away. The finished textures are added to the global
+// resource cache.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "DDSFile.h"
+
+enum DXUT_TEXTURE_PLACEHOLDER
+{
+    DXUT_PLACEHOLDER_GREY = 0,      // diffuse
+    DXUT_PLACEHOLDER_FLAT_NORMAL,   // tangent space (0, 0, 1)
+    DXUT_PLACEHOLDER_BLACK,         // specular
+    DXUT_PLACEHOLDER_COUNT
+};
+
+class CDXUTAsyncTextureLoader
+{
+public:
+    // numWorkers of 0 starts one worker per hardware thread, less one for the render thread.
+    // maxQueuedUploads is how many loaded files may wait for ProcessUploads
+    CDXUTAsyncTextureLoader( _In_ UINT numWorkers = 0, _In_ UINT maxQueuedUploads = 8 );
+    ~CDXUTAsyncTextureLoader();
+
+    // Points *ppSRV at a placeholder and queues the file. When the texture has been created,
+    // ProcessUploads releases the placeholder and stores the texture, or pOnError if it
+    // failed. Requests for a file that is already cached complete immediately; requests for
+    // a file that is already queued share its load. *ppSRV must stay valid until the request
+    // completes or is cancelled. DDS files skip the top mips larger than maxsize (0 for none);
+    // images loaded through WIC are scaled down to it
+    HRESULT Request( _In_ ID3D11Device* pDevice, _In_z_ LPCWSTR pSrcFile, _In_ bool bSRGB,
+                     _Inout_ ID3D11ShaderResourceView** ppSRV, _In_opt_ ID3D11ShaderResourceView* pOnError,
+                     _In_ DXUT_TEXTURE_PLACEHOLDER placeholder, _In_opt_ const void* pOwner, _In_ size_t maxsize = 0 );
+
+    // Creates the textures of the loaded files until fBudgetMs has passed (at least one)
+    // Returns the number of textures created
+    UINT ProcessUploads( _In_ ID3D11Device* pDevice, _In_opt_ ID3D11DeviceContext* pContext, _In_ float fBudgetMs = 4.0f );
+
+    // Forgets the requests of pOwner; their slots keep the placeholder
+    void Cancel( _In_opt_ const void* pOwner );
+
+    // Requests not completed yet, of pOwner or of all owners if it's null
+    UINT GetNumPending( _In_opt_ const void* pOwner = nullptr ) const;
+
+    bool IsPlaceholder( _In_opt_ const ID3D11ShaderResourceView* pSRV ) const;
+
+    UINT GetNumWorkers() const { return static_cast<UINT>( m_Workers.size() ); }
+
+    // Stops the workers and releases the placeholders, e.g. when the device is destroyed
+    void Shutdown();
+
+private:
+    struct TextureRequest
+    {
+        ID3D11ShaderResourceView**  ppSRV;
+        ID3D11ShaderResourceView*   pOnError;
+        const void*                 pOwner;
+    };
+
+    struct LoadJob
+    {
+        WCHAR                       wszSource[MAX_PATH];
+        bool                        bSRGB;
+        bool                        bDDS;
+        size_t                      maxsize;
+        std::vector<TextureRequest> requests;       // only touched by the render thread
+        DirectX::MappedFile         file;           // written by a worker, then handed over
+        HRESULT                     hr;
+    };
+
+    CDXUTAsyncTextureLoader( const CDXUTAsyncTextureLoader& );
+    CDXUTAsyncTextureLoader& operator=( const CDXUTAsyncTextureLoader& );
+
+    static unsigned int __stdcall WorkerThread( _In_ void* pParam );
+    void WorkerLoop();
+    static void LoadFile( _Inout_ LoadJob* pJob );
+
+    HRESULT CreatePlaceholders( _In_ ID3D11Device* pDevice );
+    void StartWorkers();
+
+    // Shared with the workers, guarded by m_Lock
+    CRITICAL_SECTION                    m_Lock;
+    CONDITION_VARIABLE                  m_WorkAvailable;
+    CONDITION_VARIABLE                  m_UploadSpace;
+    std::deque<LoadJob*>                m_LoadQueue;
+    std::deque<LoadJob*>                m_UploadQueue;
+    bool                                m_bShutdown;
+
+    // Only touched by the render thread
+    std::vector<LoadJob*>               m_Jobs;         // every job not uploaded yet
+    std::vector<HANDLE>                 m_Workers;
+    UINT                                m_NumWorkers;
+    UINT                                m_MaxQueuedUploads;
+    ID3D11ShaderResourceView*           m_pPlaceholders[DXUT_PLACEHOLDER_COUNT];
+};
+
+CDXUTAsyncTextureLoader& WINAPI DXUTGetGlobalAsyncTextureLoader();
+HRESULT WINAPI DXUTDestroyGlobalAsyncTextureLoader();
+
+// Safe to call after the global loader was destroyed, e.g. from a mesh's Destroy
+void WINAPI DXUTCancelAsyncTextureLoads( _In_opt_ const void* pOwner );
@@ -0,0 +1,343 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTMipScheduler.cpp
+//
+// Mip streaming decisions, without a device
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "DXUTMipScheduler.h"
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+// Closer than this, a texture wants its finest mip anyway
+const float MIN_DISTANCE = 1e-4f;
+
+struct ImportanceGreater
+{
+    const std::vector<float>* pImportance;
+    bool operator()( uint32_t a, uint32_t b ) const { return (*pImportance)[a] > (*pImportance)[b]; }
+};
+
+}
+
+//--------------------------------------------------------------------------------------
+CDXUTMipStreamScheduler::CDXUTMipStreamScheduler() :
+    m_BudgetBytes( 256 * 1024 * 1024 ),
+    m_AllocatedBytes( 0 ),
+    m_MaxLoadsInFlight( 4 ),
+    m_NumLoadsInFlight( 0 ),
+    m_NumEvictions( 0 ),
+    m_fLodBias( 0.0f )
+{
+}
+
+
+//--------------------------------------------------------------------------------------
+uint32_t CDXUTMipStreamScheduler::AddTexture( uint32_t size, uint32_t mipCount, uint32_t tailMip, const uint64_t* mipBytes )
+{
+    if ( !mipCount || !mipBytes )
+        return INVALID_TEXTURE;
+
+    Texture texture;
+    texture.mipBytes.assign( mipBytes, mipBytes + mipCount );
+    texture.size = std::max<uint32_t>( size, 1 );
+    texture.tailMip = std::min( tailMip, mipCount - 1 );
+    texture.allocMip = texture.tailMip;
+    texture.residentMip = texture.tailMip;
+    texture.desiredMip = texture.tailMip;
+    texture.loadingMip = INVALID_MIP;
+    texture.startAllocMip = texture.tailMip;
+    texture.fScreenSize = 0.0f;
+    texture.bLive = true;
+    texture.bFailed = false;
+
+    uint32_t id;
+    if ( !m_FreeIds.empty() )
+    {
+        id = m_FreeIds.back();
+        m_FreeIds.pop_back();
+        m_Textures[id] = texture;
+    }
+    else
+    {
+        id = static_cast<uint32_t>( m_Textures.size() );
+        m_Textures.push_back( texture );
+    }
+
+    return id;
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTMipStreamScheduler::RemoveTexture( uint32_t texture )
+{
+    if ( texture >= m_Textures.size() || !m_Textures[texture].bLive )
+        return;
+
+    Texture& t = m_Textures[texture];
+    for( uint32_t mip = t.allocMip; mip < t.tailMip; ++mip )
+    {
+        m_AllocatedBytes -= t.mipBytes[mip];
+    }
+
+    if ( t.loadingMip != INVALID_MIP )
+    {
+        --m_NumLoadsInFlight;
+    }
+
+    t.bLive = false;
+    t.mipBytes.clear();
+    m_FreeIds.push_back( texture );
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTMipStreamScheduler::SetScreenSize( uint32_t texture, float fPixels )
+{
+    if ( texture < m_Textures.size() && m_Textures[texture].bLive )
+    {
+        m_Textures[texture].fScreenSize = std::max( m_Textures[texture].fScreenSize, fPixels );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+float CDXUTMipStreamScheduler::GetImportance( const Texture& texture, uint32_t mip ) const
+{
+    uint32_t texels = std::max<uint32_t>( texture.size >> mip, 1 );
+    return texture.fScreenSize / static_cast<float>( texels );
+}
+
+
+//--------------------------------------------------------------------------------------
+uint32_t CDXUTMipStreamScheduler::FindVictim( float fImportance, uint32_t exclude ) const
+{
+    uint32_t victim = INVALID_TEXTURE;
+    float fLowest = fImportance;
+
+    for( uint32_t i = 0; i < m_Textures.size(); ++i )
+    {
+        const Texture& t = m_Textures[i];
+        if ( !t.bLive || i == exclude || t.allocMip >= t.tailMip )
+            continue;
+
+        float fMipImportance = GetImportance( t, t.allocMip );
+        if ( fMipImportance < fLowest )
+        {
+            fLowest = fMipImportance;
+            victim = i;
+        }
+    }
+
+    return victim;
+}
+
+
+uint64_t CDXUTMipStreamScheduler::GetReclaimableBytes( float fImportance, uint32_t exclude ) const
+{
+    uint64_t bytes = 0;
+
+    // The importance of a texture's mips grows towards the tail, so the mips that can go
+    // are the finest ones
+    for( uint32_t i = 0; i < m_Textures.size(); ++i )
+    {
+        const Texture& t = m_Textures[i];
+        if ( !t.bLive || i == exclude )
+            continue;
+
+        for( uint32_t mip = t.allocMip; mip < t.tailMip && GetImportance( t, mip ) < fImportance; ++mip )
+        {
+            bytes += t.mipBytes[mip];
+        }
+    }
+
+    return bytes;
+}
+
+
+void CDXUTMipStreamScheduler::Shrink( uint32_t texture )
+{
+    Texture& t = m_Textures[texture];
+    assert( t.allocMip < t.tailMip );
+
+    m_AllocatedBytes -= t.mipBytes[t.allocMip];
+    ++t.allocMip;
+    t.residentMip = std::max( t.residentMip, t.allocMip );
+    ++m_NumEvictions;
+}
+
+
+void CDXUTMipStreamScheduler::Grow( uint32_t texture )
+{
+    Texture& t = m_Textures[texture];
+    assert( t.allocMip > 0 );
+
+    --t.allocMip;
+    m_AllocatedBytes += t.mipBytes[t.allocMip];
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTMipStreamScheduler::Update( std::vector<Action>& actions )
+{
+    actions.clear();
+
+    const float fBiasScale = powf( 2.0f, m_fLodBias );
+    const uint32_t numTextures = static_cast<uint32_t>( m_Textures.size() );
+
+    // The desired mip is the coarsest one that still has at least a texel per pixel
+    for( uint32_t i = 0; i < numTextures; ++i )
+    {
+        Texture& t = m_Textures[i];
+        if ( !t.bLive )
+            continue;
+
+        t.startAllocMip = t.allocMip;
+        t.desiredMip = t.tailMip;
+        const float fPixels = t.fScreenSize * fBiasScale;
+        while( t.desiredMip > 0 && static_cast<float>( std::max<uint32_t>( t.size >> t.desiredMip, 1 ) ) < fPixels )
+        {
+            --t.desiredMip;
+        }
+    }
+
+    // Memory pressure: give up the least important mips until the allocations fit
+    while( m_AllocatedBytes > m_BudgetBytes )
+    {
+        uint32_t victim = FindVictim( FLT_MAX, INVALID_TEXTURE );
+        if ( victim == INVALID_TEXTURE )
+            break;
+
+        Shrink( victim );
+    }
+
+    // Grow towards the desired mips, most important first. A texture can take memory from
+    // mips that are worth less than the one it adds
+    m_Importance.assign( numTextures, 0.0f );
+    m_Order.clear();
+    for( uint32_t i = 0; i < numTextures; ++i )
+    {
+        const Texture& t = m_Textures[i];
+        if ( t.bLive && !t.bFailed && t.allocMip > t.desiredMip )
+        {
+            m_Importance[i] = GetImportance( t, t.allocMip - 1 );
+            m_Order.push_back( i );
+        }
+    }
+
+    ImportanceGreater greater = { &m_Importance };
+    std::sort( m_Order.begin(), m_Order.end(), greater );
+
+    for( size_t j = 0; j < m_Order.size(); ++j )
+    {
+        const uint32_t i = m_Order[j];
+        while( m_Textures[i].allocMip > m_Textures[i].desiredMip )
+        {
+            const Texture& t = m_Textures[i];
+            const uint32_t mip = t.allocMip - 1;
+            const float fMipImportance = GetImportance( t, mip );
+
+            // Don't evict anything unless it makes enough room
+            if ( m_AllocatedBytes + t.mipBytes[mip] > m_BudgetBytes
+                 && m_AllocatedBytes + t.mipBytes[mip] - GetReclaimableBytes( fMipImportance, i ) > m_BudgetBytes )
+                break;
+
+            while( m_AllocatedBytes + t.mipBytes[mip] > m_BudgetBytes )
+            {
+                Shrink( FindVictim( fMipImportance, i ) );
+            }
+
+            Grow( i );
+        }
+    }
+
+    for( uint32_t i = 0; i < numTextures; ++i )
+    {
+        const Texture& t = m_Textures[i];
+        if ( t.bLive && t.allocMip != t.startAllocMip )
+        {
+            Action action = { i, ACTION_RESIZE, t.allocMip };
+            actions.push_back( action );
+        }
+    }
+
+    // Load the next finer mip of the textures that have room for it, coarse to fine, so
+    // each step up in detail can be shown as soon as it arrives
+    m_Order.clear();
+    for( uint32_t i = 0; i < numTextures; ++i )
+    {
+        const Texture& t = m_Textures[i];
+        if ( t.bLive && !t.bFailed && t.loadingMip == INVALID_MIP
+             && t.residentMip > std::max( t.allocMip, t.desiredMip ) )
+        {
+            m_Importance[i] = GetImportance( t, t.residentMip - 1 );
+            m_Order.push_back( i );
+        }
+    }
+    std::sort( m_Order.begin(), m_Order.end(), greater );
+
+    for( size_t j = 0; j < m_Order.size() && m_NumLoadsInFlight < m_MaxLoadsInFlight; ++j )
+    {
+        Texture& t = m_Textures[m_Order[j]];
+        t.loadingMip = t.residentMip - 1;
+        ++m_NumLoadsInFlight;
+
+        Action action = { m_Order[j], ACTION_LOAD, t.loadingMip };
+        actions.push_back( action );
+    }
+
+    for( uint32_t i = 0; i < numTextures; ++i )
+    {
+        m_Textures[i].fScreenSize = 0.0f;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTMipStreamScheduler::OnLoadComplete( uint32_t texture, uint32_t mip, bool bSucceeded )
+{
+    if ( texture >= m_Textures.size() || !m_Textures[texture].bLive )
+        return;
+
+    Texture& t = m_Textures[texture];
+    if ( t.loadingMip != mip )
+        return;
+
+    t.loadingMip = INVALID_MIP;
+    --m_NumLoadsInFlight;
+
+    if ( !bSucceeded )
+    {
+        t.bFailed = true;
+    }
+    else if ( mip >= t.allocMip && mip < t.residentMip )
+    {
+        // Otherwise the mip was evicted while it was loading
+        t.residentMip = mip;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+float CDXUTMipStreamScheduler::ScreenSizeFromDistance( float fWorldSize, float fDistance, float fProjScaleY, float fViewportHeight )
+{
+    return fWorldSize * fProjScaleY * 0.5f * fViewportHeight / std::max( fDistance, MIN_DISTANCE );
+}
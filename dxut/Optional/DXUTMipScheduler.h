@@ -0,0 +1,134 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTMipScheduler.h
+//
+// Decides which mips of streamed textures should be in memory. Each texture has a mip
+// tail that is always resident, an allocation (the finest mip its texture has room for)
+// and a resident mip (the finest mip whose data has arrived). Sampling is clamped to the
+// resident mip until the finer ones have been loaded.
+//
+// Every update the textures report the largest size in pixels they were drawn at. That
+// gives each mip an importance: pixels on screen per texel of the mip. Textures grow
+// towards the mip where a texel covers about a pixel, most important first. When the
+// memory budget runs out, the least important finest mips are evicted, so distant and
+// small textures give up memory before nearby ones.
+//
+// Nothing here needs a Direct3D device or windows.h, so the scheduler can be tested and
+// simulated headless. CDXUTMipStreamer applies its decisions to D3D11 textures.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#include <stdint.h>
+#include <vector>
+
+class CDXUTMipStreamScheduler
+{
+public:
+    enum ActionType
+    {
+        ACTION_RESIZE,  // reallocate the texture with mip as its finest mip, keeping the resident data
+        ACTION_LOAD,    // read mip and upload it, then call OnLoadComplete
+    };
+
+    struct Action
+    {
+        uint32_t    texture;
+        ActionType  type;
+        uint32_t    mip;
+    };
+
+    static const uint32_t INVALID_TEXTURE = UINT32_MAX;
+
+    CDXUTMipStreamScheduler();
+
+    // size is the larger of the width and height of mip 0. mipBytes holds the memory of each
+    // mip, with all its array slices. Mips from tailMip on are resident from the start and are
+    // never evicted. Returns the texture's id
+    uint32_t AddTexture( uint32_t size, uint32_t mipCount, uint32_t tailMip, const uint64_t* mipBytes );
+
+    // A load in flight for the texture must not be reported afterwards
+    void RemoveTexture( uint32_t texture );
+
+    // The budget only applies to the mips above the tails
+    void SetBudget( uint64_t budgetBytes ) { m_BudgetBytes = budgetBytes; }
+    uint64_t GetBudget() const { return m_BudgetBytes; }
+
+    void SetMaxLoadsInFlight( uint32_t maxLoads ) { m_MaxLoadsInFlight = maxLoads ? maxLoads : 1; }
+
+    // Positive biases want finer mips than a texel per pixel
+    void SetLodBias( float fBias ) { m_fLodBias = fBias; }
+
+    // Reports the size in pixels, along the larger texture axis, that the texture was drawn at.
+    // Reports since the last Update are combined by taking the largest
+    void SetScreenSize( uint32_t texture, float fPixels );
+
+    // Replaces actions with what should be done this frame: the resizes first, then the loads.
+    // The resizes are considered done when Update returns. Clears the screen sizes
+    void Update( std::vector<Action>& actions );
+
+    // A failed load leaves the texture at its resident mip, and it won't be retried
+    void OnLoadComplete( uint32_t texture, uint32_t mip, bool bSucceeded );
+
+    uint32_t GetAllocatedMip( uint32_t texture ) const { return m_Textures[texture].allocMip; }
+    uint32_t GetResidentMip( uint32_t texture ) const { return m_Textures[texture].residentMip; }
+    uint32_t GetDesiredMip( uint32_t texture ) const { return m_Textures[texture].desiredMip; }
+
+    // Memory of every allocated mip above the tails
+    uint64_t GetAllocatedBytes() const { return m_AllocatedBytes; }
+    uint32_t GetNumLoadsInFlight() const { return m_NumLoadsInFlight; }
+    uint32_t GetNumEvictions() const { return m_NumEvictions; }
+
+    // Pixels covered by an object of fWorldSize at fDistance from the eye. fProjScaleY is
+    // element (1, 1) of the projection matrix, 1 / tan(fovY / 2)
+    static float ScreenSizeFromDistance( float fWorldSize, float fDistance, float fProjScaleY, float fViewportHeight );
+
+private:
+    struct Texture
+    {
+        std::vector<uint64_t>   mipBytes;
+        uint32_t                size;
+        uint32_t                tailMip;
+        uint32_t                allocMip;
+        uint32_t                residentMip;
+        uint32_t                desiredMip;
+        uint32_t                loadingMip;     // INVALID_MIP when nothing is in flight
+        uint32_t                startAllocMip;  // allocMip when the update started
+        float                   fScreenSize;
+        bool                    bLive;
+        bool                    bFailed;
+    };
+
+    static const uint32_t INVALID_MIP = UINT32_MAX;
+
+    // Screen pixels per texel of mip: the higher, the more the mip is worth keeping
+    float GetImportance( const Texture& texture, uint32_t mip ) const;
+
+    // Least important finest allocated mip whose importance is below fImportance, other than
+    // of exclude; INVALID_TEXTURE if there is none
+    uint32_t FindVictim( float fImportance, uint32_t exclude ) const;
+    // Memory of all the mips FindVictim could return
+    uint64_t GetReclaimableBytes( float fImportance, uint32_t exclude ) const;
+    void Shrink( uint32_t texture );
+    void Grow( uint32_t texture );
+
+    std::vector<Texture>    m_Textures;
+    std::vector<uint32_t>   m_FreeIds;
+    std::vector<uint32_t>   m_Order;            // scratch for sorting
+    std::vector<float>      m_Importance;
+    uint64_t                m_BudgetBytes;
+    uint64_t                m_AllocatedBytes;
+    uint32_t                m_MaxLoadsInFlight;
+    uint32_t                m_NumLoadsInFlight;
+    uint32_t                m_NumEvictions;
+    float                   m_fLodBias;
+};
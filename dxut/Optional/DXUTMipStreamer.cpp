@@ -0,0 +1,603 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTMipStreamer.cpp
+//
+// Progressive mip streaming for 2D DDS textures
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#include "dxut.h"
+#include "DXUTMipStreamer.h"
+
+#include <process.h>
+
+using namespace DirectX;
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+// Mips no larger than this along either axis make up the tail, which is always resident
+const size_t TAIL_SIZE = 64;
+
+const size_t PAGE_STRIDE = 4096;
+
+bool IsCompressed( DXGI_FORMAT format )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+}
+
+//--------------------------------------------------------------------------------------
+// Global/Static Members
+//--------------------------------------------------------------------------------------
+static CDXUTMipStreamer* s_dxut_global_mip_streamer = nullptr;
+static bool s_dxut_mip_streaming_enabled = false;
+
+CDXUTMipStreamer& WINAPI DXUTGetGlobalMipStreamer()
+{
+    // Using an accessor function gives control of the construction order
+    if ( !s_dxut_global_mip_streamer )
+    {
+        s_dxut_global_mip_streamer = new CDXUTMipStreamer;
+    }
+    return *s_dxut_global_mip_streamer;
+}
+
+HRESULT WINAPI DXUTDestroyGlobalMipStreamer()
+{
+    SAFE_DELETE( s_dxut_global_mip_streamer );
+    return S_OK;
+}
+
+_Use_decl_annotations_
+void WINAPI DXUTSetMipStreaming( bool bEnabled )
+{
+    s_dxut_mip_streaming_enabled = bEnabled;
+}
+
+bool WINAPI DXUTIsMipStreamingEnabled()
+{
+    return s_dxut_mip_streaming_enabled;
+}
+
+_Use_decl_annotations_
+void WINAPI DXUTCancelMipStreaming( const void* pOwner )
+{
+    if ( s_dxut_global_mip_streamer )
+    {
+        s_dxut_global_mip_streamer->Cancel( pOwner );
+    }
+}
+
+
+//======================================================================================
+// CDXUTMipStreamer
+//======================================================================================
+
+CDXUTMipStreamer::CDXUTMipStreamer() :
+    m_bShutdown( false ),
+    m_hWorker( nullptr )
+{
+    InitializeCriticalSection( &m_Lock );
+    InitializeConditionVariable( &m_WorkAvailable );
+}
+
+CDXUTMipStreamer::~CDXUTMipStreamer()
+{
+    Shutdown();
+    DeleteCriticalSection( &m_Lock );
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTMipStreamer::Shutdown()
+{
+    if ( m_hWorker )
+    {
+        EnterCriticalSection( &m_Lock );
+        m_bShutdown = true;
+        LeaveCriticalSection( &m_Lock );
+        WakeAllConditionVariable( &m_WorkAvailable );
+
+        WaitForSingleObject( m_hWorker, INFINITE );
+        CloseHandle( m_hWorker );
+        m_hWorker = nullptr;
+    }
+
+    m_bShutdown = false;
+    m_LoadQueue.clear();
+    m_DoneQueue.clear();
+
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+    {
+        StopStreaming( *it );
+        ReleaseResources( *it );
+        delete *it;
+    }
+    m_Textures.clear();
+
+    for( auto it = m_Removed.begin(); it != m_Removed.end(); ++it )
+    {
+        delete *it;
+    }
+    m_Removed.clear();
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT CDXUTMipStreamer::Request( ID3D11Device* pDevice, LPCWSTR pSrcFile, bool bSRGB,
+                                   ID3D11ShaderResourceView** ppSRV, const void* pOwner )
+{
+    if ( !pDevice || !pSrcFile || !ppSRV )
+        return E_INVALIDARG;
+
+    Slot slot;
+    slot.ppSRV = ppSRV;
+    slot.pOwner = pOwner;
+
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+    {
+        if ( !wcscmp( (*it)->wszSource, pSrcFile ) && (*it)->bSRGB == bSRGB )
+        {
+            (*it)->slots.push_back( slot );
+            *ppSRV = (*it)->pSRV;
+            (*ppSRV)->AddRef();
+            return S_OK;
+        }
+    }
+
+    WCHAR ext[_MAX_EXT];
+    _wsplitpath_s( pSrcFile, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT );
+    if ( _wcsicmp( ext, L".dds" ) != 0 )
+        return S_FALSE;
+
+    std::unique_ptr<StreamedTexture> texture( new (std::nothrow) StreamedTexture );
+    if ( !texture )
+        return E_OUTOFMEMORY;
+
+    HRESULT hr = texture->file.Open( pSrcFile );
+    if ( FAILED(hr) )
+        return hr;
+
+    const DDSTextureDesc& desc = texture->desc;
+    hr = ParseDDSHeader( texture->file.data(), texture->file.size(), texture->desc );
+    if ( FAILED(hr) )
+        return hr;
+
+    if ( desc.resDim != D3D11_RESOURCE_DIMENSION_TEXTURE2D || desc.arraySize != 1 || desc.isCubeMap || desc.mipCount < 2 )
+        return S_FALSE;
+
+    // The tail must stay a valid texture on its own, and so must every allocation above it,
+    // which for block compressed formats means whole blocks
+    std::vector<uint64_t> mipBytes( desc.mipCount );
+    size_t tailMip = desc.mipCount - 1;
+    for( size_t mip = 0; mip < desc.mipCount; ++mip )
+    {
+        DDSMipLayout layout;
+        hr = GetMipLayout( desc, 0, mip, layout );
+        if ( FAILED(hr) )
+            return hr;
+
+        mipBytes[mip] = layout.numBytes;
+
+        if ( mip > tailMip )
+            continue;
+
+        if ( IsCompressed( desc.format ) && ( ( layout.width % 4 ) || ( layout.height % 4 ) ) )
+            return S_FALSE;
+
+        if ( layout.width <= TAIL_SIZE && layout.height <= TAIL_SIZE )
+        {
+            tailMip = mip;
+        }
+    }
+
+    if ( !tailMip )
+        return S_FALSE;
+
+    wcscpy_s( texture->wszSource, MAX_PATH, pSrcFile );
+    texture->bSRGB = bSRGB;
+    texture->format = bSRGB ? MakeSRGB( desc.format ) : desc.format;
+    texture->tailMip = static_cast<uint32_t>( tailMip );
+    texture->allocMip = texture->tailMip;
+    texture->residentMip = texture->tailMip;
+    texture->pTexture = nullptr;
+    texture->pSRV = nullptr;
+    texture->bLoading = false;
+    texture->bRemoved = false;
+
+    std::vector<D3D11_SUBRESOURCE_DATA> initData( desc.mipCount - tailMip );
+    for( size_t mip = tailMip; mip < desc.mipCount; ++mip )
+    {
+        DDSMipLayout layout;
+        (void)GetMipLayout( desc, 0, mip, layout );
+        initData[mip - tailMip].pSysMem = desc.bitData + layout.offset;
+        initData[mip - tailMip].SysMemPitch = static_cast<UINT>( layout.rowBytes );
+        initData[mip - tailMip].SysMemSlicePitch = static_cast<UINT>( layout.slicePitch );
+    }
+
+    hr = CreateTexture( pDevice, texture.get(), texture->tailMip, initData.data(), &texture->pTexture, &texture->pSRV );
+    if ( FAILED(hr) )
+        return hr;
+
+    texture->id = m_Scheduler.AddTexture( static_cast<uint32_t>( std::max( desc.width, desc.height ) ),
+                                          static_cast<uint32_t>( desc.mipCount ), texture->tailMip, mipBytes.data() );
+
+    texture->slots.push_back( slot );
+    *ppSRV = texture->pSRV;
+    (*ppSRV)->AddRef();
+
+    m_Textures.push_back( texture.release() );
+
+    if ( !m_hWorker )
+    {
+        m_hWorker = reinterpret_cast<HANDLE>( _beginthreadex( nullptr, 0, WorkerThread, this, 0, nullptr ) );
+    }
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT CDXUTMipStreamer::CreateTexture( ID3D11Device* pDevice, const StreamedTexture* pTexture, uint32_t allocMip,
+                                         const D3D11_SUBRESOURCE_DATA* pInitData,
+                                         ID3D11Texture2D** ppTexture, ID3D11ShaderResourceView** ppSRV )
+{
+    *ppTexture = nullptr;
+    *ppSRV = nullptr;
+
+    D3D11_TEXTURE2D_DESC desc;
+    desc.Width = static_cast<UINT>( std::max<size_t>( pTexture->desc.width >> allocMip, 1 ) );
+    desc.Height = static_cast<UINT>( std::max<size_t>( pTexture->desc.height >> allocMip, 1 ) );
+    desc.MipLevels = static_cast<UINT>( pTexture->desc.mipCount - allocMip );
+    desc.ArraySize = 1;
+    desc.Format = pTexture->format;
+    desc.SampleDesc.Count = 1;
+    desc.SampleDesc.Quality = 0;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = 0;
+    desc.MiscFlags = 0;
+
+    HRESULT hr = pDevice->CreateTexture2D( &desc, pInitData, ppTexture );
+    if ( FAILED(hr) )
+        return hr;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc;
+    memset( &SRVDesc, 0, sizeof( SRVDesc ) );
+    SRVDesc.Format = desc.Format;
+    SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    SRVDesc.Texture2D.MipLevels = static_cast<UINT>( -1 );
+
+    hr = pDevice->CreateShaderResourceView( *ppTexture, &SRVDesc, ppSRV );
+    if ( FAILED(hr) )
+    {
+        SAFE_RELEASE( *ppTexture );
+        return hr;
+    }
+
+    DXUT_SetDebugName( *ppTexture, "DXUTMipStreamer" );
+    DXUT_SetDebugName( *ppSRV, "DXUTMipStreamer" );
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Takes over the new texture and view, and points every slot at the view
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTMipStreamer::SetView( StreamedTexture* pTexture, ID3D11Texture2D* pNewTexture, ID3D11ShaderResourceView* pNewSRV )
+{
+    for( auto it = pTexture->slots.begin(); it != pTexture->slots.end(); ++it )
+    {
+        SAFE_RELEASE( *it->ppSRV );
+        *it->ppSRV = pNewSRV;
+        pNewSRV->AddRef();
+    }
+
+    ReleaseResources( pTexture );
+    pTexture->pTexture = pNewTexture;
+    pTexture->pSRV = pNewSRV;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTMipStreamer::Resize( ID3D11Device* pDevice, ID3D11DeviceContext* pContext, StreamedTexture* pTexture, uint32_t allocMip )
+{
+    if ( allocMip == pTexture->allocMip )
+        return;
+
+    ID3D11Texture2D* pNewTexture = nullptr;
+    ID3D11ShaderResourceView* pNewSRV = nullptr;
+    if ( FAILED( CreateTexture( pDevice, pTexture, allocMip, nullptr, &pNewTexture, &pNewSRV ) ) )
+    {
+        // Keep what is resident, and don't stream this texture any further
+        StopStreaming( pTexture );
+        return;
+    }
+
+    // Evicted mips are simply not copied
+    const uint32_t residentMip = std::max( pTexture->residentMip, allocMip );
+    for( uint32_t mip = residentMip; mip < pTexture->desc.mipCount; ++mip )
+    {
+        pContext->CopySubresourceRegion( pNewTexture, mip - allocMip, 0, 0, 0,
+                                         pTexture->pTexture, mip - pTexture->allocMip, nullptr );
+    }
+
+    SetView( pTexture, pNewTexture, pNewSRV );
+    pTexture->allocMip = allocMip;
+    pTexture->residentMip = residentMip;
+
+    // The mips above the resident one have no data yet
+    pContext->SetResourceMinLOD( pNewTexture, static_cast<float>( residentMip - allocMip ) );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTMipStreamer::Upload( ID3D11DeviceContext* pContext, StreamedTexture* pTexture, uint32_t mip )
+{
+    DDSMipLayout layout;
+    if ( FAILED( GetMipLayout( pTexture->desc, 0, mip, layout ) ) )
+        return;
+
+    pContext->UpdateSubresource( pTexture->pTexture, mip - pTexture->allocMip, nullptr,
+                                 pTexture->desc.bitData + layout.offset,
+                                 static_cast<UINT>( layout.rowBytes ), static_cast<UINT>( layout.slicePitch ) );
+
+    pTexture->residentMip = mip;
+    pContext->SetResourceMinLOD( pTexture->pTexture, static_cast<float>( mip - pTexture->allocMip ) );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTMipStreamer::SetScreenSize( const ID3D11ShaderResourceView* pSRV, float fPixels )
+{
+    if ( !pSRV )
+        return;
+
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+    {
+        if ( (*it)->pSRV == pSRV )
+        {
+            m_Scheduler.SetScreenSize( (*it)->id, fPixels );
+            return;
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTMipStreamer::Update( ID3D11Device* pDevice, ID3D11DeviceContext* pContext )
+{
+    if ( !pDevice || !pContext )
+        return;
+
+    std::deque<LoadJob> done;
+    EnterCriticalSection( &m_Lock );
+    done.swap( m_DoneQueue );
+    LeaveCriticalSection( &m_Lock );
+
+    for( auto it = done.begin(); it != done.end(); ++it )
+    {
+        StreamedTexture* pTexture = it->pTexture;
+        pTexture->bLoading = false;
+
+        if ( pTexture->bRemoved || pTexture->id == CDXUTMipStreamScheduler::INVALID_TEXTURE )
+            continue;
+
+        m_Scheduler.OnLoadComplete( pTexture->id, it->mip, SUCCEEDED(it->hr) );
+
+        // Unless the mip was evicted while it was being read
+        if ( SUCCEEDED(it->hr) && m_Scheduler.GetResidentMip( pTexture->id ) == it->mip
+             && it->mip >= pTexture->allocMip && it->mip < pTexture->residentMip )
+        {
+            Upload( pContext, pTexture, it->mip );
+        }
+    }
+
+    for( auto it = m_Removed.begin(); it != m_Removed.end(); )
+    {
+        if ( !(*it)->bLoading )
+        {
+            delete *it;
+            it = m_Removed.erase( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    m_Scheduler.Update( m_Actions );
+
+    bool bQueued = false;
+    for( auto action = m_Actions.cbegin(); action != m_Actions.cend(); ++action )
+    {
+        StreamedTexture* pTexture = nullptr;
+        for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+        {
+            if ( (*it)->id == action->texture )
+            {
+                pTexture = *it;
+                break;
+            }
+        }
+
+        // Stopped by a failed resize earlier in this update
+        if ( !pTexture )
+            continue;
+
+        if ( action->type == CDXUTMipStreamScheduler::ACTION_RESIZE )
+        {
+            Resize( pDevice, pContext, pTexture, action->mip );
+        }
+        else
+        {
+            LoadJob job;
+            job.pTexture = pTexture;
+            job.mip = action->mip;
+            job.hr = E_PENDING;
+
+            pTexture->bLoading = true;
+            EnterCriticalSection( &m_Lock );
+            m_LoadQueue.push_back( job );
+            LeaveCriticalSection( &m_Lock );
+            bQueued = true;
+        }
+    }
+
+    if ( bQueued )
+    {
+        WakeConditionVariable( &m_WorkAvailable );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+unsigned int __stdcall CDXUTMipStreamer::WorkerThread( void* pParam )
+{
+    static_cast<CDXUTMipStreamer*>( pParam )->WorkerLoop();
+    return 0;
+}
+
+
+void CDXUTMipStreamer::WorkerLoop()
+{
+    for(;;)
+    {
+        EnterCriticalSection( &m_Lock );
+        while( m_LoadQueue.empty() && !m_bShutdown )
+        {
+            SleepConditionVariableCS( &m_WorkAvailable, &m_Lock, INFINITE );
+        }
+
+        if ( m_bShutdown )
+        {
+            LeaveCriticalSection( &m_Lock );
+            return;
+        }
+
+        LoadJob job = m_LoadQueue.front();
+        m_LoadQueue.pop_front();
+        LeaveCriticalSection( &m_Lock );
+
+        // The texture isn't deleted while it's loading, and its file and header don't change.
+        // Touching the mip's pages here keeps the page faults off the render thread
+        DDSMipLayout layout;
+        job.hr = GetMipLayout( job.pTexture->desc, 0, job.mip, layout );
+        if ( SUCCEEDED(job.hr) && job.pTexture->file.IsMapped() )
+        {
+            const volatile uint8_t* pData = job.pTexture->desc.bitData + layout.offset;
+            uint8_t touch = 0;
+            for( size_t offset = 0; offset < layout.numBytes; offset += PAGE_STRIDE )
+            {
+                touch ^= pData[offset];
+            }
+            UNREFERENCED_PARAMETER( touch );
+        }
+
+        EnterCriticalSection( &m_Lock );
+        m_DoneQueue.push_back( job );
+        LeaveCriticalSection( &m_Lock );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTMipStreamer::Cancel( const void* pOwner )
+{
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); )
+    {
+        StreamedTexture* pTexture = *it;
+        auto& slots = pTexture->slots;
+        for( auto slot = slots.begin(); slot != slots.end(); )
+        {
+            if ( slot->pOwner == pOwner )
+                slot = slots.erase( slot );
+            else
+                ++slot;
+        }
+
+        if ( !slots.empty() )
+        {
+            ++it;
+            continue;
+        }
+
+        StopStreaming( pTexture );
+        ReleaseResources( pTexture );
+        if ( pTexture->bLoading )
+        {
+            pTexture->bRemoved = true;
+            m_Removed.push_back( pTexture );
+        }
+        else
+        {
+            delete pTexture;
+        }
+        it = m_Textures.erase( it );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTMipStreamer::StopStreaming( StreamedTexture* pTexture )
+{
+    if ( pTexture->id != CDXUTMipStreamScheduler::INVALID_TEXTURE )
+    {
+        m_Scheduler.RemoveTexture( pTexture->id );
+        pTexture->id = CDXUTMipStreamScheduler::INVALID_TEXTURE;
+    }
+}
+
+
+_Use_decl_annotations_
+void CDXUTMipStreamer::ReleaseResources( StreamedTexture* pTexture )
+{
+    SAFE_RELEASE( pTexture->pSRV );
+    SAFE_RELEASE( pTexture->pTexture );
+}
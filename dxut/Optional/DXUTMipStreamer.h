@@ -0,0 +1,141 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTMipStreamer.h
+//
+// Progressive mip streaming for 2D DDS textures. A texture starts out with only its mip
+// tail (the mips of 64x64 texels and less), which is uploaded right away, so it can be
+// drawn immediately. The finer mips are streamed in afterwards, as far as the screen
+// size reported for the texture calls for and the memory budget allows.
+//
+// Each texture is allocated down to the finest mip CDXUTMipStreamScheduler grants it.
+// Sampling is clamped to the finest mip whose data has arrived with SetResourceMinLOD,
+// and a worker thread faults in each mip's pages from the mapped file before it is
+// uploaded on the render thread. Evicting mips reallocates the texture without them,
+// copying the coarser mips on the GPU.
+//
+// Because resizing replaces the texture's view, requests hand in the slot that holds
+// the view, the way CDXUTAsyncTextureLoader does, and the slots are updated.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "DDSFile.h"
+#include "DXUTMipScheduler.h"
+
+class CDXUTMipStreamer
+{
+public:
+    CDXUTMipStreamer();
+    ~CDXUTMipStreamer();
+
+    // Budget, LOD bias and loads in flight. The global streamer is destroyed with the device,
+    // so set them up after creating it
+    CDXUTMipStreamScheduler& GetScheduler() { return m_Scheduler; }
+
+    // Creates the texture with its mip tail and points *ppSRV at it, with a reference the
+    // caller releases. Returns S_FALSE without touching *ppSRV if the file can't be streamed:
+    // anything but a 2D DDS texture with mips finer than the tail. Requests for a texture
+    // that is already streaming share it. *ppSRV must stay valid until the request is cancelled
+    HRESULT Request( _In_ ID3D11Device* pDevice, _In_z_ LPCWSTR pSrcFile, _In_ bool bSRGB,
+                     _Inout_ ID3D11ShaderResourceView** ppSRV, _In_opt_ const void* pOwner );
+
+    // Reports the size in pixels a texture is drawn at this frame, by its current view
+    void SetScreenSize( _In_opt_ const ID3D11ShaderResourceView* pSRV, _In_ float fPixels );
+
+    // Once per frame, after the screen sizes: uploads the mips that have been read, then
+    // resizes textures and starts loads as the scheduler decides
+    void Update( _In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pContext );
+
+    // Forgets the requests of pOwner; textures nobody uses any more are released
+    void Cancel( _In_opt_ const void* pOwner );
+
+    UINT GetNumTextures() const { return static_cast<UINT>( m_Textures.size() ); }
+
+    // Bytes of texture memory above the mip tails
+    UINT64 GetStreamedBytes() const { return m_Scheduler.GetAllocatedBytes(); }
+
+    // Stops the worker and releases every texture, e.g. when the device is destroyed
+    void Shutdown();
+
+private:
+    struct Slot
+    {
+        ID3D11ShaderResourceView**  ppSRV;
+        const void*                 pOwner;
+    };
+
+    struct StreamedTexture
+    {
+        WCHAR                       wszSource[MAX_PATH];
+        bool                        bSRGB;
+        DirectX::MappedFile         file;
+        DirectX::DDSTextureDesc     desc;
+        DXGI_FORMAT                 format;         // with sRGB applied
+        uint32_t                    id;             // in the scheduler
+        uint32_t                    allocMip;
+        uint32_t                    residentMip;
+        uint32_t                    tailMip;
+        ID3D11Texture2D*            pTexture;
+        ID3D11ShaderResourceView*   pSRV;
+        std::vector<Slot>           slots;
+        bool                        bLoading;       // a worker may be reading the file
+        bool                        bRemoved;       // delete once the load is back
+    };
+
+    struct LoadJob
+    {
+        StreamedTexture*            pTexture;
+        uint32_t                    mip;
+        HRESULT                     hr;
+    };
+
+    CDXUTMipStreamer( const CDXUTMipStreamer& );
+    CDXUTMipStreamer& operator=( const CDXUTMipStreamer& );
+
+    static unsigned int __stdcall WorkerThread( _In_ void* pParam );
+    void WorkerLoop();
+
+    static HRESULT CreateTexture( _In_ ID3D11Device* pDevice, _In_ const StreamedTexture* pTexture, _In_ uint32_t allocMip,
+                                  _In_opt_ const D3D11_SUBRESOURCE_DATA* pInitData,
+                                  _Outptr_ ID3D11Texture2D** ppTexture, _Outptr_ ID3D11ShaderResourceView** ppSRV );
+    void Resize( _In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pContext, _In_ StreamedTexture* pTexture, _In_ uint32_t allocMip );
+    void Upload( _In_ ID3D11DeviceContext* pContext, _In_ StreamedTexture* pTexture, _In_ uint32_t mip );
+    static void SetView( _In_ StreamedTexture* pTexture, _In_ ID3D11Texture2D* pNewTexture, _In_ ID3D11ShaderResourceView* pNewSRV );
+    void StopStreaming( _In_ StreamedTexture* pTexture );
+    static void ReleaseResources( _In_ StreamedTexture* pTexture );
+
+    // Shared with the worker, guarded by m_Lock
+    CRITICAL_SECTION                    m_Lock;
+    CONDITION_VARIABLE                  m_WorkAvailable;
+    std::deque<LoadJob>                 m_LoadQueue;
+    std::deque<LoadJob>                 m_DoneQueue;
+    bool                                m_bShutdown;
+
+    // Only touched by the render thread
+    CDXUTMipStreamScheduler             m_Scheduler;
+    std::vector<CDXUTMipStreamScheduler::Action> m_Actions;
+    std::vector<StreamedTexture*>       m_Textures;
+    std::vector<StreamedTexture*>       m_Removed;      // waiting for their loads
+    HANDLE                              m_hWorker;
+};
+
+CDXUTMipStreamer& WINAPI DXUTGetGlobalMipStreamer();
+HRESULT WINAPI DXUTDestroyGlobalMipStreamer();
+
+// Whether CDXUTSDKMesh streams the mips of its DDS textures. Off by default; it applies to
+// meshes created after it was set, and outlives the global streamer
+void WINAPI DXUTSetMipStreaming( _In_ bool bEnabled );
+bool WINAPI DXUTIsMipStreamingEnabled();
+
+// Safe to call after the global streamer was destroyed
+void WINAPI DXUTCancelMipStreaming( _In_opt_ const void* pOwner );
@@ -0,0 +1,186 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTResidencyPlanner.cpp
+//
+// Texture residency decisions, without a device
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "DXUTResidencyPlanner.h"
+
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+//--------------------------------------------------------------------------------------
+CDXUTResidencyPlanner::CDXUTResidencyPlanner() :
+    m_BudgetBytes( 256 * 1024 * 1024 ),
+    m_ReservedBytes( 0 ),
+    m_PlannedBytes( 0 ),
+    m_fLodBias( 0.0f )
+{
+}
+
+
+//--------------------------------------------------------------------------------------
+uint32_t CDXUTResidencyPlanner::AddTexture( uint32_t size, uint32_t mipCount, uint32_t maxSkip, const uint64_t* mipBytes, float fPixels )
+{
+    if ( !mipCount || !mipBytes )
+        return INVALID_TEXTURE;
+
+    Texture texture;
+    texture.mipBytes.assign( mipBytes, mipBytes + mipCount );
+    texture.size = std::max<uint32_t>( size, 1 );
+    texture.maxSkip = std::min( maxSkip, mipCount - 1 );
+    texture.skipMips = 0;
+    texture.fScreenSize = std::max( fPixels, 0.0f );
+    texture.bLive = true;
+
+    uint32_t id;
+    if ( !m_FreeIds.empty() )
+    {
+        id = m_FreeIds.back();
+        m_FreeIds.pop_back();
+        m_Textures[id] = texture;
+    }
+    else
+    {
+        id = static_cast<uint32_t>( m_Textures.size() );
+        m_Textures.push_back( texture );
+    }
+
+    m_PlannedBytes += GetBytes( m_Textures[id], 0 );
+
+    return id;
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTResidencyPlanner::RemoveTexture( uint32_t texture )
+{
+    if ( texture >= m_Textures.size() || !m_Textures[texture].bLive )
+        return;
+
+    Texture& t = m_Textures[texture];
+    m_PlannedBytes -= GetBytes( t, t.skipMips );
+
+    t.bLive = false;
+    t.mipBytes.clear();
+    m_FreeIds.push_back( texture );
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTResidencyPlanner::SetScreenSize( uint32_t texture, float fPixels )
+{
+    if ( texture < m_Textures.size() && m_Textures[texture].bLive )
+    {
+        m_Textures[texture].fScreenSize = std::max( fPixels, 0.0f );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+uint32_t CDXUTResidencyPlanner::GetMaxSize( uint32_t texture ) const
+{
+    const Texture& t = m_Textures[texture];
+    return t.skipMips ? std::max<uint32_t>( t.size >> t.skipMips, 1 ) : 0;
+}
+
+
+//--------------------------------------------------------------------------------------
+float CDXUTResidencyPlanner::GetImportance( const Texture& texture, uint32_t mip, float fBiasScale ) const
+{
+    uint32_t texels = std::max<uint32_t>( texture.size >> mip, 1 );
+    float fPixels = texture.fScreenSize > 0.0f ? texture.fScreenSize * fBiasScale : static_cast<float>( texture.size );
+    return fPixels / static_cast<float>( texels );
+}
+
+
+//--------------------------------------------------------------------------------------
+uint64_t CDXUTResidencyPlanner::GetBytes( const Texture& texture, uint32_t mip )
+{
+    uint64_t bytes = 0;
+    for( size_t i = mip; i < texture.mipBytes.size(); ++i )
+    {
+        bytes += texture.mipBytes[i];
+    }
+    return bytes;
+}
+
+
+//--------------------------------------------------------------------------------------
+bool CDXUTResidencyPlanner::Plan()
+{
+    const float fBiasScale = powf( 2.0f, m_fLodBias );
+    const uint32_t numTextures = static_cast<uint32_t>( m_Textures.size() );
+    const uint64_t availableBytes = m_BudgetBytes > m_ReservedBytes ? m_BudgetBytes - m_ReservedBytes : 0;
+
+    std::vector<uint32_t> startSkip( numTextures, 0 );
+
+    // Start each texture at the coarsest mip that still has at least a texel per pixel
+    m_PlannedBytes = 0;
+    for( uint32_t i = 0; i < numTextures; ++i )
+    {
+        Texture& t = m_Textures[i];
+        if ( !t.bLive )
+            continue;
+
+        startSkip[i] = t.skipMips;
+        t.skipMips = 0;
+        while( t.skipMips < t.maxSkip && GetImportance( t, t.skipMips + 1, fBiasScale ) <= 1.0f )
+        {
+            ++t.skipMips;
+        }
+
+        m_PlannedBytes += GetBytes( t, t.skipMips );
+    }
+
+    // Memory pressure: drop the least important top mips until the textures fit
+    while( m_PlannedBytes > availableBytes )
+    {
+        uint32_t victim = INVALID_TEXTURE;
+        float fLowest = FLT_MAX;
+        for( uint32_t i = 0; i < numTextures; ++i )
+        {
+            const Texture& t = m_Textures[i];
+            if ( !t.bLive || t.skipMips >= t.maxSkip )
+                continue;
+
+            float fImportance = GetImportance( t, t.skipMips, fBiasScale );
+            if ( fImportance < fLowest )
+            {
+                fLowest = fImportance;
+                victim = i;
+            }
+        }
+
+        if ( victim == INVALID_TEXTURE )
+            break;
+
+        Texture& t = m_Textures[victim];
+        m_PlannedBytes -= t.mipBytes[t.skipMips];
+        ++t.skipMips;
+    }
+
+    bool bChanged = false;
+    for( uint32_t i = 0; i < numTextures; ++i )
+    {
+        if ( m_Textures[i].bLive && m_Textures[i].skipMips != startSkip[i] )
+        {
+            bChanged = true;
+        }
+    }
+
+    return bChanged;
+}
@@ -0,0 +1,102 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTResidencyPlanner.h
+//
+// Decides how many top mips of each texture to leave out when it is loaded, so that the
+// textures fit a memory budget. The budget is shared with other allocations, such as
+// render targets, that are reserved from it first.
+//
+// Each texture has an importance: the size in pixels it is expected to be drawn at. A
+// texture never keeps mips finer than a texel per pixel. When the textures don't fit,
+// the top mip with the fewest screen pixels per texel is dropped, over and over, so large
+// textures on small or distant surfaces give up memory before those close to the camera.
+//
+// Plans are only made when asked for, since every change means reloading textures. Once
+// a plan is made the loader applies it with the maxsize of DDSTextureLoader.
+//
+// Nothing here needs a Direct3D device or windows.h, so the planner can be tested and
+// simulated headless. CDXUTTextureResidency applies its plans to D3D11 textures.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#include <stdint.h>
+#include <vector>
+
+class CDXUTResidencyPlanner
+{
+public:
+    static const uint32_t INVALID_TEXTURE = UINT32_MAX;
+
+    CDXUTResidencyPlanner();
+
+    // size is the larger of the width, height and depth of mip 0. mipBytes holds the memory of
+    // each mip, with all its array slices. At most maxSkip top mips may be left out. fPixels is
+    // the size the texture is drawn at, along its larger axis; 0 if it isn't known, which
+    // plans it as if each texel of mip 0 covered a pixel. Returns the texture's id
+    uint32_t AddTexture( uint32_t size, uint32_t mipCount, uint32_t maxSkip, const uint64_t* mipBytes, float fPixels );
+
+    void RemoveTexture( uint32_t texture );
+
+    // Replaces the size the texture is drawn at. Takes effect at the next Plan
+    void SetScreenSize( uint32_t texture, float fPixels );
+
+    // Everything in the plan and the reserved bytes are held to the budget
+    void SetBudget( uint64_t budgetBytes ) { m_BudgetBytes = budgetBytes; }
+    uint64_t GetBudget() const { return m_BudgetBytes; }
+
+    // Memory taken from the budget by other allocations, e.g. render targets
+    void SetReservedBytes( uint64_t reservedBytes ) { m_ReservedBytes = reservedBytes; }
+    uint64_t GetReservedBytes() const { return m_ReservedBytes; }
+
+    // Positive biases want finer mips than a texel per pixel
+    void SetLodBias( float fBias ) { m_fLodBias = fBias; }
+
+    // Picks the mips to skip for every texture. Returns whether any texture's plan changed
+    bool Plan();
+
+    uint32_t GetSkipMips( uint32_t texture ) const { return m_Textures[texture].skipMips; }
+
+    // The maxsize that makes DDSTextureLoader skip the planned mips; 0 when none are
+    uint32_t GetMaxSize( uint32_t texture ) const;
+
+    // Memory of the planned mips of every texture
+    uint64_t GetPlannedBytes() const { return m_PlannedBytes; }
+
+    // Whether the last plan fit the budget; it doesn't when every texture is down to maxSkip
+    // and they still take too much
+    bool Fits() const { return m_PlannedBytes + m_ReservedBytes <= m_BudgetBytes; }
+
+private:
+    struct Texture
+    {
+        std::vector<uint64_t>   mipBytes;
+        uint32_t                size;
+        uint32_t                maxSkip;
+        uint32_t                skipMips;
+        float                   fScreenSize;
+        bool                    bLive;
+    };
+
+    // Screen pixels per texel of mip: the higher, the more the mip is worth keeping
+    float GetImportance( const Texture& texture, uint32_t mip, float fBiasScale ) const;
+
+    // Memory of the mips from mip down
+    static uint64_t GetBytes( const Texture& texture, uint32_t mip );
+
+    std::vector<Texture>    m_Textures;
+    std::vector<uint32_t>   m_FreeIds;
+    uint64_t                m_BudgetBytes;
+    uint64_t                m_ReservedBytes;
+    uint64_t                m_PlannedBytes;
+    float                   m_fLodBias;
+};
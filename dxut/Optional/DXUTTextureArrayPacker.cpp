@@ -0,0 +1,113 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTTextureArrayPacker.cpp
+//
+// Texture array grouping, without a device
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#include "DXUTTextureArrayPacker.h"
+
+#include <stddef.h>
+
+//--------------------------------------------------------------------------------------
+CDXUTTextureArrayPacker::CDXUTTextureArrayPacker() :
+    m_MaxSlices( MAX_SLICES )
+{
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTTextureArrayPacker::SetMaxSlices( uint32_t maxSlices )
+{
+    if ( maxSlices < 1 )
+        maxSlices = 1;
+    if ( maxSlices > MAX_SLICES )
+        maxSlices = MAX_SLICES;
+
+    m_MaxSlices = maxSlices;
+}
+
+
+//--------------------------------------------------------------------------------------
+uint32_t CDXUTTextureArrayPacker::AddTexture( uint32_t format, uint32_t width, uint32_t height, uint32_t mipLevels )
+{
+    if ( !width || !height || !mipLevels )
+        return INVALID_TEXTURE;
+
+    Texture texture;
+    texture.format = format;
+    texture.width = width;
+    texture.height = height;
+    texture.mipLevels = mipLevels;
+    texture.array = INVALID_TEXTURE;
+    texture.slice = 0;
+    m_Textures.push_back( texture );
+
+    return static_cast<uint32_t>( m_Textures.size() - 1 );
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTTextureArrayPacker::Clear()
+{
+    m_Textures.clear();
+    m_Arrays.clear();
+}
+
+
+//--------------------------------------------------------------------------------------
+bool CDXUTTextureArrayPacker::IsCompatible( const Texture& texture, const TextureArray& array )
+{
+    return texture.format == array.format
+        && texture.width == array.width
+        && texture.height == array.height
+        && texture.mipLevels == array.mipLevels;
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTTextureArrayPacker::Pack()
+{
+    m_Arrays.clear();
+
+    // Only the last array of each kind has room, so that is the one to look for; a mesh has
+    // few kinds of texture, so a linear search is enough
+    for( size_t i = 0; i < m_Textures.size(); ++i )
+    {
+        Texture& texture = m_Textures[i];
+
+        size_t array = m_Arrays.size();
+        for( size_t j = m_Arrays.size(); j-- > 0; )
+        {
+            if ( IsCompatible( texture, m_Arrays[j] ) )
+            {
+                if ( m_Arrays[j].textures.size() < m_MaxSlices )
+                {
+                    array = j;
+                }
+                break;
+            }
+        }
+
+        if ( array == m_Arrays.size() )
+        {
+            TextureArray newArray;
+            newArray.format = texture.format;
+            newArray.width = texture.width;
+            newArray.height = texture.height;
+            newArray.mipLevels = texture.mipLevels;
+            m_Arrays.push_back( newArray );
+        }
+
+        texture.array = static_cast<uint32_t>( array );
+        texture.slice = static_cast<uint32_t>( m_Arrays[array].textures.size() );
+        m_Arrays[array].textures.push_back( static_cast<uint32_t>( i ) );
+    }
+}
@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTTextureArrayPacker.h
+//
+// Groups textures that have the same format, size and mip count into texture arrays, so
+// that a mesh can bind one array for many materials and pick each material's texture by
+// its slice index, instead of binding a view per subset.
+//
+// Textures are added in order and keep that order within their array; arrays are made in
+// the order their first texture was added, and an array that would exceed maxSlices is
+// split. The result is the same every time for the same textures, so the remap table of a
+// mesh is stable between runs.
+//
+// Nothing here needs a Direct3D device or windows.h, so the grouping can be tested
+// headless. CDXUTSDKMesh::CreateTextureArrays copies the textures into the arrays.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#ifdef _MSC_VER
+#pragma once
+#endif
+
+#include <stdint.h>
+#include <vector>
+
+class CDXUTTextureArrayPacker
+{
+public:
+    static const uint32_t INVALID_TEXTURE = UINT32_MAX;
+
+    // D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+    static const uint32_t MAX_SLICES = 2048;
+
+    struct TextureArray
+    {
+        uint32_t                format;         // a DXGI_FORMAT
+        uint32_t                width;
+        uint32_t                height;
+        uint32_t                mipLevels;
+        std::vector<uint32_t>   textures;       // the texture in each slice
+    };
+
+    CDXUTTextureArrayPacker();
+
+    // At most this many slices go in an array; clamped to [1, MAX_SLICES]
+    void SetMaxSlices( uint32_t maxSlices );
+
+    // Returns the texture's id. Textures are never merged, so add each one once
+    uint32_t AddTexture( uint32_t format, uint32_t width, uint32_t height, uint32_t mipLevels );
+
+    // Forgets every texture and array
+    void Clear();
+
+    // Groups the textures added so far into arrays, replacing the last grouping
+    void Pack();
+
+    uint32_t GetNumTextures() const { return static_cast<uint32_t>( m_Textures.size() ); }
+    uint32_t GetNumArrays() const { return static_cast<uint32_t>( m_Arrays.size() ); }
+    const TextureArray& GetArray( uint32_t array ) const { return m_Arrays[array]; }
+
+    // Where the last Pack put a texture
+    uint32_t GetArrayIndex( uint32_t texture ) const { return m_Textures[texture].array; }
+    uint32_t GetSlice( uint32_t texture ) const { return m_Textures[texture].slice; }
+
+private:
+    struct Texture
+    {
+        uint32_t    format;
+        uint32_t    width;
+        uint32_t    height;
+        uint32_t    mipLevels;
+        uint32_t    array;
+        uint32_t    slice;
+    };
+
+    static bool IsCompatible( const Texture& texture, const TextureArray& array );
+
+    std::vector<Texture>        m_Textures;
+    std::vector<TextureArray>   m_Arrays;
+    uint32_t                    m_MaxSlices;
+};
@@ -0,0 +1,471 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTTextureResidency.cpp
+//
+// Budgeted texture residency through the maxsize of DDSTextureLoader
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#include "dxut.h"
+#include "DXUTTextureResidency.h"
+#include "SDKmisc.h"
+
+using namespace DirectX;
+
+//--------------------------------------------------------------------------------------
+namespace
+{
+
+// Textures keep their mips of this size and smaller along the larger axis
+const size_t MIN_SIZE = 64;
+
+}
+
+//--------------------------------------------------------------------------------------
+// Global/Static Members
+//--------------------------------------------------------------------------------------
+static CDXUTTextureResidency* s_dxut_global_texture_residency = nullptr;
+static bool s_dxut_texture_residency_enabled = false;
+
+CDXUTTextureResidency& WINAPI DXUTGetGlobalTextureResidency()
+{
+    // Using an accessor function gives control of the construction order
+    if ( !s_dxut_global_texture_residency )
+    {
+        s_dxut_global_texture_residency = new CDXUTTextureResidency;
+    }
+    return *s_dxut_global_texture_residency;
+}
+
+HRESULT WINAPI DXUTDestroyGlobalTextureResidency()
+{
+    SAFE_DELETE( s_dxut_global_texture_residency );
+    return S_OK;
+}
+
+_Use_decl_annotations_
+void WINAPI DXUTSetTextureResidency( bool bEnabled )
+{
+    s_dxut_texture_residency_enabled = bEnabled;
+}
+
+bool WINAPI DXUTIsTextureResidencyEnabled()
+{
+    return s_dxut_texture_residency_enabled;
+}
+
+_Use_decl_annotations_
+void WINAPI DXUTCancelTextureResidency( const void* pOwner )
+{
+    if ( s_dxut_global_texture_residency )
+    {
+        s_dxut_global_texture_residency->Cancel( pOwner );
+    }
+}
+
+
+//======================================================================================
+// CDXUTTextureResidency
+//======================================================================================
+
+CDXUTTextureResidency::CDXUTTextureResidency() :
+    m_fViewportHeight( 0.0f ),
+    m_NumReloads( 0 ),
+    m_bDirty( false )
+{
+}
+
+CDXUTTextureResidency::~CDXUTTextureResidency()
+{
+    Shutdown();
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTTextureResidency::Shutdown()
+{
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+    {
+        CancelLoad( *it );
+        SAFE_RELEASE( (*it)->pSRV );
+        m_Planner.RemoveTexture( (*it)->id );
+        delete *it;
+    }
+    m_Textures.clear();
+    m_bDirty = false;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTTextureResidency::SetBudget( UINT64 budgetBytes )
+{
+    if ( budgetBytes != m_Planner.GetBudget() )
+    {
+        m_Planner.SetBudget( budgetBytes );
+        m_bDirty = true;
+    }
+}
+
+
+_Use_decl_annotations_
+void CDXUTTextureResidency::SetReservedBytes( UINT64 reservedBytes )
+{
+    if ( reservedBytes != m_Planner.GetReservedBytes() )
+    {
+        m_Planner.SetReservedBytes( reservedBytes );
+        m_bDirty = true;
+    }
+}
+
+
+_Use_decl_annotations_
+void CDXUTTextureResidency::SetViewportHeight( float fHeight )
+{
+    if ( fHeight != m_fViewportHeight )
+    {
+        m_fViewportHeight = fHeight;
+        m_bDirty = true;
+    }
+}
+
+
+_Use_decl_annotations_
+void CDXUTTextureResidency::SetLodBias( float fBias )
+{
+    m_Planner.SetLodBias( fBias );
+    m_bDirty = true;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT CDXUTTextureResidency::Request( ID3D11Device* pDevice, LPCWSTR pSrcFile, bool bSRGB, float fCoverage,
+                                        ID3D11ShaderResourceView** ppSRV, ID3D11ShaderResourceView* pOnError,
+                                        DXUT_TEXTURE_PLACEHOLDER placeholder, const void* pOwner )
+{
+    if ( !pDevice || !pSrcFile || !ppSRV || placeholder >= DXUT_PLACEHOLDER_COUNT )
+        return E_INVALIDARG;
+
+    Slot slot;
+    slot.ppSRV = ppSRV;
+    slot.pOwner = pOwner;
+
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+    {
+        ResidentTexture* pTexture = *it;
+        if ( !wcscmp( pTexture->wszSource, pSrcFile ) && pTexture->bSRGB == bSRGB )
+        {
+            if ( fCoverage > pTexture->fCoverage )
+            {
+                pTexture->fCoverage = fCoverage;
+                m_bDirty = true;
+            }
+
+            pTexture->slots.push_back( slot );
+            *ppSRV = pTexture->pSRV ? pTexture->pSRV : pTexture->pOnError;
+            if ( pTexture->pSRV )
+                pTexture->pSRV->AddRef();
+            return S_OK;
+        }
+    }
+
+    WCHAR ext[_MAX_EXT];
+    _wsplitpath_s( pSrcFile, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT );
+    if ( _wcsicmp( ext, L".dds" ) != 0 )
+        return S_FALSE;
+
+    // Only the headers are read here; the async loader reads the mips that are kept
+    MappedFile file;
+    HRESULT hr = file.Open( pSrcFile );
+    if ( FAILED(hr) )
+        return hr;
+
+    DDSTextureDesc desc;
+    hr = ParseDDSHeader( file.data(), file.size(), desc );
+    if ( FAILED(hr) )
+        return hr;
+
+    // Every mip that can be skipped leaves a valid texture behind, which for block
+    // compressed formats means whole blocks
+    std::vector<uint64_t> mipBytes( desc.mipCount, 0 );
+    size_t maxSkip = 0;
+    for( size_t item = 0; item < desc.arraySize; ++item )
+    {
+        for( size_t mip = 0; mip < desc.mipCount; ++mip )
+        {
+            DDSMipLayout layout;
+            hr = GetMipLayout( desc, item, mip, layout );
+            if ( FAILED(hr) )
+                return hr;
+
+            mipBytes[mip] += layout.numBytes;
+
+            if ( item == 0 && mip == maxSkip + 1
+                 && std::max( std::max( layout.width, layout.height ), layout.depth ) >= MIN_SIZE
+                 && !( layout.width % 4 ) && !( layout.height % 4 ) )
+            {
+                maxSkip = mip;
+            }
+        }
+    }
+
+    std::unique_ptr<ResidentTexture> texture( new (std::nothrow) ResidentTexture );
+    if ( !texture )
+        return E_OUTOFMEMORY;
+
+    wcscpy_s( texture->wszSource, MAX_PATH, pSrcFile );
+    texture->bSRGB = bSRGB;
+    texture->placeholder = placeholder;
+    texture->pOnError = pOnError;
+    texture->fCoverage = std::max( fCoverage, 0.0f );
+    texture->loadedMaxSize = 0;
+    texture->pendingMaxSize = 0;
+    texture->pSRV = nullptr;
+    texture->pPending = nullptr;
+    texture->bPending = false;
+    texture->bLoaded = false;
+    texture->bFailed = false;
+
+    const size_t size = std::max( std::max( desc.width, desc.height ), desc.depth );
+    texture->id = m_Planner.AddTexture( static_cast<uint32_t>( size ), static_cast<uint32_t>( desc.mipCount ),
+                                        static_cast<uint32_t>( maxSkip ), mipBytes.data(),
+                                        texture->fCoverage * m_fViewportHeight );
+    if ( texture->id == CDXUTResidencyPlanner::INVALID_TEXTURE )
+        return E_FAIL;
+
+    // The mip bias is picked now, with what is known of the other textures. The ones
+    // requested before may have less room now, which the next Update sees to
+    m_Planner.Plan();
+    m_bDirty = true;
+
+    Load( pDevice, texture.get() );
+
+    // Until the first load completes, the slots share the async loader's placeholder
+    if ( texture->bPending && !texture->pSRV )
+    {
+        texture->pSRV = texture->pPending;
+        texture->pSRV->AddRef();
+    }
+
+    texture->slots.push_back( slot );
+    *ppSRV = texture->pSRV ? texture->pSRV : texture->pOnError;
+    if ( texture->pSRV )
+        texture->pSRV->AddRef();
+
+    m_Textures.push_back( texture.release() );
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTTextureResidency::Load( ID3D11Device* pDevice, ResidentTexture* pTexture )
+{
+    if ( pTexture->bFailed )
+        return;
+
+    const size_t maxsize = m_Planner.GetMaxSize( pTexture->id );
+    if ( pTexture->bPending && pTexture->pendingMaxSize == maxsize )
+        return;
+
+    CancelLoad( pTexture );
+
+    // Back to what is shown
+    if ( pTexture->bLoaded && pTexture->loadedMaxSize == maxsize )
+        return;
+
+    if ( pTexture->bLoaded )
+        ++m_NumReloads;
+
+    pTexture->pendingMaxSize = maxsize;
+    pTexture->bPending = true;
+    if ( FAILED( DXUTGetGlobalAsyncTextureLoader().Request( pDevice, pTexture->wszSource, pTexture->bSRGB, &pTexture->pPending,
+                                                            nullptr, pTexture->placeholder, pTexture, maxsize ) ) )
+    {
+        pTexture->pPending = nullptr;
+    }
+
+    // Cached textures and failures complete right away
+    CompleteLoad( pTexture );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTTextureResidency::CompleteLoad( ResidentTexture* pTexture )
+{
+    if ( !pTexture->bPending )
+        return;
+
+    if ( pTexture->pPending && DXUTGetGlobalAsyncTextureLoader().IsPlaceholder( pTexture->pPending ) )
+        return;
+
+    pTexture->bPending = false;
+
+    // A failed reload keeps what is shown, and a failed first load shows pOnError
+    if ( !pTexture->pPending )
+    {
+        if ( !pTexture->bLoaded )
+        {
+            pTexture->bFailed = true;
+            SetView( pTexture, nullptr );
+        }
+        return;
+    }
+
+    const bool bReload = pTexture->bLoaded;
+    const size_t oldMaxSize = pTexture->loadedMaxSize;
+
+    SetView( pTexture, pTexture->pPending );
+    pTexture->pPending = nullptr;
+    pTexture->loadedMaxSize = pTexture->pendingMaxSize;
+    pTexture->bLoaded = true;
+
+    // Otherwise the cache would keep the old texture, and its memory, alive
+    if ( bReload && oldMaxSize != pTexture->loadedMaxSize )
+    {
+        DXUTGetGlobalResourceCache().RemoveTexture( pTexture->wszSource, pTexture->bSRGB, oldMaxSize );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTTextureResidency::CancelLoad( ResidentTexture* pTexture )
+{
+    if ( !pTexture->bPending )
+        return;
+
+    // The loader's slot keeps the placeholder
+    DXUTCancelAsyncTextureLoads( pTexture );
+    SAFE_RELEASE( pTexture->pPending );
+    pTexture->bPending = false;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTTextureResidency::SetView( ResidentTexture* pTexture, ID3D11ShaderResourceView* pNewSRV )
+{
+    for( auto it = pTexture->slots.begin(); it != pTexture->slots.end(); ++it )
+    {
+        SAFE_RELEASE( *it->ppSRV );
+        *it->ppSRV = pNewSRV ? pNewSRV : pTexture->pOnError;
+        if ( pNewSRV )
+            pNewSRV->AddRef();
+    }
+
+    SAFE_RELEASE( pTexture->pSRV );
+    pTexture->pSRV = pNewSRV;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTTextureResidency::Update( ID3D11Device* pDevice, ID3D11DeviceContext* pContext )
+{
+    if ( !pDevice || !pContext )
+        return;
+
+    bool bPending = false;
+    for( auto it = m_Textures.begin(); it != m_Textures.end() && !bPending; ++it )
+    {
+        bPending = (*it)->bPending;
+    }
+
+    if ( bPending )
+    {
+        DXUTGetGlobalAsyncTextureLoader().ProcessUploads( pDevice, pContext );
+
+        for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+        {
+            CompleteLoad( *it );
+        }
+    }
+
+    if ( !m_bDirty )
+        return;
+
+    m_bDirty = false;
+
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+    {
+        m_Planner.SetScreenSize( (*it)->id, (*it)->fCoverage * m_fViewportHeight );
+    }
+
+    // Every texture is checked, not only those whose plan just changed, because each
+    // request planned the textures before it without reloading them
+    m_Planner.Plan();
+
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+    {
+        Load( pDevice, *it );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTTextureResidency::Cancel( const void* pOwner )
+{
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); )
+    {
+        ResidentTexture* pTexture = *it;
+        auto& slots = pTexture->slots;
+        for( auto slot = slots.begin(); slot != slots.end(); )
+        {
+            if ( slot->pOwner == pOwner )
+                slot = slots.erase( slot );
+            else
+                ++slot;
+        }
+
+        if ( !slots.empty() )
+        {
+            ++it;
+            continue;
+        }
+
+        CancelLoad( pTexture );
+        SAFE_RELEASE( pTexture->pSRV );
+        m_Planner.RemoveTexture( pTexture->id );
+        delete pTexture;
+        it = m_Textures.erase( it );
+
+        // Its memory can go to the others
+        m_bDirty = true;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+UINT CDXUTTextureResidency::GetNumPending( const void* pOwner ) const
+{
+    UINT numPending = 0;
+    for( auto it = m_Textures.begin(); it != m_Textures.end(); ++it )
+    {
+        const ResidentTexture* pTexture = *it;
+        if ( pTexture->bLoaded || pTexture->bFailed )
+            continue;
+
+        bool bOwned = !pOwner;
+        for( auto slot = pTexture->slots.begin(); slot != pTexture->slots.end() && !bOwned; ++slot )
+        {
+            bOwned = ( slot->pOwner == pOwner );
+        }
+
+        if ( bOwned )
+            ++numPending;
+    }
+
+    return numPending;
+}
@@ -0,0 +1,130 @@
+//--------------------------------------------------------------------------------------
+// File: DXUTTextureResidency.h
+//
+// Keeps DDS textures within a memory budget by loading them without some of their top
+// mips. How many mips a texture gives up is decided when it is requested, from how large
+// it will be drawn, by CDXUTResidencyPlanner. The textures are loaded by the async loader
+// with the planned maxsize.
+//
+// When the budget, the memory reserved from it or the viewport size changes, every
+// texture is planned again, and the ones whose plan changed are reloaded in the
+// background. Until a reload is done its texture keeps its old view, so nothing pops to
+// a placeholder. A sample can reserve its render targets from the budget, so switching
+// to a mode with more samples takes memory back from the textures.
+//
+// Requests hand in the slot that holds the view, the way CDXUTAsyncTextureLoader does,
+// and the slots are updated when a reload completes.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=320437
+//--------------------------------------------------------------------------------------
+#pragma once
+
+#include <vector>
+
+#include "DXUTAsyncLoader.h"
+#include "DXUTResidencyPlanner.h"
+
+class CDXUTTextureResidency
+{
+public:
+    CDXUTTextureResidency();
+    ~CDXUTTextureResidency();
+
+    // Changing any of these plans the textures again at the next Update. The global manager
+    // is destroyed with the device, so set them up after creating it
+    void SetBudget( _In_ UINT64 budgetBytes );
+    void SetReservedBytes( _In_ UINT64 reservedBytes );
+    void SetViewportHeight( _In_ float fHeight );
+    void SetLodBias( _In_ float fBias );
+
+    // Queues the texture on the async loader without the top mips the plan leaves out, and
+    // points *ppSRV at a placeholder until it's loaded, with a reference the caller releases.
+    // fCoverage is how large the texture is drawn, as a fraction of the viewport height; 0 if
+    // it isn't known. Returns S_FALSE without touching *ppSRV if the file isn't a DDS file.
+    // Requests for a texture that is already resident share it, and the largest coverage
+    // counts. *ppSRV must stay valid until the request is cancelled
+    HRESULT Request( _In_ ID3D11Device* pDevice, _In_z_ LPCWSTR pSrcFile, _In_ bool bSRGB, _In_ float fCoverage,
+                     _Inout_ ID3D11ShaderResourceView** ppSRV, _In_opt_ ID3D11ShaderResourceView* pOnError,
+                     _In_ DXUT_TEXTURE_PLACEHOLDER placeholder, _In_opt_ const void* pOwner );
+
+    // Once per frame: creates the loaded textures with the async loader's ProcessUploads if
+    // any are pending, hands them to their slots, then reloads the textures whose plan changed
+    void Update( _In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext* pContext );
+
+    // Forgets the requests of pOwner; textures nobody uses any more are released, and their
+    // memory is planned for the others
+    void Cancel( _In_opt_ const void* pOwner );
+
+    // Textures of pOwner, or of all owners if it's null, that haven't been loaded yet. Reloads
+    // of textures that are already shown don't count
+    UINT GetNumPending( _In_opt_ const void* pOwner = nullptr ) const;
+
+    UINT GetNumTextures() const { return static_cast<UINT>( m_Textures.size() ); }
+    UINT GetNumReloads() const { return m_NumReloads; }
+
+    UINT64 GetBudget() const { return m_Planner.GetBudget(); }
+    UINT64 GetReservedBytes() const { return m_Planner.GetReservedBytes(); }
+    UINT64 GetPlannedBytes() const { return m_Planner.GetPlannedBytes(); }
+
+    // Releases every texture, e.g. when the device is destroyed
+    void Shutdown();
+
+private:
+    struct Slot
+    {
+        ID3D11ShaderResourceView**  ppSRV;
+        const void*                 pOwner;
+    };
+
+    struct ResidentTexture
+    {
+        WCHAR                       wszSource[MAX_PATH];
+        bool                        bSRGB;
+        DXUT_TEXTURE_PLACEHOLDER    placeholder;
+        ID3D11ShaderResourceView*   pOnError;
+        uint32_t                    id;             // in the planner
+        float                       fCoverage;
+        size_t                      loadedMaxSize;  // of pSRV
+        size_t                      pendingMaxSize; // of pPending
+        ID3D11ShaderResourceView*   pSRV;           // what the slots hold
+        ID3D11ShaderResourceView*   pPending;       // the async loader's slot
+        bool                        bPending;
+        bool                        bLoaded;
+        bool                        bFailed;
+        std::vector<Slot>           slots;
+    };
+
+    CDXUTTextureResidency( const CDXUTTextureResidency& );
+    CDXUTTextureResidency& operator=( const CDXUTTextureResidency& );
+
+    // Requests the texture with its planned maxsize, unless it's already loaded with it
+    void Load( _In_ ID3D11Device* pDevice, _In_ ResidentTexture* pTexture );
+    // Hands a completed load to the slots
+    void CompleteLoad( _In_ ResidentTexture* pTexture );
+    void CancelLoad( _In_ ResidentTexture* pTexture );
+    static void SetView( _In_ ResidentTexture* pTexture, _In_opt_ ID3D11ShaderResourceView* pNewSRV );
+
+    CDXUTResidencyPlanner               m_Planner;
+    std::vector<ResidentTexture*>       m_Textures;
+    float                               m_fViewportHeight;
+    UINT                                m_NumReloads;
+    bool                                m_bDirty;       // plan again at the next Update
+};
+
+CDXUTTextureResidency& WINAPI DXUTGetGlobalTextureResidency();
+HRESULT WINAPI DXUTDestroyGlobalTextureResidency();
+
+// Whether CDXUTSDKMesh loads its DDS textures through the residency manager. Off by default;
+// it applies to meshes created after it was set, and outlives the global manager
+void WINAPI DXUTSetTextureResidency( _In_ bool bEnabled );
+bool WINAPI DXUTIsTextureResidencyEnabled();
+
+// Safe to call after the global manager was destroyed
+void WINAPI DXUTCancelTextureResidency( _In_opt_ const void* pOwner );
@@ -18,16 +18,56 @@
 #include "DXUT.h"
 #include "SDKMesh.h"
 #include "SDKMisc.h"
+#include "DXUTAsyncLoader.h"
+#include "DXUTMipStreamer.h"
+#include "DXUTTextureResidency.h"
+#include "DXUTTextureArrayPacker.h"
+
+#include <DirectXPackedVector.h>
 
 using namespace DirectX;
 
+//--------------------------------------------------------------------------------------
+// Streams the texture if mip streaming is on and it can be streamed, or loads it within
+// the residency manager's budget if that is on, and otherwise queues it on the async
+// loader. Failures leave ERROR_RESOURCE_VALUE in the slot
+//--------------------------------------------------------------------------------------
+static void RequestTexture( _In_ ID3D11Device* pd3dDevice, _In_z_ const char* strMeshPath, _In_z_ const char* strTexture,
+                            _In_ bool bSRGB, _In_ float fCoverage, _In_ DXUT_TEXTURE_PLACEHOLDER placeholder,
+                            _Inout_ ID3D11ShaderResourceView** ppSRV, _In_ const void* pOwner )
+{
+    auto pError = reinterpret_cast<ID3D11ShaderResourceView*>( ERROR_RESOURCE_VALUE );
+
+    char strPath[MAX_PATH];
+    WCHAR wstrPath[MAX_PATH];
+    sprintf_s( strPath, MAX_PATH, "%s%s", strMeshPath, strTexture );
+    MultiByteToWideChar( CP_ACP, 0, strPath, -1, wstrPath, MAX_PATH );
+
+    if( DXUTIsMipStreamingEnabled() )
+    {
+        HRESULT hr = DXUTGetGlobalMipStreamer().Request( pd3dDevice, wstrPath, bSRGB, ppSRV, pOwner );
+        if( hr == S_OK )
+            return;
+    }
+
+    if( DXUTIsTextureResidencyEnabled() )
+    {
+        HRESULT hr = DXUTGetGlobalTextureResidency().Request( pd3dDevice, wstrPath, bSRGB, fCoverage, ppSRV, pError,
+                                                              placeholder, pOwner );
+        if( hr == S_OK )
+            return;
+    }
+
+    if( FAILED( DXUTGetGlobalAsyncTextureLoader().Request( pd3dDevice, wstrPath, bSRGB, ppSRV, pError,
+                                                           placeholder, pOwner ) ) )
+        *ppSRV = pError;
+}
+
 //--------------------------------------------------------------------------------------
 _Use_decl_annotations_
 void CDXUTSDKMesh::LoadMaterials( ID3D11Device* pd3dDevice, SDKMESH_MATERIAL* pMaterials, UINT numMaterials,
                                   SDKMESH_CALLBACKS11* pLoaderCallbacks )
 {
-    char strPath[MAX_PATH];
-
     if( pLoaderCallbacks && pLoaderCallbacks->pCreateTextureFromFile )
     {
         for( UINT m = 0; m < numMaterials; m++ )
@@ -62,6 +102,14 @@ void CDXUTSDKMesh::LoadMaterials( ID3D11Device* pd3dDevice, SDKMESH_MATERIAL* pM
     }
     else
     {
+        // The textures are loaded on the async loader's workers, or streamed. Until
+        // CheckLoadDone has created them, the materials hold placeholders
+        std::vector<float> coverage( numMaterials, 0.0f );
+        if( DXUTIsTextureResidencyEnabled() && numMaterials > 0 )
+        {
+            GetMaterialCoverage( coverage.data(), numMaterials );
+        }
+
         for( UINT m = 0; m < numMaterials; m++ )
         {
             pMaterials[m].pDiffuseTexture11 = nullptr;
@@ -74,31 +122,124 @@ void CDXUTSDKMesh::LoadMaterials( ID3D11Device* pd3dDevice, SDKMESH_MATERIAL* pM
             // load textures
             if( pMaterials[m].DiffuseTexture[0] != 0 )
             {
-                sprintf_s( strPath, MAX_PATH, "%s%s", m_strPath, pMaterials[m].DiffuseTexture );
-                if( FAILED( DXUTGetGlobalResourceCache().CreateTextureFromFile( pd3dDevice, DXUTGetD3D11DeviceContext(),
-                                                                                strPath, &pMaterials[m].pDiffuseRV11,
-                                                                                true ) ) )
-                    pMaterials[m].pDiffuseRV11 = ( ID3D11ShaderResourceView* )ERROR_RESOURCE_VALUE;
-
+                RequestTexture( pd3dDevice, m_strPath, pMaterials[m].DiffuseTexture, true, coverage[m], DXUT_PLACEHOLDER_GREY,
+                                &pMaterials[m].pDiffuseRV11, this );
             }
             if( pMaterials[m].NormalTexture[0] != 0 )
             {
-                sprintf_s( strPath, MAX_PATH, "%s%s", m_strPath, pMaterials[m].NormalTexture );
-                if( FAILED( DXUTGetGlobalResourceCache().CreateTextureFromFile( pd3dDevice, DXUTGetD3D11DeviceContext(),
-                                                                                strPath,
-                                                                                &pMaterials[m].pNormalRV11 ) ) )
-                    pMaterials[m].pNormalRV11 = ( ID3D11ShaderResourceView* )ERROR_RESOURCE_VALUE;
+                RequestTexture( pd3dDevice, m_strPath, pMaterials[m].NormalTexture, false, coverage[m], DXUT_PLACEHOLDER_FLAT_NORMAL,
+                                &pMaterials[m].pNormalRV11, this );
             }
             if( pMaterials[m].SpecularTexture[0] != 0 )
             {
-                sprintf_s( strPath, MAX_PATH, "%s%s", m_strPath, pMaterials[m].SpecularTexture );
-                if( FAILED( DXUTGetGlobalResourceCache().CreateTextureFromFile( pd3dDevice, DXUTGetD3D11DeviceContext(),
-                                                                                strPath,
-                                                                                &pMaterials[m].pSpecularRV11 ) ) )
-                    pMaterials[m].pSpecularRV11 = ( ID3D11ShaderResourceView* )ERROR_RESOURCE_VALUE;
+                RequestTexture( pd3dDevice, m_strPath, pMaterials[m].SpecularTexture, false, coverage[m], DXUT_PLACEHOLDER_BLACK,
+                                &pMaterials[m].pSpecularRV11, this );
+            }
+        }
+
+        m_bLoading = ( DXUTGetGlobalAsyncTextureLoader().GetNumPending( this ) > 0 );
+        if( DXUTIsTextureResidencyEnabled() )
+        {
+            m_bLoading = m_bLoading || ( DXUTGetGlobalTextureResidency().GetNumPending( this ) > 0 );
+        }
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// How large one repeat of each material's textures is, as a fraction of the size of the
+// whole mesh: the world size of each subset over the texture coordinates it spans. When
+// the mesh fills the viewport, that is the fraction of the viewport the textures are
+// drawn at. Materials no subset uses, or without 2D texture coordinates, get 0
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTSDKMesh::GetMaterialCoverage( float* pCoverage, UINT numMaterials ) const
+{
+    for( UINT m = 0; m < numMaterials; ++m )
+    {
+        pCoverage[m] = 0.0f;
+    }
+
+    XMVECTOR vMeshMin = XMVectorReplicate( FLT_MAX );
+    XMVECTOR vMeshMax = XMVectorReplicate( -FLT_MAX );
+
+    for( UINT i = 0; i < m_pMeshHeader->NumMeshes; ++i )
+    {
+        const SDKMESH_MESH& mesh = m_pMeshArray[i];
+        const SDKMESH_VERTEX_BUFFER_HEADER& vb = m_pVertexBufferArray[ mesh.VertexBuffers[0] ];
+        const BYTE* pVertices = m_ppVertices[ mesh.VertexBuffers[0] ];
+
+        // Positions come first, as for the bounding boxes
+        const D3DVERTEXELEMENT9* pTexCoord = nullptr;
+        for( UINT e = 0; e < MAX_VERTEX_ELEMENTS && vb.Decl[e].Stream != 0xFF; ++e )
+        {
+            if( vb.Decl[e].Usage == D3DDECLUSAGE_TEXCOORD && vb.Decl[e].UsageIndex == 0 && vb.Decl[e].Stream == 0
+                && ( vb.Decl[e].Type == D3DDECLTYPE_FLOAT2 || vb.Decl[e].Type == D3DDECLTYPE_FLOAT16_2 ) )
+            {
+                pTexCoord = &vb.Decl[e];
+                break;
+            }
+        }
+
+        for( UINT iSubset = 0; iSubset < mesh.NumSubsets; ++iSubset )
+        {
+            const SDKMESH_SUBSET& subset = m_pSubsetArray[ mesh.pSubsets[iSubset] ];
+            const UINT64 vertexEnd = std::min( subset.VertexStart + subset.VertexCount, vb.NumVertices );
+
+            XMVECTOR vMin = XMVectorReplicate( FLT_MAX );
+            XMVECTOR vMax = XMVectorReplicate( -FLT_MAX );
+            float uvMin[2] = { FLT_MAX, FLT_MAX };
+            float uvMax[2] = { -FLT_MAX, -FLT_MAX };
+            for( UINT64 v = subset.VertexStart; v < vertexEnd; ++v )
+            {
+                const BYTE* pVertex = pVertices + v * vb.StrideBytes;
+                XMVECTOR vPos = XMLoadFloat3( reinterpret_cast<const XMFLOAT3*>( pVertex ) );
+                vMin = XMVectorMin( vMin, vPos );
+                vMax = XMVectorMax( vMax, vPos );
+
+                if( !pTexCoord )
+                    continue;
+
+                float uv[2];
+                if( pTexCoord->Type == D3DDECLTYPE_FLOAT2 )
+                {
+                    memcpy( uv, pVertex + pTexCoord->Offset, sizeof( uv ) );
+                }
+                else
+                {
+                    PackedVector::HALF half[2];
+                    memcpy( half, pVertex + pTexCoord->Offset, sizeof( half ) );
+                    uv[0] = PackedVector::XMConvertHalfToFloat( half[0] );
+                    uv[1] = PackedVector::XMConvertHalfToFloat( half[1] );
+                }
+
+                for( int c = 0; c < 2; ++c )
+                {
+                    uvMin[c] = std::min( uvMin[c], uv[c] );
+                    uvMax[c] = std::max( uvMax[c], uv[c] );
+                }
             }
+
+            if( subset.VertexStart >= vertexEnd )
+                continue;
+
+            vMeshMin = XMVectorMin( vMeshMin, vMin );
+            vMeshMax = XMVectorMax( vMeshMax, vMax );
+
+            const float fUVRange = std::max( uvMax[0] - uvMin[0], uvMax[1] - uvMin[1] );
+            if( !pTexCoord || subset.MaterialID >= numMaterials || fUVRange <= 1e-4f )
+                continue;
+
+            const float fSize = XMVectorGetX( XMVector3Length( XMVectorSubtract( vMax, vMin ) ) ) / fUVRange;
+            pCoverage[subset.MaterialID] = std::max( pCoverage[subset.MaterialID], fSize );
         }
     }
+
+    const float fMeshSize = XMVectorGetX( XMVector3Length( XMVectorSubtract( vMeshMax, vMeshMin ) ) );
+    for( UINT m = 0; m < numMaterials; ++m )
+    {
+        pCoverage[m] = ( fMeshSize > 0.0f ) ? pCoverage[m] / fMeshSize : 0.0f;
+    }
 }
 
 //--------------------------------------------------------------------------------------
@@ -630,6 +771,15 @@ void CDXUTSDKMesh::RenderMesh( UINT iMesh,
     pd3dDeviceContext->IASetVertexBuffers( 0, pMesh->NumVertexBuffers, pVB, Strides, Offsets );
     pd3dDeviceContext->IASetIndexBuffer( pIB, ibFormat, 0 );
 
+    // Each draw picks its material's slices with its start instance
+    bool bTextureArrays = HasTextureArrays();
+    if( bTextureArrays )
+    {
+        UINT SliceStride = 2 * sizeof( UINT );
+        UINT SliceOffset = 0;
+        pd3dDeviceContext->IASetVertexBuffers( SLICE_STREAM, 1, &m_pSliceBuffer, &SliceStride, &SliceOffset );
+    }
+
     SDKMESH_SUBSET* pSubset = nullptr;
     SDKMESH_MATERIAL* pMat = nullptr;
     D3D11_PRIMITIVE_TOPOLOGY PrimType;
@@ -661,12 +811,40 @@ void CDXUTSDKMesh::RenderMesh( UINT iMesh,
         pd3dDeviceContext->IASetPrimitiveTopology( PrimType );
 
         pMat = &m_pMaterialArray[ pSubset->MaterialID ];
-        if( iDiffuseSlot != INVALID_SAMPLER_SLOT && !IsErrorResource( pMat->pDiffuseRV11 ) )
-            pd3dDeviceContext->PSSetShaderResources( iDiffuseSlot, 1, &pMat->pDiffuseRV11 );
-        if( iNormalSlot != INVALID_SAMPLER_SLOT && !IsErrorResource( pMat->pNormalRV11 ) )
-            pd3dDeviceContext->PSSetShaderResources( iNormalSlot, 1, &pMat->pNormalRV11 );
+        if( bTextureArrays )
+        {
+            const SDKMESH_TEXTURE_ARRAY_REMAP& remap = m_TextureArrayRemap[ pSubset->MaterialID ];
+            if( iDiffuseSlot != INVALID_SAMPLER_SLOT && remap.DiffuseArray != INVALID_TEXTURE_ARRAY && remap.DiffuseArray != m_BoundDiffuseArray )
+            {
+                pd3dDeviceContext->PSSetShaderResources( iDiffuseSlot, 1, &m_TextureArrays[ remap.DiffuseArray ] );
+                m_BoundDiffuseArray = remap.DiffuseArray;
+                m_NumTextureBinds++;
+            }
+            if( iNormalSlot != INVALID_SAMPLER_SLOT && remap.NormalArray != INVALID_TEXTURE_ARRAY && remap.NormalArray != m_BoundNormalArray )
+            {
+                pd3dDeviceContext->PSSetShaderResources( iNormalSlot, 1, &m_TextureArrays[ remap.NormalArray ] );
+                m_BoundNormalArray = remap.NormalArray;
+                m_NumTextureBinds++;
+            }
+        }
+        else
+        {
+            if( iDiffuseSlot != INVALID_SAMPLER_SLOT && !IsErrorResource( pMat->pDiffuseRV11 ) )
+            {
+                pd3dDeviceContext->PSSetShaderResources( iDiffuseSlot, 1, &pMat->pDiffuseRV11 );
+                m_NumTextureBinds++;
+            }
+            if( iNormalSlot != INVALID_SAMPLER_SLOT && !IsErrorResource( pMat->pNormalRV11 ) )
+            {
+                pd3dDeviceContext->PSSetShaderResources( iNormalSlot, 1, &pMat->pNormalRV11 );
+                m_NumTextureBinds++;
+            }
+        }
         if( iSpecularSlot != INVALID_SAMPLER_SLOT && !IsErrorResource( pMat->pSpecularRV11 ) )
+        {
             pd3dDeviceContext->PSSetShaderResources( iSpecularSlot, 1, &pMat->pSpecularRV11 );
+            m_NumTextureBinds++;
+        }
 
         UINT IndexCount = ( UINT )pSubset->IndexCount;
         UINT IndexStart = ( UINT )pSubset->IndexStart;
@@ -677,7 +855,10 @@ void CDXUTSDKMesh::RenderMesh( UINT iMesh,
             IndexStart *= 2;
         }
 
-        pd3dDeviceContext->DrawIndexed( IndexCount, IndexStart, VertexStart );
+        if( bTextureArrays )
+            pd3dDeviceContext->DrawIndexedInstanced( IndexCount, 1, IndexStart, VertexStart, pSubset->MaterialID );
+        else
+            pd3dDeviceContext->DrawIndexed( IndexCount, IndexStart, VertexStart );
     }
 }
 
@@ -730,7 +911,11 @@ CDXUTSDKMesh::CDXUTSDKMesh() : m_NumOutstandingResources( 0 ),
                                m_pBindPoseFrameMatrices( nullptr ),
                                m_pTransformedFrameMatrices( nullptr ),
                                m_pWorldPoseFrameMatrices( nullptr ),
-                               m_pDev11( nullptr )
+                               m_pDev11( nullptr ),
+                               m_pSliceBuffer( nullptr ),
+                               m_NumTextureBinds( 0 ),
+                               m_BoundDiffuseArray( INVALID_TEXTURE_ARRAY ),
+                               m_BoundNormalArray( INVALID_TEXTURE_ARRAY )
 {
 }
 
@@ -821,8 +1006,13 @@ Error:
 //--------------------------------------------------------------------------------------
 void CDXUTSDKMesh::Destroy()
 {
-    if( !CheckLoadDone() )
-        return;
+    // Textures still loading or streaming would be written into the material array
+    DXUTCancelAsyncTextureLoads( this );
+    DXUTCancelMipStreaming( this );
+    DXUTCancelTextureResidency( this );
+    m_bLoading = false;
+
+    ReleaseTextureArrays();
 
     if( m_pStaticMeshData )
     {
@@ -936,6 +1126,9 @@ void CDXUTSDKMesh::Render( ID3D11DeviceContext* pd3dDeviceContext,
                            UINT iNormalSlot,
                            UINT iSpecularSlot )
 {
+    m_NumTextureBinds = 0;
+    m_BoundDiffuseArray = m_BoundNormalArray = INVALID_TEXTURE_ARRAY;
+
     RenderFrame( 0, false, pd3dDeviceContext, iDiffuseSlot, iNormalSlot, iSpecularSlot );
 }
 
@@ -946,6 +1139,9 @@ void CDXUTSDKMesh::RenderAdjacent( ID3D11DeviceContext* pd3dDeviceContext,
                                    UINT iNormalSlot,
                                    UINT iSpecularSlot )
 {
+    m_NumTextureBinds = 0;
+    m_BoundDiffuseArray = m_BoundNormalArray = INVALID_TEXTURE_ARRAY;
+
     RenderFrame( 0, true, pd3dDeviceContext, iDiffuseSlot, iNormalSlot, iSpecularSlot );
 }
 
@@ -1172,35 +1368,248 @@ XMVECTOR CDXUTSDKMesh::GetMeshBBoxExtents( _In_ UINT iMesh ) const
 }
 
 //--------------------------------------------------------------------------------------
-UINT CDXUTSDKMesh::GetOutstandingResources() const
+_Use_decl_annotations_
+void CDXUTSDKMesh::UpdateMipStreaming( FXMVECTOR vEye, CXMMATRIX world, float fProjScaleY, float fViewportHeight ) const
 {
-    UINT outstandingResources = 0;
-    if( !m_pMeshHeader )
-        return 1;
+    if( !m_pMeshHeader || !DXUTIsMipStreamingEnabled() )
+        return;
 
-    outstandingResources += GetOutstandingBufferResources();
+    auto& streamer = DXUTGetGlobalMipStreamer();
+    for( UINT i = 0; i < m_pMeshHeader->NumMeshes; ++i )
+    {
+        XMVECTOR vCenter = XMVector3Transform( GetMeshBBoxCenter( i ), world );
+        float fRadius = XMVectorGetX( XMVector3Length( XMVector3TransformNormal( GetMeshBBoxExtents( i ), world ) ) );
+
+        // From the nearest point of the bounding sphere; inside it, the textures want their finest mips
+        float fDistance = XMVectorGetX( XMVector3Length( XMVectorSubtract( vCenter, vEye ) ) ) - fRadius;
+        float fPixels = CDXUTMipStreamScheduler::ScreenSizeFromDistance( 2.0f * fRadius, fDistance, fProjScaleY, fViewportHeight );
+
+        for( UINT iSubset = 0; iSubset < m_pMeshArray[i].NumSubsets; ++iSubset )
+        {
+            const SDKMESH_SUBSET& subset = m_pSubsetArray[ m_pMeshArray[i].pSubsets[iSubset] ];
+            const SDKMESH_MATERIAL& material = m_pMaterialArray[ subset.MaterialID ];
+
+            streamer.SetScreenSize( material.pDiffuseRV11, fPixels );
+            streamer.SetScreenSize( material.pNormalRV11, fPixels );
+            streamer.SetScreenSize( material.pSpecularRV11, fPixels );
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT CDXUTSDKMesh::CreateTextureArrays( ID3D11DeviceContext* pd3dDeviceContext )
+{
+    ReleaseTextureArrays();
 
-    if( m_pDev11 )
+    if( !m_pDev11 || !m_pMeshHeader || m_bLoading )
+        return E_FAIL;
+
+    // The arrays are copies, so they would miss the mips streamed or reloaded later
+    if( DXUTIsMipStreamingEnabled() || DXUTIsTextureResidencyEnabled() )
+        return E_FAIL;
+
+    const UINT numMaterials = static_cast<UINT>( m_pMeshHeader->NumMaterials );
+
+    // Every texture is added once, in material order, so materials that share a texture
+    // share its slice; the packer's ids are the indices in textures
+    CDXUTTextureArrayPacker packer;
+    std::vector<ID3D11Texture2D*> textures;
+    std::vector<UINT> materialTextures( numMaterials * 2, INVALID_TEXTURE_ARRAY );
+
+    HRESULT hr = S_OK;
+    for( UINT m = 0; m < numMaterials && SUCCEEDED( hr ); ++m )
     {
-        for( UINT i = 0; i < m_pMeshHeader->NumMaterials; i++ )
+        ID3D11ShaderResourceView* pSRVs[2] = { m_pMaterialArray[m].pDiffuseRV11, m_pMaterialArray[m].pNormalRV11 };
+        for( UINT i = 0; i < 2; ++i )
         {
-            if( m_pMaterialArray[i].DiffuseTexture[0] != 0 )
+            if( !pSRVs[i] || IsErrorResource( pSRVs[i] ) )
+                continue;
+
+            ID3D11Resource* pResource = nullptr;
+            pSRVs[i]->GetResource( &pResource );
+            ID3D11Texture2D* pTexture = nullptr;
+            hr = pResource->QueryInterface( __uuidof( ID3D11Texture2D ), ( void** )&pTexture );
+            SAFE_RELEASE( pResource );
+            if( FAILED( hr ) )
+                break;
+
+            auto it = std::find( textures.begin(), textures.end(), pTexture );
+            if( it != textures.end() )
+            {
+                materialTextures[m * 2 + i] = static_cast<UINT>( it - textures.begin() );
+                SAFE_RELEASE( pTexture );
+                continue;
+            }
+
+            D3D11_TEXTURE2D_DESC desc;
+            pTexture->GetDesc( &desc );
+            if( desc.ArraySize != 1 || desc.SampleDesc.Count != 1 || ( desc.MiscFlags & D3D11_RESOURCE_MISC_TEXTURECUBE ) )
             {
-                if( !m_pMaterialArray[i].pDiffuseRV11 && !IsErrorResource( m_pMaterialArray[i].pDiffuseRV11 ) )
-                    outstandingResources ++;
+                SAFE_RELEASE( pTexture );
+                hr = E_FAIL;
+                break;
             }
 
-            if( m_pMaterialArray[i].NormalTexture[0] != 0 )
+            materialTextures[m * 2 + i] = packer.AddTexture( desc.Format, desc.Width, desc.Height, desc.MipLevels );
+            textures.push_back( pTexture );
+        }
+    }
+
+    if( SUCCEEDED( hr ) && textures.empty() )
+        hr = E_FAIL;
+
+    if( SUCCEEDED( hr ) )
+    {
+        packer.Pack();
+
+        for( UINT a = 0; a < packer.GetNumArrays(); ++a )
+        {
+            const CDXUTTextureArrayPacker::TextureArray& array = packer.GetArray( a );
+
+            D3D11_TEXTURE2D_DESC desc;
+            desc.Width = array.width;
+            desc.Height = array.height;
+            desc.MipLevels = array.mipLevels;
+            desc.ArraySize = static_cast<UINT>( array.textures.size() );
+            desc.Format = static_cast<DXGI_FORMAT>( array.format );
+            desc.SampleDesc.Count = 1;
+            desc.SampleDesc.Quality = 0;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+            desc.CPUAccessFlags = 0;
+            desc.MiscFlags = 0;
+
+            ID3D11Texture2D* pArray = nullptr;
+            hr = m_pDev11->CreateTexture2D( &desc, nullptr, &pArray );
+            if( FAILED( hr ) )
+                break;
+
+            for( UINT slice = 0; slice < desc.ArraySize; ++slice )
             {
-                if( !m_pMaterialArray[i].pNormalRV11 && !IsErrorResource( m_pMaterialArray[i].pNormalRV11 ) )
-                    outstandingResources ++;
+                for( UINT mip = 0; mip < desc.MipLevels; ++mip )
+                {
+                    pd3dDeviceContext->CopySubresourceRegion( pArray, D3D11CalcSubresource( mip, slice, desc.MipLevels ), 0, 0, 0,
+                                                              textures[ array.textures[slice] ], mip, nullptr );
+                }
             }
 
-            if( m_pMaterialArray[i].SpecularTexture[0] != 0 )
+            D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc;
+            SRVDesc.Format = desc.Format;
+            SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+            SRVDesc.Texture2DArray.MostDetailedMip = 0;
+            SRVDesc.Texture2DArray.MipLevels = desc.MipLevels;
+            SRVDesc.Texture2DArray.FirstArraySlice = 0;
+            SRVDesc.Texture2DArray.ArraySize = desc.ArraySize;
+
+            ID3D11ShaderResourceView* pSRV = nullptr;
+            hr = m_pDev11->CreateShaderResourceView( pArray, &SRVDesc, &pSRV );
+            SAFE_RELEASE( pArray );
+            if( FAILED( hr ) )
+                break;
+
+            DXUT_SetDebugName( pSRV, "CDXUTSDKMesh" );
+            m_TextureArrays.push_back( pSRV );
+        }
+    }
+
+    for( size_t i = 0; i < textures.size(); ++i )
+    {
+        SAFE_RELEASE( textures[i] );
+    }
+
+    if( SUCCEEDED( hr ) )
+    {
+        // The remap table, and the slices of each material for the shaders
+        char strMsg[MAX_PATH + MAX_MATERIAL_NAME];
+        sprintf_s( strMsg, "%s: %u textures in %u texture arrays\n", m_strPath, packer.GetNumTextures(), packer.GetNumArrays() );
+        OutputDebugStringA( strMsg );
+
+        m_TextureArrayRemap.resize( numMaterials );
+        std::vector<UINT> slices( numMaterials * 2 );
+        for( UINT m = 0; m < numMaterials; ++m )
+        {
+            UINT arrays[2];
+            for( UINT i = 0; i < 2; ++i )
             {
-                if( !m_pMaterialArray[i].pSpecularRV11 && !IsErrorResource( m_pMaterialArray[i].pSpecularRV11 ) )
-                    outstandingResources ++;
+                UINT texture = materialTextures[m * 2 + i];
+                arrays[i] = texture != INVALID_TEXTURE_ARRAY ? packer.GetArrayIndex( texture ) : INVALID_TEXTURE_ARRAY;
+                slices[m * 2 + i] = texture != INVALID_TEXTURE_ARRAY ? packer.GetSlice( texture ) : 0;
             }
+
+            SDKMESH_TEXTURE_ARRAY_REMAP& remap = m_TextureArrayRemap[m];
+            remap.DiffuseArray = arrays[0];
+            remap.DiffuseSlice = slices[m * 2];
+            remap.NormalArray = arrays[1];
+            remap.NormalSlice = slices[m * 2 + 1];
+
+            sprintf_s( strMsg, "  %u %s: diffuse array %d slice %u, normal array %d slice %u\n", m, m_pMaterialArray[m].Name,
+                       static_cast<int>( remap.DiffuseArray ), remap.DiffuseSlice, static_cast<int>( remap.NormalArray ), remap.NormalSlice );
+            OutputDebugStringA( strMsg );
+        }
+
+        D3D11_BUFFER_DESC bufferDesc;
+        bufferDesc.ByteWidth = static_cast<UINT>( slices.size() * sizeof( UINT ) );
+        bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+        bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        bufferDesc.CPUAccessFlags = 0;
+        bufferDesc.MiscFlags = 0;
+
+        D3D11_SUBRESOURCE_DATA InitData;
+        InitData.pSysMem = &slices[0];
+        hr = m_pDev11->CreateBuffer( &bufferDesc, &InitData, &m_pSliceBuffer );
+        if( SUCCEEDED( hr ) )
+        {
+            DXUT_SetDebugName( m_pSliceBuffer, "CDXUTSDKMesh" );
+        }
+    }
+
+    if( FAILED( hr ) )
+    {
+        ReleaseTextureArrays();
+    }
+
+    return hr;
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTSDKMesh::ReleaseTextureArrays()
+{
+    for( size_t i = 0; i < m_TextureArrays.size(); ++i )
+    {
+        SAFE_RELEASE( m_TextureArrays[i] );
+    }
+    m_TextureArrays.clear();
+    m_TextureArrayRemap.clear();
+    SAFE_RELEASE( m_pSliceBuffer );
+}
+
+
+//--------------------------------------------------------------------------------------
+const SDKMESH_TEXTURE_ARRAY_REMAP* CDXUTSDKMesh::GetTextureArrayRemap( _In_ UINT iMaterial ) const
+{
+    if( iMaterial >= m_TextureArrayRemap.size() )
+        return nullptr;
+
+    return &m_TextureArrayRemap[iMaterial];
+}
+
+//--------------------------------------------------------------------------------------
+UINT CDXUTSDKMesh::GetOutstandingResources() const
+{
+    UINT outstandingResources = 0;
+    if( !m_pMeshHeader )
+        return 1;
+
+    outstandingResources += GetOutstandingBufferResources();
+
+    if( m_pDev11 && m_bLoading )
+    {
+        outstandingResources += DXUTGetGlobalAsyncTextureLoader().GetNumPending( this );
+        if( DXUTIsTextureResidencyEnabled() )
+        {
+            outstandingResources += DXUTGetGlobalTextureResidency().GetNumPending( this );
         }
     }
 
@@ -1220,6 +1629,11 @@ UINT CDXUTSDKMesh::GetOutstandingBufferResources() const
 //--------------------------------------------------------------------------------------
 bool CDXUTSDKMesh::CheckLoadDone()
 {
+    if( m_bLoading && m_pDev11 )
+    {
+        DXUTGetGlobalAsyncTextureLoader().ProcessUploads( m_pDev11, DXUTGetD3D11DeviceContext() );
+    }
+
     if( 0 == GetOutstandingResources() )
     {
         m_bLoading = false;
@@ -293,6 +293,20 @@ struct SDKMESH_CALLBACKS11
     void* pContext;
 };
 
+//--------------------------------------------------------------------------------------
+// Where CDXUTSDKMesh::CreateTextureArrays put a material's diffuse and normal textures.
+// The array is INVALID_TEXTURE_ARRAY when the material has no such texture
+//--------------------------------------------------------------------------------------
+#define INVALID_TEXTURE_ARRAY 0xffffffff
+
+struct SDKMESH_TEXTURE_ARRAY_REMAP
+{
+    UINT DiffuseArray;
+    UINT DiffuseSlice;
+    UINT NormalArray;
+    UINT NormalSlice;
+};
+
 //--------------------------------------------------------------------------------------
 // CDXUTSDKMesh class.  This class reads the sdkmesh file format for use by the samples
 //--------------------------------------------------------------------------------------
@@ -308,6 +322,17 @@ private:
     ID3D11Device* m_pDev11;
     ID3D11DeviceContext* m_pDevContext11;
 
+    // Texture arrays made by CreateTextureArrays, the slices of each material, and the
+    // per-instance buffer that hands the slices to the shaders
+    std::vector<ID3D11ShaderResourceView*> m_TextureArrays;
+    std::vector<SDKMESH_TEXTURE_ARRAY_REMAP> m_TextureArrayRemap;
+    ID3D11Buffer* m_pSliceBuffer;
+
+    // Views bound by the last Render, and the arrays bound during it
+    UINT m_NumTextureBinds;
+    UINT m_BoundDiffuseArray;
+    UINT m_BoundNormalArray;
+
 protected:
     //These are the pointers to the two chunks of data loaded in from the mesh file
     BYTE* m_pStaticMeshData;
@@ -343,6 +368,10 @@ protected:
     void LoadMaterials( _In_ ID3D11Device* pd3dDevice, _In_reads_(NumMaterials) SDKMESH_MATERIAL* pMaterials,
                         _In_ UINT NumMaterials, _In_opt_ SDKMESH_CALLBACKS11* pLoaderCallbacks = nullptr );
 
+    // How large each material's textures are drawn, as a fraction of the viewport when the
+    // mesh fills it, for the texture residency manager
+    void GetMaterialCoverage( _Out_writes_(numMaterials) float* pCoverage, _In_ UINT numMaterials ) const;
+
     HRESULT CreateVertexBuffer( _In_ ID3D11Device* pd3dDevice,
                                 _In_ SDKMESH_VERTEX_BUFFER_HEADER* pHeader, _In_reads_(pHeader->SizeBytes) void* pVertices,
                                 _In_opt_ SDKMESH_CALLBACKS11* pLoaderCallbacks = nullptr );
@@ -404,6 +433,29 @@ public:
                                  _In_ UINT iNormalSlot = INVALID_SAMPLER_SLOT,
                                  _In_ UINT iSpecularSlot = INVALID_SAMPLER_SLOT );
 
+    // Vertex buffer slot of the per-instance slices, as R32G32_UINT: diffuse slice, normal slice
+    static const UINT SLICE_STREAM = D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT - 1;
+
+    // Copies the materials' diffuse and normal textures into texture arrays, one per format,
+    // size and mip count, so that Render only binds views when the array changes rather than
+    // for every subset. Each draw then gets its material's slices in SLICE_STREAM, and the
+    // shaders must sample Texture2DArrays. Writes the remap table to the debug output.
+    // Call once the textures are loaded; fails, leaving the mesh on its own views, if a
+    // texture can't go in an array or if textures may still be streamed or reloaded
+    HRESULT CreateTextureArrays( _In_ ID3D11DeviceContext* pd3dDeviceContext );
+    void ReleaseTextureArrays();
+    bool HasTextureArrays() const { return !m_TextureArrays.empty(); }
+    UINT GetNumTextureArrays() const { return static_cast<UINT>( m_TextureArrays.size() ); }
+    const SDKMESH_TEXTURE_ARRAY_REMAP* GetTextureArrayRemap( _In_ UINT iMaterial ) const;
+
+    // Shader resource views bound by the last Render or RenderAdjacent
+    UINT GetNumTextureBinds() const { return m_NumTextureBinds; }
+
+    // Reports how large each material's streamed textures are on screen, from the distance of
+    // each mesh's bounds to the eye. Call every frame, before the mip streamer's Update
+    void UpdateMipStreaming( _In_ DirectX::FXMVECTOR vEye, _In_ DirectX::CXMMATRIX world,
+                             _In_ float fProjScaleY, _In_ float fViewportHeight ) const;
+
     //Helpers (D3D11 specific)
     static D3D11_PRIMITIVE_TOPOLOGY GetPrimitiveType11( _In_ SDKMESH_PRIMITIVE_TYPE PrimType );
     DXGI_FORMAT GetIBFormat11( _In_ UINT iMesh ) const;
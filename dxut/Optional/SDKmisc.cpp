@@ -17,10 +17,15 @@
 #include "DXUTres.h"
 
 #include "DXUTGui.h"
+#include "DXUTAsyncLoader.h"
+#include "DXUTMipStreamer.h"
+#include "DXUTTextureResidency.h"
 
 #include "DDSTextureLoader.h"
 #include "WICTextureLoader.h"
 #include "ScreenGrab.h"
+#include "BCEncode.h"
+#include "MipGen.h"
 
 using namespace DirectX;
 
@@ -810,15 +815,125 @@ XMMATRIX WINAPI DXUTGetCubeMapViewMatrix( _In_ DWORD dwFace )
 // CDXUTResourceCache
 //======================================================================================
 
+//--------------------------------------------------------------------------------------
+// Full path, lower case, with backslashes, so every spelling of a file gives the same key
+//--------------------------------------------------------------------------------------
+static DXUTCache_TextureKey GetTextureKey( _In_z_ LPCWSTR pSrcFile, _In_ bool bSRGB, _In_ size_t maxsize = 0 )
+{
+    DXUTCache_TextureKey key;
+    key.bSRGB = bSRGB;
+    key.nMaxSize = maxsize;
+
+    WCHAR szFullPath[MAX_PATH];
+    DWORD len = GetFullPathNameW( pSrcFile, MAX_PATH, szFullPath, nullptr );
+    if ( len > 0 && len < MAX_PATH )
+        key.strPath.assign( szFullPath, len );
+    else
+        key.strPath = pSrcFile;
+
+    if ( !key.strPath.empty() )
+    {
+        std::replace( key.strPath.begin(), key.strPath.end(), L'/', L'\\' );
+        CharLowerBuffW( &key.strPath[0], static_cast<DWORD>( key.strPath.size() ) );
+    }
+
+    return key;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Size of the resource behind a view, with every mip, array item and slice
+//--------------------------------------------------------------------------------------
+static size_t GetTextureBytes( _In_ ID3D11ShaderResourceView* pSRV )
+{
+    ID3D11Resource* pResource = nullptr;
+    pSRV->GetResource( &pResource );
+    if ( !pResource )
+        return 0;
+
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    size_t width = 1, height = 1, depth = 1, mipLevels = 1, arraySize = 1;
+
+    D3D11_RESOURCE_DIMENSION dimension;
+    pResource->GetType( &dimension );
+    switch( dimension )
+    {
+    case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
+        {
+            D3D11_TEXTURE1D_DESC desc;
+            static_cast<ID3D11Texture1D*>( pResource )->GetDesc( &desc );
+            format = desc.Format;
+            width = desc.Width;
+            mipLevels = desc.MipLevels;
+            arraySize = desc.ArraySize;
+        }
+        break;
+
+    case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
+        {
+            D3D11_TEXTURE2D_DESC desc;
+            static_cast<ID3D11Texture2D*>( pResource )->GetDesc( &desc );
+            format = desc.Format;
+            width = desc.Width;
+            height = desc.Height;
+            mipLevels = desc.MipLevels;
+            arraySize = desc.ArraySize;
+        }
+        break;
+
+    case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
+        {
+            D3D11_TEXTURE3D_DESC desc;
+            static_cast<ID3D11Texture3D*>( pResource )->GetDesc( &desc );
+            format = desc.Format;
+            width = desc.Width;
+            height = desc.Height;
+            depth = desc.Depth;
+            mipLevels = desc.MipLevels;
+        }
+        break;
+
+    case D3D11_RESOURCE_DIMENSION_BUFFER:
+        {
+            D3D11_BUFFER_DESC desc;
+            static_cast<ID3D11Buffer*>( pResource )->GetDesc( &desc );
+            SAFE_RELEASE( pResource );
+            return desc.ByteWidth;
+        }
+
+    default:
+        break;
+    }
+
+    SAFE_RELEASE( pResource );
+
+    size_t nBytes = 0;
+    for( size_t mip = 0; mip < mipLevels; ++mip )
+    {
+        size_t mipBytes = 0;
+        if ( FAILED( DirectX::GetSurfaceInfo( width, height, format, &mipBytes, nullptr, nullptr ) ) )
+            return 0;
+        nBytes += mipBytes * depth;
+
+        width = std::max<size_t>( width / 2, 1 );
+        height = std::max<size_t>( height / 2, 1 );
+        depth = std::max<size_t>( depth / 2, 1 );
+    }
+
+    return nBytes * arraySize;
+}
+
+
+//--------------------------------------------------------------------------------------
 CDXUTResourceCache::~CDXUTResourceCache()
 {
     // Release all resources
-    for( size_t j = 0; j < m_TextureCache.size(); ++j )
+    for( auto it = m_TextureCache.begin(); it != m_TextureCache.end(); ++it )
     {
-        SAFE_RELEASE( m_TextureCache[ j ].pSRV11 );
+        SAFE_RELEASE( it->second.pSRV11 );
     }
     m_TextureCache.clear();
-    m_TextureCache.shrink_to_fit();
+    m_TextureLRU.clear();
 }
 
 //--------------------------------------------------------------------------------------
@@ -829,19 +944,8 @@ HRESULT CDXUTResourceCache::CreateTextureFromFile( ID3D11Device* pDevice, ID3D11
     if ( !ppOutputRV )
         return E_INVALIDARG;
 
-    *ppOutputRV = nullptr;
-
-    for( auto it = m_TextureCache.cbegin(); it != m_TextureCache.cend(); ++it )
-    {
-        if( !wcscmp( it->wszSource, pSrcFile )
-            && it->bSRGB == bSRGB
-            && it->pSRV11 )
-        {
-            it->pSRV11->AddRef();
-            *ppOutputRV = it->pSRV11;
-            return S_OK;
-        }
-    }
+    if ( FindTexture( pSrcFile, bSRGB, ppOutputRV ) )
+        return S_OK;
 
     WCHAR ext[_MAX_EXT];
     _wsplitpath_s( pSrcFile, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT );
@@ -853,24 +957,280 @@ HRESULT CDXUTResourceCache::CreateTextureFromFile( ID3D11Device* pDevice, ID3D11
                                                   D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0, bSRGB,
                                                   nullptr, ppOutputRV, nullptr );
     }
+    else if ( m_bCompressWIC && SUCCEEDED( CreateCompressedWICTexture( pDevice, pSrcFile, bSRGB, ppOutputRV ) ) )
+    {
+        hr = S_OK;
+    }
     else
     {
-        hr = DirectX::CreateWICTextureFromFileEx( pDevice, pContext, pSrcFile, 0,
-                                                  D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0, bSRGB,
-                                                  nullptr, ppOutputRV );
+        hr = DirectX::CreateWICTextureWithMipsFromFile( pDevice, pContext, pSrcFile, 0,
+                                                        D3D11_USAGE_IMMUTABLE, D3D11_BIND_SHADER_RESOURCE, 0, 0, bSRGB,
+                                                        m_nMipFlags, nullptr, ppOutputRV );
+    }
+
+    if ( FAILED(hr) )
+        return hr;
+
+    AddTexture( pSrcFile, bSRGB, *ppOutputRV );
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTResourceCache::SetWICCompression( bool bCompress, unsigned int encodeFlags, bool bCacheToDisk )
+{
+    m_bCompressWIC = bCompress;
+    m_nCompressFlags = encodeFlags;
+    m_bCacheCompressed = bCacheToDisk;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTResourceCache::SetWICMipFilter( unsigned int mipFlags )
+{
+    m_nMipFlags = mipFlags;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Decodes an image through WIC, block compresses it on the CPU and creates an immutable
+// texture from it, or loads the .DDS file an earlier call left next to the image
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT CDXUTResourceCache::CreateCompressedWICTexture( ID3D11Device* pDevice, LPCWSTR pSrcFile, bool bSRGB,
+                                                        ID3D11ShaderResourceView** ppOutputRV )
+{
+    *ppOutputRV = nullptr;
+
+    // The encoding and filter settings are in the name, so changing them doesn't pick up a
+    // stale file
+    WCHAR szCacheFile[MAX_PATH];
+    if ( swprintf_s( szCacheFile, MAX_PATH, L"%s.bc%u%s.mip%x.dds", pSrcFile, m_nCompressFlags & BC_ENCODE_QUALITY_MASK, bSRGB ? L"s" : L"",
+                     m_nMipFlags & ~MIPGEN_REFERENCE ) < 0 )
+        return E_FAIL;
+
+    if ( m_bCacheCompressed )
+    {
+        WIN32_FILE_ATTRIBUTE_DATA srcInfo, cacheInfo;
+        if ( GetFileAttributesExW( pSrcFile, GetFileExInfoStandard, &srcInfo )
+             && GetFileAttributesExW( szCacheFile, GetFileExInfoStandard, &cacheInfo )
+             && CompareFileTime( &cacheInfo.ftLastWriteTime, &srcInfo.ftLastWriteTime ) >= 0 )
+        {
+            if ( SUCCEEDED( DirectX::CreateDDSTextureFromFileEx( pDevice, szCacheFile, 0,
+                                                                 D3D11_USAGE_IMMUTABLE, D3D11_BIND_SHADER_RESOURCE, 0, 0, bSRGB,
+                                                                 nullptr, ppOutputRV, nullptr ) ) )
+                return S_OK;
+        }
+    }
+
+    std::unique_ptr<uint8_t[]> pixels;
+    size_t width, height;
+    DXGI_FORMAT srcFormat;
+    HRESULT hr = DirectX::LoadWICTextureFromFile( pSrcFile, 0, bSRGB, pixels, width, height, srcFormat );
+    if ( FAILED(hr) )
+        return hr;
+
+    // The top mip of a block compressed texture has to be a whole number of blocks
+    if ( ( width % 4 ) || ( height % 4 ) )
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+
+    MipChain mips;
+    hr = GenerateMipChain( srcFormat, width, height, pixels.get(), width * 4, 0, 0, m_nMipFlags, mips );
+    if ( FAILED(hr) )
+        return hr;
+    pixels.reset();
+
+    bool bOpaque = true;
+    for( size_t i = 3; i < width * height * 4 && bOpaque; i += 4 )
+    {
+        bOpaque = ( mips.bits[i] == 255 );
+    }
+
+    DXGI_FORMAT format;
+    if ( ( m_nCompressFlags & BC_ENCODE_QUALITY_MASK ) == BC_ENCODE_HIGH )
+    {
+        format = DXGI_FORMAT_BC7_UNORM;
+    }
+    else
+    {
+        format = bOpaque ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
     }
 
+    EncodedTexture encoded;
+    hr = EncodeBCTexture( format, srcFormat, width, height, mips.mipCount, 1, mips.mips.get(), 0, m_nCompressFlags, encoded );
     if ( FAILED(hr) )
         return hr;
 
+    for( size_t mip = 0; mip < mips.mipCount; ++mip )
+    {
+        const DDSMipLayout& layout = encoded.mips[mip];
+        mips.mips[mip].pSysMem = encoded.bits.get() + layout.offset;
+        mips.mips[mip].SysMemPitch = static_cast<UINT>( layout.rowBytes );
+        mips.mips[mip].SysMemSlicePitch = static_cast<UINT>( layout.numBytes );
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    desc.Width = static_cast<UINT>( width );
+    desc.Height = static_cast<UINT>( height );
+    desc.MipLevels = static_cast<UINT>( mips.mipCount );
+    desc.ArraySize = 1;
+    desc.Format = encoded.format;
+    desc.SampleDesc.Count = 1;
+    desc.SampleDesc.Quality = 0;
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = 0;
+    desc.MiscFlags = 0;
+
+    ID3D11Texture2D* pTexture = nullptr;
+    hr = pDevice->CreateTexture2D( &desc, mips.mips.get(), &pTexture );
+    if ( FAILED(hr) )
+        return hr;
+
+    hr = pDevice->CreateShaderResourceView( pTexture, nullptr, ppOutputRV );
+    SAFE_RELEASE( pTexture );
+    if ( FAILED(hr) )
+        return hr;
+
+    DXUT_SetDebugName( *ppOutputRV, "CDXUTResourceCache" );
+
+    // Media folders can be read only, so not being able to cache isn't an error
+    if ( m_bCacheCompressed )
+    {
+        (void)SaveDDSTextureToFile( encoded.format, width, height, mips.mipCount, 1, mips.mips.get(), szCacheFile );
+    }
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+bool CDXUTResourceCache::FindTexture( LPCWSTR pSrcFile, bool bSRGB, ID3D11ShaderResourceView** ppOutputRV, size_t maxsize )
+{
+    *ppOutputRV = nullptr;
+
+    auto it = m_TextureCache.find( GetTextureKey( pSrcFile, bSRGB, maxsize ) );
+    if ( it == m_TextureCache.end() || !it->second.pSRV11 )
+    {
+        ++m_nMisses;
+        return false;
+    }
+
+    ++m_nHits;
+
+    // Most recently used goes to the front
+    m_TextureLRU.splice( m_TextureLRU.begin(), m_TextureLRU, it->second.itLRU );
+
+    it->second.pSRV11->AddRef();
+    *ppOutputRV = it->second.pSRV11;
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTResourceCache::AddTexture( LPCWSTR pSrcFile, bool bSRGB, ID3D11ShaderResourceView* pSRV, size_t maxsize )
+{
+    if ( !pSRV )
+        return;
+
+    DXUTCache_TextureKey key = GetTextureKey( pSrcFile, bSRGB, maxsize );
+    if ( m_TextureCache.find( key ) != m_TextureCache.end() )
+        return;
+
     DXUTCache_Texture entry;
-    wcscpy_s( entry.wszSource, MAX_PATH, pSrcFile );
-    entry.bSRGB = bSRGB;
-    entry.pSRV11 = *ppOutputRV;
+    entry.pSRV11 = pSRV;
     entry.pSRV11->AddRef();
-    m_TextureCache.push_back( entry );
+    entry.nBytes = GetTextureBytes( pSRV );
 
-    return S_OK;
+    m_TextureLRU.push_front( key );
+    entry.itLRU = m_TextureLRU.begin();
+    m_TextureCache.insert( std::make_pair( key, entry ) );
+    m_nTextureBytes += entry.nBytes;
+
+    if ( m_nTextureBudget > 0 && m_nTextureBytes > m_nTextureBudget )
+        EvictTextures( m_nTextureBudget );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTResourceCache::RemoveTexture( LPCWSTR pSrcFile, bool bSRGB, size_t maxsize )
+{
+    auto it = m_TextureCache.find( GetTextureKey( pSrcFile, bSRGB, maxsize ) );
+    if ( it == m_TextureCache.end() )
+        return;
+
+    SAFE_RELEASE( it->second.pSRV11 );
+    m_nTextureBytes -= it->second.nBytes;
+
+    m_TextureLRU.erase( it->second.itLRU );
+    m_TextureCache.erase( it );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTResourceCache::SetTextureBudget( size_t nBytes )
+{
+    m_nTextureBudget = nBytes;
+
+    if ( m_nTextureBudget > 0 && m_nTextureBytes > m_nTextureBudget )
+        EvictTextures( m_nTextureBudget );
+}
+
+
+//--------------------------------------------------------------------------------------
+void CDXUTResourceCache::EvictUnusedTextures()
+{
+    EvictTextures( 0 );
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void CDXUTResourceCache::EvictTextures( size_t nBytes )
+{
+    auto itLRU = m_TextureLRU.end();
+    while( m_nTextureBytes > nBytes && itLRU != m_TextureLRU.begin() )
+    {
+        --itLRU;
+
+        auto it = m_TextureCache.find( *itLRU );
+        assert( it != m_TextureCache.end() );
+
+        // Only the cache's reference would be left after this Release
+        ID3D11ShaderResourceView* pSRV = it->second.pSRV11;
+        ULONG refs = pSRV->AddRef();
+        pSRV->Release();
+        if ( refs > 2 )
+            continue;
+
+        SAFE_RELEASE( it->second.pSRV11 );
+        m_nTextureBytes -= it->second.nBytes;
+        ++m_nEvictions;
+
+        m_TextureCache.erase( it );
+        itLRU = m_TextureLRU.erase( itLRU );
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+DXUTCacheStats CDXUTResourceCache::GetStats() const
+{
+    DXUTCacheStats stats;
+    stats.nHits = m_nHits;
+    stats.nMisses = m_nMisses;
+    stats.nEvictions = m_nEvictions;
+    stats.nTextures = m_TextureCache.size();
+    stats.nBytes = m_nTextureBytes;
+    stats.nBudget = m_nTextureBudget;
+    return stats;
 }
 
 
@@ -895,6 +1255,12 @@ HRESULT CDXUTResourceCache::CreateTextureFromFile( ID3D11Device* pDevice, ID3D11
 //--------------------------------------------------------------------------------------
 HRESULT CDXUTResourceCache::OnDestroyDevice()
 {
+    // The async loader adds to the cache, and both hold views of this device. The residency
+    // manager loads through the async loader, so it goes first
+    DXUTDestroyGlobalTextureResidency();
+    DXUTDestroyGlobalAsyncTextureLoader();
+    DXUTDestroyGlobalMipStreamer();
+
     SAFE_DELETE( s_dxut_sdk_misc_global_resource_cache );
 
     return S_OK;
@@ -14,23 +14,55 @@
 //--------------------------------------------------------------------------------------
 #pragma once
 
+#include <list>
+#include <string>
+#include <unordered_map>
+
 //-----------------------------------------------------------------------------
 // Resource cache for textures, fonts, meshs, and effects.  
 // Use DXUTGetGlobalResourceCache() to access the global cache
 //-----------------------------------------------------------------------------
 
+// Textures are keyed on their full, lower case path with backslashes, so different
+// spellings of the same file share an entry. Loads of the same file with a different
+// maxsize (the top mips that were skipped) are separate entries
+struct DXUTCache_TextureKey
+{
+    std::wstring    strPath;
+    bool            bSRGB;
+    size_t          nMaxSize;
+
+    bool operator==( const DXUTCache_TextureKey& other ) const { return bSRGB == other.bSRGB && nMaxSize == other.nMaxSize && strPath == other.strPath; }
+};
+
+struct DXUTCache_TextureKeyHash
+{
+    size_t operator()( const DXUTCache_TextureKey& key ) const { return std::hash<std::wstring>()( key.strPath ) ^ static_cast<size_t>( key.bSRGB ) ^ ( key.nMaxSize << 1 ); }
+};
+
 struct DXUTCache_Texture
 {
-    WCHAR   wszSource[MAX_PATH];
-    bool    bSRGB;
     ID3D11ShaderResourceView* pSRV11;
+    size_t  nBytes;         // of the whole resource, every mip and array item
+    std::list<DXUTCache_TextureKey>::iterator itLRU;
 
     DXUTCache_Texture() :
-        pSRV11(nullptr)
+        pSRV11(nullptr),
+        nBytes(0)
     {
     }
 };
 
+struct DXUTCacheStats
+{
+    UINT64  nHits;
+    UINT64  nMisses;
+    UINT64  nEvictions;
+    size_t  nTextures;
+    size_t  nBytes;
+    size_t  nBudget;        // 0 if there is none
+};
+
 
 class CDXUTResourceCache
 {
@@ -41,6 +73,36 @@ public:
                                    _Outptr_ ID3D11ShaderResourceView** ppOutputRV, _In_ bool bSRGB=false );
     HRESULT CreateTextureFromFile( _In_ ID3D11Device* pDevice, _In_ ID3D11DeviceContext *pContext, _In_z_ LPCSTR pSrcFile,
                                    _Outptr_ ID3D11ShaderResourceView** ppOutputRV, _In_ bool bSRGB=false );
+
+    // Returns an AddRef'd view of a texture already in the cache, or false. Counts a hit or a miss.
+    // maxsize is the one the texture was loaded with, 0 for all its mips
+    bool FindTexture( _In_z_ LPCWSTR pSrcFile, _In_ bool bSRGB, _Outptr_result_maybenull_ ID3D11ShaderResourceView** ppOutputRV,
+                      _In_ size_t maxsize = 0 );
+    // Adds a texture created elsewhere, e.g. by the async loader. The cache takes its own reference.
+    // If the file is already cached, the cached texture is kept
+    void AddTexture( _In_z_ LPCWSTR pSrcFile, _In_ bool bSRGB, _In_ ID3D11ShaderResourceView* pSRV, _In_ size_t maxsize = 0 );
+    // Drops the cache's reference to a texture, e.g. once it was reloaded with another maxsize.
+    // It is released when its other users release it
+    void RemoveTexture( _In_z_ LPCWSTR pSrcFile, _In_ bool bSRGB, _In_ size_t maxsize = 0 );
+
+    // Once the cached textures add up to more than nBytes, the least recently used ones that
+    // only the cache still references are released until they fit again. 0 (the default) for
+    // no budget
+    void SetTextureBudget( _In_ size_t nBytes );
+    // Releases every texture only the cache still references
+    void EvictUnusedTextures();
+    DXUTCacheStats GetStats() const;
+
+    // Images CreateTextureFromFile loads through WIC get their mips filtered on the CPU and
+    // are created immutable. mipFlags are the MIPGEN_FLAGS of MipGen.h; the default is a box
+    // filter in linear space for sRGB images
+    void SetWICMipFilter( _In_ unsigned int mipFlags );
+
+    // Block compresses the images CreateTextureFromFile loads through WIC, mips and all:
+    // BC1 if they're opaque and BC3 if not, or BC7 with BC_ENCODE_HIGH in encodeFlags.
+    // bCacheToDisk writes the result next to the image as a .DDS file, which is loaded instead
+    // for as long as it's newer than the image. Off by default
+    void SetWICCompression( _In_ bool bCompress, _In_ unsigned int encodeFlags, _In_ bool bCacheToDisk );
 public:
     static HRESULT OnDestroyDevice();
 
@@ -50,9 +112,37 @@ protected:
     friend HRESULT WINAPI   DXUTReset3DEnvironment();
     friend void WINAPI      DXUTCleanup3DEnvironment( bool bReleaseSettings );
 
-    CDXUTResourceCache() { }
+    CDXUTResourceCache() :
+        m_nTextureBytes( 0 ),
+        m_nTextureBudget( 0 ),
+        m_nHits( 0 ),
+        m_nMisses( 0 ),
+        m_nEvictions( 0 ),
+        m_nMipFlags( 0 ),
+        m_bCompressWIC( false ),
+        m_nCompressFlags( 0 ),
+        m_bCacheCompressed( false )
+    {
+    }
 
-    std::vector<DXUTCache_Texture> m_TextureCache;
+    HRESULT CreateCompressedWICTexture( _In_ ID3D11Device* pDevice, _In_z_ LPCWSTR pSrcFile, _In_ bool bSRGB,
+                                        _Outptr_ ID3D11ShaderResourceView** ppOutputRV );
+
+    // Evicts unreferenced textures, least recently used first, until the cache is down to nBytes
+    void EvictTextures( _In_ size_t nBytes );
+
+    typedef std::unordered_map<DXUTCache_TextureKey, DXUTCache_Texture, DXUTCache_TextureKeyHash> TextureMap;
+    TextureMap m_TextureCache;
+    std::list<DXUTCache_TextureKey> m_TextureLRU;   // most recently used first
+    size_t m_nTextureBytes;
+    size_t m_nTextureBudget;
+    UINT64 m_nHits;
+    UINT64 m_nMisses;
+    UINT64 m_nEvictions;
+    unsigned int m_nMipFlags;
+    bool m_bCompressWIC;
+    unsigned int m_nCompressFlags;
+    bool m_bCacheCompressed;
 };
    
 CDXUTResourceCache& WINAPI DXUTGetGlobalResourceCache();
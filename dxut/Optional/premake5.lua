@@ -28,6 +28,10 @@ project "DXUTOpt"
    files { "*.h", "*.cpp" }
    includedirs { "../Core" }
 
+   -- DXUTMipScheduler.cpp, DXUTResidencyPlanner.cpp and DXUTTextureArrayPacker.cpp don't include DXUT.h, so they can also be built headless
+   filter "files:DXUTMipScheduler.cpp or DXUTResidencyPlanner.cpp or DXUTTextureArrayPacker.cpp"
+      flags { "NoPCH" }
+
    filter "configurations:Debug"
       defines { "WIN32", "_DEBUG", "DEBUG", "PROFILE", "_WINDOWS", "_LIB", "_WIN32_WINNT=0x0601" }
       flags { "Symbols", "FatalWarnings", "Unicode" }
@@ -0,0 +1,36 @@
+-- BCDecodeBench: command line tool that measures the software BC decoder, BC encoder and mip generator in
+-- DXUT, checks the decoder against a golden set decoded by Pillow, and checks their SSE2 code against the reference code.
+-- It doesn't need a device, only the Windows SDK headers for the DXGI formats.
+
+workspace "BCDecodeBench"
+   configurations { "Debug", "Release" }
+   platforms { "x64" }
+   location "../build"
+   startproject "BCDecodeBench"
+
+   filter "platforms:x64"
+      architecture "x64"
+
+project "BCDecodeBench"
+   kind "ConsoleApp"
+   language "C++"
+   location "../build"
+   targetdir "../bin"
+   objdir "../build/BCDecodeBench/%{cfg.platform}/%{cfg.buildcfg}"
+   warnings "Extra"
+
+   files { "../tools/BCDecodeBench.cpp", "../tools/BCDecodeGolden.h", "../../dxut/Core/BCCommon.*", "../../dxut/Core/BCDecode.*", "../../dxut/Core/BCEncode.*", "../../dxut/Core/DDSFile.*", "../../dxut/Core/DDSZFile.*", "../../dxut/Core/LZ4Block.*", "../../dxut/Core/MipGen.*" }
+   includedirs { "../../dxut/Core" }
+
+   filter "system:windows"
+      flags { "FatalWarnings" }
+
+   filter "configurations:Debug"
+      defines { "_DEBUG", "DEBUG" }
+      flags { "Symbols" }
+      targetsuffix "_Debug"
+
+   filter "configurations:Release"
+      defines { "NDEBUG" }
+      flags { "Symbols" }
+      optimize "On"
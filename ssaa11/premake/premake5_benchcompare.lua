@@ -0,0 +1,35 @@
+-- BenchCompare: command line tool that compares two SSAA11 benchmark runs.
+-- It has no graphics dependencies, so it can also be generated for Linux CI machines,
+-- e.g. premake5 --file=premake5_benchcompare.lua gmake2
+
+workspace "BenchCompare"
+   configurations { "Debug", "Release" }
+   platforms { "x64" }
+   location "../build"
+   startproject "BenchCompare"
+
+   filter "platforms:x64"
+      architecture "x64"
+
+project "BenchCompare"
+   kind "ConsoleApp"
+   language "C++"
+   location "../build"
+   targetdir "../bin"
+   objdir "../build/BenchCompare/%{cfg.platform}/%{cfg.buildcfg}"
+   warnings "Extra"
+
+   files { "../tools/BenchCompare.cpp" }
+
+   filter "system:windows"
+      flags { "FatalWarnings" }
+
+   filter "configurations:Debug"
+      defines { "_DEBUG", "DEBUG" }
+      flags { "Symbols" }
+      targetsuffix "_Debug"
+
+   filter "configurations:Release"
+      defines { "NDEBUG" }
+      flags { "Symbols" }
+      optimize "On"
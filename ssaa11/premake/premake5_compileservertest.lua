@@ -0,0 +1,34 @@
+-- CompileServerTest: command line tool that drives the shader compile server in AMD_SDK over its named
+-- pipe with the mock compiler, and checks the bytecode it returns and that identical requests compile once.
+-- It doesn't need a device, but the server uses Win32 named pipes, so it's Windows only.
+
+workspace "CompileServerTest"
+   configurations { "Debug", "Release" }
+   platforms { "x64" }
+   location "../build"
+   startproject "CompileServerTest"
+
+   filter "platforms:x64"
+      architecture "x64"
+
+project "CompileServerTest"
+   kind "ConsoleApp"
+   language "C++"
+   location "../build"
+   targetdir "../bin"
+   objdir "../build/CompileServerTest/%{cfg.platform}/%{cfg.buildcfg}"
+   warnings "Extra"
+
+   files { "../tools/CompileServerTest.cpp", "../../amd_sdk/src/ShaderCompileServer.*" }
+   includedirs { "../../dxut/Core", "../../amd_sdk/src" }
+   flags { "FatalWarnings", "Unicode" }
+
+   filter "configurations:Debug"
+      defines { "_DEBUG", "DEBUG" }
+      flags { "Symbols" }
+      targetsuffix "_Debug"
+
+   filter "configurations:Release"
+      defines { "NDEBUG" }
+      flags { "Symbols" }
+      optimize "On"
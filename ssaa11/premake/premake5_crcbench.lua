@@ -0,0 +1,37 @@
+-- CrcBench: command line tool that measures the throughput of each CRC-32 implementation in AMD_SDK and
+-- checks that they agree.
+-- It has no graphics dependencies, so it can also be generated for Linux CI machines,
+-- e.g. premake5 --file=premake5_crcbench.lua gmake2
+
+workspace "CrcBench"
+   configurations { "Debug", "Release" }
+   platforms { "x64" }
+   location "../build"
+   startproject "CrcBench"
+
+   filter "platforms:x64"
+      architecture "x64"
+
+project "CrcBench"
+   kind "ConsoleApp"
+   language "C++"
+   location "../build"
+   targetdir "../bin"
+   objdir "../build/CrcBench/%{cfg.platform}/%{cfg.buildcfg}"
+   warnings "Extra"
+
+   files { "../tools/CrcBench.cpp", "../../amd_sdk/src/crc.*" }
+   includedirs { "../../amd_sdk/src" }
+
+   filter "system:windows"
+      flags { "FatalWarnings" }
+
+   filter "configurations:Debug"
+      defines { "_DEBUG", "DEBUG" }
+      flags { "Symbols" }
+      targetsuffix "_Debug"
+
+   filter "configurations:Release"
+      defines { "NDEBUG" }
+      flags { "Symbols" }
+      optimize "On"
@@ -0,0 +1,36 @@
+-- DDSZConvert: command line tool that converts the DDS files of a media tree to DDSZ, with their texture
+-- data compressed with LZ4, and checks that each one decompresses to the original.
+-- It doesn't need a device, only the Windows SDK headers for the DXGI formats.
+
+workspace "DDSZConvert"
+   configurations { "Debug", "Release" }
+   platforms { "x64" }
+   location "../build"
+   startproject "DDSZConvert"
+
+   filter "platforms:x64"
+      architecture "x64"
+
+project "DDSZConvert"
+   kind "ConsoleApp"
+   language "C++"
+   location "../build"
+   targetdir "../bin"
+   objdir "../build/DDSZConvert/%{cfg.platform}/%{cfg.buildcfg}"
+   warnings "Extra"
+
+   files { "../tools/DDSZConvert.cpp", "../../dxut/Core/BCCommon.*", "../../dxut/Core/DDSFile.*", "../../dxut/Core/DDSZFile.*", "../../dxut/Core/LZ4Block.*" }
+   includedirs { "../../dxut/Core" }
+
+   filter "system:windows"
+      flags { "FatalWarnings" }
+
+   filter "configurations:Debug"
+      defines { "_DEBUG", "DEBUG" }
+      flags { "Symbols" }
+      targetsuffix "_Debug"
+
+   filter "configurations:Release"
+      defines { "NDEBUG" }
+      flags { "Symbols" }
+      optimize "On"
@@ -0,0 +1,37 @@
+-- GpuTimestampRingTest: command line tool that drives the GpuTimer ring in AMD_SDK with a simulated GPU, and
+-- checks its growth, stalls and reported latency.
+-- It has no graphics dependencies, so it can also be generated for Linux CI machines,
+-- e.g. premake5 --file=premake5_gputimestampringtest.lua gmake2
+
+workspace "GpuTimestampRingTest"
+   configurations { "Debug", "Release" }
+   platforms { "x64" }
+   location "../build"
+   startproject "GpuTimestampRingTest"
+
+   filter "platforms:x64"
+      architecture "x64"
+
+project "GpuTimestampRingTest"
+   kind "ConsoleApp"
+   language "C++"
+   location "../build"
+   targetdir "../bin"
+   objdir "../build/GpuTimestampRingTest/%{cfg.platform}/%{cfg.buildcfg}"
+   warnings "Extra"
+
+   files { "../tools/GpuTimestampRingTest.cpp", "../../amd_sdk/src/GpuTimestamp*" }
+   includedirs { "../../amd_sdk/src" }
+
+   filter "system:windows"
+      flags { "FatalWarnings" }
+
+   filter "configurations:Debug"
+      defines { "_DEBUG", "DEBUG" }
+      flags { "Symbols" }
+      targetsuffix "_Debug"
+
+   filter "configurations:Release"
+      defines { "NDEBUG" }
+      flags { "Symbols" }
+      optimize "On"
@@ -0,0 +1,36 @@
+-- TextureResidencyTest: command line tool that checks the texture array packer, the mip stream scheduler
+-- and the residency planner in DXUT on made up textures, and the planner against the DDS loader's maxsize.
+-- It doesn't need a device, only the Windows SDK headers for the DXGI formats.
+
+workspace "TextureResidencyTest"
+   configurations { "Debug", "Release" }
+   platforms { "x64" }
+   location "../build"
+   startproject "TextureResidencyTest"
+
+   filter "platforms:x64"
+      architecture "x64"
+
+project "TextureResidencyTest"
+   kind "ConsoleApp"
+   language "C++"
+   location "../build"
+   targetdir "../bin"
+   objdir "../build/TextureResidencyTest/%{cfg.platform}/%{cfg.buildcfg}"
+   warnings "Extra"
+
+   files { "../tools/TextureResidencyTest.cpp", "../../dxut/Core/BCCommon.*", "../../dxut/Core/DDSFile.*", "../../dxut/Core/DDSZFile.*", "../../dxut/Core/LZ4Block.*", "../../dxut/Optional/DXUTMipScheduler.*", "../../dxut/Optional/DXUTResidencyPlanner.*", "../../dxut/Optional/DXUTTextureArrayPacker.*" }
+   includedirs { "../../dxut/Core", "../../dxut/Optional" }
+
+   filter "system:windows"
+      flags { "FatalWarnings" }
+
+   filter "configurations:Debug"
+      defines { "_DEBUG", "DEBUG" }
+      flags { "Symbols" }
+      targetsuffix "_Debug"
+
+   filter "configurations:Release"
+      defines { "NDEBUG" }
+      flags { "Symbols" }
+      optimize "On"
@@ -0,0 +1,247 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "Benchmark.h"
+#include "../../AMD_SDK/inc/AMD_SDK.h"
+
+
+namespace
+{
+	// Frames to let a new setting settle before recording: the GPU timers report results a few
+	// frames late, and the first frames after a switch create render targets and shaders
+	const UINT kWarmupFrames = 30;
+	const UINT kSampleFrames = 120;
+
+	const wchar_t* kTimerNames[ Benchmark::NumTimers ] = { L"Scene", L"AA Resolve" };
+	const char* kTimerKeys[ Benchmark::NumTimers ] = { "Scene", "AA Resolve" };
+
+	// The names of the settings, as shown in the GUI. The comparison tool matches runs by them
+	const char* kSceneNames[ SSAA::NumSceneTypes ] = { "Typical Scene", "Alpha Stress Test" };
+
+	const char* kTypeNames[ SSAA::Max ] =
+	{
+		"None",
+		"2x MSAA",
+		"2x SSAA (Horiz.)",
+		"2x SSAA (Vert.)",
+		"2x SSAA SF",
+		"1.5x1.5 SSAA",
+		"4x MSAA",
+		"4x SSAA",
+		"4x SSAA SF",
+		"4x SSAA RG",
+		"8x MSAA",
+		"8x SSAA SF",
+		"2f4x EQAA",
+		"4f8x EQAA",
+		"8f16x EQAA",
+	};
+
+	const char* kFormatNames[ SSAA::FmtMax ] = { "R8G8B8A8", "R10G10B10A2", "R16G16B16A16F" };
+
+	void WriteString( FILE* file, const wchar_t* str )
+	{
+		fputc( '"', file );
+		for ( ; *str; str++ )
+		{
+			if ( *str == L'"' || *str == L'\\' )
+			{
+				fputc( '\\', file );
+			}
+			fputc( ( *str < 0x20 || *str > 0x7e ) ? '?' : (char)*str, file );
+		}
+		fputc( '"', file );
+	}
+}
+
+
+Benchmark::Benchmark() :
+	m_CurrentRun( 0 ),
+	m_Frame( 0 ),
+	m_RestoreScene( SSAA::TypicalScene ),
+	m_RestoreType( SSAA::None ),
+	m_RestoreFormat( SSAA::Fmt8x4 ),
+	m_Running( false ),
+	m_Succeeded( false )
+{
+	m_OutputPath[ 0 ] = 0;
+	m_Status[ 0 ] = 0;
+}
+
+
+void Benchmark::Start( const SSAA& ssaa, bool eqaaSupported, const wchar_t* outputPath )
+{
+	m_Runs.clear();
+
+	const int numTypes = eqaaSupported ? SSAA::Max : SSAA::SSAAx8SF + 1;
+	for ( int scene = 0; scene < SSAA::NumSceneTypes; scene++ )
+	{
+		for ( int format = 0; format < SSAA::FmtMax; format++ )
+		{
+			for ( int type = 0; type < numTypes; type++ )
+			{
+				Run run;
+				run.m_Scene = (SSAA::SceneType)scene;
+				run.m_Type = (SSAA::Type)type;
+				run.m_Format = (SSAA::RenderTargetFormat)format;
+				m_Runs.push_back( run );
+			}
+		}
+	}
+
+	m_RestoreScene = ssaa.GetSceneType();
+	m_RestoreType = ssaa.GetAAType();
+	m_RestoreFormat = ssaa.GetRenderTargetType();
+
+	wcscpy_s( m_OutputPath, outputPath );
+	m_CurrentRun = 0;
+	m_Frame = 0;
+	m_Running = true;
+	m_Succeeded = false;
+}
+
+
+bool Benchmark::OnFrame( SSAA& ssaa )
+{
+	if ( !m_Running )
+	{
+		return false;
+	}
+
+	if ( 0 == m_Frame )
+	{
+		const Run& run = m_Runs[ m_CurrentRun ];
+		ApplySettings( ssaa, run.m_Scene, run.m_Type, run.m_Format );
+		m_Frame++;
+		return true;
+	}
+
+	if ( m_Frame > kWarmupFrames )
+	{
+		Run& run = m_Runs[ m_CurrentRun ];
+		for ( int i = 0; i < NumTimers; i++ )
+		{
+			run.m_Times[ i ].push_back( (float)( TIMER_GetTime( Gpu, kTimerNames[ i ] ) * 1000.0 ) );
+		}
+	}
+
+	if ( ++m_Frame <= kWarmupFrames + kSampleFrames )
+	{
+		return false;
+	}
+
+	// This run is complete
+	m_Frame = 0;
+	if ( ++m_CurrentRun < m_Runs.size() )
+	{
+		return OnFrame( ssaa );
+	}
+
+	m_Succeeded = Write();
+	m_Running = false;
+	m_Runs.clear();
+
+	ApplySettings( ssaa, m_RestoreScene, m_RestoreType, m_RestoreFormat );
+	return true;
+}
+
+
+void Benchmark::ApplySettings( SSAA& ssaa, SSAA::SceneType scene, SSAA::Type type, SSAA::RenderTargetFormat format ) const
+{
+	if ( ssaa.GetSceneType() != scene )
+	{
+		ssaa.SetScene( scene );
+	}
+	if ( ssaa.GetRenderTargetType() != format )
+	{
+		ssaa.SetRenderTargetFormat( format );
+	}
+	if ( ssaa.GetAAType() != type )
+	{
+		ssaa.SetAAType( type );
+	}
+}
+
+
+const wchar_t* Benchmark::GetStatus()
+{
+	if ( m_Running )
+	{
+		const Run& run = m_Runs[ m_CurrentRun ];
+		swprintf_s( m_Status, L"Benchmark run %u / %u: %hs, %hs, %hs", m_CurrentRun + 1, (UINT)m_Runs.size(),
+			kSceneNames[ run.m_Scene ], kFormatNames[ run.m_Format ], kTypeNames[ run.m_Type ] );
+	}
+	else
+	{
+		swprintf_s( m_Status, m_Succeeded ? L"Benchmark written to %ls" : L"Benchmark could not be written to %ls", m_OutputPath );
+	}
+
+	return m_Status;
+}
+
+
+// Writes every run with its frame times, one object per scene, format and AA mode
+bool Benchmark::Write() const
+{
+	FILE* file = NULL;
+	_wfopen_s( &file, m_OutputPath, L"wt" );
+	if ( !file )
+	{
+		return false;
+	}
+
+	const DXGI_SURFACE_DESC* backBuffer = DXUTGetDXGIBackBufferSurfaceDesc();
+
+	fprintf( file, "{\n" );
+	fprintf( file, "\"sample\": \"SSAA11\",\n" );
+	fprintf( file, "\"device\": " );
+	WriteString( file, DXUTGetDeviceStats() );
+	fprintf( file, ",\n" );
+	fprintf( file, "\"width\": %u,\n", backBuffer->Width );
+	fprintf( file, "\"height\": %u,\n", backBuffer->Height );
+	fprintf( file, "\"warmup_frames\": %u,\n", kWarmupFrames );
+	fprintf( file, "\"frames\": %u,\n", kSampleFrames );
+	fprintf( file, "\"units\": \"ms\",\n" );
+	fprintf( file, "\"runs\": [" );
+
+	for ( size_t r = 0; r < m_Runs.size(); r++ )
+	{
+		const Run& run = m_Runs[ r ];
+		fprintf( file, "%s\n{ \"scene\": \"%s\", \"format\": \"%s\", \"mode\": \"%s\", \"timers\": {",
+			( 0 == r ) ? "" : ",", kSceneNames[ run.m_Scene ], kFormatNames[ run.m_Format ], kTypeNames[ run.m_Type ] );
+
+		for ( int i = 0; i < NumTimers; i++ )
+		{
+			fprintf( file, "%s\n  \"%s\": [", ( 0 == i ) ? "" : ",", kTimerKeys[ i ] );
+			for ( size_t f = 0; f < run.m_Times[ i ].size(); f++ )
+			{
+				fprintf( file, "%s%.4f", ( 0 == f ) ? "" : ", ", run.m_Times[ i ][ f ] );
+			}
+			fprintf( file, "]" );
+		}
+		fprintf( file, " } }" );
+	}
+	fprintf( file, "\n]\n}\n" );
+
+	bool ok = ( 0 == ferror( file ) );
+	fclose( file );
+	return ok;
+}
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+
+#include "../../DXUT/Core/DXUT.h"
+#include "SSAA.h"
+#include <vector>
+
+
+// Benchmark runs the sample through every scene, render target format and AA mode, and records
+// the GPU time of the scene and of the resolve for a number of frames in each. The frame times
+// are written as JSON, for the BenchCompare tool (see tools/BenchCompare.cpp) to compare against
+// a baseline run.
+class Benchmark
+{
+public:
+
+	enum Timers
+	{
+		SceneTimer,
+		ResolveTimer,
+		NumTimers
+	};
+
+	Benchmark();
+
+	// Builds the list of runs and starts with the first. The settings of ssaa are restored at the end
+	void Start( const SSAA& ssaa, bool eqaaSupported, const wchar_t* outputPath );
+
+	// Call once a frame, before rendering. Records the GPU times of the frame before, and moves
+	// on to the next run when this one has enough frames. Returns true if it changed the settings
+	bool OnFrame( SSAA& ssaa );
+
+	bool IsRunning() const { return m_Running; }
+	// Whether the last benchmark wrote its results
+	bool Succeeded() const { return m_Succeeded; }
+
+	// One line of progress for the HUD
+	const wchar_t* GetStatus();
+
+private:
+
+	struct Run
+	{
+		SSAA::SceneType				m_Scene;
+		SSAA::Type					m_Type;
+		SSAA::RenderTargetFormat	m_Format;
+		std::vector<float>			m_Times[ NumTimers ];	// milliseconds, one per frame
+	};
+
+	void ApplySettings( SSAA& ssaa, SSAA::SceneType scene, SSAA::Type type, SSAA::RenderTargetFormat format ) const;
+	bool Write() const;
+
+	std::vector<Run>			m_Runs;
+	UINT						m_CurrentRun;
+	UINT						m_Frame;			// frames since the current run started, including warm up
+
+	SSAA::SceneType				m_RestoreScene;
+	SSAA::Type					m_RestoreType;
+	SSAA::RenderTargetFormat	m_RestoreFormat;
+
+	bool						m_Running;
+	bool						m_Succeeded;
+	wchar_t						m_OutputPath[ MAX_PATH ];
+	wchar_t						m_Status[ 256 ];
+};
+
+
+#endif
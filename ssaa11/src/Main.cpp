@@ -26,11 +26,14 @@
 #include "../../DXUT/Optional/DXUTSettingsDlg.h"
 #include "../../DXUT/Optional/SDKmisc.h"
 #include "../../DXUT/Optional/SDKmesh.h"
+#include "../../DXUT/Optional/DXUTMipStreamer.h"
+#include "../../DXUT/Optional/DXUTTextureResidency.h"
 #include "../../DXUT/Core/DDSTextureLoader.h"
 #include "../../AMD_SDK/inc/AMD_SDK.h"
 #include "resource.h"
 #include "SSAA.h"
 #include "SampleLayoutControl.h"
+#include "Benchmark.h"
 
 #pragma warning( disable : 4100 ) // disable unreference formal parameter warnings for /W4 builds
 
@@ -80,6 +83,12 @@ static ID3D11ShaderResourceView*	g_CircleTexture = 0;
 static ID3D11ShaderResourceView*	g_CrossTexture = 0;
 static SampleLayoutControl*			g_SampleLayoutControl = 0;
 static bool							g_EQAASupported = false;
+static AMD::FramePacing				g_FramePacing;
+static Benchmark					g_Benchmark;
+static bool							g_bBenchmarkOnStartup = false;
+static bool							g_bQuitAfterBenchmark = false;
+static UINT							g_TextureBudgetMB = 160;
+static bool							g_bTextureArrays = false;
 
 //--------------------------------------------------------------------------------------
 // Forward declarations 
@@ -104,6 +113,7 @@ void CALLBACK OnD3D11FrameRender( ID3D11Device* pd3dDevice, ID3D11DeviceContext*
 
 void InitApp();
 void RenderText();
+void UpdateTextureResidency( UINT backBufferHeight );
 
 //--------------------------------------------------------------------------------------
 // Puts the camera in the default location depending on which scene we are showing
@@ -136,6 +146,37 @@ void SetUpCameraForScene()
 }
 
 
+//--------------------------------------------------------------------------------------
+// Brings the GUI, the camera and the timing statistics up to date after the benchmark
+// changed the settings
+//--------------------------------------------------------------------------------------
+void OnBenchmarkSettingsChanged()
+{
+	if ( g_SceneSelectCombo->GetSelectedIndex() != g_SSAA.GetSceneType() )
+	{
+		g_SceneSelectCombo->SetSelectedByIndex( g_SSAA.GetSceneType() );
+		SetUpCameraForScene();
+	}
+	g_SSAATypeCombo->SetSelectedByIndex( g_SSAA.GetAAType() );
+	g_RenderTargetCombo->SetSelectedByIndex( g_SSAA.GetRenderTargetType() );
+
+	TIMER_ResetStats()
+	g_FramePacing.MarkFrame( AMD::FramePacing::FLAG_MODE_SWITCH );
+}
+
+
+//--------------------------------------------------------------------------------------
+// Reserves the SSAA render targets from the texture budget, so that modes with more
+// samples or a higher resolution take memory back from the scene's textures
+//--------------------------------------------------------------------------------------
+void UpdateTextureResidency( UINT backBufferHeight )
+{
+	CDXUTTextureResidency& residency = DXUTGetGlobalTextureResidency();
+	residency.SetReservedBytes( g_SSAA.GetRenderTargetBytes() );
+	residency.SetViewportHeight( (float)backBufferHeight );
+}
+
+
 //--------------------------------------------------------------------------------------
 // Make sure we check for hardware support of EQAA modes before adding to the options
 //--------------------------------------------------------------------------------------
@@ -245,6 +286,26 @@ int WINAPI wWinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdL
     DXUTSetCallbackD3D11DeviceDestroyed( OnD3D11DestroyDevice );
     DXUTSetCallbackD3D11FrameRender( OnD3D11FrameRender );
 
+	// -benchmark runs the benchmark once the device is created, and quits when it is written
+	g_bBenchmarkOnStartup = ( NULL != wcsstr( lpCmdLine, L"-benchmark" ) );
+
+	// -mipstreaming starts the scene's DDS textures with their mip tails and streams the finer mips in
+	DXUTSetMipStreaming( NULL != wcsstr( lpCmdLine, L"-mipstreaming" ) );
+
+	// -residency loads the scene's DDS textures without the top mips that don't fit a memory budget shared
+	// with the SSAA render targets, and -texturebudget:<MB> sets the budget
+	DXUTSetTextureResidency( NULL != wcsstr( lpCmdLine, L"-residency" ) );
+	const wchar_t* pTextureBudget = wcsstr( lpCmdLine, L"-texturebudget:" );
+	if ( pTextureBudget && _wtoi( pTextureBudget + wcslen( L"-texturebudget:" ) ) > 0 )
+	{
+		g_TextureBudgetMB = (UINT)_wtoi( pTextureBudget + wcslen( L"-texturebudget:" ) );
+	}
+
+	// -texturearrays packs the scene's textures into texture arrays once they are loaded, so that materials
+	// with the same kind of texture don't need their own binds. It's ignored with -mipstreaming or -residency,
+	// which go on changing the textures after they are loaded
+	g_bTextureArrays = ( NULL != wcsstr( lpCmdLine, L"-texturearrays" ) );
+
 	InitApp();
     DXUTInit( true, true, NULL ); // Parse the command line, show msgboxes on error, no extra command line params
     DXUTSetCursorSettings( true, true );
@@ -375,32 +436,65 @@ void RenderText()
     g_pTxtHelper->DrawTextLine( DXUTGetDeviceStats() );
 	g_pTxtHelper->DrawTextLine( g_SSAA.GetDescription() );
 
-	static int		s_counter = 0;
-	static float	s_SceneCostAcc = 0.0f;
-	static float	s_ResolveCostAcc = 0.0f;
-	static float	s_SceneCost = 0.0f;
-	static float	s_ResolveCost = 0.0f;
+	// The GPU timers keep statistics of every frame since the settings last changed
+	const TimerStats* pSceneStats = TIMER_GetStats( Gpu, L"Scene" );
+	const TimerStats* pResolveStats = TIMER_GetStats( Gpu, L"AA Resolve" );
 
-	s_SceneCostAcc += (float)TIMER_GetTime( Gpu, L"Scene" ) * 1000.0f;
-	s_ResolveCostAcc += (float)TIMER_GetTime( Gpu, L"AA Resolve" ) * 1000.0f;
-	s_counter++;
-	if ( s_counter > 10 )
-	{
-		s_SceneCost = s_SceneCostAcc / (float)s_counter;
-		s_ResolveCost = s_ResolveCostAcc / (float)s_counter;
-		s_SceneCostAcc = 0.0f;
-		s_ResolveCostAcc = 0.0f;
-		s_counter = 0;
-	}
-	
 	WCHAR wcbuf[256];
-	swprintf_s( wcbuf, 256, L"Cost in milliseconds( Scene = %.2f, Resolve = %.2f )", s_SceneCost, s_ResolveCost );
+	swprintf_s( wcbuf, 256, L"Cost in milliseconds( Scene = %.2f, Resolve = %.2f )",
+		pSceneStats ? pSceneStats->GetEma() * 1000.0 : 0.0, pResolveStats ? pResolveStats->GetEma() * 1000.0 : 0.0 );
 	g_pTxtHelper->DrawTextLine( wcbuf );
+
+	const TimerStats* pStats[] = { pSceneStats, pResolveStats };
+	const WCHAR* pwsNames[] = { L"Scene", L"Resolve" };
+	for ( UINT i = 0; i < ARRAYSIZE( pStats ); i++ )
+	{
+		if ( pStats[i] && pStats[i]->GetCount() )
+		{
+			swprintf_s( wcbuf, 256, L"%ls p50 / p95 / p99 / p99.9 = %.2f / %.2f / %.2f / %.2f ms, max = %.2f ms",
+				pwsNames[i], pStats[i]->GetPercentile( 50.0 ) * 1000.0, pStats[i]->GetPercentile( 95.0 ) * 1000.0,
+				pStats[i]->GetPercentile( 99.0 ) * 1000.0, pStats[i]->GetPercentile( 99.9 ) * 1000.0, pStats[i]->GetMax() * 1000.0 );
+			g_pTxtHelper->DrawTextLine( wcbuf );
+		}
+	}
+	g_pTxtHelper->DrawTextLine( g_FramePacing.GetSummary() );
+	if ( g_SceneMesh.IsLoading() )
+	{
+		swprintf_s( wcbuf, 256, L"Loading textures: %u left", g_SceneMesh.GetOutstandingResources() );
+		g_pTxtHelper->DrawTextLine( wcbuf );
+	}
+	if ( DXUTIsMipStreamingEnabled() )
+	{
+		swprintf_s( wcbuf, 256, L"Streamed mips: %.1f MB of %.1f MB budget",
+			DXUTGetGlobalMipStreamer().GetStreamedBytes() / ( 1024.0 * 1024.0 ),
+			DXUTGetGlobalMipStreamer().GetScheduler().GetBudget() / ( 1024.0 * 1024.0 ) );
+		g_pTxtHelper->DrawTextLine( wcbuf );
+	}
+	if ( DXUTIsTextureResidencyEnabled() )
+	{
+		const CDXUTTextureResidency& residency = DXUTGetGlobalTextureResidency();
+		swprintf_s( wcbuf, 256, L"Textures: %.1f MB + render targets %.1f MB of %.1f MB budget (%u reloads)",
+			residency.GetPlannedBytes() / ( 1024.0 * 1024.0 ), residency.GetReservedBytes() / ( 1024.0 * 1024.0 ),
+			residency.GetBudget() / ( 1024.0 * 1024.0 ), residency.GetNumReloads() );
+		g_pTxtHelper->DrawTextLine( wcbuf );
+	}
+	if ( g_SSAA.GetSceneType() == SSAA::TypicalScene )
+	{
+		swprintf_s( wcbuf, 256, L"Texture binds: %u per frame, %u texture arrays",
+			g_SceneMesh.GetNumTextureBinds(), g_SceneMesh.GetNumTextureArrays() );
+		g_pTxtHelper->DrawTextLine( wcbuf );
+	}
+	if ( g_Benchmark.IsRunning() || g_Benchmark.Succeeded() )
+	{
+		g_pTxtHelper->DrawTextLine( g_Benchmark.GetStatus() );
+	}
 	g_pTxtHelper->DrawTextLine( L"" );
 	g_pTxtHelper->DrawTextLine( g_SSAA.GetAADescription() );
 
-    g_pTxtHelper->SetInsertionPos( 5, DXUTGetDXGIBackBufferSurfaceDesc()->Height - 2*AMD::HUD::iElementDelta );
+    g_pTxtHelper->SetInsertionPos( 5, DXUTGetDXGIBackBufferSurfaceDesc()->Height - 4*AMD::HUD::iElementDelta );
 	g_pTxtHelper->DrawTextLine( L"Toggle GUI             : F1" );
+	g_pTxtHelper->DrawTextLine( L"Write timing reports   : F3" );
+	g_pTxtHelper->DrawTextLine( L"Run benchmark          : F4" );
 	g_pTxtHelper->DrawTextLine( L"Cycle through AA Modes : +/-" );
 
     g_pTxtHelper->End();
@@ -436,12 +530,20 @@ HRESULT CALLBACK OnD3D11CreateDevice( ID3D11Device* pd3dDevice, const DXGI_SURFA
 
 	g_SampleLayoutControl->SetTextures( g_CircleTexture, g_CrossTexture );
    
-	// Load the main scene
-	V( g_SceneMesh.Create( pd3dDevice, L"SquidRoom\\SquidRoom.sdkmesh" ) );
-
-	// Init the SSAA class
+	// Init the SSAA class before loading the scene, so the texture budget knows what its render targets take
 	g_SSAA.Init( pd3dDevice, pd3dImmediateContext, &g_SceneMesh, g_Camera );
 	g_SSAA.OnResize( pBackBufferSurfaceDesc->Width, pBackBufferSurfaceDesc->Height );
+	if ( DXUTIsTextureResidencyEnabled() )
+	{
+		// The camera is inside the room, so its surfaces are drawn a few times larger than with the whole room in view
+		DXUTGetGlobalTextureResidency().SetBudget( (UINT64)g_TextureBudgetMB * 1024 * 1024 );
+		DXUTGetGlobalTextureResidency().SetLodBias( 2.0f );
+		UpdateTextureResidency( pBackBufferSurfaceDesc->Height );
+	}
+
+	// Load the main scene
+	V( g_SceneMesh.Create( pd3dDevice, L"SquidRoom\\SquidRoom.sdkmesh" ) );
+	g_FramePacing.MarkFrame( AMD::FramePacing::FLAG_DEVICE_CHANGE );
     
     // Create AMD_SDK resources here
     g_HUD.OnCreateDevice( pd3dDevice );
@@ -502,6 +604,7 @@ HRESULT CALLBACK OnD3D11ResizedSwapChain( ID3D11Device* pd3dDevice, IDXGISwapCha
 #endif
 	
 	g_SSAA.OnResize( pBackBufferSurfaceDesc->Width, pBackBufferSurfaceDesc->Height );
+	g_FramePacing.MarkFrame( AMD::FramePacing::FLAG_RESIZE );
 
     return S_OK;
 }
@@ -516,6 +619,9 @@ void CALLBACK OnD3D11FrameRender( ID3D11Device* pd3dDevice, ID3D11DeviceContext*
     // Reset the timer at start of frame
     TIMER_Reset()
 
+	// Present to present intervals, for the stutter detection
+	g_FramePacing.OnFrame();
+
     // If the settings dialog is being shown, then render it instead of rendering the app's scene
     if( g_SettingsDlg.IsActive() )
     {
@@ -527,16 +633,15 @@ void CALLBACK OnD3D11FrameRender( ID3D11Device* pd3dDevice, ID3D11DeviceContext*
 	g_SSAA.Render( DXUTGetD3D11RenderTargetView(), DXUTGetD3D11DepthStencilView() );
 
 	// Render HUD and other text to the backbuffer
-	TIMER_Begin( 0, L"HUD" );
 	if( g_bRenderHUD )
     {
+		TIMER_Zone( tcFrame, L"HUD" );
 #if defined (USE_MAGNIFY)
         g_MagnifyTool.Render();
 #endif
         g_HUD.OnRender( fElapsedTime );
 		RenderText();
     }
-	TIMER_End();
 }
 
 
@@ -598,6 +703,57 @@ void CALLBACK OnFrameMove( double fTime, float fElapsedTime, void* pUserContext
 {
     // Update the camera's position based on user input 
     g_Camera.FrameMove( fElapsedTime );
+
+	// Creates the textures the loader threads have read since the last frame
+	if ( g_SceneMesh.IsLoading() )
+	{
+		g_SceneMesh.CheckLoadDone();
+
+		// The arrays are copies of the final textures, so they are made once everything is loaded
+		if ( g_bTextureArrays && !g_SceneMesh.IsLoading() )
+		{
+			g_SceneMesh.CreateTextureArrays( DXUTGetD3D11DeviceContext() );
+		}
+	}
+
+	// Picks the mips the scene's textures need from the camera, before they are drawn
+	if ( DXUTIsMipStreamingEnabled() )
+	{
+		DirectX::XMMATRIX mProj = g_Camera.GetProjMatrix();
+		g_SceneMesh.UpdateMipStreaming( g_Camera.GetEyePt(), DirectX::XMMatrixIdentity(),
+			DirectX::XMVectorGetY( mProj.r[1] ), (float)DXUTGetDXGIBackBufferSurfaceDesc()->Height );
+		DXUTGetGlobalMipStreamer().Update( DXUTGetD3D11Device(), DXUTGetD3D11DeviceContext() );
+	}
+
+	// Reloads the scene's textures with fewer or more mips when the AA mode or the window size changed
+	if ( DXUTIsTextureResidencyEnabled() )
+	{
+		UpdateTextureResidency( DXUTGetDXGIBackBufferSurfaceDesc()->Height );
+		DXUTGetGlobalTextureResidency().Update( DXUTGetD3D11Device(), DXUTGetD3D11DeviceContext() );
+	}
+
+	// Measure the final textures, not the placeholders
+	if ( g_bBenchmarkOnStartup && g_SceneMesh.IsLoaded() )
+	{
+		g_bBenchmarkOnStartup = false;
+		g_bQuitAfterBenchmark = true;
+		g_Benchmark.Start( g_SSAA, g_EQAASupported, L"SSAA11_Benchmark.json" );
+	}
+
+	// The benchmark switches through the settings by itself
+	if ( g_Benchmark.IsRunning() )
+	{
+		if ( g_Benchmark.OnFrame( g_SSAA ) )
+		{
+			OnBenchmarkSettingsChanged();
+		}
+
+		// A run from the command line quits when it is done, with a non-zero exit code if it failed
+		if ( !g_Benchmark.IsRunning() && g_bQuitAfterBenchmark )
+		{
+			DXUTShutdown( g_Benchmark.Succeeded() ? 0 : 1 );
+		}
+	}
 }
 
 
@@ -644,17 +800,37 @@ void CALLBACK OnKeyboard( UINT nChar, bool bKeyDown, bool bAltDown, void* pUserC
 				g_bRenderHUD = !g_bRenderHUD;
 				break;
 
+			case VK_F3:
+				// Frame time statistics of every timer for the current settings, for benchmarking
+				TIMER_WriteStats( L"SSAA11_TimerStats.csv" );
+				// What a timer scope and a TIMER_Zone cost, to read the statistics above with
+				TIMER_WriteOverhead( L"SSAA11_TimerOverhead.csv" );
+				g_FramePacing.WriteReport( L"SSAA11_FramePacing.json" );
+				break;
+
+			case VK_F4:
+				// Every scene, format and AA mode, for tools/BenchCompare
+				if ( !g_Benchmark.IsRunning() && g_SceneMesh.IsLoaded() )
+				{
+					g_Benchmark.Start( g_SSAA, g_EQAASupported, L"SSAA11_Benchmark.json" );
+				}
+				break;
+
 			case VK_ADD:
 				if ( ( g_EQAASupported && g_SSAA.GetAAType() < SSAA::Max ) || g_SSAA.GetAAType() < SSAA::SSAAx8SF )
 				{
 					g_SSAA.SetAAType( (SSAA::Type)( g_SSAA.GetAAType() + 1 ) );
 					g_SSAATypeCombo->SetSelectedByIndex( g_SSAA.GetAAType() );
+					TIMER_ResetStats()
+					g_FramePacing.MarkFrame( AMD::FramePacing::FLAG_MODE_SWITCH );
 				}
 				break;
 
 			case VK_SUBTRACT:
 				g_SSAA.SetAAType( (SSAA::Type)( g_SSAA.GetAAType() - 1 ) );
 				g_SSAATypeCombo->SetSelectedByIndex( g_SSAA.GetAAType() );
+				TIMER_ResetStats()
+				g_FramePacing.MarkFrame( AMD::FramePacing::FLAG_MODE_SWITCH );
 				break;
 		}
     }
@@ -678,14 +854,20 @@ void CALLBACK OnGUIEvent( UINT nEvent, int nControlID, CDXUTControl* pControl, v
 		case IDC_SCENE_COMBO:
 			g_SSAA.SetScene( (SSAA::SceneType)g_SceneSelectCombo->GetSelectedIndex() );
 			SetUpCameraForScene();
+			TIMER_ResetStats()
+			g_FramePacing.MarkFrame( AMD::FramePacing::FLAG_MODE_SWITCH );
 			break;
 
 		case IDC_SSAA_TYPE:
 			g_SSAA.SetAAType( (SSAA::Type)g_SSAATypeCombo->GetSelectedIndex() );
+			TIMER_ResetStats()
+			g_FramePacing.MarkFrame( AMD::FramePacing::FLAG_MODE_SWITCH );
 			break;
 
 		case IDC_RENDER_TARGET:
 			g_SSAA.SetRenderTargetFormat( (SSAA::RenderTargetFormat)g_RenderTargetCombo->GetSelectedIndex() );
+			TIMER_ResetStats()
+			g_FramePacing.MarkFrame( AMD::FramePacing::FLAG_MODE_SWITCH );
 			break;
     }
 
@@ -91,14 +91,12 @@ SSAA::SSAA() :
 	m_SceneMesh( 0 ),
 	m_SceneInputLayout( 0 ),
 	m_SceneVS( 0 ),
-	m_ScenePS( 0 ),
-	m_SceneSampleFrequencyPS( 0 ),
+	m_SceneArrayInputLayout( 0 ),
+	m_SceneArrayVS( 0 ),
 	m_StressTestInputLayout( 0 ),
 	m_StressTestVB( 0 ),
 	m_StressTestIB( 0 ),
 	m_StressTestVS( 0 ),
-	m_StressTestPS( 0 ),
-	m_StressTestSampleFrequencyPS( 0 ),
 	m_StressTestTexture( 0 ),
 	m_QuadInputLayout( 0 ),
 	m_QuadVS( 0 ),
@@ -114,6 +112,15 @@ SSAA::SSAA() :
 	m_DepthView( 0 )
 {
 	ZeroMemory( m_SceneSamplers, sizeof( m_SceneSamplers ) );
+
+	// Describe the scene pixel shader permutations; they're compiled in Init
+	const char* ScenePixelShaderEntryPoints[ NumSceneTypes ] = { "PSMainBump", "PSMain2" };
+	for ( int i = 0; i < NumSceneTypes; i++ )
+	{
+		m_ScenePixelShaders[ i ].SetShader( L"../src/Shaders/Scene.hlsl", ScenePixelShaderEntryPoints[ i ], "ps_5_0" );
+		m_ScenePixelShaders[ i ].AddBoolAxis( "PER_SAMPLE_FREQUENCY" );
+	}
+	m_ScenePixelShaders[ TypicalScene ].AddBoolAxis( "TEXTURE_ARRAYS" );
 }
 
 
@@ -195,18 +202,10 @@ void SSAA::Init( ID3D11Device* device, ID3D11DeviceContext* immediateContext, CD
 	V( m_Device->CreateDepthStencilState( &DepthStencilDesc, &m_QuadDepthStencilState ) );
 	
 	// Create shaders
-	V( AMD::CompileShaderFromFile( L"../src/Shaders/Scene.hlsl", "PSMainBump", "ps_5_0", &Blob, 0 ) );
-	V( m_Device->CreatePixelShader( Blob->GetBufferPointer(), Blob->GetBufferSize(), 0, &m_ScenePS ) );
-	SAFE_RELEASE( Blob );
-
-	D3D10_SHADER_MACRO defines[] = 
+	for ( int i = 0; i < NumSceneTypes; i++ )
 	{
-		"PER_SAMPLE_FREQUENCY", "",
-		0, 0
-	};
-	V( AMD::CompileShaderFromFile( L"../src/Shaders/Scene.hlsl", "PSMainBump", "ps_5_0", &Blob, defines ) );
-	V( m_Device->CreatePixelShader( Blob->GetBufferPointer(), Blob->GetBufferSize(), 0, &m_SceneSampleFrequencyPS ) );
-	SAFE_RELEASE( Blob );
+		V( m_ScenePixelShaders[ i ].Compile( m_Device ) );
+	}
 
 	V( AMD::CompileShaderFromFile( L"../src/Shaders/Scene.hlsl", "VSMain", "vs_5_0", &Blob, 0 ) );
 	V( m_Device->CreateVertexShader( Blob->GetBufferPointer(), Blob->GetBufferSize(), 0, &m_SceneVS ) );
@@ -223,12 +222,22 @@ void SSAA::Init( ID3D11Device* device, ID3D11DeviceContext* immediateContext, CD
 	
 	SAFE_RELEASE( Blob );
 
-	V( AMD::CompileShaderFromFile( L"../src/Shaders/Scene.hlsl", "PSMain2", "ps_5_0", &Blob, 0 ) );
-	V( m_Device->CreatePixelShader( Blob->GetBufferPointer(), Blob->GetBufferSize(), 0, &m_StressTestPS ) );
-	SAFE_RELEASE( Blob );
+	// The same vertex shader for a mesh with texture arrays, which gets each draw's slices per instance
+	const D3D10_SHADER_MACRO TextureArrayDefines[] = { { "TEXTURE_ARRAYS", "1" }, { 0, 0 } };
+	V( AMD::CompileShaderFromFile( L"../src/Shaders/Scene.hlsl", "VSMain", "vs_5_0", &Blob, TextureArrayDefines ) );
+	V( m_Device->CreateVertexShader( Blob->GetBufferPointer(), Blob->GetBufferSize(), 0, &m_SceneArrayVS ) );
+
+	const D3D11_INPUT_ELEMENT_DESC arrayLayout[] =
+	{
+		{ "POSITION",  0, DXGI_FORMAT_R32G32B32_FLOAT,		0,  0,  D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "NORMAL",    0, DXGI_FORMAT_R10G10B10A2_UNORM,	0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXCOORD",  0, DXGI_FORMAT_R16G16_FLOAT,			0, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TANGENT",   0, DXGI_FORMAT_R10G10B10A2_UNORM,	0, 20, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TEXSLICES", 0, DXGI_FORMAT_R32G32_UINT,			CDXUTSDKMesh::SLICE_STREAM, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+	};
+
+	V( m_Device->CreateInputLayout( arrayLayout, ARRAYSIZE( arrayLayout ), Blob->GetBufferPointer(), Blob->GetBufferSize(), &m_SceneArrayInputLayout ) );
 
-	V( AMD::CompileShaderFromFile( L"../src/Shaders/Scene.hlsl", "PSMain2", "ps_5_0", &Blob, defines ) );
-	V( m_Device->CreatePixelShader( Blob->GetBufferPointer(), Blob->GetBufferSize(), 0, &m_StressTestSampleFrequencyPS ) );
 	SAFE_RELEASE( Blob );
 
 	V( AMD::CompileShaderFromFile( L"../src/Shaders/Scene.hlsl", "VSMain2", "vs_5_0", &Blob, 0 ) );
@@ -412,17 +421,20 @@ void SSAA::DeInit()
 
 	SAFE_RELEASE( m_SceneInputLayout );
 	SAFE_RELEASE( m_SceneVS );
-	SAFE_RELEASE( m_ScenePS );
-	SAFE_RELEASE( m_SceneSampleFrequencyPS );
+	SAFE_RELEASE( m_SceneArrayInputLayout );
+	SAFE_RELEASE( m_SceneArrayVS );
 
 	SAFE_RELEASE( m_StressTestInputLayout );
 	SAFE_RELEASE( m_StressTestVB );
 	SAFE_RELEASE( m_StressTestIB );
 	SAFE_RELEASE( m_StressTestVS );
-	SAFE_RELEASE( m_StressTestPS );
-	SAFE_RELEASE( m_StressTestSampleFrequencyPS );
 	SAFE_RELEASE( m_StressTestTexture );
 
+	for ( int i = 0; i < NumSceneTypes; i++ )
+	{
+		m_ScenePixelShaders[ i ].Release();
+	}
+
 	SAFE_RELEASE( m_QuadSampler );
 	SAFE_RELEASE( m_QuadVB );
 	SAFE_RELEASE( m_QuadInputLayout );
@@ -550,8 +562,9 @@ void SSAA::Render( ID3D11RenderTargetView* rtv, ID3D11DepthStencilView* dsv )
 		m_ImmediateContext->PSSetConstantBuffers( 0, 1, &m_SceneConstantBuffer );
 
 		// Set shaders
-		m_ImmediateContext->IASetInputLayout( m_SceneInputLayout );
-		m_ImmediateContext->VSSetShader( m_SceneVS, 0, 0 );
+		const bool bTextureArrays = m_SceneMesh->HasTextureArrays();
+		m_ImmediateContext->IASetInputLayout( bTextureArrays ? m_SceneArrayInputLayout : m_SceneInputLayout );
+		m_ImmediateContext->VSSetShader( bTextureArrays ? m_SceneArrayVS : m_SceneVS, 0, 0 );
 		m_ImmediateContext->PSSetShader( GetScenePixelShader(), 0, 0 );
 		
 		// Submit the draw calls
@@ -792,16 +805,43 @@ ID3D11PixelShader* SSAA::GetQuadPixelShader()
 ID3D11PixelShader* SSAA::GetScenePixelShader()
 {
 	// If we are doing per-sample AA then we need to use the appropriate per-sample pixel shader
-	switch ( m_AntiAliasingType )
+	static const bool PerSampleFrequency[ Max ] =
 	{
-		case SSAAx2SF:
-		case SSAAx4SF:
-		case SSAAx8SF:
-			return m_Scene == StressTest ? m_StressTestSampleFrequencyPS : m_SceneSampleFrequencyPS;
+		false,					// None
+		false, false, false,	// MSAAx2, SSAAx2H, SSAAx2V
+		true,					// SSAAx2SF
+		false,					// SSAAx15
+		false, false,			// MSAAx4, SSAAx4
+		true,					// SSAAx4SF
+		false,					// SSAAx4RG
+		false,					// MSAAx8
+		true,					// SSAAx8SF
+		false, false, false		// EQAA2f4x, EQAA4f8x, EQAA8f16x
+	};
+
+	const bool TextureArrays = m_Scene == TypicalScene && m_SceneMesh && m_SceneMesh->HasTextureArrays();
+	const unsigned int AxisValues[ NumScenePixelShaderAxes ] = { PerSampleFrequency[ m_AntiAliasingType ] ? 1u : 0u, TextureArrays ? 1u : 0u };
+	const AMD::ShaderPermutations& Permutations = m_ScenePixelShaders[ m_Scene ];
 
-		default: 
-			return m_Scene == StressTest ? m_StressTestPS : m_ScenePS;
+	return Permutations.GetPixelShader( Permutations.GetIndex( AxisValues ) );
+}
+
+
+// Return the memory of the destination texture, the multisampled surface if there is one and the depth buffer
+UINT64 SSAA::GetRenderTargetBytes() const
+{
+	const UINT64 width = (UINT64)( (float)m_Width * m_ResolutionMultiplierX );
+	const UINT64 height = (UINT64)( (float)m_Height * m_ResolutionMultiplierY );
+	const UINT64 samples = GetMultisampleLevel();
+
+	UINT64 bytes = width * height * GetRenderTargetFormatSizeInBytes();
+	if ( samples > 1 )
+	{
+		bytes += width * height * samples * GetRenderTargetFormatSizeInBytes();
 	}
+	bytes += width * height * samples * 4;
+
+	return bytes;
 }
 
 
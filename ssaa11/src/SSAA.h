@@ -24,6 +24,7 @@
 
 
 #include "../../DXUT/Core/DXUT.h"
+#include "../../AMD_SDK/src/ShaderPermutations.h"
 
 
 class CFirstPersonCamera;
@@ -72,7 +73,8 @@ public:
 	enum SceneType
 	{
 		TypicalScene,
-		StressTest
+		StressTest,
+		NumSceneTypes
 	};
 
 	// Construction/destruction
@@ -99,6 +101,9 @@ public:
 	SceneType GetSceneType() const { return m_Scene; }
 	const wchar_t* GetDescription() const { return m_Description; }
 	const wchar_t* GetAADescription() const;
+
+	// Memory of the intermediate render targets for the current AA type, format and size
+	UINT64 GetRenderTargetBytes() const;
 	
 private:
 
@@ -122,6 +127,14 @@ private:
 		ID3D11SamplerState*		m_AnisoSampler;
 	};
 
+	// Axes of the scene pixel shader permutations; only the typical scene has the texture array axis
+	enum ScenePixelShaderAxes
+	{
+		PerSampleFrequencyAxis,
+		TextureArrayAxis,
+		NumScenePixelShaderAxes
+	};
+
 	enum BiasLevels
 	{
 		NoBias,
@@ -158,18 +171,21 @@ private:
 	CDXUTSDKMesh*						m_SceneMesh;
 	ID3D11InputLayout*					m_SceneInputLayout;
 	ID3D11VertexShader*					m_SceneVS;
-	ID3D11PixelShader*					m_ScenePS;
-	ID3D11PixelShader*					m_SceneSampleFrequencyPS;
+
+	// Used instead when the scene mesh has packed its textures into arrays
+	ID3D11InputLayout*					m_SceneArrayInputLayout;
+	ID3D11VertexShader*					m_SceneArrayVS;
 	
 	// Stress Test Scene D3D resources
 	ID3D11InputLayout*					m_StressTestInputLayout;
 	ID3D11Buffer*						m_StressTestVB;
 	ID3D11Buffer*						m_StressTestIB;
 	ID3D11VertexShader*					m_StressTestVS;
-	ID3D11PixelShader*					m_StressTestPS;
-	ID3D11PixelShader*					m_StressTestSampleFrequencyPS;
 	ID3D11ShaderResourceView*			m_StressTestTexture;
 
+	// Scene pixel shaders for each scene type, with and without per sample frequency shading
+	AMD::ShaderPermutations				m_ScenePixelShaders[ NumSceneTypes ];
+
 	// Full screen quad D3D resources
 	ID3D11InputLayout*					m_QuadInputLayout;
 	ID3D11VertexShader*					m_QuadVS;
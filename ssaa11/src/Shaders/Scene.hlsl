@@ -36,9 +36,15 @@ cbuffer Constants : register( b0 )
 };
 
 
-// The two texture slots
+// The two texture slots. With TEXTURE_ARRAYS the mesh packs its textures into arrays, and
+// each draw gets its material's slices as instance data
+#if defined (TEXTURE_ARRAYS)
+Texture2DArray	g_txAlbedo : register( t0 );
+Texture2DArray	g_txNormal : register( t1 );
+#else
 Texture2D		g_txAlbedo : register( t0 );
 Texture2D		g_txNormal : register( t1 );
+#endif
 
 // The sampler states defined by the demo
 SamplerState	g_samPoint : register( s0 );
@@ -51,6 +57,9 @@ struct VS_INPUT
 	float3 normal		: NORMAL;
 	float2 texcoord		: TEXCOORD0;
 	float3 tangent		: TANGENT;
+#if defined (TEXTURE_ARRAYS)
+	uint2 slices		: TEXSLICES;	// albedo, normal
+#endif
 };
 
 // Output from vertex shader
@@ -60,6 +69,9 @@ struct VS_OUTPUT
 	float3 tangent		: TANGENT;
 	float2 texcoord		: TEXCOORD0;
 	float3 worldPos		: TEXCOORD1;
+#if defined (TEXTURE_ARRAYS)
+	nointerpolation uint2 slices : TEXCOORD2;
+#endif
 	float4 position		: SV_POSITION;
 };
 
@@ -74,6 +86,9 @@ struct PS_INPUT
 	centroid sample float3		tangent		: TANGENT;
 	sample float2				texcoord	: TEXCOORD0;
 	centroid sample float3		worldPos	: TEXCOORD1;
+#if defined (TEXTURE_ARRAYS)
+	nointerpolation uint2		slices		: TEXCOORD2;
+#endif
 };
 #else
 struct PS_INPUT
@@ -82,6 +97,9 @@ struct PS_INPUT
 	centroid float3 tangent		: TANGENT;
 	float2			texcoord	: TEXCOORD0;
 	centroid float3 worldPos	: TEXCOORD1;
+#if defined (TEXTURE_ARRAYS)
+	nointerpolation uint2 slices : TEXCOORD2;
+#endif
 };
 #endif
 
@@ -102,6 +120,9 @@ VS_OUTPUT VSMain( in VS_INPUT input )
 	output.tangent = normalize( mul( R10G10B10A2_UNORM_TO_R32G32B32_FLOAT( input.tangent ), (float3x3)World ) );
 	output.texcoord = input.texcoord;
 	output.worldPos = mul( input.position, World ).xyz;
+#if defined (TEXTURE_ARRAYS)
+	output.slices = input.slices;
+#endif
 
 	return output;
 }
@@ -162,8 +183,13 @@ void LightingFunction( float3 position, float3 normal, float specularMask, out f
 float4 PSMainBump( in PS_INPUT input ) : SV_TARGET
 {
 	// Sample textures
+#if defined (TEXTURE_ARRAYS)
+	float4 albedo = g_txAlbedo.Sample( g_samAniso, float3( input.texcoord, input.slices.x ) );
+	float3 normal = 2.0 * g_txNormal.Sample( g_samAniso, float3( input.texcoord, input.slices.y ) ).xyz - 1.0;
+#else
 	float4 albedo = g_txAlbedo.Sample( g_samAniso, input.texcoord );
 	float3 normal = 2.0 * g_txNormal.Sample( g_samAniso, input.texcoord ).xyz - 1.0;
+#endif
 	float specMask = albedo.a;
 	
 	// Generate binormal from normal and tangent to save interpolators
@@ -0,0 +1,734 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: BCDecodeBench.cpp
+//
+// Measures the throughput of the software BC decoder (dxut/Core/BCDecode.cpp) and checks
+// that its SSE2 code decodes exactly like the scalar reference code.
+//
+// First both are checked against another decoder: BCDecodeGolden.h holds blocks of BC1-BC5
+// (UNORM) and BC7 with the texels Pillow decodes them to (MakeBCDecodeGolden.py). BC7 must
+// match to the bit. Pillow truncates the interpolated values of BC1-BC5 where this decoder
+// rounds them to nearest, so those must match or be exactly 1 higher. Reserved BC7 modes
+// must decode to zeros, as the Direct3D 11 specification says; Pillow decodes them to
+// opaque black, so they aren't in the golden set.
+//
+// For each of BC1-BC7 (BC4, BC5 and BC6H both signed and unsigned) it decodes a surface of
+// random blocks three ways: the reference code on one thread, the SSE2 code on one thread,
+// and the SSE2 code on all threads. Random blocks hit every mode, partition and index, so
+// the comparison covers far more than real textures do. Each measurement repeats until it
+// has run for the minimum time, and reports the best pass in megatexels per second.
+//
+// DDS files given on the command line are decoded whole, every mip of every item, and
+// compared the same way.
+//
+// Then it encodes a synthetic RGBA image (gradients, edges and noise) with the software BC
+// encoder (dxut/Core/BCEncode.cpp) to BC1, BC3, BC4, BC5 and BC7 at each quality tier, the
+// same three ways, checks that the SSE2 and reference code write the same blocks, and
+// reports the PSNR of the encoded channels as decoded again.
+//
+// Last it filters full mip chains from a larger image of the same kind with the CPU mip
+// generator (dxut/Core/MipGen.cpp), with each filter, the same three ways, checks that
+// the SSE2 and reference code give the same texels, and reports how many texels of mip 4
+// pass an alpha test, which MIPGEN_ALPHA_COVERAGE should keep where the top mip is.
+//
+// The exit code is 0 if everything matches, 1 on mismatches, 2 on bad arguments or input.
+// It doesn't need a device, e.g. with premake: premake5 --file=premake5_bcdecodebench.lua vs2015
+//--------------------------------------------------------------------------------------
+#define _CRT_SECURE_NO_WARNINGS
+
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "BCDecode.h"
+#include "BCEncode.h"
+#include "MipGen.h"
+
+#include "BCDecodeGolden.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    const int kExitOk = 0;
+    const int kExitMismatch = 1;
+    const int kExitError = 2;
+
+    struct Format
+    {
+        DXGI_FORMAT     format;
+        const char*     name;
+    };
+
+    const Format kFormats[] =
+    {
+        { DXGI_FORMAT_BC1_UNORM,    "BC1" },
+        { DXGI_FORMAT_BC2_UNORM,    "BC2" },
+        { DXGI_FORMAT_BC3_UNORM,    "BC3" },
+        { DXGI_FORMAT_BC4_UNORM,    "BC4_UNORM" },
+        { DXGI_FORMAT_BC4_SNORM,    "BC4_SNORM" },
+        { DXGI_FORMAT_BC5_UNORM,    "BC5_UNORM" },
+        { DXGI_FORMAT_BC5_SNORM,    "BC5_SNORM" },
+        { DXGI_FORMAT_BC6H_UF16,    "BC6H_UF16" },
+        { DXGI_FORMAT_BC6H_SF16,    "BC6H_SF16" },
+        { DXGI_FORMAT_BC7_UNORM,    "BC7" },
+    };
+
+    struct EncodeFormat
+    {
+        DXGI_FORMAT     format;
+        const char*     name;
+        unsigned int    channels;   // bit i for each channel the format encodes
+        bool            cutout;     // texels with alpha below 128 come out transparent black
+    };
+
+    const EncodeFormat kEncodeFormats[] =
+    {
+        { DXGI_FORMAT_BC1_UNORM,    "BC1",  0x7,    true },
+        { DXGI_FORMAT_BC3_UNORM,    "BC3",  0xf,    false },
+        { DXGI_FORMAT_BC4_UNORM,    "BC4",  0x1,    false },
+        { DXGI_FORMAT_BC5_UNORM,    "BC5",  0x3,    false },
+        { DXGI_FORMAT_BC7_UNORM,    "BC7",  0xf,    false },
+    };
+
+    const char* const kQualityNames[] = { "fast", "normal", "high" };
+
+    // The encoder is much slower than the decoder, so it gets a smaller image
+    const size_t kEncodeSize = 256;
+
+    struct MipFilter
+    {
+        unsigned int    flags;
+        const char*     name;
+    };
+
+    const MipFilter kMipFilters[] =
+    {
+        { MIPGEN_BOX,                                           "mips box" },
+        { MIPGEN_BOX | MIPGEN_SRGB,                             "mips box srgb" },
+        { MIPGEN_KAISER,                                        "mips kaiser" },
+        { MIPGEN_KAISER | MIPGEN_SRGB,                          "mips kaiser srgb" },
+        { MIPGEN_KAISER | MIPGEN_SRGB | MIPGEN_ALPHA_COVERAGE,  "mips kaiser coverage" },
+    };
+
+    // The mip whose alpha coverage gets reported
+    const size_t kCoverageMip = 4;
+
+    struct Options
+    {
+        Options() :
+            m_NumThreads( 0 ),
+            m_Size( 1024 ),
+            m_MinSeconds( 0.5 ),
+            m_Seed( 1 ),
+            m_Encode( true ),
+            m_Mips( true )
+        {
+        }
+
+        unsigned int                m_NumThreads;       // 0 for one per processor
+        size_t                      m_Size;
+        double                      m_MinSeconds;
+        unsigned long long          m_Seed;
+        bool                        m_Encode;
+        bool                        m_Mips;
+        std::vector<const char*>    m_Files;
+    };
+
+    void PrintUsage()
+    {
+        printf(
+            "usage: BCDecodeBench [options] [file.dds ...]\n"
+            "\n"
+            "Checks the software BC decoder against the golden set decoded by Pillow, then\n"
+            "measures it on random blocks of every BC format, and on the given DDS files, then\n"
+            "the software BC encoder and mip generator. Exits with 1 if the decoder doesn't\n"
+            "match the golden set or the SSE2 and reference code disagree, 2 on errors, 0\n"
+            "otherwise.\n"
+            "\n"
+            "  --threads N     threads for the multithreaded runs (default one per processor)\n"
+            "  --size N        width and height of the random surfaces (default 1024)\n"
+            "  --seconds S     minimum time per measurement (default 0.5)\n"
+            "  --seed N        random seed (default 1)\n"
+            "  --no-random     only decode the files\n"
+            "  --no-encode     skip the encoder\n"
+            "  --no-mips       skip the mip generator\n" );
+    }
+
+    bool ParseNumber( const char* text, double& o_Value )
+    {
+        char* end = NULL;
+        o_Value = strtod( text, &end );
+        return end != text && 0 == *end;
+    }
+
+    bool ParseOptions( int argc, char** argv, Options& o_Options, bool& o_Random )
+    {
+        o_Random = true;
+        for (int i = 1; i < argc; i++)
+        {
+            const char* arg = argv[i];
+            const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+            double number = 0.0;
+
+            if (0 == strcmp( arg, "--no-random" ))
+            {
+                o_Random = false;
+            }
+            else if (0 == strcmp( arg, "--no-encode" ))
+            {
+                o_Options.m_Encode = false;
+            }
+            else if (0 == strcmp( arg, "--no-mips" ))
+            {
+                o_Options.m_Mips = false;
+            }
+            else if (0 == strcmp( arg, "--help" ) || 0 == strcmp( arg, "-h" ))
+            {
+                return false;
+            }
+            else if (0 == strncmp( arg, "--", 2 ))
+            {
+                if (!value)
+                {
+                    fprintf( stderr, "error: %s needs a value\n", arg );
+                    return false;
+                }
+                i++;
+
+                if (!ParseNumber( value, number ) || number < 0.0)
+                {
+                    fprintf( stderr, "error: bad value %s for %s\n", value, arg );
+                    return false;
+                }
+
+                if (0 == strcmp( arg, "--threads" ))
+                {
+                    o_Options.m_NumThreads = (unsigned int)number;
+                }
+                else if (0 == strcmp( arg, "--size" ) && number >= 1.0 && number <= 16384.0)
+                {
+                    o_Options.m_Size = (size_t)number;
+                }
+                else if (0 == strcmp( arg, "--seconds" ))
+                {
+                    o_Options.m_MinSeconds = number;
+                }
+                else if (0 == strcmp( arg, "--seed" ))
+                {
+                    o_Options.m_Seed = (unsigned long long)number;
+                }
+                else
+                {
+                    fprintf( stderr, "error: unknown option %s\n", arg );
+                    return false;
+                }
+            }
+            else
+            {
+                o_Options.m_Files.push_back( arg );
+            }
+        }
+        return true;
+    }
+
+    double GetSeconds()
+    {
+#ifdef _WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency( &frequency );
+        QueryPerformanceCounter( &counter );
+        return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+        timespec now;
+        clock_gettime( CLOCK_MONOTONIC, &now );
+        return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+    }
+
+    class Random
+    {
+    public:
+        Random( unsigned long long seed ) : m_State( seed ? seed : 0x9E3779B97F4A7C15ull ) {}
+
+        unsigned long long Next()
+        {
+            m_State ^= m_State >> 12;
+            m_State ^= m_State << 25;
+            m_State ^= m_State >> 27;
+            return m_State * 2685821657736338717ull;
+        }
+
+    private:
+        unsigned long long m_State;
+    };
+
+    // A texture in memory, described the way ParseDDSHeader describes a file
+    DDSTextureDesc MakeDesc( DXGI_FORMAT format, size_t size, const std::vector<uint8_t>& bits )
+    {
+        DDSTextureDesc desc;
+        memset( &desc, 0, sizeof(desc) );
+        desc.bitData = bits.empty() ? NULL : &bits[0];
+        desc.bitSize = bits.size();
+        desc.resDim = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+        desc.width = size;
+        desc.height = size;
+        desc.depth = 1;
+        desc.mipCount = 1;
+        desc.arraySize = 1;
+        desc.format = format;
+        return desc;
+    }
+
+    size_t CountTexels( const DecodedTexture& texture )
+    {
+        size_t texels = 0;
+        for (size_t i = 0; i < texture.mipCount * texture.arraySize; i++)
+        {
+            texels += texture.mips[i].width * texture.mips[i].height * texture.mips[i].depth;
+        }
+        return texels;
+    }
+
+    // Decodes until minSeconds have passed, at least twice, and returns the fastest pass in
+    // seconds, or a negative value on failure
+    double TimeDecode( const DDSTextureDesc& desc, unsigned int numThreads, unsigned int flags,
+                       double minSeconds, DecodedTexture& o_Texture )
+    {
+        double best = -1.0;
+        double total = 0.0;
+        for (unsigned int pass = 0; pass < 2 || total < minSeconds; pass++)
+        {
+            const double start = GetSeconds();
+            if (FAILED( DecodeDDSTexture( desc, numThreads, flags, o_Texture ) ))
+            {
+                return -1.0;
+            }
+            const double seconds = GetSeconds() - start;
+
+            total += seconds;
+            best = (best < 0.0) ? seconds : std::min( best, seconds );
+        }
+        return best;
+    }
+
+    bool IsSame( const DecodedTexture& a, const DecodedTexture& b )
+    {
+        return a.format == b.format && a.pixelBytes == b.pixelBytes
+            && 0 == memcmp( a.pixels.get(), b.pixels.get(), a.pixelBytes );
+    }
+
+    // Decodes a golden set with the given flags and returns the largest amount by which a
+    // channel is above the one Pillow decoded, or a negative value if one is below it or the
+    // decode fails
+    int CompareGolden( const BCDecodeGolden::GoldenSet& set, unsigned int flags )
+    {
+        const size_t blockBytes = BitsPerPixel( set.format ) * 2;
+        const size_t width = set.numBlocks * 4;
+        std::vector<uint8_t> decoded( width * 4 * 4 );
+        if (FAILED( DecodeBC( set.format, width, 4, set.blocks, set.numBlocks * blockBytes, &decoded[0], width * 4, flags ) ))
+        {
+            return -1;
+        }
+
+        int maxError = 0;
+        for (size_t texel = 0; texel < width * 4; texel++)
+        {
+            for (unsigned int c = 0; c < set.channels; c++)
+            {
+                const int error = (int)decoded[texel * 4 + c] - (int)set.texels[texel * set.channels + c];
+                if (error < 0)
+                {
+                    return -1;
+                }
+                maxError = std::max( maxError, error );
+            }
+        }
+        return maxError;
+    }
+
+    // Returns kExitOk or kExitMismatch
+    int VerifyGolden()
+    {
+        printf( "%-24s %10s %10s %10s\n", "", "ref error", "SSE2 error", "allowed" );
+
+        int result = kExitOk;
+        for (size_t s = 0; s < sizeof(BCDecodeGolden::kSets) / sizeof(BCDecodeGolden::kSets[0]); s++)
+        {
+            const BCDecodeGolden::GoldenSet& set = BCDecodeGolden::kSets[s];
+
+            // BC7 is exact; the others round where the golden decoder truncates
+            const int allowed = (DXGI_FORMAT_BC7_UNORM == set.format) ? 0 : 1;
+            const int referenceError = CompareGolden( set, BC_DECODE_REFERENCE );
+            const int error = CompareGolden( set, BC_DECODE_DEFAULT );
+            const bool same = referenceError >= 0 && referenceError <= allowed && error >= 0 && error <= allowed;
+
+            char name[64];
+            sprintf( name, "golden %s", set.name );
+            printf( "%-24s %10d %10d %10d   %s\n", name, referenceError, error, allowed, same ? "ok" : "MISMATCH" );
+            result = same ? result : kExitMismatch;
+        }
+
+        // A reserved BC7 mode, no bit set in the first byte, decodes to zeros
+        uint8_t reserved[16];
+        memset( reserved, 0xff, sizeof(reserved) );
+        reserved[0] = 0;
+
+        bool zeros = true;
+        for (unsigned int pass = 0; pass < 2; pass++)
+        {
+            uint8_t decoded[4 * 4 * 4];
+            zeros = zeros && SUCCEEDED( DecodeBC( DXGI_FORMAT_BC7_UNORM, 4, 4, reserved, sizeof(reserved), decoded, 16,
+                                                  pass ? BC_DECODE_DEFAULT : BC_DECODE_REFERENCE ) );
+            for (size_t i = 0; i < sizeof(decoded); i++)
+            {
+                zeros = zeros && (0 == decoded[i]);
+            }
+        }
+        printf( "%-24s %43s\n", "BC7 reserved mode", zeros ? "ok" : "MISMATCH" );
+        result = zeros ? result : kExitMismatch;
+
+        printf( "(golden texels decoded by %s)\n\n", BCDecodeGolden::kReference );
+        return result;
+    }
+
+    // Returns kExitOk, kExitMismatch or kExitError
+    int Measure( const char* name, const DDSTextureDesc& desc, const Options& options )
+    {
+        DecodedTexture reference, single, multi;
+        const double referenceSeconds = TimeDecode( desc, 1, BC_DECODE_REFERENCE, options.m_MinSeconds, reference );
+        const double singleSeconds = TimeDecode( desc, 1, BC_DECODE_DEFAULT, options.m_MinSeconds, single );
+        const double multiSeconds = TimeDecode( desc, options.m_NumThreads, BC_DECODE_DEFAULT, options.m_MinSeconds, multi );
+        if (referenceSeconds < 0.0 || singleSeconds < 0.0 || multiSeconds < 0.0)
+        {
+            fprintf( stderr, "error: can't decode %s\n", name );
+            return kExitError;
+        }
+
+        const bool same = IsSame( reference, single ) && IsSame( reference, multi );
+        const double megaTexels = (double)CountTexels( reference ) * 1e-6;
+        const double megaBytes = (double)desc.bitSize / (1024.0 * 1024.0);
+        printf( "%-24s %10.1f %10.1f %10.1f %10.1f   %s\n", name,
+                megaTexels / std::max( referenceSeconds, 1e-9 ),
+                megaTexels / std::max( singleSeconds, 1e-9 ),
+                megaTexels / std::max( multiSeconds, 1e-9 ),
+                megaBytes / std::max( multiSeconds, 1e-9 ),
+                same ? "ok" : "MISMATCH" );
+
+        return same ? kExitOk : kExitMismatch;
+    }
+
+    // Smooth gradients with a few hard edges and some noise, which is closer to what gets
+    // encoded than random texels. The top half is opaque; below, alpha is a gradient on the
+    // left and a noisy cutout on the right
+    std::vector<uint8_t> MakeEncodeImage( size_t size, Random& rng )
+    {
+        std::vector<uint8_t> texels( size * size * 4 );
+        for (size_t y = 0; y < size; y++)
+        {
+            for (size_t x = 0; x < size; x++)
+            {
+                const unsigned int noise = (unsigned int)(rng.Next() >> 32);
+                const bool edge = ((x / 24) + (y / 40)) % 3 == 0;
+                uint8_t* texel = &texels[(y * size + x) * 4];
+                texel[0] = (uint8_t)std::min<size_t>( 255, (x * 255) / size + ((noise >> 16) & 7) );
+                texel[1] = (uint8_t)(edge ? 255 - (y * 255) / size : (y * 255) / size);
+                texel[2] = (uint8_t)std::min<size_t>( 255, ((x + y) * 127) / size + (noise & 15) );
+                texel[3] = (uint8_t)((y < size / 2) ? 255 : (x < size / 2) ? (y * 255) / size : ((noise >> 8) & 1) ? 255 : 0);
+            }
+        }
+        return texels;
+    }
+
+    // Encodes until minSeconds have passed, at least twice, and returns the fastest pass in
+    // seconds, or a negative value on failure
+    double TimeEncode( DXGI_FORMAT format, const std::vector<uint8_t>& texels, size_t size, unsigned int numThreads,
+                       unsigned int flags, double minSeconds, EncodedTexture& o_Texture )
+    {
+        D3D11_SUBRESOURCE_DATA src;
+        src.pSysMem = &texels[0];
+        src.SysMemPitch = (UINT)(size * 4);
+        src.SysMemSlicePitch = (UINT)texels.size();
+
+        double best = -1.0;
+        double total = 0.0;
+        for (unsigned int pass = 0; pass < 2 || total < minSeconds; pass++)
+        {
+            const double start = GetSeconds();
+            if (FAILED( EncodeBCTexture( format, DXGI_FORMAT_R8G8B8A8_UNORM, size, size, 1, 1, &src, numThreads, flags, o_Texture ) ))
+            {
+                return -1.0;
+            }
+            const double seconds = GetSeconds() - start;
+
+            total += seconds;
+            best = (best < 0.0) ? seconds : std::min( best, seconds );
+        }
+        return best;
+    }
+
+    // The PSNR of the channels the format encodes, or a negative value on failure
+    double GetPSNR( const EncodeFormat& format, const std::vector<uint8_t>& texels, size_t size, const EncodedTexture& encoded )
+    {
+        std::vector<uint8_t> decoded( texels.size() );
+        if (FAILED( DecodeBC( encoded.format, size, size, encoded.bits.get(), encoded.mips[0].rowBytes,
+                              &decoded[0], size * 4, BC_DECODE_DEFAULT ) ))
+        {
+            return -1.0;
+        }
+
+        double error = 0.0;
+        size_t count = 0;
+        for (size_t i = 0; i < texels.size(); i++)
+        {
+            if (format.cutout && texels[(i & ~(size_t)3) + 3] < 128)
+            {
+                continue;
+            }
+
+            if (format.channels & (1u << (i % 4)))
+            {
+                const double d = (double)texels[i] - (double)decoded[i];
+                error += d * d;
+                count++;
+            }
+        }
+        return (error > 0.0) ? 10.0 * log10( 255.0 * 255.0 * (double)count / error ) : 99.0;
+    }
+
+    // Returns kExitOk, kExitMismatch or kExitError
+    int MeasureEncode( const EncodeFormat& format, unsigned int quality, const std::vector<uint8_t>& texels, size_t size,
+                       const Options& options )
+    {
+        EncodedTexture reference, single, multi;
+        const double referenceSeconds = TimeEncode( format.format, texels, size, 1, quality | BC_ENCODE_REFERENCE, options.m_MinSeconds, reference );
+        const double singleSeconds = TimeEncode( format.format, texels, size, 1, quality, options.m_MinSeconds, single );
+        const double multiSeconds = TimeEncode( format.format, texels, size, options.m_NumThreads, quality, options.m_MinSeconds, multi );
+        const double psnr = (multiSeconds < 0.0) ? -1.0 : GetPSNR( format, texels, size, multi );
+        if (referenceSeconds < 0.0 || singleSeconds < 0.0 || multiSeconds < 0.0 || psnr < 0.0)
+        {
+            fprintf( stderr, "error: can't encode %s\n", format.name );
+            return kExitError;
+        }
+
+        const bool same = reference.bitSize == single.bitSize && reference.bitSize == multi.bitSize
+            && 0 == memcmp( reference.bits.get(), single.bits.get(), reference.bitSize )
+            && 0 == memcmp( reference.bits.get(), multi.bits.get(), reference.bitSize );
+
+        char name[64];
+        sprintf( name, "encode %s %s", format.name, kQualityNames[quality] );
+
+        const double megaTexels = (double)(size * size) * 1e-6;
+        printf( "%-24s %10.1f %10.1f %10.1f %10.1f   %s\n", name,
+                megaTexels / std::max( referenceSeconds, 1e-9 ),
+                megaTexels / std::max( singleSeconds, 1e-9 ),
+                megaTexels / std::max( multiSeconds, 1e-9 ),
+                psnr,
+                same ? "ok" : "MISMATCH" );
+
+        return same ? kExitOk : kExitMismatch;
+    }
+
+    // Generates mips until minSeconds have passed, at least twice, and returns the fastest
+    // pass in seconds, or a negative value on failure
+    double TimeMips( const std::vector<uint8_t>& texels, size_t size, unsigned int numThreads, unsigned int flags,
+                     double minSeconds, MipChain& o_Chain )
+    {
+        double best = -1.0;
+        double total = 0.0;
+        for (unsigned int pass = 0; pass < 2 || total < minSeconds; pass++)
+        {
+            const double start = GetSeconds();
+            if (FAILED( GenerateMipChain( DXGI_FORMAT_R8G8B8A8_UNORM, size, size, &texels[0], size * 4, 0, numThreads, flags, o_Chain ) ))
+            {
+                return -1.0;
+            }
+            const double seconds = GetSeconds() - start;
+
+            total += seconds;
+            best = (best < 0.0) ? seconds : std::min( best, seconds );
+        }
+        return best;
+    }
+
+    // The percentage of texels of a mip with alpha of at least 128
+    double GetCoverage( const MipChain& chain, size_t mip )
+    {
+        const size_t width = std::max<size_t>( chain.width >> mip, 1 );
+        const size_t height = std::max<size_t>( chain.height >> mip, 1 );
+        const uint8_t* texels = (const uint8_t*)chain.mips[mip].pSysMem;
+
+        size_t covered = 0;
+        for (size_t i = 0; i < width * height; i++)
+        {
+            covered += (texels[i * 4 + 3] >= 128) ? 1 : 0;
+        }
+        return 100.0 * (double)covered / (double)(width * height);
+    }
+
+    // Returns kExitOk, kExitMismatch or kExitError
+    int MeasureMips( const MipFilter& filter, const std::vector<uint8_t>& texels, size_t size, const Options& options )
+    {
+        MipChain reference, single, multi;
+        const double referenceSeconds = TimeMips( texels, size, 1, filter.flags | MIPGEN_REFERENCE, options.m_MinSeconds, reference );
+        const double singleSeconds = TimeMips( texels, size, 1, filter.flags, options.m_MinSeconds, single );
+        const double multiSeconds = TimeMips( texels, size, options.m_NumThreads, filter.flags, options.m_MinSeconds, multi );
+        if (referenceSeconds < 0.0 || singleSeconds < 0.0 || multiSeconds < 0.0 || multi.mipCount <= kCoverageMip)
+        {
+            fprintf( stderr, "error: can't generate %s\n", filter.name );
+            return kExitError;
+        }
+
+        const bool same = reference.bitSize == single.bitSize && reference.bitSize == multi.bitSize
+            && 0 == memcmp( reference.bits.get(), single.bits.get(), reference.bitSize )
+            && 0 == memcmp( reference.bits.get(), multi.bits.get(), reference.bitSize );
+
+        const double megaTexels = (double)(size * size) * 1e-6;
+        printf( "%-24s %10.1f %10.1f %10.1f %10.1f   %s\n", filter.name,
+                megaTexels / std::max( referenceSeconds, 1e-9 ),
+                megaTexels / std::max( singleSeconds, 1e-9 ),
+                megaTexels / std::max( multiSeconds, 1e-9 ),
+                GetCoverage( multi, kCoverageMip ),
+                same ? "ok" : "MISMATCH" );
+
+        return same ? kExitOk : kExitMismatch;
+    }
+}
+
+int main( int argc, char** argv )
+{
+    Options options;
+    bool random = true;
+    if (!ParseOptions( argc, argv, options, random ))
+    {
+        PrintUsage();
+        return kExitError;
+    }
+
+    int result = VerifyGolden();
+
+    printf( "%-24s %10s %10s %10s %10s\n", "", "ref Mtex/s", "1T Mtex/s", "MT Mtex/s", "MT MB/s" );
+
+    if (random)
+    {
+        Random rng( options.m_Seed );
+        for (size_t f = 0; f < sizeof(kFormats) / sizeof(kFormats[0]); f++)
+        {
+            const size_t blocks = (options.m_Size + 3) / 4;
+            const size_t blockBytes = BitsPerPixel( kFormats[f].format ) * 2;
+            std::vector<uint8_t> bits( blocks * blocks * blockBytes );
+            for (size_t i = 0; i < bits.size(); i++)
+            {
+                bits[i] = (uint8_t)(rng.Next() >> 56);
+            }
+
+            const int status = Measure( kFormats[f].name, MakeDesc( kFormats[f].format, options.m_Size, bits ), options );
+            result = std::max( result, status );
+        }
+    }
+
+    for (size_t i = 0; i < options.m_Files.size(); i++)
+    {
+        const char* fileName = options.m_Files[i];
+        wchar_t wideName[1024];
+        if (mbstowcs( wideName, fileName, 1024 ) >= 1024)
+        {
+            fprintf( stderr, "error: file name too long: %s\n", fileName );
+            result = kExitError;
+            continue;
+        }
+
+        MappedFile file;
+        DDSTextureDesc desc;
+        if (FAILED( file.Open( wideName ) ) || FAILED( ParseDDSHeader( file.data(), file.size(), desc ) ))
+        {
+            fprintf( stderr, "error: can't read %s\n", fileName );
+            result = kExitError;
+            continue;
+        }
+
+        if (DXGI_FORMAT_UNKNOWN == GetBCDecodedFormat( desc.format ))
+        {
+            printf( "%-24s not block compressed, skipped\n", fileName );
+            continue;
+        }
+
+        const char* name = strrchr( fileName, '/' );
+        const char* backslash = strrchr( fileName, '\\' );
+        name = std::max( name ? name + 1 : fileName, backslash ? backslash + 1 : fileName );
+        result = std::max( result, Measure( name, desc, options ) );
+    }
+
+    if (options.m_Encode)
+    {
+        printf( "\n%-24s %10s %10s %10s %10s\n", "", "ref Mtex/s", "1T Mtex/s", "MT Mtex/s", "PSNR dB" );
+
+        Random rng( options.m_Seed );
+        const std::vector<uint8_t> texels = MakeEncodeImage( kEncodeSize, rng );
+        for (size_t f = 0; f < sizeof(kEncodeFormats) / sizeof(kEncodeFormats[0]); f++)
+        {
+            for (unsigned int quality = BC_ENCODE_FAST; quality <= BC_ENCODE_HIGH; quality++)
+            {
+                result = std::max( result, MeasureEncode( kEncodeFormats[f], quality, texels, kEncodeSize, options ) );
+            }
+        }
+    }
+
+    if (options.m_Mips)
+    {
+        Random rng( options.m_Seed );
+        const std::vector<uint8_t> texels = MakeEncodeImage( options.m_Size, rng );
+
+        size_t covered = 0;
+        for (size_t i = 3; i < texels.size(); i += 4)
+        {
+            covered += (texels[i] >= 128) ? 1 : 0;
+        }
+
+        char coverage[32];
+        sprintf( coverage, "mip%u cov%%", (unsigned int)kCoverageMip );
+        printf( "\n%-24s %10s %10s %10s %10s\n", "", "ref Mtex/s", "1T Mtex/s", "MT Mtex/s", coverage );
+        printf( "%-24s %43.1f\n", "top mip coverage", 100.0 * (double)covered / (double)(options.m_Size * options.m_Size) );
+
+        for (size_t f = 0; f < sizeof(kMipFilters) / sizeof(kMipFilters[0]); f++)
+        {
+            result = std::max( result, MeasureMips( kMipFilters[f], texels, options.m_Size, options ) );
+        }
+    }
+
+    return result;
+}
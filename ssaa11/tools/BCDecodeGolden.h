@@ -0,0 +1,274 @@
+//--------------------------------------------------------------------------------------
+// File: BCDecodeGolden.h
+//
+// Generated by MakeBCDecodeGolden.py with Pillow 12.3.0; don't edit.
+//
+// Blocks of each format and the texels Pillow decodes them to, row by row over a strip
+// one block high, with only the channels Pillow returns: R for BC4, RGB for BC5.
+//--------------------------------------------------------------------------------------
+#pragma once
+
+namespace BCDecodeGolden
+{
+    const char* const kReference = "Pillow 12.3.0";
+
+    const uint8_t kBC1Blocks[] =
+    {
+        0x22, 0x91, 0xd8, 0xcd, 0xc3, 0x10, 0x41, 0x1e,
+        0x7e, 0xc2, 0x73, 0x78, 0xa6, 0x61, 0xc9, 0x35,
+        0x18, 0x7c, 0x07, 0xe4, 0xd5, 0x63, 0x6e, 0x9b,
+        0xc3, 0xc4, 0x00, 0xb2, 0x72, 0x44, 0xb8, 0xcd,
+        0x3a, 0x97, 0xf1, 0x1a, 0xe6, 0x51, 0x07, 0x05,
+        0x06, 0xa6, 0x8a, 0x02, 0xf0, 0xe1, 0x61, 0xaf,
+        0x37, 0xf8, 0x6c, 0xb9, 0x07, 0x87, 0x38, 0xc3,
+        0x70, 0xf0, 0x7e, 0x8d, 0x3b, 0x58, 0x3b, 0xad,
+        0x38, 0xc2, 0x75, 0xf3, 0x4a, 0xed, 0x05, 0x6a,
+        0xd6, 0xea, 0x8e, 0xec, 0xa4, 0x19, 0x2f, 0xa1,
+        0xfe, 0xb9, 0xdc, 0x4b, 0x1e, 0xbe, 0x55, 0xe5,
+        0xb8, 0xf9, 0xb6, 0x80, 0xef, 0xf7, 0x6c, 0x81,
+        0xd4, 0xe9, 0xab, 0x30, 0x4d, 0x48, 0x96, 0xf9,
+        0xe1, 0x7f, 0xd8, 0xf0, 0x81, 0x64, 0x96, 0xda,
+        0x08, 0x7a, 0x3e, 0xbe, 0xcc, 0x67, 0x6a, 0xaa,
+        0x2c, 0x5d, 0x8c, 0xe1, 0xb3, 0xc6, 0xac, 0xbc,
+    };
+
+    const uint8_t kBC1Texels[] =
+    {
+        0x00, 0x00, 0x00, 0x00, 0x94, 0x24, 0x10, 0xff, 0x94, 0x24, 0x10, 0xff, 0x00, 0x00, 0x00, 0x00, 0xad, 0x37, 0xd8, 0xff, 0x7b, 0x0c, 0x9c, 0xff, 0xad, 0x37, 0xd8, 0xff, 0xad, 0x37, 0xd8, 0xff, 0xe7, 0x82, 0x39, 0xff, 0xe7, 0x82, 0x39, 0xff, 0xe7, 0x82, 0x39, 0xff, 0x00, 0x00, 0x00, 0x00, 0xc0, 0x7c, 0x10, 0xff, 0xc6, 0x9a, 0x18, 0xff, 0xba, 0x5e, 0x08, 0xff, 0xb5, 0x41, 0x00, 0xff,
+        0x6a, 0xb9, 0xbd, 0xff, 0x18, 0x5d, 0x8c, 0xff, 0x6a, 0xb9, 0xbd, 0xff, 0x41, 0x8b, 0xa4, 0xff, 0xa5, 0xc3, 0x31, 0xff, 0xa5, 0xc3, 0x31, 0xff, 0x37, 0x77, 0x47, 0xff, 0x37, 0x77, 0x47, 0xff, 0xd3, 0x1e, 0x81, 0xff, 0xbd, 0x2c, 0x63, 0xff, 0xff, 0x04, 0xbd, 0xff, 0xff, 0x04, 0xbd, 0xff, 0xaf, 0x78, 0xd0, 0xff, 0xd3, 0x42, 0xaa, 0xff, 0xaf, 0x78, 0xd0, 0xff, 0xf7, 0x0c, 0x84, 0xff,
+        0xde, 0x59, 0xb9, 0xff, 0xde, 0x59, 0xb9, 0xff, 0xc6, 0x45, 0xc6, 0xff, 0xf7, 0x6d, 0xad, 0xff, 0xef, 0x59, 0xb5, 0xff, 0xef, 0x92, 0x73, 0xff, 0xef, 0x75, 0x94, 0xff, 0xef, 0x75, 0x94, 0xff, 0x96, 0x50, 0xf1, 0xff, 0x70, 0x64, 0xec, 0xff, 0x4a, 0x79, 0xe7, 0xff, 0xbd, 0x3c, 0xf7, 0xff, 0xad, 0x1e, 0xba, 0xff, 0xad, 0x1e, 0xba, 0xff, 0xd6, 0x29, 0xc0, 0xff, 0xad, 0x1e, 0xba, 0xff,
+        0x31, 0x14, 0x5a, 0xff, 0x70, 0x20, 0x73, 0xff, 0xef, 0x38, 0xa5, 0xff, 0x31, 0x14, 0x5a, 0xff, 0xf7, 0x18, 0xc6, 0xff, 0x7b, 0xff, 0x08, 0xff, 0x7b, 0xff, 0x08, 0xff, 0xb9, 0x8b, 0x67, 0xff, 0x7b, 0x41, 0x42, 0xff, 0x00, 0x00, 0x00, 0x00, 0x7b, 0x41, 0x42, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x5a, 0xa6, 0x63, 0xff, 0x00, 0x00, 0x00, 0x00, 0xa0, 0x6b, 0x63, 0xff,
+        0x94, 0x24, 0x10, 0xff, 0x94, 0x24, 0x10, 0xff, 0xce, 0xba, 0xc6, 0xff, 0x94, 0x24, 0x10, 0xff, 0x7b, 0x0c, 0x9c, 0xff, 0xc6, 0x4d, 0xf7, 0xff, 0xad, 0x37, 0xd8, 0xff, 0x7b, 0x0c, 0x9c, 0xff, 0x00, 0x00, 0x00, 0x00, 0x7b, 0x82, 0xc6, 0xff, 0xb1, 0x82, 0x7f, 0xff, 0xe7, 0x82, 0x39, 0xff, 0xc6, 0x9a, 0x18, 0xff, 0xb5, 0x41, 0x00, 0xff, 0xc6, 0x9a, 0x18, 0xff, 0xb5, 0x41, 0x00, 0xff,
+        0x18, 0x5d, 0x8c, 0xff, 0x94, 0xe7, 0xd6, 0xff, 0x18, 0x5d, 0x8c, 0xff, 0x18, 0x5d, 0x8c, 0xff, 0x00, 0x51, 0x52, 0xff, 0xa5, 0xc3, 0x31, 0xff, 0x6e, 0x9d, 0x3c, 0xff, 0x37, 0x77, 0x47, 0xff, 0xd3, 0x1e, 0x81, 0xff, 0xbd, 0x2c, 0x63, 0xff, 0xff, 0x04, 0xbd, 0xff, 0xe9, 0x11, 0x9f, 0xff, 0xf7, 0x0c, 0x84, 0xff, 0xd3, 0x42, 0xaa, 0xff, 0x8c, 0xae, 0xf7, 0xff, 0x8c, 0xae, 0xf7, 0xff,
+        0xf7, 0x6d, 0xad, 0xff, 0x00, 0x00, 0x00, 0x00, 0xde, 0x59, 0xb9, 0xff, 0x00, 0x00, 0x00, 0x00, 0xef, 0x92, 0x73, 0xff, 0xef, 0x75, 0x94, 0xff, 0xef, 0x92, 0x73, 0xff, 0xef, 0x59, 0xb5, 0xff, 0x96, 0x50, 0xf1, 0xff, 0x70, 0x64, 0xec, 0xff, 0x70, 0x64, 0xec, 0xff, 0x96, 0x50, 0xf1, 0xff, 0xad, 0x1e, 0xba, 0xff, 0x84, 0x14, 0xb5, 0xff, 0xad, 0x1e, 0xba, 0xff, 0xad, 0x1e, 0xba, 0xff,
+        0xef, 0x38, 0xa5, 0xff, 0xaf, 0x2c, 0x8c, 0xff, 0xef, 0x38, 0xa5, 0xff, 0x31, 0x14, 0x5a, 0xff, 0x7b, 0xff, 0x08, 0xff, 0xf7, 0x18, 0xc6, 0xff, 0xb9, 0x8b, 0x67, 0xff, 0xf7, 0x18, 0xc6, 0xff, 0x00, 0x00, 0x00, 0x00, 0xbd, 0xc7, 0xf7, 0xff, 0x9c, 0x84, 0x9c, 0xff, 0xbd, 0xc7, 0xf7, 0xff, 0xa0, 0x6b, 0x63, 0xff, 0xe7, 0x30, 0x63, 0xff, 0x5a, 0xa6, 0x63, 0xff, 0x00, 0x00, 0x00, 0x00,
+        0xce, 0xba, 0xc6, 0xff, 0x94, 0x24, 0x10, 0xff, 0x94, 0x24, 0x10, 0xff, 0xce, 0xba, 0xc6, 0xff, 0x7b, 0x0c, 0x9c, 0xff, 0xad, 0x37, 0xd8, 0xff, 0xc6, 0x4d, 0xf7, 0xff, 0x94, 0x21, 0xba, 0xff, 0xb1, 0x82, 0x7f, 0xff, 0x00, 0x00, 0x00, 0x00, 0xb1, 0x82, 0x7f, 0xff, 0xe7, 0x82, 0x39, 0xff, 0xc6, 0x9a, 0x18, 0xff, 0xc0, 0x7c, 0x10, 0xff, 0xba, 0x5e, 0x08, 0xff, 0xc0, 0x7c, 0x10, 0xff,
+        0x41, 0x8b, 0xa4, 0xff, 0x18, 0x5d, 0x8c, 0xff, 0x94, 0xe7, 0xd6, 0xff, 0x94, 0xe7, 0xd6, 0xff, 0x00, 0x51, 0x52, 0xff, 0xa5, 0xc3, 0x31, 0xff, 0x6e, 0x9d, 0x3c, 0xff, 0x00, 0x51, 0x52, 0xff, 0xff, 0x04, 0xbd, 0xff, 0xe9, 0x11, 0x9f, 0xff, 0xd3, 0x1e, 0x81, 0xff, 0xff, 0x04, 0xbd, 0xff, 0xaf, 0x78, 0xd0, 0xff, 0xd3, 0x42, 0xaa, 0xff, 0xaf, 0x78, 0xd0, 0xff, 0xf7, 0x0c, 0x84, 0xff,
+        0xf7, 0x6d, 0xad, 0xff, 0xf7, 0x6d, 0xad, 0xff, 0xc6, 0x45, 0xc6, 0xff, 0xc6, 0x45, 0xc6, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xef, 0x75, 0x94, 0xff, 0xef, 0x59, 0xb5, 0xff, 0x4a, 0x79, 0xe7, 0xff, 0x4a, 0x79, 0xe7, 0xff, 0x4a, 0x79, 0xe7, 0xff, 0x4a, 0x79, 0xe7, 0xff, 0xff, 0x34, 0xc6, 0xff, 0xad, 0x1e, 0xba, 0xff, 0xd6, 0x29, 0xc0, 0xff, 0x84, 0x14, 0xb5, 0xff,
+        0xaf, 0x2c, 0x8c, 0xff, 0x31, 0x14, 0x5a, 0xff, 0x31, 0x14, 0x5a, 0xff, 0xaf, 0x2c, 0x8c, 0xff, 0xb9, 0x8b, 0x67, 0xff, 0xf7, 0x18, 0xc6, 0xff, 0xf7, 0x18, 0xc6, 0xff, 0xb9, 0x8b, 0x67, 0xff, 0x9c, 0x84, 0x9c, 0xff, 0x9c, 0x84, 0x9c, 0xff, 0x9c, 0x84, 0x9c, 0xff, 0xbd, 0xc7, 0xf7, 0xff, 0x5a, 0xa6, 0x63, 0xff, 0x00, 0x00, 0x00, 0x00, 0xa0, 0x6b, 0x63, 0xff, 0xa0, 0x6b, 0x63, 0xff,
+        0xb1, 0x6f, 0x6b, 0xff, 0x00, 0x00, 0x00, 0x00, 0xce, 0xba, 0xc6, 0xff, 0x94, 0x24, 0x10, 0xff, 0x7b, 0x0c, 0x9c, 0xff, 0x7b, 0x0c, 0x9c, 0xff, 0x94, 0x21, 0xba, 0xff, 0xc6, 0x4d, 0xf7, 0xff, 0x00, 0x00, 0x00, 0x00, 0xb1, 0x82, 0x7f, 0xff, 0xe7, 0x82, 0x39, 0xff, 0xb1, 0x82, 0x7f, 0xff, 0xb5, 0x41, 0x00, 0xff, 0xba, 0x5e, 0x08, 0xff, 0xc6, 0x9a, 0x18, 0xff, 0xba, 0x5e, 0x08, 0xff,
+        0x18, 0x5d, 0x8c, 0xff, 0x18, 0x5d, 0x8c, 0xff, 0x94, 0xe7, 0xd6, 0xff, 0x94, 0xe7, 0xd6, 0xff, 0x37, 0x77, 0x47, 0xff, 0x37, 0x77, 0x47, 0xff, 0x6e, 0x9d, 0x3c, 0xff, 0x6e, 0x9d, 0x3c, 0xff, 0xd3, 0x1e, 0x81, 0xff, 0xff, 0x04, 0xbd, 0xff, 0xff, 0x04, 0xbd, 0xff, 0xd3, 0x1e, 0x81, 0xff, 0x8c, 0xae, 0xf7, 0xff, 0xaf, 0x78, 0xd0, 0xff, 0xd3, 0x42, 0xaa, 0xff, 0xd3, 0x42, 0xaa, 0xff,
+        0xde, 0x59, 0xb9, 0xff, 0xde, 0x59, 0xb9, 0xff, 0xde, 0x59, 0xb9, 0xff, 0xf7, 0x6d, 0xad, 0xff, 0xef, 0x92, 0x73, 0xff, 0xef, 0x59, 0xb5, 0xff, 0xef, 0x75, 0x94, 0xff, 0xef, 0x75, 0x94, 0xff, 0x4a, 0x79, 0xe7, 0xff, 0x4a, 0x79, 0xe7, 0xff, 0x96, 0x50, 0xf1, 0xff, 0x70, 0x64, 0xec, 0xff, 0x84, 0x14, 0xb5, 0xff, 0xff, 0x34, 0xc6, 0xff, 0xff, 0x34, 0xc6, 0xff, 0xd6, 0x29, 0xc0, 0xff,
+        0x31, 0x14, 0x5a, 0xff, 0xaf, 0x2c, 0x8c, 0xff, 0x70, 0x20, 0x73, 0xff, 0x70, 0x20, 0x73, 0xff, 0xb9, 0x8b, 0x67, 0xff, 0xb9, 0x8b, 0x67, 0xff, 0xf7, 0x18, 0xc6, 0xff, 0x00, 0x00, 0x00, 0x00, 0x9c, 0x84, 0x9c, 0xff, 0x9c, 0x84, 0x9c, 0xff, 0x9c, 0x84, 0x9c, 0xff, 0x9c, 0x84, 0x9c, 0xff, 0x5a, 0xa6, 0x63, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa0, 0x6b, 0x63, 0xff,
+    };
+
+    const uint8_t kBC2Blocks[] =
+    {
+        0x5f, 0x16, 0x70, 0xa9, 0x82, 0x1b, 0xc7, 0x29, 0x85, 0xd7, 0x64, 0x5e, 0x7d, 0xbb, 0x07, 0x78,
+        0x0b, 0x4e, 0xb4, 0xd9, 0xfb, 0x9d, 0x97, 0x94, 0x64, 0xa5, 0x2b, 0x2b, 0x80, 0x3a, 0xfb, 0x03,
+        0xc5, 0x33, 0x8a, 0xeb, 0xdc, 0x8c, 0x3b, 0x67, 0x83, 0x58, 0xf3, 0xd8, 0x93, 0x5a, 0x75, 0xe8,
+        0x44, 0xa8, 0x8c, 0x9b, 0xf5, 0xba, 0x01, 0x62, 0xc8, 0xdb, 0xd2, 0xf4, 0xe2, 0xf0, 0xbd, 0x83,
+        0xcf, 0x21, 0x84, 0xc7, 0x8f, 0x34, 0x6d, 0xf3, 0x0e, 0x7b, 0xde, 0x5d, 0x91, 0x8d, 0x33, 0xf0,
+        0x81, 0x69, 0x7c, 0xd0, 0x5b, 0x6a, 0x58, 0x00, 0x89, 0x8a, 0x9f, 0xc9, 0x9c, 0x54, 0x75, 0x99,
+        0x07, 0xcd, 0x3a, 0xa2, 0x2d, 0x8c, 0x95, 0x2e, 0xdc, 0x17, 0xcc, 0x8d, 0xcc, 0xd9, 0xd1, 0xee,
+        0x41, 0x08, 0xd7, 0xf1, 0xac, 0x12, 0x15, 0xde, 0x04, 0x73, 0x03, 0xc1, 0xc1, 0x47, 0x3f, 0x44,
+        0x1c, 0xcc, 0x9f, 0x2f, 0x58, 0x4a, 0x11, 0x2a, 0x28, 0x41, 0x87, 0xf3, 0x2b, 0xa8, 0x45, 0xa5,
+        0xb6, 0x4b, 0x74, 0xb3, 0x52, 0x7f, 0x79, 0x1d, 0x06, 0x4f, 0x62, 0x57, 0x6b, 0xcb, 0x30, 0x42,
+        0x1b, 0x40, 0xe6, 0xba, 0x82, 0xfa, 0x35, 0xf7, 0x9b, 0x6e, 0xd1, 0xf9, 0x05, 0x39, 0x04, 0x65,
+        0x25, 0x09, 0xb8, 0xf5, 0x29, 0x72, 0xb4, 0x81, 0xad, 0x6d, 0x8b, 0xd5, 0x38, 0xfa, 0xf9, 0xa1,
+        0xcc, 0xb1, 0x84, 0x73, 0x39, 0x86, 0xa6, 0x07, 0x65, 0xac, 0x93, 0xcd, 0x52, 0xa8, 0xa1, 0x6d,
+        0x0f, 0xbc, 0x4c, 0x20, 0xf7, 0x36, 0xe0, 0x0c, 0x4e, 0x12, 0xdb, 0x13, 0x4f, 0xea, 0xf0, 0x4c,
+        0xbe, 0x28, 0x6a, 0x90, 0x40, 0x21, 0x02, 0x8f, 0xe0, 0xd9, 0x09, 0x97, 0xd1, 0x37, 0xf6, 0xe6,
+        0x91, 0x75, 0x2b, 0xd3, 0xde, 0xde, 0xf9, 0xc7, 0xb4, 0x9f, 0x82, 0x09, 0x60, 0x33, 0x58, 0x19,
+    };
+
+    const uint8_t kBC2Texels[] =
+    {
+        0x5a, 0xcf, 0x21, 0xff, 0x83, 0xdb, 0x23, 0x55, 0x83, 0xdb, 0x23, 0x66, 0x5a, 0xcf, 0x21, 0x11, 0xa5, 0xae, 0x21, 0xbb, 0xa5, 0xae, 0x21, 0x00, 0xa5, 0xae, 0x21, 0xee, 0x7b, 0x95, 0x34, 0x44, 0xb2, 0x18, 0x70, 0x55, 0x5a, 0x10, 0x18, 0xcc, 0xde, 0x1c, 0x9c, 0x33, 0x86, 0x14, 0x44, 0x33, 0xe6, 0x84, 0x5d, 0x44, 0xde, 0x79, 0x42, 0x44, 0xe6, 0x84, 0x5d, 0x88, 0xee, 0x8f, 0x78, 0xaa,
+        0x5a, 0xba, 0xf7, 0xff, 0x7b, 0x61, 0x73, 0xcc, 0x5a, 0xba, 0xf7, 0x11, 0x70, 0x7e, 0x9f, 0x22, 0x8c, 0x51, 0x4a, 0x11, 0xb8, 0x3b, 0xc2, 0x88, 0xce, 0x30, 0xff, 0x99, 0xa2, 0x46, 0x86, 0x66, 0x10, 0xfb, 0xe7, 0x77, 0x62, 0xcf, 0x8f, 0x00, 0x10, 0xfb, 0xe7, 0xdd, 0x62, 0xcf, 0x8f, 0xcc, 0xc6, 0x20, 0x18, 0x11, 0x73, 0x61, 0x21, 0x44, 0x73, 0x61, 0x21, 0x88, 0xaa, 0x35, 0x1b, 0x00,
+        0xba, 0x57, 0x3c, 0xcc, 0x7e, 0x3d, 0x3f, 0x11, 0x7e, 0x3d, 0x3f, 0xcc, 0x42, 0x24, 0x42, 0xcc, 0x4f, 0xeb, 0x1b, 0x66, 0x4c, 0xe7, 0x26, 0xbb, 0x4c, 0xe7, 0x26, 0xbb, 0x52, 0xef, 0x10, 0x44, 0xff, 0x38, 0x8c, 0xbb, 0xff, 0x38, 0x8c, 0x11, 0x6b, 0xd3, 0xde, 0x00, 0x6b, 0xd3, 0xde, 0x44, 0x6b, 0xb6, 0x6b, 0x55, 0x8e, 0xb4, 0x65, 0x22, 0xb2, 0xb3, 0x5f, 0x99, 0x6b, 0xb6, 0x6b, 0x00,
+        0xb8, 0x9a, 0x4f, 0xcc, 0xad, 0x8e, 0x29, 0xcc, 0xce, 0xb2, 0x9c, 0x11, 0xce, 0xb2, 0x9c, 0xbb, 0x10, 0x69, 0xba, 0xff, 0x10, 0x69, 0xba, 0x00, 0x10, 0x49, 0x73, 0xcc, 0x10, 0x79, 0xde, 0xbb, 0x94, 0xe3, 0x4a, 0xee, 0xde, 0x3c, 0x00, 0xbb, 0x94, 0xe3, 0x4a, 0x88, 0xac, 0xab, 0x31, 0x22, 0x9c, 0xf7, 0xa5, 0x11, 0x9c, 0xf7, 0xa5, 0x99, 0x6a, 0xb4, 0x73, 0x55, 0x08, 0x30, 0x10, 0x77,
+        0x83, 0xdb, 0x23, 0x00, 0xac, 0xe7, 0x26, 0x77, 0x83, 0xdb, 0x23, 0x99, 0xac, 0xe7, 0x26, 0xaa, 0x7b, 0x95, 0x34, 0x44, 0x7b, 0x95, 0x34, 0xbb, 0x52, 0x7d, 0x47, 0x99, 0xa5, 0xae, 0x21, 0xdd, 0x86, 0x14, 0x44, 0xaa, 0x86, 0x14, 0x44, 0x88, 0xde, 0x1c, 0x9c, 0xbb, 0xde, 0x1c, 0x9c, 0xee, 0xde, 0x79, 0x42, 0xcc, 0xde, 0x79, 0x42, 0x88, 0xee, 0x8f, 0x78, 0xbb, 0xee, 0x8f, 0x78, 0x99,
+        0x5a, 0xba, 0xf7, 0x44, 0x65, 0x9c, 0xcb, 0x88, 0x7b, 0x61, 0x73, 0x77, 0x70, 0x7e, 0x9f, 0xcc, 0x8c, 0x51, 0x4a, 0xcc, 0xce, 0x30, 0xff, 0x77, 0xce, 0x30, 0xff, 0x00, 0xce, 0x30, 0xff, 0xdd, 0x8c, 0xba, 0x63, 0xaa, 0x39, 0xe5, 0xbb, 0x33, 0x8c, 0xba, 0x63, 0x22, 0x62, 0xcf, 0x8f, 0xaa, 0xaa, 0x35, 0x1b, 0x77, 0xc6, 0x20, 0x18, 0xdd, 0x73, 0x61, 0x21, 0x11, 0xc6, 0x20, 0x18, 0xff,
+        0x42, 0x24, 0x42, 0xff, 0x7e, 0x3d, 0x3f, 0x99, 0x7e, 0x3d, 0x3f, 0xff, 0x7e, 0x3d, 0x3f, 0x22, 0x4f, 0xeb, 0x1b, 0x44, 0x4c, 0xe7, 0x26, 0x77, 0x4a, 0xe3, 0x31, 0x33, 0x4f, 0xeb, 0x1b, 0xbb, 0xff, 0x38, 0x8c, 0x66, 0x9c, 0x9f, 0xc2, 0xee, 0xcd, 0x6b, 0xa7, 0xaa, 0x6b, 0xd3, 0xde, 0xbb, 0x8e, 0xb4, 0x65, 0x88, 0x8e, 0xb4, 0x65, 0xbb, 0xb2, 0xb3, 0x5f, 0x55, 0xb2, 0xb3, 0x5f, 0xff,
+        0xad, 0x8e, 0x29, 0x44, 0xb8, 0x9a, 0x4f, 0x88, 0xb8, 0x9a, 0x4f, 0x33, 0xb8, 0x9a, 0x4f, 0x77, 0x10, 0x59, 0x96, 0xcc, 0x10, 0x59, 0x96, 0x44, 0x10, 0x59, 0x96, 0x00, 0x10, 0x69, 0xba, 0x22, 0xac, 0xab, 0x31, 0xaa, 0x94, 0xe3, 0x4a, 0x66, 0xac, 0xab, 0x31, 0x00, 0xde, 0x3c, 0x00, 0x99, 0x39, 0x72, 0x41, 0xbb, 0x9c, 0xf7, 0xa5, 0x22, 0x39, 0x72, 0x41, 0x33, 0x9c, 0xf7, 0xa5, 0xdd,
+        0x83, 0xdb, 0x23, 0x22, 0x5a, 0xcf, 0x21, 0x88, 0xd6, 0xf3, 0x29, 0xbb, 0xd6, 0xf3, 0x29, 0x11, 0x52, 0x7d, 0x47, 0xbb, 0x7b, 0x95, 0x34, 0xff, 0x52, 0x7d, 0x47, 0xdd, 0x52, 0x7d, 0x47, 0x99, 0xde, 0x1c, 0x9c, 0xcc, 0xde, 0x1c, 0x9c, 0xdd, 0xb2, 0x18, 0x70, 0xcc, 0xde, 0x1c, 0x9c, 0x88, 0xf7, 0x9a, 0x94, 0x55, 0xee, 0x8f, 0x78, 0xff, 0xee, 0x8f, 0x78, 0xaa, 0xe6, 0x84, 0x5d, 0xbb,
+        0x65, 0x9c, 0xcb, 0xff, 0x7b, 0x61, 0x73, 0x88, 0x65, 0x9c, 0xcb, 0x44, 0x7b, 0x61, 0x73, 0x33, 0xce, 0x30, 0xff, 0xbb, 0xce, 0x30, 0xff, 0x55, 0xb8, 0x3b, 0xc2, 0xaa, 0xce, 0x30, 0xff, 0x66, 0x8c, 0xba, 0x63, 0xdd, 0x10, 0xfb, 0xe7, 0x22, 0x8c, 0xba, 0x63, 0xcc, 0x62, 0xcf, 0x8f, 0x88, 0xaa, 0x35, 0x1b, 0xcc, 0xaa, 0x35, 0x1b, 0xaa, 0xaa, 0x35, 0x1b, 0x22, 0x73, 0x61, 0x21, 0x11,
+        0xf7, 0x71, 0x39, 0x88, 0xf7, 0x71, 0x39, 0x55, 0x42, 0x24, 0x42, 0xaa, 0xf7, 0x71, 0x39, 0x44, 0x4a, 0xe3, 0x31, 0x22, 0x4a, 0xe3, 0x31, 0x55, 0x4f, 0xeb, 0x1b, 0xff, 0x4a, 0xe3, 0x31, 0x77, 0x6b, 0xd3, 0xde, 0x22, 0xff, 0x38, 0x8c, 0x88, 0x6b, 0xd3, 0xde, 0xaa, 0x6b, 0xd3, 0xde, 0xff, 0xd6, 0xb2, 0x5a, 0x99, 0x8e, 0xb4, 0x65, 0x22, 0xb2, 0xb3, 0x5f, 0x22, 0xb2, 0xb3, 0x5f, 0x77,
+        0xce, 0xb2, 0x9c, 0x99, 0xad, 0x8e, 0x29, 0x33, 0xb8, 0x9a, 0x4f, 0x66, 0xb8, 0x9a, 0x4f, 0x88, 0x10, 0x49, 0x73, 0x77, 0x10, 0x49, 0x73, 0xff, 0x10, 0x69, 0xba, 0x66, 0x10, 0x69, 0xba, 0x33, 0xc5, 0x73, 0x18, 0x00, 0x94, 0xe3, 0x4a, 0x44, 0xac, 0xab, 0x31, 0x11, 0xac, 0xab, 0x31, 0x22, 0x9c, 0xf7, 0xa5, 0xee, 0x6a, 0xb4, 0x73, 0xdd, 0x08, 0x30, 0x10, 0xee, 0x08, 0x30, 0x10, 0xdd,
+        0xd6, 0xf3, 0x29, 0x77, 0xac, 0xe7, 0x26, 0xcc, 0x83, 0xdb, 0x23, 0x99, 0x5a, 0xcf, 0x21, 0x22, 0x52, 0x7d, 0x47, 0x77, 0xa5, 0xae, 0x21, 0x99, 0xa5, 0xae, 0x21, 0x44, 0xa5, 0xae, 0x21, 0x99, 0x5a, 0x10, 0x18, 0xbb, 0x86, 0x14, 0x44, 0x33, 0x86, 0x14, 0x44, 0x77, 0xb2, 0x18, 0x70, 0x66, 0xee, 0x8f, 0x78, 0x11, 0xde, 0x79, 0x42, 0x00, 0xde, 0x79, 0x42, 0x22, 0xe6, 0x84, 0x5d, 0x66,
+        0x7b, 0x61, 0x73, 0xdd, 0x7b, 0x61, 0x73, 0x66, 0x65, 0x9c, 0xcb, 0x33, 0x65, 0x9c, 0xcb, 0xff, 0xce, 0x30, 0xff, 0x88, 0xa2, 0x46, 0x86, 0x55, 0xce, 0x30, 0xff, 0x00, 0xa2, 0x46, 0x86, 0x00, 0x39, 0xe5, 0xbb, 0x55, 0x62, 0xcf, 0x8f, 0x99, 0x39, 0xe5, 0xbb, 0xee, 0x62, 0xcf, 0x8f, 0x22, 0x73, 0x61, 0x21, 0x55, 0xc6, 0x20, 0x18, 0x11, 0x73, 0x61, 0x21, 0xee, 0xc6, 0x20, 0x18, 0xdd,
+        0xf7, 0x71, 0x39, 0x11, 0xf7, 0x71, 0x39, 0x11, 0x7e, 0x3d, 0x3f, 0xaa, 0x7e, 0x3d, 0x3f, 0x22, 0x4c, 0xe7, 0x26, 0x99, 0x4a, 0xe3, 0x31, 0x77, 0x4a, 0xe3, 0x31, 0xdd, 0x52, 0xef, 0x10, 0x11, 0xff, 0x38, 0x8c, 0x55, 0xff, 0x38, 0x8c, 0x33, 0x9c, 0x9f, 0xc2, 0x77, 0xff, 0x38, 0x8c, 0xff, 0xd6, 0xb2, 0x5a, 0x44, 0x6b, 0xb6, 0x6b, 0xbb, 0x8e, 0xb4, 0x65, 0x11, 0x8e, 0xb4, 0x65, 0x88,
+        0xce, 0xb2, 0x9c, 0x66, 0xc3, 0xa6, 0x75, 0xaa, 0xb8, 0x9a, 0x4f, 0x77, 0xce, 0xb2, 0x9c, 0x00, 0x10, 0x49, 0x73, 0x00, 0x10, 0x69, 0xba, 0xee, 0x10, 0x49, 0x73, 0xcc, 0x10, 0x79, 0xde, 0x00, 0xc5, 0x73, 0x18, 0x22, 0x94, 0xe3, 0x4a, 0x00, 0xc5, 0x73, 0x18, 0xff, 0xac, 0xab, 0x31, 0x88, 0x08, 0x30, 0x10, 0x99, 0x6a, 0xb4, 0x73, 0xff, 0x08, 0x30, 0x10, 0x77, 0x9c, 0xf7, 0xa5, 0xcc,
+    };
+
+    const uint8_t kBC3Blocks[] =
+    {
+        0x34, 0x92, 0xac, 0xe5, 0x6e, 0x97, 0x31, 0x7e, 0x1a, 0xf0, 0xaa, 0x63, 0x4b, 0x81, 0x7f, 0x04,
+        0x53, 0x9c, 0xdf, 0x66, 0xe6, 0x48, 0x04, 0x28, 0x33, 0xdb, 0x53, 0xcf, 0xfc, 0x90, 0xc8, 0x22,
+        0x56, 0x6d, 0x36, 0x44, 0xac, 0x18, 0xd6, 0x61, 0xee, 0x8c, 0x58, 0xea, 0xe1, 0xd6, 0xaf, 0x88,
+        0x7c, 0xc4, 0xfc, 0x88, 0x3c, 0x10, 0xb9, 0x0a, 0x15, 0x22, 0x2b, 0x2a, 0xe9, 0x89, 0x36, 0x44,
+        0xc2, 0x55, 0x99, 0x81, 0xd7, 0x41, 0x5e, 0x56, 0x57, 0x1d, 0x4a, 0x3c, 0xde, 0xf1, 0x9a, 0xc7,
+        0xf4, 0xb7, 0xe3, 0x7d, 0x22, 0x94, 0x8d, 0xc5, 0x1a, 0x52, 0x0a, 0x68, 0x12, 0x61, 0xdd, 0xfd,
+        0xc9, 0x25, 0xd4, 0x20, 0x57, 0x1d, 0x9d, 0x96, 0xc8, 0xed, 0x60, 0x13, 0x92, 0x8c, 0x39, 0x90,
+        0x14, 0xf3, 0x44, 0x5d, 0xe4, 0x4b, 0x90, 0x88, 0xec, 0x1d, 0x75, 0xe5, 0x46, 0x1b, 0xc9, 0x0b,
+        0xd3, 0x4b, 0x03, 0x9d, 0xab, 0x03, 0x17, 0x69, 0x1d, 0xd3, 0xe2, 0xca, 0x0a, 0x30, 0x3d, 0xc9,
+        0xfc, 0x96, 0x6b, 0x29, 0x1d, 0x73, 0x2a, 0xae, 0x3d, 0x28, 0xbe, 0xd8, 0x1a, 0x6f, 0xe9, 0xf6,
+        0x60, 0xce, 0xf8, 0x8a, 0xe8, 0xd1, 0x4b, 0x8c, 0x40, 0xb6, 0x7a, 0x50, 0x19, 0x35, 0xa6, 0x51,
+        0x0a, 0x06, 0x02, 0xc9, 0xfb, 0xec, 0x4b, 0xb9, 0x98, 0x51, 0x73, 0x64, 0x50, 0x66, 0x10, 0x10,
+        0xe9, 0x51, 0xf8, 0x99, 0xf8, 0x74, 0x1c, 0x40, 0x37, 0xc8, 0x9e, 0xc7, 0xfa, 0xe4, 0x8a, 0xde,
+        0xb0, 0x78, 0xa9, 0x5b, 0x42, 0x2e, 0x8a, 0x35, 0x4e, 0x32, 0x3f, 0x5c, 0x14, 0xd1, 0x47, 0x16,
+        0xfb, 0xc0, 0x72, 0x17, 0xa6, 0x93, 0xa4, 0x56, 0xf0, 0x3a, 0x63, 0xf7, 0x4e, 0x0a, 0x53, 0x2f,
+        0x51, 0xca, 0xd8, 0x94, 0xe4, 0xeb, 0x4d, 0x3e, 0x55, 0x19, 0x8b, 0x9c, 0x94, 0xce, 0x98, 0x17,
+    };
+
+    const uint8_t kBC3Texels[] =
+    {
+        0x94, 0x4e, 0x7e, 0x6c, 0xc5, 0x27, 0xaa, 0x7f, 0xf7, 0x00, 0xd6, 0x00, 0x63, 0x75, 0x52, 0x46, 0xde, 0x65, 0x9c, 0xff, 0xd3, 0xbe, 0x9c, 0x70, 0xd3, 0xbe, 0x9c, 0x70, 0xd3, 0xbe, 0x9c, 0x70, 0xef, 0x49, 0xc6, 0x00, 0x8c, 0x9e, 0x73, 0x00, 0xad, 0x81, 0x8e, 0x56, 0xce, 0x65, 0xaa, 0x5a, 0x29, 0x45, 0x5a, 0xa7, 0x23, 0x42, 0x91, 0xff, 0x23, 0x42, 0x91, 0x98, 0x26, 0x43, 0x75, 0xa7,
+        0x23, 0x9f, 0x99, 0x55, 0x2e, 0x94, 0x75, 0xa2, 0x39, 0x8a, 0x52, 0x74, 0x2e, 0x94, 0x75, 0xc2, 0x5a, 0x2b, 0xaa, 0xe2, 0x52, 0x41, 0xd6, 0xd9, 0x6b, 0x00, 0x52, 0xbf, 0x52, 0x41, 0xd6, 0xc8, 0xa4, 0xa0, 0x2c, 0x82, 0xef, 0xba, 0x42, 0xb1, 0x10, 0x6d, 0x00, 0x9a, 0xa4, 0xa0, 0x2c, 0xc9, 0x5d, 0xb8, 0x7b, 0x99, 0xe7, 0xae, 0xad, 0x14, 0x18, 0xbe, 0x63, 0xc6, 0xe7, 0xae, 0xad, 0x00,
+        0xd3, 0x5f, 0xa4, 0xac, 0xd3, 0x5f, 0xa4, 0xd3, 0xd6, 0x61, 0xef, 0x98, 0xd6, 0x61, 0xef, 0x71, 0x65, 0x09, 0xf1, 0xde, 0x65, 0x09, 0xf1, 0xc1, 0xde, 0x14, 0xf7, 0xc1, 0x29, 0x04, 0xef, 0xd0, 0x52, 0x0c, 0xd6, 0x60, 0x94, 0x8b, 0x47, 0xff, 0x52, 0x0c, 0xd6, 0x8c, 0xb5, 0xcb, 0x00, 0xb8, 0x52, 0x30, 0xc6, 0x09, 0x52, 0x30, 0xc6, 0x0a, 0x63, 0x8e, 0x9c, 0x08, 0x63, 0x8e, 0x9c, 0x08,
+        0xcb, 0x53, 0xd0, 0xe9, 0xcb, 0x53, 0xd0, 0x66, 0xc8, 0xa3, 0xe3, 0x66, 0xc8, 0xa3, 0xe3, 0xa7, 0x31, 0x49, 0x73, 0x78, 0x5a, 0x86, 0xff, 0x90, 0x5a, 0x86, 0xff, 0x88, 0x31, 0x49, 0x73, 0x90, 0x78, 0x8d, 0x60, 0xf2, 0xb7, 0xbe, 0x3c, 0xd0, 0x39, 0x5d, 0x84, 0xd9, 0xf7, 0xef, 0x18, 0xea, 0x18, 0x28, 0xad, 0x51, 0x9c, 0x92, 0x5a, 0x81, 0x9c, 0x92, 0x5a, 0x81, 0x44, 0x4b, 0x91, 0x69,
+        0x63, 0x75, 0x52, 0x00, 0xf7, 0x00, 0xd6, 0x7f, 0xf7, 0x00, 0xd6, 0x59, 0xc5, 0x27, 0xaa, 0x59, 0xde, 0x65, 0x9c, 0x00, 0xde, 0x65, 0x9c, 0x7e, 0xce, 0xeb, 0x9c, 0x9c, 0xd8, 0x91, 0x9c, 0xff, 0xad, 0x81, 0x8e, 0x63, 0xef, 0x49, 0xc6, 0x56, 0xef, 0x49, 0xc6, 0x5f, 0xce, 0x65, 0xaa, 0x68, 0x29, 0x45, 0x5a, 0x7c, 0x23, 0x42, 0x91, 0xc4, 0x21, 0x41, 0xad, 0xff, 0x23, 0x42, 0x91, 0xc4,
+        0x39, 0x8a, 0x52, 0xc2, 0x18, 0xaa, 0xbd, 0x64, 0x2e, 0x94, 0x75, 0x83, 0x2e, 0x94, 0x75, 0x74, 0x6b, 0x00, 0x52, 0xbf, 0x52, 0x41, 0xd6, 0xd9, 0x5a, 0x2b, 0xaa, 0xf4, 0x6b, 0x00, 0x52, 0xb7, 0xef, 0xba, 0x42, 0xb1, 0x5a, 0x86, 0x16, 0x53, 0xef, 0xba, 0x42, 0x6b, 0xa4, 0xa0, 0x2c, 0xb1, 0xa2, 0xb3, 0x94, 0xc6, 0x5d, 0xb8, 0x7b, 0x14, 0xe7, 0xae, 0xad, 0xf3, 0x18, 0xbe, 0x63, 0xff,
+        0xd6, 0x61, 0xef, 0x4b, 0xd6, 0x61, 0xef, 0x5e, 0xd0, 0x5e, 0x5a, 0xbf, 0xd6, 0x61, 0xef, 0x85, 0xa1, 0x0e, 0xf4, 0xed, 0xa1, 0x0e, 0xf4, 0xed, 0x65, 0x09, 0xf1, 0xa4, 0xde, 0x14, 0xf7, 0xfc, 0x52, 0x0c, 0xd6, 0x60, 0x52, 0x0c, 0xd6, 0xce, 0x73, 0x4b, 0x8e, 0x76, 0xb5, 0xcb, 0x00, 0xff, 0x57, 0x4f, 0xb8, 0x08, 0x63, 0x8e, 0x9c, 0x06, 0x57, 0x4f, 0xb8, 0x07, 0x63, 0x8e, 0x9c, 0x06,
+        0xce, 0x04, 0xbd, 0x51, 0xc6, 0xf3, 0xf7, 0x51, 0xcb, 0x53, 0xd0, 0x7c, 0xc8, 0xa3, 0xe3, 0x66, 0x5a, 0x86, 0xff, 0x90, 0x31, 0x49, 0x73, 0x98, 0x5a, 0x86, 0xff, 0xb0, 0x4c, 0x71, 0xd0, 0xa8, 0x78, 0x8d, 0x60, 0xc0, 0x78, 0x8d, 0x60, 0xe1, 0x39, 0x5d, 0x84, 0xc0, 0x39, 0x5d, 0x84, 0xd9, 0x44, 0x4b, 0x91, 0xca, 0x70, 0x6e, 0x75, 0xca, 0x18, 0x28, 0xad, 0xca, 0x70, 0x6e, 0x75, 0xff,
+        0x94, 0x4e, 0x7e, 0xff, 0x94, 0x4e, 0x7e, 0x46, 0x94, 0x4e, 0x7e, 0x00, 0x63, 0x75, 0x52, 0x34, 0xde, 0x65, 0x9c, 0x53, 0xd8, 0x91, 0x9c, 0x9c, 0xde, 0x65, 0x9c, 0x9c, 0xd3, 0xbe, 0x9c, 0x61, 0xce, 0x65, 0xaa, 0x56, 0xce, 0x65, 0xaa, 0x5f, 0xad, 0x81, 0x8e, 0x56, 0xad, 0x81, 0x8e, 0x5f, 0x23, 0x42, 0x91, 0x7c, 0x29, 0x45, 0x5a, 0x8a, 0x26, 0x43, 0x75, 0xa7, 0x21, 0x41, 0xad, 0xa7,
+        0x23, 0x9f, 0x99, 0x55, 0x23, 0x9f, 0x99, 0xc2, 0x39, 0x8a, 0x52, 0x55, 0x23, 0x9f, 0x99, 0x64, 0x6b, 0x00, 0x52, 0xd9, 0x62, 0x15, 0x7e, 0xeb, 0x6b, 0x00, 0x52, 0xc8, 0x62, 0x15, 0x7e, 0xc8, 0x10, 0x6d, 0x00, 0x6b, 0xa4, 0xa0, 0x2c, 0x9a, 0x5a, 0x86, 0x16, 0x82, 0xef, 0xba, 0x42, 0x53, 0xe7, 0xae, 0xad, 0x6d, 0x5d, 0xb8, 0x7b, 0xf3, 0x18, 0xbe, 0x63, 0xf3, 0xa2, 0xb3, 0x94, 0x14,
+        0xce, 0x5d, 0x10, 0xac, 0xd0, 0x5e, 0x5a, 0xd3, 0xd0, 0x5e, 0x5a, 0x98, 0xd6, 0x61, 0xef, 0xac, 0xde, 0x14, 0xf7, 0xde, 0x65, 0x09, 0xf1, 0xb3, 0x65, 0x09, 0xf1, 0x96, 0xa1, 0x0e, 0xf4, 0xc1, 0x94, 0x8b, 0x47, 0xce, 0x52, 0x0c, 0xd6, 0x76, 0x94, 0x8b, 0x47, 0xff, 0x94, 0x8b, 0x47, 0xb8, 0x52, 0x30, 0xc6, 0x08, 0x52, 0x30, 0xc6, 0x07, 0x63, 0x8e, 0x9c, 0x06, 0x52, 0x30, 0xc6, 0x07,
+        0xcb, 0x53, 0xd0, 0xa7, 0xcb, 0x53, 0xd0, 0x7c, 0xce, 0x04, 0xbd, 0x51, 0xcb, 0x53, 0xd0, 0x7c, 0x4c, 0x71, 0xd0, 0x88, 0x5a, 0x86, 0xff, 0x90, 0x31, 0x49, 0x73, 0xb0, 0x5a, 0x86, 0xff, 0x90, 0xb7, 0xbe, 0x3c, 0xea, 0x39, 0x5d, 0x84, 0xf2, 0xf7, 0xef, 0x18, 0xf2, 0xf7, 0xef, 0x18, 0xf2, 0x18, 0x28, 0xad, 0x81, 0x44, 0x4b, 0x91, 0xb1, 0x9c, 0x92, 0x5a, 0xff, 0x44, 0x4b, 0x91, 0x00,
+        0xf7, 0x00, 0xd6, 0x59, 0x63, 0x75, 0x52, 0x6c, 0xf7, 0x00, 0xd6, 0xff, 0xf7, 0x00, 0xd6, 0x59, 0xd8, 0x91, 0x9c, 0x53, 0xde, 0x65, 0x9c, 0x53, 0xd8, 0x91, 0x9c, 0x61, 0xde, 0x65, 0x9c, 0x9c, 0x8c, 0x9e, 0x73, 0x68, 0xad, 0x81, 0x8e, 0x5f, 0x8c, 0x9e, 0x73, 0x56, 0xad, 0x81, 0x8e, 0x5f, 0x21, 0x41, 0xad, 0x98, 0x29, 0x45, 0x5a, 0xb5, 0x21, 0x41, 0xad, 0x8a, 0x29, 0x45, 0x5a, 0x7c,
+        0x2e, 0x94, 0x75, 0x83, 0x39, 0x8a, 0x52, 0x93, 0x18, 0xaa, 0xbd, 0x83, 0x2e, 0x94, 0x75, 0xb2, 0x6b, 0x00, 0x52, 0xf4, 0x62, 0x15, 0x7e, 0xe2, 0x62, 0x15, 0x7e, 0xb7, 0x62, 0x15, 0x7e, 0xc8, 0xef, 0xba, 0x42, 0x25, 0xef, 0xba, 0x42, 0x6b, 0x10, 0x6d, 0x00, 0x6b, 0xa4, 0xa0, 0x2c, 0x82, 0xa2, 0xb3, 0x94, 0xf3, 0x5d, 0xb8, 0x7b, 0xf3, 0x18, 0xbe, 0x63, 0x40, 0x18, 0xbe, 0x63, 0x99,
+        0xce, 0x5d, 0x10, 0x4b, 0xd3, 0x5f, 0xa4, 0xbf, 0xd6, 0x61, 0xef, 0xbf, 0xd0, 0x5e, 0x5a, 0xac, 0x65, 0x09, 0xf1, 0xed, 0xde, 0x14, 0xf7, 0xd0, 0xa1, 0x0e, 0xf4, 0xde, 0xa1, 0x0e, 0xf4, 0xc1, 0x52, 0x0c, 0xd6, 0xa2, 0xb5, 0xcb, 0x00, 0x60, 0x52, 0x0c, 0xd6, 0x8c, 0x52, 0x0c, 0xd6, 0xa2, 0x52, 0x30, 0xc6, 0x08, 0x52, 0x30, 0xc6, 0x09, 0x63, 0x8e, 0x9c, 0x07, 0x52, 0x30, 0xc6, 0x07,
+        0xcb, 0x53, 0xd0, 0x51, 0xc8, 0xa3, 0xe3, 0xe9, 0xc6, 0xf3, 0xf7, 0xe9, 0xc8, 0xa3, 0xe3, 0xd3, 0x3e, 0x5d, 0xa1, 0xb0, 0x5a, 0x86, 0xff, 0xa0, 0x5a, 0x86, 0xff, 0x90, 0x31, 0x49, 0x73, 0x78, 0xb7, 0xbe, 0x3c, 0xf2, 0xb7, 0xbe, 0x3c, 0xd9, 0x78, 0x8d, 0x60, 0xd9, 0x39, 0x5d, 0x84, 0xf2, 0x70, 0x6e, 0x75, 0x99, 0x9c, 0x92, 0x5a, 0x99, 0x9c, 0x92, 0x5a, 0xff, 0x18, 0x28, 0xad, 0xca,
+    };
+
+    const uint8_t kBC4_UNORMBlocks[] =
+    {
+        0x3e, 0x38, 0x05, 0xce, 0x3e, 0x66, 0x12, 0x44,
+        0x8d, 0xde, 0x12, 0xba, 0x13, 0x05, 0xa2, 0x02,
+        0x4a, 0xc0, 0xca, 0x5b, 0x7e, 0x78, 0xdc, 0xdb,
+        0x27, 0x19, 0x80, 0xc7, 0xcb, 0x53, 0x13, 0x82,
+        0xf3, 0xaa, 0x2c, 0x2d, 0xc6, 0x26, 0xfc, 0x24,
+        0xd2, 0xdd, 0x51, 0x4e, 0x1b, 0xb5, 0x83, 0xd5,
+        0xeb, 0x9a, 0x4b, 0x20, 0xe4, 0x34, 0x24, 0x8b,
+        0xe9, 0xb8, 0x08, 0xc7, 0x50, 0xd2, 0xe7, 0x9f,
+        0xcd, 0xac, 0xe8, 0x8d, 0xd7, 0xf1, 0xbf, 0xfc,
+        0xb0, 0x34, 0x2d, 0x4c, 0x6e, 0x89, 0x28, 0x0c,
+        0xb6, 0xdc, 0xaa, 0x3f, 0x40, 0xc7, 0x10, 0xae,
+        0xf6, 0x72, 0xce, 0x6e, 0x8c, 0x40, 0x8a, 0x70,
+        0xd9, 0x89, 0x74, 0x02, 0x65, 0xd6, 0x56, 0x2b,
+        0x42, 0x7c, 0x06, 0xcb, 0xa5, 0xee, 0x6a, 0xf9,
+        0x92, 0x04, 0x0f, 0xb1, 0x5a, 0x94, 0x23, 0x97,
+        0x20, 0x23, 0x42, 0xfb, 0xd4, 0x46, 0x65, 0x90,
+    };
+
+    const uint8_t kBC4_UNORMTexels[] =
+    {
+        0x3a, 0x3e, 0x3e, 0x38, 0x9d, 0x9d, 0x8d, 0xcd, 0x61, 0xc0, 0xff, 0xa8, 0x27, 0x27, 0x1d, 0x23,
+        0xd3, 0xc9, 0xd3, 0xbe, 0xdd, 0xd4, 0xdd, 0xff, 0xd3, 0x9a, 0x9a, 0xeb, 0xe9, 0xb8, 0xd4, 0xdb,
+        0xcd, 0xba, 0xb0, 0xb5, 0x69, 0x69, 0xb0, 0x57, 0xbd, 0xd4, 0x00, 0xff, 0x97, 0x72, 0xd0, 0x84,
+        0xb6, 0x9f, 0x89, 0x89, 0x00, 0x42, 0x64, 0x70, 0x18, 0x04, 0x55, 0x92, 0x20, 0x20, 0x22, 0x22,
+        0x3b, 0x3a, 0x38, 0x38, 0xad, 0xff, 0xbd, 0x8d, 0xa8, 0x90, 0xff, 0x79, 0x21, 0x1b, 0x25, 0x1d,
+        0xe8, 0xd3, 0xaa, 0xbe, 0xd8, 0x00, 0x00, 0xd2, 0xdf, 0xeb, 0x9a, 0xa5, 0xd4, 0xb8, 0xd4, 0xe2,
+        0xcd, 0xb0, 0xba, 0xb5, 0x7a, 0x7a, 0x8c, 0x8c, 0xc5, 0xb6, 0xb6, 0xbd, 0x97, 0xf6, 0xd0, 0xbd,
+        0xd9, 0xcd, 0x89, 0xc2, 0x64, 0x59, 0x7c, 0x70, 0x69, 0x40, 0x2c, 0x7d, 0xff, 0x23, 0x22, 0x00,
+        0x39, 0x3b, 0x38, 0x38, 0xcd, 0x8d, 0x8d, 0xde, 0x4a, 0xff, 0xc0, 0x00, 0x23, 0x25, 0x1f, 0x19,
+        0xbe, 0xd3, 0xf3, 0xbe, 0xda, 0x00, 0x00, 0xdd, 0xc8, 0xb1, 0xeb, 0xdf, 0xe2, 0xe2, 0xbf, 0xdb,
+        0xac, 0xb5, 0xb0, 0xb0, 0x34, 0x34, 0x9e, 0x7a, 0xff, 0xb6, 0xc5, 0xb6, 0xf6, 0xf6, 0x72, 0xaa,
+        0x9f, 0xcd, 0xc2, 0xc2, 0x00, 0x70, 0x59, 0x70, 0x55, 0x7d, 0x2c, 0x04, 0x00, 0x20, 0x22, 0x20,
+        0x38, 0x3e, 0x38, 0x3d, 0x9d, 0xcd, 0x8d, 0x8d, 0xa8, 0xff, 0x00, 0x00, 0x19, 0x21, 0x27, 0x21,
+        0xb4, 0xaa, 0xaa, 0xaa, 0xd2, 0xd6, 0xda, 0x00, 0xdf, 0xb1, 0xdf, 0xc8, 0xc6, 0xbf, 0xbf, 0xd4,
+        0xc3, 0xac, 0xb0, 0xb0, 0x9e, 0xb0, 0x8c, 0xb0, 0xdc, 0xcc, 0xc5, 0xd4, 0xf6, 0x72, 0xbd, 0xd0,
+        0xab, 0x9f, 0xcd, 0x89, 0x00, 0x4d, 0x00, 0xff, 0x7d, 0x2c, 0x40, 0x55, 0x00, 0x20, 0x21, 0x21,
+    };
+
+    const uint8_t kBC5_UNORMBlocks[] =
+    {
+        0x66, 0x2c, 0x9c, 0x16, 0x3b, 0x7c, 0x01, 0x2d, 0x87, 0x51, 0x80, 0xe4, 0xa6, 0xeb, 0x70, 0xee,
+        0xaf, 0xa3, 0xbb, 0x39, 0x3d, 0x50, 0x7e, 0xaf, 0x7a, 0xf4, 0x39, 0xb6, 0x69, 0x56, 0x8f, 0x9c,
+        0xe8, 0xba, 0xea, 0xa7, 0x46, 0xf8, 0xa5, 0x38, 0x0c, 0xeb, 0x12, 0xc3, 0x82, 0xa5, 0xe0, 0x5e,
+        0x28, 0x82, 0xc4, 0xca, 0xe2, 0x34, 0x4f, 0x4c, 0xb1, 0x4c, 0xd9, 0x8d, 0x5f, 0x2a, 0xb3, 0xb3,
+        0xbc, 0x76, 0x98, 0x15, 0xdb, 0x1f, 0xe5, 0x9b, 0xf5, 0x83, 0x92, 0x60, 0x2d, 0x27, 0x40, 0x6d,
+        0x37, 0xf1, 0x91, 0xb8, 0xc1, 0xc8, 0x0d, 0x7e, 0xae, 0x64, 0xb7, 0xa3, 0x59, 0x62, 0x83, 0xd8,
+        0x2a, 0x8b, 0xba, 0xfe, 0x0a, 0x86, 0xfb, 0x17, 0xce, 0x41, 0xa0, 0x19, 0x44, 0xbc, 0xe9, 0x15,
+        0xf5, 0xf9, 0x23, 0xf8, 0xc6, 0x9d, 0xd7, 0xf7, 0xa8, 0xaf, 0xb3, 0x14, 0x71, 0xd9, 0xec, 0x3d,
+        0xf8, 0xd9, 0x61, 0xf0, 0xcd, 0xe7, 0x6e, 0x65, 0x2a, 0xe8, 0x53, 0x70, 0x20, 0x9f, 0xe8, 0x7c,
+        0xf5, 0x36, 0x1e, 0x6e, 0x99, 0x88, 0x68, 0xe8, 0x1e, 0xa9, 0x4b, 0x47, 0x3f, 0x60, 0xbf, 0x8f,
+        0x01, 0xf5, 0x30, 0x87, 0x70, 0x94, 0x05, 0x07, 0xa0, 0xf9, 0x9b, 0x3e, 0xd5, 0x42, 0x34, 0x2c,
+        0x48, 0x25, 0x8a, 0x33, 0x45, 0x4f, 0x95, 0xc1, 0x40, 0xd5, 0xae, 0x72, 0xca, 0xdc, 0xcf, 0xda,
+        0xf9, 0x2b, 0x8b, 0x5b, 0x7d, 0x6b, 0xdb, 0x1f, 0xc4, 0x35, 0x92, 0xe1, 0x62, 0x34, 0x48, 0xcf,
+        0x1b, 0xe7, 0xce, 0x06, 0x1e, 0x91, 0xbf, 0x03, 0x8b, 0x4b, 0xf7, 0xac, 0xc2, 0xb9, 0xf9, 0xa6,
+        0x22, 0x13, 0x80, 0x5f, 0x92, 0xce, 0x4f, 0x6f, 0x80, 0xad, 0x5b, 0xc2, 0x87, 0x52, 0x00, 0x1f,
+        0x71, 0xb7, 0x73, 0x59, 0x4e, 0x8a, 0x66, 0x56, 0xc8, 0xbb, 0xae, 0x92, 0x7e, 0x1c, 0xa5, 0xea,
+    };
+
+    const uint8_t kBC5_UNORMTexels[] =
+    {
+        0x4d, 0x87, 0x00, 0x55, 0x87, 0x00, 0x5d, 0x7f, 0x00, 0x55, 0x7f, 0x00, 0xab, 0xf4, 0x00, 0xa4, 0xff, 0x00, 0xa6, 0x7a, 0x00, 0xa9, 0xaa, 0x00, 0xe1, 0x38, 0x00, 0xcd, 0x38, 0x00, 0xc0, 0x91, 0x00, 0xda, 0xeb, 0x00, 0x5e, 0x4c, 0x00, 0x28, 0x94, 0x00, 0x4c, 0x5a, 0x00, 0x70, 0x68, 0x00,
+        0xbc, 0xe4, 0x00, 0xa8, 0xe4, 0x00, 0x8a, 0xe4, 0x00, 0xb2, 0xf5, 0x00, 0xf1, 0x6e, 0x00, 0x5c, 0x79, 0x00, 0x5c, 0x79, 0x00, 0xa6, 0x64, 0x00, 0x3d, 0xce, 0x00, 0xff, 0x91, 0x00, 0x3d, 0x69, 0x00, 0xff, 0x91, 0x00, 0xf6, 0xaa, 0x00, 0xf7, 0x00, 0x00, 0xf5, 0xa9, 0x00, 0xf7, 0xa9, 0x00,
+        0xd9, 0x76, 0x00, 0xea, 0x50, 0x00, 0xd9, 0xe8, 0x00, 0xf8, 0x2a, 0x00, 0x6c, 0x55, 0x00, 0xbe, 0xa9, 0x00, 0xf5, 0x8d, 0x00, 0x51, 0x55, 0x00, 0x01, 0xc3, 0x00, 0x00, 0xc3, 0x00, 0x93, 0xb1, 0x00, 0x62, 0xff, 0x00, 0x43, 0x00, 0x00, 0x25, 0xb7, 0x00, 0x2f, 0x5d, 0x00, 0x25, 0xd5, 0x00,
+        0xbe, 0xaf, 0x00, 0x2b, 0xaf, 0x00, 0x65, 0x5d, 0x00, 0x83, 0xc4, 0x00, 0x00, 0x54, 0x00, 0xe7, 0x5d, 0x00, 0x6c, 0x78, 0x00, 0x6c, 0x5d, 0x00, 0x22, 0x92, 0x00, 0x22, 0x92, 0x00, 0x17, 0xad, 0x00, 0x15, 0xad, 0x00, 0x8d, 0xbe, 0x00, 0x00, 0xc0, 0x00, 0xa9, 0xc6, 0x00, 0x9b, 0xbb, 0x00,
+        0x2c, 0x60, 0x00, 0x3c, 0x68, 0x00, 0x3c, 0x51, 0x00, 0x2c, 0x68, 0x00, 0xab, 0xaa, 0x00, 0xad, 0xaa, 0x00, 0xa4, 0x92, 0x00, 0xa3, 0xaa, 0x00, 0xe1, 0x91, 0x00, 0xcd, 0xbe, 0x00, 0xba, 0x0c, 0x00, 0xe1, 0x91, 0x00, 0x5e, 0xb1, 0x00, 0x70, 0x5a, 0x00, 0x28, 0x5a, 0x00, 0xff, 0xa2, 0x00,
+        0x76, 0xa3, 0x00, 0x8a, 0xe4, 0x00, 0x8a, 0xd4, 0x00, 0x8a, 0x83, 0x00, 0x81, 0xa3, 0x00, 0x81, 0x98, 0x00, 0x37, 0x79, 0x00, 0x00, 0xa3, 0x00, 0xff, 0x41, 0x00, 0x77, 0xce, 0x00, 0x3d, 0x41, 0x00, 0x2a, 0xb9, 0x00, 0xff, 0xaf, 0x00, 0xf8, 0xa9, 0x00, 0xf9, 0xac, 0x00, 0x00, 0xaa, 0x00,
+        0xdd, 0xff, 0x00, 0xef, 0x2a, 0x00, 0xef, 0x2a, 0x00, 0xe1, 0xe8, 0x00, 0x6c, 0x71, 0x00, 0xd9, 0x00, 0x00, 0x6c, 0xff, 0x00, 0xa3, 0xa9, 0x00, 0x01, 0xc3, 0x00, 0xf5, 0xb1, 0x00, 0x93, 0xe7, 0x00, 0x62, 0x00, 0x00, 0x3e, 0xff, 0x00, 0x43, 0x99, 0x00, 0x25, 0x5d, 0x00, 0x43, 0x00, 0x00,
+        0x83, 0x5d, 0x00, 0xdb, 0x72, 0x00, 0x48, 0xc4, 0x00, 0xbe, 0x9b, 0x00, 0x1b, 0x81, 0x00, 0x95, 0x66, 0x00, 0xff, 0x8b, 0x00, 0x1b, 0x5d, 0x00, 0x19, 0x9b, 0x00, 0x1b, 0xff, 0x00, 0x1b, 0xad, 0x00, 0x1b, 0x9b, 0x00, 0xa9, 0xbb, 0x00, 0x9b, 0xc0, 0x00, 0x8d, 0xbc, 0x00, 0x7f, 0xc4, 0x00,
+        0x4d, 0x77, 0x00, 0x34, 0x68, 0x00, 0x44, 0x77, 0x00, 0x66, 0x87, 0x00, 0xaf, 0x00, 0x00, 0xad, 0x92, 0x00, 0xa3, 0xdb, 0x00, 0xa4, 0xff, 0x00, 0xe8, 0xbe, 0x00, 0xc0, 0x91, 0x00, 0xc0, 0x38, 0x00, 0xe1, 0x0c, 0x00, 0x5e, 0xa2, 0x00, 0x00, 0x77, 0x00, 0x5e, 0x85, 0x00, 0xff, 0x4c, 0x00,
+        0x80, 0x93, 0x00, 0xa8, 0xc4, 0x00, 0x9e, 0xf5, 0x00, 0xb2, 0xf5, 0x00, 0x37, 0xa3, 0x00, 0xf1, 0x8e, 0x00, 0xff, 0x83, 0x00, 0x00, 0x64, 0x00, 0x00, 0x91, 0x00, 0x2a, 0x55, 0x00, 0x00, 0x69, 0x00, 0x77, 0x91, 0x00, 0xf8, 0xaf, 0x00, 0xf6, 0xaa, 0x00, 0x00, 0xaa, 0x00, 0xf6, 0x00, 0x00,
+        0xdd, 0xff, 0x00, 0xea, 0x76, 0x00, 0xef, 0x50, 0x00, 0xdd, 0x9c, 0x00, 0xf5, 0x1e, 0x00, 0x36, 0x71, 0x00, 0xd9, 0x8d, 0x00, 0xa3, 0xff, 0x00, 0x93, 0xb1, 0x00, 0x31, 0xa0, 0x00, 0x00, 0xf9, 0x00, 0x31, 0xb1, 0x00, 0x2a, 0x99, 0x00, 0x25, 0x7b, 0x00, 0x34, 0xff, 0x00, 0x43, 0xff, 0x00,
+        0xbe, 0x86, 0x00, 0x83, 0x5d, 0x00, 0x83, 0xc4, 0x00, 0x83, 0x86, 0x00, 0xe7, 0x4b, 0x00, 0x43, 0x54, 0x00, 0x00, 0x5d, 0x00, 0xff, 0x6f, 0x00, 0x17, 0x89, 0x00, 0x13, 0x89, 0x00, 0x15, 0xad, 0x00, 0x15, 0x80, 0x00, 0x7f, 0xc2, 0x00, 0xb7, 0xc4, 0x00, 0x7f, 0xc2, 0x00, 0x8d, 0xc6, 0x00,
+        0x66, 0x58, 0x00, 0x5d, 0x6f, 0x00, 0x55, 0x77, 0x00, 0x2c, 0x58, 0x00, 0xa4, 0x7a, 0x00, 0xa6, 0xf4, 0x00, 0xab, 0xff, 0x00, 0xa8, 0xc3, 0x00, 0xe1, 0x00, 0x00, 0xba, 0xbe, 0x00, 0xc7, 0xff, 0x00, 0xba, 0x38, 0x00, 0x5e, 0x94, 0x00, 0x28, 0x5a, 0x00, 0x4c, 0x85, 0x00, 0x3a, 0x77, 0x00,
+        0x8a, 0xc4, 0x00, 0x80, 0xe4, 0x00, 0x8a, 0xd4, 0x00, 0x9e, 0xd4, 0x00, 0x37, 0xae, 0x00, 0xa6, 0x64, 0x00, 0xff, 0x79, 0x00, 0x81, 0x79, 0x00, 0xff, 0x69, 0x00, 0xff, 0xa5, 0x00, 0x77, 0x7d, 0x00, 0x2a, 0xce, 0x00, 0xf8, 0x00, 0x00, 0xff, 0xaa, 0x00, 0xf8, 0xff, 0x00, 0xff, 0xaf, 0x00,
+        0xe1, 0x00, 0x00, 0xf3, 0xe8, 0x00, 0xd9, 0xff, 0x00, 0xef, 0x76, 0x00, 0x6c, 0x55, 0x00, 0xf5, 0xff, 0x00, 0xd9, 0x55, 0x00, 0x51, 0x71, 0x00, 0x01, 0xc3, 0x00, 0x00, 0xa0, 0x00, 0xf5, 0xc3, 0x00, 0x01, 0xf9, 0x00, 0x25, 0x99, 0x00, 0x3e, 0xb7, 0x00, 0x48, 0x00, 0x00, 0x2f, 0x00, 0x00,
+        0x83, 0x86, 0x00, 0x48, 0x5d, 0x00, 0x48, 0x9b, 0x00, 0xf9, 0x5d, 0x00, 0x6c, 0x54, 0x00, 0xff, 0x66, 0x00, 0x1b, 0x4b, 0x00, 0x1b, 0x66, 0x00, 0x1b, 0x80, 0x00, 0x17, 0x00, 0x00, 0x1d, 0xff, 0x00, 0x1d, 0x80, 0x00, 0x00, 0xc6, 0x00, 0x9b, 0xc0, 0x00, 0xa9, 0xc6, 0x00, 0x7f, 0xbc, 0x00,
+    };
+
+    const uint8_t kBC7Blocks[] =
+    {
+        0x61, 0x61, 0x34, 0x8e, 0x00, 0xfe, 0x47, 0xa2, 0x99, 0xb8, 0xe1, 0xbd, 0xd4, 0xba, 0x82, 0x32,
+        0xfe, 0xec, 0x76, 0x99, 0xd5, 0x84, 0x68, 0xef, 0xbe, 0xb6, 0xfc, 0xfc, 0x4e, 0xb3, 0x2b, 0x73,
+        0x9c, 0xab, 0x87, 0x32, 0x5c, 0x86, 0x00, 0xad, 0x63, 0x94, 0x6d, 0xf8, 0x67, 0x56, 0xdc, 0x9f,
+        0x98, 0xf9, 0xbb, 0xb3, 0xe5, 0xf7, 0xbf, 0x11, 0x7e, 0xfc, 0xbe, 0x3f, 0xa3, 0xf7, 0xa6, 0x4a,
+        0xb0, 0x05, 0x68, 0xb8, 0xa1, 0x27, 0xa2, 0xc7, 0xef, 0x65, 0xc8, 0x45, 0xd8, 0x2d, 0xc4, 0x12,
+        0xe0, 0xc6, 0x9a, 0x02, 0x59, 0xe9, 0x43, 0xcc, 0xb5, 0x69, 0xdf, 0xaf, 0x8b, 0x4d, 0x26, 0x76,
+        0xc0, 0x42, 0x7c, 0x2b, 0x77, 0x82, 0x0b, 0x45, 0x82, 0x19, 0xbe, 0x97, 0x6c, 0x11, 0x5a, 0x11,
+        0x80, 0x71, 0x05, 0x2a, 0x81, 0xb5, 0xf2, 0x29, 0xb0, 0x17, 0x66, 0xa2, 0xb0, 0x46, 0x9a, 0x4d,
+        0x35, 0x87, 0x35, 0x3c, 0xe2, 0x55, 0x44, 0x11, 0x13, 0xb2, 0xd4, 0xe9, 0x85, 0xa8, 0x5e, 0x77,
+        0x82, 0x8e, 0xbc, 0x0c, 0x2b, 0x4c, 0xa7, 0xbc, 0xb6, 0xff, 0xd0, 0x8e, 0x45, 0x5b, 0x9c, 0xbd,
+        0x3c, 0x64, 0x8f, 0x66, 0x2c, 0x7b, 0xca, 0x42, 0xdd, 0x9c, 0x54, 0xb7, 0x38, 0x42, 0xf6, 0x9c,
+        0xb8, 0x3e, 0xd8, 0xa9, 0x07, 0xda, 0xe6, 0xde, 0x9f, 0x67, 0x51, 0xed, 0x6e, 0xee, 0xc2, 0x3f,
+        0xd0, 0x44, 0x30, 0x12, 0xa0, 0xbb, 0x2a, 0xde, 0xf9, 0x94, 0x71, 0x94, 0xe9, 0xee, 0xba, 0x25,
+        0xa0, 0xf2, 0x43, 0x75, 0x86, 0x29, 0x23, 0xc7, 0x23, 0xe4, 0xb7, 0x70, 0x5c, 0x4f, 0xc0, 0x66,
+        0x40, 0x1d, 0xb7, 0x34, 0xb7, 0xae, 0x4e, 0x11, 0x1b, 0x3a, 0x65, 0x52, 0x7e, 0xed, 0x19, 0xf4,
+        0x80, 0x0b, 0x0e, 0xcf, 0x98, 0x05, 0xe3, 0xc0, 0x37, 0xae, 0x08, 0x7e, 0xb4, 0x87, 0xd0, 0xb9,
+    };
+
+    const uint8_t kBC7Texels[] =
+    {
+        0xbd, 0x4a, 0x29, 0xff, 0x00, 0x00, 0x10, 0xff, 0x8c, 0xba, 0xd3, 0xff, 0x6a, 0x70, 0xd7, 0xff, 0x94, 0x51, 0xd1, 0xff, 0x99, 0x68, 0xb5, 0xff, 0xa7, 0x53, 0xc4, 0xff, 0x6c, 0x4c, 0xed, 0xff, 0xad, 0x63, 0x18, 0xff, 0xdf, 0x4d, 0x23, 0xff, 0xc5, 0x58, 0x1e, 0xff, 0xdf, 0x4d, 0x23, 0xff, 0xfc, 0xbe, 0x3e, 0xff, 0xfc, 0xbe, 0x3e, 0xff, 0xe6, 0xd3, 0x7c, 0xff, 0xba, 0xfe, 0xfc, 0xff,
+        0x79, 0xd6, 0xde, 0x29, 0x79, 0xca, 0xd1, 0x23, 0x7f, 0x84, 0x84, 0x00, 0x8a, 0xbf, 0xc5, 0x1d, 0x82, 0x3d, 0x30, 0x6f, 0x75, 0x68, 0x53, 0xb6, 0x82, 0x3d, 0x10, 0x6f, 0x6a, 0x91, 0x53, 0xfb, 0x18, 0xb9, 0x9e, 0x12, 0x7d, 0xce, 0xaf, 0x4e, 0x8a, 0xd1, 0xb1, 0x56, 0x18, 0xb9, 0x9e, 0x12, 0xaa, 0x00, 0x38, 0x28, 0x3a, 0x3e, 0x30, 0x51, 0x4e, 0x7e, 0xa4, 0x4e, 0x3a, 0x3e, 0x30, 0x51,
+        0x7e, 0x16, 0xa1, 0xff, 0x40, 0x11, 0x8a, 0xff, 0x8d, 0x17, 0xa7, 0xff, 0x4f, 0x12, 0x90, 0xff, 0x38, 0xad, 0xf1, 0xff, 0x15, 0xb1, 0xf9, 0xff, 0xa0, 0xbb, 0x8f, 0xff, 0x1f, 0xbe, 0xf4, 0xff, 0xb2, 0x8c, 0x34, 0xff, 0xef, 0x39, 0x39, 0xff, 0x8c, 0x29, 0x4a, 0xff, 0x4f, 0x4a, 0x8d, 0xff, 0x5c, 0xb0, 0xad, 0xff, 0x5c, 0xb0, 0xad, 0xff, 0x41, 0xe5, 0xa8, 0xff, 0x41, 0xe5, 0xa8, 0xff,
+        0x21, 0xba, 0x08, 0x63, 0x12, 0xb6, 0x73, 0x2a, 0x1f, 0xb6, 0x19, 0x5a, 0x1c, 0xba, 0x2b, 0x50, 0xe5, 0xc8, 0x30, 0xab, 0xe5, 0xf1, 0x30, 0xab, 0x9e, 0xd5, 0x63, 0x94, 0xe5, 0xd5, 0x30, 0xab, 0x8b, 0x7e, 0x90, 0x40, 0x78, 0x54, 0xa7, 0x4b, 0xa2, 0xb3, 0x73, 0x31, 0x82, 0x6a, 0x9b, 0x45, 0x88, 0x40, 0x53, 0x6c, 0x47, 0x4d, 0x8c, 0x7b, 0x88, 0x40, 0x53, 0x6c, 0x08, 0x59, 0xc3, 0x8a,
+        0x35, 0x15, 0x17, 0xff, 0x50, 0x1f, 0x1b, 0xff, 0x5a, 0x4d, 0xda, 0xff, 0x6a, 0x70, 0xd7, 0xff, 0x6c, 0x4c, 0xed, 0xff, 0x90, 0x5e, 0xb4, 0xff, 0xa7, 0x53, 0xc4, 0xff, 0x7f, 0x4e, 0xe0, 0xff, 0x43, 0x7c, 0xef, 0xff, 0x89, 0x36, 0xa5, 0xff, 0x8f, 0x6f, 0x6a, 0xff, 0x08, 0xad, 0xe7, 0xff, 0x97, 0x85, 0xff, 0xff, 0xd0, 0xe9, 0xbe, 0xff, 0xba, 0xfe, 0xfc, 0xff, 0xe6, 0xd3, 0x7c, 0xff,
+        0x8a, 0xa7, 0xaa, 0x11, 0x79, 0xd6, 0xde, 0x29, 0x84, 0x90, 0x91, 0x06, 0x8a, 0x90, 0x91, 0x06, 0x8d, 0x14, 0x30, 0x2a, 0x82, 0x3d, 0x73, 0x6f, 0x6a, 0x91, 0x10, 0xfb, 0x75, 0x68, 0x30, 0xb6, 0xd5, 0xe1, 0xbe, 0x82, 0xa9, 0xd8, 0xb6, 0x68, 0x6f, 0xcc, 0xad, 0x46, 0x8a, 0xd1, 0xb1, 0x56, 0x3a, 0x3e, 0x30, 0x51, 0x4e, 0x7e, 0xa4, 0x4e, 0x51, 0x59, 0x82, 0x30, 0x4e, 0x7e, 0xa4, 0x4e,
+        0xa5, 0xa5, 0x94, 0xff, 0xc2, 0xe6, 0x8e, 0xff, 0xce, 0xff, 0x8c, 0xff, 0xc2, 0xe6, 0x8e, 0xff, 0x8c, 0xb9, 0xa2, 0xff, 0x15, 0xb1, 0xf9, 0xff, 0x38, 0xad, 0xf1, 0xff, 0x15, 0xb1, 0xf9, 0xff, 0x94, 0xb5, 0x31, 0xff, 0x94, 0xb5, 0x31, 0xff, 0x6e, 0x39, 0x6a, 0xff, 0x4f, 0x4a, 0x8d, 0xff, 0x30, 0xee, 0xaf, 0xff, 0xd9, 0x6d, 0x67, 0xff, 0x30, 0xee, 0xaf, 0xff, 0x1f, 0xf7, 0xb5, 0xff,
+        0x1f, 0xae, 0x19, 0x5a, 0x1a, 0xae, 0x3c, 0x47, 0x1c, 0xb2, 0x2b, 0x50, 0x10, 0xae, 0x84, 0x21, 0x55, 0xf1, 0x98, 0x7d, 0xe5, 0xf1, 0x30, 0xab, 0x0e, 0xc8, 0xcb, 0x66, 0x0e, 0xd5, 0xcb, 0x66, 0x8b, 0x7e, 0x90, 0x40, 0x90, 0x8a, 0x89, 0x3d, 0x7e, 0x60, 0xa0, 0x48, 0x8b, 0x7e, 0x90, 0x40, 0x08, 0x59, 0xc3, 0x8a, 0xc7, 0x34, 0x1c, 0x5d, 0xc7, 0x34, 0x1c, 0x5d, 0x88, 0x40, 0x53, 0x6c,
+        0x35, 0x15, 0x17, 0xff, 0x3a, 0xa3, 0x7a, 0xff, 0x57, 0x69, 0xa1, 0xff, 0x39, 0x08, 0xde, 0xff, 0xa7, 0x53, 0xc4, 0xff, 0x76, 0x3e, 0xb0, 0xff, 0x99, 0x68, 0xb5, 0xff, 0x6d, 0x34, 0xaf, 0xff, 0x82, 0x49, 0xf7, 0xff, 0x94, 0xa5, 0x31, 0xff, 0x8f, 0x6f, 0x6a, 0xff, 0xbd, 0x18, 0xff, 0xff, 0x77, 0x51, 0xa8, 0xff, 0xe6, 0xd3, 0x7c, 0xff, 0xd0, 0xe9, 0xbe, 0xff, 0xd0, 0xe9, 0xbe, 0xff,
+        0x8a, 0x9b, 0x9d, 0x0c, 0x7f, 0x9b, 0x9d, 0x0c, 0x8a, 0xd6, 0xde, 0x29, 0x8a, 0xbf, 0xc5, 0x1d, 0x6a, 0x91, 0x53, 0xfb, 0x6a, 0x91, 0x30, 0xfb, 0x75, 0x68, 0x53, 0xb6, 0x6a, 0x91, 0x10, 0xfb, 0xb6, 0xdb, 0xb9, 0x70, 0x62, 0xc9, 0xab, 0x3e, 0x18, 0xb9, 0x9e, 0x12, 0x18, 0xb9, 0x9e, 0x12, 0x3a, 0x3e, 0x30, 0x51, 0x3a, 0x3e, 0x30, 0x51, 0x4e, 0x7e, 0xa4, 0x4e, 0x3a, 0x3e, 0x30, 0x51,
+        0x91, 0x26, 0x5a, 0xff, 0x4f, 0x23, 0x2c, 0xff, 0xb0, 0x27, 0x70, 0xff, 0xef, 0x29, 0x9c, 0xff, 0xa0, 0xbb, 0x8f, 0xff, 0x15, 0xb1, 0xf9, 0xff, 0x38, 0xad, 0xf1, 0xff, 0x0c, 0xa5, 0xfd, 0xff, 0x2e, 0x7b, 0x9a, 0xff, 0x44, 0xb6, 0x54, 0xff, 0x31, 0x5a, 0xad, 0xff, 0x6e, 0x39, 0x6a, 0xff, 0x30, 0xee, 0xaf, 0xff, 0x52, 0xdc, 0xa2, 0xff, 0x1f, 0xd1, 0xcf, 0xff, 0x1f, 0xf7, 0xb5, 0xff,
+        0x12, 0xba, 0x73, 0x2a, 0x15, 0xae, 0x61, 0x34, 0x1a, 0xae, 0x3c, 0x47, 0x15, 0xb6, 0x61, 0x34, 0x0e, 0xc8, 0xcb, 0x66, 0x55, 0xc8, 0x98, 0x7d, 0x9e, 0xc8, 0x63, 0x94, 0x9e, 0xf1, 0x63, 0x94, 0xb5, 0xdd, 0x5c, 0x26, 0x94, 0x94, 0x84, 0x3a, 0xaf, 0xd1, 0x63, 0x29, 0xb5, 0xdd, 0x5c, 0x26, 0xc7, 0x34, 0x1c, 0x5d, 0x47, 0x4d, 0x8c, 0x7b, 0x47, 0x4d, 0x8c, 0x7b, 0x30, 0x8a, 0x8a, 0xfb,
+        0x49, 0x85, 0x8e, 0xff, 0x2c, 0xbf, 0x67, 0xff, 0x65, 0x4d, 0xb3, 0xff, 0x10, 0xf7, 0x42, 0xff, 0xa7, 0x53, 0xc4, 0xff, 0x76, 0x3e, 0xb0, 0xff, 0x90, 0x5e, 0xb4, 0xff, 0x65, 0x2a, 0xae, 0xff, 0xbd, 0x18, 0xff, 0xff, 0x94, 0xa5, 0x31, 0xff, 0x84, 0x00, 0xde, 0xff, 0x43, 0x7c, 0xef, 0xff, 0x87, 0x6b, 0xd4, 0xff, 0x87, 0x6b, 0xd4, 0xff, 0xfc, 0xbe, 0x3e, 0xff, 0xe6, 0xd3, 0x7c, 0xff,
+        0x84, 0xa7, 0xaa, 0x11, 0x79, 0x9b, 0x9d, 0x0c, 0x8a, 0xa7, 0xaa, 0x11, 0x79, 0xd6, 0xde, 0x29, 0x6a, 0x91, 0x53, 0xfb, 0x82, 0x3d, 0x30, 0x6f, 0x82, 0x3d, 0x73, 0x6f, 0x6a, 0x91, 0x30, 0xfb, 0x9b, 0xd5, 0xb4, 0x60, 0x51, 0xc5, 0xa8, 0x34, 0x18, 0xb9, 0x9e, 0x12, 0x18, 0xb9, 0x9e, 0x12, 0x74, 0x1f, 0x34, 0x3c, 0x04, 0x5d, 0x2c, 0x65, 0xaa, 0x00, 0x38, 0x28, 0x74, 0x1f, 0x34, 0x3c,
+        0x4f, 0x23, 0x2c, 0xff, 0xef, 0x29, 0x9c, 0xff, 0xd0, 0x28, 0x86, 0xff, 0x2f, 0x22, 0x16, 0xff, 0x8c, 0xb9, 0xa2, 0xff, 0x15, 0xb1, 0xf9, 0xff, 0xc9, 0xc1, 0x68, 0xff, 0x23, 0xc5, 0xf2, 0xff, 0x44, 0xb6, 0x54, 0xff, 0x5a, 0xef, 0x10, 0xff, 0x8c, 0x29, 0x4a, 0xff, 0x6e, 0x39, 0x6a, 0xff, 0x1f, 0xf7, 0xb5, 0xff, 0x1f, 0xf7, 0xb5, 0xff, 0xd9, 0x6d, 0x67, 0xff, 0x1f, 0xd1, 0xcf, 0xff,
+        0x1a, 0xb2, 0x3c, 0x47, 0x1a, 0xb2, 0x3c, 0x47, 0x1f, 0xba, 0x19, 0x5a, 0x1f, 0xae, 0x19, 0x5a, 0xe5, 0xe4, 0x30, 0xab, 0x55, 0xd5, 0x98, 0x7d, 0x0e, 0xe4, 0xcb, 0x66, 0xe5, 0xd5, 0x30, 0xab, 0x9d, 0xa7, 0x7a, 0x34, 0x78, 0x54, 0xa7, 0x4b, 0x86, 0x74, 0x95, 0x43, 0xb9, 0xe7, 0x57, 0x23, 0xc7, 0x34, 0x1c, 0x5d, 0x30, 0x8a, 0x8a, 0xfb, 0x61, 0x85, 0xaa, 0x52, 0x61, 0x85, 0xaa, 0x52,
+    };
+
+    struct GoldenSet
+    {
+        DXGI_FORMAT     format;
+        const char*     name;
+        size_t          numBlocks;
+        unsigned int    channels;   // per texel in texels
+        const uint8_t*  blocks;
+        const uint8_t*  texels;
+    };
+
+    const GoldenSet kSets[] =
+    {
+        { DXGI_FORMAT_BC1_UNORM, "BC1", 16, 4, kBC1Blocks, kBC1Texels },
+        { DXGI_FORMAT_BC2_UNORM, "BC2", 16, 4, kBC2Blocks, kBC2Texels },
+        { DXGI_FORMAT_BC3_UNORM, "BC3", 16, 4, kBC3Blocks, kBC3Texels },
+        { DXGI_FORMAT_BC4_UNORM, "BC4_UNORM", 16, 1, kBC4_UNORMBlocks, kBC4_UNORMTexels },
+        { DXGI_FORMAT_BC5_UNORM, "BC5_UNORM", 16, 3, kBC5_UNORMBlocks, kBC5_UNORMTexels },
+        { DXGI_FORMAT_BC7_UNORM, "BC7", 16, 4, kBC7Blocks, kBC7Texels },
+    };
+}
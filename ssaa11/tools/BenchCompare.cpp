@@ -0,0 +1,868 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: BenchCompare.cpp
+//
+// Compares two benchmark runs of the sample (SSAA11_Benchmark.json, written by the
+// -benchmark command line option or F4) and fails if the candidate is significantly slower
+// than the baseline. Each scene / format / AA mode / timer is compared on its own:
+//
+//   - Mann-Whitney U test (default): a rank test of whether candidate frame times tend to be
+//     larger, with tie correction and a normal approximation
+//   - or a bootstrap of the ratio of the medians, with a confidence interval
+//
+// p-values are Holm-Bonferroni corrected over all comparisons, as one run compares up to a
+// hundred settings. A comparison is a regression if its corrected p-value is below alpha,
+// the median is slower by at least the threshold, and Cliff's delta (the probability that a
+// candidate frame is slower than a baseline frame, minus the reverse) is at least the minimum
+// effect size. So small but real changes, and large but noisy ones, don't fail the gate.
+//
+// A setting of the baseline that the candidate has no frames for, e.g. because the run
+// crashed or was cut short, fails like a regression unless --allow-missing is given, for
+// candidates that only run a subset on purpose.
+//
+// The exit code is 0 without regressions, 1 with regressions or missing settings, 2 on bad
+// arguments or input, or if nothing could be compared.
+// It only uses the C++ standard library, so it builds anywhere, e.g. on Linux:
+//   g++ -O2 -o BenchCompare BenchCompare.cpp
+// or with premake: premake5 --file=premake5_benchcompare.lua gmake2 (or vs2015, ...)
+//--------------------------------------------------------------------------------------
+#define _CRT_SECURE_NO_WARNINGS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int kExitOk = 0;
+    const int kExitRegression = 1;
+    const int kExitError = 2;
+
+    //--------------------------------------------------------------------------------------
+    // A minimal JSON reader, enough for the benchmark files
+    //--------------------------------------------------------------------------------------
+    struct JsonValue
+    {
+        enum Type { Null, Bool, Number, String, Array, Object };
+
+        JsonValue() : m_Type( Null ), m_Number( 0.0 ) {}
+
+        const JsonValue* Find( const char* key ) const
+        {
+            for (size_t i = 0; i < m_Keys.size(); i++)
+            {
+                if (m_Keys[i] == key)
+                {
+                    return &m_Items[i];
+                }
+            }
+            return NULL;
+        }
+
+        Type                    m_Type;
+        double                  m_Number;       // also 0 / 1 for Bool
+        std::string             m_String;
+        std::vector<JsonValue>  m_Items;        // array elements, or object values
+        std::vector<std::string> m_Keys;        // object keys, in the order of m_Items
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser( const char* text ) : m_Text( text ), m_Pos( text ), m_Error( NULL ) {}
+
+        bool Parse( JsonValue& o_Value )
+        {
+            if (!ParseValue( o_Value, 0 ))
+            {
+                return false;
+            }
+            SkipSpace();
+            return (0 == *m_Pos) || Fail( "trailing characters" );
+        }
+
+        const char* GetError() const { return m_Error; }
+        size_t GetErrorOffset() const { return (size_t)(m_Pos - m_Text); }
+
+    private:
+        bool Fail( const char* error )
+        {
+            m_Error = error;
+            return false;
+        }
+
+        void SkipSpace()
+        {
+            while (' ' == *m_Pos || '\t' == *m_Pos || '\n' == *m_Pos || '\r' == *m_Pos)
+            {
+                m_Pos++;
+            }
+        }
+
+        bool Literal( const char* literal )
+        {
+            size_t len = strlen( literal );
+            if (0 != strncmp( m_Pos, literal, len ))
+            {
+                return Fail( "invalid literal" );
+            }
+            m_Pos += len;
+            return true;
+        }
+
+        bool ParseString( std::string& o_String )
+        {
+            m_Pos++;    // opening quote
+            o_String.clear();
+            while ('"' != *m_Pos)
+            {
+                if (0 == *m_Pos)
+                {
+                    return Fail( "unterminated string" );
+                }
+                if ('\\' == *m_Pos)
+                {
+                    m_Pos++;
+                    switch (*m_Pos)
+                    {
+                    case 'n': o_String += '\n'; break;
+                    case 't': o_String += '\t'; break;
+                    case 'r': o_String += '\r'; break;
+                    case 'b': o_String += '\b'; break;
+                    case 'f': o_String += '\f'; break;
+                    case 'u':
+                        // the names in benchmark files are ASCII; keep other characters as '?'
+                        for (int i = 1; i <= 4; i++)
+                        {
+                            if (!isxdigit( (unsigned char)m_Pos[i] ))
+                            {
+                                return Fail( "invalid \\u escape" );
+                            }
+                        }
+                        {
+                            unsigned int code = (unsigned int)strtoul( std::string( m_Pos + 1, 4 ).c_str(), NULL, 16 );
+                            o_String += (code < 0x80) ? (char)code : '?';
+                        }
+                        m_Pos += 4;
+                        break;
+                    case 0:
+                        return Fail( "unterminated string" );
+                    default:
+                        o_String += *m_Pos;
+                        break;
+                    }
+                    m_Pos++;
+                }
+                else
+                {
+                    o_String += *m_Pos++;
+                }
+            }
+            m_Pos++;
+            return true;
+        }
+
+        bool ParseValue( JsonValue& o_Value, int depth )
+        {
+            if (depth > 64)
+            {
+                return Fail( "nested too deeply" );
+            }
+
+            SkipSpace();
+            switch (*m_Pos)
+            {
+            case '{':
+                o_Value.m_Type = JsonValue::Object;
+                m_Pos++;
+                SkipSpace();
+                if ('}' == *m_Pos)
+                {
+                    m_Pos++;
+                    return true;
+                }
+                for (;;)
+                {
+                    SkipSpace();
+                    if ('"' != *m_Pos)
+                    {
+                        return Fail( "expected a key" );
+                    }
+                    o_Value.m_Keys.push_back( std::string() );
+                    if (!ParseString( o_Value.m_Keys.back() ))
+                    {
+                        return false;
+                    }
+                    SkipSpace();
+                    if (':' != *m_Pos++)
+                    {
+                        return Fail( "expected ':'" );
+                    }
+                    o_Value.m_Items.push_back( JsonValue() );
+                    if (!ParseValue( o_Value.m_Items.back(), depth + 1 ))
+                    {
+                        return false;
+                    }
+                    SkipSpace();
+                    if ('}' == *m_Pos)
+                    {
+                        m_Pos++;
+                        return true;
+                    }
+                    if (',' != *m_Pos++)
+                    {
+                        return Fail( "expected ',' or '}'" );
+                    }
+                }
+
+            case '[':
+                o_Value.m_Type = JsonValue::Array;
+                m_Pos++;
+                SkipSpace();
+                if (']' == *m_Pos)
+                {
+                    m_Pos++;
+                    return true;
+                }
+                for (;;)
+                {
+                    o_Value.m_Items.push_back( JsonValue() );
+                    if (!ParseValue( o_Value.m_Items.back(), depth + 1 ))
+                    {
+                        return false;
+                    }
+                    SkipSpace();
+                    if (']' == *m_Pos)
+                    {
+                        m_Pos++;
+                        return true;
+                    }
+                    if (',' != *m_Pos++)
+                    {
+                        return Fail( "expected ',' or ']'" );
+                    }
+                }
+
+            case '"':
+                o_Value.m_Type = JsonValue::String;
+                return ParseString( o_Value.m_String );
+
+            case 't':
+                o_Value.m_Type = JsonValue::Bool;
+                o_Value.m_Number = 1.0;
+                return Literal( "true" );
+
+            case 'f':
+                o_Value.m_Type = JsonValue::Bool;
+                return Literal( "false" );
+
+            case 'n':
+                return Literal( "null" );
+
+            default:
+                {
+                    char* end = NULL;
+                    o_Value.m_Type = JsonValue::Number;
+                    o_Value.m_Number = strtod( m_Pos, &end );
+                    if (end == m_Pos)
+                    {
+                        return Fail( "unexpected character" );
+                    }
+                    m_Pos = end;
+                    return true;
+                }
+            }
+        }
+
+        const char*     m_Text;
+        const char*     m_Pos;
+        const char*     m_Error;
+    };
+
+    //--------------------------------------------------------------------------------------
+    // Benchmark files: frame times per scene / format / mode / timer
+    //--------------------------------------------------------------------------------------
+    typedef std::map< std::string, std::vector<double> > SampleMap;
+
+    std::string MakeKey( const std::string& scene, const std::string& format, const std::string& mode, const std::string& timer )
+    {
+        return scene + " | " + format + " | " + mode + " | " + timer;
+    }
+
+    bool LoadBenchmark( const char* path, SampleMap& o_Samples )
+    {
+        FILE* file = fopen( path, "rb" );
+        if (!file)
+        {
+            fprintf( stderr, "error: can't open %s\n", path );
+            return false;
+        }
+
+        std::string text;
+        char buffer[64 * 1024];
+        size_t read;
+        while (0 < (read = fread( buffer, 1, sizeof( buffer ), file )))
+        {
+            text.append( buffer, read );
+        }
+        fclose( file );
+
+        JsonValue root;
+        JsonParser parser( text.c_str() );
+        if (!parser.Parse( root ))
+        {
+            fprintf( stderr, "error: %s: %s at offset %u\n", path, parser.GetError(), (unsigned int)parser.GetErrorOffset() );
+            return false;
+        }
+
+        const JsonValue* runs = root.Find( "runs" );
+        if (!runs || JsonValue::Array != runs->m_Type)
+        {
+            fprintf( stderr, "error: %s has no \"runs\" array\n", path );
+            return false;
+        }
+
+        for (size_t r = 0; r < runs->m_Items.size(); r++)
+        {
+            const JsonValue& run = runs->m_Items[r];
+            const JsonValue* scene = run.Find( "scene" );
+            const JsonValue* format = run.Find( "format" );
+            const JsonValue* mode = run.Find( "mode" );
+            const JsonValue* timers = run.Find( "timers" );
+            if (!scene || !format || !mode || !timers || JsonValue::Object != timers->m_Type)
+            {
+                fprintf( stderr, "error: %s: run %u needs \"scene\", \"format\", \"mode\" and \"timers\"\n", path, (unsigned int)r );
+                return false;
+            }
+
+            for (size_t t = 0; t < timers->m_Items.size(); t++)
+            {
+                std::vector<double>& samples = o_Samples[ MakeKey( scene->m_String, format->m_String, mode->m_String, timers->m_Keys[t] ) ];
+                const JsonValue& times = timers->m_Items[t];
+                for (size_t i = 0; i < times.m_Items.size(); i++)
+                {
+                    // a GPU timer that had no result yet reports 0
+                    if (JsonValue::Number == times.m_Items[i].m_Type && times.m_Items[i].m_Number > 0.0)
+                    {
+                        samples.push_back( times.m_Items[i].m_Number );
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Statistics
+    //--------------------------------------------------------------------------------------
+    double Median( std::vector<double> values )
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        size_t mid = values.size() / 2;
+        std::nth_element( values.begin(), values.begin() + mid, values.end() );
+        double median = values[mid];
+        if (0 == values.size() % 2)
+        {
+            median = 0.5 * (median + *std::max_element( values.begin(), values.begin() + mid ));
+        }
+        return median;
+    }
+
+    // complementary error function, fractional error below 1.2e-7 (Numerical Recipes erfcc);
+    // erfc isn't in every supported compiler's math.h
+    double Erfc( double x )
+    {
+        double z = fabs( x );
+        double t = 1.0 / (1.0 + 0.5 * z);
+        double r = t * exp( -z * z - 1.26551223 + t * (1.00002368 + t * (0.37409196 + t * (0.09678418 +
+            t * (-0.18628806 + t * (0.27886807 + t * (-1.13520398 + t * (1.48851587 +
+            t * (-0.82215223 + t * 0.17087277)))))))) );
+        return (x >= 0.0) ? r : 2.0 - r;
+    }
+
+    // P(Z > z) for a standard normal Z
+    double NormalUpperTail( double z )
+    {
+        return 0.5 * Erfc( z / sqrt( 2.0 ) );
+    }
+
+    struct Comparison
+    {
+        std::string     m_Key;
+        size_t          m_NumBaseline;
+        size_t          m_NumCandidate;
+        double          m_BaselineMedian;
+        double          m_CandidateMedian;
+        double          m_Change;           // of the median, candidate / baseline - 1
+        double          m_CliffsDelta;      // P(candidate > baseline) - P(candidate < baseline)
+        double          m_P;                // one-sided, that the candidate is slower
+        double          m_PAdjusted;        // after the Holm-Bonferroni correction
+        double          m_Low;              // bootstrap confidence interval of the change
+        double          m_High;
+        bool            m_HasInterval;
+    };
+
+    // Mann-Whitney U of the candidate against the baseline. Returns the one-sided p-value for
+    // the candidate's frame times being stochastically larger, and Cliff's delta
+    double MannWhitney( const std::vector<double>& baseline, const std::vector<double>& candidate, double& o_CliffsDelta )
+    {
+        const size_t n1 = baseline.size();
+        const size_t n2 = candidate.size();
+        const double n = (double)(n1 + n2);
+
+        // rank the pooled samples, ties get their average rank
+        std::vector< std::pair<double, int> > pooled;
+        pooled.reserve( n1 + n2 );
+        for (size_t i = 0; i < n1; i++)
+        {
+            pooled.push_back( std::make_pair( baseline[i], 0 ) );
+        }
+        for (size_t i = 0; i < n2; i++)
+        {
+            pooled.push_back( std::make_pair( candidate[i], 1 ) );
+        }
+        std::sort( pooled.begin(), pooled.end() );
+
+        double candidateRankSum = 0.0;
+        double tieSum = 0.0;
+        for (size_t i = 0; i < pooled.size(); )
+        {
+            size_t j = i + 1;
+            while (j < pooled.size() && pooled[j].first == pooled[i].first)
+            {
+                j++;
+            }
+
+            const double rank = 0.5 * (double)(i + 1 + j);     // average of ranks i + 1 .. j
+            for (size_t k = i; k < j; k++)
+            {
+                if (1 == pooled[k].second)
+                {
+                    candidateRankSum += rank;
+                }
+            }
+
+            const double t = (double)(j - i);
+            tieSum += t * t * t - t;
+            i = j;
+        }
+
+        const double u = candidateRankSum - 0.5 * (double)n2 * (double)(n2 + 1);
+        const double mean = 0.5 * (double)n1 * (double)n2;
+        const double variance = (double)n1 * (double)n2 / 12.0 * ((n + 1.0) - tieSum / (n * (n - 1.0)));
+
+        o_CliffsDelta = u / mean - 1.0;
+
+        if (variance <= 0.0)
+        {
+            // all samples are equal
+            return 1.0;
+        }
+
+        // with continuity correction
+        const double z = (u - mean - 0.5) / sqrt( variance );
+        return NormalUpperTail( z );
+    }
+
+    // xorshift64*, so bootstrap runs are repeatable for a given seed
+    class Random
+    {
+    public:
+        Random( unsigned long long seed ) : m_State( seed ? seed : 0x9E3779B97F4A7C15ull ) {}
+
+        size_t Next( size_t range )
+        {
+            m_State ^= m_State >> 12;
+            m_State ^= m_State << 25;
+            m_State ^= m_State >> 27;
+            return (size_t)(((m_State * 2685821657736338717ull) >> 11) % range);
+        }
+
+    private:
+        unsigned long long m_State;
+    };
+
+    // Bootstraps the ratio of the medians. Returns the one-sided p-value for the candidate
+    // being slower (the fraction of resamples where it isn't), and the confidence interval
+    // of the change at the given alpha
+    double Bootstrap( const std::vector<double>& baseline, const std::vector<double>& candidate, unsigned int numResamples,
+        Random& random, double alpha, double& o_Low, double& o_High )
+    {
+        std::vector<double> changes( numResamples );
+        std::vector<double> resampledBaseline( baseline.size() );
+        std::vector<double> resampledCandidate( candidate.size() );
+
+        unsigned int notSlower = 0;
+        for (unsigned int b = 0; b < numResamples; b++)
+        {
+            for (size_t i = 0; i < baseline.size(); i++)
+            {
+                resampledBaseline[i] = baseline[ random.Next( baseline.size() ) ];
+            }
+            for (size_t i = 0; i < candidate.size(); i++)
+            {
+                resampledCandidate[i] = candidate[ random.Next( candidate.size() ) ];
+            }
+
+            changes[b] = Median( resampledCandidate ) / Median( resampledBaseline ) - 1.0;
+            if (changes[b] <= 0.0)
+            {
+                notSlower++;
+            }
+        }
+
+        std::sort( changes.begin(), changes.end() );
+        size_t low = (size_t)floor( 0.5 * alpha * (double)(numResamples - 1) );
+        size_t high = (size_t)ceil( (1.0 - 0.5 * alpha) * (double)(numResamples - 1) );
+        o_Low = changes[low];
+        o_High = changes[high];
+
+        // never exactly 0: with B resamples, p can't be resolved below 1 / (B + 1)
+        return (double)(notSlower + 1) / (double)(numResamples + 1);
+    }
+
+    // Holm-Bonferroni: the i-th smallest of m p-values is scaled by (m - i), and kept monotone
+    void HolmCorrection( std::vector<Comparison>& io_Comparisons )
+    {
+        std::vector< std::pair<double, size_t> > order;
+        for (size_t i = 0; i < io_Comparisons.size(); i++)
+        {
+            order.push_back( std::make_pair( io_Comparisons[i].m_P, i ) );
+        }
+        std::sort( order.begin(), order.end() );
+
+        double previous = 0.0;
+        const size_t m = order.size();
+        for (size_t i = 0; i < m; i++)
+        {
+            double adjusted = std::min( 1.0, order[i].first * (double)(m - i) );
+            previous = std::max( previous, adjusted );
+            io_Comparisons[ order[i].second ].m_PAdjusted = previous;
+        }
+    }
+
+    // Romano et al.'s thresholds for Cliff's delta
+    const char* EffectSizeName( double delta )
+    {
+        double magnitude = fabs( delta );
+        return (magnitude < 0.147) ? "negligible" : (magnitude < 0.33) ? "small" : (magnitude < 0.474) ? "medium" : "large";
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Command line
+    //--------------------------------------------------------------------------------------
+    struct Options
+    {
+        Options() :
+            m_Baseline( NULL ),
+            m_Candidate( NULL ),
+            m_Bootstrap( false ),
+            m_Alpha( 0.01 ),
+            m_Threshold( 0.03 ),
+            m_MinEffect( 0.33 ),
+            m_NumResamples( 10000 ),
+            m_Seed( 1 ),
+            m_Correction( true ),
+            m_MinSamples( 10 ),
+            m_AllowMissing( false ),
+            m_Verbose( false )
+        {
+        }
+
+        const char*                 m_Baseline;
+        const char*                 m_Candidate;
+        bool                        m_Bootstrap;
+        double                      m_Alpha;
+        double                      m_Threshold;        // fraction the median must be slower by
+        double                      m_MinEffect;        // Cliff's delta
+        unsigned int                m_NumResamples;
+        unsigned long long          m_Seed;
+        bool                        m_Correction;
+        unsigned int                m_MinSamples;
+        bool                        m_AllowMissing;     // settings only in the baseline don't fail
+        bool                        m_Verbose;
+        std::vector<std::string>    m_Timers;           // empty for all
+    };
+
+    void PrintUsage()
+    {
+        printf(
+            "usage: BenchCompare [options] baseline.json candidate.json\n"
+            "\n"
+            "Compares two SSAA11 benchmark runs, and exits with 1 if the candidate has a\n"
+            "significant regression or lacks a setting of the baseline, 2 on errors or if\n"
+            "nothing could be compared, 0 otherwise.\n"
+            "\n"
+            "  --method mwu|bootstrap  Mann-Whitney U test (default) or bootstrap of the median ratio\n"
+            "  --alpha A               significance level, after correction (default 0.01)\n"
+            "  --threshold PERCENT     how much slower the median must be to fail (default 3)\n"
+            "  --min-effect D          smallest Cliff's delta that fails (default 0.33, medium)\n"
+            "  --resamples N           bootstrap resamples (default 10000); p can't go below 1 / (N + 1)\n"
+            "  --seed N                bootstrap random seed (default 1)\n"
+            "  --timer NAME            only compare this timer, e.g. \"AA Resolve\"; may be repeated\n"
+            "  --min-samples N         skip comparisons with fewer frames (default 10)\n"
+            "  --no-correction         don't apply the Holm-Bonferroni correction\n"
+            "  --allow-missing         don't fail on settings the candidate has no frames for\n"
+            "  --verbose               print every comparison, not just changes\n" );
+    }
+
+    bool ParseNumber( const char* text, double& o_Value )
+    {
+        char* end = NULL;
+        o_Value = strtod( text, &end );
+        return end != text && 0 == *end;
+    }
+
+    bool ParseOptions( int argc, char** argv, Options& o_Options )
+    {
+        std::vector<const char*> files;
+        for (int i = 1; i < argc; i++)
+        {
+            const char* arg = argv[i];
+            const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+            double number = 0.0;
+
+            if (0 == strcmp( arg, "--no-correction" ))
+            {
+                o_Options.m_Correction = false;
+            }
+            else if (0 == strcmp( arg, "--allow-missing" ))
+            {
+                o_Options.m_AllowMissing = true;
+            }
+            else if (0 == strcmp( arg, "--verbose" ))
+            {
+                o_Options.m_Verbose = true;
+            }
+            else if (0 == strcmp( arg, "--help" ) || 0 == strcmp( arg, "-h" ))
+            {
+                return false;
+            }
+            else if (0 == strncmp( arg, "--", 2 ))
+            {
+                if (!value)
+                {
+                    fprintf( stderr, "error: %s needs a value\n", arg );
+                    return false;
+                }
+                i++;
+
+                if (0 == strcmp( arg, "--method" ))
+                {
+                    if (0 != strcmp( value, "mwu" ) && 0 != strcmp( value, "bootstrap" ))
+                    {
+                        fprintf( stderr, "error: unknown method %s\n", value );
+                        return false;
+                    }
+                    o_Options.m_Bootstrap = (0 == strcmp( value, "bootstrap" ));
+                }
+                else if (0 == strcmp( arg, "--timer" ))
+                {
+                    o_Options.m_Timers.push_back( value );
+                }
+                else if (!ParseNumber( value, number ) || number < 0.0)
+                {
+                    fprintf( stderr, "error: %s needs a non-negative number, not %s\n", arg, value );
+                    return false;
+                }
+                else if (0 == strcmp( arg, "--alpha" ) && number > 0.0 && number < 1.0)
+                {
+                    o_Options.m_Alpha = number;
+                }
+                else if (0 == strcmp( arg, "--threshold" ))
+                {
+                    o_Options.m_Threshold = number * 0.01;
+                }
+                else if (0 == strcmp( arg, "--min-effect" ) && number <= 1.0)
+                {
+                    o_Options.m_MinEffect = number;
+                }
+                else if (0 == strcmp( arg, "--resamples" ) && number >= 100.0)
+                {
+                    o_Options.m_NumResamples = (unsigned int)number;
+                }
+                else if (0 == strcmp( arg, "--seed" ))
+                {
+                    o_Options.m_Seed = (unsigned long long)number;
+                }
+                else if (0 == strcmp( arg, "--min-samples" ) && number >= 2.0)
+                {
+                    o_Options.m_MinSamples = (unsigned int)number;
+                }
+                else
+                {
+                    fprintf( stderr, "error: unknown option or value out of range: %s %s\n", arg, value );
+                    return false;
+                }
+            }
+            else
+            {
+                files.push_back( arg );
+            }
+        }
+
+        if (2 != files.size())
+        {
+            fprintf( stderr, "error: expected a baseline and a candidate file\n" );
+            return false;
+        }
+
+        o_Options.m_Baseline = files[0];
+        o_Options.m_Candidate = files[1];
+        return true;
+    }
+
+    bool IsTimerSelected( const Options& options, const std::string& key )
+    {
+        if (options.m_Timers.empty())
+        {
+            return true;
+        }
+
+        // the timer is the last part of the key
+        std::string timer = key.substr( key.rfind( " | " ) + 3 );
+        return options.m_Timers.end() != std::find( options.m_Timers.begin(), options.m_Timers.end(), timer );
+    }
+}
+
+
+int main( int argc, char** argv )
+{
+    Options options;
+    if (!ParseOptions( argc, argv, options ))
+    {
+        PrintUsage();
+        return kExitError;
+    }
+
+    SampleMap baseline, candidate;
+    if (!LoadBenchmark( options.m_Baseline, baseline ) || !LoadBenchmark( options.m_Candidate, candidate ))
+    {
+        return kExitError;
+    }
+
+    std::vector<Comparison> comparisons;
+    unsigned int numMissing = 0, numSkipped = 0;
+    Random random( options.m_Seed );
+
+    for (SampleMap::const_iterator it = baseline.begin(); it != baseline.end(); ++it)
+    {
+        if (!IsTimerSelected( options, it->first ))
+        {
+            continue;
+        }
+
+        SampleMap::const_iterator match = candidate.find( it->first );
+        if (candidate.end() == match)
+        {
+            // e.g. EQAA modes on a GPU without them, or a run that didn't finish
+            printf( "%-11s %s\n", options.m_AllowMissing ? "missing" : "MISSING", it->first.c_str() );
+            numMissing++;
+            continue;
+        }
+
+        const std::vector<double>& a = it->second;
+        const std::vector<double>& b = match->second;
+        if (a.size() < options.m_MinSamples || b.size() < options.m_MinSamples)
+        {
+            printf( "skipped     %s (%u / %u frames)\n", it->first.c_str(), (unsigned int)a.size(), (unsigned int)b.size() );
+            numSkipped++;
+            continue;
+        }
+
+        Comparison c;
+        c.m_Key = it->first;
+        c.m_NumBaseline = a.size();
+        c.m_NumCandidate = b.size();
+        c.m_BaselineMedian = Median( a );
+        c.m_CandidateMedian = Median( b );
+        c.m_Change = (c.m_BaselineMedian > 0.0) ? c.m_CandidateMedian / c.m_BaselineMedian - 1.0 : 0.0;
+        c.m_Low = c.m_High = 0.0;
+        c.m_HasInterval = false;
+
+        c.m_P = MannWhitney( a, b, c.m_CliffsDelta );
+        if (options.m_Bootstrap)
+        {
+            c.m_P = Bootstrap( a, b, options.m_NumResamples, random, options.m_Alpha, c.m_Low, c.m_High );
+            c.m_HasInterval = true;
+        }
+        c.m_PAdjusted = c.m_P;
+        comparisons.push_back( c );
+    }
+
+    if (options.m_Correction)
+    {
+        HolmCorrection( comparisons );
+    }
+
+    unsigned int numRegressions = 0, numImprovements = 0;
+    for (size_t i = 0; i < comparisons.size(); i++)
+    {
+        const Comparison& c = comparisons[i];
+
+        const bool bigEnough = fabs( c.m_Change ) >= options.m_Threshold && fabs( c.m_CliffsDelta ) >= options.m_MinEffect;
+        const bool regression = bigEnough && c.m_Change > 0.0 && c.m_PAdjusted < options.m_Alpha;
+        // the test is one-sided, so an improvement isn't tested, only reported by its size
+        const bool improvement = bigEnough && c.m_Change < 0.0 && c.m_CliffsDelta < 0.0;
+
+        numRegressions += regression ? 1 : 0;
+        numImprovements += improvement ? 1 : 0;
+
+        if (!regression && !improvement && !options.m_Verbose)
+        {
+            continue;
+        }
+
+        printf( "%-11s %s\n", regression ? "REGRESSION" : improvement ? "improvement" : "unchanged", c.m_Key.c_str() );
+        printf( "            median %.4f -> %.4f ms (%+.1f%%), Cliff's delta %+.2f (%s), p %.2g",
+            c.m_BaselineMedian, c.m_CandidateMedian, c.m_Change * 100.0, c.m_CliffsDelta, EffectSizeName( c.m_CliffsDelta ), c.m_PAdjusted );
+        if (c.m_HasInterval)
+        {
+            printf( ", %g%% CI %+.1f%% .. %+.1f%%", (1.0 - options.m_Alpha) * 100.0, c.m_Low * 100.0, c.m_High * 100.0 );
+        }
+        printf( ", %u / %u frames\n", (unsigned int)c.m_NumBaseline, (unsigned int)c.m_NumCandidate );
+    }
+
+    printf( "\n%u compared (%s%s), %u regressions, %u improvements, %u missing, %u skipped\n",
+        (unsigned int)comparisons.size(), options.m_Bootstrap ? "bootstrap" : "Mann-Whitney U",
+        options.m_Correction ? ", Holm corrected" : "", numRegressions, numImprovements, numMissing, numSkipped );
+
+    if (comparisons.empty())
+    {
+        fprintf( stderr, "error: nothing to compare\n" );
+        return kExitError;
+    }
+
+    return (0 < numRegressions || (0 < numMissing && !options.m_AllowMissing)) ? kExitRegression : kExitOk;
+}
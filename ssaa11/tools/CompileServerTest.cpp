@@ -0,0 +1,340 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: CompileServerTest.cpp
+//
+// Drives the shader compile server (amd_sdk/src/ShaderCompileServer.cpp) over its named
+// pipe, with ShaderCompileServer::MockCompile in place of d3dcompiler. MockCompile returns
+// the source as the bytecode, after a delay, so every response can be checked exactly and
+// compiles overlap long enough for identical requests to meet in flight.
+//
+//   - concurrent clients send the same shader at the same time, and others send distinct
+//     shaders (different sources, and the same source with different macros); each must
+//     get its own source back, and the shared shader must be compiled exactly once
+//   - a lookup without source is answered from the cache, or with NEED_SOURCE
+//   - compile errors come back with their text, and aren't cached
+//   - a malformed request is rejected by ProcessRequest
+//   - a second server on the same archive directory serves the shaders without compiling
+//
+// The exit code is 0 if every check passes, 1 on failures, 2 if the server can't start.
+// It doesn't need a device, e.g. with premake: premake5 --file=premake5_compileservertest.lua vs2015
+//--------------------------------------------------------------------------------------
+#include "..\\..\\DXUT\\Core\\DXUT.h"
+#include "..\\..\\amd_sdk\\src\\ShaderCompileServer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace AMD;
+using namespace AMD::ShaderCompileProtocol;
+
+namespace
+{
+    const int kExitOk = 0;
+    const int kExitFailed = 1;
+    const int kExitError = 2;
+
+    // Long enough that every client sends its request while the first compile runs
+    const DWORD kdwCompileDelayMs = 250;
+
+    const unsigned int kuNumIdentical = 8;
+
+    struct Shader
+    {
+        const char*     m_pszSource;
+        const char*     m_pszMacro;     // NULL for none
+        int             m_iMacroValue;
+    };
+
+    // The first is sent by kuNumIdentical clients, the others by one client each
+    const Shader kShaders[] =
+    {
+        { "float4 main() : SV_Target { return 1; }",        NULL,       0 },
+        { "float4 main() : SV_Target { return 0.5; }",      NULL,       0 },
+        { "float4 main() : SV_Target { return VALUE; }",    "VALUE",    1 },
+        { "float4 main() : SV_Target { return VALUE; }",    "VALUE",    2 },
+    };
+
+    const unsigned int kuNumShaders = sizeof( kShaders ) / sizeof( kShaders[0] );
+
+    int g_iNumFailures = 0;
+
+    void Check( bool bCondition, const char* pszWhat )
+    {
+        printf( "%-64s %s\n", pszWhat, bCondition ? "ok" : "FAILED" );
+        if (!bCondition)
+        {
+            g_iNumFailures++;
+        }
+    }
+
+    // The server keys on the hash the client sends and doesn't check it, so anything that
+    // differs between sources will do
+    void HashSource( const char* pszSource, unsigned char (&o_Hash)[HASH_LENGTH] )
+    {
+        unsigned long long uHash = 14695981039346656037ULL;
+        for (const char* p = pszSource; *p; p++)
+        {
+            uHash = (uHash ^ (unsigned char)*p) * 1099511628211ULL;
+        }
+
+        for (unsigned int i = 0; i < HASH_LENGTH; i++)
+        {
+            o_Hash[i] = (unsigned char)(uHash >> ((i % 8) * 8));
+        }
+    }
+
+    HRESULT CompileShader( ShaderCompileClient& i_Client, const Shader& i_Shader, bool bSendSource,
+                           std::vector<BYTE>& o_Bytecode, std::string& o_Errors )
+    {
+        unsigned char hash[HASH_LENGTH];
+        HashSource( i_Shader.m_pszSource, hash );
+
+        Macro macro;
+        ZeroMemory( &macro, sizeof( macro ) );
+        if (i_Shader.m_pszMacro)
+        {
+            strncpy_s( macro.m_szName, i_Shader.m_pszMacro, _TRUNCATE );
+            macro.m_iValue = i_Shader.m_iMacroValue;
+        }
+
+        return i_Client.Compile( hash, "main", "ps_5_0", 0, &macro, i_Shader.m_pszMacro ? 1 : 0,
+            bSendSource ? i_Shader.m_pszSource : NULL, bSendSource ? strlen( i_Shader.m_pszSource ) : 0,
+            o_Bytecode, o_Errors );
+    }
+
+    bool IsSource( const std::vector<BYTE>& i_Bytecode, const char* pszSource )
+    {
+        return (i_Bytecode.size() == strlen( pszSource )) && (0 == memcmp( &i_Bytecode[0], pszSource, i_Bytecode.size() ));
+    }
+
+    struct ClientThreadArgs
+    {
+        const wchar_t*      m_pwsPipeName;
+        HANDLE              m_hReadySemaphore;  // released by each client once it's connected
+        HANDLE              m_hStartEvent;
+        unsigned int        m_uShader;
+        HRESULT             m_hr;
+        bool                m_bMatches;
+    };
+
+    DWORD WINAPI ClientThreadProc( LPVOID pParameter )
+    {
+        ClientThreadArgs* pArgs = (ClientThreadArgs*)pParameter;
+        pArgs->m_hr = E_FAIL;
+        pArgs->m_bMatches = false;
+
+        ShaderCompileClient client;
+        bool bConnected = client.Connect( pArgs->m_pwsPipeName, 5000 );
+        ReleaseSemaphore( pArgs->m_hReadySemaphore, 1, NULL );
+        if (!bConnected)
+        {
+            return 0;
+        }
+
+        WaitForSingleObject( pArgs->m_hStartEvent, INFINITE );
+
+        std::vector<BYTE> bytecode;
+        std::string errors;
+        pArgs->m_hr = CompileShader( client, kShaders[pArgs->m_uShader], true, bytecode, errors );
+        pArgs->m_bMatches = SUCCEEDED( pArgs->m_hr ) && IsSource( bytecode, kShaders[pArgs->m_uShader].m_pszSource );
+        return 0;
+    }
+
+    void TestConcurrentRequests( ShaderCompileServer& io_Server, const wchar_t* pwsPipeName )
+    {
+        const unsigned int uNumClients = kuNumIdentical + kuNumShaders - 1;
+        std::vector<ClientThreadArgs> args( uNumClients );
+        std::vector<HANDLE> threads;
+
+        HANDLE hReadySemaphore = CreateSemaphore( NULL, 0, (LONG)uNumClients, NULL );
+        HANDLE hStartEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+        for (unsigned int i = 0; i < uNumClients; i++)
+        {
+            args[i].m_pwsPipeName = pwsPipeName;
+            args[i].m_hReadySemaphore = hReadySemaphore;
+            args[i].m_hStartEvent = hStartEvent;
+            args[i].m_uShader = (i < kuNumIdentical) ? 0 : (i - kuNumIdentical + 1);
+
+            HANDLE hThread = CreateThread( NULL, 0, ClientThreadProc, &args[i], 0, NULL );
+            if (hThread)
+            {
+                threads.push_back( hThread );
+            }
+        }
+
+        // Every client connects first, so the requests arrive together
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            WaitForSingleObject( hReadySemaphore, INFINITE );
+        }
+        SetEvent( hStartEvent );
+        if (!threads.empty())
+        {
+            WaitForMultipleObjects( (DWORD)threads.size(), &threads[0], TRUE, INFINITE );
+        }
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            CloseHandle( threads[i] );
+        }
+        CloseHandle( hStartEvent );
+        CloseHandle( hReadySemaphore );
+
+        bool bAllMatch = (threads.size() == uNumClients);
+        for (unsigned int i = 0; i < uNumClients; i++)
+        {
+            bAllMatch = bAllMatch && args[i].m_bMatches;
+        }
+
+        char szWhat[128];
+        sprintf_s( szWhat, "%u concurrent clients get their own bytecode", uNumClients );
+        Check( bAllMatch, szWhat );
+
+        sprintf_s( szWhat, "%u identical requests compile once (%u deduped, %u cache hits)",
+            kuNumIdentical, io_Server.GetNumDeduped(), io_Server.GetNumCacheHits() );
+        Check( io_Server.GetNumCompiles() == kuNumShaders, szWhat );
+        Check( io_Server.GetNumDeduped() + io_Server.GetNumCacheHits() == kuNumIdentical - 1, "the other identical requests are deduped or hit the cache" );
+        Check( io_Server.GetNumDeduped() > 0, "at least one identical request waits on the compile in flight" );
+    }
+
+    void TestLookups( ShaderCompileServer& io_Server, const wchar_t* pwsPipeName )
+    {
+        ShaderCompileClient client;
+        Check( client.Connect( pwsPipeName ), "client connects" );
+
+        std::vector<BYTE> bytecode;
+        std::string errors;
+        const unsigned int uNumCompiles = io_Server.GetNumCompiles();
+
+        HRESULT hr = CompileShader( client, kShaders[1], false, bytecode, errors );
+        Check( SUCCEEDED( hr ) && IsSource( bytecode, kShaders[1].m_pszSource ), "a lookup without source hits the cache" );
+
+        const Shader unknown = { "float4 main() : SV_Target { return 0; }", NULL, 0 };
+        hr = CompileShader( client, unknown, false, bytecode, errors );
+        Check( hr == HRESULT_FROM_WIN32( ERROR_NOT_FOUND ), "a lookup of an unknown shader needs its source" );
+        Check( io_Server.GetNumCompiles() == uNumCompiles, "lookups don't compile" );
+
+        const Shader broken = { "#error broken\nfloat4 main() : SV_Target { return 0; }", NULL, 0 };
+        hr = CompileShader( client, broken, true, bytecode, errors );
+        Check( (hr == E_FAIL) && !errors.empty() && bytecode.empty(), "a compile error returns its text" );
+
+        hr = CompileShader( client, broken, true, bytecode, errors );
+        Check( (hr == E_FAIL) && (io_Server.GetNumCompiles() == uNumCompiles + 2), "compile errors aren't cached" );
+
+        ShaderCompileServer::Request request;
+        ZeroMemory( &request.m_Header, sizeof( request.m_Header ) );
+        request.m_Header.m_uMagic = REQUEST_MAGIC;
+        request.m_Header.m_uVersion = VERSION;
+        request.m_Header.m_uSourceLength = 100;
+        request.m_Source = "float4 main() : SV_Target { return 1; }";
+        ShaderCompileServer::Response response;
+        io_Server.ProcessRequest( request, response );
+        Check( response.m_eStatus == STATUS_BAD_REQUEST, "a request with the wrong source length is rejected" );
+    }
+
+    void TestArchive( const wchar_t* pwsPipeName )
+    {
+        wchar_t wsArchiveDir[MAX_PATH];
+        wchar_t wsTempDir[MAX_PATH];
+        GetTempPathW( MAX_PATH, wsTempDir );
+        swprintf_s( wsArchiveDir, L"%sCompileServerTest_%u", wsTempDir, GetCurrentProcessId() );
+
+        DWORD dwDelay = 0;
+        std::vector<BYTE> bytecode;
+        std::string errors;
+
+        {
+            ShaderCompileServer server;
+            if (FAILED( server.Start( pwsPipeName, wsArchiveDir, ShaderCompileServer::MockCompile, &dwDelay ) ))
+            {
+                Check( false, "a server starts on an archive directory" );
+                return;
+            }
+
+            ShaderCompileClient client;
+            client.Connect( pwsPipeName );
+            CompileShader( client, kShaders[2], true, bytecode, errors );
+            client.Disconnect();
+            server.Stop();
+        }
+
+        {
+            ShaderCompileServer server;
+            if (FAILED( server.Start( pwsPipeName, wsArchiveDir, ShaderCompileServer::MockCompile, &dwDelay ) ))
+            {
+                Check( false, "a second server starts on the same archive directory" );
+                return;
+            }
+
+            ShaderCompileClient client;
+            client.Connect( pwsPipeName );
+            HRESULT hr = CompileShader( client, kShaders[2], false, bytecode, errors );
+            Check( SUCCEEDED( hr ) && IsSource( bytecode, kShaders[2].m_pszSource ) && (server.GetNumCompiles() == 0),
+                   "a new server serves archived shaders without compiling" );
+            client.Disconnect();
+            server.Stop();
+        }
+
+        // Remove the archive
+        WIN32_FIND_DATAW findData;
+        std::wstring pattern = std::wstring( wsArchiveDir ) + L"\\*.sco";
+        HANDLE hFind = FindFirstFileW( pattern.c_str(), &findData );
+        if (hFind != INVALID_HANDLE_VALUE)
+        {
+            do
+            {
+                DeleteFileW( (std::wstring( wsArchiveDir ) + L"\\" + findData.cFileName).c_str() );
+            } while (FindNextFileW( hFind, &findData ));
+            FindClose( hFind );
+        }
+        RemoveDirectoryW( wsArchiveDir );
+    }
+}
+
+int main()
+{
+    // A pipe name of our own, so a server another sample hosts isn't disturbed
+    wchar_t wsPipeName[128];
+    swprintf_s( wsPipeName, L"\\\\.\\pipe\\AMD_SDK_CompileServerTest_%u", GetCurrentProcessId() );
+
+    {
+        DWORD dwDelay = kdwCompileDelayMs;
+        ShaderCompileServer server;
+        if (FAILED( server.Start( wsPipeName, NULL, ShaderCompileServer::MockCompile, &dwDelay ) ))
+        {
+            fprintf( stderr, "error: can't start the server\n" );
+            return kExitError;
+        }
+
+        TestConcurrentRequests( server, wsPipeName );
+        TestLookups( server, wsPipeName );
+        server.Stop();
+    }
+
+    TestArchive( wsPipeName );
+
+    printf( "\n%d failed\n", g_iNumFailures );
+    return g_iNumFailures ? kExitFailed : kExitOk;
+}
@@ -0,0 +1,192 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: CrcBench.cpp
+//
+// Measures the throughput of each CRC-32 implementation in amd_sdk/src/crc.cpp that this
+// CPU supports, with crcBenchmark, and checks that they all compute the same CRC.
+//
+// Each implementation must give the standard check value for "123456789", and agree with
+// the byte at a time table on random messages of every length up to a few hundred bytes at
+// every alignment, which covers the head, tail and folding paths of the wide ones. Then it
+// reports GB/s on a buffer that fits in the L1 cache and on one much larger than the last
+// level cache, and which implementation crcCompute picked.
+//
+// The exit code is 0 if every implementation matches, 1 on mismatches, 2 on bad arguments.
+// It only needs the C++ standard library and crc.cpp, so it builds anywhere, e.g. on Linux:
+//   g++ -O2 -o CrcBench CrcBench.cpp ../../amd_sdk/src/crc.cpp -I../../amd_sdk/src
+// or with premake: premake5 --file=premake5_crcbench.lua gmake2 (or vs2015, ...)
+//--------------------------------------------------------------------------------------
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "crc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    const int kExitOk = 0;
+    const int kExitMismatch = 1;
+    const int kExitError = 2;
+
+    // Messages of every length up to this, at every alignment up to 16 bytes
+    const size_t kMaxCheckLength = 512;
+
+    struct BufferSize
+    {
+        unsigned long long  bytes;
+        const char*         name;
+    };
+
+    const BufferSize kBufferSizes[] =
+    {
+        { 16 * 1024,            "16 KB" },
+        { 64 * 1024 * 1024,     "64 MB" },
+    };
+
+    struct Options
+    {
+        Options() :
+            m_TotalMB( 1024 )
+        {
+        }
+
+        unsigned long long  m_TotalMB;      // hashed per measurement
+    };
+
+    void PrintUsage()
+    {
+        printf(
+            "usage: CrcBench [options]\n"
+            "\n"
+            "Measures each CRC-32 implementation this CPU supports, and checks that they agree.\n"
+            "Exits with 1 if they don't, 2 on errors, 0 otherwise.\n"
+            "\n"
+            "  --total MB      megabytes hashed per measurement (default 1024)\n" );
+    }
+
+    bool ParseOptions( int argc, char** argv, Options& o_Options )
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            if (0 == strcmp( argv[i], "--total" ) && i + 1 < argc)
+            {
+                char* end = NULL;
+                const long number = strtol( argv[++i], &end, 10 );
+                if (number <= 0 || !end || 0 != *end)
+                {
+                    fprintf( stderr, "error: bad value %s for --total\n", argv[i] );
+                    return false;
+                }
+                o_Options.m_TotalMB = (unsigned long long)number;
+            }
+            else
+            {
+                if (0 != strcmp( argv[i], "--help" ) && 0 != strcmp( argv[i], "-h" ))
+                {
+                    fprintf( stderr, "error: unknown option %s\n", argv[i] );
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Check( crcImplementation impl )
+    {
+        static const char kCheckMessage[] = "123456789";
+        if (crcComputeWith( impl, kCheckMessage, 9 ) != CHECK_VALUE)
+        {
+            return false;
+        }
+
+        std::vector<unsigned char> message( kMaxCheckLength + 16 );
+        unsigned int seed = 0x2545F491;
+        for (size_t i = 0; i < message.size(); i++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            message[i] = (unsigned char)(seed >> 24);
+        }
+
+        for (size_t offset = 0; offset < 16; offset++)
+        {
+            for (size_t length = 0; length <= kMaxCheckLength; length++)
+            {
+                if (crcComputeWith( impl, &message[offset], length ) != crcComputeWith( CRC_IMPL_TABLE, &message[offset], length ))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+}
+
+int main( int argc, char** argv )
+{
+    Options options;
+    if (!ParseOptions( argc, argv, options ))
+    {
+        PrintUsage();
+        return kExitError;
+    }
+
+    printf( "%-16s %8s", "", "check" );
+    for (size_t s = 0; s < sizeof(kBufferSizes) / sizeof(kBufferSizes[0]); s++)
+    {
+        char heading[32];
+        sprintf( heading, "%s GB/s", kBufferSizes[s].name );
+        printf( " %14s", heading );
+    }
+    printf( "\n" );
+
+    int result = kExitOk;
+    for (int impl = 0; impl < CRC_IMPL_COUNT; impl++)
+    {
+        const crcImplementation implementation = (crcImplementation)impl;
+        if (!crcIsSupported( implementation ))
+        {
+            printf( "%-16s not supported\n", crcGetImplementationName( implementation ) );
+            continue;
+        }
+
+        const bool same = Check( implementation );
+        result = same ? result : kExitMismatch;
+        printf( "%-16s %8s", crcGetImplementationName( implementation ), same ? "ok" : "MISMATCH" );
+
+        for (size_t s = 0; s < sizeof(kBufferSizes) / sizeof(kBufferSizes[0]); s++)
+        {
+            const unsigned long long bytes = kBufferSizes[s].bytes;
+            const unsigned long long iterations = (options.m_TotalMB * 1024 * 1024 + bytes - 1) / bytes;
+            const double megabytesPerSecond = crcBenchmark( implementation, bytes, (int)iterations );
+            printf( " %14.2f", megabytesPerSecond / 1024.0 );
+        }
+        printf( "\n" );
+    }
+
+    printf( "\ncrcCompute uses %s\n", crcGetImplementationName( crcGetImplementation() ) );
+    return result;
+}
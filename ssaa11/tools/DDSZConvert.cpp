@@ -0,0 +1,455 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+//--------------------------------------------------------------------------------------
+// File: DDSZConvert.cpp
+//
+// Converts DDS files to DDSZ (dxut/Core/DDSZFile.h), the DDS container with its texture
+// data compressed per mip with LZ4, which MappedFile::Open reads in place of the DDS file
+// next to it.
+//
+// Directories given on the command line are walked for .dds files, e.g. the media tree:
+// DDSZConvert ../media. Each file is compressed, decompressed again and compared with the
+// original, and name.ddsz is written next to name.dds only if it's smaller; otherwise a
+// name.ddsz left from an earlier run is removed, so it can't shadow a newer DDS file. Run
+// it again after changing the media. The DDS files are left as they are.
+//
+// For each file it reports the sizes and how fast the file decompresses on one thread and
+// on all threads, in megabytes of DDS data per second, best of a few passes.
+//
+// The exit code is 0 if every file converted, 1 if a file didn't decompress to what it
+// was made from, 2 on bad arguments or input.
+// It doesn't need a device, e.g. with premake: premake5 --file=premake5_ddszconvert.lua vs2015
+//--------------------------------------------------------------------------------------
+#define _CRT_SECURE_NO_WARNINGS
+
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "DDSZFile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    const int kExitOk = 0;
+    const int kExitMismatch = 1;
+    const int kExitError = 2;
+
+    // Decompression is timed over this many passes, and the best one reported
+    const int kTimingPasses = 3;
+
+    struct Options
+    {
+        Options() :
+            m_NumThreads( 0 ),
+            m_Write( true )
+        {
+        }
+
+        unsigned int                m_NumThreads;       // 0 for one per processor
+        bool                        m_Write;
+        std::vector<const char*>    m_Paths;
+    };
+
+    struct Totals
+    {
+        Totals() :
+            m_NumFiles( 0 ),
+            m_NumWritten( 0 ),
+            m_DDSBytes( 0 ),
+            m_DiskBytes( 0 )
+        {
+        }
+
+        size_t                      m_NumFiles;
+        size_t                      m_NumWritten;
+        unsigned long long          m_DDSBytes;
+        unsigned long long          m_DiskBytes;        // what the loader reads, .ddsz where written
+    };
+
+    void PrintUsage()
+    {
+        printf(
+            "usage: DDSZConvert [options] <file.dds or directory> ...\n"
+            "\n"
+            "Writes name.ddsz next to each name.dds, with its texture data compressed with LZ4,\n"
+            "if that makes it smaller. Directories are searched for .dds files recursively.\n"
+            "Exits with 1 if a file doesn't decompress to the original, 2 on errors, 0 otherwise.\n"
+            "\n"
+            "  --threads N     threads to compress and decompress with (default one per processor)\n"
+            "  --dry-run       only report the sizes and speeds, don't write or remove files\n" );
+    }
+
+    bool ParseOptions( int argc, char** argv, Options& o_Options )
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            const char* arg = argv[i];
+
+            if (0 == strcmp( arg, "--dry-run" ))
+            {
+                o_Options.m_Write = false;
+            }
+            else if (0 == strcmp( arg, "--help" ) || 0 == strcmp( arg, "-h" ))
+            {
+                return false;
+            }
+            else if (0 == strcmp( arg, "--threads" ))
+            {
+                char* end = NULL;
+                const long number = (i + 1 < argc) ? strtol( argv[i + 1], &end, 10 ) : -1;
+                if (number < 0 || !end || 0 != *end)
+                {
+                    fprintf( stderr, "error: --threads needs a number\n" );
+                    return false;
+                }
+                o_Options.m_NumThreads = (unsigned int)number;
+                i++;
+            }
+            else if (0 == strncmp( arg, "--", 2 ))
+            {
+                fprintf( stderr, "error: unknown option %s\n", arg );
+                return false;
+            }
+            else
+            {
+                o_Options.m_Paths.push_back( arg );
+            }
+        }
+        return !o_Options.m_Paths.empty();
+    }
+
+    double GetSeconds()
+    {
+#ifdef _WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency( &frequency );
+        QueryPerformanceCounter( &counter );
+        return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+        timespec now;
+        clock_gettime( CLOCK_MONOTONIC, &now );
+        return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+    }
+
+    bool HasDDSExtension( const std::string& path )
+    {
+        if (path.size() < 4 || path[path.size() - 4] != '.')
+        {
+            return false;
+        }
+
+        for (size_t i = path.size() - 3; i < path.size(); i++)
+        {
+            if (tolower( (unsigned char)path[i] ) != (i + 1 == path.size() ? 's' : 'd'))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns false if the path isn't a file or directory that can be read
+    bool FindFiles( const std::string& path, std::vector<std::string>& o_Files )
+    {
+#ifdef _WIN32
+        const DWORD attributes = GetFileAttributesA( path.c_str() );
+        if (INVALID_FILE_ATTRIBUTES == attributes)
+        {
+            return false;
+        }
+
+        if (!(attributes & FILE_ATTRIBUTE_DIRECTORY))
+        {
+            o_Files.push_back( path );
+            return true;
+        }
+
+        WIN32_FIND_DATAA findData;
+        HANDLE find = FindFirstFileA( (path + "\\*").c_str(), &findData );
+        if (INVALID_HANDLE_VALUE == find)
+        {
+            return false;
+        }
+
+        bool ok = true;
+        do
+        {
+            const std::string name = findData.cFileName;
+            if (name == "." || name == "..")
+            {
+                continue;
+            }
+
+            const std::string child = path + "\\" + name;
+            if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            {
+                ok = FindFiles( child, o_Files ) && ok;
+            }
+            else if (HasDDSExtension( name ))
+            {
+                o_Files.push_back( child );
+            }
+        } while (FindNextFileA( find, &findData ));
+
+        FindClose( find );
+        return ok;
+#else
+        struct stat pathStat;
+        if (0 != stat( path.c_str(), &pathStat ))
+        {
+            return false;
+        }
+
+        if (!S_ISDIR( pathStat.st_mode ))
+        {
+            o_Files.push_back( path );
+            return true;
+        }
+
+        DIR* dir = opendir( path.c_str() );
+        if (!dir)
+        {
+            return false;
+        }
+
+        // Sorted, so the report comes out in the same order every time
+        std::vector<std::string> names;
+        while (dirent* entry = readdir( dir ))
+        {
+            if (0 != strcmp( entry->d_name, "." ) && 0 != strcmp( entry->d_name, ".." ))
+            {
+                names.push_back( entry->d_name );
+            }
+        }
+        closedir( dir );
+        std::sort( names.begin(), names.end() );
+
+        bool ok = true;
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            const std::string child = path + "/" + names[i];
+            struct stat childStat;
+            if (0 != stat( child.c_str(), &childStat ))
+            {
+                ok = false;
+            }
+            else if (S_ISDIR( childStat.st_mode ))
+            {
+                ok = FindFiles( child, o_Files ) && ok;
+            }
+            else if (HasDDSExtension( names[i] ))
+            {
+                o_Files.push_back( child );
+            }
+        }
+        return ok;
+#endif
+    }
+
+    // Read with stdio rather than MappedFile, which would read an existing .ddsz instead
+    bool ReadWholeFile( const std::string& path, std::vector<uint8_t>& o_Data )
+    {
+        FILE* file = fopen( path.c_str(), "rb" );
+        if (!file)
+        {
+            return false;
+        }
+
+        bool ok = 0 == fseek( file, 0, SEEK_END );
+        const long size = ok ? ftell( file ) : -1;
+        ok = size >= 0 && 0 == fseek( file, 0, SEEK_SET );
+        if (ok)
+        {
+            o_Data.resize( (size_t)size );
+            ok = o_Data.empty() || fread( &o_Data[0], 1, o_Data.size(), file ) == o_Data.size();
+        }
+
+        fclose( file );
+        return ok;
+    }
+
+    bool WriteWholeFile( const std::string& path, const uint8_t* data, size_t size )
+    {
+        FILE* file = fopen( path.c_str(), "wb" );
+        if (!file)
+        {
+            return false;
+        }
+
+        bool ok = fwrite( data, 1, size, file ) == size;
+        ok = (0 == fclose( file )) && ok;
+        if (!ok)
+        {
+            remove( path.c_str() );
+        }
+        return ok;
+    }
+
+    // Megabytes of DDS data per second, best of kTimingPasses
+    double MeasureDecompress( const uint8_t* ddszData, size_t ddszSize, unsigned int numThreads )
+    {
+        double best = 0.0;
+        for (int pass = 0; pass < kTimingPasses; pass++)
+        {
+            std::unique_ptr<uint8_t[]> ddsData;
+            size_t ddsSize = 0;
+            const double start = GetSeconds();
+            if (FAILED( DecompressDDSZ( ddszData, ddszSize, numThreads, ddsData, ddsSize ) ))
+            {
+                return 0.0;
+            }
+            const double seconds = std::max( GetSeconds() - start, 1e-9 );
+            best = std::max( best, (double)ddsSize / seconds / (1024.0 * 1024.0) );
+        }
+        return best;
+    }
+
+    int Convert( const std::string& path, const Options& options, Totals& totals )
+    {
+        std::vector<uint8_t> dds;
+        if (!ReadWholeFile( path, dds ) || dds.empty())
+        {
+            fprintf( stderr, "error: can't read %s\n", path.c_str() );
+            return kExitError;
+        }
+
+        std::unique_ptr<uint8_t[]> ddsz;
+        size_t ddszSize = 0;
+        if (FAILED( CompressDDS( &dds[0], dds.size(), options.m_NumThreads, ddsz, ddszSize ) ))
+        {
+            fprintf( stderr, "error: %s isn't a DDS file that can be loaded\n", path.c_str() );
+            return kExitError;
+        }
+
+        std::unique_ptr<uint8_t[]> check;
+        size_t checkSize = 0;
+        if (FAILED( DecompressDDSZ( ddsz.get(), ddszSize, options.m_NumThreads, check, checkSize ) ) ||
+            checkSize != dds.size() || 0 != memcmp( check.get(), &dds[0], dds.size() ))
+        {
+            fprintf( stderr, "error: %s doesn't decompress to the original\n", path.c_str() );
+            return kExitMismatch;
+        }
+
+        const double singleThread = MeasureDecompress( ddsz.get(), ddszSize, 1 );
+        const double multiThread = MeasureDecompress( ddsz.get(), ddszSize, options.m_NumThreads );
+
+        const bool smaller = ddszSize < dds.size();
+        const std::string ddszPath = path + "z";
+        if (options.m_Write)
+        {
+            if (smaller)
+            {
+                if (!WriteWholeFile( ddszPath, ddsz.get(), ddszSize ))
+                {
+                    fprintf( stderr, "error: can't write %s\n", ddszPath.c_str() );
+                    return kExitError;
+                }
+            }
+            else
+            {
+                remove( ddszPath.c_str() );
+            }
+        }
+
+        printf( "%-48s %10llu %10llu %6.1f%% %10.0f %10.0f %s\n",
+                path.c_str(),
+                (unsigned long long)dds.size(),
+                (unsigned long long)ddszSize,
+                100.0 * (double)ddszSize / (double)dds.size(),
+                singleThread,
+                multiThread,
+                smaller ? (options.m_Write ? "written" : "smaller") : "kept dds" );
+
+        totals.m_NumFiles++;
+        totals.m_DDSBytes += dds.size();
+        if (smaller)
+        {
+            totals.m_NumWritten++;
+            totals.m_DiskBytes += ddszSize;
+        }
+        else
+        {
+            totals.m_DiskBytes += dds.size();
+        }
+        return kExitOk;
+    }
+}
+
+int main( int argc, char** argv )
+{
+    Options options;
+    if (!ParseOptions( argc, argv, options ))
+    {
+        PrintUsage();
+        return kExitError;
+    }
+
+    int result = kExitOk;
+    std::vector<std::string> files;
+    for (size_t i = 0; i < options.m_Paths.size(); i++)
+    {
+        if (!FindFiles( options.m_Paths[i], files ))
+        {
+            fprintf( stderr, "error: can't read %s\n", options.m_Paths[i] );
+            result = kExitError;
+        }
+    }
+
+    printf( "%-48s %10s %10s %7s %10s %10s\n", "", "dds bytes", "ddsz bytes", "ratio", "1T MB/s", "MT MB/s" );
+
+    Totals totals;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        result = std::max( result, Convert( files[i], options, totals ) );
+    }
+
+    if (totals.m_NumFiles)
+    {
+        printf( "\n%u of %u files compressed, %llu bytes read at load instead of %llu (%.1f%%)\n",
+                (unsigned int)totals.m_NumWritten,
+                (unsigned int)totals.m_NumFiles,
+                totals.m_DiskBytes,
+                totals.m_DDSBytes,
+                100.0 * (double)totals.m_DiskBytes / (double)totals.m_DDSBytes );
+    }
+
+    return result;
+}
@@ -0,0 +1,215 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+//--------------------------------------------------------------------------------------
+// File: GpuTimestampRingTest.cpp
+//
+// Drives GpuTimer's ring of in-flight intervals (amd_sdk/src/GpuTimestampRing.cpp) with
+// SimulatedGpuTimestamps in place of a GPU, so the results come back a known number of
+// frames late and disjoint frames can be injected:
+//
+//   - with a latency the ring has room for, it neither grows nor stalls
+//   - with more, it grows to fit, keeping the results in issue order, and doesn't stall
+//   - with more than MaxTimeStamps in flight, it stalls, and each stall is one wait
+//   - the latency it reports is the simulated one
+//   - frames with a disjoint result aren't reported, every other frame is, with its time
+//
+// The exit code is 0 if every check passes, 1 on failures.
+// It only needs the C++ standard library and two files of AMD_SDK, so it builds anywhere,
+// e.g. on Linux:
+//   g++ -O2 -o GpuTimestampRingTest GpuTimestampRingTest.cpp ../../amd_sdk/src/GpuTimestamp*.cpp -I../../amd_sdk/src
+// or with premake: premake5 --file=premake5_gputimestampringtest.lua gmake2 (or vs2015, ...)
+//--------------------------------------------------------------------------------------
+#include "GpuTimestampRing.h"
+
+#include <math.h>
+#include <stdio.h>
+
+using namespace AMD;
+
+namespace
+{
+    const int kExitOk = 0;
+    const int kExitFailed = 1;
+
+    const unsigned long long kullFrequency = 100000000;
+    const double kfWorkSeconds = 0.001;     // per Start/Stop pair
+
+    int g_iNumFailures = 0;
+
+    void Check( bool bCondition, const char* pszWhat )
+    {
+        printf( "%-64s %s\n", pszWhat, bCondition ? "ok" : "FAILED" );
+        if (!bCondition)
+        {
+            g_iNumFailures++;
+        }
+    }
+
+    // What the ring reported through its callbacks
+    struct Results
+    {
+        Results() :
+            m_uNumFrames( 0 ),
+            m_uNumBadFrames( 0 ),
+            m_fExpectedFrameTime( 0.0 ),
+            m_uNumTimestamps( 0 ),
+            m_uNumBadTimestamps( 0 ),
+            m_ullLastTag( 0 ),
+            m_bInOrder( true )
+        {
+        }
+
+        unsigned int        m_uNumFrames;
+        unsigned int        m_uNumBadFrames;        // with another time than expected
+        double              m_fExpectedFrameTime;
+        unsigned int        m_uNumTimestamps;
+        unsigned int        m_uNumBadTimestamps;    // not kfWorkSeconds apart
+        unsigned long long  m_ullLastTag;
+        bool                m_bInOrder;             // tags came back in the order they were issued
+    };
+
+    void OnFrame( void* pUserData, double fSeconds )
+    {
+        Results* pResults = static_cast<Results*>( pUserData );
+        pResults->m_uNumFrames++;
+        if (fabs( fSeconds - pResults->m_fExpectedFrameTime ) > 1.0e-9)
+        {
+            pResults->m_uNumBadFrames++;
+        }
+    }
+
+    void OnTimestamps( void* pUserData, unsigned long long ullTag, unsigned long long ullStart, unsigned long long ullStop, unsigned long long ullFrequency )
+    {
+        Results* pResults = static_cast<Results*>( pUserData );
+        pResults->m_uNumTimestamps++;
+        if (ullFrequency != kullFrequency || fabs( (double)(ullStop - ullStart) / (double)ullFrequency - kfWorkSeconds ) > 1.0e-9)
+        {
+            pResults->m_uNumBadTimestamps++;
+        }
+        pResults->m_bInOrder = pResults->m_bInOrder && (ullTag > pResults->m_ullLastTag);
+        pResults->m_ullLastTag = ullTag;
+    }
+
+    struct Scenario
+    {
+        const char*     m_pszName;
+        unsigned int    m_uLatencyFrames;
+        unsigned int    m_uPairsPerFrame;
+        unsigned int    m_uNumFrames;
+        unsigned int    m_uDisjointEvery;       // inject a disjoint frame every so many frames, 0 for none
+    };
+
+    // Runs the frames of a scenario on a ring of 8 records, the GpuTimer default, then waits
+    // for the results still in flight
+    void Run( const Scenario& i_Scenario, SimulatedGpuTimestamps& io_Gpu, GpuTimestampRing& io_Ring, Results& o_Results, unsigned int& o_uNumDisjointFrames )
+    {
+        o_Results.m_fExpectedFrameTime = kfWorkSeconds * i_Scenario.m_uPairsPerFrame;
+        io_Ring.SetFrameCallback( &OnFrame, &o_Results );
+        io_Ring.SetTimestampCallback( &OnTimestamps, &o_Results );
+
+        o_uNumDisjointFrames = 0;
+        unsigned long long ullTag = 0;
+        for (unsigned int uFrame = 0; uFrame < i_Scenario.m_uNumFrames; uFrame++)
+        {
+            if (0 != i_Scenario.m_uDisjointEvery && 0 == uFrame % i_Scenario.m_uDisjointEvery)
+            {
+                io_Gpu.InjectDisjoint();
+                o_uNumDisjointFrames++;
+            }
+
+            for (unsigned int uPair = 0; uPair < i_Scenario.m_uPairsPerFrame; uPair++)
+            {
+                io_Ring.SetNextTag( ++ullTag );
+                io_Ring.Start();
+                io_Gpu.AddWork( kfWorkSeconds );
+                io_Ring.Stop();
+            }
+
+            io_Ring.EndFrame();
+            io_Gpu.AdvanceFrame();
+        }
+    }
+}
+
+int main()
+{
+    static const Scenario kScenarios[] =
+    {
+        // name         latency pairs   frames  disjoint
+        { "fits",       2,      2,      100,    0 },
+        { "grows",      10,     4,      100,    0 },
+        { "stalls",     300,    4,      1000,   0 },
+        { "disjoint",   3,      3,      60,     4 },
+    };
+
+    for (size_t s = 0; s < sizeof( kScenarios ) / sizeof( kScenarios[0] ); s++)
+    {
+        const Scenario& scenario = kScenarios[s];
+        printf( "\n%s: %u frames of latency, %u intervals per frame\n", scenario.m_pszName, scenario.m_uLatencyFrames, scenario.m_uPairsPerFrame );
+
+        SimulatedGpuTimestamps gpu( kullFrequency, scenario.m_uLatencyFrames );
+        GpuTimestampRing ring( &gpu );
+        Results results;
+        unsigned int uNumDisjointFrames = 0;
+        Run( scenario, gpu, ring, results, uNumDisjointFrames );
+
+        // the records in flight at a Start: those of the frames whose results aren't in yet, and this one's
+        const unsigned int uInFlight = (scenario.m_uLatencyFrames + 1) * scenario.m_uPairsPerFrame;
+        unsigned int uExpectedSize = 8;
+        unsigned int uExpectedGrowths = 0;
+        while (uExpectedSize < uInFlight && uExpectedSize < GpuTimestampRing::MaxTimeStamps)
+        {
+            uExpectedSize *= 2;
+            uExpectedGrowths++;
+        }
+        const bool bStalls = (uInFlight > GpuTimestampRing::MaxTimeStamps);
+
+        Check( ring.GetNumTimeStamps() == uExpectedSize, "ring size fits the intervals in flight" );
+        Check( ring.GetNumGrowths() == uExpectedGrowths, "ring grew once per doubling" );
+        if (bStalls)
+        {
+            Check( ring.GetNumStalls() > 0, "ring stalled past MaxTimeStamps" );
+            Check( gpu.GetNumWaits() == ring.GetNumStalls(), "every stall waited for the GPU once" );
+            Check( ring.GetMaxLatencyFrames() < scenario.m_uLatencyFrames, "stalls cut the latency" );
+        }
+        else
+        {
+            Check( 0 == ring.GetNumStalls() && 0 == gpu.GetNumWaits(), "ring never stalled" );
+            Check( ring.GetLatencyFrames() == scenario.m_uLatencyFrames, "reported latency is the simulated one" );
+            Check( ring.GetMaxLatencyFrames() == scenario.m_uLatencyFrames, "most latency seen is the simulated one" );
+        }
+
+        ring.WaitIdle();
+
+        const unsigned int uNumIntervals = scenario.m_uNumFrames * scenario.m_uPairsPerFrame;
+        Check( results.m_uNumTimestamps == uNumIntervals - uNumDisjointFrames * scenario.m_uPairsPerFrame, "every interval that isn't disjoint came back" );
+        Check( 0 == results.m_uNumBadTimestamps, "intervals came back with their time" );
+        Check( results.m_bInOrder, "intervals came back in issue order" );
+        Check( results.m_uNumFrames == scenario.m_uNumFrames - uNumDisjointFrames, "every frame that isn't disjoint was reported" );
+        Check( 0 == results.m_uNumBadFrames, "frames were reported with their time" );
+    }
+
+    printf( "\n%d failures\n", g_iNumFailures );
+    return (0 == g_iNumFailures) ? kExitOk : kExitFailed;
+}
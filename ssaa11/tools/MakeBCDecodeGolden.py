@@ -0,0 +1,117 @@
+#
+# Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#
+
+
+# MakeBCDecodeGolden.py
+#
+# Writes BCDecodeGolden.h: blocks of each BC format Pillow decodes, with the texels Pillow's
+# decoder gives for them, which BCDecodeBench checks the software BC decoder against.
+# The blocks are random, from a fixed seed, except that each BC7 mode gets the same number
+# of blocks and no BC7 block uses a reserved mode, which Pillow decodes to opaque black
+# rather than to the zeros of the Direct3D 11 specification.
+#
+#   python MakeBCDecodeGolden.py > BCDecodeGolden.h
+
+import random
+import sys
+
+import PIL
+from PIL import Image
+
+BLOCKS_PER_FORMAT = 16
+
+# DXGI format, name, block bytes, Pillow mode, Pillow bcn decoder arguments
+FORMATS = [
+    ("DXGI_FORMAT_BC1_UNORM", "BC1", 8, "RGBA", (1, "DXT1")),
+    ("DXGI_FORMAT_BC2_UNORM", "BC2", 16, "RGBA", (2, "DXT3")),
+    ("DXGI_FORMAT_BC3_UNORM", "BC3", 16, "RGBA", (3, "DXT5")),
+    ("DXGI_FORMAT_BC4_UNORM", "BC4_UNORM", 8, "L", (4, "BC4")),
+    ("DXGI_FORMAT_BC5_UNORM", "BC5_UNORM", 16, "RGB", (5, "BC5")),
+    ("DXGI_FORMAT_BC7_UNORM", "BC7", 16, "RGBA", (7, "BC7")),
+]
+
+
+def make_blocks(rng, name, block_bytes):
+    blocks = []
+    for i in range(BLOCKS_PER_FORMAT):
+        block = bytearray(rng.getrandbits(8) for _ in range(block_bytes))
+        if name == "BC7":
+            # the mode is the position of the lowest set bit
+            mode = i % 8
+            block[0] = (block[0] & ~((2 << mode) - 1) & 0xFF) | (1 << mode)
+        blocks.append(bytes(block))
+    return blocks
+
+
+def write_bytes(out, data, per_line):
+    for i in range(0, len(data), per_line):
+        out.write("        " + " ".join("0x%02x," % b for b in data[i:i + per_line]) + "\n")
+
+
+def main():
+    rng = random.Random(1)
+    out = sys.stdout
+
+    out.write("//--------------------------------------------------------------------------------------\n")
+    out.write("// File: BCDecodeGolden.h\n")
+    out.write("//\n")
+    out.write("// Generated by MakeBCDecodeGolden.py with Pillow %s; don't edit.\n" % PIL.__version__)
+    out.write("//\n")
+    out.write("// Blocks of each format and the texels Pillow decodes them to, row by row over a strip\n")
+    out.write("// one block high, with only the channels Pillow returns: R for BC4, RGB for BC5.\n")
+    out.write("//--------------------------------------------------------------------------------------\n")
+    out.write("#pragma once\n\n")
+    out.write("namespace BCDecodeGolden\n{\n")
+    out.write("    const char* const kReference = \"Pillow %s\";\n\n" % PIL.__version__)
+
+    for dxgi, name, block_bytes, mode, args in FORMATS:
+        blocks = make_blocks(rng, name, block_bytes)
+        data = b"".join(blocks)
+
+        # Pillow wants the blocks in rows; one row of blocks is a 4 texel high strip
+        image = Image.frombytes(mode, (4 * len(blocks), 4), data, "bcn", args)
+        texels = image.tobytes()
+
+        out.write("    const uint8_t k%sBlocks[] =\n    {\n" % name)
+        write_bytes(out, data, block_bytes)
+        out.write("    };\n\n")
+        out.write("    const uint8_t k%sTexels[] =\n    {\n" % name)
+        write_bytes(out, texels, 4 * len(mode) * 4)
+        out.write("    };\n\n")
+
+    out.write("    struct GoldenSet\n    {\n")
+    out.write("        DXGI_FORMAT     format;\n")
+    out.write("        const char*     name;\n")
+    out.write("        size_t          numBlocks;\n")
+    out.write("        unsigned int    channels;   // per texel in texels\n")
+    out.write("        const uint8_t*  blocks;\n")
+    out.write("        const uint8_t*  texels;\n")
+    out.write("    };\n\n")
+    out.write("    const GoldenSet kSets[] =\n    {\n")
+    for dxgi, name, block_bytes, mode, args in FORMATS:
+        out.write("        { %s, \"%s\", %d, %d, k%sBlocks, k%sTexels },\n" % (dxgi, name, BLOCKS_PER_FORMAT, len(mode), name, name))
+    out.write("    };\n")
+    out.write("}\n")
+
+
+if __name__ == "__main__":
+    main()
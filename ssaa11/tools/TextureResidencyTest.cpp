@@ -0,0 +1,571 @@
+//
+// Copyright (c) 2016 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+//--------------------------------------------------------------------------------------
+// File: TextureResidencyTest.cpp
+//
+// Checks the device independent parts of texture packing and residency in DXUT Optional
+// on made up textures:
+//
+//   - CDXUTTextureArrayPacker puts compatible textures in one array, splits an array at
+//     SetMaxSlices, and gives each texture the same array and slice every time
+//   - CDXUTMipStreamScheduler, run through random frames of screen sizes, budget changes,
+//     textures coming and going and loads that finish late or fail, never allocates more
+//     than its budget and never reports a resident mip finer than the allocated one
+//   - CDXUTResidencyPlanner fits the budget that is left after SetReservedBytes, and the
+//     maxsize from GetMaxSize makes FillInitData, which DDSTextureLoader loads with, skip
+//     exactly the planned mips
+//
+// The textures are random, from a fixed seed, so every run checks the same frames.
+// The exit code is 0 if every check passes, 1 on failures.
+// It doesn't need a device, only the Windows SDK headers for the DXGI formats, e.g. with
+// premake: premake5 --file=premake5_textureresidencytest.lua vs2015
+//--------------------------------------------------------------------------------------
+#if defined(_WIN32) && !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+
+#include "DDSFile.h"
+#include "DXUTMipScheduler.h"
+#include "DXUTResidencyPlanner.h"
+#include "DXUTTextureArrayPacker.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    const int kExitOk = 0;
+    const int kExitFailed = 1;
+
+    const uint32_t kTailSize = 64;      // CDXUTMipStreamer keeps the mips of 64x64 texels and less
+
+    int g_iNumFailures = 0;
+
+    void Check( bool bCondition, const char* pszWhat )
+    {
+        printf( "%-64s %s\n", pszWhat, bCondition ? "ok" : "FAILED" );
+        if (!bCondition)
+        {
+            g_iNumFailures++;
+        }
+    }
+
+    // the same sequence on every run and platform
+    class Random
+    {
+    public:
+        explicit Random( unsigned int uSeed ) : m_uState( uSeed ) {}
+
+        // in [0, uRange)
+        unsigned int Next( unsigned int uRange )
+        {
+            m_uState = m_uState * 1664525 + 1013904223;
+            return (unsigned int)(((unsigned long long)(m_uState >> 8) * uRange) >> 24);
+        }
+
+    private:
+        unsigned int m_uState;
+    };
+
+    // a 2D texture with a full mip chain, and the memory of each mip as the DDS loader counts it
+    struct TestTexture
+    {
+        uint32_t                m_uWidth;
+        uint32_t                m_uHeight;
+        uint32_t                m_uMipCount;
+        DXGI_FORMAT             m_Format;
+        std::vector<uint64_t>   m_MipBytes;
+        uint32_t                m_uId;          // in the scheduler or planner
+    };
+
+    void MakeTexture( uint32_t i_uWidth, uint32_t i_uHeight, DXGI_FORMAT i_Format, TestTexture& o_Texture )
+    {
+        o_Texture.m_uWidth = i_uWidth;
+        o_Texture.m_uHeight = i_uHeight;
+        o_Texture.m_Format = i_Format;
+        o_Texture.m_uMipCount = 1;
+        while ((std::max( i_uWidth, i_uHeight ) >> o_Texture.m_uMipCount) > 0)
+        {
+            o_Texture.m_uMipCount++;
+        }
+
+        o_Texture.m_MipBytes.resize( o_Texture.m_uMipCount );
+        for (uint32_t mip = 0; mip < o_Texture.m_uMipCount; mip++)
+        {
+            size_t numBytes = 0;
+            DirectX::GetSurfaceInfo( std::max<size_t>( i_uWidth >> mip, 1 ), std::max<size_t>( i_uHeight >> mip, 1 ), i_Format, &numBytes, NULL, NULL );
+            o_Texture.m_MipBytes[mip] = numBytes;
+        }
+        o_Texture.m_uId = CDXUTMipStreamScheduler::INVALID_TEXTURE;
+    }
+
+    // a power of two from 2^i_uMinLog to 2^i_uMaxLog
+    uint32_t RandomSize( Random& io_Random, uint32_t i_uMinLog, uint32_t i_uMaxLog )
+    {
+        return 1u << (i_uMinLog + io_Random.Next( i_uMaxLog - i_uMinLog + 1 ));
+    }
+
+    uint64_t GetBytes( const TestTexture& i_Texture, uint32_t i_uFirstMip, uint32_t i_uEndMip )
+    {
+        uint64_t bytes = 0;
+        for (uint32_t mip = i_uFirstMip; mip < i_uEndMip; mip++)
+        {
+            bytes += i_Texture.m_MipBytes[mip];
+        }
+        return bytes;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // CDXUTTextureArrayPacker
+    //--------------------------------------------------------------------------------------
+    struct TextureKind
+    {
+        DXGI_FORMAT     m_Format;
+        uint32_t        m_uWidth;
+        uint32_t        m_uHeight;
+        uint32_t        m_uMipLevels;
+    };
+
+    // where the last Pack put each texture
+    void GetPlacement( const CDXUTTextureArrayPacker& i_Packer, std::vector<uint32_t>& o_Placement )
+    {
+        o_Placement.clear();
+        for (uint32_t texture = 0; texture < i_Packer.GetNumTextures(); texture++)
+        {
+            o_Placement.push_back( i_Packer.GetArrayIndex( texture ) );
+            o_Placement.push_back( i_Packer.GetSlice( texture ) );
+        }
+    }
+
+    // every array holds textures of its kind, in the order they were added, and each texture
+    // is in the slice of the array that says it is
+    bool IsConsistent( const CDXUTTextureArrayPacker& i_Packer, const std::vector<uint32_t>& i_Kinds, const TextureKind* i_pKinds )
+    {
+        uint32_t numSlices = 0;
+        for (uint32_t a = 0; a < i_Packer.GetNumArrays(); a++)
+        {
+            const CDXUTTextureArrayPacker::TextureArray& array = i_Packer.GetArray( a );
+            for (size_t slice = 0; slice < array.textures.size(); slice++)
+            {
+                const uint32_t texture = array.textures[slice];
+                const TextureKind& kind = i_pKinds[i_Kinds[texture]];
+                if (i_Packer.GetArrayIndex( texture ) != a || i_Packer.GetSlice( texture ) != slice
+                    || (0 < slice && array.textures[slice - 1] >= texture)
+                    || array.format != (uint32_t)kind.m_Format || array.width != kind.m_uWidth
+                    || array.height != kind.m_uHeight || array.mipLevels != kind.m_uMipLevels)
+                {
+                    return false;
+                }
+            }
+            numSlices += (uint32_t)array.textures.size();
+        }
+        return numSlices == i_Packer.GetNumTextures();
+    }
+
+    void TestTextureArrayPacker()
+    {
+        printf( "\nCDXUTTextureArrayPacker\n" );
+
+        static const TextureKind kKinds[] =
+        {
+            { DXGI_FORMAT_BC1_UNORM,        1024,   1024,   11 },
+            { DXGI_FORMAT_BC1_UNORM,        512,    512,    10 },
+            { DXGI_FORMAT_BC3_UNORM,        1024,   1024,   11 },
+            { DXGI_FORMAT_BC1_UNORM,        1024,   1024,   1 },    // differs from the first only in its mips
+            { DXGI_FORMAT_R8G8B8A8_UNORM,   1024,   512,    11 },
+        };
+        const uint32_t kNumKinds = sizeof( kKinds ) / sizeof( kKinds[0] );
+        const uint32_t kNumTextures = 60;
+        const uint32_t kMaxSlices = 4;
+
+        // the kinds interleaved, the way the materials of a mesh list their textures
+        Random random( 1 );
+        std::vector<uint32_t> kinds;
+        CDXUTTextureArrayPacker packer;
+        for (uint32_t i = 0; i < kNumTextures; i++)
+        {
+            const uint32_t kind = random.Next( kNumKinds );
+            kinds.push_back( kind );
+            packer.AddTexture( kKinds[kind].m_Format, kKinds[kind].m_uWidth, kKinds[kind].m_uHeight, kKinds[kind].m_uMipLevels );
+        }
+        Check( CDXUTTextureArrayPacker::INVALID_TEXTURE == packer.AddTexture( DXGI_FORMAT_BC1_UNORM, 0, 64, 1 ), "a texture without texels is refused" );
+
+        // one array for each kind
+        packer.Pack();
+        const uint32_t kNoArray = CDXUTTextureArrayPacker::INVALID_TEXTURE;
+        std::vector<uint32_t> arrayOfKind( kNumKinds, kNoArray );
+        uint32_t numKindsUsed = 0;
+        bool bShared = true;
+        for (uint32_t texture = 0; texture < kNumTextures; texture++)
+        {
+            uint32_t& array = arrayOfKind[kinds[texture]];
+            if (kNoArray == array)
+            {
+                array = packer.GetArrayIndex( texture );
+                numKindsUsed++;
+            }
+            bShared = bShared && (array == packer.GetArrayIndex( texture ));
+        }
+        Check( bShared && packer.GetNumArrays() == numKindsUsed, "compatible textures share one array" );
+        Check( IsConsistent( packer, kinds, kKinds ), "arrays hold compatible textures in the order they were added" );
+
+        // the n-th texture of a kind goes in slice n % kMaxSlices of the (n / kMaxSlices)-th
+        // array of that kind
+        packer.SetMaxSlices( kMaxSlices );
+        packer.Pack();
+        std::vector<uint32_t> numOfKind( kNumKinds, 0 );
+        std::vector<uint32_t> lastArrayOfKind( kNumKinds, kNoArray );
+        uint32_t numExpectedArrays = 0;
+        bool bSplit = true;
+        for (uint32_t texture = 0; texture < kNumTextures; texture++)
+        {
+            const uint32_t kind = kinds[texture];
+            const uint32_t n = numOfKind[kind]++;
+            const uint32_t array = packer.GetArrayIndex( texture );
+            if (0 == n % kMaxSlices)
+            {
+                numExpectedArrays++;
+                bSplit = bSplit && (array != lastArrayOfKind[kind]);
+            }
+            else
+            {
+                bSplit = bSplit && (array == lastArrayOfKind[kind]);
+            }
+            bSplit = bSplit && (packer.GetSlice( texture ) == n % kMaxSlices);
+            lastArrayOfKind[kind] = array;
+        }
+        Check( bSplit && packer.GetNumArrays() == numExpectedArrays, "arrays split at SetMaxSlices" );
+        Check( IsConsistent( packer, kinds, kKinds ), "split arrays keep compatible textures in the order added" );
+
+        std::vector<uint32_t> placement;
+        std::vector<uint32_t> again;
+        GetPlacement( packer, placement );
+        packer.Pack();
+        GetPlacement( packer, again );
+        Check( placement == again, "packing again gives each texture the same array and slice" );
+
+        CDXUTTextureArrayPacker other;
+        other.SetMaxSlices( kMaxSlices );
+        for (uint32_t texture = 0; texture < kNumTextures; texture++)
+        {
+            const TextureKind& kind = kKinds[kinds[texture]];
+            other.AddTexture( kind.m_Format, kind.m_uWidth, kind.m_uHeight, kind.m_uMipLevels );
+        }
+        other.Pack();
+        GetPlacement( other, again );
+        Check( placement == again, "another packer with the same textures packs them the same" );
+
+        packer.SetMaxSlices( 0 );
+        packer.Pack();
+        Check( kNumTextures == packer.GetNumArrays() && IsConsistent( packer, kinds, kKinds ), "SetMaxSlices( 0 ) gives every texture its own array" );
+    }
+
+    //--------------------------------------------------------------------------------------
+    // CDXUTMipStreamScheduler
+    //--------------------------------------------------------------------------------------
+    struct PendingLoad
+    {
+        uint32_t    m_uTexture;         // index into the test's textures
+        uint32_t    m_uMip;
+        uint32_t    m_uFramesLeft;
+    };
+
+    uint32_t GetTailMip( const TestTexture& i_Texture )
+    {
+        uint32_t tailMip = 0;
+        while ((std::max( i_Texture.m_uWidth, i_Texture.m_uHeight ) >> tailMip) > kTailSize)
+        {
+            tailMip++;
+        }
+        return tailMip;
+    }
+
+    void AddStreamedTexture( Random& io_Random, CDXUTMipStreamScheduler& io_Scheduler, TestTexture& o_Texture )
+    {
+        MakeTexture( RandomSize( io_Random, 7, 12 ), RandomSize( io_Random, 7, 12 ), (0 == io_Random.Next( 2 )) ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM, o_Texture );
+        o_Texture.m_uId = io_Scheduler.AddTexture( std::max( o_Texture.m_uWidth, o_Texture.m_uHeight ), o_Texture.m_uMipCount, GetTailMip( o_Texture ), &o_Texture.m_MipBytes[0] );
+    }
+
+    void TestMipStreamScheduler()
+    {
+        printf( "\nCDXUTMipStreamScheduler\n" );
+
+        static const uint64_t kBudgets[] = { 0, 1 << 20, 4 << 20, 16 << 20, 64 << 20, 256 << 20 };
+        const uint32_t kNumBudgets = sizeof( kBudgets ) / sizeof( kBudgets[0] );
+        const uint32_t kNumTextures = 32;
+        const uint32_t kNumFrames = 4000;
+        const uint32_t kMaxLoadsInFlight = 3;
+
+        Random random( 2 );
+        CDXUTMipStreamScheduler scheduler;
+        scheduler.SetMaxLoadsInFlight( kMaxLoadsInFlight );
+
+        std::vector<TestTexture> textures( kNumTextures );
+        for (uint32_t i = 0; i < kNumTextures; i++)
+        {
+            AddStreamedTexture( random, scheduler, textures[i] );
+        }
+
+        std::vector<CDXUTMipStreamScheduler::Action> actions;
+        std::vector<PendingLoad> loads;
+        uint64_t budget = 0;
+        uint32_t numLoaded = 0;
+        uint32_t numRefined = 0;         // textures seen with a resident mip finer than their tail
+        bool bWithinBudget = true;
+        bool bBytesAddUp = true;
+        bool bResidentNotFiner = true;
+        bool bLoadsAllocated = true;
+        bool bLoadsLimited = true;
+
+        for (uint32_t frame = 0; frame < kNumFrames; frame++)
+        {
+            if (0 == frame % 200)
+            {
+                budget = kBudgets[random.Next( kNumBudgets )];
+                scheduler.SetBudget( budget );
+            }
+
+            // now and then a texture goes, with its loads, and another takes its place
+            if (0 == frame % 50)
+            {
+                TestTexture& texture = textures[random.Next( kNumTextures )];
+                scheduler.RemoveTexture( texture.m_uId );
+                for (size_t l = loads.size(); l-- > 0; )
+                {
+                    if (&textures[loads[l].m_uTexture] == &texture)
+                    {
+                        loads.erase( loads.begin() + l );
+                    }
+                }
+                AddStreamedTexture( random, scheduler, texture );
+            }
+
+            // a few textures are off screen, the others anywhere from distant to close up
+            for (uint32_t i = 0; i < kNumTextures; i++)
+            {
+                if (0 != random.Next( 8 ))
+                {
+                    scheduler.SetScreenSize( textures[i].m_uId, (float)random.Next( 4096 ) );
+                }
+            }
+
+            scheduler.Update( actions );
+
+            for (size_t a = 0; a < actions.size(); a++)
+            {
+                const CDXUTMipStreamScheduler::Action& action = actions[a];
+                if (CDXUTMipStreamScheduler::ACTION_LOAD != action.type)
+                {
+                    continue;
+                }
+
+                uint32_t i = 0;
+                while (i < kNumTextures && textures[i].m_uId != action.texture)
+                {
+                    i++;
+                }
+                bLoadsAllocated = bLoadsAllocated && (i < kNumTextures) && (action.mip >= scheduler.GetAllocatedMip( action.texture ));
+
+                PendingLoad load = { i, action.mip, 1 + random.Next( 4 ) };
+                loads.push_back( load );
+            }
+            bLoadsLimited = bLoadsLimited && (scheduler.GetNumLoadsInFlight() <= kMaxLoadsInFlight);
+
+            uint64_t allocatedBytes = 0;
+            for (uint32_t i = 0; i < kNumTextures; i++)
+            {
+                const TestTexture& texture = textures[i];
+                const uint32_t allocMip = scheduler.GetAllocatedMip( texture.m_uId );
+                const uint32_t residentMip = scheduler.GetResidentMip( texture.m_uId );
+                const uint32_t tailMip = GetTailMip( texture );
+
+                bResidentNotFiner = bResidentNotFiner && (residentMip >= allocMip) && (residentMip <= tailMip);
+                allocatedBytes += GetBytes( texture, allocMip, tailMip );
+                numRefined += (residentMip < tailMip) ? 1 : 0;
+            }
+            bBytesAddUp = bBytesAddUp && (allocatedBytes == scheduler.GetAllocatedBytes());
+            bWithinBudget = bWithinBudget && (allocatedBytes <= budget);
+
+            // the loads come back a few frames later, one in twenty failed
+            for (size_t l = loads.size(); l-- > 0; )
+            {
+                PendingLoad& load = loads[l];
+                if (0 == --load.m_uFramesLeft)
+                {
+                    const uint32_t id = textures[load.m_uTexture].m_uId;
+                    scheduler.OnLoadComplete( id, load.m_uMip, 0 != random.Next( 20 ) );
+                    bResidentNotFiner = bResidentNotFiner && (scheduler.GetResidentMip( id ) >= scheduler.GetAllocatedMip( id ));
+                    loads.erase( loads.begin() + l );
+                    numLoaded++;
+                }
+            }
+        }
+
+        printf( "%u frames, %u loads, %u evictions\n", kNumFrames, numLoaded, scheduler.GetNumEvictions() );
+        Check( 0 < numLoaded && 0 < numRefined && 0 < scheduler.GetNumEvictions(), "textures streamed in and were evicted" );
+        Check( bWithinBudget, "allocations never exceeded the budget" );
+        Check( bBytesAddUp, "allocated bytes are those of the allocated mips" );
+        Check( bResidentNotFiner, "no resident mip was finer than the allocated one" );
+        Check( bLoadsAllocated, "loads were only for allocated mips" );
+        Check( bLoadsLimited, "loads in flight stayed within SetMaxLoadsInFlight" );
+    }
+
+    //--------------------------------------------------------------------------------------
+    // CDXUTResidencyPlanner
+    //--------------------------------------------------------------------------------------
+
+    // loads the texture the way DDSTextureLoader does with maxsize, and returns whether it
+    // skipped i_uSkipMips top mips
+    bool LoaderSkips( const TestTexture& i_Texture, uint32_t i_uMaxSize, uint32_t i_uSkipMips, std::vector<uint8_t>& io_Bits )
+    {
+        const uint64_t numBytes = GetBytes( i_Texture, 0, i_Texture.m_uMipCount );
+        if (io_Bits.size() < numBytes)
+        {
+            io_Bits.resize( (size_t)numBytes );
+        }
+
+        std::vector<D3D11_SUBRESOURCE_DATA> initData( i_Texture.m_uMipCount );
+        size_t twidth = 0;
+        size_t theight = 0;
+        size_t tdepth = 0;
+        size_t skipMip = 0;
+        HRESULT hr = DirectX::FillInitData( i_Texture.m_uWidth, i_Texture.m_uHeight, 1, i_Texture.m_uMipCount, 1, i_Texture.m_Format, i_uMaxSize,
+                                            (size_t)numBytes, &io_Bits[0], twidth, theight, tdepth, skipMip, &initData[0] );
+
+        return SUCCEEDED( hr ) && skipMip == i_uSkipMips
+            && twidth == std::max<size_t>( i_Texture.m_uWidth >> i_uSkipMips, 1 )
+            && theight == std::max<size_t>( i_Texture.m_uHeight >> i_uSkipMips, 1 );
+    }
+
+    void TestResidencyPlanner()
+    {
+        printf( "\nCDXUTResidencyPlanner\n" );
+
+        const uint32_t kNumTextures = 24;
+
+        Random random( 3 );
+        CDXUTResidencyPlanner planner;
+        std::vector<TestTexture> textures( kNumTextures );
+        std::vector<uint32_t> maxSkips( kNumTextures );
+        uint64_t allBytes = 0;
+        uint64_t leastBytes = 0;            // with every texture down to maxSkip
+        for (uint32_t i = 0; i < kNumTextures; i++)
+        {
+            TestTexture& texture = textures[i];
+            MakeTexture( RandomSize( random, 2, 11 ), RandomSize( random, 2, 11 ), (0 == random.Next( 2 )) ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM, texture );
+
+            // some textures may lose every mip but the last, others only two; some have no screen size yet
+            maxSkips[i] = (0 == random.Next( 2 )) ? texture.m_uMipCount - 1 : std::min<uint32_t>( 2, texture.m_uMipCount - 1 );
+            const float fPixels = (0 == random.Next( 4 )) ? 0.0f : (float)random.Next( 2048 );
+            texture.m_uId = planner.AddTexture( std::max( texture.m_uWidth, texture.m_uHeight ), texture.m_uMipCount, maxSkips[i], &texture.m_MipBytes[0], fPixels );
+
+            allBytes += GetBytes( texture, 0, texture.m_uMipCount );
+            leastBytes += GetBytes( texture, maxSkips[i], texture.m_uMipCount );
+        }
+
+        // budgets from one that fits everything, over the exact fit, to too little for anything
+        struct Case
+        {
+            uint64_t    m_Budget;
+            uint64_t    m_Reserved;
+        };
+        const Case kCases[] =
+        {
+            { allBytes,             0 },
+            { allBytes,             allBytes / 4 },
+            { allBytes,             allBytes / 2 },
+            { allBytes / 2,         allBytes / 4 },
+            { allBytes,             allBytes - leastBytes },
+            { allBytes,             allBytes - leastBytes + 1 },
+            { allBytes,             allBytes },
+            { allBytes / 2,         allBytes },
+        };
+        const uint32_t kNumCases = sizeof( kCases ) / sizeof( kCases[0] );
+
+        bool bFits = true;
+        bool bMaxSkipWhenNot = true;
+        bool bBytesAddUp = true;
+        bool bWithinMaxSkip = true;
+        bool bLoaderAgrees = true;
+        uint64_t lastAvailable = UINT64_MAX;
+        uint64_t lastPlannedBytes = UINT64_MAX;
+        bool bShrinks = true;
+        std::vector<uint8_t> bits;
+        for (uint32_t c = 0; c < kNumCases; c++)
+        {
+            planner.SetBudget( kCases[c].m_Budget );
+            planner.SetReservedBytes( kCases[c].m_Reserved );
+            planner.Plan();
+
+            uint64_t plannedBytes = 0;
+            bool bAllAtMaxSkip = true;
+            for (uint32_t i = 0; i < kNumTextures; i++)
+            {
+                const TestTexture& texture = textures[i];
+                const uint32_t skipMips = planner.GetSkipMips( texture.m_uId );
+
+                plannedBytes += GetBytes( texture, skipMips, texture.m_uMipCount );
+                bAllAtMaxSkip = bAllAtMaxSkip && (skipMips == maxSkips[i]);
+                bWithinMaxSkip = bWithinMaxSkip && (skipMips <= maxSkips[i]);
+                bLoaderAgrees = bLoaderAgrees && LoaderSkips( texture, planner.GetMaxSize( texture.m_uId ), skipMips, bits );
+            }
+            bBytesAddUp = bBytesAddUp && (plannedBytes == planner.GetPlannedBytes());
+
+            const bool bCanFit = (leastBytes + kCases[c].m_Reserved <= kCases[c].m_Budget);
+            if (bCanFit)
+            {
+                bFits = bFits && planner.Fits() && (plannedBytes + kCases[c].m_Reserved <= kCases[c].m_Budget);
+            }
+            else
+            {
+                bMaxSkipWhenNot = bMaxSkipWhenNot && !planner.Fits() && bAllAtMaxSkip;
+            }
+
+            // less room never plans more memory
+            const uint64_t available = (kCases[c].m_Budget > kCases[c].m_Reserved) ? kCases[c].m_Budget - kCases[c].m_Reserved : 0;
+            bShrinks = bShrinks && (available > lastAvailable || plannedBytes <= lastPlannedBytes);
+            lastAvailable = available;
+            lastPlannedBytes = plannedBytes;
+        }
+
+        Check( bFits, "plans fit the budget left after SetReservedBytes" );
+        Check( bMaxSkipWhenNot, "a plan that can't fit has every texture at maxSkip" );
+        Check( bShrinks, "reserving more never plans more memory" );
+        Check( bBytesAddUp, "planned bytes are those of the planned mips" );
+        Check( bWithinMaxSkip, "no texture skips more than maxSkip mips" );
+        Check( bLoaderAgrees, "GetMaxSize makes FillInitData skip the planned mips" );
+    }
+}
+
+int main()
+{
+    TestTextureArrayPacker();
+    TestMipStreamScheduler();
+    TestResidencyPlanner();
+
+    printf( "\n%d failures\n", g_iNumFailures );
+    return (0 == g_iNumFailures) ? kExitOk : kExitFailed;
+}